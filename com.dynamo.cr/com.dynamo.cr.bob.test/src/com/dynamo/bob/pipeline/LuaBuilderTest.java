@@ -12,9 +12,12 @@
 
 package com.dynamo.bob.pipeline;
 
+import static org.junit.Assert.assertArrayEquals;
 import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertTrue;
 
+import java.io.ByteArrayOutputStream;
+
 import org.junit.Test;
 
 import com.dynamo.bob.CompileExceptionError;
@@ -91,4 +94,35 @@ public class LuaBuilderTest extends AbstractProtoBuilderTest {
             assertEquals(2, e.getLineNumber());
         }
     }
+
+    // A Lua 5.1 chunk with the given header layout, source name and function data
+    private static byte[] lua51Bytecode(int sizeOfSizeT, boolean littleEndian, String source, byte[] function) throws Exception {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        out.write(new byte[] { 0x1b, 'L', 'u', 'a', 0x51, 0, (byte) (littleEndian ? 1 : 0), 4, (byte) sizeOfSizeT, 4, 8, 0 });
+        byte[] name = (source + "\0").getBytes("UTF-8");
+        for (int i = 0; i < sizeOfSizeT; ++i) {
+            int shift = littleEndian ? i : sizeOfSizeT - 1 - i;
+            out.write((name.length >> (8 * shift)) & 0xff);
+        }
+        out.write(name);
+        out.write(function);
+        return out.toByteArray();
+    }
+
+    @Test
+    public void testLua51ChunkName() throws Exception {
+        byte[] function = new byte[] { 1, 2, 3, 4, 5 };
+        for (int sizeOfSizeT : new int[] { 4, 8 }) {
+            for (boolean littleEndian : new boolean[] { true, false }) {
+                byte[] bytecode = lua51Bytecode(sizeOfSizeT, littleEndian, "@/tmp/script1234567890.lua", function);
+                byte[] expected = lua51Bytecode(sizeOfSizeT, littleEndian, "=/main/test.script", function);
+                assertArrayEquals(expected, LuaBuilder.setLua51ChunkName(bytecode, "=/main/test.script"));
+
+                // a longer name than the original
+                bytecode = lua51Bytecode(sizeOfSizeT, littleEndian, "@a.lua", function);
+                expected = lua51Bytecode(sizeOfSizeT, littleEndian, "=/main/some/longer/path/test.script", function);
+                assertArrayEquals(expected, LuaBuilder.setLua51ChunkName(bytecode, "=/main/some/longer/path/test.script"));
+            }
+        }
+    }
 }
@@ -90,6 +90,14 @@ copy () {
     cp -v $DYNAMO_HOME/archive/${SHA1}/engine/$1 libexec/$2
 }
 
+# Lua 5.1 compilers for --use-lua51-bytecode
+copy x86_64-linux/luac-32 x86_64-linux/luac-32
+copy x86_64-linux/luac-64 x86_64-linux/luac-64
+copy x86_64-darwin/luac-32 x86_64-darwin/luac-32
+copy x86_64-darwin/luac-64 x86_64-darwin/luac-64
+copy win32/luac-32.exe x86_64-win32/luac-32.exe
+copy x86_64-win32/luac-64.exe x86_64-win32/luac-64.exe
+
 copy x86_64-linux/stripped/dmengine x86_64-linux/dmengine
 copy x86_64-linux/stripped/dmengine_release x86_64-linux/dmengine_release
 copy x86_64-linux/stripped/dmengine_headless x86_64-linux/dmengine_headless
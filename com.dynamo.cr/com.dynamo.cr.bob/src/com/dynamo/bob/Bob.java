@@ -392,6 +392,7 @@ public class Bob {
         options.addOption(null, "binary-output", true, "Location where built engine binary will be placed. Default is \"<build-output>/<platform>/\"");
 
         options.addOption(null, "use-vanilla-lua", false, "Only ships vanilla source code (i.e. no byte code)");
+        options.addOption(null, "use-lua51-bytecode", false, "Also ship vanilla Lua 5.1 byte code built with luac, for the platforms using vanilla Lua. The source code is kept as fallback");
 
         options.addOption("l", "liveupdate", true, "yes if liveupdate content should be published");
 
@@ -583,6 +584,10 @@ public class Bob {
             project.setOption("use-vanilla-lua", "true");
         }
 
+        if (cmd.hasOption("use-lua51-bytecode")) {
+            project.setOption("use-lua51-bytecode", "true");
+        }
+
         if (cmd.hasOption("bundle-format")) {
             project.setOption("bundle-format", cmd.getOptionValue("bundle-format"));
         }
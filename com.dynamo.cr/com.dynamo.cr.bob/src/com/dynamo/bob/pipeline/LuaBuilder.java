@@ -87,7 +87,58 @@ public abstract class LuaBuilder extends Builder<Void> {
         return string.getBytes();
     }
 
+    // The chunkname (the identifying part of a script/source chunk) is limited to 59 chars.
+    // Lua has a maximum length of chunknames, by default defined to 60 chars.
+    //
+    // If a script error occurs in runtime we want Lua to report the end of the filepath
+    // associated with the chunk, since this is where the filename is visible.
+    //
+    // See implementation of luaO_chunkid and why a prefix '=' is used; it is to pass through the filename without modifications.
+    private static String getChunkName(Task<Void> task) {
+        String chunkName = task.input(0).getPath();
+        if (chunkName.length() >= 59) {
+            chunkName = chunkName.substring(chunkName.length() - 59);
+        }
+        return "=" + chunkName;
+    }
+
     public byte[] constructBytecode(Task<Void> task, String luajitExe, byte[] byteString) throws IOException, CompileExceptionError {
+        return compileLua(task, luajitExe, true, byteString);
+    }
+
+    // Bytecode for the vanilla Lua 5.1 runtime, from a luac built for the same word size as the target
+    public byte[] constructLua51Bytecode(Task<Void> task, String luacExe, byte[] byteString) throws IOException, CompileExceptionError {
+        byte[] bytecode = compileLua(task, luacExe, false, byteString);
+        return setLua51ChunkName(bytecode, getChunkName(task));
+    }
+
+    // luac names the chunk after the temporary input file, so it's replaced with the same chunk name
+    // as for LuaJIT. Only the main function stores it, nested functions share it (see DumpFunction in ldump.c)
+    static byte[] setLua51ChunkName(byte[] bytecode, String chunkName) throws IOException {
+        final int headerSize = 12;
+        boolean littleEndian = bytecode[6] == 1;
+        int sizeOfSizeT = bytecode[8];
+
+        long oldLength = 0;
+        for (int i = 0; i < sizeOfSizeT; ++i) {
+            int shift = littleEndian ? i : sizeOfSizeT - 1 - i;
+            oldLength |= (long) (bytecode[headerSize + i] & 0xff) << (8 * shift);
+        }
+
+        byte[] name = (chunkName + "\0").getBytes("UTF-8");
+        ByteArrayOutputStream out = new ByteArrayOutputStream(bytecode.length + name.length);
+        out.write(bytecode, 0, headerSize);
+        for (int i = 0; i < sizeOfSizeT; ++i) {
+            int shift = littleEndian ? i : sizeOfSizeT - 1 - i;
+            out.write((int) (((long) name.length >> (8 * shift)) & 0xff));
+        }
+        out.write(name);
+        int rest = headerSize + sizeOfSizeT + (int) oldLength;
+        out.write(bytecode, rest, bytecode.length - rest);
+        return out.toByteArray();
+    }
+
+    private byte[] compileLua(Task<Void> task, String exe, boolean luajit, byte[] byteString) throws IOException, CompileExceptionError {
 
         java.io.FileOutputStream fo = null;
         RandomAccessFile rdr = null;
@@ -104,28 +155,17 @@ public abstract class LuaBuilder extends Builder<Void> {
             fo.write(byteString);
             fo.close();
 
-            // Doing a bit of custom set up here as the path is required.
-            //
-            // NOTE: The -f option for bytecode is a small custom modification to bcsave.lua in LuaJIT which allows us to supply the
-            //       correct chunk name (the original original source file) already here.
-            //
-            // See implementation of luaO_chunkid and why a prefix '=' is used; it is to pass through the filename without modifications.
-            //
-            // We will also limit the chunkname (the identifying part of a script/source chunk) to 59 chars.
-            // Lua has a maximum length of chunknames, by default defined to 60 chars.
-            //
-            // If a script error occurs in runtime we want Lua to report the end of the filepath
-            // associated with the chunk, since this is where the filename is visible.
-            //
-            String chunkName = task.input(0).getPath();
-            if (chunkName.length() >= 59) {
-                chunkName = chunkName.substring(chunkName.length() - 59);
-            }
-            chunkName = "=" + chunkName;
-            ProcessBuilder pb = new ProcessBuilder(new String[] { Bob.getExe(Platform.getHostPlatform(), luajitExe), "-bgf", chunkName, inputFile.getAbsolutePath(), outputFile.getAbsolutePath() }).redirectErrorStream(true);
+            ProcessBuilder pb;
+            if (luajit) {
+                // NOTE: The -f option for bytecode is a small custom modification to bcsave.lua in LuaJIT which allows us to supply the
+                //       correct chunk name (the original original source file) already here.
+                pb = new ProcessBuilder(new String[] { Bob.getExe(Platform.getHostPlatform(), exe), "-bgf", getChunkName(task), inputFile.getAbsolutePath(), outputFile.getAbsolutePath() }).redirectErrorStream(true);
 
-            java.util.Map<String, String> env = pb.environment();
-            env.put("LUA_PATH", Bob.getPath("share/luajit/") + "/?.lua");
+                java.util.Map<String, String> env = pb.environment();
+                env.put("LUA_PATH", Bob.getPath("share/luajit/") + "/?.lua");
+            } else {
+                pb = new ProcessBuilder(new String[] { Bob.getExe(Platform.getHostPlatform(), exe), "-o", outputFile.getAbsolutePath(), inputFile.getAbsolutePath() }).redirectErrorStream(true);
+            }
 
             Process p = pb.start();
             InputStream is = null;
@@ -141,7 +181,7 @@ public abstract class LuaBuilder extends Builder<Void> {
 
                 String cmdOutput = new String(buf);
                 if (ret != 0) {
-                    // first delimiter is the executable name "luajit:"
+                    // first delimiter is the executable name "luajit:" or "luac:"
                     int execSep = cmdOutput.indexOf(':');
                     if (execSep > 0) {
                         // then comes the filename and the line like this:
@@ -158,7 +198,7 @@ public abstract class LuaBuilder extends Builder<Void> {
                         }
                     }
                     // Since parsing out the actual error failed, as a backup just
-                    // spit out whatever luajit said.
+                    // spit out whatever the compiler said.
                     inputFile.delete();
                     throw new CompileExceptionError(task.input(0), 1, cmdOutput);
                 }
@@ -220,6 +260,12 @@ public abstract class LuaBuilder extends Builder<Void> {
 
         if (needsLuaSource.contains(project.getPlatform()) || use_vanilla_lua) {
             srcBuilder.setScript(ByteString.copyFrom(scriptBytesStripped));
+
+            // The vanilla runtime loads the bytecode matching its word size, and the script otherwise
+            if (this.project.option("use-lua51-bytecode", "false").equals("true")) {
+                srcBuilder.setLua51Bytecode(ByteString.copyFrom(constructLua51Bytecode(task, "luac-32", scriptBytesStripped)));
+                srcBuilder.setLua51Bytecode64(ByteString.copyFrom(constructLua51Bytecode(task, "luac-64", scriptBytesStripped)));
+            }
         } else {
             byte[] bytecode = constructBytecode(task, "luajit-32", scriptBytesStripped);
             if (bytecode != null) {
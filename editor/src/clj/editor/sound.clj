@@ -77,7 +77,7 @@
   (g/clear-property! node-id property))
 
 (g/defnk produce-form-data
-  [_node-id sound looping group gain pan speed]
+  [_node-id sound looping group gain pan speed priority]
   {:navigation false
    :form-ops {:user-data {:node-id _node-id}
               :set set-form-op
@@ -101,22 +101,27 @@
                          :type :number}
                          {:path [:speed]
                          :label "Speed"
-                         :type :number}]}]
+                         :type :number}
+                        {:path [:priority]
+                         :label "Priority"
+                         :type :integer}]}]
    :values {[:sound] sound
             [:looping] looping
             [:group] group
             [:gain] gain
             [:pan] pan
-            [:speed] speed}})
+            [:speed] speed
+            [:priority] priority}})
 
 (g/defnk produce-pb-msg
-  [_node-id sound-resource looping group gain pan speed]
+  [_node-id sound-resource looping group gain pan speed priority]
   {:sound (resource/resource->proj-path sound-resource)
    :looping (if looping 1 0)
    :group group
    :gain gain
    :pan pan
-   :speed speed})
+   :speed speed
+   :priority priority})
 
 (defn build-sound
   [resource dep-resources user-data]
@@ -150,9 +155,11 @@
     :group (:group sound)
     :gain (:gain sound)
     :pan (:pan sound)
-    :speed (:speed sound)))
+    :speed (:speed sound)
+    :priority (:priority sound)))
 
 (def prop-sound_speed? (partial validation/prop-outside-range? [0.1 5.0]))
+(def prop-sound_priority? (partial validation/prop-outside-range? [0 255]))
 
 (g/defnode SoundNode
   (inherits resource-node/ResourceNode)
@@ -179,6 +186,8 @@
             (dynamic error (validation/prop-error-fnk :fatal validation/prop-1-1? pan)))
   (property speed g/Num (default 1.0)
             (dynamic error (validation/prop-error-fnk :fatal prop-sound_speed? speed)))
+  (property priority g/Int (default 0)
+            (dynamic error (validation/prop-error-fnk :fatal prop-sound_priority? priority)))
 
   (output form-data g/Any :cached produce-form-data)
   (output node-outline outline/OutlineData :cached produce-outline-data)
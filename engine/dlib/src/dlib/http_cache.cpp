@@ -30,16 +30,33 @@
 #include "poolallocator.h"
 #include "path.h"
 
+#if defined(_WIN32) || defined(__EMSCRIPTEN__)
+    #define DM_HTTP_CACHE_MMAP 0
+#else
+    #define DM_HTTP_CACHE_MMAP 1
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 namespace dmHttpCache
 {
     // Magic file header for index file
     const uint32_t MAGIC = 0xCAAAAAAC;
     // Current index file version
-    const uint32_t VERSION = 7;
+    const uint32_t VERSION = 8;
 
     // Maximum number of cache entry creations in flight
     const uint32_t MAX_CACHE_CREATORS = 16;
 
+    // Number of lock stripes. Entries are distributed over the stripes by uri hash
+    // so that concurrent lookups of different entries rarely contend for a lock
+    const uint32_t STRIPE_COUNT = 16;
+
+    // The index file is rewritten when it holds more records than this number of live entries
+    // multiplied by two, ie when more than half of the records are stale
+    const uint32_t INDEX_COMPACT_SLACK = 256;
+
     // Index header struct
     struct IndexHeader
     {
@@ -47,8 +64,6 @@ namespace dmHttpCache
         uint32_t m_Magic;
         // Index file version number
         uint32_t m_Version;
-        // Checksum of the index payload, ie the data that follows the header
-        uint64_t m_Checksum;
         uint32_t m_SizeOfEntry;     // Making sure the size is double checked
         uint32_t m_SizeOfFileEntry; // Making sure the size is double checked
     };
@@ -65,19 +80,21 @@ namespace dmHttpCache
         EntryInfo m_Info;
         uint8_t  m_ReadLockCount : 8;
         uint8_t  m_WriteLock : 1;
+        // Changed since the entry was last written to the index file
+        uint8_t  m_IndexDirty : 1;
     };
 
     /*
-     * Disk (index) representation of a cache entry
+     * Disk (index) representation of a cache entry. The index file is a journal of
+     * records appended on flush. A later record for the same uri replaces an earlier one.
+     * Each record is followed by the null-terminated uri, padded to a multiple of 8 bytes.
      */
     struct FileEntry
     {
         uint64_t m_UriHash;
         // ETag string
         char     m_ETag[MAX_TAG_LEN];
-        // Path string
-        char     m_URI[MAX_URI_LEN];
-        // The content hash is the hash of URI and ETag.
+        // The content hash is the hash of URI and ETag. Zero for a removed entry
         uint64_t m_IdentifierHash;
         // Last accessed time
         uint64_t m_LastAccessed;
@@ -85,6 +102,12 @@ namespace dmHttpCache
         uint64_t m_Expires;
         // Checksum
         uint64_t m_Checksum;
+        // Checksum of the record and uri, computed with this field set to zero.
+        // Used to detect a record torn by an interrupted append
+        uint64_t m_RecordChecksum;
+        // Size of the uri that follows the record, including padding
+        uint32_t m_URISize;
+        uint32_t m_Pad;
     };
 
     /*
@@ -101,6 +124,16 @@ namespace dmHttpCache
         uint32_t    m_Error : 1;
     };
 
+    /*
+     * A partition of the cache entries with its own lock
+     */
+    struct Stripe
+    {
+        dmHashTable64<Entry>    m_CacheTable;
+        dmMutex::HMutex         m_Mutex;
+        dmPoolAllocator::HPool  m_StringAllocator;
+    };
+
     /*
      * The cache database
      */
@@ -110,28 +143,49 @@ namespace dmHttpCache
         {
             m_Path = strdup(path);
             m_MaxCacheEntryAge = max_entry_age;
-            m_CacheTable.SetCapacity(11, 32);
+            for (uint32_t i = 0; i < STRIPE_COUNT; ++i)
+            {
+                m_Stripes[i].m_CacheTable.SetCapacity(11, 32);
+                m_Stripes[i].m_Mutex = dmMutex::New();
+                m_Stripes[i].m_StringAllocator = dmPoolAllocator::New(4096);
+            }
             m_Mutex = dmMutex::New();
+            m_IndexMutex = dmMutex::New();
             m_Policy = CONSISTENCY_POLICY_VERIFY;
-            m_StringAllocator = dmPoolAllocator::New(4096);
+            m_IndexRecords = 0;
+            m_IndexValid = false;
             m_Dirty = false;
         }
 
         ~Cache()
         {
             free(m_Path);
+            for (uint32_t i = 0; i < STRIPE_COUNT; ++i)
+            {
+                dmMutex::Delete(m_Stripes[i].m_Mutex);
+                dmPoolAllocator::Delete(m_Stripes[i].m_StringAllocator);
+            }
             dmMutex::Delete(m_Mutex);
-            dmPoolAllocator::Delete(m_StringAllocator);
+            dmMutex::Delete(m_IndexMutex);
         }
 
         char*                m_Path;
         uint64_t             m_MaxCacheEntryAge;
-        dmHashTable64<Entry> m_CacheTable;
+        Stripe               m_Stripes[STRIPE_COUNT];
+        // Protects cache creators, policy and the index dirty state. Taken while a stripe
+        // lock is held, so no other lock may be acquired while holding it
         dmMutex::HMutex      m_Mutex;
+        // Serializes writes to the index file
+        dmMutex::HMutex      m_IndexMutex;
         dmIndexPool16        m_CacheCreatorsPool;
         dmArray<CacheCreator> m_CacheCreators;
         ConsistencyPolicy    m_Policy;
-        dmPoolAllocator::HPool m_StringAllocator;
+        // Uri hashes of entries removed since the last flush
+        dmArray<uint64_t>    m_Removed;
+        // Number of records in the index file
+        uint32_t             m_IndexRecords;
+        // False when the index file is missing or damaged and must be rewritten on flush
+        bool                 m_IndexValid;
         bool                 m_Dirty;
     };
 
@@ -141,6 +195,58 @@ namespace dmHttpCache
         params->m_MaxCacheEntryAge = 60 * 60 * 24 * 5;
     }
 
+    static Stripe* GetStripe(HCache cache, uint64_t uri_hash)
+    {
+        // Use the top bits as the hashtables use the low bits for bucket selection
+        return &cache->m_Stripes[(uri_hash >> 32) % STRIPE_COUNT];
+    }
+
+    static uint64_t GetIdentifierHash(const char* uri, const char* etag)
+    {
+        HashState64 hash_state;
+        dmHashInit64(&hash_state, false);
+        dmHashUpdateBuffer64(&hash_state, uri, strlen(uri));
+        dmHashUpdateBuffer64(&hash_state, etag, strlen(etag));
+        return dmHashFinal64(&hash_state);
+    }
+
+    static Entry* PutEntry(Stripe* stripe, uint64_t uri_hash)
+    {
+        if (stripe->m_CacheTable.Full())
+        {
+            uint32_t new_capacity = stripe->m_CacheTable.Capacity() + 128;
+            stripe->m_CacheTable.SetCapacity(dmMath::Max(1U, 2 * new_capacity / 3), new_capacity);
+        }
+        stripe->m_CacheTable.Put(uri_hash, Entry());
+        return stripe->m_CacheTable.Get(uri_hash);
+    }
+
+    static void SetDirty(HCache cache)
+    {
+        dmMutex::ScopedLock lock(cache->m_Mutex);
+        cache->m_Dirty = true;
+    }
+
+    static void MarkEntryDirty(HCache cache, Entry* entry)
+    {
+        entry->m_IndexDirty = 1;
+        SetDirty(cache);
+    }
+
+    // NOTE: The stripe lock must be held
+    static void EraseEntry(HCache cache, Stripe* stripe, uint64_t uri_hash)
+    {
+        stripe->m_CacheTable.Erase(uri_hash);
+
+        dmMutex::ScopedLock lock(cache->m_Mutex);
+        if (cache->m_Removed.Full())
+        {
+            cache->m_Removed.OffsetCapacity(64);
+        }
+        cache->m_Removed.Push(uri_hash);
+        cache->m_Dirty = true;
+    }
+
     static void HashToString(uint64_t hash, char* str)
     {
         static const char hex_chars[] = "0123456789abcdef";
@@ -173,7 +279,7 @@ namespace dmHttpCache
         if (r != dmSys::RESULT_OK)
         {
             dmLogWarning("Unable to remove %s", path);
-            cache->m_Dirty = true;
+            SetDirty(cache);
         }
     }
 
@@ -185,6 +291,111 @@ namespace dmHttpCache
                 header->m_SizeOfFileEntry == (uint32_t)sizeof(FileEntry);
     }
 
+    // Replay the index journal. Returns the number of bytes of valid records
+    static uint32_t LoadIndex(HCache cache, uint8_t* records, uint32_t size, uint32_t* record_count)
+    {
+        // The number of records is an upper bound of the number of entries
+        uint32_t capacity = (size / sizeof(FileEntry)) / STRIPE_COUNT + 32;
+        for (uint32_t i = 0; i < STRIPE_COUNT; ++i)
+        {
+            cache->m_Stripes[i].m_CacheTable.SetCapacity(2 * capacity / 3, capacity);
+        }
+
+        uint32_t offset = 0;
+        uint32_t count = 0;
+        while (offset + sizeof(FileEntry) <= size)
+        {
+            FileEntry* record = (FileEntry*) (records + offset);
+            uint32_t record_size = sizeof(FileEntry) + record->m_URISize;
+            if (record->m_URISize > MAX_URI_LEN + 8 || (record->m_URISize & 7) != 0 || offset + record_size > size)
+                break;
+
+            uint64_t record_checksum = record->m_RecordChecksum;
+            record->m_RecordChecksum = 0;
+            if (dmHashBuffer64(record, record_size) != record_checksum)
+                break;
+
+            const char* uri = (const char*) (record + 1);
+            bool removed = record->m_IdentifierHash == 0;
+            if (!removed && (record->m_URISize == 0 || uri[record->m_URISize - 1] != '\0'))
+                break;
+
+            Stripe* stripe = GetStripe(cache, record->m_UriHash);
+            Entry* entry = stripe->m_CacheTable.Get(record->m_UriHash);
+            if (removed)
+            {
+                if (entry)
+                    stripe->m_CacheTable.Erase(record->m_UriHash);
+            }
+            else
+            {
+                if (entry == 0)
+                {
+                    entry = PutEntry(stripe, record->m_UriHash);
+                    entry->m_Info.m_URI = dmPoolAllocator::Duplicate(stripe->m_StringAllocator, uri);
+                }
+                memcpy(entry->m_Info.m_ETag, record->m_ETag, sizeof(entry->m_Info.m_ETag));
+                entry->m_Info.m_IdentifierHash = record->m_IdentifierHash;
+                entry->m_Info.m_LastAccessed = record->m_LastAccessed;
+                entry->m_Info.m_Expires = record->m_Expires;
+                entry->m_Info.m_Checksum = record->m_Checksum;
+            }
+
+            offset += record_size;
+            ++count;
+        }
+
+        *record_count = count;
+        return offset;
+    }
+
+    struct ExpiredEntry
+    {
+        uint64_t m_UriHash;
+        uint64_t m_IdentifierHash;
+    };
+
+    struct ExpiredContext
+    {
+        uint64_t               m_Time;
+        uint64_t               m_MaxAge;
+        dmArray<ExpiredEntry>  m_Expired;
+    };
+
+    static void FindExpired(ExpiredContext* context, const uint64_t* key, Entry* entry)
+    {
+        if (entry->m_Info.m_LastAccessed + context->m_MaxAge < context->m_Time)
+        {
+            if (context->m_Expired.Full())
+            {
+                context->m_Expired.OffsetCapacity(64);
+            }
+            ExpiredEntry expired = { *key, entry->m_Info.m_IdentifierHash };
+            context->m_Expired.Push(expired);
+        }
+    }
+
+    static void RemoveExpiredEntries(HCache cache)
+    {
+        ExpiredContext context;
+        context.m_Time = dmTime::GetTime();
+        context.m_MaxAge = cache->m_MaxCacheEntryAge;
+
+        for (uint32_t i = 0; i < STRIPE_COUNT; ++i)
+        {
+            Stripe* stripe = &cache->m_Stripes[i];
+            dmMutex::ScopedLock lock(stripe->m_Mutex);
+            context.m_Expired.SetSize(0);
+            stripe->m_CacheTable.Iterate(&FindExpired, &context);
+
+            for (uint32_t j = 0; j < context.m_Expired.Size(); ++j)
+            {
+                RemoveCachedContentFile(cache, context.m_Expired[j].m_IdentifierHash);
+                EraseEntry(cache, stripe, context.m_Expired[j].m_UriHash);
+            }
+        }
+    }
+
     Result Open(NewParams* params, HCache* cache)
     {
         const char* path = params->m_Path;
@@ -238,155 +449,201 @@ namespace dmHttpCache
             }
             else
             {
-                uint64_t checksum = dmHashBuffer64((void*) (((uintptr_t) buffer) + sizeof(IndexHeader)), size - sizeof(IndexHeader));
-                if (checksum != header->m_Checksum)
+                uint32_t records_size = size - sizeof(IndexHeader);
+                uint32_t record_count = 0;
+                uint32_t valid_size = LoadIndex(c, (uint8_t*) buffer + sizeof(IndexHeader), records_size, &record_count);
+                c->m_IndexRecords = record_count;
+                c->m_IndexValid = valid_size == records_size;
+                if (!c->m_IndexValid)
                 {
-                    dmLogError("Corrupt cache index file '%s'. Removing file.", cache_file);
-                }
-                else
-                {
-                    uint32_t n_entries = (size - sizeof(IndexHeader)) / sizeof(FileEntry);
-                    FileEntry* entries = (FileEntry*) (((uintptr_t) buffer) + sizeof(IndexHeader));
-                    uint32_t capacity = n_entries + 128;
-                    c->m_CacheTable.SetCapacity(2 * capacity / 3, capacity);
-                    uint64_t current_time = dmTime::GetTime();
-                    for (uint32_t i = 0; i < n_entries; ++i)
-                    {
-                        if (entries[i].m_LastAccessed + c->m_MaxCacheEntryAge >= current_time)
-                        {
-                            // Keep cache entry, ie within max age
-                            Entry e;
-                            memcpy(e.m_Info.m_ETag, entries[i].m_ETag, sizeof(e.m_Info.m_ETag));
-                            e.m_Info.m_URI = dmPoolAllocator::Duplicate(c->m_StringAllocator, entries[i].m_URI);
-                            e.m_Info.m_IdentifierHash = entries[i].m_IdentifierHash;
-                            e.m_Info.m_LastAccessed = entries[i].m_LastAccessed;
-                            e.m_Info.m_Expires = entries[i].m_Expires;
-                            e.m_Info.m_Checksum = entries[i].m_Checksum;
-                            c->m_CacheTable.Put(entries[i].m_UriHash, e);
-                        }
-                        else
-                        {
-                            // Remove old cache entry
-                            RemoveCachedContentFile(c, entries[i].m_IdentifierHash);
-                        }
-                    }
+                    // Keep the records up to the damaged one. The file is rewritten on next flush
+                    dmLogError("Corrupt cache index file '%s'. Ignoring %u trailing bytes.", cache_file, records_size - valid_size);
+                    c->m_Dirty = true;
                 }
             }
             free(buffer);
             fclose(f);
         }
 
+        RemoveExpiredEntries(c);
+
         *cache = c;
         return RESULT_OK;
     }
 
-    struct WriteEntryContext
+    static void AppendRecord(dmArray<uint8_t>& buffer, uint64_t uri_hash, const EntryInfo* info)
     {
-        FILE* m_File;
-        bool m_Error;
-        HashState64 m_HashState;
-        WriteEntryContext(FILE* f)
+        uint32_t uri_length = info ? strlen(info->m_URI) + 1 : 0;
+        uint32_t uri_size = (uri_length + 7) & ~7U;
+        uint32_t record_size = sizeof(FileEntry) + uri_size;
+        if (buffer.Remaining() < record_size)
         {
-            m_File = f;
-            m_Error = false;
-            dmHashInit64(&m_HashState, false);
+            buffer.OffsetCapacity(dmMath::Max(record_size, buffer.Capacity()));
         }
-    };
 
-    static void WriteEntry(WriteEntryContext* context, const uint64_t* key, Entry* entry)
-    {
-        if (context->m_Error)
-            return;
+        uint8_t* data = buffer.End();
+        buffer.SetSize(buffer.Size() + record_size);
+        memset(data, 0, record_size);
 
-        if(entry->m_WriteLock)
+        FileEntry* record = (FileEntry*) data;
+        record->m_UriHash = uri_hash;
+        record->m_URISize = uri_size;
+        if (info)
         {
-            dmLogWarning("Invalid http cache state. Not yet flushed cache entry (etag: %s).", entry->m_Info.m_ETag);
-            return;
+            memcpy(record->m_ETag, info->m_ETag, sizeof(record->m_ETag));
+            record->m_IdentifierHash = info->m_IdentifierHash;
+            record->m_LastAccessed = info->m_LastAccessed;
+            record->m_Expires = info->m_Expires;
+            record->m_Checksum = info->m_Checksum;
+            memcpy(data + sizeof(FileEntry), info->m_URI, uri_length);
         }
+        record->m_RecordChecksum = dmHashBuffer64(data, record_size);
+    }
 
-        FileEntry file_entry;
-        memset(&file_entry, 0, sizeof(file_entry));
+    struct CollectRecordsContext
+    {
+        dmArray<uint8_t> m_Buffer;
+        uint32_t         m_Count;
+        bool             m_All;
+    };
 
-        file_entry.m_UriHash = *key;
-        memcpy(file_entry.m_ETag, entry->m_Info.m_ETag, sizeof(file_entry.m_ETag));
-        dmStrlCpy(file_entry.m_URI, entry->m_Info.m_URI, sizeof(file_entry.m_URI));
-        file_entry.m_IdentifierHash = entry->m_Info.m_IdentifierHash;
-        file_entry.m_LastAccessed = entry->m_Info.m_LastAccessed;
-        file_entry.m_Expires = entry->m_Info.m_Expires;
-        file_entry.m_Checksum = entry->m_Info.m_Checksum;
+    static void CollectRecord(CollectRecordsContext* context, const uint64_t* key, Entry* entry)
+    {
+        // Entries being created are written when completed, see End()
+        if (entry->m_WriteLock)
+            return;
 
-        dmHashUpdateBuffer64(&context->m_HashState, &file_entry, sizeof(file_entry));
-        size_t n_written = fwrite(&file_entry, 1, sizeof(file_entry), context->m_File);
-        if (n_written != sizeof(file_entry))
+        if (context->m_All || entry->m_IndexDirty)
         {
-            context->m_Error = true;
+            AppendRecord(context->m_Buffer, *key, &entry->m_Info);
+            entry->m_IndexDirty = 0;
+            context->m_Count++;
         }
     }
 
-    static Result WriteIndex(HCache cache, FILE* f)
+    static Result WriteIndex(HCache cache, FILE* f, dmArray<uint8_t>& records, bool write_header)
     {
-        IndexHeader header;
-
-        header.m_Magic = MAGIC;
-        header.m_Version = VERSION;
-        header.m_Checksum = 0;
-        header.m_SizeOfEntry = (uint32_t)sizeof(Entry);
-        header.m_SizeOfFileEntry = (uint32_t)sizeof(FileEntry);
-        size_t n_written = fwrite(&header, 1, sizeof(header), f);
-        if (n_written != sizeof(header))
+        if (write_header)
         {
-            return RESULT_IO_ERROR;
-        }
-        else
-        {
-            WriteEntryContext context(f);
-            cache->m_CacheTable.Iterate(&WriteEntry, &context);
-            if (context.m_Error)
+            IndexHeader header;
+            header.m_Magic = MAGIC;
+            header.m_Version = VERSION;
+            header.m_SizeOfEntry = (uint32_t)sizeof(Entry);
+            header.m_SizeOfFileEntry = (uint32_t)sizeof(FileEntry);
+            size_t n_written = fwrite(&header, 1, sizeof(header), f);
+            if (n_written != sizeof(header))
             {
                 return RESULT_IO_ERROR;
             }
-            else
-            {
-                // Rewrite header with checksum
-                fseek(f, 0, SEEK_SET);
-                header.m_Checksum = dmHashFinal64(&context.m_HashState);
-                size_t n_written = fwrite(&header, 1, sizeof(header), f);
-                if (n_written != sizeof(header))
-                {
-                    return RESULT_IO_ERROR;
-                }
-            }
+        }
+
+        if (records.Empty())
+        {
+            return RESULT_OK;
+        }
+
+        size_t n_written = fwrite(records.Begin(), 1, records.Size(), f);
+        if (n_written != records.Size())
+        {
+            return RESULT_IO_ERROR;
         }
         return RESULT_OK;
     }
 
     Result Flush(HCache cache)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-        if (!cache->m_Dirty) {
-            return RESULT_OK;
+        dmMutex::ScopedLock index_lock(cache->m_IndexMutex);
+
+        dmArray<uint64_t> removed;
+        {
+            dmMutex::ScopedLock lock(cache->m_Mutex);
+            if (!cache->m_Dirty) {
+                return RESULT_OK;
+            }
+            cache->m_Dirty = false;
+            removed.Swap(cache->m_Removed);
         }
 
-        cache->m_Dirty = false;
         dmLogInfo("Flushing http cache to disk");
 
+        // Rewrite the whole index when it's damaged or mostly consists of stale records.
+        // Otherwise only the changes are appended
+        uint32_t entry_count = GetEntryCount(cache);
+        bool rewrite = !cache->m_IndexValid || cache->m_IndexRecords > 2 * entry_count + INDEX_COMPACT_SLACK;
+
+        CollectRecordsContext context;
+        context.m_Count = 0;
+        context.m_All = rewrite;
+        if (!rewrite)
+        {
+            for (uint32_t i = 0; i < removed.Size(); ++i)
+            {
+                AppendRecord(context.m_Buffer, removed[i], 0);
+                context.m_Count++;
+            }
+        }
+
+        for (uint32_t i = 0; i < STRIPE_COUNT; ++i)
+        {
+            Stripe* stripe = &cache->m_Stripes[i];
+            dmMutex::ScopedLock lock(stripe->m_Mutex);
+            stripe->m_CacheTable.Iterate(&CollectRecord, &context);
+        }
+
         char cache_file[DMPATH_MAX_PATH];
         dmSnPrintf(cache_file, sizeof(cache_file), "%s/%s", cache->m_Path, "index");
-        FILE* f = fopen(cache_file, "wb");
-        if (f) {
-            Result r = WriteIndex(cache, f);
-            fclose(f);
-            if (r != RESULT_OK) {
-                dmLogError("Error writing to index file '%s'", cache_file);
-                dmSys::Unlink(cache_file);
-                return RESULT_IO_ERROR;
+
+        Result r;
+        if (rewrite)
+        {
+            char temp_file[DMPATH_MAX_PATH];
+            dmSnPrintf(temp_file, sizeof(temp_file), "%s/%s", cache->m_Path, "index.tmp");
+            FILE* f = fopen(temp_file, "wb");
+            if (f) {
+                r = WriteIndex(cache, f, context.m_Buffer, true);
+                fclose(f);
+                if (r == RESULT_OK && dmSys::MoveFile(cache_file, temp_file) != dmSys::RESULT_OK) {
+                    r = RESULT_IO_ERROR;
+                }
+                if (r != RESULT_OK) {
+                    dmLogError("Error writing to index file '%s'", cache_file);
+                    dmSys::Unlink(temp_file);
+                }
+            } else {
+                dmLogError("Unable to open index file '%s'", temp_file);
+                r = RESULT_IO_ERROR;
+            }
+
+            if (r == RESULT_OK) {
+                cache->m_IndexRecords = context.m_Count;
+                cache->m_IndexValid = true;
             }
-        } else {
-            dmLogError("Unable to open index file '%s'", cache_file);
-            return RESULT_IO_ERROR;
         }
+        else
+        {
+            FILE* f = fopen(cache_file, "ab");
+            if (f) {
+                r = WriteIndex(cache, f, context.m_Buffer, false);
+                fclose(f);
+                if (r != RESULT_OK) {
+                    dmLogError("Error writing to index file '%s'", cache_file);
+                }
+            } else {
+                dmLogError("Unable to open index file '%s'", cache_file);
+                r = RESULT_IO_ERROR;
+            }
 
-        return RESULT_OK;
+            if (r == RESULT_OK) {
+                cache->m_IndexRecords += context.m_Count;
+            }
+        }
+
+        if (r != RESULT_OK) {
+            // The dirty flags are already cleared. Write everything on next flush
+            cache->m_IndexValid = false;
+            SetDirty(cache);
+        }
+        return r;
     }
 
     Result Close(HCache cache)
@@ -412,7 +669,6 @@ namespace dmHttpCache
 
     Result Begin(HCache cache, const char* uri, const char* etag, uint32_t max_age, HCacheCreator* cache_creator)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
         *cache_creator = 0;
 
         if (etag[0] == '\0' && max_age == 0) {
@@ -421,14 +677,12 @@ namespace dmHttpCache
         }
 
         uint64_t uri_hash = dmHashString64(uri);
+        uint64_t identifier_hash = GetIdentifierHash(uri, etag);
 
-        HashState64 hash_state;
-        dmHashInit64(&hash_state, false);
-        dmHashUpdateBuffer64(&hash_state, uri, strlen(uri));
-        dmHashUpdateBuffer64(&hash_state, etag, strlen(etag));
-        uint64_t identifier_hash = dmHashFinal64(&hash_state);
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
 
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
+        Entry* entry = stripe->m_CacheTable.Get(uri_hash);
         if (entry)
         {
             // NOTE: Empty string is "no" etag so cache updates with identical tag is valid only for empty etag
@@ -454,18 +708,11 @@ namespace dmHttpCache
         else
         {
             // New entry
-            Entry new_entry;
-            if (cache->m_CacheTable.Full())
-            {
-                uint32_t new_capacity = cache->m_CacheTable.Capacity() + 128;
-                cache->m_CacheTable.SetCapacity(dmMath::Max(1U, 2 * new_capacity / 3), new_capacity);
-            }
-            cache->m_CacheTable.Put(uri_hash, new_entry);
+            entry = PutEntry(stripe, uri_hash);
+            entry->m_Info.m_URI = dmPoolAllocator::Duplicate(stripe->m_StringAllocator, uri);
         }
 
-        entry = cache->m_CacheTable.Get(uri_hash);
         dmStrlCpy(entry->m_Info.m_ETag, etag, sizeof(entry->m_Info.m_ETag));
-        entry->m_Info.m_URI = dmPoolAllocator::Duplicate(cache->m_StringAllocator, uri);
         entry->m_Info.m_IdentifierHash = identifier_hash;
         entry->m_Info.m_LastAccessed = dmTime::GetTime();
         if (max_age > 0) {
@@ -476,11 +723,15 @@ namespace dmHttpCache
         }
         entry->m_WriteLock = 1;
 
-        if (cache->m_CacheCreatorsPool.Remaining() == 0)
+        uint16_t index;
         {
-            return RESULT_OUT_OF_RESOURCES;
+            dmMutex::ScopedLock creators_lock(cache->m_Mutex);
+            if (cache->m_CacheCreatorsPool.Remaining() == 0)
+            {
+                return RESULT_OUT_OF_RESOURCES;
+            }
+            index = cache->m_CacheCreatorsPool.Pop();
         }
-        uint16_t index = cache->m_CacheCreatorsPool.Pop();
 
         int file_name_len = strlen(cache->m_Path) + 1 /* slash */ + 8 /* tempXXXX */ + 1 /* '\0' */;
         char* file_name = (char*) malloc(file_name_len);
@@ -490,6 +741,7 @@ namespace dmHttpCache
         {
             dmLogError("Unable to open temporary file: '%s'", file_name);
             free(file_name);
+            dmMutex::ScopedLock creators_lock(cache->m_Mutex);
             cache->m_CacheCreatorsPool.Push(index);
             return RESULT_IO_ERROR;
         }
@@ -500,7 +752,7 @@ namespace dmHttpCache
         handle->m_File = f;
         handle->m_Filename = file_name;
         handle->m_IdentifierHash = identifier_hash;
-        handle->m_UriHash = dmHashString64(uri);
+        handle->m_UriHash = uri_hash;
         handle->m_Error = 0;
         *cache_creator = handle;
 
@@ -530,11 +782,13 @@ namespace dmHttpCache
             free(cache_creator->m_Filename);
         }
 
-        cache->m_CacheCreatorsPool.Push(cache_creator->m_Index);
-
+        uint16_t index = cache_creator->m_Index;
         cache_creator->m_File = 0;
         cache_creator->m_Filename = 0;
         cache_creator->m_Index = 0xffff;
+
+        dmMutex::ScopedLock lock(cache->m_Mutex);
+        cache->m_CacheCreatorsPool.Push(index);
     }
 
     Result Add(HCache cache, HCacheCreator cache_creator, const void* content, uint32_t content_len)
@@ -560,8 +814,6 @@ namespace dmHttpCache
 
     Result End(HCache cache, HCacheCreator cache_creator)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         assert(cache_creator->m_File && cache_creator->m_Filename);
         uint64_t identifier_hash = cache_creator->m_IdentifierHash;
 
@@ -569,13 +821,16 @@ namespace dmHttpCache
         cache_creator->m_File = 0;
 
         uint64_t uri_hash = cache_creator->m_UriHash;
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
+
+        Entry* entry = stripe->m_CacheTable.Get(uri_hash);
         assert(entry);
 
         if (cache_creator->m_Error)
         {
             FreeCacheCreator(cache, cache_creator);
-            cache->m_CacheTable.Erase(uri_hash);
+            EraseEntry(cache, stripe, uri_hash);
             return RESULT_IO_ERROR;
         }
 
@@ -589,7 +844,7 @@ namespace dmHttpCache
             {
                 dmLogError("Unable to remove cache file: %s", path);
                 FreeCacheCreator(cache, cache_creator);
-                cache->m_CacheTable.Erase(uri_hash);
+                EraseEntry(cache, stripe, uri_hash);
                 return RESULT_IO_ERROR;
             }
         }
@@ -609,7 +864,7 @@ namespace dmHttpCache
                 {
                     dmLogError("Unable to create directory '%s'", path);
                     FreeCacheCreator(cache, cache_creator);
-                    cache->m_CacheTable.Erase(uri_hash);
+                    EraseEntry(cache, stripe, uri_hash);
                     return RESULT_IO_ERROR;
                 }
             }
@@ -628,22 +883,23 @@ namespace dmHttpCache
             char* error_msg = strerror(errno);
             dmLogError("Unable to rename temporary cache file from '%s' to '%s'. %s (%d)", cache_creator->m_Filename, path, error_msg, errno);
             FreeCacheCreator(cache, cache_creator);
-            cache->m_CacheTable.Erase(uri_hash);
+            EraseEntry(cache, stripe, uri_hash);
             return RESULT_IO_ERROR;
         }
 
         FreeCacheCreator(cache, cache_creator);
-        cache->m_Dirty = true;
+        MarkEntryDirty(cache, entry);
 
         return RESULT_OK;
     }
 
     Result GetETag(HCache cache, const char* uri, char* tag_buffer, uint32_t tag_buffer_len)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         uint64_t uri_hash = dmHashString64(uri);
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
+
+        Entry* entry = stripe->m_CacheTable.Get(uri_hash);
         if (entry != 0)
         {
             if (entry->m_Info.m_ETag[0]) {
@@ -661,10 +917,11 @@ namespace dmHttpCache
 
     Result GetInfo(HCache cache, const char* uri, EntryInfo* info)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-
         uint64_t uri_hash = dmHashString64(uri);
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
+
+        Entry* entry = stripe->m_CacheTable.Get(uri_hash);
         if (entry != 0)
         {
             memcpy(info, &entry->m_Info, sizeof(*info));
@@ -677,93 +934,224 @@ namespace dmHttpCache
         }
     }
 
-    Result Get(HCache cache, const char* uri, const char* etag, FILE** file, uint64_t* checksum)
+    /*
+     * Find the entry for uri and etag and make sure it's readable.
+     * NOTE: The stripe lock must be held
+     */
+    static Result LockEntryForRead(HCache cache, Stripe* stripe, uint64_t uri_hash, uint64_t identifier_hash, Entry** out_entry)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
+        Entry* entry = stripe->m_CacheTable.Get(uri_hash);
+        if (entry == 0 || entry->m_Info.m_IdentifierHash != identifier_hash)
+        {
+            return RESULT_NO_ENTRY;
+        }
 
-        HashState64 hash_state;
-        dmHashInit64(&hash_state, false);
-        dmHashUpdateBuffer64(&hash_state, uri, strlen(uri));
-        dmHashUpdateBuffer64(&hash_state, etag, strlen(etag));
-        uint64_t identifier_hash = dmHashFinal64(&hash_state);
+        if (entry->m_WriteLock)
+        {
+            dmLogWarning("Cache entry locked.");
+            return RESULT_LOCKED;
+        }
 
+        // The access time is persisted on the next flush, but doesn't by itself make the index dirty
+        entry->m_Info.m_LastAccessed = dmTime::GetTime();
+        entry->m_IndexDirty = 1;
+        *out_entry = entry;
+        return RESULT_OK;
+    }
+
+    Result Get(HCache cache, const char* uri, const char* etag, FILE** file, uint64_t* checksum)
+    {
+        uint64_t identifier_hash = GetIdentifierHash(uri, etag);
         uint64_t uri_hash = dmHashString64(uri);
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
-        if (entry != 0 && entry->m_Info.m_IdentifierHash == identifier_hash)
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
+
+        Entry* entry;
+        Result r = LockEntryForRead(cache, stripe, uri_hash, identifier_hash, &entry);
+        if (r != RESULT_OK)
         {
-            if (entry->m_WriteLock)
-            {
-                dmLogWarning("Cache entry locked.");
-                return RESULT_LOCKED;
-            }
+            return r;
+        }
 
-            entry->m_Info.m_LastAccessed = dmTime::GetTime();
+        char path[DMPATH_MAX_PATH];
+        ContentFilePath(cache, identifier_hash, path, sizeof(path));
+        FILE* f = fopen(path, "rb");
+        if (f)
+        {
+            *file = f;
+            entry->m_ReadLockCount++;
+            *checksum = entry->m_Info.m_Checksum;
+            return RESULT_OK;
+        }
+        else
+        {
+            dmLogError("Unable to open %s", path);
+            // Remove invalid cache entry
+            EraseEntry(cache, stripe, uri_hash);
+            return RESULT_NO_ENTRY;
+        }
+    }
 
-            char path[DMPATH_MAX_PATH];
-            ContentFilePath(cache, identifier_hash, path, sizeof(path));
-            FILE* f = fopen(path, "rb");
-            if (f)
-            {
-                *file = f;
-                entry->m_ReadLockCount++;
-                *checksum = entry->m_Info.m_Checksum;
-                return RESULT_OK;
-            }
-            else
-            {
-                dmLogError("Unable to open %s", path);
-                // Remove invalid cache entry
-                cache->m_CacheTable.Erase(uri_hash);
-                return RESULT_NO_ENTRY;
-            }
+    static bool MapContentFile(const char* path, const void** data, uint32_t* data_size)
+    {
+#if DM_HTTP_CACHE_MMAP
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat stat_data;
+        if (fstat(fd, &stat_data) != 0)
+        {
+            close(fd);
+            return false;
         }
 
-        return RESULT_NO_ENTRY;
+        if (stat_data.st_size == 0)
+        {
+            // Zero length mappings aren't allowed
+            close(fd);
+            *data = "";
+            *data_size = 0;
+            return true;
+        }
+
+        void* map = mmap(0, stat_data.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+        {
+            return false;
+        }
+
+        *data = map;
+        *data_size = (uint32_t) stat_data.st_size;
+        return true;
+#else
+        FILE* f = fopen(path, "rb");
+        if (f == 0)
+        {
+            return false;
+        }
+
+        fseek(f, 0, SEEK_END);
+        size_t size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        void* buffer = malloc(size + 1);
+        size_t nread = fread(buffer, 1, size, f);
+        fclose(f);
+        if (nread != size)
+        {
+            free(buffer);
+            return false;
+        }
+
+        *data = buffer;
+        *data_size = (uint32_t) size;
+        return true;
+#endif
     }
 
-    Result SetVerified(HCache cache, const char* uri, bool verified)
+    static void UnmapContentFile(const void* data, uint32_t data_size)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
+#if DM_HTTP_CACHE_MMAP
+        if (data_size > 0)
+        {
+            munmap((void*) data, data_size);
+        }
+#else
+        free((void*) data);
+#endif
+    }
 
+    Result GetMapped(HCache cache, const char* uri, const char* etag, const void** data, uint32_t* data_size, uint64_t* checksum)
+    {
+        uint64_t identifier_hash = GetIdentifierHash(uri, etag);
         uint64_t uri_hash = dmHashString64(uri);
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
-        if (entry != 0)
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
+
+        Entry* entry;
+        Result r = LockEntryForRead(cache, stripe, uri_hash, identifier_hash, &entry);
+        if (r != RESULT_OK)
         {
-            entry->m_Info.m_Verified = verified;
+            return r;
+        }
+
+        char path[DMPATH_MAX_PATH];
+        ContentFilePath(cache, identifier_hash, path, sizeof(path));
+        if (MapContentFile(path, data, data_size))
+        {
+            entry->m_ReadLockCount++;
+            *checksum = entry->m_Info.m_Checksum;
             return RESULT_OK;
         }
         else
         {
+            dmLogError("Unable to map %s", path);
+            // Remove invalid cache entry
+            EraseEntry(cache, stripe, uri_hash);
             return RESULT_NO_ENTRY;
         }
     }
 
-    Result Release(HCache cache, const char* uri, const char* etag, FILE* file)
+    Result SetVerified(HCache cache, const char* uri, bool verified)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
+        uint64_t uri_hash = dmHashString64(uri);
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
 
-        HashState64 hash_state;
-        dmHashInit64(&hash_state, false);
-        dmHashUpdateBuffer64(&hash_state, uri, strlen(uri));
-        dmHashUpdateBuffer64(&hash_state, etag, strlen(etag));
-        uint64_t identifier_hash = dmHashFinal64(&hash_state);
+        Entry* entry = stripe->m_CacheTable.Get(uri_hash);
+        if (entry != 0)
+        {
+            entry->m_Info.m_Verified = verified;
+            return RESULT_OK;
+        }
+        else
+        {
+            return RESULT_NO_ENTRY;
+        }
+    }
 
+    static void UnlockEntryForRead(HCache cache, const char* uri, const char* etag)
+    {
+        uint64_t identifier_hash = GetIdentifierHash(uri, etag);
         uint64_t uri_hash = dmHashString64(uri);
-        Entry* entry = cache->m_CacheTable.Get(uri_hash);
+        Stripe* stripe = GetStripe(cache, uri_hash);
+        dmMutex::ScopedLock lock(stripe->m_Mutex);
+
+        Entry* entry = stripe->m_CacheTable.Get(uri_hash);
         assert(entry);
         assert(entry->m_Info.m_IdentifierHash == identifier_hash);
         assert(strcmp(uri, entry->m_Info.m_URI) == 0);
         assert(entry->m_ReadLockCount > 0);
         --entry->m_ReadLockCount;
+    }
 
+    Result Release(HCache cache, const char* uri, const char* etag, FILE* file)
+    {
+        UnlockEntryForRead(cache, uri, etag);
         fclose(file);
         return RESULT_OK;
     }
 
+    Result ReleaseMapped(HCache cache, const char* uri, const char* etag, const void* data, uint32_t data_size)
+    {
+        UnlockEntryForRead(cache, uri, etag);
+        UnmapContentFile(data, data_size);
+        return RESULT_OK;
+    }
+
     uint32_t GetEntryCount(HCache cache)
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
-        return cache->m_CacheTable.Size();
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < STRIPE_COUNT; ++i)
+        {
+            Stripe* stripe = &cache->m_Stripes[i];
+            dmMutex::ScopedLock lock(stripe->m_Mutex);
+            count += stripe->m_CacheTable.Size();
+        }
+        return count;
     }
 
     struct IterateContext
@@ -799,9 +1187,13 @@ namespace dmHttpCache
 
     void Iterate(HCache cache, void* context, void (*call_back)(void* context, const EntryInfo* entry_info))
     {
-        dmMutex::ScopedLock lock(cache->m_Mutex);
         IterateContext iterate_context(cache, context, call_back);
-        cache->m_CacheTable.Iterate(&IterateCallback, &iterate_context);
+        for (uint32_t i = 0; i < STRIPE_COUNT; ++i)
+        {
+            Stripe* stripe = &cache->m_Stripes[i];
+            dmMutex::ScopedLock lock(stripe->m_Mutex);
+            stripe->m_CacheTable.Iterate(&IterateCallback, &iterate_context);
+        }
     }
 
 }
@@ -116,6 +116,8 @@ namespace dmHttpCache
 
     /**
      * Flush index to disk. Flush will only write to disk when the index is dirty.
+     * Entries changed since the last flush are appended to the index file. The file
+     * is rewritten only when it has grown to contain mostly stale records.
      * @param cache http cache handle
      * @return RESULT_OK on success
      */
@@ -201,6 +203,30 @@ namespace dmHttpCache
      */
     Result Release(HCache cache, const char* uri, const char* etag, FILE* file);
 
+    /**
+     * Get content of cache entry mapped into memory. Memory mapped where supported,
+     * otherwise the content is read into a heap buffer.
+     * @param cache cache
+     * @param uri uri
+     * @param etag etag
+     * @param data pointer to the cached content (out). Valid until ReleaseMapped is called
+     * @param data_size content size (out)
+     * @param checksum content checksum (dmHashString64)
+     * @return RESULT_OK on success.
+     */
+    Result GetMapped(HCache cache, const char* uri, const char* etag, const void** data, uint32_t* data_size, uint64_t* checksum);
+
+    /**
+     * Release cache entry content, see GetMapped.
+     * @param cache cache
+     * @param uri uri
+     * @param etag etag
+     * @param data content pointer returned by GetMapped
+     * @param data_size content size returned by GetMapped
+     * @return RESULT_OK on success.
+     */
+    Result ReleaseMapped(HCache cache, const char* uri, const char* etag, const void* data, uint32_t data_size);
+
     /**
      * Get total entry count in cache
      * @param cache http cache handle
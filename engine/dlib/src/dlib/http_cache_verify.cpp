@@ -18,103 +18,118 @@
 #include "log.h"
 #include "time.h"
 #include "math.h"
+#include "array.h"
+#include "atomic.h"
+#include "thread.h"
 #include "dstrings.h"
 #include "http_cache_verify.h"
 
 namespace dmHttpCacheVerify
 {
     const uint32_t BUFFER_SIZE = 512;
+    // Maximum number of concurrent verification connections
+    const uint32_t MAX_CONNECTIONS = 8;
+
+    /*
+     * A batch of entries to verify, stored as the request body, ie
+     * URI <SPACE> ETAG'\n' for every entry
+     */
+    struct Batch
+    {
+        dmArray<char> m_Data;
+        uint32_t      m_Count;
+
+        Batch()
+        {
+            m_Count = 0;
+        }
+    };
+
     struct VerifyContext
     {
-        dmHttpClient::HClient   m_Client;
-        dmHttpClient::HResponse m_Response;
         dmHttpCache::HCache     m_HttpCache;
-        uint64_t                m_MaxAge;
-        uint64_t                m_CurrentTime;
-        uint32_t                m_BytesWritten;
-        dmHttpClient::Result    m_Result;
+        Batch*                  m_Batch;
+        int32_atomic_t*         m_Reused;
         char                    m_Buffer[BUFFER_SIZE + 1]; // Room for terminating '\0'
         char*                   m_BufferCurrent;
-        uint32_t                m_BufferSize;
-        bool                    m_DryRun;
         int                     m_HttpStatus;
 
-        VerifyContext(uint64_t max_age)
+        VerifyContext(dmHttpCache::HCache cache, Batch* batch, int32_atomic_t* reused)
         {
             memset(this, 0, sizeof(*this));
+            m_HttpCache = cache;
+            m_Batch = batch;
+            m_Reused = reused;
             m_BufferCurrent = m_Buffer;
-            m_MaxAge = max_age;
-            m_CurrentTime = dmTime::GetTime();
-            m_Result = dmHttpClient::RESULT_OK;
         }
     };
 
-    static void VerifyCallback(void* context, const dmHttpCache::EntryInfo* entry_info)
+    struct CollectContext
     {
-        VerifyContext* verify_context = (VerifyContext*) context;
-        if (verify_context->m_Result != dmHttpClient::RESULT_OK)
-            return;
+        Batch*   m_Batches;
+        uint32_t m_BatchCount;
+        uint32_t m_NextBatch;
+        uint64_t m_MaxAge;
+        uint64_t m_CurrentTime;
+    };
 
-        if (entry_info->m_LastAccessed + verify_context->m_MaxAge >= verify_context->m_CurrentTime)
+    static void AppendData(dmArray<char>& data, const char* str, uint32_t str_len)
+    {
+        if (data.Remaining() < str_len)
         {
-            // Young enough
-
-            // #path + space + #etag + \n
-            verify_context->m_BytesWritten += strlen(entry_info->m_URI) + 1 + strlen(entry_info->m_ETag) + 1;
-            if (!verify_context->m_DryRun)
-            {
-                dmHttpClient::Result r;
-                r = Write(verify_context->m_Response, entry_info->m_URI, strlen(entry_info->m_URI));
-                if (r != dmHttpClient::RESULT_OK)
-                {
-                    verify_context->m_Result = r;
-                    return;
-                }
+            data.OffsetCapacity(dmMath::Max(str_len, 4096U));
+        }
+        data.PushArray(str, str_len);
+    }
 
-                r = Write(verify_context->m_Response, " ", 1);
-                if (r != dmHttpClient::RESULT_OK)
-                {
-                    verify_context->m_Result = r;
-                    return;
-                }
+    static void CollectCallback(void* context, const dmHttpCache::EntryInfo* entry_info)
+    {
+        CollectContext* collect_context = (CollectContext*) context;
 
-                r = Write(verify_context->m_Response, entry_info->m_ETag, strlen(entry_info->m_ETag));
-                if (r != dmHttpClient::RESULT_OK)
-                {
-                    verify_context->m_Result = r;
-                    return;
-                }
+        if (entry_info->m_LastAccessed + collect_context->m_MaxAge >= collect_context->m_CurrentTime)
+        {
+            // Young enough. Distribute the entries evenly over the batches
+            Batch* batch = &collect_context->m_Batches[collect_context->m_NextBatch];
+            collect_context->m_NextBatch = (collect_context->m_NextBatch + 1) % collect_context->m_BatchCount;
 
-                r = Write(verify_context->m_Response, "\n", 1);
-                if (r != dmHttpClient::RESULT_OK)
-                {
-                    verify_context->m_Result = r;
-                    return;
-                }
-            }
-            else
-            {
-                // Dry run
-            }
+            AppendData(batch->m_Data, entry_info->m_URI, strlen(entry_info->m_URI));
+            AppendData(batch->m_Data, " ", 1);
+            AppendData(batch->m_Data, entry_info->m_ETag, strlen(entry_info->m_ETag));
+            AppendData(batch->m_Data, "\n", 1);
+            batch->m_Count++;
         }
     }
 
+    /*
+     * Collect the entries to verify. The request bodies are created up front in order to
+     * not hold the cache locks while sending
+     */
+    static void CollectBatches(dmHttpCache::HCache cache, uint64_t max_age, Batch* batches, uint32_t batch_count)
+    {
+        CollectContext context;
+        context.m_Batches = batches;
+        context.m_BatchCount = batch_count;
+        context.m_NextBatch = 0;
+        context.m_MaxAge = max_age * 1000000;
+        context.m_CurrentTime = dmTime::GetTime();
+        dmHttpCache::Iterate(cache, &context, &CollectCallback);
+    }
+
     static uint32_t HttpSendContentLength(dmHttpClient::HResponse response, void* user_data)
     {
         VerifyContext* verify_context = (VerifyContext*) user_data;
-        verify_context->m_DryRun = true;
-        verify_context->m_Response = response;
-        dmHttpCache::Iterate(verify_context->m_HttpCache, verify_context, &VerifyCallback);
-        return verify_context->m_BytesWritten;
+        return verify_context->m_Batch->m_Data.Size();
     }
 
     static dmHttpClient::Result HttpWrite(dmHttpClient::HResponse response, uint32_t offset, uint32_t length, void* user_data)
     {
         VerifyContext* verify_context = (VerifyContext*) user_data;
-        verify_context->m_DryRun = false;
-        verify_context->m_Response = response;
-        dmHttpCache::Iterate(verify_context->m_HttpCache, verify_context, &VerifyCallback);
-        return verify_context->m_Result;
+        dmArray<char>& data = verify_context->m_Batch->m_Data;
+        if (data.Empty())
+        {
+            return dmHttpClient::RESULT_OK;
+        }
+        return Write(response, data.Begin(), data.Size());
     }
 
     static void HttpContent(dmHttpClient::HResponse, void* user_data, int status_code, const void* content_data, uint32_t content_data_size)
@@ -142,7 +157,10 @@ namespace dmHttpCacheVerify
                 // New uri
                 // Terminate string, we have room for the extra '\0'
                 *buf_current = '\0';
-                dmHttpCache::SetVerified(verify_context->m_HttpCache, verify_context->m_Buffer, true);
+                if (dmHttpCache::SetVerified(verify_context->m_HttpCache, verify_context->m_Buffer, true) == dmHttpCache::RESULT_OK)
+                {
+                    dmAtomicIncrement32(verify_context->m_Reused);
+                }
 
                 // Reset buffer
                 buf_current = verify_context->m_Buffer;
@@ -166,10 +184,9 @@ namespace dmHttpCacheVerify
         verify_context->m_BufferCurrent = buf_current;
     }
 
-    Result VerifyCache(dmHttpCache::HCache cache, dmURI::Parts* uri, dmDNS::HChannel channel, uint64_t max_age)
+    static Result VerifyBatch(dmHttpCache::HCache cache, dmURI::Parts* uri, dmDNS::HChannel channel, Batch* batch, int32_atomic_t* reused)
     {
-        VerifyContext context(max_age * 1000000);
-        context.m_HttpCache = cache;
+        VerifyContext context(cache, batch, reused);
 
         dmHttpClient::NewParams params;
         params.m_HttpSendContentLength = HttpSendContentLength;
@@ -183,7 +200,6 @@ namespace dmHttpCacheVerify
             return RESULT_OUT_OF_RESOURCES;
         }
 
-        context.m_Client = client;
         dmHttpClient::Result verify_result = Post(client, "/__verify_etags__");
         dmHttpClient::Delete(client);
 
@@ -208,4 +224,141 @@ namespace dmHttpCacheVerify
         }
     }
 
+    Result VerifyCache(dmHttpCache::HCache cache, dmURI::Parts* uri, dmDNS::HChannel channel, uint64_t max_age)
+    {
+        Batch batch;
+        CollectBatches(cache, max_age, &batch, 1);
+        int32_atomic_t reused = 0;
+        return VerifyBatch(cache, uri, channel, &batch, &reused);
+    }
+
+    struct AsyncVerify;
+
+    struct AsyncBatch
+    {
+        AsyncVerify*     m_Verify;
+        Batch            m_Batch;
+        dmThread::Thread m_Thread;
+        Result           m_Result;
+    };
+
+    struct AsyncVerify
+    {
+        dmHttpCache::HCache m_HttpCache;
+        dmURI::Parts        m_URI;
+        AsyncBatch          m_Batches[MAX_CONNECTIONS];
+        uint32_t            m_BatchCount;
+        uint32_t            m_Checked;
+        int32_atomic_t      m_Reused;
+        int32_atomic_t      m_Pending;
+        bool                m_Joined;
+    };
+
+    static void VerifyBatchThread(void* arg)
+    {
+        AsyncBatch* async_batch = (AsyncBatch*) arg;
+        AsyncVerify* verify = async_batch->m_Verify;
+
+        // DNS channels aren't thread safe. Use one per connection
+        dmDNS::HChannel channel = 0;
+        if (dmDNS::NewChannel(&channel) == dmDNS::RESULT_OK)
+        {
+            async_batch->m_Result = VerifyBatch(verify->m_HttpCache, &verify->m_URI, channel, &async_batch->m_Batch, &verify->m_Reused);
+            dmDNS::DeleteChannel(channel);
+        }
+        else
+        {
+            async_batch->m_Result = RESULT_NETWORK_ERROR;
+        }
+
+        dmAtomicDecrement32(&verify->m_Pending);
+    }
+
+    Result VerifyCacheAsync(dmHttpCache::HCache cache, dmURI::Parts* uri, uint64_t max_age, uint32_t max_connections, HAsyncVerify* verify)
+    {
+        AsyncVerify* v = new AsyncVerify;
+        v->m_HttpCache = cache;
+        memcpy(&v->m_URI, uri, sizeof(v->m_URI));
+        v->m_BatchCount = dmMath::Clamp(max_connections, 1U, MAX_CONNECTIONS);
+        v->m_Checked = 0;
+        v->m_Reused = 0;
+        v->m_Joined = false;
+
+        Batch batches[MAX_CONNECTIONS];
+        CollectBatches(cache, max_age, batches, v->m_BatchCount);
+
+        // Skip empty batches, ie when there are fewer entries than connections
+        uint32_t batch_count = 0;
+        for (uint32_t i = 0; i < v->m_BatchCount; ++i)
+        {
+            if (batches[i].m_Count == 0)
+                continue;
+
+            AsyncBatch* async_batch = &v->m_Batches[batch_count++];
+            async_batch->m_Verify = v;
+            async_batch->m_Batch.m_Data.Swap(batches[i].m_Data);
+            async_batch->m_Batch.m_Count = batches[i].m_Count;
+            async_batch->m_Result = RESULT_OK;
+            v->m_Checked += batches[i].m_Count;
+        }
+        v->m_BatchCount = batch_count;
+        v->m_Pending = batch_count;
+
+        for (uint32_t i = 0; i < v->m_BatchCount; ++i)
+        {
+#if defined(__EMSCRIPTEN__)
+            VerifyBatchThread(&v->m_Batches[i]);
+#else
+            v->m_Batches[i].m_Thread = dmThread::New(VerifyBatchThread, 0x80000, &v->m_Batches[i], "httpcacheverify");
+#endif
+        }
+
+        *verify = v;
+        return RESULT_OK;
+    }
+
+    bool IsDone(HAsyncVerify verify)
+    {
+        return dmAtomicAdd32(&verify->m_Pending, 0) == 0;
+    }
+
+    static void Join(HAsyncVerify verify)
+    {
+        if (verify->m_Joined)
+            return;
+
+#if !defined(__EMSCRIPTEN__)
+        for (uint32_t i = 0; i < verify->m_BatchCount; ++i)
+        {
+            dmThread::Join(verify->m_Batches[i].m_Thread);
+        }
+#endif
+        verify->m_Joined = true;
+    }
+
+    Result GetResult(HAsyncVerify verify)
+    {
+        Join(verify);
+        for (uint32_t i = 0; i < verify->m_BatchCount; ++i)
+        {
+            if (verify->m_Batches[i].m_Result != RESULT_OK)
+                return verify->m_Batches[i].m_Result;
+        }
+        return RESULT_OK;
+    }
+
+    void GetStatistics(HAsyncVerify verify, Statistics* statistics)
+    {
+        bool done = IsDone(verify);
+        statistics->m_Checked = verify->m_Checked;
+        statistics->m_Reused = (uint32_t) dmAtomicAdd32(&verify->m_Reused, 0);
+        statistics->m_NotReused = done ? statistics->m_Checked - dmMath::Min(statistics->m_Reused, statistics->m_Checked) : 0;
+    }
+
+    void DeleteAsync(HAsyncVerify verify)
+    {
+        Join(verify);
+        delete verify;
+    }
+
 }
@@ -54,6 +54,70 @@ namespace dmHttpCacheVerify
      */
     Result VerifyCache(dmHttpCache::HCache cache, dmURI::Parts* uri, dmDNS::HChannel channel, uint64_t max_age);
 
+    /**
+     * Asynchronous verification handle
+     */
+    typedef struct AsyncVerify* HAsyncVerify;
+
+    /**
+     * Verification statistics
+     */
+    struct Statistics
+    {
+        /// Number of cache entries sent to the server for verification
+        uint32_t m_Checked;
+        /// Number of entries verified by the server. These are served directly from the cache
+        uint32_t m_Reused;
+        /// Number of entries the server didn't verify, set when completed. These are revalidated when
+        /// requested, and only refetched if they changed
+        uint32_t m_NotReused;
+    };
+
+    /**
+     * Verify HTTP-cache in the background. The entries are split into batches that are
+     * verified in parallel, see VerifyCache() for the protocol. Each batch uses a connection
+     * and a DNS channel of its own.
+     *
+     * The cache may be used while the verification is in progress. Entries not yet verified
+     * are revalidated with a conditional request when requested.
+     *
+     * @param cache cache handle
+     * @param uri uri
+     * @param max_age max-age of resource to verify in seconds
+     * @param max_connections maximum number of concurrent connections
+     * @param verify verification handle (out)
+     * @return RESULT_OK on success
+     */
+    Result VerifyCacheAsync(dmHttpCache::HCache cache, dmURI::Parts* uri, uint64_t max_age, uint32_t max_connections, HAsyncVerify* verify);
+
+    /**
+     * Check if an asynchronous verification is completed
+     * @param verify verification handle
+     * @return true if completed
+     */
+    bool IsDone(HAsyncVerify verify);
+
+    /**
+     * Get the result of an asynchronous verification. Blocks until the verification is completed.
+     * RESULT_UNSUPPORTED is returned if the server lacks support for batch verification.
+     * @param verify verification handle
+     * @return RESULT_OK on success
+     */
+    Result GetResult(HAsyncVerify verify);
+
+    /**
+     * Get verification statistics. The counters are updated while the verification is in progress.
+     * @param verify verification handle
+     * @param statistics statistics (out)
+     */
+    void GetStatistics(HAsyncVerify verify, Statistics* statistics);
+
+    /**
+     * Delete an asynchronous verification. Blocks until the verification is completed.
+     * @param verify verification handle
+     */
+    void DeleteAsync(HAsyncVerify verify);
+
 }
 
 #endif
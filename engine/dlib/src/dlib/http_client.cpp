@@ -855,21 +855,19 @@ bail:
             }
         }
 
-        FILE* file = 0;
+        const void* content = 0;
+        uint32_t content_size = 0;
         uint64_t checksum;
-        cache_result = dmHttpCache::Get(client->m_HttpCache, client->m_URI, cache_etag, &file, &checksum);
+        cache_result = dmHttpCache::GetMapped(client->m_HttpCache, client->m_URI, cache_etag, &content, &content_size, &checksum);
         if (cache_result == dmHttpCache::RESULT_OK)
         {
-            // NOTE: We have an extra byte for null-termination so no buffer overrun here.
-            size_t nread;
-            do
+            // The content is delivered directly from the mapping, followed by the terminating empty call
+            if (content_size > 0)
             {
-                nread = fread(client->m_Buffer, 1, BUFFER_SIZE, file);
-                client->m_Buffer[nread] = '\0';
-                client->m_HttpContent(response, client->m_Userdata, response->m_Status, client->m_Buffer, nread);
+                client->m_HttpContent(response, client->m_Userdata, response->m_Status, content, content_size);
             }
-            while (nread > 0);
-            dmHttpCache::Release(client->m_HttpCache, client->m_URI, cache_etag, file);
+            client->m_HttpContent(response, client->m_Userdata, response->m_Status, client->m_Buffer, 0);
+            dmHttpCache::ReleaseMapped(client->m_HttpCache, client->m_URI, cache_etag, content, content_size);
         }
         else
         {
@@ -1132,22 +1130,19 @@ bail:
         Response response(client);
         client->m_Statistics.m_DirectFromCache++;
 
-        FILE* file = 0;
+        const void* content = 0;
+        uint32_t content_size = 0;
         uint64_t checksum;
 
-        dmHttpCache::Result cache_result = dmHttpCache::Get(client->m_HttpCache, client->m_URI, info->m_ETag, &file, &checksum);
+        dmHttpCache::Result cache_result = dmHttpCache::GetMapped(client->m_HttpCache, client->m_URI, info->m_ETag, &content, &content_size, &checksum);
         if (cache_result == dmHttpCache::RESULT_OK)
         {
-            // NOTE: We have an extra byte for null-termination so no buffer overrun here.
-            size_t nread;
-            do
+            if (content_size > 0)
             {
-                nread = fread(client->m_Buffer, 1, BUFFER_SIZE, file);
-                client->m_Buffer[nread] = '\0';
-                client->m_HttpContent(&response, client->m_Userdata, 304, client->m_Buffer, nread);
+                client->m_HttpContent(&response, client->m_Userdata, 304, content, content_size);
             }
-            while (nread > 0);
-            dmHttpCache::Release(client->m_HttpCache, client->m_URI, info->m_ETag, file);
+            client->m_HttpContent(&response, client->m_Userdata, 304, client->m_Buffer, 0);
+            dmHttpCache::ReleaseMapped(client->m_HttpCache, client->m_URI, info->m_ETag, content, content_size);
             return RESULT_NOT_200_OK;
         }
         else
@@ -1282,3 +1277,11 @@ bail:
     #undef DM_HTTPCLIENT_RESULT_TO_STRING_CASE
 
 } // namespace dmHttpClient
+
+namespace dmHttpClientPrivate
+{
+    dmConnectionPool::HPool GetConnectionPool()
+    {
+        return dmHttpClient::g_PoolCreator.GetPool();
+    }
+} // namespace dmHttpClientPrivate
@@ -283,6 +283,94 @@ namespace dmHttpClient
     */
     void ReopenConnectionPool();
 
+    /**
+     * Multi HTTP-client handle. A multi handle multiplexes many GET-requests over
+     * a small set of non-blocking keep-alive connections from the internal pool and
+     * pipelines requests to the same host on each connection. All network work is
+     * done in MultiUpdate() so a single thread can drive any number of requests.
+     * @note Only plain http is supported. Use the blocking client for https.
+     */
+    typedef struct Multi* HMulti;
+
+    /**
+     * Multi request completion callback. Invoked from MultiUpdate() once for every request
+     * added with MultiGet()
+     * @param multi Multi handle
+     * @param user_data User data passed to MultiGet()
+     * @param result RESULT_OK for status 200, RESULT_NOT_200_OK for other statuses or an error
+     * @param status_code HTTP status code. -1 if no response was received
+     * @param content Response content. Valid during the callback only
+     * @param content_size Response content size
+     */
+    typedef void (*MultiCallback)(HMulti multi, void* user_data, Result result, int status_code, const void* content, uint32_t content_size);
+
+    /**
+     * Multi HTTP-client parameters.
+     * The structure is automatically initialized to default values
+     */
+    struct MultiParams
+    {
+        MultiParams()
+        {
+            m_DNSChannel = 0;
+            m_MaxConnections = 4;
+            m_MaxPipelineDepth = 8;
+            m_MaxRetries = 4;
+            m_RequestTimeout = 0;
+        }
+
+        /// DNS channel used when dialing new connections
+        dmDNS::HChannel m_DNSChannel;
+        /// Maximum number of simultaneous connections. Default is 4.
+        uint32_t m_MaxConnections;
+        /// Maximum number of in-flight requests per connection. Default is 8. Set to 1 to disable pipelining.
+        uint32_t m_MaxPipelineDepth;
+        /// Maximum number of attempts per request when a connection is lost. Default is 4.
+        uint32_t m_MaxRetries;
+        /// Request timeout in us, measured from MultiGet(). 0 means no timeout.
+        int m_RequestTimeout;
+    };
+
+    /**
+     * Create a new multi HTTP-client
+     * @param params Parameters
+     * @return Multi handle
+     */
+    HMulti NewMulti(const MultiParams* params);
+
+    /**
+     * Delete multi HTTP-client. Outstanding requests are dropped without invoking their callbacks.
+     * @param multi Multi handle
+     */
+    void DeleteMulti(HMulti multi);
+
+    /**
+     * Queue a GET-request. The request is sent by a later call to MultiUpdate()
+     * @param multi Multi handle
+     * @param hostname Hostname
+     * @param port Port number
+     * @param path Path part of URI
+     * @param callback Completion callback
+     * @param user_data User data passed to the callback
+     * @return RESULT_OK on success, RESULT_INVAL if the hostname or path is too long
+     */
+    Result MultiGet(HMulti multi, const char* hostname, uint16_t port, const char* path, MultiCallback callback, void* user_data);
+
+    /**
+     * Send and receive on all connections. Completion callbacks are invoked from this function.
+     * @param multi Multi handle
+     * @param timeout Max time in us to wait for socket activity. For blocking pass -1
+     * @return Number of requests not yet completed
+     */
+    uint32_t MultiUpdate(HMulti multi, int32_t timeout);
+
+    /**
+     * Get multi HTTP-client statistics
+     * @param multi Multi handle
+     * @param statistics Pointer to statistics struct
+     */
+    void GetStatistics(HMulti multi, Statistics* statistics);
+
     /**
      * Convert result value to string
      * @param result Result to convert
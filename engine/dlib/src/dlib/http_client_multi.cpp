@@ -0,0 +1,743 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "array.h"
+#include "math.h"
+#include "./socket.h"
+#include "http_client.h"
+#include "http_client_private.h"
+#include "connection_pool.h"
+#include "log.h"
+#include "dstrings.h"
+#include "uri.h"
+#include "time.h"
+
+namespace dmHttpClient
+{
+    // Max size of a response header block
+    const uint32_t MULTI_MAX_HEADER_SIZE = 64 * 1024;
+    const uint32_t MULTI_RECV_SIZE = 16 * 1024;
+
+    struct MultiRequest
+    {
+        char            m_Hostname[dmURI::MAX_LOCATION_LEN];
+        char            m_Path[dmURI::MAX_PATH_LEN];
+        uint16_t        m_Port;
+        MultiCallback   m_Callback;
+        void*           m_UserData;
+        dmArray<char>   m_Content;
+        uint64_t        m_Start;
+        uint32_t        m_Attempts;
+    };
+
+    enum MultiParseState
+    {
+        MULTI_PARSE_STATE_HEADERS,
+        MULTI_PARSE_STATE_BODY,
+        MULTI_PARSE_STATE_BODY_UNTIL_EOF,
+        MULTI_PARSE_STATE_CHUNK_SIZE,
+        MULTI_PARSE_STATE_CHUNK_DATA,
+        MULTI_PARSE_STATE_CHUNK_END,
+        MULTI_PARSE_STATE_CHUNK_TRAILER,
+    };
+
+    struct MultiConnection
+    {
+        dmConnectionPool::HConnection   m_Connection;
+        dmSocket::Socket                m_Socket;
+        char                            m_Hostname[dmURI::MAX_LOCATION_LEN];
+        uint16_t                        m_Port;
+
+        // Requests sent (or queued in m_SendBuffer), oldest first
+        dmArray<MultiRequest*>          m_InFlight;
+        dmArray<char>                   m_SendBuffer;
+        uint32_t                        m_SendOffset;
+        // Received bytes not yet parsed. NOTE: Capacity is kept one byte larger for null-termination
+        dmArray<char>                   m_RecvBuffer;
+        uint32_t                        m_RecvOffset;
+
+        // State for the response currently being parsed, ie for m_InFlight[0]
+        MultiParseState                 m_State;
+        int                             m_Status;
+        int                             m_ContentLength;
+        uint32_t                        m_Remaining;
+        uint32_t                        m_Chunked : 1;
+        uint32_t                        m_CloseConnection : 1;
+    };
+
+    struct Multi
+    {
+        MultiParams                 m_Params;
+        dmConnectionPool::HPool     m_Pool;
+        // Requests waiting for a connection, oldest first
+        dmArray<MultiRequest*>      m_Pending;
+        dmArray<MultiConnection*>   m_Connections;
+        Statistics                  m_Statistics;
+    };
+
+    static void ArrayRemoveFirst(dmArray<MultiRequest*>& array)
+    {
+        uint32_t size = array.Size();
+        assert(size > 0);
+        memmove(array.Begin(), array.Begin() + 1, (size - 1) * sizeof(MultiRequest*));
+        array.SetSize(size - 1);
+    }
+
+    static void ArrayAppend(dmArray<char>& array, const char* data, uint32_t size)
+    {
+        if (array.Remaining() < size)
+        {
+            array.OffsetCapacity(dmMath::Max(size - array.Remaining(), array.Capacity()));
+        }
+        array.PushArray(data, size);
+    }
+
+    static void CompleteRequest(HMulti multi, MultiRequest* request, Result result, int status_code)
+    {
+        request->m_Callback(multi, request->m_UserData, result, status_code, request->m_Content.Begin(), request->m_Content.Size());
+        delete request;
+    }
+
+    // Complete failed requests after the pending queue is compacted as the callbacks may add new requests
+    static void CompleteFailed(HMulti multi, dmArray<MultiRequest*>& failed, Result result)
+    {
+        for (uint32_t i = 0; i < failed.Size(); ++i)
+        {
+            CompleteRequest(multi, failed[i], result, -1);
+        }
+    }
+
+    static void PushFailed(dmArray<MultiRequest*>& failed, MultiRequest* request)
+    {
+        if (failed.Full())
+        {
+            failed.OffsetCapacity(16);
+        }
+        failed.Push(request);
+    }
+
+    static void ResetResponse(MultiConnection* c)
+    {
+        c->m_State = MULTI_PARSE_STATE_HEADERS;
+        c->m_Status = -1;
+        c->m_ContentLength = -1;
+        c->m_Remaining = 0;
+        c->m_Chunked = 0;
+    }
+
+    // Close the connection and put all unanswered requests first in the pending queue, in order.
+    // The oldest request is the one that was on the wire when the connection was lost. It is
+    // charged one attempt and failed with 'result' if it is out of attempts.
+    static void CloseConnection(HMulti multi, uint32_t index, Result result)
+    {
+        MultiConnection* c = multi->m_Connections[index];
+        dmConnectionPool::Close(multi->m_Pool, c->m_Connection);
+
+        uint32_t n = c->m_InFlight.Size();
+        if (n > 0)
+        {
+            MultiRequest* head = c->m_InFlight[0];
+            uint32_t first = 0;
+            if (result != RESULT_OK && ++head->m_Attempts >= multi->m_Params.m_MaxRetries)
+            {
+                CompleteRequest(multi, head, result, -1);
+                first = 1;
+            }
+
+            uint32_t requeue = n - first;
+            if (requeue > 0)
+            {
+                multi->m_Statistics.m_Reconnections++;
+                uint32_t pending = multi->m_Pending.Size();
+                if (multi->m_Pending.Remaining() < requeue)
+                {
+                    multi->m_Pending.OffsetCapacity(requeue);
+                }
+                multi->m_Pending.SetSize(pending + requeue);
+                memmove(multi->m_Pending.Begin() + requeue, multi->m_Pending.Begin(), pending * sizeof(MultiRequest*));
+                for (uint32_t i = 0; i < requeue; ++i)
+                {
+                    MultiRequest* request = c->m_InFlight[first + i];
+                    request->m_Content.SetSize(0);
+                    multi->m_Pending[i] = request;
+                }
+            }
+        }
+
+        delete c;
+        multi->m_Connections.EraseSwap(index);
+    }
+
+    static void ReturnConnection(HMulti multi, uint32_t index)
+    {
+        MultiConnection* c = multi->m_Connections[index];
+        assert(c->m_InFlight.Empty());
+        dmSocket::SetBlocking(c->m_Socket, true);
+        dmConnectionPool::Return(multi->m_Pool, c->m_Connection);
+        delete c;
+        multi->m_Connections.EraseSwap(index);
+    }
+
+    static MultiConnection* Dial(HMulti multi, MultiRequest* request, Result* result)
+    {
+        dmConnectionPool::HConnection connection;
+        dmSocket::Result sock_res = dmSocket::RESULT_OK;
+        dmConnectionPool::Result r = dmConnectionPool::Dial(multi->m_Pool, request->m_Hostname, request->m_Port, multi->m_Params.m_DNSChannel, false, multi->m_Params.m_RequestTimeout, &connection, &sock_res);
+        if (r != dmConnectionPool::RESULT_OK)
+        {
+            *result = r == dmConnectionPool::RESULT_HANDSHAKE_FAILED ? RESULT_HANDSHAKE_FAILED : RESULT_SOCKET_ERROR;
+            return 0;
+        }
+
+        dmSocket::Socket socket = dmConnectionPool::GetSocket(multi->m_Pool, connection);
+        if (dmSocket::SetBlocking(socket, false) != dmSocket::RESULT_OK)
+        {
+            dmConnectionPool::Close(multi->m_Pool, connection);
+            *result = RESULT_SOCKET_ERROR;
+            return 0;
+        }
+
+        MultiConnection* c = new MultiConnection;
+        c->m_Connection = connection;
+        c->m_Socket = socket;
+        dmStrlCpy(c->m_Hostname, request->m_Hostname, sizeof(c->m_Hostname));
+        c->m_Port = request->m_Port;
+        c->m_InFlight.SetCapacity(multi->m_Params.m_MaxPipelineDepth);
+        c->m_SendOffset = 0;
+        c->m_RecvBuffer.SetCapacity(MULTI_RECV_SIZE + 1);
+        c->m_RecvOffset = 0;
+        c->m_CloseConnection = 0;
+        ResetResponse(c);
+
+        if (multi->m_Connections.Full())
+        {
+            multi->m_Connections.OffsetCapacity(4);
+        }
+        multi->m_Connections.Push(c);
+        *result = RESULT_OK;
+        return c;
+    }
+
+    // Find a connection to the request host with room for another request
+    static MultiConnection* FindConnection(HMulti multi, MultiRequest* request)
+    {
+        uint32_t n = multi->m_Connections.Size();
+        MultiConnection* best = 0;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            MultiConnection* c = multi->m_Connections[i];
+            if (c->m_CloseConnection || c->m_Port != request->m_Port || c->m_InFlight.Size() >= multi->m_Params.m_MaxPipelineDepth)
+                continue;
+            if (strcmp(c->m_Hostname, request->m_Hostname) != 0)
+                continue;
+            // Prefer the connection with the shortest pipeline
+            if (best == 0 || c->m_InFlight.Size() < best->m_InFlight.Size())
+                best = c;
+        }
+        return best;
+    }
+
+    static bool ReleaseIdleConnection(HMulti multi)
+    {
+        uint32_t n = multi->m_Connections.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (multi->m_Connections[i]->m_InFlight.Empty())
+            {
+                ReturnConnection(multi, i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void WriteRequest(MultiConnection* c, MultiRequest* request)
+    {
+        ArrayAppend(c->m_SendBuffer, "GET ", 4);
+        ArrayAppend(c->m_SendBuffer, request->m_Path, strlen(request->m_Path));
+        ArrayAppend(c->m_SendBuffer, " HTTP/1.1\r\nHost: ", 17);
+        ArrayAppend(c->m_SendBuffer, request->m_Hostname, strlen(request->m_Hostname));
+        ArrayAppend(c->m_SendBuffer, "\r\n\r\n", 4);
+        c->m_InFlight.Push(request);
+    }
+
+    static void DispatchPending(HMulti multi)
+    {
+        dmArray<MultiRequest*> failed;
+        Result failed_result = RESULT_OK;
+        uint32_t kept = 0;
+        uint32_t n = multi->m_Pending.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            MultiRequest* request = multi->m_Pending[i];
+            MultiConnection* c = FindConnection(multi, request);
+            if (c == 0 && (multi->m_Connections.Size() < multi->m_Params.m_MaxConnections || ReleaseIdleConnection(multi)))
+            {
+                Result r;
+                c = Dial(multi, request, &r);
+                if (c == 0)
+                {
+                    failed_result = r;
+                    PushFailed(failed, request);
+                    continue;
+                }
+            }
+
+            if (c)
+                WriteRequest(c, request);
+            else
+                multi->m_Pending[kept++] = request;
+        }
+        multi->m_Pending.SetSize(kept);
+        CompleteFailed(multi, failed, failed_result);
+    }
+
+    static void HandleVersion(void* user_data, int major, int minor, int status, const char* status_str)
+    {
+        MultiConnection* c = (MultiConnection*) user_data;
+        c->m_Status = status;
+        if ((major << 16 | minor) < (1 << 16 | 1))
+        {
+            // Close connection for HTTP protocol version < 1.1
+            c->m_CloseConnection = 1;
+        }
+    }
+
+    static void HandleHeader(void* user_data, const char* key, const char* value)
+    {
+        MultiConnection* c = (MultiConnection*) user_data;
+        if (dmStrCaseCmp(key, "Content-Length") == 0)
+        {
+            c->m_ContentLength = strtol(value, 0, 10);
+        }
+        else if (dmStrCaseCmp(key, "Transfer-Encoding") == 0 && dmStrCaseCmp(value, "chunked") == 0)
+        {
+            c->m_Chunked = 1;
+        }
+        else if (dmStrCaseCmp(key, "Connection") == 0 && dmStrCaseCmp(value, "close") == 0)
+        {
+            c->m_CloseConnection = 1;
+        }
+    }
+
+    static void HandleContent(void* user_data, int offset)
+    {
+        MultiConnection* c = (MultiConnection*) user_data;
+        c->m_Remaining = (uint32_t) offset;
+    }
+
+    // Returns the length of the line at the start of buffer (excluding "\r\n") or -1 if incomplete
+    static int FindLine(const char* buffer, uint32_t size)
+    {
+        for (uint32_t i = 0; i + 1 < size; ++i)
+        {
+            if (buffer[i] == '\r' && buffer[i+1] == '\n')
+                return (int) i;
+        }
+        return -1;
+    }
+
+    // Parse as many complete responses as possible from the receive buffer
+    static Result ParseResponses(HMulti multi, MultiConnection* c)
+    {
+        while (true)
+        {
+            char* buffer = c->m_RecvBuffer.Begin() + c->m_RecvOffset;
+            uint32_t available = c->m_RecvBuffer.Size() - c->m_RecvOffset;
+            if (available == 0 && c->m_State != MULTI_PARSE_STATE_BODY)
+                break;
+
+            if (c->m_InFlight.Empty())
+            {
+                dmLogWarning("Unexpected data (%u bytes) on idle connection", available);
+                return RESULT_INVALID_RESPONSE;
+            }
+            MultiRequest* request = c->m_InFlight[0];
+
+            bool complete = false;
+            switch (c->m_State)
+            {
+            case MULTI_PARSE_STATE_HEADERS:
+                {
+                    // NOTE: Capacity is always at least one byte larger than the size
+                    buffer[available] = '\0';
+                    dmHttpClientPrivate::ParseResult parse_res = dmHttpClientPrivate::ParseHeader(buffer, c, false, &HandleVersion, &HandleHeader, &HandleContent);
+                    if (parse_res == dmHttpClientPrivate::PARSE_RESULT_NEED_MORE_DATA)
+                    {
+                        if (available > MULTI_MAX_HEADER_SIZE)
+                            return RESULT_HTTP_HEADERS_ERROR;
+                        return RESULT_OK;
+                    }
+                    else if (parse_res == dmHttpClientPrivate::PARSE_RESULT_SYNTAX_ERROR)
+                    {
+                        return RESULT_HTTP_HEADERS_ERROR;
+                    }
+
+                    c->m_RecvOffset += c->m_Remaining;
+                    c->m_Remaining = 0;
+                    if (c->m_Status == 204 /* No Content */ || c->m_Status == 304 /* Not Modified */)
+                    {
+                        c->m_ContentLength = 0;
+                    }
+
+                    if (c->m_Chunked)
+                    {
+                        c->m_State = MULTI_PARSE_STATE_CHUNK_SIZE;
+                    }
+                    else if (c->m_ContentLength >= 0)
+                    {
+                        c->m_State = MULTI_PARSE_STATE_BODY;
+                        c->m_Remaining = (uint32_t) c->m_ContentLength;
+                        request->m_Content.SetCapacity(c->m_Remaining);
+                    }
+                    else
+                    {
+                        // No Content-Length. The body is terminated by the server closing the connection
+                        c->m_State = MULTI_PARSE_STATE_BODY_UNTIL_EOF;
+                        c->m_CloseConnection = 1;
+                    }
+                }
+                break;
+
+            case MULTI_PARSE_STATE_BODY:
+            case MULTI_PARSE_STATE_CHUNK_DATA:
+                {
+                    uint32_t n = dmMath::Min(c->m_Remaining, available);
+                    ArrayAppend(request->m_Content, buffer, n);
+                    c->m_RecvOffset += n;
+                    c->m_Remaining -= n;
+                    if (c->m_Remaining > 0)
+                        return RESULT_OK;
+
+                    if (c->m_State == MULTI_PARSE_STATE_BODY)
+                        complete = true;
+                    else
+                        c->m_State = MULTI_PARSE_STATE_CHUNK_END;
+                }
+                break;
+
+            case MULTI_PARSE_STATE_BODY_UNTIL_EOF:
+                ArrayAppend(request->m_Content, buffer, available);
+                c->m_RecvOffset += available;
+                return RESULT_OK;
+
+            case MULTI_PARSE_STATE_CHUNK_SIZE:
+            case MULTI_PARSE_STATE_CHUNK_END:
+            case MULTI_PARSE_STATE_CHUNK_TRAILER:
+                {
+                    int line = FindLine(buffer, available);
+                    if (line < 0)
+                    {
+                        if (available > MULTI_MAX_HEADER_SIZE)
+                            return RESULT_INVALID_RESPONSE;
+                        return RESULT_OK;
+                    }
+                    c->m_RecvOffset += line + 2;
+
+                    if (c->m_State == MULTI_PARSE_STATE_CHUNK_END)
+                    {
+                        if (line != 0)
+                            return RESULT_INVALID_RESPONSE;
+                        c->m_State = MULTI_PARSE_STATE_CHUNK_SIZE;
+                    }
+                    else if (c->m_State == MULTI_PARSE_STATE_CHUNK_TRAILER)
+                    {
+                        // Trailer properties are ignored. An empty line terminates the response
+                        complete = line == 0;
+                    }
+                    else
+                    {
+                        char size_str[16];
+                        dmStrlCpy(size_str, buffer, dmMath::Min((uint32_t) line + 1, (uint32_t) sizeof(size_str)));
+                        char* end = 0;
+                        unsigned long chunk_size = strtoul(size_str, &end, 16);
+                        if (end == size_str)
+                            return RESULT_INVALID_RESPONSE;
+
+                        if (chunk_size == 0)
+                        {
+                            c->m_State = MULTI_PARSE_STATE_CHUNK_TRAILER;
+                        }
+                        else
+                        {
+                            c->m_State = MULTI_PARSE_STATE_CHUNK_DATA;
+                            c->m_Remaining = (uint32_t) chunk_size;
+                        }
+                    }
+                }
+                break;
+            }
+
+            if (complete)
+            {
+                multi->m_Statistics.m_Responses++;
+                ArrayRemoveFirst(c->m_InFlight);
+                CompleteRequest(multi, request, c->m_Status == 200 ? RESULT_OK : RESULT_NOT_200_OK, c->m_Status);
+                ResetResponse(c);
+                if (c->m_CloseConnection)
+                    return RESULT_OK;
+            }
+        }
+        return RESULT_OK;
+    }
+
+    static Result FlushSend(MultiConnection* c)
+    {
+        while (c->m_SendOffset < c->m_SendBuffer.Size())
+        {
+            int sent_bytes = 0;
+            dmSocket::Result r = dmSocket::Send(c->m_Socket, c->m_SendBuffer.Begin() + c->m_SendOffset, c->m_SendBuffer.Size() - c->m_SendOffset, &sent_bytes);
+            if (r == dmSocket::RESULT_WOULDBLOCK || r == dmSocket::RESULT_TRY_AGAIN)
+                return RESULT_OK;
+            if (r != dmSocket::RESULT_OK)
+                return RESULT_SOCKET_ERROR;
+            c->m_SendOffset += sent_bytes;
+        }
+        c->m_SendBuffer.SetSize(0);
+        c->m_SendOffset = 0;
+        return RESULT_OK;
+    }
+
+    // Returns RESULT_UNEXPECTED_EOF when the remote peer closed the connection
+    static Result Receive(HMulti multi, MultiConnection* c)
+    {
+        while (true)
+        {
+            dmArray<char>& buffer = c->m_RecvBuffer;
+            if (buffer.Remaining() < MULTI_RECV_SIZE + 1)
+            {
+                buffer.OffsetCapacity(MULTI_RECV_SIZE + 1 - buffer.Remaining());
+            }
+
+            int recv_bytes = 0;
+            dmSocket::Result r = dmSocket::Receive(c->m_Socket, buffer.End(), MULTI_RECV_SIZE, &recv_bytes);
+            if (r == dmSocket::RESULT_WOULDBLOCK || r == dmSocket::RESULT_TRY_AGAIN)
+                return RESULT_OK;
+            if (r != dmSocket::RESULT_OK)
+                return RESULT_SOCKET_ERROR;
+            if (recv_bytes == 0)
+                return RESULT_UNEXPECTED_EOF;
+
+            buffer.SetSize(buffer.Size() + recv_bytes);
+            Result parse_res = ParseResponses(multi, c);
+
+            // Move unparsed bytes to buffer start
+            uint32_t left = buffer.Size() - c->m_RecvOffset;
+            memmove(buffer.Begin(), buffer.Begin() + c->m_RecvOffset, left);
+            buffer.SetSize(left);
+            c->m_RecvOffset = 0;
+
+            if (parse_res != RESULT_OK || c->m_CloseConnection)
+                return parse_res;
+        }
+    }
+
+    // Returns false if the connection was closed
+    static bool UpdateConnection(HMulti multi, uint32_t index, dmSocket::Selector* selector)
+    {
+        MultiConnection* c = multi->m_Connections[index];
+
+        if (dmSocket::SelectorIsSet(selector, dmSocket::SELECTOR_KIND_WRITE, c->m_Socket))
+        {
+            Result r = FlushSend(c);
+            if (r != RESULT_OK)
+            {
+                CloseConnection(multi, index, r);
+                return false;
+            }
+        }
+
+        if (dmSocket::SelectorIsSet(selector, dmSocket::SELECTOR_KIND_READ, c->m_Socket))
+        {
+            Result r = Receive(multi, c);
+            if (r == RESULT_UNEXPECTED_EOF && c->m_State == MULTI_PARSE_STATE_BODY_UNTIL_EOF)
+            {
+                MultiRequest* request = c->m_InFlight[0];
+                multi->m_Statistics.m_Responses++;
+                ArrayRemoveFirst(c->m_InFlight);
+                CompleteRequest(multi, request, c->m_Status == 200 ? RESULT_OK : RESULT_NOT_200_OK, c->m_Status);
+                r = RESULT_OK;
+            }
+
+            // The server announced that it closes the connection after the last complete response
+            bool closed_by_server = c->m_CloseConnection && c->m_State == MULTI_PARSE_STATE_HEADERS;
+            if (r != RESULT_OK || closed_by_server)
+            {
+                // Requests left unanswered are retried on a new connection
+                CloseConnection(multi, index, closed_by_server ? RESULT_OK : r);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void CheckTimeouts(HMulti multi)
+    {
+        if (multi->m_Params.m_RequestTimeout <= 0)
+            return;
+
+        uint64_t now = dmTime::GetTime();
+        uint64_t timeout = (uint64_t) multi->m_Params.m_RequestTimeout;
+
+        dmArray<MultiRequest*> failed;
+        uint32_t kept = 0;
+        uint32_t n = multi->m_Pending.Size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            MultiRequest* request = multi->m_Pending[i];
+            if (now - request->m_Start > timeout)
+                PushFailed(failed, request);
+            else
+                multi->m_Pending[kept++] = request;
+        }
+        multi->m_Pending.SetSize(kept);
+        CompleteFailed(multi, failed, RESULT_SOCKET_ERROR);
+
+        for (uint32_t i = 0; i < multi->m_Connections.Size();)
+        {
+            MultiConnection* c = multi->m_Connections[i];
+            if (!c->m_InFlight.Empty() && now - c->m_InFlight[0]->m_Start > timeout)
+            {
+                // The response is stuck on the wire. Give up on it and resend the rest
+                MultiRequest* request = c->m_InFlight[0];
+                ArrayRemoveFirst(c->m_InFlight);
+                CompleteRequest(multi, request, RESULT_SOCKET_ERROR, -1);
+                CloseConnection(multi, i, RESULT_OK);
+                continue;
+            }
+            ++i;
+        }
+    }
+
+    HMulti NewMulti(const MultiParams* params)
+    {
+        Multi* multi = new Multi;
+        multi->m_Params = *params;
+        multi->m_Params.m_MaxConnections = dmMath::Max(1U, params->m_MaxConnections);
+        multi->m_Params.m_MaxPipelineDepth = dmMath::Max(1U, params->m_MaxPipelineDepth);
+        multi->m_Params.m_MaxRetries = dmMath::Max(1U, params->m_MaxRetries);
+        multi->m_Pool = dmHttpClientPrivate::GetConnectionPool();
+        multi->m_Connections.SetCapacity(multi->m_Params.m_MaxConnections);
+        memset(&multi->m_Statistics, 0, sizeof(multi->m_Statistics));
+        return multi;
+    }
+
+    void DeleteMulti(HMulti multi)
+    {
+        for (uint32_t i = 0; i < multi->m_Pending.Size(); ++i)
+        {
+            delete multi->m_Pending[i];
+        }
+
+        while (!multi->m_Connections.Empty())
+        {
+            uint32_t index = multi->m_Connections.Size() - 1;
+            MultiConnection* c = multi->m_Connections[index];
+            if (c->m_InFlight.Empty())
+            {
+                ReturnConnection(multi, index);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < c->m_InFlight.Size(); ++i)
+                {
+                    delete c->m_InFlight[i];
+                }
+                c->m_InFlight.SetSize(0);
+                CloseConnection(multi, index, RESULT_OK);
+            }
+        }
+        delete multi;
+    }
+
+    Result MultiGet(HMulti multi, const char* hostname, uint16_t port, const char* path, MultiCallback callback, void* user_data)
+    {
+        if (strlen(hostname) >= dmURI::MAX_LOCATION_LEN || strlen(path) >= dmURI::MAX_PATH_LEN)
+        {
+            return RESULT_INVAL;
+        }
+
+        MultiRequest* request = new MultiRequest;
+        dmStrlCpy(request->m_Hostname, hostname, sizeof(request->m_Hostname));
+        dmStrlCpy(request->m_Path, path, sizeof(request->m_Path));
+        request->m_Port = port;
+        request->m_Callback = callback;
+        request->m_UserData = user_data;
+        request->m_Start = dmTime::GetTime();
+        request->m_Attempts = 0;
+
+        if (multi->m_Pending.Full())
+        {
+            multi->m_Pending.OffsetCapacity(dmMath::Max(16U, multi->m_Pending.Capacity()));
+        }
+        multi->m_Pending.Push(request);
+        return RESULT_OK;
+    }
+
+    uint32_t MultiUpdate(HMulti multi, int32_t timeout)
+    {
+        DispatchPending(multi);
+
+        dmSocket::Selector selector;
+        bool active = false;
+        for (uint32_t i = 0; i < multi->m_Connections.Size(); ++i)
+        {
+            MultiConnection* c = multi->m_Connections[i];
+            if (!c->m_SendBuffer.Empty())
+            {
+                dmSocket::SelectorSet(&selector, dmSocket::SELECTOR_KIND_WRITE, c->m_Socket);
+                active = true;
+            }
+            if (!c->m_InFlight.Empty())
+            {
+                dmSocket::SelectorSet(&selector, dmSocket::SELECTOR_KIND_READ, c->m_Socket);
+                active = true;
+            }
+        }
+
+        if (active)
+        {
+            dmSocket::Result r = dmSocket::Select(&selector, timeout);
+            if (r == dmSocket::RESULT_OK)
+            {
+                for (uint32_t i = 0; i < multi->m_Connections.Size();)
+                {
+                    if (UpdateConnection(multi, i, &selector))
+                        ++i;
+                }
+            }
+            else if (r != dmSocket::RESULT_WOULDBLOCK)
+            {
+                dmLogWarning("HTTPCLIENT: select failed (%s)", dmSocket::ResultToString(r));
+            }
+        }
+
+        CheckTimeouts(multi);
+
+        uint32_t count = multi->m_Pending.Size();
+        for (uint32_t i = 0; i < multi->m_Connections.Size(); ++i)
+        {
+            count += multi->m_Connections[i]->m_InFlight.Size();
+        }
+        return count;
+    }
+
+    void GetStatistics(HMulti multi, Statistics* statistics)
+    {
+        *statistics = multi->m_Statistics;
+    }
+
+} // namespace dmHttpClient
@@ -13,6 +13,8 @@
 #ifndef DM_HTTP_CLIENT_PRIVATE_H
 #define DM_HTTP_CLIENT_PRIVATE_H
 
+#include <dlib/connection_pool.h>
+
 namespace dmHttpClientPrivate
 {
     enum ParseResult
@@ -29,6 +31,12 @@ namespace dmHttpClientPrivate
                             void (*header)(void* user_data, const char* key, const char* value),
                             void (*body)(void* user_data, int offset));
 
+    /**
+     * Get the connection pool shared by all http clients. Created on first use
+     * @return Pool handle
+     */
+    dmConnectionPool::HPool GetConnectionPool();
+
 } // namespace dmHttpClientPrivate
 
 #endif // DM_HTTP_CLIENT_PRIVATE_H
@@ -10,9 +10,47 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <stdlib.h>
 #include <string.h>
 #include <dlib/log.h>
 #include "image.h"
+#include "image_private.h"
+#include "../zlib/zlib.h"
+
+namespace dmImage
+{
+    static void* DefaultAlloc(void* context, size_t size)
+    {
+        return malloc(size);
+    }
+
+    static void* DefaultRealloc(void* context, void* ptr, size_t size)
+    {
+        return realloc(ptr, size);
+    }
+
+    static void DefaultFree(void* context, void* ptr)
+    {
+        free(ptr);
+    }
+
+    static Allocator g_Allocator = {DefaultAlloc, DefaultRealloc, DefaultFree, 0};
+
+    static void* AllocMemory(size_t size)
+    {
+        return g_Allocator.m_Alloc(g_Allocator.m_Context, size);
+    }
+
+    static void* ReallocMemory(void* ptr, size_t size)
+    {
+        return g_Allocator.m_Realloc(g_Allocator.m_Context, ptr, size);
+    }
+
+    static void FreeMemory(void* ptr)
+    {
+        g_Allocator.m_Free(g_Allocator.m_Context, ptr);
+    }
+}
 
 //#define STBI_NO_JPEG
 //#define STBI_NO_PNG
@@ -27,72 +65,619 @@
 #define STBI_NO_LINEAR
 #define STBI_NO_STDIO
 #define STBI_FAILURE_USERMSG
+#define STBI_MALLOC(size)           dmImage::AllocMemory(size)
+#define STBI_REALLOC(ptr, size)     dmImage::ReallocMemory(ptr, size)
+#define STBI_FREE(ptr)              dmImage::FreeMemory(ptr)
 #define STB_IMAGE_IMPLEMENTATION
 #include "../stb_image/stb_image.h"
 
+#if !defined(DM_IMAGE_NO_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define DM_IMAGE_SSE2
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define DM_IMAGE_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
 namespace dmImage
 {
-    void Premultiply(uint8_t* buffer, int width, int height)
-    {
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                int index = (y * width + x) * 4;
-                uint32_t a = buffer[index + 3];
-                uint32_t r = (buffer[index + 0] * a + 255) >> 8;
-                uint32_t g = (buffer[index + 1] * a + 255) >> 8;
-                uint32_t b = (buffer[index + 2] * a + 255) >> 8;
-                buffer[index + 0] = r;
-                buffer[index + 1] = g;
-                buffer[index + 2] = b;
+    void SetAllocator(const Allocator* allocator)
+    {
+        if (allocator) {
+            g_Allocator = *allocator;
+        } else {
+            g_Allocator.m_Alloc = DefaultAlloc;
+            g_Allocator.m_Realloc = DefaultRealloc;
+            g_Allocator.m_Free = DefaultFree;
+            g_Allocator.m_Context = 0;
+        }
+    }
+
+    // Premultiplies count rgba pixels. The vector paths compute the exact same
+    // (c * a + 255) >> 8 as the scalar tail, since c * a + 255 fits in 16 bits.
+    static void PremultiplyPixels(uint8_t* p, uint32_t count)
+    {
+        uint32_t i = 0;
+#if defined(DM_IMAGE_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bias = _mm_set1_epi16(255);
+        const __m128i alpha_mask = _mm_set1_epi32((int) 0xff000000);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i px = _mm_loadu_si128((const __m128i*) (p + i * 4));
+            __m128i lo = _mm_unpacklo_epi8(px, zero);
+            __m128i hi = _mm_unpackhi_epi8(px, zero);
+            __m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xff), 0xff);
+            __m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xff), 0xff);
+            lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(lo, alpha_lo), bias), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(hi, alpha_hi), bias), 8);
+            __m128i result = _mm_packus_epi16(lo, hi);
+            result = _mm_or_si128(_mm_andnot_si128(alpha_mask, result), _mm_and_si128(alpha_mask, px));
+            _mm_storeu_si128((__m128i*) (p + i * 4), result);
+        }
+#elif defined(DM_IMAGE_NEON)
+        const uint16x8_t bias = vdupq_n_u16(255);
+        for (; i + 8 <= count; i += 8)
+        {
+            uint8x8x4_t px = vld4_u8(p + i * 4);
+            px.val[0] = vshrn_n_u16(vaddq_u16(vmull_u8(px.val[0], px.val[3]), bias), 8);
+            px.val[1] = vshrn_n_u16(vaddq_u16(vmull_u8(px.val[1], px.val[3]), bias), 8);
+            px.val[2] = vshrn_n_u16(vaddq_u16(vmull_u8(px.val[2], px.val[3]), bias), 8);
+            vst4_u8(p + i * 4, px);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            uint8_t* px = p + i * 4;
+            uint32_t a = px[3];
+            px[0] = (uint8_t) ((px[0] * a + 255) >> 8);
+            px[1] = (uint8_t) ((px[1] * a + 255) >> 8);
+            px[2] = (uint8_t) ((px[2] * a + 255) >> 8);
+        }
+    }
+
+    void Premultiply(uint8_t* buffer, uint32_t width, uint32_t height)
+    {
+        PremultiplyPixels(buffer, width * height);
+    }
+
+    static Type TypeFromComponents(int comp)
+    {
+        switch (comp)
+        {
+        case 3:
+            return TYPE_RGB;
+        case 4:
+            return TYPE_RGBA;
+        default:
+            // Luminance + alpha is loaded as luminance
+            return TYPE_LUMINANCE;
+        }
+    }
+
+    // Converts one row from src_comp to dst_comp components. Writing is done front
+    // to back, so src and dst may alias as long as dst_comp <= src_comp.
+    static void ConvertRow(const uint8_t* src, uint32_t src_comp, uint8_t* dst, uint32_t dst_comp, uint32_t width, bool premult)
+    {
+        if (src_comp == dst_comp)
+        {
+            if (src != dst)
+                memcpy(dst, src, width * dst_comp);
+        }
+        else
+        {
+            for (uint32_t x = 0; x < width; ++x, src += src_comp, dst += dst_comp)
+            {
+                uint8_t r, g, b, a;
+                if (src_comp <= 2)
+                {
+                    r = g = b = src[0];
+                    a = src_comp == 2 ? src[1] : 255;
+                }
+                else
+                {
+                    r = src[0];
+                    g = src[1];
+                    b = src[2];
+                    a = src_comp == 4 ? src[3] : 255;
+                }
+
+                if (dst_comp == 1)
+                {
+                    dst[0] = src_comp <= 2 ? r : stbi__compute_y(r, g, b);
+                }
+                else
+                {
+                    dst[0] = r;
+                    dst[1] = g;
+                    dst[2] = b;
+                    if (dst_comp == 4)
+                        dst[3] = a;
+                }
             }
+            dst -= width * dst_comp;
+        }
+
+        if (premult && dst_comp == 4)
+        {
+            PremultiplyPixels(dst, width);
         }
     }
 
-    Result Load(const void* buffer, uint32_t buffer_size, bool premult, Image* image)
+    // Converts decoded rows into the output of LoadInto, one row at a time
+    struct RowWriter
     {
-        int x, y, comp;
+        uint8_t* m_Out;
+        uint32_t m_Width;
+        uint32_t m_Height;
+        uint32_t m_Comp;
+        uint32_t m_OutComp;
+        uint32_t m_Flags;
+    };
 
-        unsigned char* ret = stbi_load_from_memory((const stbi_uc*) buffer, (int) buffer_size, &x, &y, &comp, 0);
+    static void WriteRow(RowWriter* writer, uint32_t row, const uint8_t* pixels)
+    {
+        uint32_t out_row = (writer->m_Flags & LOAD_FLAG_FLIP_Y) ? writer->m_Height - 1 - row : row;
+        uint8_t* dst = writer->m_Out + out_row * writer->m_Width * writer->m_OutComp;
+        ConvertRow(pixels, writer->m_Comp, dst, writer->m_OutComp, writer->m_Width, (writer->m_Flags & LOAD_FLAG_PREMULTIPLY) != 0);
+    }
 
-        if (ret) {
-            Image i;
-            i.m_Width = (uint32_t) x;
-            i.m_Height = (uint32_t) y;
-            switch (comp) {
-            case 1:
-                i.m_Type = TYPE_LUMINANCE;
-                break;
-            case 2:
-                // Luminance + alpha. Convert to luminance
-                i.m_Type = TYPE_LUMINANCE;
-                ret = stbi__convert_format(ret, 2, 1, x, y);
-                break;
-            case 3:
-                i.m_Type = TYPE_RGB;
-                break;
-            case 4:
-                i.m_Type = TYPE_RGBA;
-                if (premult) {
-                    Premultiply(ret, x, y);
+    static uint32_t ReadU32(const uint8_t* p)
+    {
+        return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+    }
+
+    static const uint8_t PNG_SIGNATURE[] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+    struct PngHeader
+    {
+        uint32_t        m_Width;
+        uint32_t        m_Height;
+        // Components per pixel in the file, a palette index counts as one
+        uint32_t        m_FileComp;
+        // Components per decoded pixel, the same as stb_image returns
+        uint32_t        m_Comp;
+        uint32_t        m_Indexed : 1;
+        // Pixels matching the key color get zero alpha, the others opaque
+        uint32_t        m_HasKey : 1;
+        const uint8_t*  m_FirstData;
+        uint8_t         m_Key[3];
+        uint8_t         m_Palette[256 * 4];
+    };
+
+    // Returns the next chunk, or false if there's no complete chunk left
+    static bool NextPngChunk(const uint8_t** cursor, const uint8_t* end, const uint8_t** type, const uint8_t** data, uint32_t* length)
+    {
+        const uint8_t* p = *cursor;
+        if (end - p < 12)
+            return false;
+        uint32_t l = ReadU32(p);
+        if (l > (uint32_t) (end - p) - 12)
+            return false;
+        *type = p + 4;
+        *data = p + 8;
+        *length = l;
+        *cursor = p + 12 + l;
+        return true;
+    }
+
+    // Reads the chunks before the image data of png images that can be decoded row by row: non interlaced
+    // with 8 bits per channel. The other images are left to stb_image.
+    static bool ReadPngHeader(const uint8_t* buffer, uint32_t buffer_size, PngHeader* header)
+    {
+        if (buffer == 0 || buffer_size < sizeof(PNG_SIGNATURE) || memcmp(buffer, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0)
+            return false;
+
+        const uint8_t* cursor = buffer + sizeof(PNG_SIGNATURE);
+        const uint8_t* end = buffer + buffer_size;
+        const uint8_t* type;
+        const uint8_t* data;
+        uint32_t length;
+        if (!NextPngChunk(&cursor, end, &type, &data, &length) || memcmp(type, "IHDR", 4) != 0 || length != 13)
+            return false;
+
+        header->m_Width = ReadU32(data);
+        header->m_Height = ReadU32(data + 4);
+        uint8_t bit_depth = data[8];
+        uint8_t color_type = data[9];
+        // Compression, filter and interlace method
+        if (data[10] != 0 || data[11] != 0 || data[12] != 0 || bit_depth != 8)
+            return false;
+        if (header->m_Width == 0 || header->m_Height == 0 || header->m_Width > (1 << 24) || header->m_Height > (1 << 24))
+            return false;
+
+        switch (color_type)
+        {
+        case 0: header->m_FileComp = 1; break;
+        case 2: header->m_FileComp = 3; break;
+        case 3: header->m_FileComp = 1; break;
+        case 4: header->m_FileComp = 2; break;
+        case 6: header->m_FileComp = 4; break;
+        default:
+            return false;
+        }
+        header->m_Indexed = color_type == 3;
+        header->m_HasKey = 0;
+        header->m_Comp = header->m_FileComp;
+
+        uint32_t palette_size = 0;
+        memset(header->m_Palette, 0, sizeof(header->m_Palette));
+        while (NextPngChunk(&cursor, end, &type, &data, &length))
+        {
+            if (memcmp(type, "IDAT", 4) == 0)
+            {
+                if (header->m_Indexed && palette_size == 0)
+                    return false;
+                header->m_FirstData = type - 4;
+                return true;
+            }
+            else if (memcmp(type, "PLTE", 4) == 0)
+            {
+                if (length == 0 || length % 3 != 0 || length / 3 > 256)
+                    return false;
+                palette_size = length / 3;
+                for (uint32_t i = 0; i < palette_size; ++i)
+                {
+                    header->m_Palette[i * 4 + 0] = data[i * 3 + 0];
+                    header->m_Palette[i * 4 + 1] = data[i * 3 + 1];
+                    header->m_Palette[i * 4 + 2] = data[i * 3 + 2];
+                    header->m_Palette[i * 4 + 3] = 255;
+                }
+                if (header->m_Indexed)
+                    header->m_Comp = 3;
+            }
+            else if (memcmp(type, "tRNS", 4) == 0)
+            {
+                if (header->m_Indexed)
+                {
+                    if (length > palette_size)
+                        return false;
+                    for (uint32_t i = 0; i < length; ++i)
+                    {
+                        header->m_Palette[i * 4 + 3] = data[i];
+                    }
+                    header->m_Comp = 4;
                 }
+                else if ((color_type == 0 && length == 2) || (color_type == 2 && length == 6))
+                {
+                    // 16 bit samples, of which only the low byte is used at this bit depth
+                    for (uint32_t i = 0; i < header->m_FileComp; ++i)
+                    {
+                        header->m_Key[i] = data[i * 2 + 1];
+                    }
+                    header->m_HasKey = 1;
+                    header->m_Comp = header->m_FileComp + 1;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else if (memcmp(type, "IEND", 4) == 0 || memcmp(type, "CgBI", 4) == 0 || (type[0] & 32) == 0)
+            {
+                // No image data, Apple's premultiplied variant, or an unknown critical chunk
+                return false;
+            }
+        }
+        return false;
+    }
+
+    static uint8_t Paeth(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = abs(p - a);
+        int pb = abs(p - b);
+        int pc = abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return (uint8_t) a;
+        if (pb <= pc)
+            return (uint8_t) b;
+        return (uint8_t) c;
+    }
+
+    static bool Unfilter(uint8_t filter, uint8_t* row, const uint8_t* prev, uint32_t size, uint32_t bpp)
+    {
+        switch (filter)
+        {
+        case 0:
+            break;
+        case 1:
+            for (uint32_t i = bpp; i < size; ++i)
+                row[i] += row[i - bpp];
+            break;
+        case 2:
+            for (uint32_t i = 0; i < size; ++i)
+                row[i] += prev[i];
+            break;
+        case 3:
+            for (uint32_t i = 0; i < bpp; ++i)
+                row[i] += prev[i] >> 1;
+            for (uint32_t i = bpp; i < size; ++i)
+                row[i] += (uint8_t) ((row[i - bpp] + prev[i]) >> 1);
+            break;
+        case 4:
+            for (uint32_t i = 0; i < bpp; ++i)
+                row[i] += prev[i];
+            for (uint32_t i = bpp; i < size; ++i)
+                row[i] += Paeth(row[i - bpp], prev[i], prev[i - bpp]);
+            break;
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    static voidpf ZAlloc(voidpf opaque, uInt items, uInt size)
+    {
+        return AllocMemory((size_t) items * size);
+    }
+
+    static void ZFree(voidpf opaque, voidpf address)
+    {
+        FreeMemory(address);
+    }
+
+    // Inflates the image data into a window of two rows, and hands each row to the writer as soon
+    // as it is unfiltered. Palette indices and key color transparency are expanded into a third row.
+    static Result DecodePngRows(const uint8_t* buffer, uint32_t buffer_size, const PngHeader* header, RowWriter* writer)
+    {
+        uint32_t row_size = header->m_Width * header->m_FileComp;
+        uint32_t expanded_size = (header->m_Indexed || header->m_HasKey) ? header->m_Width * header->m_Comp : 0;
+        uint8_t* rows = (uint8_t*) AllocMemory(2 * (row_size + 1) + expanded_size);
+        if (!rows)
+            return RESULT_IMAGE_ERROR;
+        // The row before the first row is all zeros. Each row starts with its filter type.
+        memset(rows, 0, 2 * (row_size + 1));
+        uint8_t* prev = rows;
+        uint8_t* current = rows + row_size + 1;
+        uint8_t* expanded = rows + 2 * (row_size + 1);
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.zalloc = ZAlloc;
+        stream.zfree = ZFree;
+        if (inflateInit(&stream) != Z_OK)
+        {
+            FreeMemory(rows);
+            return RESULT_IMAGE_ERROR;
+        }
+        stream.next_out = current;
+        stream.avail_out = row_size + 1;
+
+        const uint8_t* cursor = header->m_FirstData;
+        const uint8_t* end = buffer + buffer_size;
+        Result result = RESULT_OK;
+        uint32_t row = 0;
+        int z_result = Z_OK;
+        while (row < header->m_Height && z_result != Z_STREAM_END)
+        {
+            if (stream.avail_in == 0)
+            {
+                const uint8_t* type;
+                const uint8_t* data;
+                uint32_t length;
+                if (!NextPngChunk(&cursor, end, &type, &data, &length) || memcmp(type, "IDAT", 4) != 0)
+                {
+                    result = RESULT_IMAGE_ERROR;
+                    break;
+                }
+                stream.next_in = (z_const Bytef*) data;
+                stream.avail_in = length;
+                continue;
+            }
+
+            z_result = inflate(&stream, Z_NO_FLUSH);
+            if (z_result != Z_OK && z_result != Z_STREAM_END && z_result != Z_BUF_ERROR)
+            {
+                result = RESULT_IMAGE_ERROR;
                 break;
-            default:
-                dmLogError("Unexpected number of components in image (%d)", comp);
-                free(ret);
+            }
+
+            if (stream.avail_out == 0)
+            {
+                if (!Unfilter(current[0], current + 1, prev + 1, row_size, header->m_FileComp))
+                {
+                    result = RESULT_IMAGE_ERROR;
+                    break;
+                }
+
+                const uint8_t* pixels = current + 1;
+                if (header->m_Indexed)
+                {
+                    uint32_t comp = header->m_Comp;
+                    for (uint32_t x = 0; x < header->m_Width; ++x)
+                    {
+                        memcpy(expanded + x * comp, &header->m_Palette[pixels[x] * 4], comp);
+                    }
+                    pixels = expanded;
+                }
+                else if (header->m_HasKey)
+                {
+                    uint32_t file_comp = header->m_FileComp;
+                    for (uint32_t x = 0; x < header->m_Width; ++x)
+                    {
+                        const uint8_t* src = pixels + x * file_comp;
+                        uint8_t* dst = expanded + x * (file_comp + 1);
+                        memcpy(dst, src, file_comp);
+                        dst[file_comp] = memcmp(src, header->m_Key, file_comp) == 0 ? 0 : 255;
+                    }
+                    pixels = expanded;
+                }
+                WriteRow(writer, row, pixels);
+                ++row;
+
+                uint8_t* tmp = prev;
+                prev = current;
+                current = tmp;
+                stream.next_out = current;
+                stream.avail_out = row_size + 1;
+            }
+        }
+
+        if (result == RESULT_OK && row < header->m_Height)
+        {
+            result = RESULT_IMAGE_ERROR;
+        }
+        if (result != RESULT_OK)
+        {
+            dmLogError("Failed to load image: 'corrupt png'");
+        }
+
+        inflateEnd(&stream);
+        FreeMemory(rows);
+        return result;
+    }
+
+    static uint8_t* Decode(const void* buffer, uint32_t buffer_size, uint32_t* width, uint32_t* height, uint32_t* comp)
+    {
+        int x, y, c;
+        unsigned char* ret = stbi_load_from_memory((const stbi_uc*) buffer, (int) buffer_size, &x, &y, &c, 0);
+        if (!ret) {
+            dmLogError("Failed to load image: '%s'", stbi_failure_reason());
+            return 0;
+        }
+        if (c < 1 || c > 4) {
+            dmLogError("Unexpected number of components in image (%d)", c);
+            FreeMemory(ret);
+            return 0;
+        }
+        *width = (uint32_t) x;
+        *height = (uint32_t) y;
+        *comp = (uint32_t) c;
+        return ret;
+    }
+
+    Result Load(const void* buffer, uint32_t buffer_size, bool premult, Image* image)
+    {
+        PngHeader png;
+        if (ReadPngHeader((const uint8_t*) buffer, buffer_size, &png))
+        {
+            Image i;
+            i.m_Width = png.m_Width;
+            i.m_Height = png.m_Height;
+            i.m_Type = TypeFromComponents(png.m_Comp);
+
+            uint64_t size = (uint64_t) png.m_Width * png.m_Height * BytesPerPixel(i.m_Type);
+            uint8_t* out = size <= 0xffffffff ? (uint8_t*) AllocMemory((size_t) size) : 0;
+            if (!out) {
+                dmLogError("Failed to load image: 'outofmem'");
                 return RESULT_IMAGE_ERROR;
             }
-            i.m_Buffer = (void*) ret;
+
+            RowWriter writer = {out, png.m_Width, png.m_Height, png.m_Comp, BytesPerPixel(i.m_Type), premult ? (uint32_t) LOAD_FLAG_PREMULTIPLY : 0};
+            Result r = DecodePngRows((const uint8_t*) buffer, buffer_size, &png, &writer);
+            if (r != RESULT_OK) {
+                FreeMemory(out);
+                return r;
+            }
+            i.m_Buffer = (void*) out;
             *image = i;
             return RESULT_OK;
-        } else {
-            dmLogError("Failed to load image: '%s'", stbi_failure_reason());
+        }
+
+        uint32_t width, height, comp;
+        uint8_t* ret = Decode(buffer, buffer_size, &width, &height, &comp);
+        if (!ret) {
+            return RESULT_IMAGE_ERROR;
+        }
+
+        Image i;
+        i.m_Width = width;
+        i.m_Height = height;
+        i.m_Type = TypeFromComponents(comp);
+
+        // Conversion and premultiplication are done in place, in a single pass over the rows
+        uint32_t out_comp = BytesPerPixel(i.m_Type);
+        if (out_comp != comp || (premult && comp == 4)) {
+            uint32_t src_stride = width * comp;
+            uint32_t dst_stride = width * out_comp;
+            for (uint32_t row = 0; row < height; ++row) {
+                ConvertRow(ret + row * src_stride, comp, ret + row * dst_stride, out_comp, width, premult);
+            }
+        }
+        if (out_comp != comp) {
+            uint8_t* shrunk = (uint8_t*) ReallocMemory(ret, width * height * out_comp);
+            if (shrunk) {
+                ret = shrunk;
+            }
+        }
+
+        i.m_Buffer = (void*) ret;
+        *image = i;
+        return RESULT_OK;
+    }
+
+    Result LoadInto(const void* buffer, uint32_t buffer_size, Type type, uint32_t flags, void* out_buffer, uint32_t out_buffer_size)
+    {
+        uint32_t out_comp = BytesPerPixel(type);
+        if (out_comp == 0) {
+            return RESULT_UNSUPPORTED_FORMAT;
+        }
+
+        PngHeader png;
+        if (ReadPngHeader((const uint8_t*) buffer, buffer_size, &png))
+        {
+            if ((uint64_t) png.m_Width * png.m_Height * out_comp > out_buffer_size) {
+                return RESULT_BUFFER_TOO_SMALL;
+            }
+            RowWriter writer = {(uint8_t*) out_buffer, png.m_Width, png.m_Height, png.m_Comp, out_comp, flags};
+            return DecodePngRows((const uint8_t*) buffer, buffer_size, &png, &writer);
+        }
+
+        // Other images are decoded in full by stb_image first
+        Image info;
+        Result r = GetInfo(buffer, buffer_size, &info);
+        if (r != RESULT_OK) {
+            return r;
+        }
+        if ((uint64_t) info.m_Width * info.m_Height * out_comp > out_buffer_size) {
+            return RESULT_BUFFER_TOO_SMALL;
+        }
+
+        uint32_t width, height, comp;
+        uint8_t* decoded = Decode(buffer, buffer_size, &width, &height, &comp);
+        if (!decoded) {
+            return RESULT_IMAGE_ERROR;
+        }
+        RowWriter writer = {(uint8_t*) out_buffer, width, height, comp, out_comp, flags};
+        for (uint32_t row = 0; row < height; ++row) {
+            WriteRow(&writer, row, decoded + row * width * comp);
+        }
+        FreeMemory(decoded);
+        return RESULT_OK;
+    }
+
+    Result GetInfo(const void* buffer, uint32_t buffer_size, Image* image)
+    {
+        // Unlike stbi_info, this includes the transparency chunk in the type
+        PngHeader png;
+        if (ReadPngHeader((const uint8_t*) buffer, buffer_size, &png))
+        {
+            Image i;
+            i.m_Width = png.m_Width;
+            i.m_Height = png.m_Height;
+            i.m_Type = TypeFromComponents(png.m_Comp);
+            *image = i;
+            return RESULT_OK;
+        }
+
+        int x, y, comp;
+        if (!stbi_info_from_memory((const stbi_uc*) buffer, (int) buffer_size, &x, &y, &comp) || comp < 1 || comp > 4) {
             return RESULT_IMAGE_ERROR;
         }
+        Image i;
+        i.m_Width = (uint32_t) x;
+        i.m_Height = (uint32_t) y;
+        i.m_Type = TypeFromComponents(comp);
+        *image = i;
+        return RESULT_OK;
     }
 
     void Free(Image* image)
     {
-        free(image->m_Buffer);
+        FreeMemory(image->m_Buffer);
         memset(image, 0, sizeof(*image));
     }
 
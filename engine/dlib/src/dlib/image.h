@@ -22,6 +22,7 @@ namespace dmImage
         RESULT_OK                   = 0,
         RESULT_UNSUPPORTED_FORMAT   = -1,
         RESULT_IMAGE_ERROR          = -2,
+        RESULT_BUFFER_TOO_SMALL     = -3,
     };
 
     enum Type
@@ -31,6 +32,12 @@ namespace dmImage
         TYPE_LUMINANCE  = 2,
     };
 
+    enum LoadFlags
+    {
+        LOAD_FLAG_PREMULTIPLY   = 1 << 0,
+        LOAD_FLAG_FLIP_Y        = 1 << 1,
+    };
+
     struct Image
     {
         Image() : m_Width(0), m_Height(0), m_Type(TYPE_RGB), m_Buffer(0) {}
@@ -58,6 +65,50 @@ namespace dmImage
      */
     Result Load(const void* buffer, uint32_t buffer_size, bool premult, Image* image);
 
+    /**
+     * Get image dimensions and the type Load would return, without decoding the pixels.
+     * m_Buffer of the output is set to 0.
+     *
+     * @param buffer image buffer
+     * @param buffer_size image buffer size
+     * @param image output
+     * @return RESULT_OK on success
+     */
+    Result GetInfo(const void* buffer, uint32_t buffer_size, Image* image);
+
+    /**
+     * Load image into a caller provided buffer, e.g. a texture staging buffer.
+     * The pixels are converted to the requested type, and premultiplied and flipped
+     * according to flags, row by row as they are written to the output. The output
+     * rows are tightly packed.
+     *
+     * Non interlaced png images with 8 bits per channel are decoded one row at a time,
+     * so apart from the output only a couple of rows and the inflate window are allocated.
+     * Other images are decoded in full before they are converted into the output.
+     *
+     * Luminance is expanded to all color channels, and color is converted to
+     * luminance using the same weights as the decoder. Missing alpha is set to 255.
+     * LOAD_FLAG_PREMULTIPLY only applies when the output type has alpha.
+     *
+     * @param buffer image buffer
+     * @param buffer_size image buffer size
+     * @param type output type
+     * @param flags combination of LoadFlags
+     * @param out_buffer output buffer
+     * @param out_buffer_size output buffer size. Must be at least width * height * BytesPerPixel(type)
+     * @return RESULT_OK on success, RESULT_BUFFER_TOO_SMALL if the output buffer can't hold the image
+     */
+    Result LoadInto(const void* buffer, uint32_t buffer_size, Type type, uint32_t flags, void* out_buffer, uint32_t out_buffer_size);
+
+    /**
+     * Premultiply rgba pixels in place. Uses SSE2 or NEON when available, unless
+     * DM_IMAGE_NO_SIMD is defined. The result is identical to the scalar version.
+     * @param buffer rgba pixels
+     * @param width width in pixels
+     * @param height height in pixels
+     */
+    void Premultiply(uint8_t* buffer, uint32_t width, uint32_t height);
+
     /**
      * Free loaded image
      * @param image image to free
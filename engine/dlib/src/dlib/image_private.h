@@ -0,0 +1,40 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_IMAGE_PRIVATE_H
+#define DM_IMAGE_PRIVATE_H
+
+#include <stddef.h>
+
+namespace dmImage
+{
+    /**
+     * Allocation functions used by the decoders and for the images returned by Load.
+     * The tests use them to measure how much memory a decode needs.
+     */
+    struct Allocator
+    {
+        void* (*m_Alloc)(void* context, size_t size);
+        void* (*m_Realloc)(void* context, void* ptr, size_t size);
+        void  (*m_Free)(void* context, void* ptr);
+        void*   m_Context;
+    };
+
+    /**
+     * Set the allocator. Must not be changed while an image is decoded, or while
+     * an image returned by Load is alive.
+     * @param allocator allocator, 0 restores malloc, realloc and free
+     */
+    void SetAllocator(const Allocator* allocator);
+}
+
+#endif // DM_IMAGE_PRIVATE_H
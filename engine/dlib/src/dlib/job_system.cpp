@@ -0,0 +1,662 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include "safe_windows.h"
+#else
+#include <unistd.h>
+#endif
+
+#include "job_system.h"
+#include "atomic.h"
+#include "condition_variable.h"
+#include "log.h"
+#include "math.h"
+#include "mutex.h"
+#include "profile.h"
+#include "spinlock.h"
+#include "thread.h"
+
+namespace dmJobSystem
+{
+    static const uint32_t MAX_WORKERS = 32;
+    static const uint32_t MAX_DEFAULT_WORKERS = 8;
+    static const uint32_t MAX_JOBS = 0xffff;
+    static const uint32_t MAX_DEPENDENTS = 8;
+    // Upper limit of batches per ParallelFor call, the batch descriptors live on the stack
+    static const uint32_t MAX_PARALLEL_FOR_BATCHES = 256;
+    // Batches per thread in ParallelFor, more than one so that uneven batches can be stolen
+    static const uint32_t PARALLEL_FOR_BATCHES_PER_THREAD = 4;
+
+    struct Job
+    {
+        JobFunction     m_Function;
+        void*           m_Context;
+        void*           m_Data;
+        const char*     m_Name;
+        uint32_t        m_NameHash;
+        HJob            m_Parent;
+        uint32_t        m_Flags;
+        // Lower 16 bits are matched against the handle, incremented when the job completes
+        int32_atomic_t  m_Generation;
+        // The execution of the job itself plus the number of unfinished children
+        int32_atomic_t  m_Unfinished;
+        // The pending Run() call plus the number of unfinished dependencies
+        int32_atomic_t  m_Pending;
+        // Jobs waiting for this job to complete. Protected by Context::m_DependencyLock
+        HJob            m_Dependents[MAX_DEPENDENTS];
+        uint32_t        m_DependentCount;
+    };
+
+    /*
+     * Deque of runnable jobs owned by one thread. The owner pushes and pops at the bottom
+     * and other threads steal from the top, so the owner keeps working on the most recently
+     * created (cache warm) jobs while thieves take the oldest ones.
+     * The capacity equals the max number of jobs, so a push never fails.
+     */
+    struct JobQueue
+    {
+        dmSpinlock::lock_t  m_Lock;
+        HJob*               m_Jobs;
+        uint32_t            m_Capacity;
+        uint32_t            m_Top;
+        uint32_t            m_Bottom;
+    };
+
+    struct Worker
+    {
+        struct Context*     m_Context;
+        uint32_t            m_Index;
+        dmThread::Thread    m_Thread;
+    };
+
+    struct Context
+    {
+        Job*                            m_Jobs;
+        uint16_t*                       m_FreeJobs;
+        uint32_t                        m_FreeJobCount;
+        uint32_t                        m_MaxJobs;
+        dmSpinlock::lock_t              m_FreeJobsLock;
+        dmSpinlock::lock_t              m_DependencyLock;
+
+        // One queue for the main thread followed by one per worker
+        JobQueue                        m_Queues[MAX_WORKERS + 1];
+        // Jobs with main thread affinity
+        JobQueue                        m_MainQueue;
+        Worker                          m_Workers[MAX_WORKERS];
+        uint32_t                        m_WorkerCount;
+
+        // Maps the current thread to its queue index + 1, 0 for threads outside the context
+        dmThread::TlsKey                m_ThreadIndexKey;
+
+        dmMutex::HMutex                 m_Mutex;
+        dmConditionVariable::HConditionVariable m_Condition;
+        // Signaled when a job completes or is queued while threads are blocked in Wait()
+        dmConditionVariable::HConditionVariable m_WaitCondition;
+        // Number of jobs in m_Queues
+        int32_atomic_t                  m_QueuedCount;
+        int32_atomic_t                  m_SleepingCount;
+        int32_atomic_t                  m_WaitingCount;
+        int32_atomic_t                  m_Run;
+    };
+
+    struct ParallelForBatch
+    {
+        ParallelForFunction m_Function;
+        void*               m_Context;
+        uint32_t            m_Begin;
+        uint32_t            m_End;
+    };
+
+    static uint32_t GetCpuCount()
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO system_info;
+        ::GetSystemInfo(&system_info);
+        return (uint32_t) system_info.dwNumberOfProcessors;
+#elif defined(__EMSCRIPTEN__)
+        return 1;
+#else
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (uint32_t) count : 1;
+#endif
+    }
+
+    NewContextParams::NewContextParams()
+    {
+        uint32_t cpu_count = GetCpuCount();
+        m_WorkerCount = dmMath::Min(cpu_count - 1, MAX_DEFAULT_WORKERS);
+        m_MaxJobs = 4096;
+    }
+
+    static inline HJob MakeHandle(uint32_t index, uint32_t generation)
+    {
+        return ((generation & 0xffff) << 16) | index;
+    }
+
+    static inline uint32_t GetIndex(HJob job)
+    {
+        return job & 0xffff;
+    }
+
+    static inline uint32_t GetGeneration(HJob job)
+    {
+        return job >> 16;
+    }
+
+    static inline Job* GetJob(HContext context, HJob job)
+    {
+        uint32_t index = GetIndex(job);
+        assert(index < context->m_MaxJobs);
+        return &context->m_Jobs[index];
+    }
+
+    static inline bool IsAlive(Job* job, HJob handle)
+    {
+        // Full barrier, so that the job results are visible once the job is observed as completed
+        uint32_t generation = (uint32_t) dmAtomicAdd32(&job->m_Generation, 0);
+        return (generation & 0xffff) == GetGeneration(handle);
+    }
+
+    static void InitQueue(JobQueue* queue, uint32_t capacity)
+    {
+        dmSpinlock::Init(&queue->m_Lock);
+        queue->m_Jobs = new HJob[capacity];
+        queue->m_Capacity = capacity;
+        queue->m_Top = 0;
+        queue->m_Bottom = 0;
+    }
+
+    static void FreeQueue(JobQueue* queue)
+    {
+        delete [] queue->m_Jobs;
+    }
+
+    static void PushBottom(JobQueue* queue, HJob job)
+    {
+        dmSpinlock::Lock(&queue->m_Lock);
+        assert(queue->m_Bottom - queue->m_Top < queue->m_Capacity);
+        queue->m_Jobs[queue->m_Bottom % queue->m_Capacity] = job;
+        queue->m_Bottom++;
+        dmSpinlock::Unlock(&queue->m_Lock);
+    }
+
+    static HJob PopBottom(JobQueue* queue)
+    {
+        HJob job = INVALID_JOB;
+        dmSpinlock::Lock(&queue->m_Lock);
+        if (queue->m_Bottom != queue->m_Top)
+        {
+            queue->m_Bottom--;
+            job = queue->m_Jobs[queue->m_Bottom % queue->m_Capacity];
+        }
+        dmSpinlock::Unlock(&queue->m_Lock);
+        return job;
+    }
+
+    static HJob PopTop(JobQueue* queue)
+    {
+        HJob job = INVALID_JOB;
+        dmSpinlock::Lock(&queue->m_Lock);
+        if (queue->m_Bottom != queue->m_Top)
+        {
+            job = queue->m_Jobs[queue->m_Top % queue->m_Capacity];
+            queue->m_Top++;
+        }
+        dmSpinlock::Unlock(&queue->m_Lock);
+        return job;
+    }
+
+    // Returns the queue index of the current thread, or -1 if the thread doesn't belong to the context
+    static inline int32_t GetThreadIndex(HContext context)
+    {
+        uintptr_t value = (uintptr_t) dmThread::GetTlsValue(context->m_ThreadIndexKey);
+        return (int32_t) value - 1;
+    }
+
+    static void WakeWorker(HContext context)
+    {
+        if (dmAtomicAdd32(&context->m_SleepingCount, 0) > 0)
+        {
+            dmMutex::Lock(context->m_Mutex);
+            dmConditionVariable::Signal(context->m_Condition);
+            dmMutex::Unlock(context->m_Mutex);
+        }
+    }
+
+    // Same protocol as the workers, the waiting count is read after the queue or job state has been updated
+    static void WakeWaiters(HContext context)
+    {
+        if (dmAtomicAdd32(&context->m_WaitingCount, 0) > 0)
+        {
+            dmMutex::Lock(context->m_Mutex);
+            dmConditionVariable::Broadcast(context->m_WaitCondition);
+            dmMutex::Unlock(context->m_Mutex);
+        }
+    }
+
+    // Called when all dependencies of the job have completed and Run() has been called
+    static void Schedule(HContext context, HJob job)
+    {
+        Job* j = GetJob(context, job);
+        if (j->m_Flags & JOB_FLAG_MAIN_THREAD)
+        {
+            PushBottom(&context->m_MainQueue, job);
+            WakeWaiters(context);
+            return;
+        }
+
+        // Threads outside the context push to the main thread queue, where the workers steal from
+        int32_t thread_index = GetThreadIndex(context);
+        PushBottom(&context->m_Queues[thread_index < 0 ? 0 : thread_index], job);
+        dmAtomicIncrement32(&context->m_QueuedCount);
+        WakeWorker(context);
+        WakeWaiters(context);
+    }
+
+    static void DependencyDone(HContext context, HJob job)
+    {
+        Job* j = GetJob(context, job);
+        if (dmAtomicDecrement32(&j->m_Pending) == 1)
+        {
+            Schedule(context, job);
+        }
+    }
+
+    static void FreeJob(HContext context, uint32_t index)
+    {
+        dmSpinlock::Lock(&context->m_FreeJobsLock);
+        context->m_FreeJobs[context->m_FreeJobCount++] = (uint16_t) index;
+        dmSpinlock::Unlock(&context->m_FreeJobsLock);
+    }
+
+    static void Finish(HContext context, HJob job)
+    {
+        while (job != INVALID_JOB)
+        {
+            Job* j = GetJob(context, job);
+            if (dmAtomicDecrement32(&j->m_Unfinished) != 1)
+            {
+                return;
+            }
+
+            HJob dependents[MAX_DEPENDENTS];
+            dmSpinlock::Lock(&context->m_DependencyLock);
+            uint32_t dependent_count = j->m_DependentCount;
+            memcpy(dependents, j->m_Dependents, sizeof(HJob) * dependent_count);
+            dmAtomicIncrement32(&j->m_Generation);
+            dmSpinlock::Unlock(&context->m_DependencyLock);
+
+            HJob parent = j->m_Parent;
+            FreeJob(context, GetIndex(job));
+            WakeWaiters(context);
+
+            for (uint32_t i = 0; i < dependent_count; ++i)
+            {
+                DependencyDone(context, dependents[i]);
+            }
+
+            job = parent;
+        }
+    }
+
+    static void Execute(HContext context, HJob job)
+    {
+        Job* j = GetJob(context, job);
+        if (j->m_Function)
+        {
+            DM_PROFILE_DYN(JobSystem, j->m_Name, j->m_NameHash);
+            j->m_Function(j->m_Context, j->m_Data);
+        }
+        DM_COUNTER("JobSystem.Jobs", 1);
+        Finish(context, job);
+    }
+
+    static HJob TakeJob(HContext context, int32_t thread_index)
+    {
+        if (thread_index == 0)
+        {
+            HJob job = PopBottom(&context->m_MainQueue);
+            if (job != INVALID_JOB)
+            {
+                return job;
+            }
+        }
+
+        if (dmAtomicAdd32(&context->m_QueuedCount, 0) == 0)
+        {
+            return INVALID_JOB;
+        }
+
+        if (thread_index >= 0)
+        {
+            HJob job = PopBottom(&context->m_Queues[thread_index]);
+            if (job != INVALID_JOB)
+            {
+                dmAtomicDecrement32(&context->m_QueuedCount);
+                return job;
+            }
+        }
+
+        uint32_t queue_count = context->m_WorkerCount + 1;
+        uint32_t start = thread_index < 0 ? 0 : (uint32_t) thread_index + 1;
+        for (uint32_t i = 0; i < queue_count; ++i)
+        {
+            uint32_t victim = (start + i) % queue_count;
+            if ((int32_t) victim == thread_index)
+            {
+                continue;
+            }
+            HJob job = PopTop(&context->m_Queues[victim]);
+            if (job != INVALID_JOB)
+            {
+                dmAtomicDecrement32(&context->m_QueuedCount);
+                DM_COUNTER("JobSystem.Stolen", 1);
+                return job;
+            }
+        }
+        return INVALID_JOB;
+    }
+
+    static void WorkerThread(void* arg)
+    {
+        Worker* worker = (Worker*) arg;
+        HContext context = worker->m_Context;
+        dmThread::SetTlsValue(context->m_ThreadIndexKey, (void*) (uintptr_t) (worker->m_Index + 1));
+
+        while (dmAtomicAdd32(&context->m_Run, 0))
+        {
+            HJob job = TakeJob(context, (int32_t) worker->m_Index);
+            if (job != INVALID_JOB)
+            {
+                Execute(context, job);
+                continue;
+            }
+
+            // The sleeping count is raised before the queued count is checked, and Schedule() raises the
+            // queued count before it checks the sleeping count, so a wake up can't be missed
+            dmMutex::Lock(context->m_Mutex);
+            dmAtomicIncrement32(&context->m_SleepingCount);
+            while (dmAtomicAdd32(&context->m_Run, 0) && dmAtomicAdd32(&context->m_QueuedCount, 0) == 0)
+            {
+                dmConditionVariable::Wait(context->m_Condition, context->m_Mutex);
+            }
+            dmAtomicDecrement32(&context->m_SleepingCount);
+            dmMutex::Unlock(context->m_Mutex);
+        }
+    }
+
+    HContext New(const NewContextParams& params)
+    {
+        Context* context = new Context;
+        memset(context, 0, sizeof(Context));
+
+        uint32_t max_jobs = dmMath::Min(dmMath::Max(params.m_MaxJobs, 1U), MAX_JOBS);
+        context->m_MaxJobs = max_jobs;
+        context->m_Jobs = new Job[max_jobs];
+        memset(context->m_Jobs, 0, sizeof(Job) * max_jobs);
+        context->m_FreeJobs = new uint16_t[max_jobs];
+        for (uint32_t i = 0; i < max_jobs; ++i)
+        {
+            // Pop from the end, so that low indices are used first
+            context->m_FreeJobs[i] = (uint16_t) (max_jobs - 1 - i);
+        }
+        context->m_FreeJobCount = max_jobs;
+        dmSpinlock::Init(&context->m_FreeJobsLock);
+        dmSpinlock::Init(&context->m_DependencyLock);
+
+#if defined(__EMSCRIPTEN__)
+        context->m_WorkerCount = 0;
+#else
+        context->m_WorkerCount = dmMath::Min(params.m_WorkerCount, MAX_WORKERS);
+#endif
+
+        for (uint32_t i = 0; i < context->m_WorkerCount + 1; ++i)
+        {
+            InitQueue(&context->m_Queues[i], max_jobs);
+        }
+        InitQueue(&context->m_MainQueue, max_jobs);
+
+        context->m_ThreadIndexKey = dmThread::AllocTls();
+        dmThread::SetTlsValue(context->m_ThreadIndexKey, (void*) (uintptr_t) 1);
+
+        context->m_Mutex = dmMutex::New();
+        context->m_Condition = dmConditionVariable::New();
+        context->m_WaitCondition = dmConditionVariable::New();
+        context->m_Run = 1;
+
+        for (uint32_t i = 0; i < context->m_WorkerCount; ++i)
+        {
+            Worker* worker = &context->m_Workers[i];
+            worker->m_Context = context;
+            worker->m_Index = i + 1;
+            worker->m_Thread = dmThread::New(WorkerThread, 0x80000, worker, "dmJobWorker");
+        }
+
+        return context;
+    }
+
+    void Delete(HContext context)
+    {
+        dmMutex::Lock(context->m_Mutex);
+        dmAtomicStore32(&context->m_Run, 0);
+        dmConditionVariable::Broadcast(context->m_Condition);
+        dmMutex::Unlock(context->m_Mutex);
+
+        for (uint32_t i = 0; i < context->m_WorkerCount; ++i)
+        {
+            dmThread::Join(context->m_Workers[i].m_Thread);
+        }
+
+        dmConditionVariable::Delete(context->m_WaitCondition);
+        dmConditionVariable::Delete(context->m_Condition);
+        dmMutex::Delete(context->m_Mutex);
+        dmThread::FreeTls(context->m_ThreadIndexKey);
+
+        for (uint32_t i = 0; i < context->m_WorkerCount + 1; ++i)
+        {
+            FreeQueue(&context->m_Queues[i]);
+        }
+        FreeQueue(&context->m_MainQueue);
+
+        delete [] context->m_FreeJobs;
+        delete [] context->m_Jobs;
+        delete context;
+    }
+
+    uint32_t GetWorkerCount(HContext context)
+    {
+        return context->m_WorkerCount;
+    }
+
+    HJob CreateJob(HContext context, JobFunction function, void* job_context, void* data, HJob parent, uint32_t flags, const char* name)
+    {
+        dmSpinlock::Lock(&context->m_FreeJobsLock);
+        if (context->m_FreeJobCount == 0)
+        {
+            dmSpinlock::Unlock(&context->m_FreeJobsLock);
+            dmLogWarning("Unable to create job, out of job slots (%d).", context->m_MaxJobs);
+            return INVALID_JOB;
+        }
+        uint32_t index = context->m_FreeJobs[--context->m_FreeJobCount];
+        dmSpinlock::Unlock(&context->m_FreeJobsLock);
+
+        Job* j = &context->m_Jobs[index];
+        j->m_Function = function;
+        j->m_Context = job_context;
+        j->m_Data = data;
+        j->m_Name = name ? name : "Job";
+        j->m_NameHash = dmProfile::GetNameHash(j->m_Name, (uint32_t) strlen(j->m_Name));
+        j->m_Parent = parent;
+        j->m_Flags = flags;
+        j->m_Unfinished = 1;
+        j->m_Pending = 1;
+        j->m_DependentCount = 0;
+
+        if (parent != INVALID_JOB)
+        {
+            Job* p = GetJob(context, parent);
+            assert(IsAlive(p, parent) && "The parent job has already completed");
+            dmAtomicIncrement32(&p->m_Unfinished);
+        }
+
+        // Waiters holding stale handles to this slot may read the generation concurrently
+        return MakeHandle(index, (uint32_t) dmAtomicAdd32(&j->m_Generation, 0));
+    }
+
+    bool AddDependency(HContext context, HJob job, HJob dependency)
+    {
+        Job* j = GetJob(context, job);
+        Job* d = GetJob(context, dependency);
+        bool result = true;
+
+        dmSpinlock::Lock(&context->m_DependencyLock);
+        if (IsAlive(d, dependency))
+        {
+            if (d->m_DependentCount < MAX_DEPENDENTS)
+            {
+                d->m_Dependents[d->m_DependentCount++] = job;
+                dmAtomicIncrement32(&j->m_Pending);
+            }
+            else
+            {
+                result = false;
+            }
+        }
+        dmSpinlock::Unlock(&context->m_DependencyLock);
+        return result;
+    }
+
+    void Run(HContext context, HJob job)
+    {
+        DependencyDone(context, job);
+    }
+
+    bool IsCompleted(HContext context, HJob job)
+    {
+        return !IsAlive(GetJob(context, job), job);
+    }
+
+    static bool HasQueuedJobs(HContext context, int32_t thread_index)
+    {
+        if (dmAtomicAdd32(&context->m_QueuedCount, 0) > 0)
+        {
+            return true;
+        }
+        if (thread_index == 0)
+        {
+            dmSpinlock::Lock(&context->m_MainQueue.m_Lock);
+            bool empty = context->m_MainQueue.m_Bottom == context->m_MainQueue.m_Top;
+            dmSpinlock::Unlock(&context->m_MainQueue.m_Lock);
+            return !empty;
+        }
+        return false;
+    }
+
+    void Wait(HContext context, HJob job)
+    {
+        int32_t thread_index = GetThreadIndex(context);
+        Job* j = GetJob(context, job);
+        while (IsAlive(j, job))
+        {
+            HJob other = TakeJob(context, thread_index);
+            if (other != INVALID_JOB)
+            {
+                Execute(context, other);
+                continue;
+            }
+
+            // The remaining work is running on other threads. The waiting count is raised before the job and
+            // queues are checked, and Finish()/Schedule() update them before they check the waiting count.
+            dmMutex::Lock(context->m_Mutex);
+            dmAtomicIncrement32(&context->m_WaitingCount);
+            while (IsAlive(j, job) && !HasQueuedJobs(context, thread_index))
+            {
+                dmConditionVariable::Wait(context->m_WaitCondition, context->m_Mutex);
+            }
+            dmAtomicDecrement32(&context->m_WaitingCount);
+            dmMutex::Unlock(context->m_Mutex);
+        }
+    }
+
+    uint32_t RunMainThreadJobs(HContext context)
+    {
+        assert(GetThreadIndex(context) == 0 && "Must be called from the thread that created the context");
+        uint32_t count = 0;
+        HJob job;
+        while ((job = PopBottom(&context->m_MainQueue)) != INVALID_JOB)
+        {
+            Execute(context, job);
+            ++count;
+        }
+        return count;
+    }
+
+    static void ParallelForJob(void* context, void* data)
+    {
+        (void) context;
+        ParallelForBatch* batch = (ParallelForBatch*) data;
+        batch->m_Function(batch->m_Context, batch->m_Begin, batch->m_End);
+    }
+
+    void ParallelFor(HContext context, ParallelForFunction function, void* function_context, uint32_t count, uint32_t min_batch_size)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        min_batch_size = dmMath::Max(min_batch_size, 1U);
+        uint32_t batch_count = count / min_batch_size;
+        uint32_t max_batch_count = dmMath::Min((context->m_WorkerCount + 1) * PARALLEL_FOR_BATCHES_PER_THREAD, MAX_PARALLEL_FOR_BATCHES);
+        batch_count = dmMath::Min(batch_count, max_batch_count);
+        if (context->m_WorkerCount == 0 || batch_count <= 1)
+        {
+            function(function_context, 0, count);
+            return;
+        }
+
+        HJob parent = CreateJob(context, 0, 0, 0, INVALID_JOB, 0, "ParallelFor");
+        if (parent == INVALID_JOB)
+        {
+            function(function_context, 0, count);
+            return;
+        }
+
+        ParallelForBatch batches[MAX_PARALLEL_FOR_BATCHES];
+        for (uint32_t i = 0; i < batch_count; ++i)
+        {
+            ParallelForBatch* batch = &batches[i];
+            batch->m_Function = function;
+            batch->m_Context = function_context;
+            batch->m_Begin = (uint32_t) (((uint64_t) count * i) / batch_count);
+            batch->m_End = (uint32_t) (((uint64_t) count * (i + 1)) / batch_count);
+
+            HJob job = CreateJob(context, ParallelForJob, 0, batch, parent, 0, "ParallelForBatch");
+            if (job != INVALID_JOB)
+            {
+                Run(context, job);
+            }
+            else
+            {
+                ParallelForJob(0, batch);
+            }
+        }
+
+        Run(context, parent);
+        Wait(context, parent);
+    }
+}
@@ -0,0 +1,228 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DMSDK_JOB_SYSTEM_H
+#define DMSDK_JOB_SYSTEM_H
+
+#include <stdint.h>
+
+namespace dmJobSystem
+{
+    /*# SDK Job System API documentation
+     * [file:<dmsdk/dlib/job_system.h>]
+     *
+     * A work stealing job scheduler. Each worker thread (and the thread that created the context)
+     * owns a queue of jobs, pushing and popping jobs at one end while idle threads steal jobs
+     * from the other end.
+     *
+     * Jobs may have a parent, in which case the parent is not completed until all its children
+     * are completed, and dependencies, in which case the job is not started until all its
+     * dependencies are completed.
+     *
+     * Jobs with main thread affinity are only run by the thread that created the context,
+     * either in [ref:dmJobSystem::Wait] or [ref:dmJobSystem::RunMainThreadJobs].
+     *
+     * On platforms without thread support the context has no workers and all jobs are run
+     * by the thread waiting for them.
+     *
+     * @document
+     * @name Job System
+     * @namespace dmJobSystem
+     */
+
+    /*# HContext type definition
+     *
+     * ```cpp
+     * typedef struct Context* HContext;
+     * ```
+     *
+     * @typedef
+     * @name dmJobSystem::HContext
+     */
+    typedef struct Context* HContext;
+
+    /*# HJob type definition
+     *
+     * Job handle. The handle stays safe to use after the job has completed.
+     *
+     * ```cpp
+     * typedef uint32_t HJob;
+     * ```
+     *
+     * @typedef
+     * @name dmJobSystem::HJob
+     */
+    typedef uint32_t HJob;
+
+    /*# invalid job handle
+     *
+     * @constant
+     * @name dmJobSystem::INVALID_JOB
+     */
+    const HJob INVALID_JOB = 0xffffffff;
+
+    /*# job function
+     *
+     * @typedef
+     * @name dmJobSystem::JobFunction
+     * @param context [type:void*] The context passed to [ref:dmJobSystem::CreateJob]
+     * @param data [type:void*] The data passed to [ref:dmJobSystem::CreateJob]
+     */
+    typedef void (*JobFunction)(void* context, void* data);
+
+    /*# parallel for function
+     *
+     * @typedef
+     * @name dmJobSystem::ParallelForFunction
+     * @param context [type:void*] The context passed to [ref:dmJobSystem::ParallelFor]
+     * @param begin [type:uint32_t] First index of the range to process
+     * @param end [type:uint32_t] One past the last index of the range to process
+     */
+    typedef void (*ParallelForFunction)(void* context, uint32_t begin, uint32_t end);
+
+    /*# job flags
+     *
+     * @enum
+     * @name dmJobSystem::JobFlags
+     * @member JOB_FLAG_MAIN_THREAD The job is only run on the thread that created the context
+     */
+    enum JobFlags
+    {
+        JOB_FLAG_MAIN_THREAD = 1 << 0,
+    };
+
+    /*# context creation parameters
+     *
+     * @struct
+     * @name dmJobSystem::NewContextParams
+     * @member m_WorkerCount [type:uint32_t] Number of worker threads. Default is the number of cpu cores minus one (the creating thread), at most 8.
+     * @member m_MaxJobs [type:uint32_t] Max number of jobs that may be alive at the same time. Default is 4096.
+     */
+    struct NewContextParams
+    {
+        uint32_t m_WorkerCount;
+        uint32_t m_MaxJobs;
+
+        NewContextParams();
+    };
+
+    /*# create a job system context
+     *
+     * Creates the worker threads. The calling thread is the main thread of the context.
+     *
+     * @name dmJobSystem::New
+     * @param params [type:dmJobSystem::NewContextParams] Parameters
+     * @return context [type:dmJobSystem::HContext] The context
+     */
+    HContext New(const NewContextParams& params);
+
+    /*# delete a job system context
+     *
+     * Waits for all the running jobs and joins the worker threads.
+     *
+     * @name dmJobSystem::Delete
+     * @param context [type:dmJobSystem::HContext] The context
+     */
+    void Delete(HContext context);
+
+    /*# get the worker count
+     *
+     * @name dmJobSystem::GetWorkerCount
+     * @param context [type:dmJobSystem::HContext] The context
+     * @return count [type:uint32_t] The number of worker threads, not counting the main thread
+     */
+    uint32_t GetWorkerCount(HContext context);
+
+    /*# create a job
+     *
+     * The job is not started until [ref:dmJobSystem::Run] is called.
+     *
+     * @name dmJobSystem::CreateJob
+     * @param context [type:dmJobSystem::HContext] The context
+     * @param function [type:dmJobSystem::JobFunction] The job function
+     * @param job_context [type:void*] Context passed to the job function
+     * @param data [type:void*] Data passed to the job function
+     * @param parent [type:dmJobSystem::HJob] Parent job, that won't complete until this job completes. May be INVALID_JOB.
+     * @param flags [type:uint32_t] Bit field of [ref:dmJobSystem::JobFlags]
+     * @param name [type:const char*] Name of the job used in the profiler, must be a literal or outlive the job. May be 0.
+     * @return job [type:dmJobSystem::HJob] The job, or INVALID_JOB if the max number of jobs has been reached
+     */
+    HJob CreateJob(HContext context, JobFunction function, void* job_context, void* data, HJob parent, uint32_t flags, const char* name);
+
+    /*# add a job dependency
+     *
+     * The job won't start until the dependency has completed. Must be called before the job is run.
+     *
+     * @name dmJobSystem::AddDependency
+     * @param context [type:dmJobSystem::HContext] The context
+     * @param job [type:dmJobSystem::HJob] The job
+     * @param dependency [type:dmJobSystem::HJob] The job to wait for
+     * @return result [type:bool] False if the dependency could not be added (too many dependents)
+     */
+    bool AddDependency(HContext context, HJob job, HJob dependency);
+
+    /*# run a job
+     *
+     * Schedules the job to run as soon as its dependencies have completed.
+     *
+     * @name dmJobSystem::Run
+     * @param context [type:dmJobSystem::HContext] The context
+     * @param job [type:dmJobSystem::HJob] The job
+     */
+    void Run(HContext context, HJob job);
+
+    /*# check if a job has completed
+     *
+     * @name dmJobSystem::IsCompleted
+     * @param context [type:dmJobSystem::HContext] The context
+     * @param job [type:dmJobSystem::HJob] The job
+     * @return result [type:bool] True if the job and all its children have completed
+     */
+    bool IsCompleted(HContext context, HJob job);
+
+    /*# wait for a job to complete
+     *
+     * The calling thread runs other jobs while waiting, and sleeps when there is nothing to run
+     * until the job completes or more jobs are queued.
+     *
+     * @name dmJobSystem::Wait
+     * @param context [type:dmJobSystem::HContext] The context
+     * @param job [type:dmJobSystem::HJob] The job
+     */
+    void Wait(HContext context, HJob job);
+
+    /*# run jobs with main thread affinity
+     *
+     * Must be called from the thread that created the context.
+     *
+     * @name dmJobSystem::RunMainThreadJobs
+     * @param context [type:dmJobSystem::HContext] The context
+     * @return count [type:uint32_t] The number of jobs that were run
+     */
+    uint32_t RunMainThreadJobs(HContext context);
+
+    /*# run a function over a range in parallel
+     *
+     * Splits the range [0, count) into batches of at least `min_batch_size` items, runs them
+     * on the workers and waits for all of them to complete.
+     *
+     * @name dmJobSystem::ParallelFor
+     * @param context [type:dmJobSystem::HContext] The context
+     * @param function [type:dmJobSystem::ParallelForFunction] The function to call for each batch
+     * @param function_context [type:void*] Context passed to the function
+     * @param count [type:uint32_t] Number of items
+     * @param min_batch_size [type:uint32_t] Minimum number of items per batch
+     */
+    void ParallelFor(HContext context, ParallelForFunction function, void* function_context, uint32_t count, uint32_t min_batch_size);
+}
+
+#endif // DMSDK_JOB_SYSTEM_H
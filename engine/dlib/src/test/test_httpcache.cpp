@@ -682,6 +682,108 @@ TEST_F(dmHttpCacheTest, Persist)
     dmHttpCache::Close(cache);
 }
 
+TEST_F(dmHttpCacheTest, PersistJournal)
+{
+    dmHttpCache::HCache cache;
+    dmHttpCache::NewParams params;
+    params.m_Path = "tmp/cache";
+    dmHttpCache::Result r = dmHttpCache::Open(&params, &cache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+
+    const char* data1 = "data1";
+    const char* data2 = "data2";
+    const char* data3 = "data3";
+    r = Put(cache, "uri1", "etag1", data1, strlen(data1));
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    r = Put(cache, "uri2", "etag2", data2, strlen(data2));
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, dmHttpCache::Flush(cache));
+
+    // Appended to the index on flush
+    r = Put(cache, "uri1", "etag1b", data3, strlen(data3));
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, dmHttpCache::Flush(cache));
+    dmHttpCache::Close(cache);
+
+    // Simulate a partially written record at the end of the index
+    FILE* f = fopen("tmp/cache/index", "ab");
+    ASSERT_NE((FILE*) 0, f);
+    fwrite("partial record", 1, 14, f);
+    fclose(f);
+
+    r = dmHttpCache::Open(&params, &cache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(2U, dmHttpCache::GetEntryCount(cache));
+
+    char etag[16];
+    r = dmHttpCache::GetETag(cache, "uri1", etag, sizeof(etag));
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_STREQ("etag1b", etag);
+
+    void* buffer = 0;
+    uint64_t checksum;
+    r = Get(cache, "uri1", "etag1b", &buffer, &checksum);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(dmHashString64(data3), checksum);
+    ASSERT_TRUE(memcmp(data3, buffer, strlen(data3)) == 0);
+    free(buffer);
+
+    r = Get(cache, "uri2", "etag2", &buffer, &checksum);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_TRUE(memcmp(data2, buffer, strlen(data2)) == 0);
+    free(buffer);
+    dmHttpCache::Close(cache);
+
+    // The damaged index is rewritten when closed
+    r = dmHttpCache::Open(&params, &cache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(2U, dmHttpCache::GetEntryCount(cache));
+    dmHttpCache::Close(cache);
+}
+
+TEST_F(dmHttpCacheTest, GetMapped)
+{
+    dmHttpCache::HCache cache;
+    dmHttpCache::NewParams params;
+    params.m_Path = "tmp/cache";
+    dmHttpCache::Result r = dmHttpCache::Open(&params, &cache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+
+    const char* data = "mapped data";
+    r = Put(cache, "uri", "etag", data, strlen(data));
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    r = Put(cache, "empty", "etag", "", 0);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+
+    const void* content;
+    uint32_t content_size;
+    uint64_t checksum;
+    r = dmHttpCache::GetMapped(cache, "uri", "other", &content, &content_size, &checksum);
+    ASSERT_EQ(dmHttpCache::RESULT_NO_ENTRY, r);
+
+    r = dmHttpCache::GetMapped(cache, "uri", "etag", &content, &content_size, &checksum);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(strlen(data), content_size);
+    ASSERT_EQ(dmHashString64(data), checksum);
+    ASSERT_TRUE(memcmp(data, content, content_size) == 0);
+
+    // The entry is read locked while mapped
+    r = Put(cache, "uri", "etag2", data, strlen(data));
+    ASSERT_EQ(dmHttpCache::RESULT_LOCKED, r);
+    r = dmHttpCache::ReleaseMapped(cache, "uri", "etag", content, content_size);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    r = Put(cache, "uri", "etag2", data, strlen(data));
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+
+    r = dmHttpCache::GetMapped(cache, "empty", "etag", &content, &content_size, &checksum);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+    ASSERT_EQ(0U, content_size);
+    r = dmHttpCache::ReleaseMapped(cache, "empty", "etag", content, content_size);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, r);
+
+    dmHttpCache::Close(cache);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
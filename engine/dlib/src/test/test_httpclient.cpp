@@ -391,6 +391,133 @@ TEST_P(dmHttpClientTest, Simple)
     }
 }
 
+struct HttpMultiRequest
+{
+    int m_Expected;
+    int m_Completed;
+    int m_StatusCode;
+    dmHttpClient::Result m_Result;
+    std::string m_Content;
+};
+
+static void HttpMultiCallback(dmHttpClient::HMulti multi, void* user_data, dmHttpClient::Result result, int status_code, const void* content, uint32_t content_size)
+{
+    HttpMultiRequest* request = (HttpMultiRequest*) user_data;
+    request->m_Completed++;
+    request->m_Result = result;
+    request->m_StatusCode = status_code;
+    request->m_Content.assign((const char*) content, content_size);
+}
+
+static void RunMulti(dmHttpClient::HMulti multi)
+{
+    uint64_t start = dmTime::GetTime();
+    while (dmHttpClient::MultiUpdate(multi, 100 * 1000) > 0)
+    {
+        ASSERT_GT(start + 30 * 1000000, dmTime::GetTime());
+    }
+}
+
+TEST_P(dmHttpClientTest, MultiPipelined)
+{
+    if (strcmp(m_URI.m_Scheme, "https") == 0)
+        return; // The multi client only supports plain http
+
+    dmHttpClient::MultiParams params;
+    params.m_DNSChannel = m_DNSChannel;
+    params.m_MaxConnections = 2;
+    params.m_MaxPipelineDepth = 8;
+    dmHttpClient::HMulti multi = dmHttpClient::NewMulti(&params);
+
+    const int count = 100;
+    HttpMultiRequest requests[count];
+    for (int i = 0; i < count; ++i)
+    {
+        char buf[128];
+        dmSnPrintf(buf, sizeof(buf), "/add/%d/1000", i);
+        requests[i].m_Expected = 1000 + i;
+        requests[i].m_Completed = 0;
+        ASSERT_EQ(dmHttpClient::RESULT_OK, dmHttpClient::MultiGet(multi, m_URI.m_Hostname, m_URI.m_Port, buf, HttpMultiCallback, &requests[i]));
+    }
+
+    RunMulti(multi);
+
+    for (int i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(1, requests[i].m_Completed);
+        ASSERT_EQ(dmHttpClient::RESULT_OK, requests[i].m_Result);
+        ASSERT_EQ(200, requests[i].m_StatusCode);
+        ASSERT_EQ(requests[i].m_Expected, strtol(requests[i].m_Content.c_str(), 0, 10));
+    }
+
+    dmHttpClient::Statistics stats;
+    dmHttpClient::GetStatistics(multi, &stats);
+    ASSERT_EQ((uint32_t) count, stats.m_Responses);
+
+    dmHttpClient::DeleteMulti(multi);
+}
+
+TEST_P(dmHttpClientTest, MultiNoKeepAlive)
+{
+    if (strcmp(m_URI.m_Scheme, "https") == 0)
+        return; // The multi client only supports plain http
+
+    dmHttpClient::MultiParams params;
+    params.m_DNSChannel = m_DNSChannel;
+    params.m_MaxConnections = 1;
+    dmHttpClient::HMulti multi = dmHttpClient::NewMulti(&params);
+
+    // Requests pipelined after a "Connection: close" response must be resent on a new connection
+    const int count = 16;
+    HttpMultiRequest requests[count];
+    for (int i = 0; i < count; ++i)
+    {
+        char buf[128];
+        if (i % 3 == 1)
+            dmStrlCpy(buf, "/no-keep-alive", sizeof(buf));
+        else
+            dmSnPrintf(buf, sizeof(buf), "/add/%d/1000", i);
+        requests[i].m_Expected = 1000 + i;
+        requests[i].m_Completed = 0;
+        ASSERT_EQ(dmHttpClient::RESULT_OK, dmHttpClient::MultiGet(multi, m_URI.m_Hostname, m_URI.m_Port, buf, HttpMultiCallback, &requests[i]));
+    }
+
+    RunMulti(multi);
+
+    for (int i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(1, requests[i].m_Completed);
+        ASSERT_EQ(dmHttpClient::RESULT_OK, requests[i].m_Result);
+        if (i % 3 == 1)
+            ASSERT_STREQ("will close connection now.", requests[i].m_Content.c_str());
+        else
+            ASSERT_EQ(requests[i].m_Expected, strtol(requests[i].m_Content.c_str(), 0, 10));
+    }
+
+    dmHttpClient::DeleteMulti(multi);
+}
+
+TEST_P(dmHttpClientTest, MultiConnectionRefused)
+{
+    if (strcmp(m_URI.m_Scheme, "https") == 0)
+        return; // The multi client only supports plain http
+
+    dmHttpClient::MultiParams params;
+    params.m_DNSChannel = m_DNSChannel;
+    dmHttpClient::HMulti multi = dmHttpClient::NewMulti(&params);
+
+    HttpMultiRequest request;
+    request.m_Completed = 0;
+    ASSERT_EQ(dmHttpClient::RESULT_OK, dmHttpClient::MultiGet(multi, "localhost", 1, "/", HttpMultiCallback, &request));
+    RunMulti(multi);
+
+    ASSERT_EQ(1, request.m_Completed);
+    ASSERT_EQ(dmHttpClient::RESULT_SOCKET_ERROR, request.m_Result);
+    ASSERT_EQ(-1, request.m_StatusCode);
+
+    dmHttpClient::DeleteMulti(multi);
+}
+
 struct HttpStressHelper
 {
     int m_StatusCode;
@@ -1028,6 +1155,67 @@ TEST_P(dmHttpClientTestCache, TrustCacheNoValidate)
     ASSERT_EQ(dmHttpCache::RESULT_OK, cache_r);
 }
 
+TEST_P(dmHttpClientTestCache, BatchValidateCacheAsync)
+{
+    dmHttpClient::Delete(m_Client);
+
+    // Reinit client with http-cache
+    dmHttpClient::NewParams params;
+    params.m_Userdata = this;
+    params.m_HttpContent = dmHttpClientTest::HttpContent;
+    params.m_HttpHeader = dmHttpClientTest::HttpHeader;
+    params.m_DNSChannel = m_DNSChannel;
+    dmHttpCache::NewParams cache_params;
+    cache_params.m_Path = "tmp/cache";
+    dmHttpCache::Result cache_r = dmHttpCache::Open(&cache_params, &params.m_HttpCache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, cache_r);
+    m_Client = dmHttpClient::New(&params, m_URI.m_Hostname, m_URI.m_Port);
+    ASSERT_NE((void*) 0, m_Client);
+
+    // Warmup cache
+    GetFiles(true);
+
+    // Reopen
+    dmHttpClient::Delete(m_Client);
+    cache_r = dmHttpCache::Close(params.m_HttpCache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, cache_r);
+    cache_r = dmHttpCache::Open(&cache_params, &params.m_HttpCache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, cache_r);
+    m_Client = dmHttpClient::New(&params, m_URI.m_Hostname, m_URI.m_Port);
+    ASSERT_NE((void*) 0, m_Client);
+
+    dmHttpCacheVerify::HAsyncVerify verify;
+    dmHttpCacheVerify::Result verify_r = dmHttpCacheVerify::VerifyCacheAsync(params.m_HttpCache, &m_URI, 60 * 60 * 24 * 5, 3, &verify);
+    ASSERT_EQ(dmHttpCacheVerify::RESULT_OK, verify_r);
+
+    uint64_t start = dmTime::GetTime();
+    while (!dmHttpCacheVerify::IsDone(verify) && dmTime::GetTime() - start < 10 * 1000000)
+    {
+        dmTime::Sleep(1000);
+    }
+    ASSERT_TRUE(dmHttpCacheVerify::IsDone(verify));
+    ASSERT_EQ(dmHttpCacheVerify::RESULT_OK, dmHttpCacheVerify::GetResult(verify));
+
+    dmHttpCacheVerify::Statistics verify_stats;
+    dmHttpCacheVerify::GetStatistics(verify, &verify_stats);
+    ASSERT_EQ(dmHttpCache::GetEntryCount(params.m_HttpCache), verify_stats.m_Checked);
+    ASSERT_EQ(verify_stats.m_Checked, verify_stats.m_Reused);
+    ASSERT_EQ(0U, verify_stats.m_NotReused);
+    dmHttpCacheVerify::DeleteAsync(verify);
+
+    dmHttpCache::SetConsistencyPolicy(params.m_HttpCache, dmHttpCache::CONSISTENCY_POLICY_TRUST_CACHE);
+
+    GetFiles(true);
+    dmHttpClient::Statistics stats;
+    dmHttpClient::GetStatistics(m_Client, &stats);
+    // Zero responses, all direct from cache
+    ASSERT_EQ(0U, stats.m_Responses);
+    ASSERT_EQ(100U, stats.m_DirectFromCache);
+
+    cache_r = dmHttpCache::Close(params.m_HttpCache);
+    ASSERT_EQ(dmHttpCache::RESULT_OK, cache_r);
+}
+
 TEST_P(dmHttpClientTestCache, BatchValidateCache)
 {
     dmHttpClient::Delete(m_Client);
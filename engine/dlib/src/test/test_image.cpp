@@ -15,7 +15,11 @@
 #include <string.h>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
+#include "../dlib/array.h"
 #include "../dlib/image.h"
+#include "../dlib/image_private.h"
+#include "../dlib/zlib.h"
+#include "../zlib/zlib.h"
 
 #include "data/color_check_2x2.png.embed.h"
 #include "data/color_check_2x2_premult.png.embed.h"
@@ -276,6 +280,392 @@ TEST(dmImage, case2319)
     dmImage::Free(&image);
 }
 
+TEST(dmImage, GetInfo)
+{
+    dmImage::Image image;
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::GetInfo(CASE2319_JPG, CASE2319_JPG_SIZE, &image));
+    ASSERT_EQ(165U, image.m_Width);
+    ASSERT_EQ(240U, image.m_Height);
+    ASSERT_EQ(dmImage::TYPE_RGB, image.m_Type);
+    ASSERT_EQ((void*) 0, image.m_Buffer);
+
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::GetInfo(GRAY_ALPHA_CHECK_2X2_PNG, GRAY_ALPHA_CHECK_2X2_PNG_SIZE, &image));
+    ASSERT_EQ(dmImage::TYPE_LUMINANCE, image.m_Type);
+
+    ASSERT_EQ(dmImage::RESULT_IMAGE_ERROR, dmImage::GetInfo(0, 0, &image));
+}
+
+static void ExpectLoadIntoEqualsLoad(const void* data, uint32_t data_size, bool premult)
+{
+    dmImage::Image image;
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::Load(data, data_size, premult, &image));
+    uint32_t size = image.m_Width * image.m_Height * dmImage::BytesPerPixel(image.m_Type);
+    uint8_t* out = (uint8_t*) malloc(size);
+    uint32_t flags = premult ? dmImage::LOAD_FLAG_PREMULTIPLY : 0;
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::LoadInto(data, data_size, image.m_Type, flags, out, size));
+    ASSERT_EQ(0, memcmp(image.m_Buffer, out, size));
+    free(out);
+    dmImage::Free(&image);
+}
+
+TEST(dmImage, LoadInto)
+{
+    for (int iter = 0; iter < 2; iter++) {
+        ExpectLoadIntoEqualsLoad(COLOR_CHECK_2X2_PNG, COLOR_CHECK_2X2_PNG_SIZE, iter == 0);
+        ExpectLoadIntoEqualsLoad(COLOR_CHECK_2X2_INDEXED_PNG, COLOR_CHECK_2X2_INDEXED_PNG_SIZE, iter == 0);
+        ExpectLoadIntoEqualsLoad(COLOR16_CHECK_2X2_PNG, COLOR16_CHECK_2X2_PNG_SIZE, iter == 0);
+        ExpectLoadIntoEqualsLoad(GRAY_CHECK_2X2_PNG, GRAY_CHECK_2X2_PNG_SIZE, iter == 0);
+        ExpectLoadIntoEqualsLoad(GRAY_ALPHA_CHECK_2X2_PNG, GRAY_ALPHA_CHECK_2X2_PNG_SIZE, iter == 0);
+        ExpectLoadIntoEqualsLoad(CASE2319_JPG, CASE2319_JPG_SIZE, iter == 0);
+    }
+}
+
+TEST(dmImage, LoadIntoConvert)
+{
+    // Luminance + alpha to rgba keeps the alpha and premultiplies
+    uint8_t rgba[2 * 2 * 4];
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::LoadInto(GRAY_ALPHA_CHECK_2X2_PNG, GRAY_ALPHA_CHECK_2X2_PNG_SIZE, dmImage::TYPE_RGBA, dmImage::LOAD_FLAG_PREMULTIPLY, rgba, sizeof(rgba)));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(rgba[i * 4 + 0], rgba[i * 4 + 1]);
+        ASSERT_EQ(rgba[i * 4 + 0], rgba[i * 4 + 2]);
+        ASSERT_LE(rgba[i * 4 + 0], rgba[i * 4 + 3]);
+    }
+
+    // Rgb to rgba gets opaque alpha
+    dmImage::Image image;
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::Load(CASE2319_JPG, CASE2319_JPG_SIZE, false, &image));
+    uint32_t pixel_count = image.m_Width * image.m_Height;
+    uint8_t* out = (uint8_t*) malloc(pixel_count * 4);
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::LoadInto(CASE2319_JPG, CASE2319_JPG_SIZE, dmImage::TYPE_RGBA, dmImage::LOAD_FLAG_PREMULTIPLY, out, pixel_count * 4));
+    const uint8_t* b = (const uint8_t*) image.m_Buffer;
+    for (uint32_t i = 0; i < pixel_count; ++i) {
+        ASSERT_EQ(b[i * 3 + 0], out[i * 4 + 0]);
+        ASSERT_EQ(b[i * 3 + 1], out[i * 4 + 1]);
+        ASSERT_EQ(b[i * 3 + 2], out[i * 4 + 2]);
+        ASSERT_EQ(255U, (uint32_t) out[i * 4 + 3]);
+    }
+
+    // Flipped rows
+    ASSERT_EQ(dmImage::RESULT_OK, dmImage::LoadInto(CASE2319_JPG, CASE2319_JPG_SIZE, dmImage::TYPE_RGB, dmImage::LOAD_FLAG_FLIP_Y, out, pixel_count * 3));
+    uint32_t stride = image.m_Width * 3;
+    for (uint32_t y = 0; y < image.m_Height; ++y) {
+        ASSERT_EQ(0, memcmp(b + y * stride, out + (image.m_Height - 1 - y) * stride, stride));
+    }
+
+    ASSERT_EQ(dmImage::RESULT_BUFFER_TOO_SMALL, dmImage::LoadInto(CASE2319_JPG, CASE2319_JPG_SIZE, dmImage::TYPE_RGBA, 0, out, pixel_count * 3));
+    ASSERT_EQ(dmImage::RESULT_BUFFER_TOO_SMALL, dmImage::LoadInto(COLOR_CHECK_2X2_PNG, COLOR_CHECK_2X2_PNG_SIZE, dmImage::TYPE_RGBA, 0, out, 2 * 2 * 4 - 1));
+    ASSERT_EQ(dmImage::RESULT_IMAGE_ERROR, dmImage::LoadInto(0, 0, dmImage::TYPE_RGBA, 0, out, pixel_count * 4));
+
+    free(out);
+    dmImage::Free(&image);
+}
+
+static void AppendU32(dmArray<uint8_t>& out, uint32_t value)
+{
+    uint8_t bytes[] = {(uint8_t) (value >> 24), (uint8_t) (value >> 16), (uint8_t) (value >> 8), (uint8_t) value};
+    out.PushArray(bytes, sizeof(bytes));
+}
+
+static void AppendChunk(dmArray<uint8_t>& out, const char* type, const uint8_t* data, uint32_t size)
+{
+    if (out.Remaining() < size + 12)
+        out.OffsetCapacity(size + 12 + 4096);
+    AppendU32(out, size);
+    uint32_t crc_offset = out.Size();
+    out.PushArray((const uint8_t*) type, 4);
+    if (size > 0)
+        out.PushArray(data, size);
+    AppendU32(out, (uint32_t) crc32(0, &out[crc_offset], size + 4));
+}
+
+static bool DeflateWriter(void* context, const void* data, uint32_t size)
+{
+    dmArray<uint8_t>* out = (dmArray<uint8_t>*) context;
+    if (out->Remaining() < size)
+        out->OffsetCapacity(size + 64 * 1024);
+    out->PushArray((const uint8_t*) data, size);
+    return true;
+}
+
+static uint8_t FilterByte(uint32_t filter, int x, int a, int b, int c)
+{
+    switch (filter)
+    {
+    case 1: return (uint8_t) (x - a);
+    case 2: return (uint8_t) (x - b);
+    case 3: return (uint8_t) (x - ((a + b) >> 1));
+    case 4:
+        {
+            int p = a + b - c;
+            int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+            int predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+            return (uint8_t) (x - predictor);
+        }
+    default: return (uint8_t) x;
+    }
+}
+
+// Encodes an 8 bit png, with an optional transparent key color. The rows cycle through all the
+// filter types, and the data is split into several IDAT chunks, so that the decoder has to handle both.
+static void CreatePng(dmArray<uint8_t>& png, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t comp, const uint8_t* key = 0)
+{
+    static const uint8_t color_types[] = {0, 0, 4, 2, 6};
+    uint32_t row_size = width * comp;
+    dmArray<uint8_t> filtered;
+    filtered.SetCapacity((row_size + 1) * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        uint32_t filter = y % 5;
+        filtered.Push((uint8_t) filter);
+        const uint8_t* row = pixels + y * row_size;
+        const uint8_t* prev = y > 0 ? row - row_size : 0;
+        for (uint32_t i = 0; i < row_size; ++i)
+        {
+            int a = i >= comp ? row[i - comp] : 0;
+            int b = prev ? prev[i] : 0;
+            int c = (prev && i >= comp) ? prev[i - comp] : 0;
+            filtered.Push(FilterByte(filter, row[i], a, b, c));
+        }
+    }
+
+    dmArray<uint8_t> compressed;
+    ASSERT_EQ(dmZlib::RESULT_OK, dmZlib::DeflateBuffer(filtered.Begin(), filtered.Size(), 6, &compressed, DeflateWriter));
+
+    const uint8_t signature[] = {137, 80, 78, 71, 13, 10, 26, 10};
+    png.SetCapacity(compressed.Size() + 4096);
+    png.PushArray(signature, sizeof(signature));
+    uint8_t ihdr[13] = {0};
+    ihdr[0] = (uint8_t) (width >> 24); ihdr[1] = (uint8_t) (width >> 16); ihdr[2] = (uint8_t) (width >> 8); ihdr[3] = (uint8_t) width;
+    ihdr[4] = (uint8_t) (height >> 24); ihdr[5] = (uint8_t) (height >> 16); ihdr[6] = (uint8_t) (height >> 8); ihdr[7] = (uint8_t) height;
+    ihdr[8] = 8;
+    ihdr[9] = color_types[comp];
+    AppendChunk(png, "IHDR", ihdr, sizeof(ihdr));
+    if (key)
+    {
+        uint8_t trns[6] = {0, key[0], 0, key[1], 0, key[2]};
+        AppendChunk(png, "tRNS", trns, comp * 2);
+    }
+    const uint32_t idat_size = 8 * 1024;
+    for (uint32_t offset = 0; offset < compressed.Size(); offset += idat_size)
+    {
+        uint32_t size = compressed.Size() - offset < idat_size ? compressed.Size() - offset : idat_size;
+        AppendChunk(png, "IDAT", &compressed[offset], size);
+    }
+    AppendChunk(png, "IEND", 0, 0);
+}
+
+struct AllocStats
+{
+    size_t m_Current;
+    size_t m_Peak;
+};
+
+// The size of each allocation is kept in front of it
+static void* TrackedAlloc(void* context, size_t size)
+{
+    AllocStats* stats = (AllocStats*) context;
+    size_t* p = (size_t*) malloc(size + 16);
+    if (!p)
+        return 0;
+    *p = size;
+    stats->m_Current += size;
+    if (stats->m_Current > stats->m_Peak)
+        stats->m_Peak = stats->m_Current;
+    return (uint8_t*) p + 16;
+}
+
+static void TrackedFree(void* context, void* ptr)
+{
+    if (!ptr)
+        return;
+    AllocStats* stats = (AllocStats*) context;
+    size_t* p = (size_t*) ((uint8_t*) ptr - 16);
+    stats->m_Current -= *p;
+    free(p);
+}
+
+static void* TrackedRealloc(void* context, void* ptr, size_t size)
+{
+    void* p = TrackedAlloc(context, size);
+    if (p && ptr)
+    {
+        size_t old_size = *(size_t*) ((uint8_t*) ptr - 16);
+        memcpy(p, ptr, old_size < size ? old_size : size);
+        TrackedFree(context, ptr);
+    }
+    return p;
+}
+
+static uint8_t* CreatePixels(uint32_t width, uint32_t height, uint32_t comp)
+{
+    uint8_t* pixels = (uint8_t*) malloc(width * height * comp);
+    uint32_t seed = 1234;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width * comp; ++x)
+        {
+            // Gradients with some noise, so that the filters have something to predict
+            seed = seed * 1103515245 + 12345;
+            pixels[y * width * comp + x] = (uint8_t) (x + y * 3 + ((seed >> 16) & 7));
+        }
+    }
+    return pixels;
+}
+
+TEST(dmImage, PngRows)
+{
+    const uint32_t width = 67;
+    const uint32_t height = 41;
+    const dmImage::Type types[] = {dmImage::TYPE_LUMINANCE, dmImage::TYPE_LUMINANCE, dmImage::TYPE_LUMINANCE, dmImage::TYPE_RGB, dmImage::TYPE_RGBA};
+    for (uint32_t comp = 1; comp <= 4; ++comp)
+    {
+        uint8_t* pixels = CreatePixels(width, height, comp);
+        dmArray<uint8_t> png;
+        CreatePng(png, pixels, width, height, comp);
+
+        dmImage::Image image;
+        ASSERT_EQ(dmImage::RESULT_OK, dmImage::Load(png.Begin(), png.Size(), false, &image));
+        ASSERT_EQ(width, image.m_Width);
+        ASSERT_EQ(height, image.m_Height);
+        ASSERT_EQ(types[comp], image.m_Type);
+        const uint8_t* b = (const uint8_t*) image.m_Buffer;
+        uint32_t out_comp = dmImage::BytesPerPixel(image.m_Type);
+        for (uint32_t i = 0; i < width * height; ++i)
+        {
+            ASSERT_EQ(0, memcmp(pixels + i * comp, b + i * out_comp, out_comp));
+        }
+        dmImage::Free(&image);
+
+        // Flipped and premultiplied
+        uint32_t size = width * height * 4;
+        uint8_t* out = (uint8_t*) malloc(size);
+        ASSERT_EQ(dmImage::RESULT_OK, dmImage::LoadInto(png.Begin(), png.Size(), dmImage::TYPE_RGBA, dmImage::LOAD_FLAG_PREMULTIPLY | dmImage::LOAD_FLAG_FLIP_Y, out, size));
+        if (comp == 4)
+        {
+            uint8_t* expected = (uint8_t*) malloc(size);
+            memcpy(expected, pixels, size);
+            dmImage::Premultiply(expected, width, height);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                ASSERT_EQ(0, memcmp(expected + y * width * 4, out + (height - 1 - y) * width * 4, width * 4));
+            }
+            free(expected);
+        }
+
+        // Truncated image data
+        ASSERT_EQ(dmImage::RESULT_IMAGE_ERROR, dmImage::LoadInto(png.Begin(), png.Size() / 2, dmImage::TYPE_RGBA, 0, out, size));
+
+        free(out);
+        free(pixels);
+    }
+}
+
+TEST(dmImage, PngKeyColor)
+{
+    const uint32_t width = 67;
+    const uint32_t height = 41;
+    for (uint32_t comp = 1; comp <= 3; comp += 2)
+    {
+        uint8_t* pixels = CreatePixels(width, height, comp);
+        const uint8_t key[] = {17, 18, 19};
+        for (uint32_t i = 0; i < width * height; i += 7)
+        {
+            memcpy(pixels + i * comp, key, comp);
+        }
+        dmArray<uint8_t> png;
+        CreatePng(png, pixels, width, height, comp, key);
+
+        dmImage::Image image;
+        ASSERT_EQ(dmImage::RESULT_OK, dmImage::GetInfo(png.Begin(), png.Size(), &image));
+        ASSERT_EQ(comp == 1 ? dmImage::TYPE_LUMINANCE : dmImage::TYPE_RGBA, image.m_Type);
+
+        uint8_t* out = (uint8_t*) malloc(width * height * 4);
+        ASSERT_EQ(dmImage::RESULT_OK, dmImage::LoadInto(png.Begin(), png.Size(), dmImage::TYPE_RGBA, 0, out, width * height * 4));
+        for (uint32_t i = 0; i < width * height; ++i)
+        {
+            const uint8_t* p = pixels + i * comp;
+            uint8_t expected_alpha = memcmp(p, key, comp) == 0 ? 0 : 255;
+            ASSERT_EQ(expected_alpha, out[i * 4 + 3]);
+            ASSERT_EQ(p[0], out[i * 4 + 0]);
+            ASSERT_EQ(p[comp - 1], out[i * 4 + 2]);
+        }
+        free(out);
+        free(pixels);
+    }
+}
+
+TEST(dmImage, PngPeakMemory)
+{
+    const uint32_t width = 512;
+    const uint32_t height = 384;
+    const uint32_t size = width * height * 4;
+    uint8_t* pixels = CreatePixels(width, height, 4);
+    dmArray<uint8_t> png;
+    CreatePng(png, pixels, width, height, 4);
+    uint8_t* out = (uint8_t*) malloc(size);
+
+    AllocStats stats;
+    memset(&stats, 0, sizeof(stats));
+    dmImage::Allocator allocator = {TrackedAlloc, TrackedRealloc, TrackedFree, &stats};
+    dmImage::SetAllocator(&allocator);
+    dmImage::Result r = dmImage::LoadInto(png.Begin(), png.Size(), dmImage::TYPE_RGBA, 0, out, size);
+    dmImage::SetAllocator(0);
+
+    ASSERT_EQ(dmImage::RESULT_OK, r);
+    ASSERT_EQ(0, memcmp(pixels, out, size));
+    ASSERT_EQ(0u, stats.m_Current);
+    // Two rows and the inflate state and window
+    ASSERT_LT(stats.m_Peak, 2 * (width * 4 + 1) + 48 * 1024);
+    size_t load_into_peak = stats.m_Peak;
+
+    // Load allocates the image itself, but not a second copy of it
+    memset(&stats, 0, sizeof(stats));
+    dmImage::SetAllocator(&allocator);
+    dmImage::Image image;
+    r = dmImage::Load(png.Begin(), png.Size(), false, &image);
+    bool equal = r == dmImage::RESULT_OK && memcmp(pixels, image.m_Buffer, size) == 0;
+    if (r == dmImage::RESULT_OK)
+        dmImage::Free(&image);
+    dmImage::SetAllocator(0);
+
+    ASSERT_EQ(dmImage::RESULT_OK, r);
+    ASSERT_TRUE(equal);
+    ASSERT_EQ(0u, stats.m_Current);
+    ASSERT_EQ(size + load_into_peak, stats.m_Peak);
+
+    // The image data is split over several chunks, cut it off in the middle
+    ASSERT_EQ(dmImage::RESULT_IMAGE_ERROR, dmImage::LoadInto(png.Begin(), png.Size() / 2, dmImage::TYPE_RGBA, 0, out, size));
+
+    free(out);
+    free(pixels);
+}
+
+TEST(dmImage, Premultiply)
+{
+    // Odd sizes to exercise both the vector loop and the scalar tail
+    const uint32_t width = 37;
+    const uint32_t height = 5;
+    uint8_t pixels[width * height * 4];
+    uint8_t expected[width * height * 4];
+    uint32_t seed = 1234;
+    for (uint32_t i = 0; i < sizeof(pixels); ++i) {
+        seed = seed * 1103515245 + 12345;
+        pixels[i] = (uint8_t) (seed >> 16);
+    }
+    pixels[3] = 0;
+    pixels[7] = 255;
+    memcpy(expected, pixels, sizeof(pixels));
+    for (uint32_t i = 0; i < width * height; ++i) {
+        uint32_t a = expected[i * 4 + 3];
+        expected[i * 4 + 0] = (uint8_t) ((expected[i * 4 + 0] * a + 255) >> 8);
+        expected[i * 4 + 1] = (uint8_t) ((expected[i * 4 + 1] * a + 255) >> 8);
+        expected[i * 4 + 2] = (uint8_t) ((expected[i * 4 + 2] * a + 255) >> 8);
+    }
+
+    dmImage::Premultiply(pixels, width, height);
+    ASSERT_EQ(0, memcmp(expected, pixels, sizeof(pixels)));
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -0,0 +1,377 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+//
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <stdint.h>
+#include <string.h>
+#define JC_TEST_IMPLEMENTATION
+#include <jc_test/jc_test.h>
+#include "../dlib/atomic.h"
+#include "../dlib/job_system.h"
+#include "../dlib/math.h"
+#include "../dlib/thread.h"
+#include "../dlib/time.h"
+
+class dmJobSystemTest : public jc_test_params_class<uint32_t>
+{
+protected:
+    virtual void SetUp()
+    {
+        dmJobSystem::NewContextParams params;
+        params.m_WorkerCount = GetParam();
+        params.m_MaxJobs = 1024;
+        m_Context = dmJobSystem::New(params);
+    }
+
+    virtual void TearDown()
+    {
+        dmJobSystem::Delete(m_Context);
+    }
+
+    dmJobSystem::HContext m_Context;
+};
+
+static void IncrementJob(void* context, void* data)
+{
+    dmAtomicIncrement32((int32_atomic_t*) context);
+}
+
+TEST_P(dmJobSystemTest, SingleJob)
+{
+    int32_atomic_t counter = 0;
+    dmJobSystem::HJob job = dmJobSystem::CreateJob(m_Context, IncrementJob, (void*) &counter, 0, dmJobSystem::INVALID_JOB, 0, "Increment");
+    ASSERT_NE(dmJobSystem::INVALID_JOB, job);
+    ASSERT_FALSE(dmJobSystem::IsCompleted(m_Context, job));
+    dmJobSystem::Run(m_Context, job);
+    dmJobSystem::Wait(m_Context, job);
+    ASSERT_TRUE(dmJobSystem::IsCompleted(m_Context, job));
+    ASSERT_EQ(1, counter);
+}
+
+TEST_P(dmJobSystemTest, Children)
+{
+    const uint32_t count = 500;
+    int32_atomic_t counter = 0;
+    dmJobSystem::HJob parent = dmJobSystem::CreateJob(m_Context, 0, 0, 0, dmJobSystem::INVALID_JOB, 0, 0);
+    ASSERT_NE(dmJobSystem::INVALID_JOB, parent);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmJobSystem::HJob job = dmJobSystem::CreateJob(m_Context, IncrementJob, (void*) &counter, 0, parent, 0, 0);
+        ASSERT_NE(dmJobSystem::INVALID_JOB, job);
+        dmJobSystem::Run(m_Context, job);
+    }
+    dmJobSystem::Run(m_Context, parent);
+    dmJobSystem::Wait(m_Context, parent);
+    ASSERT_EQ((int32_t) count, counter);
+}
+
+struct ChainContext
+{
+    int32_atomic_t m_Next;
+    int32_t        m_Order[8];
+};
+
+static void ChainJob(void* context, void* data)
+{
+    ChainContext* c = (ChainContext*) context;
+    int32_t index = dmAtomicIncrement32(&c->m_Next);
+    c->m_Order[index] = (int32_t) (uintptr_t) data;
+}
+
+TEST_P(dmJobSystemTest, Dependencies)
+{
+    ChainContext c;
+    memset(&c, 0, sizeof(c));
+
+    // Create the jobs in reverse, each depending on the job created before it
+    dmJobSystem::HJob jobs[8];
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        jobs[i] = dmJobSystem::CreateJob(m_Context, ChainJob, &c, (void*) (uintptr_t) (7 - i), dmJobSystem::INVALID_JOB, 0, 0);
+        ASSERT_NE(dmJobSystem::INVALID_JOB, jobs[i]);
+        if (i > 0)
+        {
+            ASSERT_TRUE(dmJobSystem::AddDependency(m_Context, jobs[i], jobs[i-1]));
+        }
+    }
+    // Run the last job first, it must still wait for its dependencies
+    for (int32_t i = 7; i >= 0; --i)
+    {
+        dmJobSystem::Run(m_Context, jobs[i]);
+    }
+    dmJobSystem::Wait(m_Context, jobs[7]);
+
+    ASSERT_EQ(8, c.m_Next);
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        ASSERT_EQ(7 - (int32_t) i, c.m_Order[i]);
+    }
+}
+
+TEST_P(dmJobSystemTest, CompletedDependency)
+{
+    int32_atomic_t counter = 0;
+    dmJobSystem::HJob first = dmJobSystem::CreateJob(m_Context, IncrementJob, (void*) &counter, 0, dmJobSystem::INVALID_JOB, 0, 0);
+    dmJobSystem::Run(m_Context, first);
+    dmJobSystem::Wait(m_Context, first);
+
+    dmJobSystem::HJob second = dmJobSystem::CreateJob(m_Context, IncrementJob, (void*) &counter, 0, dmJobSystem::INVALID_JOB, 0, 0);
+    ASSERT_TRUE(dmJobSystem::AddDependency(m_Context, second, first));
+    dmJobSystem::Run(m_Context, second);
+    dmJobSystem::Wait(m_Context, second);
+    ASSERT_EQ(2, counter);
+}
+
+struct MainThreadContext
+{
+    dmThread::TlsKey m_MainThreadKey;
+    int32_atomic_t   m_WrongThread;
+    int32_atomic_t   m_Count;
+};
+
+static void MainThreadJob(void* context, void* data)
+{
+    MainThreadContext* c = (MainThreadContext*) context;
+    if (dmThread::GetTlsValue(c->m_MainThreadKey) == 0)
+    {
+        dmAtomicIncrement32(&c->m_WrongThread);
+    }
+    dmAtomicIncrement32(&c->m_Count);
+}
+
+TEST_P(dmJobSystemTest, MainThreadAffinity)
+{
+    MainThreadContext c;
+    c.m_MainThreadKey = dmThread::AllocTls();
+    dmThread::SetTlsValue(c.m_MainThreadKey, &c);
+    c.m_WrongThread = 0;
+    c.m_Count = 0;
+
+    const uint32_t count = 64;
+    dmJobSystem::HJob jobs[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        jobs[i] = dmJobSystem::CreateJob(m_Context, MainThreadJob, &c, 0, dmJobSystem::INVALID_JOB, dmJobSystem::JOB_FLAG_MAIN_THREAD, 0);
+        dmJobSystem::Run(m_Context, jobs[i]);
+    }
+
+    // Give the workers a chance to (wrongly) pick them up
+    dmTime::Sleep(10000);
+    ASSERT_EQ(0, c.m_Count);
+
+    ASSERT_EQ(count, dmJobSystem::RunMainThreadJobs(m_Context));
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_TRUE(dmJobSystem::IsCompleted(m_Context, jobs[i]));
+    }
+    ASSERT_EQ((int32_t) count, c.m_Count);
+    ASSERT_EQ(0, c.m_WrongThread);
+    dmThread::FreeTls(c.m_MainThreadKey);
+}
+
+TEST_P(dmJobSystemTest, OutOfJobs)
+{
+    int32_atomic_t counter = 0;
+    dmJobSystem::HJob parent = dmJobSystem::CreateJob(m_Context, 0, 0, 0, dmJobSystem::INVALID_JOB, 0, 0);
+    uint32_t created = 1;
+    while (dmJobSystem::CreateJob(m_Context, IncrementJob, (void*) &counter, 0, parent, 0, 0) != dmJobSystem::INVALID_JOB)
+    {
+        ++created;
+    }
+    ASSERT_EQ(1024u, created);
+}
+
+struct SumContext
+{
+    uint32_t*      m_Values;
+    int32_atomic_t m_Calls;
+};
+
+static void SquareRange(void* context, uint32_t begin, uint32_t end)
+{
+    SumContext* c = (SumContext*) context;
+    dmAtomicIncrement32(&c->m_Calls);
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        c->m_Values[i] = i * 2;
+    }
+}
+
+TEST_P(dmJobSystemTest, ParallelFor)
+{
+    const uint32_t count = 10007;
+    SumContext c;
+    memset(&c, 0, sizeof(c));
+    c.m_Values = new uint32_t[count];
+    memset(c.m_Values, 0, sizeof(uint32_t) * count);
+
+    dmJobSystem::ParallelFor(m_Context, SquareRange, &c, count, 64);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(i * 2, c.m_Values[i]);
+    }
+    ASSERT_LE(1, c.m_Calls);
+    ASSERT_GE(count / 64, (uint32_t) c.m_Calls);
+
+    // Smaller than a batch, called on the calling thread
+    c.m_Calls = 0;
+    dmJobSystem::ParallelFor(m_Context, SquareRange, &c, 10, 64);
+    ASSERT_EQ(1, c.m_Calls);
+
+    c.m_Calls = 0;
+    dmJobSystem::ParallelFor(m_Context, SquareRange, &c, 0, 64);
+    ASSERT_EQ(0, c.m_Calls);
+
+    delete [] c.m_Values;
+}
+
+struct NestedContext
+{
+    dmJobSystem::HContext m_Context;
+    int32_atomic_t        m_Counter;
+};
+
+static void NestedJob(void* context, void* data)
+{
+    NestedContext* c = (NestedContext*) context;
+    // Waiting inside a job runs other jobs instead of blocking the worker
+    dmJobSystem::HJob job = dmJobSystem::CreateJob(c->m_Context, IncrementJob, (void*) &c->m_Counter, 0, dmJobSystem::INVALID_JOB, 0, 0);
+    dmJobSystem::Run(c->m_Context, job);
+    dmJobSystem::Wait(c->m_Context, job);
+}
+
+TEST_P(dmJobSystemTest, NestedWait)
+{
+    NestedContext c;
+    c.m_Context = m_Context;
+    c.m_Counter = 0;
+
+    const uint32_t count = 100;
+    dmJobSystem::HJob parent = dmJobSystem::CreateJob(m_Context, 0, 0, 0, dmJobSystem::INVALID_JOB, 0, 0);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmJobSystem::HJob job = dmJobSystem::CreateJob(m_Context, NestedJob, &c, 0, parent, 0, 0);
+        dmJobSystem::Run(m_Context, job);
+    }
+    dmJobSystem::Run(m_Context, parent);
+    dmJobSystem::Wait(m_Context, parent);
+    ASSERT_EQ((int32_t) count, c.m_Counter);
+}
+
+static void HeavyRange(void* context, uint32_t begin, uint32_t end)
+{
+    float* values = (float*) context;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        float v = (float) i;
+        for (uint32_t j = 0; j < 64; ++j)
+        {
+            v = v * 0.999f + 1.0f;
+        }
+        values[i] = v;
+    }
+}
+
+static void SlowIncrementJob(void* context, void* data)
+{
+    dmTime::Sleep(20000);
+    dmAtomicIncrement32((int32_atomic_t*) context);
+}
+
+// With workers the waiting thread runs out of jobs and blocks until the slow ones complete
+TEST_P(dmJobSystemTest, WaitForRunningJobs)
+{
+    int32_atomic_t counter = 0;
+    const uint32_t job_count = 4;
+    dmJobSystem::HJob parent = dmJobSystem::CreateJob(m_Context, 0, 0, 0, dmJobSystem::INVALID_JOB, 0, 0);
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        dmJobSystem::HJob job = dmJobSystem::CreateJob(m_Context, SlowIncrementJob, (void*) &counter, 0, parent, 0, 0);
+        ASSERT_NE(dmJobSystem::INVALID_JOB, job);
+        dmJobSystem::Run(m_Context, job);
+    }
+    dmJobSystem::Run(m_Context, parent);
+    dmJobSystem::Wait(m_Context, parent);
+    ASSERT_TRUE(dmJobSystem::IsCompleted(m_Context, parent));
+    ASSERT_EQ((int32_t) job_count, counter);
+}
+
+// Prints the jobs per second and the parallel for time against running the same work serially
+TEST_P(dmJobSystemTest, Bench)
+{
+    const uint32_t count = 1024 * 64;
+    const uint32_t iter_count = 20;
+    float* values = new float[count];
+
+    // Called through a pointer in the same ranges as ParallelFor, so both run the same code
+    void (* volatile serial_range)(void*, uint32_t, uint32_t) = HeavyRange;
+    uint64_t start = dmTime::GetTime();
+    for (uint32_t iter = 0; iter < iter_count; ++iter)
+    {
+        for (uint32_t i = 0; i < count; i += 256)
+        {
+            serial_range(values, i, dmMath::Min(i + 256, count));
+        }
+    }
+    uint64_t serial_for_time = dmTime::GetTime() - start;
+
+    start = dmTime::GetTime();
+    for (uint32_t iter = 0; iter < iter_count; ++iter)
+    {
+        dmJobSystem::ParallelFor(m_Context, HeavyRange, values, count, 256);
+    }
+    uint64_t parallel_for_time = dmTime::GetTime() - start;
+
+    int32_atomic_t counter = 0;
+    const uint32_t job_count = 1000;
+    start = dmTime::GetTime();
+    for (uint32_t i = 0; i < iter_count * job_count; ++i)
+    {
+        IncrementJob((void*) &counter, 0);
+    }
+    uint64_t serial_job_time = dmTime::GetTime() - start;
+
+    counter = 0;
+    uint32_t jobs_run = 0;
+    start = dmTime::GetTime();
+    for (uint32_t iter = 0; iter < iter_count; ++iter)
+    {
+        dmJobSystem::HJob parent = dmJobSystem::CreateJob(m_Context, 0, 0, 0, dmJobSystem::INVALID_JOB, 0, 0);
+        for (uint32_t i = 0; i < job_count; ++i)
+        {
+            dmJobSystem::HJob job = dmJobSystem::CreateJob(m_Context, IncrementJob, (void*) &counter, 0, parent, 0, 0);
+            if (job != dmJobSystem::INVALID_JOB)
+            {
+                dmJobSystem::Run(m_Context, job);
+                ++jobs_run;
+            }
+        }
+        dmJobSystem::Run(m_Context, parent);
+        dmJobSystem::Wait(m_Context, parent);
+    }
+    uint64_t job_time = dmTime::GetTime() - start;
+    ASSERT_EQ((int32_t) jobs_run, counter);
+
+    printf("%u workers: ParallelFor %.2f ms (serial %.2f ms), %.0f jobs/s (serial %.0f calls/s)\n", GetParam(),
+           parallel_for_time / (1000.0f * iter_count), serial_for_time / (1000.0f * iter_count),
+           jobs_run / (job_time / 1000000.0), (iter_count * job_count) / (dmMath::Max(serial_job_time, (uint64_t) 1) / 1000000.0));
+
+    delete [] values;
+}
+
+const uint32_t worker_counts[] = {0, 1, 4};
+INSTANTIATE_TEST_CASE_P(dmJobSystemTest, dmJobSystemTest, jc_test_values_in(worker_counts));
+
+int main(int argc, char **argv)
+{
+    jc_test_init(&argc, argv);
+    return jc_test_run_all();
+}
@@ -228,6 +228,9 @@ namespace dmEngine
     {
         m_EngineService = engine_service;
         m_Register = dmGameObject::NewRegister();
+        dmJobSystem::NewContextParams job_system_params;
+        m_JobSystem = dmJobSystem::New(job_system_params);
+        dmGameObject::SetJobSystem(m_Register, m_JobSystem);
         m_InputBuffer.SetCapacity(64);
 
         m_PhysicsContext.m_Context3D = 0x0;
@@ -279,6 +282,7 @@ namespace dmEngine
         dmHttpClient::ReopenConnectionPool();
 
         dmGameObject::DeleteRegister(engine->m_Register);
+        dmJobSystem::Delete(engine->m_JobSystem);
 
         UnloadBootstrapContent(engine);
 
@@ -417,11 +421,20 @@ namespace dmEngine
 
     static void SetSwapInterval(HEngine engine, int swap_interval)
     {
+        if (IsBenchmarking(&engine->m_Benchmark))
+        {
+            // Never wait for the display while benchmarking
+            engine->m_UseSwVsync = false;
+            dmGraphics::SetSwapInterval(engine->m_GraphicsContext, 0);
+            return;
+        }
+
         if (!engine->m_UseVariableDt)
         {
             swap_interval = dmMath::Max(0, swap_interval);
             // For backward-compatability, hardware vsync with swap_interval 0 on desktop should result in sw vsync
             engine->m_UseSwVsync = (engine->m_VsyncMode == VSYNC_SOFTWARE || (engine->m_VsyncMode == VSYNC_HARDWARE && swap_interval == 0));
+            ResetFramePacing(&engine->m_FramePacing, dmTime::GetTime());
             if (engine->m_VsyncMode == VSYNC_HARDWARE && swap_interval > 0) // need to update engine update freq to get correct dt when swap interval changes
                 engine->m_UpdateFrequency /= swap_interval;
             dmGraphics::SetSwapInterval(engine->m_GraphicsContext, swap_interval);
@@ -549,6 +562,11 @@ namespace dmEngine
             }
         }
 
+        if (ParseBenchmarkArgs(&engine->m_Benchmark, argc, argv))
+        {
+            dmLogInfo("Benchmark mode: %u frames with dt %f", engine->m_Benchmark.m_FrameCount, engine->m_Benchmark.m_Dt);
+        }
+
         dmBuffer::NewContext();
 
         dmExtension::AppParams app_params;
@@ -624,8 +642,7 @@ namespace dmEngine
         engine->m_InvPhysicalHeight = 1.0f / physical_height;
 
         engine->m_PreviousFrameTime = dmTime::GetTime();
-        engine->m_FlipTime = dmTime::GetTime();
-        engine->m_PreviousRenderTime = 0;
+        ResetFramePacing(&engine->m_FramePacing, engine->m_PreviousFrameTime);
         engine->m_UseSwVsync = false;
 
 #if defined(__MACH__) || defined(__linux__) || defined(_WIN32)
@@ -804,6 +821,7 @@ namespace dmEngine
         render_params.m_ScriptContext = engine->m_RenderScriptContext;
         render_params.m_MaxDebugVertexCount = (uint32_t) dmConfigFile::GetInt(engine->m_Config, "graphics.max_debug_vertices", 10000);
         engine->m_RenderContext = dmRender::NewRenderContext(engine->m_GraphicsContext, render_params);
+        dmRender::SetJobSystem(engine->m_RenderContext, engine->m_JobSystem);
 
         dmGameObject::Initialize(engine->m_Register, engine->m_GOScriptContext);
 
@@ -863,6 +881,7 @@ namespace dmEngine
         physics_params.m_RayCastLimit2D = dmConfigFile::GetInt(engine->m_Config, "physics.ray_cast_limit_2d", 64);
         physics_params.m_RayCastLimit3D = dmConfigFile::GetInt(engine->m_Config, "physics.ray_cast_limit_3d", 128);
         physics_params.m_TriggerOverlapCapacity = dmConfigFile::GetInt(engine->m_Config, "physics.trigger_overlap_capacity", 16);
+        physics_params.m_JobSystem = engine->m_JobSystem;
         if (physics_params.m_Scale < dmPhysics::MIN_SCALE || physics_params.m_Scale > dmPhysics::MAX_SCALE)
         {
             dmLogWarning("Physics scale must be in the range %.2f - %.2f and has been clamped.", dmPhysics::MIN_SCALE, dmPhysics::MAX_SCALE);
@@ -1067,7 +1086,12 @@ namespace dmEngine
 
         dmLiveUpdate::Initialize(engine->m_Factory);
 
-        fact_result = dmResource::Get(engine->m_Factory, dmConfigFile::GetString(engine->m_Config, "bootstrap.main_collection", "/logic/main.collectionc"), (void**) &engine->m_MainCollection);
+        {
+            const char* main_collection = dmConfigFile::GetString(engine->m_Config, "bootstrap.main_collection", "/logic/main.collectionc");
+            if (engine->m_Benchmark.m_Collection[0])
+                main_collection = engine->m_Benchmark.m_Collection;
+            fact_result = dmResource::Get(engine->m_Factory, main_collection, (void**) &engine->m_MainCollection);
+        }
         if (fact_result != dmResource::RESULT_OK)
             goto bail;
         dmGameObject::Init(engine->m_MainCollection);
@@ -1224,27 +1248,29 @@ bail:
         return memcount;
     }
 
+    static void Exit(HEngine engine, int32_t code);
+
     void Step(HEngine engine)
     {
         engine->m_Alive = true;
         engine->m_RunResult.m_ExitCode = 0;
 
         uint64_t target_frametime = 1000000 / engine->m_UpdateFrequency;
-        uint64_t prev_flip_time = engine->m_FlipTime;
         uint64_t time = dmTime::GetTime();
 
         float fps = engine->m_UpdateFrequency;
         float fixed_dt = 1.0f / fps;
         float dt = fixed_dt;
         bool variable_dt = engine->m_UseVariableDt;
-        if (variable_dt && time > engine->m_PreviousFrameTime) {
-            dt = (float)((time - engine->m_PreviousFrameTime) * 0.000001);
+        bool benchmark = IsBenchmarking(&engine->m_Benchmark);
+        if (benchmark) {
+            dt = engine->m_Benchmark.m_Dt;
+        }
+        else if (variable_dt && time > engine->m_PreviousFrameTime) {
+            float frame_dt = (float)((time - engine->m_PreviousFrameTime) * 0.000001);
             // safety mechanism for crazy; GetTime() is not guaranteed to always
             // produce small deltas between calls, cap to 25 frames in one.
-            const float max = fixed_dt * 25.0f;
-            if (dt > max) {
-                dt = max;
-            }
+            dt = EstimateDt(&engine->m_FramePacing, frame_dt, fixed_dt, fixed_dt * 25.0f);
         }
         engine->m_PreviousFrameTime = time;
 
@@ -1273,6 +1299,7 @@ bail:
                     } else {
                         engine->m_PreviousFrameTime = time - i_dt;
                     }
+                    ResetFramePacing(&engine->m_FramePacing, time);
                     return;
                 }
             }
@@ -1285,6 +1312,10 @@ bail:
             }
 
             dmProfile::HProfile profile = dmProfile::Begin();
+            if (benchmark)
+            {
+                RecordBenchmarkProfile(&engine->m_Benchmark, profile);
+            }
             {
                 DM_PROFILE(Engine, "Frame");
 
@@ -1445,29 +1476,14 @@ bail:
                     dmExtension::PostRender(&ext_params);
                 }
 
-                if (engine->m_UseSwVsync)
+                if (engine->m_UseSwVsync && !engine->m_UseVariableDt && !benchmark)
                 {
-                    uint64_t flip_dt = dmTime::GetTime() - prev_flip_time;
-                    int remainder = (int)((target_frametime - flip_dt) - engine->m_PreviousRenderTime);
-                    if (!engine->m_UseVariableDt && flip_dt < target_frametime && remainder > 1000) // only bother with sleep if diff b/w target and actual time is big enough
-                    {
-                        DM_PROFILE(Engine, "SoftwareVsync");
-                        while (remainder > 500) // dont bother with less than 0.5ms
-                        {
-                            uint64_t t1 = dmTime::GetTime();
-                            dmTime::Sleep(100); // sleep in chunks of 0.1ms
-                            uint64_t t2 = dmTime::GetTime();
-                            remainder -= (t2-t1);
-                        }
-                    }
+                    DM_PROFILE(Engine, "SoftwareVsync");
+                    WaitForDeadline(&engine->m_FramePacing, target_frametime);
                 }
-                uint64_t flip_time_start = dmTime::GetTime();
 
                 dmGraphics::Flip(engine->m_GraphicsContext);
 
-                engine->m_FlipTime = dmTime::GetTime();
-                engine->m_PreviousRenderTime = engine->m_FlipTime - flip_time_start;
-
                 RecordData* record_data = &engine->m_RecordData;
                 if (record_data->m_Recorder)
                 {
@@ -1492,6 +1508,20 @@ bail:
 
 
             ++engine->m_Stats.m_FrameCount;
+
+            if (benchmark)
+            {
+                RecordBenchmarkFrame(&engine->m_Benchmark, dmTime::GetTime() - time);
+                if (IsBenchmarkDone(&engine->m_Benchmark))
+                {
+                    // The scopes of the last frame are available once the next profile begins
+                    profile = dmProfile::Begin();
+                    RecordBenchmarkProfile(&engine->m_Benchmark, profile);
+                    dmProfile::Release(profile);
+
+                    Exit(engine, WriteBenchmark(&engine->m_Benchmark) ? 0 : 1);
+                }
+            }
         }
     }
 
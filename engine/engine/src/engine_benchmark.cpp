@@ -0,0 +1,195 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "engine_benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include <dlib/dstrings.h>
+#include <dlib/log.h>
+#include <dlib/math.h>
+#include <dlib/time.h>
+
+namespace dmEngine
+{
+    BenchmarkData::BenchmarkData()
+    : m_StartTime(0)
+    , m_FrameCount(0)
+    , m_Dt(1.0f / 60.0f)
+    {
+        dmStrlCpy(m_OutputPath, "benchmark.json", sizeof(m_OutputPath));
+        m_Collection[0] = 0;
+    }
+
+    bool ParseBenchmarkArgs(BenchmarkData* benchmark, int argc, char* argv[])
+    {
+        const char frames_arg[] = "--benchmark-frames=";
+        const char dt_arg[] = "--benchmark-dt=";
+        const char output_arg[] = "--benchmark-output=";
+        const char collection_arg[] = "--benchmark-collection=";
+        for (int i = 0; i < argc; ++i)
+        {
+            const char* arg = argv[i];
+            if (strncmp(frames_arg, arg, sizeof(frames_arg)-1) == 0)
+            {
+                int frames = atoi(arg + sizeof(frames_arg)-1);
+                if (frames > 0) {
+                    benchmark->m_FrameCount = (uint32_t)frames;
+                } else {
+                    dmLogWarning("Invalid value used for %s", arg);
+                }
+            }
+            else if (strncmp(dt_arg, arg, sizeof(dt_arg)-1) == 0)
+            {
+                float dt = (float)atof(arg + sizeof(dt_arg)-1);
+                if (dt > 0.0f) {
+                    benchmark->m_Dt = dt;
+                } else {
+                    dmLogWarning("Invalid value used for %s", arg);
+                }
+            }
+            else if (strncmp(output_arg, arg, sizeof(output_arg)-1) == 0)
+            {
+                dmStrlCpy(benchmark->m_OutputPath, arg + sizeof(output_arg)-1, sizeof(benchmark->m_OutputPath));
+            }
+            else if (strncmp(collection_arg, arg, sizeof(collection_arg)-1) == 0)
+            {
+                dmStrlCpy(benchmark->m_Collection, arg + sizeof(collection_arg)-1, sizeof(benchmark->m_Collection));
+            }
+        }
+
+        if (!IsBenchmarking(benchmark))
+            return false;
+
+        benchmark->m_FrameTimes.SetCapacity(benchmark->m_FrameCount);
+        benchmark->m_Scopes.SetCapacity(64);
+        return true;
+    }
+
+    void RecordBenchmarkFrame(BenchmarkData* benchmark, uint64_t frame_time)
+    {
+        if (benchmark->m_FrameTimes.Full())
+            return;
+        if (benchmark->m_FrameTimes.Empty())
+            benchmark->m_StartTime = dmTime::GetTime() - frame_time;
+        benchmark->m_FrameTimes.Push((uint32_t)dmMath::Min(frame_time, (uint64_t)0xffffffff));
+    }
+
+    static void AccumulateScope(void* context, const dmProfile::ScopeData* scope_data)
+    {
+        BenchmarkData* benchmark = (BenchmarkData*)context;
+        dmArray<BenchmarkScope>& scopes = benchmark->m_Scopes;
+        uint32_t index = scope_data->m_Scope->m_Index;
+        if (index >= scopes.Size())
+        {
+            uint32_t old_size = scopes.Size();
+            if (index >= scopes.Capacity())
+                scopes.SetCapacity(index + 16);
+            scopes.SetSize(index + 1);
+            memset(&scopes[old_size], 0, sizeof(BenchmarkScope) * (scopes.Size() - old_size));
+        }
+
+        BenchmarkScope& scope = scopes[index];
+        scope.m_Name = scope_data->m_Scope->m_Name;
+        scope.m_Elapsed += scope_data->m_Elapsed;
+        scope.m_MaxElapsed = dmMath::Max(scope.m_MaxElapsed, scope_data->m_Elapsed);
+        scope.m_Count += scope_data->m_Count;
+    }
+
+    void RecordBenchmarkProfile(BenchmarkData* benchmark, dmProfile::HProfile profile)
+    {
+        // The profile returned by dmProfile::Begin() holds the previous frame, and before
+        // the first benchmark frame that is the engine initialization
+        if (profile == 0 || benchmark->m_FrameTimes.Empty())
+            return;
+        dmProfile::IterateScopeData(profile, benchmark, false, AccumulateScope);
+    }
+
+    static double Percentile(const dmArray<uint32_t>& sorted, float percentile)
+    {
+        uint32_t index = (uint32_t)(percentile * (sorted.Size() - 1) + 0.5f);
+        return sorted[index] / 1000.0;
+    }
+
+    bool WriteBenchmark(const BenchmarkData* benchmark)
+    {
+        uint32_t frame_count = benchmark->m_FrameTimes.Size();
+        if (frame_count == 0)
+        {
+            dmLogError("No benchmark frames were recorded");
+            return false;
+        }
+
+        FILE* file = fopen(benchmark->m_OutputPath, "wb");
+        if (!file)
+        {
+            dmLogError("Failed to open benchmark output '%s'", benchmark->m_OutputPath);
+            return false;
+        }
+
+        dmArray<uint32_t> sorted;
+        sorted.SetCapacity(frame_count);
+        sorted.SetSize(frame_count);
+        memcpy(sorted.Begin(), &benchmark->m_FrameTimes[0], sizeof(uint32_t) * frame_count);
+        std::sort(sorted.Begin(), sorted.End());
+
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < frame_count; ++i)
+            total += sorted[i];
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"frames\": %u,\n", frame_count);
+        fprintf(file, "  \"dt\": %f,\n", benchmark->m_Dt);
+        fprintf(file, "  \"wall_time\": %.3f,\n", (dmTime::GetTime() - benchmark->m_StartTime) / 1000.0);
+        fprintf(file, "  \"frame_time\": {\"total\": %.3f, \"mean\": %.3f, \"min\": %.3f, \"max\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f},\n",
+                total / 1000.0, total / 1000.0 / frame_count, sorted[0] / 1000.0, sorted[frame_count-1] / 1000.0,
+                Percentile(sorted, 0.5f), Percentile(sorted, 0.95f), Percentile(sorted, 0.99f));
+
+        fprintf(file, "  \"frame_times\": [");
+        for (uint32_t i = 0; i < frame_count; ++i)
+            fprintf(file, "%s%.3f", i == 0 ? "" : ", ", benchmark->m_FrameTimes[i] / 1000.0);
+        fprintf(file, "],\n");
+
+        // Scope timings are empty when the profiler is compiled out (release builds)
+        double ticks_per_ms = dmProfile::GetTicksPerSecond() / 1000.0;
+        fprintf(file, "  \"scopes\": [");
+        bool first = true;
+        for (uint32_t i = 0; i < benchmark->m_Scopes.Size(); ++i)
+        {
+            const BenchmarkScope& scope = benchmark->m_Scopes[i];
+            if (scope.m_Name == 0)
+                continue;
+            fprintf(file, "%s\n    {\"name\": \"%s\", \"total\": %.3f, \"mean\": %.3f, \"max\": %.3f, \"count\": %u}",
+                    first ? "" : ",", scope.m_Name,
+                    scope.m_Elapsed / ticks_per_ms, scope.m_Elapsed / ticks_per_ms / frame_count,
+                    scope.m_MaxElapsed / ticks_per_ms, scope.m_Count);
+            first = false;
+        }
+        fprintf(file, "%s]\n", first ? "" : "\n  ");
+        fprintf(file, "}\n");
+
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        if (!ok)
+        {
+            dmLogError("Failed to write benchmark output '%s'", benchmark->m_OutputPath);
+            return false;
+        }
+
+        dmLogInfo("Benchmark: %u frames, mean %.3f ms, p95 %.3f ms, written to '%s'",
+                  frame_count, total / 1000.0 / frame_count, Percentile(sorted, 0.95f), benchmark->m_OutputPath);
+        return true;
+    }
+}
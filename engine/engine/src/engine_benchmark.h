@@ -0,0 +1,75 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_ENGINE_BENCHMARK_H
+#define DM_ENGINE_BENCHMARK_H
+
+#include <stdint.h>
+
+#include <dlib/array.h>
+#include <dlib/path.h>
+#include <dlib/profile.h>
+
+namespace dmEngine
+{
+    struct BenchmarkScope
+    {
+        const char* m_Name;
+        uint64_t    m_Elapsed;      // Total ticks over all recorded frames
+        uint32_t    m_MaxElapsed;   // Max ticks in a single frame
+        uint32_t    m_Count;
+    };
+
+    /*
+     * Benchmark mode runs the engine for a fixed number of frames with a fixed dt,
+     * without any vsync, and writes the timings as json when done.
+     * Enabled with the command line arguments:
+     *   --benchmark-frames=N         Number of frames to run (required to enable benchmark mode)
+     *   --benchmark-dt=SECONDS       Fixed dt passed to the update (default 1/60)
+     *   --benchmark-output=PATH      Output json file (default "benchmark.json")
+     *   --benchmark-collection=PATH  Collection to load instead of bootstrap.main_collection
+     */
+    struct BenchmarkData
+    {
+        BenchmarkData();
+
+        dmArray<uint32_t>       m_FrameTimes;   // Microseconds
+        dmArray<BenchmarkScope> m_Scopes;       // Indexed by dmProfile::Scope::m_Index
+        uint64_t                m_StartTime;
+        uint32_t                m_FrameCount;
+        float                   m_Dt;
+        char                    m_OutputPath[DMPATH_MAX_PATH];
+        char                    m_Collection[DMPATH_MAX_PATH];
+    };
+
+    /// Returns true if benchmark mode was requested on the command line
+    bool ParseBenchmarkArgs(BenchmarkData* benchmark, int argc, char* argv[]);
+
+    static inline bool IsBenchmarking(const BenchmarkData* benchmark)
+    {
+        return benchmark->m_FrameCount > 0;
+    }
+
+    static inline bool IsBenchmarkDone(const BenchmarkData* benchmark)
+    {
+        return benchmark->m_FrameTimes.Size() >= benchmark->m_FrameCount;
+    }
+
+    /// Records the frame time and accumulates the scope timings of the profile
+    void RecordBenchmarkFrame(BenchmarkData* benchmark, uint64_t frame_time);
+    void RecordBenchmarkProfile(BenchmarkData* benchmark, dmProfile::HProfile profile);
+
+    /// Writes the collected timings to the output path. Returns false on failure.
+    bool WriteBenchmark(const BenchmarkData* benchmark);
+}
+
+#endif // DM_ENGINE_BENCHMARK_H
@@ -0,0 +1,114 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "engine_pacing.h"
+
+#include <string.h>
+#include <math.h>
+
+#include <dlib/math.h>
+#include <dlib/profile.h>
+#include <dlib/time.h>
+
+namespace dmEngine
+{
+    // Start out spinning generously, the margin shrinks once we have measured the oversleep
+    static const uint32_t INITIAL_SLEEP_OVERSHOOT = 1000;
+    static const uint32_t MIN_SPIN_TIME = 200;
+    // Part of the accumulated dt debt paid back each frame
+    static const float DT_DEBT_PAYBACK = 0.1f;
+    // Snap the dt to the fixed dt when within this fraction of it
+    static const float DT_SNAP_TOLERANCE = 0.05f;
+
+    FramePacing::FramePacing()
+    {
+        memset(this, 0, sizeof(*this));
+        m_SleepOvershoot = INITIAL_SLEEP_OVERSHOOT;
+        m_MinSpinTime = MIN_SPIN_TIME;
+    }
+
+    void ResetFramePacing(FramePacing* pacing, uint64_t time)
+    {
+        pacing->m_Deadline = time;
+        pacing->m_DtDebt = 0.0f;
+        pacing->m_DtHistoryIndex = 0;
+        pacing->m_DtHistoryCount = 0;
+    }
+
+    bool WaitForDeadline(FramePacing* pacing, uint64_t target_frametime)
+    {
+        uint64_t deadline = pacing->m_Deadline + target_frametime;
+        uint64_t time = dmTime::GetTime();
+        if (time >= deadline)
+        {
+            // Keep the schedule when less than a frame late, the next frame then has less time to catch up.
+            // Otherwise schedule from now, rather than rushing several frames.
+            pacing->m_Deadline = (time - deadline) < target_frametime ? deadline : time;
+            ++pacing->m_MissedDeadlines;
+            DM_COUNTER("Engine.MissedDeadlines", 1);
+            return false;
+        }
+
+        // Sleep until we're within the spin margin of the deadline. The margin covers the
+        // worst oversleep seen lately, which decays so a single hiccup doesn't make us spin for long.
+        uint32_t margin = pacing->m_MinSpinTime + pacing->m_SleepOvershoot;
+        while (deadline - time > margin)
+        {
+            uint32_t request = (uint32_t)(deadline - time - margin);
+            dmTime::Sleep(request);
+            uint64_t now = dmTime::GetTime();
+            uint64_t slept = now - time;
+            uint32_t overshoot = slept > request ? (uint32_t)(slept - request) : 0;
+            pacing->m_SleepOvershoot = dmMath::Max(overshoot, pacing->m_SleepOvershoot - (pacing->m_SleepOvershoot >> 4));
+            margin = pacing->m_MinSpinTime + pacing->m_SleepOvershoot;
+            time = now;
+            if (time >= deadline)
+                break;
+        }
+
+        while (time < deadline)
+        {
+            time = dmTime::GetTime();
+        }
+
+        pacing->m_Deadline = deadline;
+        return true;
+    }
+
+    float EstimateDt(FramePacing* pacing, float frame_dt, float fixed_dt, float max_dt)
+    {
+        frame_dt = dmMath::Clamp(frame_dt, 0.0f, max_dt);
+
+        pacing->m_DtHistory[pacing->m_DtHistoryIndex] = frame_dt;
+        pacing->m_DtHistoryIndex = (pacing->m_DtHistoryIndex + 1) % PACING_DT_HISTORY;
+        pacing->m_DtHistoryCount = dmMath::Min(pacing->m_DtHistoryCount + 1, PACING_DT_HISTORY);
+
+        float average = 0.0f;
+        for (uint32_t i = 0; i < pacing->m_DtHistoryCount; ++i)
+        {
+            average += pacing->m_DtHistory[i];
+        }
+        average /= pacing->m_DtHistoryCount;
+
+        // The debt is the real time passed that hasn't been handed out as dt yet
+        pacing->m_DtDebt += frame_dt;
+        float dt = average + (pacing->m_DtDebt - average) * DT_DEBT_PAYBACK;
+        if (fabsf(dt - fixed_dt) < fixed_dt * DT_SNAP_TOLERANCE)
+        {
+            dt = fixed_dt;
+        }
+        dt = dmMath::Clamp(dt, 0.0f, max_dt);
+
+        pacing->m_DtDebt = dmMath::Clamp(pacing->m_DtDebt - dt, -max_dt, max_dt);
+        return dt;
+    }
+}
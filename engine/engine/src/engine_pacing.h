@@ -0,0 +1,54 @@
+// Copyright 2020 The Defold Foundation
+// Licensed under the Defold License version 1.0 (the "License"); you may not use
+// this file except in compliance with the License.
+// 
+// You may obtain a copy of the License, together with FAQs at
+// https://www.defold.com/license
+// 
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef DM_ENGINE_PACING_H
+#define DM_ENGINE_PACING_H
+
+#include <stdint.h>
+
+namespace dmEngine
+{
+    const uint32_t PACING_DT_HISTORY = 8;
+
+    /*
+     * Frame pacing when the display doesn't pace the frames for us (software vsync).
+     * Each frame is presented at a fixed deadline, previous deadline + target frame time.
+     * The wait sleeps until shortly before the deadline and spins for the remainder,
+     * where the spin margin adapts to the observed oversleep of dmTime::Sleep.
+     */
+    struct FramePacing
+    {
+        FramePacing();
+
+        uint64_t    m_Deadline;                     // Time of the last frame deadline (us)
+        uint32_t    m_SleepOvershoot;               // Decaying max of the observed oversleep (us)
+        uint32_t    m_MinSpinTime;                  // Spin at least this long before the deadline (us)
+        uint32_t    m_MissedDeadlines;              // Total number of missed deadlines
+        float       m_DtHistory[PACING_DT_HISTORY];
+        float       m_DtDebt;                       // Real time not yet passed on as dt (s)
+        uint32_t    m_DtHistoryIndex;
+        uint32_t    m_DtHistoryCount;
+    };
+
+    void ResetFramePacing(FramePacing* pacing, uint64_t time);
+
+    /// Waits until the next deadline, target_frametime after the previous one.
+    /// Returns false if the deadline was already missed.
+    bool WaitForDeadline(FramePacing* pacing, uint64_t target_frametime);
+
+    /// Smoothed dt from the measured frame time, averaged over the last frames and
+    /// snapped to the fixed dt when close. The real time not handed out because of the
+    /// smoothing is paid back over the following frames so the game time doesn't drift.
+    float EstimateDt(FramePacing* pacing, float frame_dt, float fixed_dt, float max_dt);
+}
+
+#endif // DM_ENGINE_PACING_H
@@ -17,6 +17,7 @@
 
 #include <dlib/configfile.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_system.h>
 #include <dlib/message.h>
 
 #include <resource/resource.h>
@@ -36,6 +37,8 @@
 
 #include <record/record.h>
 
+#include "engine_benchmark.h"
+#include "engine_pacing.h"
 #include "engine_service.h"
 #include "engine_ddf.h"
 
@@ -113,6 +116,8 @@ namespace dmEngine
         bool                                        m_Alive;
 
         dmGameObject::HRegister                     m_Register;
+        // Shared worker pool for the engine modules
+        dmJobSystem::HContext                       m_JobSystem;
         dmGameObject::HCollection                   m_MainCollection;
         dmArray<dmGameObject::InputAction>          m_InputBuffer;
 
@@ -161,8 +166,7 @@ namespace dmEngine
         bool                                        m_ConnectionAppMode;        //!< If the app was started on a device, listening for connections
         bool                                        m_RunWhileIconified;
         uint64_t                                    m_PreviousFrameTime;
-        uint64_t                                    m_PreviousRenderTime;
-        uint64_t                                    m_FlipTime;
+        FramePacing                                 m_FramePacing;
         uint32_t                                    m_UpdateFrequency;
         uint32_t                                    m_Width;
         uint32_t                                    m_Height;
@@ -172,6 +176,7 @@ namespace dmEngine
         Vsync                                       m_VsyncMode;
 
         RecordData                                  m_RecordData;
+        BenchmarkData                               m_Benchmark;
     };
 
 
@@ -11,11 +11,13 @@
 // specific language governing permissions and limitations under the License.
 
 #include <assert.h>
+#include <stdio.h>
 
 #include <dlib/http_client.h>
 #include <dlib/thread.h>
 #include <dlib/dstrings.h>
 #include <dlib/profile.h>
+#include <dlib/time.h>
 #include "test_engine.h"
 #include "../../../graphics/src/graphics_private.h"
 
@@ -88,6 +90,78 @@ TEST_F(EngineTest, RenderScript)
     ASSERT_EQ(frame_count, 1u);
 }
 
+TEST_F(EngineTest, Benchmark)
+{
+    uint32_t frame_count = 0;
+    const char* output = CONTENT_ROOT "/benchmark.json";
+    remove(output);
+    const char* argv[] = {"test_engine", "--benchmark-frames=10", "--benchmark-dt=0.02", "--benchmark-output=" CONTENT_ROOT "/benchmark.json", "--config=dmengine.unload_builtins=0", CONTENT_ROOT "/game.projectc"};
+    ASSERT_EQ(0, dmEngine::Launch(sizeof(argv)/sizeof(argv[0]), (char**)argv, 0, PostRunFrameCount, &frame_count));
+    ASSERT_EQ(10u, frame_count);
+
+    FILE* file = fopen(output, "rb");
+    ASSERT_NE((FILE*)0, file);
+    char buffer[4096];
+    size_t size = fread(buffer, 1, sizeof(buffer)-1, file);
+    fclose(file);
+    buffer[size] = 0;
+    ASSERT_NE((char*)0, strstr(buffer, "\"frames\": 10,"));
+    ASSERT_NE((char*)0, strstr(buffer, "\"dt\": 0.020000,"));
+    ASSERT_NE((char*)0, strstr(buffer, "\"frame_times\": ["));
+    remove(output);
+}
+
+TEST(FramePacing, EstimateDt)
+{
+    const float fixed_dt = 1.0f / 60.0f;
+    dmEngine::FramePacing pacing;
+    dmEngine::ResetFramePacing(&pacing, 0);
+
+    // Steady frames give the fixed dt
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        ASSERT_EQ(fixed_dt, dmEngine::EstimateDt(&pacing, fixed_dt, fixed_dt, fixed_dt * 25.0f));
+    }
+
+    // Jittery frames are smoothed, without losing any time in total
+    dmEngine::ResetFramePacing(&pacing, 0);
+    float real_time = 0.0f;
+    float game_time = 0.0f;
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        float frame_dt = (i % 2) ? 0.012f : 0.021f;
+        float dt = dmEngine::EstimateDt(&pacing, frame_dt, fixed_dt, fixed_dt * 25.0f);
+        if (i >= dmEngine::PACING_DT_HISTORY)
+        {
+            ASSERT_NEAR(0.0165f, dt, 0.002f);
+        }
+        real_time += frame_dt;
+        game_time += dt;
+    }
+    ASSERT_NEAR(real_time, game_time, fixed_dt);
+}
+
+TEST(FramePacing, WaitForDeadline)
+{
+    const uint64_t target_frametime = 5000;
+    dmEngine::FramePacing pacing;
+    uint64_t start = dmTime::GetTime();
+    dmEngine::ResetFramePacing(&pacing, start);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        dmEngine::WaitForDeadline(&pacing, target_frametime);
+    }
+    ASSERT_GE(pacing.m_Deadline, start + 4 * target_frametime);
+    ASSERT_GE(dmTime::GetTime(), pacing.m_Deadline);
+
+    // A frame more than a frame late is counted as missed and the schedule restarts from now
+    uint32_t missed = pacing.m_MissedDeadlines;
+    dmTime::Sleep(3 * target_frametime);
+    ASSERT_FALSE(dmEngine::WaitForDeadline(&pacing, target_frametime));
+    ASSERT_EQ(missed + 1, pacing.m_MissedDeadlines);
+    ASSERT_GT(pacing.m_Deadline, start + 6 * target_frametime);
+}
+
 struct HttpTestContext
 {
     HttpTestContext()
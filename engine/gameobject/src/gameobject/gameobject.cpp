@@ -22,6 +22,7 @@
 #include <dlib/index_pool.h>
 #include <dlib/profile.h>
 #include <dlib/math.h>
+#include <dlib/memory.h>
 #include <dlib/vmath.h>
 #include <dlib/mutex.h>
 #include <ddf/ddf.h>
@@ -80,6 +81,7 @@ namespace dmGameObject
     static void DeallocCollection(Collection* collection);
     static bool InitCollection(Collection* collection);
     static bool FinalCollection(Collection* collection);
+    static void DeleteInstancePool(InstancePool* pool);
 
     Prototype::~Prototype()
     {
@@ -157,6 +159,8 @@ namespace dmGameObject
     Register::Register()
     {
         m_ComponentTypeCount = 0;
+        m_UpdateStageCount = 0;
+        m_JobSystem = 0;
         m_DefaultCollectionCapacity = DEFAULT_MAX_COLLECTION_CAPACITY;
         m_Mutex = dmMutex::New();
         m_SocketToCollection.SetCapacity(15, 17);
@@ -170,6 +174,7 @@ namespace dmGameObject
     ComponentType::ComponentType()
     {
         memset(this, 0, sizeof(*this));
+        m_UpdateAccess = UPDATE_ACCESS_EXCLUSIVE;
     }
 
     void Initialize(HRegister regist, dmScript::HContext context)
@@ -251,6 +256,11 @@ namespace dmGameObject
         delete regist;
     }
 
+    void SetJobSystem(HRegister regist, dmJobSystem::HContext job_system)
+    {
+        regist->m_JobSystem = job_system;
+    }
+
     Collection* AllocCollection(const char* name, HRegister regist, uint32_t max_instances)
     {
         Collection* collection = new Collection(0, 0, max_instances);
@@ -284,6 +294,7 @@ namespace dmGameObject
                 regist->m_ComponentTypes[i].m_DeleteWorldFunction(params);
         }
         dmMutex::Delete(collection->m_Mutex);
+        DeleteInstancePool(&collection->m_InstancePool);
         delete collection;
     }
 
@@ -385,7 +396,7 @@ namespace dmGameObject
     {
         if (max_instances > INVALID_INSTANCE_INDEX)
         {
-            dmLogError("max_instances must be less or equal to %d", INVALID_INSTANCE_INDEX);
+            dmLogError("max_instances must be less or equal to %u", INVALID_INSTANCE_INDEX);
             return 0;
         }
 
@@ -486,6 +497,84 @@ namespace dmGameObject
         }
     };
 
+    static inline bool UpdateReadsTransforms(const ComponentType* type)
+    {
+        return type->m_ReadsTransforms || (type->m_UpdateAccess & UPDATE_ACCESS_READ_TRANSFORMS);
+    }
+
+    static bool UpdateAccessConflicts(const ComponentType* a, const ComponentType* b)
+    {
+        const uint32_t exclusive = UPDATE_ACCESS_EXCLUSIVE | UPDATE_ACCESS_OTHER_WORLDS;
+        if ((a->m_UpdateAccess & exclusive) || (b->m_UpdateAccess & exclusive))
+        {
+            return true;
+        }
+
+        bool a_reads_transforms = UpdateReadsTransforms(a);
+        bool b_reads_transforms = UpdateReadsTransforms(b);
+        bool a_writes_transforms = (a->m_UpdateAccess & UPDATE_ACCESS_WRITE_TRANSFORMS) != 0;
+        bool b_writes_transforms = (b->m_UpdateAccess & UPDATE_ACCESS_WRITE_TRANSFORMS) != 0;
+        if ((a_writes_transforms && (b_reads_transforms || b_writes_transforms)) || (b_writes_transforms && a_reads_transforms))
+        {
+            return true;
+        }
+
+        // Messages are posted to the same socket queue, so two posting types are kept in order to keep the message order deterministic
+        bool a_reads_messages = (a->m_UpdateAccess & UPDATE_ACCESS_READ_MESSAGES) != 0;
+        bool b_reads_messages = (b->m_UpdateAccess & UPDATE_ACCESS_READ_MESSAGES) != 0;
+        bool a_writes_messages = (a->m_UpdateAccess & UPDATE_ACCESS_WRITE_MESSAGES) != 0;
+        bool b_writes_messages = (b->m_UpdateAccess & UPDATE_ACCESS_WRITE_MESSAGES) != 0;
+        return (a_writes_messages && (b_reads_messages || b_writes_messages)) || (b_writes_messages && a_reads_messages);
+    }
+
+    // Assigns each component type with an update function to the earliest stage after all the
+    // types it conflicts with that come before it in the update order. Types within a stage are
+    // kept in update order.
+    static void BuildUpdateSchedule(HRegister regist)
+    {
+        uint16_t types[MAX_COMPONENT_TYPES];
+        uint16_t stages[MAX_COMPONENT_TYPES];
+        uint32_t type_count = 0;
+        uint32_t stage_count = 0;
+        for (uint32_t i = 0; i < regist->m_ComponentTypeCount; ++i)
+        {
+            uint16_t type_index = regist->m_ComponentTypesOrder[i];
+            const ComponentType* type = &regist->m_ComponentTypes[type_index];
+            if (type->m_UpdateFunction == 0x0)
+            {
+                continue;
+            }
+
+            uint16_t stage = 0;
+            for (uint32_t j = 0; j < type_count; ++j)
+            {
+                if (stages[j] >= stage && UpdateAccessConflicts(&regist->m_ComponentTypes[types[j]], type))
+                {
+                    stage = stages[j] + 1;
+                }
+            }
+            types[type_count] = type_index;
+            stages[type_count] = stage;
+            ++type_count;
+            stage_count = dmMath::Max(stage_count, (uint32_t)stage + 1);
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t stage = 0; stage < stage_count; ++stage)
+        {
+            regist->m_UpdateStageOffsets[stage] = offset;
+            for (uint32_t i = 0; i < type_count; ++i)
+            {
+                if (stages[i] == stage)
+                {
+                    regist->m_UpdateStageTypes[offset++] = types[i];
+                }
+            }
+        }
+        regist->m_UpdateStageOffsets[stage_count] = offset;
+        regist->m_UpdateStageCount = stage_count;
+    }
+
     Result RegisterComponentType(HRegister regist, const ComponentType& type)
     {
         if (regist->m_ComponentTypeCount == MAX_COMPONENT_TYPES)
@@ -503,6 +592,7 @@ namespace dmGameObject
         regist->m_ComponentTypesOrder[regist->m_ComponentTypeCount] = regist->m_ComponentTypeCount;
         regist->m_ComponentProfileCounterIndex[regist->m_ComponentTypeCount] = dmProfile::AllocateCounter(type.m_Name);
         regist->m_ComponentTypeCount++;
+        BuildUpdateSchedule(regist);
         return RESULT_OK;
     }
 
@@ -529,6 +619,7 @@ namespace dmGameObject
     void SortComponentTypes(HRegister regist)
     {
         std::sort(regist->m_ComponentTypesOrder, regist->m_ComponentTypesOrder + regist->m_ComponentTypeCount, ComponentTypeSortPred(regist));
+        BuildUpdateSchedule(regist);
     }
 
     dmResource::Result RegisterResourceTypes(dmResource::HFactory factory, HRegister regist, dmScript::HContext script_context, ModuleContext* module_context)
@@ -563,12 +654,12 @@ namespace dmGameObject
          * Remove instance from m_LevelIndices using an erase-swap operation
          */
 
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<InstanceIndex>& level = collection->m_LevelIndices[instance->m_Depth];
         assert(level.Size() > 0);
         assert(instance->m_LevelIndex < level.Size());
 
-        uint16_t level_index = instance->m_LevelIndex;
-        uint16_t swap_in_index = level.EraseSwap(level_index);
+        InstanceIndex level_index = instance->m_LevelIndex;
+        InstanceIndex swap_in_index = level.EraseSwap(level_index);
         HInstance swap_in_instance = collection->m_Instances[swap_in_index];
         assert(swap_in_instance->m_Index == swap_in_index);
         swap_in_instance->m_LevelIndex = level_index;
@@ -580,7 +671,7 @@ namespace dmGameObject
      * ** 10 elements as min
      * ** Up to max_instances as max
      */
-    static void ExpandLevel(dmArray<uint16_t>& level, uint32_t max_instances)
+    static void ExpandLevel(dmArray<InstanceIndex>& level, uint32_t max_instances)
     {
         const uint32_t min_offset = 10;
         const uint32_t max_offset = max_instances - level.Capacity();
@@ -593,18 +684,78 @@ namespace dmGameObject
         /*
          * Insert instance in m_LevelIndices at level set in instance->m_Depth
          */
-        dmArray<uint16_t>& level = collection->m_LevelIndices[instance->m_Depth];
+        dmArray<InstanceIndex>& level = collection->m_LevelIndices[instance->m_Depth];
         if (level.Full())
             ExpandLevel(level, collection->m_MaxInstances);
         assert(!level.Full());
 
-        uint16_t level_index = (uint16_t)level.Size();
+        InstanceIndex level_index = (InstanceIndex)level.Size();
         level.SetSize(level_index + 1);
         level[level_index] = instance->m_Index;
         instance->m_LevelIndex = level_index;
     }
 
-    static HInstance AllocInstance(Prototype* proto, const char* prototype_name) {
+    static uint32_t InstanceMemorySize(uint32_t component_userdata_count)
+    {
+        uint32_t component_userdata_size = sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]);
+        uint32_t size = sizeof(Instance) + component_userdata_count * component_userdata_size;
+        // Keep the blocks in a slab 16 byte aligned, for the vector math types
+        return (size + 15) & ~15U;
+    }
+
+    static void* AllocInstanceMemory(InstancePool* pool, uint32_t component_userdata_count)
+    {
+        if (component_userdata_count >= pool->m_FreeLists.Size())
+        {
+            uint32_t old_size = pool->m_FreeLists.Size();
+            pool->m_FreeLists.SetCapacity(component_userdata_count + 1);
+            pool->m_FreeLists.SetSize(component_userdata_count + 1);
+            memset(&pool->m_FreeLists[old_size], 0, (component_userdata_count + 1 - old_size) * sizeof(void*));
+        }
+
+        void* block = pool->m_FreeLists[component_userdata_count];
+        if (block == 0)
+        {
+            uint32_t block_size = InstanceMemorySize(component_userdata_count);
+            void* slab = 0;
+            if (dmMemory::AlignedMalloc(&slab, 16, block_size * INSTANCE_POOL_SLAB_SIZE) != dmMemory::RESULT_OK)
+            {
+                return 0;
+            }
+            if (pool->m_Slabs.Full())
+            {
+                pool->m_Slabs.OffsetCapacity(16);
+            }
+            pool->m_Slabs.Push(slab);
+
+            uint8_t* p = (uint8_t*) slab;
+            for (uint32_t i = 0; i < INSTANCE_POOL_SLAB_SIZE; ++i, p += block_size)
+            {
+                *(void**) p = i + 1 < INSTANCE_POOL_SLAB_SIZE ? (void*) (p + block_size) : 0;
+            }
+            block = slab;
+        }
+        pool->m_FreeLists[component_userdata_count] = *(void**) block;
+        return block;
+    }
+
+    static void FreeInstanceMemory(InstancePool* pool, void* block, uint32_t component_userdata_count)
+    {
+        *(void**) block = pool->m_FreeLists[component_userdata_count];
+        pool->m_FreeLists[component_userdata_count] = block;
+    }
+
+    static void DeleteInstancePool(InstancePool* pool)
+    {
+        for (uint32_t i = 0; i < pool->m_Slabs.Size(); ++i)
+        {
+            dmMemory::AlignedFree(pool->m_Slabs[i]);
+        }
+        pool->m_Slabs.SetCapacity(0);
+        pool->m_FreeLists.SetCapacity(0);
+    }
+
+    static HInstance AllocInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
         // Count number of component userdata fields required
         uint32_t component_instance_userdata_count = 0;
         for (uint32_t i = 0; i < proto->m_ComponentCount; ++i)
@@ -620,15 +771,21 @@ namespace dmGameObject
                 component_instance_userdata_count++;
         }
 
-        uint32_t component_userdata_size = sizeof(((Instance*)0)->m_ComponentInstanceUserData[0]);
         // NOTE: Allocate actual Instance with *all* component instance user-data accounted
-        void* instance_memory = ::operator new (sizeof(Instance) + component_instance_userdata_count * component_userdata_size);
+        void* instance_memory = AllocInstanceMemory(&collection->m_InstancePool, component_instance_userdata_count);
+        if (!instance_memory)
+        {
+            dmLogError("Could not allocate memory for an instance of '%s'.", prototype_name);
+            return 0;
+        }
         Instance* instance = new(instance_memory) Instance(proto);
+        instance->m_Collection = collection;
         instance->m_ComponentInstanceUserDataCount = component_instance_userdata_count;
         return instance;
     }
 
-    static void DeallocInstance(HInstance instance) {
+    static void DeallocInstance(Collection* collection, HInstance instance) {
+        uint32_t component_instance_userdata_count = instance->m_ComponentInstanceUserDataCount;
         instance->~Instance();
         void* instance_memory = (void*) instance;
 
@@ -636,7 +793,7 @@ namespace dmGameObject
         // TODO: #ifdef on something...?
         // Clear all memory excluding ComponentInstanceUserData
         memset(instance_memory, 0xcc, sizeof(Instance));
-        operator delete (instance_memory);
+        FreeInstanceMemory(&collection->m_InstancePool, instance_memory, component_instance_userdata_count);
     }
 
     HInstance NewInstance(Collection* collection, Prototype* proto, const char* prototype_name) {
@@ -645,10 +802,13 @@ namespace dmGameObject
             dmLogError("The game object instance could not be created since the buffer is full (%d).", collection->m_InstanceIndices.Capacity());
             return 0;
         }
-        HInstance instance = AllocInstance(proto, prototype_name);
-        instance->m_Collection = collection;
+        HInstance instance = AllocInstance(collection, proto, prototype_name);
+        if (!instance)
+        {
+            return 0;
+        }
         instance->m_ScaleAlongZ = collection->m_ScaleAlongZ;
-        uint16_t instance_index = collection->m_InstanceIndices.Pop();
+        InstanceIndex instance_index = collection->m_InstanceIndices.Pop();
         instance->m_Index = instance_index;
         assert(collection->m_Instances[instance_index] == 0);
         collection->m_Instances[instance_index] = instance;
@@ -673,8 +833,8 @@ namespace dmGameObject
             Unlink(collection, instance);
         }
 
-        uint16_t instance_index = instance->m_Index;
-        operator delete ((void*)instance);
+        InstanceIndex instance_index = instance->m_Index;
+        DeallocInstance(collection, instance);
         collection->m_Instances[instance_index] = 0x0;
         collection->m_InstanceIndices.Push(instance_index);
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
@@ -684,79 +844,87 @@ namespace dmGameObject
         UndoNewInstance(hcollection->m_Collection, instance);
     }
 
-    bool CreateComponents(Collection* collection, HInstance instance) {
+    static bool CreateComponent(Collection* collection, HInstance instance, uint32_t component_index, uint32_t component_instance_data_index)
+    {
+        Prototype::Component* component = &instance->m_Prototype->m_Components[component_index];
+        ComponentType* component_type = component->m_Type;
+        assert(component_type);
+
+        uintptr_t* component_instance_data = 0;
+        if (component_type->m_InstanceHasUserData)
+        {
+            assert(component_instance_data_index < instance->m_ComponentInstanceUserDataCount);
+            component_instance_data = &instance->m_ComponentInstanceUserData[component_instance_data_index];
+            *component_instance_data = 0;
+        }
+
+        ComponentCreateParams params;
+        params.m_Instance = instance;
+        params.m_Position = component->m_Position;
+        params.m_Rotation = component->m_Rotation;
+        params.m_ComponentIndex = component_index;
+        params.m_Resource = component->m_Resource;
+        params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
+        params.m_Context = component_type->m_Context;
+        params.m_UserData = component_instance_data;
+        params.m_PropertySet = component->m_PropertySet;
+        CreateResult create_result =  component_type->m_CreateFunction(params);
+        if (create_result == CREATE_RESULT_OK)
+        {
+            collection->m_ComponentInstanceCount[component->m_TypeIndex]++;
+            return true;
+        }
+        return false;
+    }
+
+    // Destroys the first components_created components of an instance, after a failed creation
+    static void DestroyCreatedComponents(Collection* collection, HInstance instance, uint32_t components_created)
+    {
         Prototype* proto = instance->m_Prototype;
-        uint32_t components_created = 0;
         uint32_t next_component_instance_data = 0;
-        bool ok = true;
-        if (proto->m_ComponentCount > 0xFFFF ) {
-            dmLogWarning("Too many components in game object: %u (max is 65536)", proto->m_ComponentCount);
-            return false;
-        }
-        for (uint32_t i = 0; i < proto->m_ComponentCount; ++i)
+        for (uint32_t i = 0; i < components_created; ++i)
         {
             Prototype::Component* component = &proto->m_Components[i];
             ComponentType* component_type = component->m_Type;
             assert(component_type);
-
             uintptr_t* component_instance_data = 0;
             if (component_type->m_InstanceHasUserData)
             {
                 component_instance_data = &instance->m_ComponentInstanceUserData[next_component_instance_data++];
-                *component_instance_data = 0;
             }
             assert(next_component_instance_data <= instance->m_ComponentInstanceUserDataCount);
 
-            ComponentCreateParams params;
+            collection->m_ComponentInstanceCount[component->m_TypeIndex]--;
+            ComponentDestroyParams params;
+            params.m_Collection = collection->m_HCollection;
             params.m_Instance = instance;
-            params.m_Position = component->m_Position;
-            params.m_Rotation = component->m_Rotation;
-            params.m_ComponentIndex = i;
-            params.m_Resource = component->m_Resource;
             params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
             params.m_Context = component_type->m_Context;
             params.m_UserData = component_instance_data;
-            params.m_PropertySet = component->m_PropertySet;
-            CreateResult create_result =  component_type->m_CreateFunction(params);
-            if (create_result == CREATE_RESULT_OK)
-            {
-                collection->m_ComponentInstanceCount[component->m_TypeIndex]++;
-                components_created++;
-            }
-            else
-            {
-                ok = false;
-                break;
-            }
+            component_type->m_DestroyFunction(params);
         }
+    }
 
-        if (!ok)
+    bool CreateComponents(Collection* collection, HInstance instance) {
+        Prototype* proto = instance->m_Prototype;
+        if (proto->m_ComponentCount > 0xFFFF ) {
+            dmLogWarning("Too many components in game object: %u (max is 65536)", proto->m_ComponentCount);
+            return false;
+        }
+        uint32_t next_component_instance_data = 0;
+        for (uint32_t i = 0; i < proto->m_ComponentCount; ++i)
         {
-            uint32_t next_component_instance_data = 0;
-            for (uint32_t i = 0; i < components_created; ++i)
+            if (!CreateComponent(collection, instance, i, next_component_instance_data))
             {
-                Prototype::Component* component = &proto->m_Components[i];
-                ComponentType* component_type = component->m_Type;
-                assert(component_type);
-                uintptr_t* component_instance_data = 0;
-                if (component_type->m_InstanceHasUserData)
-                {
-                    component_instance_data = &instance->m_ComponentInstanceUserData[next_component_instance_data++];
-                }
-                assert(next_component_instance_data <= instance->m_ComponentInstanceUserDataCount);
-
-                collection->m_ComponentInstanceCount[component->m_TypeIndex]--;
-                ComponentDestroyParams params;
-                params.m_Collection = collection->m_HCollection;
-                params.m_Instance = instance;
-                params.m_World = collection->m_ComponentWorlds[component->m_TypeIndex];
-                params.m_Context = component_type->m_Context;
-                params.m_UserData = component_instance_data;
-                component_type->m_DestroyFunction(params);
+                DestroyCreatedComponents(collection, instance, i);
+                return false;
+            }
+            if (proto->m_Components[i].m_Type->m_InstanceHasUserData)
+            {
+                next_component_instance_data++;
             }
         }
-
-        return ok;
+        return true;
     }
 
     bool CreateComponents(HCollection hcollection, HInstance instance) {
@@ -914,8 +1082,8 @@ namespace dmGameObject
             return;
         }
         instance->m_ToBeAdded = 1;
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToAddTail;
+        InstanceIndex index = instance->m_Index;
+        InstanceIndex tail = collection->m_InstancesToAddTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToAdd = index;
@@ -974,7 +1142,7 @@ namespace dmGameObject
             dmLogError("Instances can not be added to update during the update.");
             return false;
         }
-        uint16_t index = collection->m_InstancesToAddHead;
+        InstanceIndex index = collection->m_InstancesToAddHead;
         bool result = true;
         while (index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[index];
@@ -1028,14 +1196,9 @@ namespace dmGameObject
         return true;
     }
 
-    // Supplied 'proto' will be released after this function is done.
-    static HInstance SpawnInternal(Collection* collection, Prototype *proto, const char *prototype_name, dmhash_t id, uint8_t* property_buffer, uint32_t property_buffer_size, const Point3& position, const Quat& rotation, const Vector3& scale)
+    // Sets up a new instance of a spawned prototype, up until the components are created
+    static HInstance BeginSpawn(Collection* collection, Prototype* proto, const char* prototype_name, dmhash_t id, const Point3& position, const Quat& rotation, const Vector3& scale)
     {
-        if (collection->m_ToBeDeleted) {
-            dmLogWarning("Spawning is not allowed when the collection is being deleted.");
-            return 0;
-        }
-
         HInstance instance = dmGameObject::NewInstance(collection, proto, prototype_name);
         if (instance == 0) {
             return 0;
@@ -1058,15 +1221,13 @@ namespace dmGameObject
             UndoNewInstance(collection, instance);
             return 0;
         }
+        return instance;
+    }
 
-        bool success = CreateComponents(collection, instance);
-        if (!success) {
-            ReleaseIdentifier(collection, instance);
-            UndoNewInstance(collection, instance);
-            return 0;
-        }
-
-        success = SetScriptPropertiesFromBuffer(instance, prototype_name, property_buffer, property_buffer_size);
+    // Applies the properties and initializes a spawned instance once its components are created
+    static HInstance FinishSpawn(Collection* collection, HInstance instance, const char* prototype_name, uint8_t* property_buffer, uint32_t property_buffer_size)
+    {
+        bool success = SetScriptPropertiesFromBuffer(instance, prototype_name, property_buffer, property_buffer_size);
 
         if (success && !InitInstance(collection, instance))
         {
@@ -1084,6 +1245,29 @@ namespace dmGameObject
         return instance;
     }
 
+    // Supplied 'proto' will be released after this function is done.
+    static HInstance SpawnInternal(Collection* collection, Prototype *proto, const char *prototype_name, dmhash_t id, uint8_t* property_buffer, uint32_t property_buffer_size, const Point3& position, const Quat& rotation, const Vector3& scale)
+    {
+        if (collection->m_ToBeDeleted) {
+            dmLogWarning("Spawning is not allowed when the collection is being deleted.");
+            return 0;
+        }
+
+        HInstance instance = BeginSpawn(collection, proto, prototype_name, id, position, rotation, scale);
+        if (instance == 0) {
+            return 0;
+        }
+
+        bool success = CreateComponents(collection, instance);
+        if (!success) {
+            ReleaseIdentifier(collection, instance);
+            UndoNewInstance(collection, instance);
+            return 0;
+        }
+
+        return FinishSpawn(collection, instance, prototype_name, property_buffer, property_buffer_size);
+    }
+
     // Returns if successful or not
     static bool CollectionSpawnFromDescInternal(Collection* collection, dmGameObjectDDF::CollectionDesc* collection_desc, InstancePropertyBuffers *property_buffers, InstanceIdMap *id_mapping, dmTransform::Transform const &transform)
     {
@@ -1423,6 +1607,71 @@ namespace dmGameObject
         return instance;
     }
 
+    uint32_t SpawnBatch(HCollection hcollection, HPrototype proto, const char* prototype_name, const dmhash_t* ids, uint8_t* property_buffer, uint32_t property_buffer_size,
+                        const Point3* positions, const Quat* rotations, const Vector3* scales, uint32_t count, HInstance* out_instances)
+    {
+        DM_PROFILE(GameObject, "SpawnBatch");
+        memset(out_instances, 0, count * sizeof(HInstance));
+        if (proto == 0x0) {
+            dmLogError("No prototype to spawn from.");
+            return 0;
+        }
+
+        Collection* collection = hcollection->m_Collection;
+        if (collection->m_ToBeDeleted) {
+            dmLogWarning("Spawning is not allowed when the collection is being deleted.");
+            return 0;
+        }
+        if (proto->m_ComponentCount > 0xFFFF ) {
+            dmLogWarning("Too many components in game object: %u (max is 65536)", proto->m_ComponentCount);
+            return 0;
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            out_instances[i] = BeginSpawn(collection, proto, prototype_name, ids[i], positions[i], rotations[i], scales[i]);
+        }
+
+        // Create the components one component type at a time, over all instances, in the order of the prototype.
+        // This keeps each type's create function and world hot in the cache.
+        uint32_t next_component_instance_data = 0;
+        for (uint32_t c = 0; c < proto->m_ComponentCount; ++c)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                HInstance instance = out_instances[i];
+                if (instance == 0)
+                    continue;
+                if (!CreateComponent(collection, instance, c, next_component_instance_data))
+                {
+                    DestroyCreatedComponents(collection, instance, c);
+                    ReleaseIdentifier(collection, instance);
+                    UndoNewInstance(collection, instance);
+                    out_instances[i] = 0;
+                }
+            }
+            if (proto->m_Components[c].m_Type->m_InstanceHasUserData)
+            {
+                next_component_instance_data++;
+            }
+        }
+
+        uint32_t spawned = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (out_instances[i] == 0)
+                continue;
+            out_instances[i] = FinishSpawn(collection, out_instances[i], prototype_name, property_buffer, property_buffer_size);
+            if (out_instances[i] != 0)
+                ++spawned;
+        }
+
+        if (spawned != count) {
+            dmLogError("Could only spawn %u of %u instances of prototype %s.", spawned, count, prototype_name);
+        }
+        return spawned;
+    }
+
     static void Unlink(Collection* collection, Instance* instance)
     {
         // Unlink "me" from parent
@@ -1740,8 +1989,8 @@ namespace dmGameObject
         // Delete instance
         instance->m_ToBeDeleted = 1;
 
-        uint16_t index = instance->m_Index;
-        uint16_t tail = collection->m_InstancesToDeleteTail;
+        InstanceIndex index = instance->m_Index;
+        InstanceIndex tail = collection->m_InstancesToDeleteTail;
         if (tail != INVALID_INSTANCE_INDEX) {
             HInstance tail_instance = collection->m_Instances[tail];
             tail_instance->m_NextToDelete = index;
@@ -1758,10 +2007,10 @@ namespace dmGameObject
 
     static void RemoveFromAddToUpdate(Collection* collection, HInstance instance)
     {
-        uint16_t index = instance->m_Index;
+        InstanceIndex index = instance->m_Index;
         assert(collection->m_InstancesToAddTail == index || instance->m_NextToAdd != INVALID_INSTANCE_INDEX);
-        uint16_t* prev_index_ptr = &collection->m_InstancesToAddHead;
-        uint16_t prev_index = *prev_index_ptr;
+        InstanceIndex* prev_index_ptr = &collection->m_InstancesToAddHead;
+        InstanceIndex prev_index = *prev_index_ptr;
         while (prev_index != index) {
             prev_index_ptr = &collection->m_Instances[prev_index]->m_NextToAdd;
             if (collection->m_InstancesToAddTail == *prev_index_ptr) {
@@ -1870,7 +2119,7 @@ namespace dmGameObject
             collection->m_InputFocusStack.Pop();
         }
 
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
 
         assert(collection->m_IDToInstance.Size() <= collection->m_InstanceIndices.Size());
     }
@@ -1981,11 +2230,11 @@ namespace dmGameObject
         return instance->m_Bone;
     }
 
-    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, uint16_t first_index, dmTransform::Transform* transforms, uint32_t transform_count)
+    static uint32_t DoSetBoneTransforms(HCollection hcollection, dmTransform::Transform* component_transform, InstanceIndex first_index, dmTransform::Transform* transforms, uint32_t transform_count)
     {
         if (transform_count == 0)
             return 0;
-        uint16_t current_index = first_index;
+        InstanceIndex current_index = first_index;
         uint32_t count = 0;
         Collection* collection = hcollection->m_Collection;
         while (current_index != INVALID_INSTANCE_INDEX)
@@ -2016,8 +2265,8 @@ namespace dmGameObject
         return DoSetBoneTransforms(instance->m_Collection->m_HCollection, &component_transform, instance->m_Index, transforms, transform_count);
     }
 
-    static void DeleteBones(Collection* collection, uint16_t first_index) {
-        uint16_t current_index = first_index;
+    static void DeleteBones(Collection* collection, InstanceIndex first_index) {
+        InstanceIndex current_index = first_index;
         while (current_index != INVALID_INSTANCE_INDEX) {
             HInstance instance = collection->m_Instances[current_index];
             if (instance->m_Bone && instance->m_ToBeDeleted == 0) {
@@ -2328,15 +2577,15 @@ namespace dmGameObject
 
         // Calculate world transforms
         // First root-level instances
-        dmArray<uint16_t>& root_level = collection->m_LevelIndices[0];
+        dmArray<InstanceIndex>& root_level = collection->m_LevelIndices[0];
         uint32_t root_count = root_level.Size();
         for (uint32_t i = 0; i < root_count; ++i)
         {
-            uint16_t index = root_level[i];
+            InstanceIndex index = root_level[i];
             Instance* instance = collection->m_Instances[index];
             CheckEuler(instance);
             collection->m_WorldTransforms[index] = dmTransform::ToMatrix4(instance->m_Transform);
-            uint16_t parent_index = instance->m_Parent;
+            InstanceIndex parent_index = instance->m_Parent;
             assert(parent_index == INVALID_INSTANCE_INDEX);
         }
 
@@ -2344,16 +2593,16 @@ namespace dmGameObject
         if (collection->m_ScaleAlongZ) {
             for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
             {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+                dmArray<InstanceIndex>& level = collection->m_LevelIndices[level_i];
                 uint32_t instance_count = level.Size();
                 for (uint32_t i = 0; i < instance_count; ++i)
                 {
-                    uint16_t index = level[i];
+                    InstanceIndex index = level[i];
                     Instance* instance = collection->m_Instances[index];
                     CheckEuler(instance);
                     Matrix4* trans = &collection->m_WorldTransforms[index];
 
-                    uint16_t parent_index = instance->m_Parent;
+                    InstanceIndex parent_index = instance->m_Parent;
                     assert(parent_index != INVALID_INSTANCE_INDEX);
 
                     Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
@@ -2364,16 +2613,16 @@ namespace dmGameObject
         } else {
             for (uint32_t level_i = 1; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
             {
-                dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+                dmArray<InstanceIndex>& level = collection->m_LevelIndices[level_i];
                 uint32_t instance_count = level.Size();
                 for (uint32_t i = 0; i < instance_count; ++i)
                 {
-                    uint16_t index = level[i];
+                    InstanceIndex index = level[i];
                     Instance* instance = collection->m_Instances[index];
                     CheckEuler(instance);
                     Matrix4* trans = &collection->m_WorldTransforms[index];
 
-                    uint16_t parent_index = instance->m_Parent;
+                    InstanceIndex parent_index = instance->m_Parent;
                     assert(parent_index != INVALID_INSTANCE_INDEX);
 
                     Matrix4* parent_trans = &collection->m_WorldTransforms[parent_index];
@@ -2391,6 +2640,104 @@ namespace dmGameObject
         UpdateTransforms(hcollection->m_Collection);
     }
 
+    static UpdateResult UpdateComponentType(Collection* collection, uint16_t update_index, const UpdateContext* update_context, ComponentsUpdateResult& update_result)
+    {
+        ComponentType* component_type = &collection->m_Register->m_ComponentTypes[update_index];
+        DM_PROFILE(GameObject, component_type->m_Name);
+        ComponentsUpdateParams params;
+        params.m_Collection = collection->m_HCollection;
+        params.m_UpdateContext = update_context;
+        params.m_World = collection->m_ComponentWorlds[update_index];
+        params.m_Context = component_type->m_Context;
+
+        update_result.m_TransformsUpdated = false;
+        return component_type->m_UpdateFunction(params, update_result);
+    }
+
+    struct UpdateComponentTypeJob
+    {
+        Collection*             m_Collection;
+        const UpdateContext*    m_UpdateContext;
+        ComponentsUpdateResult* m_UpdateResult;
+        UpdateResult            m_Result;
+        uint16_t                m_UpdateIndex;
+    };
+
+    static void UpdateComponentTypeJobFunction(void* context, void* data)
+    {
+        UpdateComponentTypeJob* job = (UpdateComponentTypeJob*) data;
+        job->m_Result = UpdateComponentType(job->m_Collection, job->m_UpdateIndex, job->m_UpdateContext, *job->m_UpdateResult);
+    }
+
+    // Updates the thread safe component types of a stage on the job system, and the other types of the stage on
+    // the calling thread meanwhile. Returns false if there is nothing to run concurrently or no job could be created,
+    // in which case no component type has been updated.
+    static bool UpdateStageConcurrently(Collection* collection, uint32_t begin, uint32_t end, const UpdateContext* update_context, ComponentsUpdateResult* update_results, bool* ret)
+    {
+        HRegister reg = collection->m_Register;
+        dmJobSystem::HContext job_system = reg->m_JobSystem;
+
+        uint32_t thread_safe_count = 0;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            if (reg->m_ComponentTypes[reg->m_UpdateStageTypes[i]].m_ThreadSafeUpdate)
+                ++thread_safe_count;
+        }
+        if (thread_safe_count == 0)
+            return false;
+
+        dmJobSystem::HJob parent = dmJobSystem::CreateJob(job_system, 0, 0, 0, dmJobSystem::INVALID_JOB, 0, "UpdateStage");
+        if (parent == dmJobSystem::INVALID_JOB)
+            return false;
+
+        UpdateComponentTypeJob jobs[MAX_COMPONENT_TYPES];
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            UpdateComponentTypeJob* job = &jobs[i - begin];
+            job->m_Collection = collection;
+            job->m_UpdateContext = update_context;
+            job->m_UpdateResult = &update_results[i];
+            job->m_UpdateIndex = reg->m_UpdateStageTypes[i];
+            job->m_Result = UPDATE_RESULT_OK;
+        }
+
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            UpdateComponentTypeJob* job = &jobs[i - begin];
+            const ComponentType* type = &reg->m_ComponentTypes[job->m_UpdateIndex];
+            if (!type->m_ThreadSafeUpdate)
+                continue;
+            dmJobSystem::HJob handle = dmJobSystem::CreateJob(job_system, UpdateComponentTypeJobFunction, 0, job, parent, 0, type->m_Name);
+            if (handle != dmJobSystem::INVALID_JOB)
+            {
+                dmJobSystem::Run(job_system, handle);
+            }
+            else
+            {
+                // Out of jobs, the types in a stage don't conflict so it's safe to update this one right away
+                UpdateComponentTypeJobFunction(0, job);
+            }
+        }
+        dmJobSystem::Run(job_system, parent);
+
+        // The types that haven't declared a thread safe update are always updated by this thread
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            UpdateComponentTypeJob* job = &jobs[i - begin];
+            if (!reg->m_ComponentTypes[job->m_UpdateIndex].m_ThreadSafeUpdate)
+                UpdateComponentTypeJobFunction(0, job);
+        }
+
+        dmJobSystem::Wait(job_system, parent);
+
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            if (jobs[i - begin].m_Result != UPDATE_RESULT_OK)
+                *ret = false;
+        }
+        return true;
+    }
+
     static bool Update(Collection* collection, const UpdateContext* update_context)
     {
         DM_PROFILE(GameObject, "Update");
@@ -2405,43 +2752,62 @@ namespace dmGameObject
 
         bool ret = true;
 
-        uint32_t component_types = collection->m_Register->m_ComponentTypeCount;
+        HRegister reg = collection->m_Register;
+        uint32_t component_types = reg->m_ComponentTypeCount;
         for (uint32_t i = 0; i < component_types; ++i)
         {
-            uint16_t update_index = collection->m_Register->m_ComponentTypesOrder[i];
-            ComponentType* component_type = &collection->m_Register->m_ComponentTypes[update_index];
+            uint16_t update_index = reg->m_ComponentTypesOrder[i];
+            DM_COUNTER_DYN(reg->m_ComponentProfileCounterIndex[update_index], collection->m_ComponentInstanceCount[update_index]);
+        }
 
-            DM_COUNTER_DYN(collection->m_Register->m_ComponentProfileCounterIndex[update_index], collection->m_ComponentInstanceCount[update_index]);
+        // The types within a stage have declared update access that do not conflict, so
+        // transforms are only updated and messages only dispatched between the stages.
+        ComponentsUpdateResult update_results[MAX_COMPONENT_TYPES];
+        uint32_t stage_count = reg->m_UpdateStageCount;
+        for (uint32_t stage = 0; stage < stage_count; ++stage)
+        {
+            uint32_t begin = reg->m_UpdateStageOffsets[stage];
+            uint32_t end = reg->m_UpdateStageOffsets[stage + 1];
 
             // Avoid to call UpdateTransforms for each/all component types.
-            if (component_type->m_ReadsTransforms && collection->m_DirtyTransforms) {
-                UpdateTransforms(collection);
+            if (collection->m_DirtyTransforms)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    if (UpdateReadsTransforms(&reg->m_ComponentTypes[reg->m_UpdateStageTypes[i]]))
+                    {
+                        UpdateTransforms(collection);
+                        break;
+                    }
+                }
             }
 
-            if (component_type->m_UpdateFunction)
+            if (reg->m_JobSystem == 0 || end - begin < 2 || !UpdateStageConcurrently(collection, begin, end, update_context, update_results, &ret))
             {
-                DM_PROFILE(GameObject, component_type->m_Name);
-                ComponentsUpdateParams params;
-                params.m_Collection = collection->m_HCollection;
-                params.m_UpdateContext = update_context;
-                params.m_World = collection->m_ComponentWorlds[update_index];
-                params.m_Context = component_type->m_Context;
-
-                ComponentsUpdateResult update_result;
-                update_result.m_TransformsUpdated = false;
-                UpdateResult res = component_type->m_UpdateFunction(params, update_result);
-                if (res != UPDATE_RESULT_OK)
-                    ret = false;
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    if (UpdateComponentType(collection, reg->m_UpdateStageTypes[i], update_context, update_results[i]) != UPDATE_RESULT_OK)
+                        ret = false;
+                }
+            }
 
-                // Mark the collections transforms as dirty if this component has updated
-                // them in its update function.
-                collection->m_DirtyTransforms |= update_result.m_TransformsUpdated;
+            // Mark the collections transforms as dirty if any component type in the stage
+            // has updated them in its update function.
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                collection->m_DirtyTransforms |= update_results[i].m_TransformsUpdated;
             }
 
             if (!DispatchMessages(collection, &collection->m_ComponentSocket, 1))
                 ret = false;
         }
 
+        if (stage_count == 0)
+        {
+            if (!DispatchMessages(collection, &collection->m_ComponentSocket, 1))
+                ret = false;
+        }
+
         collection->m_InUpdate = 0;
         if (collection->m_DirtyTransforms) {
             UpdateTransforms(collection);
@@ -2534,11 +2900,11 @@ namespace dmGameObject
             while (collection->m_InstancesToDeleteHead != INVALID_INSTANCE_INDEX && pass_count < max_pass_count) {
                 ++pass_count;
                 // Save the list and clear the head and tail
-                uint16_t head = collection->m_InstancesToDeleteHead;
+                InstanceIndex head = collection->m_InstancesToDeleteHead;
                 collection->m_InstancesToDeleteHead = INVALID_INSTANCE_INDEX;
                 collection->m_InstancesToDeleteTail = INVALID_INSTANCE_INDEX;
 
-                uint16_t index = head;
+                InstanceIndex index = head;
                 while (index != INVALID_INSTANCE_INDEX) {
                     Instance* instance = collection->m_Instances[index];
 
@@ -3389,12 +3755,12 @@ namespace dmGameObject
     //  - patch data structures for identification and input stack
     //  - copy the rest of the fields
     // The old instance is destroyed.
-    static void RecreateInstance(Collection* collection, uint16_t index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
+    static void RecreateInstance(Collection* collection, InstanceIndex index, Prototype* old_proto, Prototype* new_proto, const char* new_proto_name) {
         HInstance instance = collection->m_Instances[index];
         // We don't support recreating instances that are 'transitioning'
         assert(instance->m_ToBeAdded == 0);
         assert(instance->m_ToBeDeleted == 0);
-        HInstance new_instance = AllocInstance(new_proto, new_proto_name);
+        HInstance new_instance = AllocInstance(collection, new_proto, new_proto_name);
         if (!new_instance) {
             return;
         }
@@ -3421,7 +3787,7 @@ namespace dmGameObject
         bool res = CreateComponents(hcollection, new_instance);
         if (!res) {
             dmHashRelease64(&new_instance->m_CollectionPathHashState);
-            DeallocInstance(new_instance);
+            DeallocInstance(collection, new_instance);
             return;
         }
         if (instance->m_Initialized) {
@@ -3447,7 +3813,7 @@ namespace dmGameObject
                 break;
             }
         }
-        DeallocInstance(instance);
+        DeallocInstance(collection, instance);
         DoAddToUpdate(collection, new_instance);
     }
 
@@ -3456,11 +3822,11 @@ namespace dmGameObject
         Collection* collection = (Collection*) params.m_UserData;
         for (uint32_t level_i = 0; level_i < MAX_HIERARCHICAL_DEPTH; ++level_i)
         {
-            dmArray<uint16_t>& level = collection->m_LevelIndices[level_i];
+            dmArray<InstanceIndex>& level = collection->m_LevelIndices[level_i];
             uint32_t instance_count = level.Size();
             for (uint32_t i = 0; i < instance_count; ++i)
             {
-                uint16_t index = level[i];
+                InstanceIndex index = level[i];
                 Instance* instance = collection->m_Instances[index];
                 if (instance->m_Prototype == params.m_Resource->m_Resource) {
                     RecreateInstance(collection, index, (Prototype*)params.m_Resource->m_PrevResource, (Prototype*)params.m_Resource->m_Resource, params.m_Name);
@@ -3503,7 +3869,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToAddHead;
+        InstanceIndex index = collection->m_InstancesToAddHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToAdd;
             ++count;
@@ -3515,7 +3881,7 @@ namespace dmGameObject
     {
         Collection* collection = hcollection->m_Collection;
         uint32_t count = 0;
-        uint16_t index = collection->m_InstancesToDeleteHead;
+        InstanceIndex index = collection->m_InstancesToDeleteHead;
         while (index != INVALID_INSTANCE_INDEX) {
             index = collection->m_Instances[index]->m_NextToDelete;
             ++count;
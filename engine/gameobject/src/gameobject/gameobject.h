@@ -19,6 +19,7 @@
 #include <dlib/easing.h>
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
+#include <dlib/job_system.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
 
@@ -103,6 +104,22 @@ namespace dmGameObject
         UPDATE_RESULT_UNKNOWN_ERROR = -1000,//!< UPDATE_RESULT_UNKNOWN_ERROR
     };
 
+    /**
+     * Declares what state a component type update function reads and writes besides its own world.
+     * Component types that declare their access may be updated concurrently with other
+     * component types they do not conflict with. Types that conflict are updated in
+     * update order, with messages dispatched in between, as before.
+     */
+    enum UpdateAccess
+    {
+        UPDATE_ACCESS_READ_TRANSFORMS   = 1 << 0,   //!< Reads game object world transforms
+        UPDATE_ACCESS_WRITE_TRANSFORMS  = 1 << 1,   //!< Modifies game object transforms (e.g. bones)
+        UPDATE_ACCESS_READ_MESSAGES     = 1 << 2,   //!< Depends on messages posted earlier in the same update being dispatched
+        UPDATE_ACCESS_WRITE_MESSAGES    = 1 << 3,   //!< Posts messages
+        UPDATE_ACCESS_OTHER_WORLDS      = 1 << 4,   //!< Accesses other worlds or shared systems (scripts, resources, render, sound)
+        UPDATE_ACCESS_EXCLUSIVE         = 1 << 5,   //!< Access not declared, the update is never run concurrently (default)
+    };
+
     /**
      * Input result enum
      */
@@ -684,8 +701,13 @@ namespace dmGameObject
         ComponentSetProperty    m_SetPropertyFunction;
         uint32_t                m_InstanceHasUserData : 1;
         uint32_t                m_ReadsTransforms : 1;
-        uint32_t                m_Reserved : 30;
+        /// Set if the update function may run on a worker thread, concurrently with the other types of its update stage.
+        /// Default is 0, the update function always runs on the updating thread.
+        uint32_t                m_ThreadSafeUpdate : 1;
+        uint32_t                m_Reserved : 29;
         uint16_t                m_UpdateOrderPrio;
+        /// Bit field of UpdateAccess flags, see UpdateAccess. Default is UPDATE_ACCESS_EXCLUSIVE.
+        uint32_t                m_UpdateAccess;
     };
 
     /**
@@ -704,7 +726,7 @@ namespace dmGameObject
     /**
      * Set default capacity of collections in this register. This does not affect existing collections.
      * @param regist Register
-     * @param capacity Default capacity of collections in this register (0-32766).
+     * @param capacity Default capacity of collections in this register (0-2147483646, or 0-32766 when built with DM_GAMEOBJECT_NARROW_INSTANCE_INDICES).
      * @return RESULT_OK on success or RESULT_INVALID_OPERATION if max_count is not within range
      */
     Result SetCollectionDefaultCapacity(HRegister regist, uint32_t capacity);
@@ -722,6 +744,15 @@ namespace dmGameObject
      */
     void DeleteRegister(HRegister regist);
 
+    /**
+     * Set the job system used to update the component types of an update stage concurrently.
+     * Only types with m_ThreadSafeUpdate set are updated as jobs, the other types of the stage are
+     * updated on the calling thread. Without a job system (default) the component types are updated one by one.
+     * @param regist Register
+     * @param job_system Job system, or 0x0 to update sequentially
+     */
+    void SetJobSystem(HRegister regist, dmJobSystem::HContext job_system);
+
     /**
      * Creates a new gameobject collection
      * @param name Collection name, which must be unique and follow the same naming as for sockets
@@ -773,7 +804,7 @@ namespace dmGameObject
     Result SetUpdateOrderPrio(HRegister regist, dmResource::ResourceType resource_type, uint16_t prio);
 
     /**
-     * Sort component types according to update order priority.
+     * Sort component types according to update order priority and rebuild the update schedule.
      * @param regist Register
      */
     void SortComponentTypes(HRegister regist);
@@ -829,6 +860,27 @@ namespace dmGameObject
      */
     HInstance Spawn(HCollection collection, HPrototype prototype, const char* prototype_name, dmhash_t id, uint8_t* property_buffer, uint32_t property_buffer_size, const Point3& position, const Quat& rotation, const Vector3& scale);
 
+    /**
+     * Spawns a number of gameobject instances of the same prototype. Equivalent to calling Spawn for each
+     * instance, but the components are created one component type at a time over all the instances,
+     * and the instance memory is taken from the collection instance pool up front.
+     * The same property buffer is applied to all instances.
+     * @param collection Gameobject collection
+     * @param prototype Prototype to spawn from
+     * @param prototype_name Prototype file name
+     * @param ids Ids of the spawned instances, count entries
+     * @param property_buffer Buffer with serialized properties
+     * @param property_buffer_size Size of property buffer
+     * @param positions Positions of the spawned objects, count entries
+     * @param rotations Rotations of the spawned objects, count entries
+     * @param scales Scales of the spawned objects, count entries
+     * @param count Number of instances to spawn
+     * @param out_instances Spawned instances, count entries. Set to 0 for instances that failed to spawn
+     * @return the number of spawned instances
+     */
+    uint32_t SpawnBatch(HCollection collection, HPrototype prototype, const char* prototype_name, const dmhash_t* ids, uint8_t* property_buffer, uint32_t property_buffer_size,
+                        const Point3* positions, const Quat* rotations, const Vector3* scales, uint32_t count, HInstance* out_instances);
+
     struct InstancePropertyBuffer
     {
         uint8_t *property_buffer;
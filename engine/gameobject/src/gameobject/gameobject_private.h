@@ -16,6 +16,7 @@
 #include <dlib/hash.h>
 #include <dlib/hashtable.h>
 #include <dlib/index_pool.h>
+#include <dlib/job_system.h>
 #include <dlib/math.h>
 #include <dlib/mutex.h>
 #include <dlib/transform.h>
@@ -82,8 +83,19 @@ namespace dmGameObject
         dmArray<void*> m_PropertyResources;
     };
 
+#if defined(DM_GAMEOBJECT_NARROW_INSTANCE_INDICES)
+    // Compact 16 bit instance indices, for memory constrained builds
+    typedef uint16_t      InstanceIndex;
+    typedef dmIndexPool16 InstanceIndexPool;
     // Invalid instance index. Implies that maximum number of instances is 32766 (ie 0x7fff - 1)
     const uint32_t INVALID_INSTANCE_INDEX = 0x7fff;
+#else
+    // Instance indices, into Collection::m_Instances
+    typedef uint32_t      InstanceIndex;
+    typedef dmIndexPool32 InstanceIndexPool;
+    // Invalid instance index. Implies that maximum number of instances is 0x7fffffff - 1
+    const uint32_t INVALID_INSTANCE_INDEX = 0x7fffffff;
+#endif
 
     // NOTE: Actual size of Instance is sizeof(Instance) + sizeof(uintptr_t) * m_UserDataCount
     struct Instance
@@ -118,23 +130,32 @@ namespace dmGameObject
         {
         }
 
+        // NOTE: The transform, the euler rotations and the parent index are kept together at the start,
+        // so that UpdateTransforms only touches the first two cache lines of each instance
+
         dmTransform::Transform m_Transform;
 
         // Shadowed rotation expressed in euler coordinates
         Vector3 m_EulerRotation;
         // Previous euler rotation, used to detect if the euler rotation has changed and should overwrite the real rotation (needed by animation)
         Vector3 m_PrevEulerRotation;
-        // Collection this instances belongs to. Added for GetWorldPosition.
-        // We should consider to remove this (memory footprint)
-        struct Collection* m_Collection;
-        Prototype*      m_Prototype;
 
-        uint32_t        m_IdentifierIndex;
-        dmhash_t        m_Identifier;
-
-        // Collection path hash-state. Used for calculating global identifiers. Contains the hash-state for the collection-path to the instance.
-        // We might, in the future, for memory reasons, move this hash-state to a data-structure shared among all instances from the same collection.
-        HashState64     m_CollectionPathHashState;
+        // Index to parent
+        InstanceIndex   m_Parent;
+        // Index to Collection::m_Instances
+        InstanceIndex   m_Index;
+        // Index to Collection::m_LevelIndex. Index is relative to current level (m_Depth), eg first object in level L always has level-index 0
+        // Level-index is used to reorder Collection::m_LevelIndex entries in O(1). Given an instance we need to find where the
+        // instance index is located in Collection::m_LevelIndex
+        InstanceIndex   m_LevelIndex;
+        // Next sibling index. Index to Collection::m_Instances
+        InstanceIndex   m_SiblingIndex;
+        // First child index. Index to Collection::m_Instances
+        InstanceIndex   m_FirstChildIndex;
+        // Index to next instance to delete or INVALID_INSTANCE_INDEX
+        InstanceIndex   m_NextToDelete;
+        // Index to next instance to add-to-update or INVALID_INSTANCE_INDEX
+        InstanceIndex   m_NextToAdd;
 
         // Hierarchical depth
         uint16_t        m_Depth : 8;
@@ -146,22 +167,12 @@ namespace dmGameObject
         uint16_t        m_Bone : 1;
         // If this is a generated instance, i.e. if the instance id is uniquely generated
         uint16_t        m_Generated : 1;
-        // Padding
-        uint16_t        m_Pad : 4;
-
-        // Index to parent
-        uint16_t        m_Parent : 16;
-
-        // Index to Collection::m_Instances
-        uint16_t        m_Index : 15;
         // Used for deferred deletion
         uint16_t        m_ToBeDeleted : 1;
-
-        // Index to Collection::m_LevelIndex. Index is relative to current level (m_Depth), eg first object in level L always has level-index 0
-        // Level-index is used to reorder Collection::m_LevelIndex entries in O(1). Given an instance we need to find where the
-        // instance index is located in Collection::m_LevelIndex
-        uint16_t        m_LevelIndex : 15;
-        uint16_t        m_Pad2 : 1;
+        // Used for deferred add-to-update
+        uint16_t        m_ToBeAdded : 1;
+        // Padding
+        uint16_t        m_Pad : 2;
 
 #ifdef __EMSCRIPTEN__
         // TODO: FIX!! Workaround for LLVM/Clang bug when compiling with any optimization level > 0.
@@ -176,19 +187,17 @@ namespace dmGameObject
         float m_llvm_pad;
 #endif
 
-        // Index to next instance to delete or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToDelete : 16;
-
-        // Index to next instance to add-to-update or INVALID_INSTANCE_INDEX
-        uint16_t        m_NextToAdd;
+        // Collection this instances belongs to. Added for GetWorldPosition.
+        // We should consider to remove this (memory footprint)
+        struct Collection* m_Collection;
+        Prototype*      m_Prototype;
 
-        // Next sibling index. Index to Collection::m_Instances
-        uint16_t        m_SiblingIndex : 15;
-        uint16_t        m_ToBeAdded : 1;
+        uint32_t        m_IdentifierIndex;
+        dmhash_t        m_Identifier;
 
-        // First child index. Index to Collection::m_Instances
-        uint16_t        m_FirstChildIndex : 15;
-        uint16_t        m_Pad4 : 1;
+        // Collection path hash-state. Used for calculating global identifiers. Contains the hash-state for the collection-path to the instance.
+        // We might, in the future, for memory reasons, move this hash-state to a data-structure shared among all instances from the same collection.
+        HashState64     m_CollectionPathHashState;
 
         uint32_t        m_ComponentInstanceUserDataCount;
         uintptr_t       m_ComponentInstanceUserData[0];
@@ -204,6 +213,14 @@ namespace dmGameObject
         ComponentType               m_ComponentTypes[MAX_COMPONENT_TYPES];
         uint16_t                    m_ComponentTypesOrder[MAX_COMPONENT_TYPES];
         uint32_t                    m_ComponentProfileCounterIndex[MAX_COMPONENT_TYPES];
+        // Update schedule, built from m_ComponentTypesOrder and the declared UpdateAccess of the types with an update function.
+        // Stage i holds the types m_UpdateStageTypes[m_UpdateStageOffsets[i]] .. m_UpdateStageTypes[m_UpdateStageOffsets[i+1]-1]
+        // which do not conflict with each other and may be updated concurrently.
+        uint16_t                    m_UpdateStageTypes[MAX_COMPONENT_TYPES];
+        uint16_t                    m_UpdateStageOffsets[MAX_COMPONENT_TYPES + 1];
+        uint32_t                    m_UpdateStageCount;
+        // Used to update the types within a stage concurrently, optional
+        dmJobSystem::HContext       m_JobSystem;
         dmMutex::HMutex             m_Mutex;
 
         // All collections. Protected by m_Mutex
@@ -221,6 +238,20 @@ namespace dmGameObject
     // depth is interpreted as up to <depth> levels of child nodes including root-nodes
     // Must be greater than zero
     const uint32_t MAX_HIERARCHICAL_DEPTH = 128;
+    // Number of instances allocated at a time by the InstancePool
+    const uint32_t INSTANCE_POOL_SLAB_SIZE = 32;
+
+    // Slab pool for instance memory. The size of an instance depends on the number of
+    // component user data slots, so there is one free list per slot count.
+    // Freed instances are kept in the free lists until the collection is deleted.
+    struct InstancePool
+    {
+        // Free list heads, indexed by component user data count. The first word of a free block links to the next
+        dmArray<void*> m_FreeLists;
+        // Allocated slabs
+        dmArray<void*> m_Slabs;
+    };
+
     struct Collection
     {
         Collection(dmResource::HFactory factory, HRegister regist, uint32_t max_instances);
@@ -248,7 +279,10 @@ namespace dmGameObject
         dmArray<Instance*>       m_Instances;
 
         // Index pool for mapping Instance::m_Index to m_Instances
-        dmIndexPool16            m_InstanceIndices;
+        InstanceIndexPool        m_InstanceIndices;
+
+        // Memory for the instances
+        InstancePool             m_InstancePool;
 
         // Resources referenced through property overrides inside the collection
         dmArray<void*>         m_PropertyResources;
@@ -258,7 +292,7 @@ namespace dmGameObject
         // Two dimensional table of indices with stride "max_instances"
         // Level 0 contains root-nodes in [0..m_LevelIndices[0].Size()-1]
         // Level 1 contains level 1 indices in [0..m_LevelIndices[1].Size()-1]
-        dmArray<uint16_t>        m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
+        dmArray<InstanceIndex>   m_LevelIndices[MAX_HIERARCHICAL_DEPTH];
 
         // Array of world transforms. Calculated using m_LevelIndices above
         dmArray<Matrix4>         m_WorldTransforms;
@@ -285,14 +319,14 @@ namespace dmGameObject
         dmIndexPool32            m_InstanceIdPool;
 
         // Head of linked list of instances scheduled for deferred deletion
-        uint16_t                 m_InstancesToDeleteHead;
+        InstanceIndex            m_InstancesToDeleteHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToDeleteTail;
+        InstanceIndex            m_InstancesToDeleteTail;
 
         // Head of linked list of instances scheduled to be added to update
-        uint16_t                 m_InstancesToAddHead;
+        InstanceIndex            m_InstancesToAddHead;
         // Tail of the same list, for O(1) appending
-        uint16_t                 m_InstancesToAddTail;
+        InstanceIndex            m_InstancesToAddTail;
 
         // Set to 1 if in update-loop
         uint32_t                 m_InUpdate : 1;
@@ -15,8 +15,10 @@
 
 #include <map>
 
+#include <dlib/atomic.h>
 #include <dlib/dstrings.h>
 #include <dlib/hash.h>
+#include <dlib/thread.h>
 
 #include <resource/resource.h>
 
@@ -31,6 +33,9 @@ protected:
     virtual void SetUp()
     {
         m_UpdateCount = 0;
+        m_ThreadSafeUpdateCount = 0;
+        m_UpdatingThread = dmThread::GetCurrentThread();
+        m_WrongThreadCount = 0;
         m_UpdateContext.m_DT = 1.0f / 60.0f;
 
         dmResource::NewFactoryParams params;
@@ -169,6 +174,11 @@ public:
 
     std::map<uint64_t, int>      m_ComponentUserDataAcc;
 
+    // Written by the thread safe updates, which may run on the workers
+    int32_atomic_t               m_ThreadSafeUpdateCount;
+    dmThread::Thread             m_UpdatingThread;
+    uint32_t                     m_WrongThreadCount;
+
     dmScript::HContext m_ScriptContext;
     dmGameObject::UpdateContext m_UpdateContext;
     dmGameObject::HRegister m_Register;
@@ -302,6 +312,23 @@ dmGameObject::ComponentDestroy ComponentTest::CComponentDestroy         = Generi
 dmGameObject::ComponentAddToUpdate ComponentTest::CComponentAddToUpdate = GenericComponentAddToUpdate<TestGameObjectDDF::CResource>;
 dmGameObject::ComponentsUpdate ComponentTest::CComponentsUpdate         = GenericComponentsUpdate<TestGameObjectDDF::CResource>;
 
+// Only touches the atomic counter, safe to run on any thread
+static dmGameObject::UpdateResult ThreadSafeComponentsUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
+{
+    ComponentTest* game_object_test = (ComponentTest*) params.m_Context;
+    dmAtomicIncrement32(&game_object_test->m_ThreadSafeUpdateCount);
+    return dmGameObject::UPDATE_RESULT_OK;
+}
+
+// Must be called on the updating thread since it writes the (non atomic) test maps
+static dmGameObject::UpdateResult UpdatingThreadComponentsUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
+{
+    ComponentTest* game_object_test = (ComponentTest*) params.m_Context;
+    if (dmThread::GetCurrentThread() != game_object_test->m_UpdatingThread)
+        game_object_test->m_WrongThreadCount++;
+    return GenericComponentsUpdate<TestGameObjectDDF::CResource>(params, update_result);
+}
+
 TEST_F(ComponentTest, TestUpdate)
 {
     dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/go1.goc");
@@ -413,6 +440,127 @@ TEST_F(ComponentTest, TestUpdateOrder)
     dmGameObject::Delete(m_Collection, go, false);
 }
 
+static dmGameObject::ComponentType* GetComponentTypeByName(dmGameObject::HRegister regist, const char* name)
+{
+    for (uint32_t i = 0; i < regist->m_ComponentTypeCount; ++i)
+    {
+        if (strcmp(regist->m_ComponentTypes[i].m_Name, name) == 0)
+            return &regist->m_ComponentTypes[i];
+    }
+    return 0x0;
+}
+
+TEST_F(ComponentTest, TestUpdateSchedule)
+{
+    // Undeclared types get a stage each (a, b, c + scriptc and animc)
+    ASSERT_EQ(5u, m_Register->m_UpdateStageCount);
+
+    // c and b only read transforms and may share a stage, a writes them and must be updated after
+    GetComponentTypeByName(m_Register, "a")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_WRITE_TRANSFORMS;
+    GetComponentTypeByName(m_Register, "b")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS;
+    GetComponentTypeByName(m_Register, "c")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS;
+    dmGameObject::SortComponentTypes(m_Register);
+
+    ASSERT_EQ(4u, m_Register->m_UpdateStageCount);
+    ASSERT_EQ(0u, m_Register->m_UpdateStageOffsets[0]);
+    ASSERT_EQ(2u, m_Register->m_UpdateStageOffsets[1]);
+    ASSERT_STREQ("c", m_Register->m_ComponentTypes[m_Register->m_UpdateStageTypes[0]].m_Name);
+    ASSERT_STREQ("b", m_Register->m_ComponentTypes[m_Register->m_UpdateStageTypes[1]].m_Name);
+    ASSERT_STREQ("a", m_Register->m_ComponentTypes[m_Register->m_UpdateStageTypes[2]].m_Name);
+
+    // The update order is kept
+    dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/go1.goc");
+    ASSERT_NE((void*) 0, (void*) go);
+    bool ret = dmGameObject::Update(m_Collection, &m_UpdateContext);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ((uint32_t) 2, m_ComponentUpdateOrderMap[TestGameObjectDDF::AResource::m_DDFHash]);
+    ASSERT_EQ((uint32_t) 1, m_ComponentUpdateOrderMap[TestGameObjectDDF::BResource::m_DDFHash]);
+    ASSERT_EQ((uint32_t) 0, m_ComponentUpdateOrderMap[TestGameObjectDDF::CResource::m_DDFHash]);
+    dmGameObject::Delete(m_Collection, go, false);
+
+    // c and b both post messages and are kept in order to keep the message order, a conflicts with neither
+    GetComponentTypeByName(m_Register, "b")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_WRITE_MESSAGES;
+    GetComponentTypeByName(m_Register, "c")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_WRITE_MESSAGES;
+    dmGameObject::SortComponentTypes(m_Register);
+    ASSERT_EQ(4u, m_Register->m_UpdateStageCount);
+    ASSERT_EQ(2u, m_Register->m_UpdateStageOffsets[1]);
+    ASSERT_STREQ("c", m_Register->m_ComponentTypes[m_Register->m_UpdateStageTypes[0]].m_Name);
+    ASSERT_STREQ("a", m_Register->m_ComponentTypes[m_Register->m_UpdateStageTypes[1]].m_Name);
+    ASSERT_STREQ("b", m_Register->m_ComponentTypes[m_Register->m_UpdateStageTypes[2]].m_Name);
+}
+
+TEST_F(ComponentTest, TestUpdateScheduleJobSystem)
+{
+    GetComponentTypeByName(m_Register, "a")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_WRITE_TRANSFORMS;
+    GetComponentTypeByName(m_Register, "b")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS;
+    GetComponentTypeByName(m_Register, "c")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS;
+    dmGameObject::SortComponentTypes(m_Register);
+
+    // No workers, the stage jobs are run by the updating thread which keeps the counters below safe
+    dmJobSystem::NewContextParams params;
+    params.m_WorkerCount = 0;
+    dmJobSystem::HContext job_system = dmJobSystem::New(params);
+    dmGameObject::SetJobSystem(m_Register, job_system);
+
+    dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/go1.goc");
+    ASSERT_NE((void*) 0, (void*) go);
+    bool ret = dmGameObject::Update(m_Collection, &m_UpdateContext);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ((uint32_t) 1, m_ComponentUpdateCountMap[TestGameObjectDDF::AResource::m_DDFHash]);
+    ASSERT_EQ((uint32_t) 1, m_ComponentUpdateCountMap[TestGameObjectDDF::BResource::m_DDFHash]);
+    ASSERT_EQ((uint32_t) 1, m_ComponentUpdateCountMap[TestGameObjectDDF::CResource::m_DDFHash]);
+    // a is in a later stage than b and c
+    ASSERT_EQ((uint32_t) 2, m_ComponentUpdateOrderMap[TestGameObjectDDF::AResource::m_DDFHash]);
+    dmGameObject::Delete(m_Collection, go, false);
+
+    dmGameObject::SetJobSystem(m_Register, 0);
+    dmJobSystem::Delete(job_system);
+}
+
+TEST_F(ComponentTest, TestUpdateScheduleJobSystemWorkers)
+{
+    GetComponentTypeByName(m_Register, "a")->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_WRITE_TRANSFORMS;
+    dmGameObject::ComponentType* b_type = GetComponentTypeByName(m_Register, "b");
+    b_type->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS;
+    b_type->m_UpdateFunction = ThreadSafeComponentsUpdate;
+    b_type->m_ThreadSafeUpdate = 1;
+    dmGameObject::ComponentType* c_type = GetComponentTypeByName(m_Register, "c");
+    c_type->m_UpdateAccess = dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS;
+    c_type->m_UpdateFunction = UpdatingThreadComponentsUpdate;
+    dmGameObject::SortComponentTypes(m_Register);
+    // b and c share the first stage, but only b is allowed on the workers
+    ASSERT_EQ(2u, m_Register->m_UpdateStageOffsets[1]);
+
+    dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/go1.goc");
+    ASSERT_NE((void*) 0, (void*) go);
+
+    const uint32_t worker_counts[] = {1, 4};
+    const uint32_t update_count = 100;
+    for (uint32_t w = 0; w < sizeof(worker_counts) / sizeof(worker_counts[0]); ++w)
+    {
+        dmJobSystem::NewContextParams params;
+        params.m_WorkerCount = worker_counts[w];
+        dmJobSystem::HContext job_system = dmJobSystem::New(params);
+        dmGameObject::SetJobSystem(m_Register, job_system);
+
+        m_ThreadSafeUpdateCount = 0;
+        m_ComponentUpdateCountMap.clear();
+        for (uint32_t i = 0; i < update_count; ++i)
+        {
+            ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        }
+        ASSERT_EQ((int32_t) update_count, m_ThreadSafeUpdateCount);
+        ASSERT_EQ(update_count, m_ComponentUpdateCountMap[TestGameObjectDDF::AResource::m_DDFHash]);
+        ASSERT_EQ(update_count, m_ComponentUpdateCountMap[TestGameObjectDDF::CResource::m_DDFHash]);
+        ASSERT_EQ(0u, m_WrongThreadCount);
+
+        dmGameObject::SetJobSystem(m_Register, 0);
+        dmJobSystem::Delete(job_system);
+    }
+
+    dmGameObject::Delete(m_Collection, go, false);
+}
+
 TEST_F(ComponentTest, TestDuplicatedIds)
 {
     dmGameObject::HInstance go = dmGameObject::New(m_Collection, "/go6.goc");
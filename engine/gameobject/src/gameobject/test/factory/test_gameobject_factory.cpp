@@ -257,6 +257,106 @@ TEST_F(FactoryTest, FactoryCreateCallback)
     ASSERT_NE((void*)0, instance);
 }
 
+static uint32_t SpawnBatch(dmResource::HFactory factory, dmGameObject::HCollection collection, const char* prototype_name, const dmhash_t* ids, uint8_t* property_buffer, uint32_t property_buffer_size,
+                           const Point3* positions, const Quat* rotations, const Vector3* scales, uint32_t count, dmGameObject::HInstance* out_instances)
+{
+    dmGameObject::HPrototype prototype = 0x0;
+    if (dmResource::Get(factory, prototype_name, (void**)&prototype) == dmResource::RESULT_OK) {
+        uint32_t result = dmGameObject::SpawnBatch(collection, prototype, prototype_name, ids, property_buffer, property_buffer_size, positions, rotations, scales, count, out_instances);
+        dmResource::Release(factory, prototype);
+        return result;
+    }
+    return 0;
+}
+
+TEST_F(FactoryTest, FactoryBatch)
+{
+    const uint32_t count = 100;
+    dmhash_t ids[count];
+    Point3 positions[count];
+    Quat rotations[count];
+    Vector3 scales[count];
+    dmGameObject::HInstance instances[count];
+
+    // Spawn twice, deleting in between, so that the second batch reuses pooled instance memory
+    for (int iter = 0; iter < 2; ++iter)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ids[i] = dmGameObject::ConstructInstanceId(dmGameObject::AcquireInstanceIndex(m_Collection));
+            positions[i] = Point3((float)i, 0.0f, 0.0f);
+            rotations[i] = Quat::identity();
+            scales[i] = Vector3(1, 1, 1);
+        }
+
+        uint32_t spawned = SpawnBatch(m_Factory, m_Collection, "/test.goc", ids, 0x0, 0, positions, rotations, scales, count, instances);
+        ASSERT_EQ(count, spawned);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ASSERT_NE((void*)0, instances[i]);
+            ASSERT_EQ(ids[i], dmGameObject::GetIdentifier(instances[i]));
+            ASSERT_EQ(instances[i], dmGameObject::GetInstanceFromIdentifier(m_Collection, ids[i]));
+            ASSERT_EQ((float)i, dmGameObject::GetPosition(instances[i]).getX());
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            dmGameObject::Delete(m_Collection, instances[i], false);
+        }
+        dmGameObject::PostUpdate(m_Collection);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ASSERT_EQ((void*)0, dmGameObject::GetInstanceFromIdentifier(m_Collection, ids[i]));
+        }
+    }
+}
+
+TEST_F(FactoryTest, FactoryBatchProperties)
+{
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+    lua_newtable(L);
+    lua_pushliteral(L, "number");
+    lua_pushnumber(L, 3);
+    lua_rawset(L, -3);
+    char buffer[256];
+    uint32_t buffer_size = dmScript::CheckTable(L, buffer, 256, -1);
+    lua_pop(L, 1);
+
+    const uint32_t count = 4;
+    dmhash_t ids[count];
+    Point3 positions[count];
+    Quat rotations[count];
+    Vector3 scales[count];
+    dmGameObject::HInstance instances[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ids[i] = dmGameObject::ConstructInstanceId(dmGameObject::AcquireInstanceIndex(m_Collection));
+        positions[i] = Point3();
+        rotations[i] = Quat::identity();
+        scales[i] = Vector3(2, 2, 2);
+    }
+    ASSERT_EQ(count, SpawnBatch(m_Factory, m_Collection, "/test_props.goc", ids, (unsigned char*)buffer, buffer_size, positions, rotations, scales, count, instances));
+}
+
+TEST_F(FactoryTest, FactoryBatchPartialFailure)
+{
+    // The component in test_create.goc only accepts /instance0 at x == 2
+    const uint32_t count = 3;
+    dmhash_t ids[count] = { dmHashString64("/instance1"), dmHashString64("/instance0"), dmHashString64("/instance2") };
+    Point3 positions[count] = { Point3(2.0f, 0.0f, 0.0f), Point3(2.0f, 0.0f, 0.0f), Point3(2.0f, 0.0f, 0.0f) };
+    Quat rotations[count] = { Quat::identity(), Quat::identity(), Quat::identity() };
+    Vector3 scales[count] = { Vector3(1, 1, 1), Vector3(1, 1, 1), Vector3(1, 1, 1) };
+    dmGameObject::HInstance instances[count];
+
+    ASSERT_EQ(1u, SpawnBatch(m_Factory, m_Collection, "/test_create.goc", ids, 0x0, 0, positions, rotations, scales, count, instances));
+    ASSERT_EQ((void*)0, instances[0]);
+    ASSERT_NE((void*)0, instances[1]);
+    ASSERT_EQ((void*)0, instances[2]);
+    ASSERT_EQ(instances[1], dmGameObject::GetInstanceFromIdentifier(m_Collection, ids[1]));
+    ASSERT_EQ((void*)0, dmGameObject::GetInstanceFromIdentifier(m_Collection, ids[0]));
+    ASSERT_EQ((void*)0, dmGameObject::GetInstanceFromIdentifier(m_Collection, ids[2]));
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
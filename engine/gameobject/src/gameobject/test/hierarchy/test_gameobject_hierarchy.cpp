@@ -888,6 +888,86 @@ TEST_F(HierarchyTest, TestEmptyInstance)
     dmGameObject::Delete(m_Collection, go, false);
 }
 
+#if !defined(DM_GAMEOBJECT_NARROW_INSTANCE_INDICES)
+// Builds chains of four instances (root, child, grandchild, great grandchild) in a new collection
+static dmGameObject::HCollection NewChains(dmResource::HFactory factory, dmGameObject::HRegister regist, uint32_t count)
+{
+    dmGameObject::HCollection collection = dmGameObject::NewCollection("chains", factory, regist, count);
+    if (!collection)
+        return 0;
+    dmGameObject::HInstance parent = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmGameObject::HInstance instance = dmGameObject::New(collection, 0x0);
+        if (!instance)
+        {
+            dmGameObject::DeleteCollection(collection);
+            return 0;
+        }
+        dmGameObject::SetPosition(instance, Point3(1.0f, 0.0f, 0.0f));
+        if (i % 4 != 0)
+        {
+            dmGameObject::SetParent(instance, parent);
+        }
+        parent = instance;
+    }
+    return collection;
+}
+
+TEST_F(HierarchyTest, TestWideInstanceIndices)
+{
+    // More instances than fit in 15 bit indices
+    const uint32_t count = 40000;
+    dmGameObject::HCollection collection = NewChains(m_Factory, m_Register, count);
+    ASSERT_NE((void*)0, collection);
+
+    dmGameObject::UpdateTransforms(collection->m_Collection);
+
+    // The last instance is at depth 3, with every ancestor offset by one unit
+    dmGameObject::HInstance last = collection->m_Collection->m_Instances[count - 1];
+    ASSERT_NE((void*)0, last);
+    ASSERT_EQ(3U, dmGameObject::GetDepth(last));
+    ASSERT_NEAR(4.0f, dmGameObject::GetWorldPosition(last).getX(), EPSILON);
+    ASSERT_EQ(count / 4, collection->m_Collection->m_LevelIndices[0].Size());
+    ASSERT_EQ(count / 4, collection->m_Collection->m_LevelIndices[3].Size());
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(m_Register);
+}
+
+static void BenchManyInstances(dmResource::HFactory factory, dmGameObject::HRegister regist, uint32_t count)
+{
+    uint64_t start = dmTime::GetTime();
+    dmGameObject::HCollection collection = NewChains(factory, regist, count);
+    uint64_t created = dmTime::GetTime();
+    ASSERT_NE((void*)0, collection);
+
+    const uint32_t iterations = 10;
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        dmGameObject::UpdateTransforms(collection->m_Collection);
+    }
+    uint64_t updated = dmTime::GetTime();
+
+    dmGameObject::DeleteCollection(collection);
+    dmGameObject::PostUpdate(regist);
+    uint64_t deleted = dmTime::GetTime();
+
+    printf("%u instances: create %.2f ms, UpdateTransforms %.2f ms, delete %.2f ms\n", count,
+           (created - start) / 1000.0f, (updated - created) / (1000.0f * iterations), (deleted - updated) / 1000.0f);
+}
+
+// Disabled by default since it creates a million instances, run it with the test filter
+TEST_F(HierarchyTest, DISABLED_BenchManyInstances)
+{
+    BenchManyInstances(m_Factory, m_Register, 100000);
+    if (sizeof(void*) == 8)
+    {
+        BenchManyInstances(m_Factory, m_Register, 1000000);
+    }
+}
+#endif
+
 #undef EPSILON
 
 int main(int argc, char **argv)
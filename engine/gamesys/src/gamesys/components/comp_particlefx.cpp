@@ -57,11 +57,29 @@ namespace dmGameSystem
         uint16_t m_Padding : 15;
     };
 
+    // Owned by the particle instance, which frees it when the instance is destroyed
+    struct DeferredEmitterStateChangedData
+    {
+        dmParticle::EmitterStateChanged m_StateChangedCallback;
+        EmitterStateChangedScriptData m_ScriptData;
+        ParticleFXWorld* m_World;
+    };
+
+    struct EmitterStateChange
+    {
+        DeferredEmitterStateChangedData* m_Data;
+        dmhash_t m_EmitterId;
+        uint32_t m_NumAwakeEmitters;
+        dmParticle::EmitterState m_State;
+    };
+
     struct ParticleFXWorld
     {
         dmArray<ParticleFXComponent> m_Components;
         dmArray<dmRender::RenderObject> m_RenderObjects;
         dmArray<ParticleFXComponentPrototype> m_Prototypes;
+        // The update may run on a worker thread, so the script callbacks are run from the post update
+        dmArray<EmitterStateChange> m_EmitterStateChanges;
         dmIndexPool32 m_PrototypeIndices;
         ParticleFXContext* m_Context;
         dmParticle::HParticleContext m_ParticleContext;
@@ -87,6 +105,7 @@ namespace dmGameSystem
         world->m_Prototypes.SetCapacity(particle_fx_count);
         world->m_Prototypes.SetSize(particle_fx_count);
         world->m_PrototypeIndices.SetCapacity(particle_fx_count);
+        world->m_EmitterStateChanges.SetCapacity(particle_fx_count);
         uint32_t buffer_size = dmParticle::GetVertexBufferSize(ctx->m_MaxParticleCount, dmParticle::PARTICLE_GO);
         world->m_VertexBuffer = dmGraphics::NewVertexBuffer(dmRender::GetGraphicsContext(ctx->m_RenderContext), buffer_size, 0x0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
         world->m_VertexBufferData.SetCapacity(ctx->m_MaxParticleCount * 6);
@@ -197,8 +216,27 @@ namespace dmGameSystem
             }
         }
 
-        ParticleFXContext* ctx = (ParticleFXContext*)params.m_Context;
         dmParticle::Update(particle_context, params.m_UpdateContext->m_DT, FetchAnimationCallback);
+        return dmGameObject::UPDATE_RESULT_OK;
+    }
+
+    dmGameObject::UpdateResult CompParticleFXPostUpdate(const dmGameObject::ComponentsPostUpdateParams& params)
+    {
+        ParticleFXWorld* w = (ParticleFXWorld*)params.m_World;
+
+        // Run the callbacks before pruning, the instances own the callback data
+        dmArray<EmitterStateChange>& state_changes = w->m_EmitterStateChanges;
+        for (uint32_t i = 0; i < state_changes.Size(); ++i)
+        {
+            EmitterStateChange& change = state_changes[i];
+            change.m_Data->m_StateChangedCallback(change.m_NumAwakeEmitters, change.m_EmitterId, change.m_State, &change.m_Data->m_ScriptData);
+        }
+        state_changes.SetSize(0);
+
+        dmArray<ParticleFXComponent>& components = w->m_Components;
+        dmParticle::HParticleContext particle_context = w->m_ParticleContext;
+        ParticleFXContext* ctx = (ParticleFXContext*)params.m_Context;
+        uint32_t count = components.Size();
 
         // Prune sleeping instances
         uint32_t i = 0;
@@ -334,6 +372,22 @@ namespace dmGameSystem
         return dmGameObject::UPDATE_RESULT_OK;
     }
 
+    static void QueueEmitterStateChanged(uint32_t num_awake_emitters, dmhash_t emitter_id, dmParticle::EmitterState emitter_state, void* user_data)
+    {
+        DeferredEmitterStateChangedData* data = (DeferredEmitterStateChangedData*)user_data;
+        dmArray<EmitterStateChange>& state_changes = data->m_World->m_EmitterStateChanges;
+        if (state_changes.Full())
+        {
+            state_changes.OffsetCapacity(32);
+        }
+        EmitterStateChange change;
+        change.m_Data = data;
+        change.m_EmitterId = emitter_id;
+        change.m_NumAwakeEmitters = num_awake_emitters;
+        change.m_State = emitter_state;
+        state_changes.Push(change);
+    }
+
     static dmParticle::HInstance CreateComponent(ParticleFXWorld* world, dmGameObject::HInstance go_instance, dmhash_t component_id, ParticleFXComponentPrototype* prototype, dmParticle::EmitterStateChangedData* emitter_state_changed_data)
     {
         if (!world->m_Components.Full())
@@ -372,12 +426,16 @@ namespace dmGameSystem
             // dmParticle::CreateInstance can be called from outside this method (when reloading particlefx for example, where we don't care about callbacks)
             // so we want to be able to pass 0x0 in that case. If there is a callback present we will make a shallow copy of the pointers to the callback and userdata,
             // and transfer ownership of that memory to the particle instance.
+            // The callback is wrapped so that the state changes are queued during the update and run from the post update.
             dmParticle::EmitterStateChangedData emitter_state_changed_data;
             if(params.m_Message->m_DataSize == sizeof(dmParticle::EmitterStateChanged) + sizeof(EmitterStateChangedScriptData))
             {
-                emitter_state_changed_data.m_UserData = malloc(sizeof(EmitterStateChangedScriptData));
-                memcpy(&(emitter_state_changed_data.m_StateChangedCallback), (params.m_Message->m_Data), sizeof(dmParticle::EmitterStateChanged));
-                memcpy(emitter_state_changed_data.m_UserData, (params.m_Message->m_Data) + sizeof(dmParticle::EmitterStateChanged), sizeof(EmitterStateChangedScriptData));
+                DeferredEmitterStateChangedData* deferred = (DeferredEmitterStateChangedData*)malloc(sizeof(DeferredEmitterStateChangedData));
+                memcpy(&(deferred->m_StateChangedCallback), (params.m_Message->m_Data), sizeof(dmParticle::EmitterStateChanged));
+                memcpy(&(deferred->m_ScriptData), (params.m_Message->m_Data) + sizeof(dmParticle::EmitterStateChanged), sizeof(EmitterStateChangedScriptData));
+                deferred->m_World = world;
+                emitter_state_changed_data.m_StateChangedCallback = QueueEmitterStateChanged;
+                emitter_state_changed_data.m_UserData = deferred;
             }
 
             dmhash_t component_id = params.m_Message->m_Receiver.m_Fragment;
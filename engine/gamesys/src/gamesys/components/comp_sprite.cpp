@@ -86,10 +86,38 @@ namespace dmGameSystem
         float v;
     };
 
+    // Shared unit quad used by instanced batches. The corner is a one-hot weight
+    // selecting which of the four per-instance texture coordinates to use.
+    struct SpriteQuadVertex
+    {
+        float   x;
+        float   y;
+        uint8_t corner[4];
+    };
+
+    // Per-sprite data for instanced batches. The axes and position are columns 0, 1 and 3 of the world transform.
+    struct SpriteInstance
+    {
+        float axis_x[3];
+        float axis_y[3];
+        float position[3];
+        float uv[8];
+    };
+
+    // Vertex, index or instance ranges reserved for a batch, filled in a separate (possibly concurrent) pass
+    struct SpriteBatch
+    {
+        TextureSetResource*             m_TextureSet;
+        SpriteVertex*                   m_Vertices;
+        uint8_t*                        m_Indices;
+        SpriteInstance*                 m_Instances;
+    };
+
     struct SpriteWorld
     {
         dmObjectPool<SpriteComponent>   m_Components;
         dmArray<dmRender::RenderObject> m_RenderObjects;
+        dmArray<SpriteBatch>            m_Batches;          // One per render object
         dmGraphics::HVertexDeclaration  m_VertexDeclaration;
         dmGraphics::HVertexBuffer       m_VertexBuffer;
         SpriteVertex*                   m_VertexBufferData;
@@ -97,6 +125,17 @@ namespace dmGameSystem
         dmGraphics::HIndexBuffer        m_IndexBuffer;
         uint8_t*                        m_IndexBufferData;
         uint8_t*                        m_IndexBufferWritePtr;
+        // Instanced rendering, used for quad sprites with a material tagged "instanced"
+        dmGraphics::HVertexDeclaration  m_QuadVertexDeclaration;
+        dmGraphics::HVertexBuffer       m_QuadVertexBuffer;
+        dmGraphics::HIndexBuffer        m_QuadIndexBuffer;
+        dmGraphics::HVertexDeclaration  m_InstanceVertexDeclaration;
+        dmGraphics::HVertexBuffer       m_InstanceVertexBuffer;
+        SpriteInstance*                 m_InstanceData;
+        SpriteInstance*                 m_InstanceWritePtr;
+        uint32_t                        m_InstancedTagMask;
+        // Materials with this tag mask are replaced when instancing isn't supported
+        uint32_t                        m_UnsupportedTagMask;
         uint8_t                         m_Is16BitIndex : 1;
         uint8_t                         m_UseGeometries : 1;
         uint8_t                         m_ReallocBuffers : 1;
@@ -105,6 +144,8 @@ namespace dmGameSystem
     DM_GAMESYS_PROP_VECTOR3(SPRITE_PROP_SCALE, scale, false);
     DM_GAMESYS_PROP_VECTOR3(SPRITE_PROP_SIZE, size, true);
 
+    static const char* FALLBACK_MATERIAL = "/builtins/materials/sprite.materialc";
+
     static const dmhash_t SPRITE_PROP_CURSOR = dmHashString64("cursor");
     static const dmhash_t SPRITE_PROP_PLAYBACK_RATE = dmHashString64("playback_rate");
 
@@ -178,6 +219,7 @@ namespace dmGameSystem
         sprite_world->m_Components.SetCapacity(sprite_context->m_MaxSpriteCount);
         memset(sprite_world->m_Components.m_Objects.Begin(), 0, sizeof(SpriteComponent) * sprite_context->m_MaxSpriteCount);
         sprite_world->m_RenderObjects.SetCapacity(sprite_context->m_MaxSpriteCount);
+        sprite_world->m_Batches.SetCapacity(sprite_context->m_MaxSpriteCount);
 
         dmGraphics::VertexElement ve[] =
         {
@@ -195,6 +237,58 @@ namespace dmGameSystem
         sprite_world->m_UseGeometries = 0;
         sprite_world->m_ReallocBuffers = 1;
 
+        sprite_world->m_QuadVertexDeclaration = 0;
+        sprite_world->m_QuadVertexBuffer = 0;
+        sprite_world->m_QuadIndexBuffer = 0;
+        sprite_world->m_InstanceVertexDeclaration = 0;
+        sprite_world->m_InstanceVertexBuffer = 0;
+        sprite_world->m_InstanceData = 0;
+        sprite_world->m_InstanceWritePtr = 0;
+        sprite_world->m_InstancedTagMask = 0;
+        sprite_world->m_UnsupportedTagMask = 0;
+
+        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
+        dmhash_t instanced_tag = dmHashString64("instanced");
+        if (!dmGraphics::IsInstancingSupported(graphics_context))
+        {
+            sprite_world->m_UnsupportedTagMask = dmRender::ConvertMaterialTagsToMask(&instanced_tag, 1);
+        }
+        else
+        {
+            sprite_world->m_InstancedTagMask = dmRender::ConvertMaterialTagsToMask(&instanced_tag, 1);
+
+            dmGraphics::VertexElement quad_ve[] =
+            {
+                    {"position", 0, 2, dmGraphics::TYPE_FLOAT, false},
+                    {"corner", 1, 4, dmGraphics::TYPE_UNSIGNED_BYTE, true},
+            };
+            sprite_world->m_QuadVertexDeclaration = dmGraphics::NewVertexDeclaration(graphics_context, quad_ve, sizeof(quad_ve) / sizeof(dmGraphics::VertexElement));
+
+            dmGraphics::VertexElement instance_ve[] =
+            {
+                    {"instance_axis_x", 0, 3, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_axis_y", 1, 3, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_position", 2, 3, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_texcoord01", 3, 4, dmGraphics::TYPE_FLOAT, false},
+                    {"instance_texcoord23", 4, 4, dmGraphics::TYPE_FLOAT, false},
+            };
+            sprite_world->m_InstanceVertexDeclaration = dmGraphics::NewVertexDeclaration(graphics_context, instance_ve, sizeof(instance_ve) / sizeof(dmGraphics::VertexElement));
+
+            // Same corner order as the quads in CreateVertexData
+            static const SpriteQuadVertex quad[] =
+            {
+                {-0.5f, -0.5f, {255, 0, 0, 0}},
+                {-0.5f,  0.5f, {0, 255, 0, 0}},
+                { 0.5f,  0.5f, {0, 0, 255, 0}},
+                { 0.5f, -0.5f, {0, 0, 0, 255}},
+            };
+            uint16_t quad_indices[6];
+            fillIndices<uint16_t>(quad_indices, 6);
+            sprite_world->m_QuadVertexBuffer = dmGraphics::NewVertexBuffer(graphics_context, sizeof(quad), quad, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+            sprite_world->m_QuadIndexBuffer = dmGraphics::NewIndexBuffer(graphics_context, sizeof(quad_indices), quad_indices, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+            sprite_world->m_InstanceVertexBuffer = dmGraphics::NewVertexBuffer(graphics_context, 0, 0x0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+        }
+
         *params.m_World = sprite_world;
         return dmGameObject::CREATE_RESULT_OK;
     }
@@ -207,6 +301,15 @@ namespace dmGameSystem
         free(sprite_world->m_VertexBufferData);
         dmGraphics::DeleteIndexBuffer(sprite_world->m_IndexBuffer);
         free(sprite_world->m_IndexBufferData);
+        if (sprite_world->m_QuadVertexDeclaration)
+        {
+            dmGraphics::DeleteVertexDeclaration(sprite_world->m_QuadVertexDeclaration);
+            dmGraphics::DeleteVertexDeclaration(sprite_world->m_InstanceVertexDeclaration);
+            dmGraphics::DeleteVertexBuffer(sprite_world->m_QuadVertexBuffer);
+            dmGraphics::DeleteIndexBuffer(sprite_world->m_QuadIndexBuffer);
+            dmGraphics::DeleteVertexBuffer(sprite_world->m_InstanceVertexBuffer);
+        }
+        free(sprite_world->m_InstanceData);
 
         delete sprite_world;
         return dmGameObject::CREATE_RESULT_OK;
@@ -331,6 +434,34 @@ namespace dmGameSystem
         component->m_ReHash = 0;
     }
 
+    // The instanced vertex program doesn't work with per-vertex data. Without instancing, such materials
+    // are replaced with the builtin sprite material, as a material override of the component.
+    static void ReplaceUnsupportedMaterial(SpriteWorld* sprite_world, SpriteComponent* component, dmResource::HFactory factory)
+    {
+        dmRender::HMaterial material = GetMaterial(component, component->m_Resource);
+        if ((dmRender::GetMaterialTagMask(material) & sprite_world->m_UnsupportedTagMask) == 0)
+            return;
+
+        static bool warned = false;
+        if (!warned)
+        {
+            dmLogWarning("Instancing isn't supported by the graphics backend, sprites with an \"instanced\" material use %s instead", FALLBACK_MATERIAL);
+            warned = true;
+        }
+
+        dmRender::HMaterial fallback = 0;
+        if (dmResource::Get(factory, FALLBACK_MATERIAL, (void**)&fallback) != dmResource::RESULT_OK)
+        {
+            dmLogError("Could not load %s", FALLBACK_MATERIAL);
+            return;
+        }
+        if (component->m_Material)
+        {
+            dmResource::Release(factory, component->m_Material);
+        }
+        component->m_Material = fallback;
+    }
+
     dmGameObject::CreateResult CompSpriteCreate(const dmGameObject::ComponentCreateParams& params)
     {
         SpriteWorld* sprite_world = (SpriteWorld*)params.m_World;
@@ -358,6 +489,7 @@ namespace dmGameSystem
         component->m_Size = Vector3(0.0f, 0.0f, 0.0f);
         component->m_AnimationID = 0;
         PlayAnimation(component, resource->m_DefaultAnimation, 0.0f, 1.0f);
+        ReplaceUnsupportedMaterial(sprite_world, component, dmGameObject::GetFactory(params.m_Instance));
 
         TextureSetResource* texture_set = GetTextureSet(component, resource);
 
@@ -546,9 +678,75 @@ namespace dmGameSystem
         *ib_where = indices;
     }
 
-    static void RenderBatch(SpriteWorld* sprite_world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    static void CreateInstanceData(SpriteInstance** instance_where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    {
+        DM_PROFILE(Sprite, "CreateInstanceData");
+
+        static int tex_coord_order[] = {
+            0,1,2,3,
+            3,2,1,0,    //h
+            1,0,3,2,    //v
+            2,3,0,1     //hv
+        };
+
+        dmGameSystemDDF::TextureSetAnimation* animations = texture_set->m_TextureSet->m_Animations.m_Data;
+        const float* tex_coords = (const float*) texture_set->m_TextureSet->m_TexCoords.m_Data;
+
+        SpriteInstance* instance = *instance_where;
+        for (uint32_t *i = begin;i != end; ++i, ++instance)
+        {
+            const SpriteComponent* component = (SpriteComponent*) buf[*i].m_UserData;
+
+            dmGameSystemDDF::TextureSetAnimation* animation_ddf = &animations[component->m_AnimationID];
+
+            uint32_t frame_index = animation_ddf->m_Start + component->m_CurrentAnimationFrame;
+            const float* tc = &tex_coords[frame_index * 4 * 2];
+            uint32_t flip_flag = 0;
+            if (animation_ddf->m_FlipHorizontal ^ component->m_FlipHorizontal)
+            {
+                flip_flag = 1;
+            }
+            if (animation_ddf->m_FlipVertical ^ component->m_FlipVertical)
+            {
+                flip_flag |= 2;
+            }
+
+            const int* tex_lookup = &tex_coord_order[flip_flag * 4];
+            for (uint32_t corner = 0; corner < 4; ++corner)
+            {
+                instance->uv[corner * 2] = tc[tex_lookup[corner] * 2];
+                instance->uv[corner * 2 + 1] = tc[tex_lookup[corner] * 2 + 1];
+            }
+
+            const Matrix4& w = component->m_World;
+            const Vector4 axis_x = w.getCol0();
+            const Vector4 axis_y = w.getCol1();
+            const Vector4 position = w.getCol3();
+            instance->axis_x[0] = axis_x.getX();
+            instance->axis_x[1] = axis_x.getY();
+            instance->axis_x[2] = axis_x.getZ();
+            instance->axis_y[0] = axis_y.getX();
+            instance->axis_y[1] = axis_y.getY();
+            instance->axis_y[2] = axis_y.getZ();
+            instance->position[0] = position.getX();
+            instance->position[1] = position.getY();
+            instance->position[2] = position.getZ();
+        }
+
+        *instance_where = instance;
+    }
+
+    static const dmGameSystemDDF::SpriteGeometry* GetGeometry(const dmGameSystemDDF::TextureSet* texture_set_ddf, const SpriteComponent* component)
+    {
+        const dmGameSystemDDF::TextureSetAnimation* animation_ddf = &texture_set_ddf->m_Animations.m_Data[component->m_AnimationID];
+        uint32_t frame_index = texture_set_ddf->m_FrameIndices.m_Data[animation_ddf->m_Start + component->m_CurrentAnimationFrame];
+        return &texture_set_ddf->m_Geometries.m_Data[frame_index];
+    }
+
+    // Reserves the vertex data of the batch and sets up its render object. The data is written by FillBatch.
+    static void ReserveBatch(SpriteWorld* sprite_world, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
     {
-        DM_PROFILE(Sprite, "RenderBatch");
+        DM_PROFILE(Sprite, "ReserveBatch");
 
         const SpriteComponent* first = (SpriteComponent*) buf[*begin].m_UserData;
         assert(first->m_Enabled);
@@ -560,35 +758,68 @@ namespace dmGameSystem
         dmRender::RenderObject& ro = *sprite_world->m_RenderObjects.End();
         sprite_world->m_RenderObjects.SetSize(sprite_world->m_RenderObjects.Size()+1);
 
-        // Fill in vertex buffer
-        SpriteVertex* vb_begin = sprite_world->m_VertexBufferWritePtr;
-        uint8_t* ib_begin = (uint8_t*)sprite_world->m_IndexBufferWritePtr;
-        SpriteVertex* vb_iter = vb_begin;
-        uint8_t* ib_iter = ib_begin;
-        CreateVertexData(sprite_world, &vb_iter, &ib_iter, texture_set, buf, begin, end);
-
-        sprite_world->m_VertexBufferWritePtr = vb_iter;
-        sprite_world->m_IndexBufferWritePtr = ib_iter;
+        SpriteBatch& batch = *sprite_world->m_Batches.End();
+        sprite_world->m_Batches.SetSize(sprite_world->m_Batches.Size()+1);
+        memset(&batch, 0, sizeof(batch));
+        batch.m_TextureSet = texture_set;
 
         ro.Init();
-        ro.m_VertexDeclaration = sprite_world->m_VertexDeclaration;
-        ro.m_VertexBuffer = sprite_world->m_VertexBuffer;
-        ro.m_IndexBuffer = sprite_world->m_IndexBuffer;
         ro.m_Material = GetMaterial(first, resource);
         ro.m_Textures[0] = texture_set->m_Texture;
         ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
-        ro.m_IndexType = sprite_world->m_Is16BitIndex ? dmGraphics::TYPE_UNSIGNED_SHORT : dmGraphics::TYPE_UNSIGNED_INT;
-
-        // offset in bytes into element buffer
-        uint32_t index_offset = ib_begin - sprite_world->m_IndexBufferData;
 
-        // num elements = Number of bytes / sizeof(index_type)
-        uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
-        uint32_t num_elements = ((uint8_t*)sprite_world->m_IndexBufferWritePtr - (uint8_t*)ib_begin) / index_type_size;
+        uint32_t sprite_count = end - begin;
+        bool instanced = sprite_world->m_InstancedTagMask != 0 && !sprite_world->m_UseGeometries
+                      && (dmRender::GetMaterialTagMask(ro.m_Material) & sprite_world->m_InstancedTagMask) != 0;
+        if (instanced)
+        {
+            // One unit quad, drawn once per sprite
+            batch.m_Instances = sprite_world->m_InstanceWritePtr;
+            sprite_world->m_InstanceWritePtr += sprite_count;
+
+            ro.m_VertexDeclaration = sprite_world->m_QuadVertexDeclaration;
+            ro.m_VertexBuffer = sprite_world->m_QuadVertexBuffer;
+            ro.m_IndexBuffer = sprite_world->m_QuadIndexBuffer;
+            ro.m_IndexType = dmGraphics::TYPE_UNSIGNED_SHORT;
+            ro.m_VertexStart = 0;
+            ro.m_VertexCount = 6;
+            ro.m_InstanceVertexDeclaration = sprite_world->m_InstanceVertexDeclaration;
+            ro.m_InstanceVertexBuffer = sprite_world->m_InstanceVertexBuffer;
+            ro.m_InstanceBufferOffset = (batch.m_Instances - sprite_world->m_InstanceData) * sizeof(SpriteInstance);
+            ro.m_InstanceCount = sprite_count;
+        }
+        else
+        {
+            uint32_t vertex_count = sprite_count * 4;
+            uint32_t index_count = sprite_count * 6;
+            if (sprite_world->m_UseGeometries)
+            {
+                vertex_count = 0;
+                index_count = 0;
+                for (uint32_t* i = begin; i != end; ++i)
+                {
+                    const dmGameSystemDDF::SpriteGeometry* geometry = GetGeometry(texture_set->m_TextureSet, (SpriteComponent*) buf[*i].m_UserData);
+                    vertex_count += geometry->m_Vertices.m_Count / 2;
+                    index_count += geometry->m_Indices.m_Count;
+                }
+            }
 
-        // // These should be named "element" or "index" (as opposed to vertex)
-        ro.m_VertexStart = index_offset;
-        ro.m_VertexCount = num_elements;
+            uint32_t index_type_size = sprite_world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+            batch.m_Vertices = sprite_world->m_VertexBufferWritePtr;
+            batch.m_Indices = sprite_world->m_IndexBufferWritePtr;
+            sprite_world->m_VertexBufferWritePtr += vertex_count;
+            sprite_world->m_IndexBufferWritePtr += index_count * index_type_size;
+
+            ro.m_VertexDeclaration = sprite_world->m_VertexDeclaration;
+            ro.m_VertexBuffer = sprite_world->m_VertexBuffer;
+            ro.m_IndexBuffer = sprite_world->m_IndexBuffer;
+            ro.m_IndexType = sprite_world->m_Is16BitIndex ? dmGraphics::TYPE_UNSIGNED_SHORT : dmGraphics::TYPE_UNSIGNED_INT;
+
+            // These should be named "element" or "index" (as opposed to vertex)
+            // offset in bytes into element buffer
+            ro.m_VertexStart = batch.m_Indices - sprite_world->m_IndexBufferData;
+            ro.m_VertexCount = index_count;
+        }
 
         const dmRender::Constant* constants = first->m_RenderConstants.m_RenderConstants;
         uint32_t size = first->m_RenderConstants.m_ConstantCount;
@@ -624,8 +855,23 @@ namespace dmGameSystem
         }
 
         ro.m_SetBlendFactors = 1;
+    }
 
-        dmRender::AddToRender(render_context, &ro);
+    // Writes the vertex data into the ranges reserved by ReserveBatch. Runs concurrently with other batches.
+    static void FillBatch(SpriteWorld* sprite_world, uint32_t batch_index, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
+    {
+        const SpriteBatch& batch = sprite_world->m_Batches[batch_index];
+        if (batch.m_Instances)
+        {
+            SpriteInstance* instance_iter = batch.m_Instances;
+            CreateInstanceData(&instance_iter, batch.m_TextureSet, buf, begin, end);
+        }
+        else
+        {
+            SpriteVertex* vb_iter = batch.m_Vertices;
+            uint8_t* ib_iter = batch.m_Indices;
+            CreateVertexData(sprite_world, &vb_iter, &ib_iter, batch.m_TextureSet, buf, begin, end);
+        }
     }
 
     static void UpdateTransforms(SpriteWorld* sprite_world, bool sub_pixels)
@@ -849,7 +1095,9 @@ namespace dmGameSystem
             case dmRender::RENDER_LIST_OPERATION_BEGIN:
                 world->m_VertexBufferWritePtr = world->m_VertexBufferData;
                 world->m_IndexBufferWritePtr = world->m_IndexBufferData;
+                world->m_InstanceWritePtr = world->m_InstanceData;
                 world->m_RenderObjects.SetSize(0);
+                world->m_Batches.SetSize(0);
                 break;
             case dmRender::RENDER_LIST_OPERATION_END:
                 dmGraphics::SetVertexBufferData(world->m_VertexBuffer, sizeof(SpriteVertex) * (world->m_VertexBufferWritePtr - world->m_VertexBufferData),
@@ -863,10 +1111,23 @@ namespace dmGameSystem
                     dmGraphics::SetIndexBufferData(world->m_IndexBuffer, index_size, world->m_IndexBufferData, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
                     DM_COUNTER("SpriteIndexBuffer", index_size);
                 }
+
+                if (world->m_InstanceWritePtr != world->m_InstanceData)
+                {
+                    uint32_t instance_size = sizeof(SpriteInstance) * (world->m_InstanceWritePtr - world->m_InstanceData);
+                    dmGraphics::SetVertexBufferData(world->m_InstanceVertexBuffer, instance_size, world->m_InstanceData, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+                    DM_COUNTER("SpriteInstanceBuffer", instance_size);
+                }
+                break;
+            case dmRender::RENDER_LIST_OPERATION_BATCH_RESERVE:
+                ReserveBatch(world, params.m_Buf, params.m_Begin, params.m_End);
+                break;
+            case dmRender::RENDER_LIST_OPERATION_BATCH_FILL:
+                FillBatch(world, params.m_BatchIndex, params.m_Buf, params.m_Begin, params.m_End);
                 break;
             default:
                 assert(params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH);
-                RenderBatch(world, params.m_Context, params.m_Buf, params.m_Begin, params.m_End);
+                dmRender::AddToRender(params.m_Context, &world->m_RenderObjects[params.m_BatchIndex]);
         }
     }
 
@@ -894,9 +1155,14 @@ namespace dmGameSystem
             ReAllocateBuffers(sprite_world, render_context, sprite_context->m_MaxSpriteCount, num_vertices_per_sprite, num_indices_per_sprite);
         }
 
+        if (sprite_world->m_InstancedTagMask != 0 && sprite_world->m_InstanceData == 0)
+        {
+            sprite_world->m_InstanceData = (SpriteInstance*) malloc(sizeof(SpriteInstance) * sprite_context->m_MaxSpriteCount);
+        }
+
         // Submit all sprites as entries in the render list for sorting.
         dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, sprite_count);
-        dmRender::HRenderListDispatch sprite_dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, sprite_world);
+        dmRender::HRenderListDispatch sprite_dispatch = dmRender::RenderListMakeParallelDispatch(render_context, &RenderListDispatch, sprite_world);
         dmRender::RenderListEntry* write_ptr = render_list;
 
         for (uint32_t i = 0; i < sprite_count; ++i)
@@ -1123,7 +1389,12 @@ namespace dmGameSystem
         }
         else if (set_property == PROP_MATERIAL)
         {
-            dmGameObject::PropertyResult res = SetResourceProperty(dmGameObject::GetFactory(params.m_Instance), params.m_Value, MATERIAL_EXT_HASH, (void**)&component->m_Material);
+            dmResource::HFactory factory = dmGameObject::GetFactory(params.m_Instance);
+            dmGameObject::PropertyResult res = SetResourceProperty(factory, params.m_Value, MATERIAL_EXT_HASH, (void**)&component->m_Material);
+            if (res == dmGameObject::PROPERTY_RESULT_OK)
+            {
+                ReplaceUnsupportedMaterial(sprite_world, component, factory);
+            }
             component->m_ReHash |= res == dmGameObject::PROPERTY_RESULT_OK;
             return res;
         }
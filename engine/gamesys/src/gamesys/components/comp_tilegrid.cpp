@@ -50,10 +50,26 @@ namespace dmGameSystem
         uint8_t :6;
     };
 
+    // Vertex data of a layer is kept in its own vertex buffer, in world space. The whole buffer is
+    // rebuilt when the tile grid moves or the tile source changes (m_Dirty), while changed tiles
+    // only rewrite the ranges of their regions (m_RegionsDirty)
     struct TileGridLayer
     {
+        dmGraphics::HVertexBuffer m_VertexBuffer;
         uint8_t m_IsVisible:1;
-        uint8_t :7;
+        uint8_t m_Dirty:1;
+        uint8_t m_RegionsDirty:1;
+        uint8_t :5;
+    };
+
+    // The vertices of one region in a layer, as a range in the layer vertex buffer.
+    // A dirty region is rewritten in place as long as its tiles fit in the range capacity.
+    struct TileGridRegionRange
+    {
+        uint32_t m_VertexStart;
+        uint32_t m_VertexCount;
+        uint32_t m_VertexCapacity:31;
+        uint32_t m_Dirty:1;
     };
 
     struct TileGridComponent
@@ -83,6 +99,7 @@ namespace dmGameSystem
         Flags*                      m_CellFlags;
         dmArray<TileGridRegion>     m_Regions;
         dmArray<TileGridLayer>      m_Layers;
+        dmArray<TileGridRegionRange> m_RegionRanges; // layer_count * region_count
         uint32_t                    m_MixedHash;
         CompRenderConstants         m_RenderConstants;
         dmRender::HMaterial         m_Material;
@@ -113,10 +130,8 @@ namespace dmGameSystem
         dmArray<dmRender::RenderObject> m_RenderObjects;
         dmGraphics::HVertexDeclaration  m_VertexDeclaration;
 
-        dmGraphics::HVertexBuffer       m_VertexBuffer;
-        TileGridVertex*                 m_VertexBufferData;
-        TileGridVertex*                 m_VertexBufferDataEnd;
-        TileGridVertex*                 m_VertexBufferWritePtr;
+        // Scratch memory used when rebuilding the vertex data of a layer or region
+        dmArray<TileGridVertex>         m_VertexBufferData;
 
         uint32_t                        m_MaxTilemapCount;
         uint32_t                        m_MaxTileCount;
@@ -135,10 +150,6 @@ namespace dmGameSystem
                 {"texcoord0", 1, 2, dmGraphics::TYPE_FLOAT, false},
         };
         world->m_VertexDeclaration = dmGraphics::NewVertexDeclaration(graphics_context, ve, sizeof(ve) / sizeof(ve[0]));
-        world->m_VertexBuffer = dmGraphics::NewVertexBuffer(dmRender::GetGraphicsContext(world->m_RenderContext), 0, 0x0, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
-        uint32_t vcount = 6 * world->m_MaxTileCount;
-        world->m_VertexBufferData = (TileGridVertex*) malloc(sizeof(TileGridVertex) * vcount);
-        world->m_VertexBufferDataEnd = world->m_VertexBufferData + vcount;
     }
 
     dmGameObject::CreateResult CompTileGridNewWorld(const dmGameObject::ComponentNewWorldParams& params)
@@ -164,8 +175,6 @@ namespace dmGameSystem
         if (world->m_VertexDeclaration)
         {
             dmGraphics::DeleteVertexDeclaration(world->m_VertexDeclaration);
-            dmGraphics::DeleteVertexBuffer(world->m_VertexBuffer);
-            free(world->m_VertexBufferData);
         }
         delete world;
         return dmGameObject::CREATE_RESULT_OK;
@@ -233,6 +242,34 @@ namespace dmGameSystem
         flags->m_FlipVertical = flip_v;
 
         SetRegionDirty(component, cell_x, cell_y);
+
+        uint32_t region_count = component->m_RegionsX * component->m_RegionsY;
+        uint32_t region_index = (cell_y / TILEGRID_REGION_SIZE) * component->m_RegionsX + cell_x / TILEGRID_REGION_SIZE;
+        component->m_RegionRanges[layer * region_count + region_index].m_Dirty = 1;
+        component->m_Layers[layer].m_RegionsDirty = 1;
+    }
+
+    static void SetLayersDirty(TileGridComponent* component)
+    {
+        uint32_t n_layers = component->m_Layers.Size();
+        for (uint32_t i = 0; i < n_layers; ++i)
+        {
+            component->m_Layers[i].m_Dirty = 1;
+        }
+    }
+
+    static void DeleteLayerBuffers(TileGridComponent* component)
+    {
+        uint32_t n_layers = component->m_Layers.Size();
+        for (uint32_t i = 0; i < n_layers; ++i)
+        {
+            TileGridLayer* layer = &component->m_Layers[i];
+            if (layer->m_VertexBuffer)
+            {
+                dmGraphics::DeleteVertexBuffer(layer->m_VertexBuffer);
+                layer->m_VertexBuffer = 0;
+            }
+        }
     }
 
     uint16_t GetTileCount(const TileGridComponent* component) {
@@ -264,6 +301,11 @@ namespace dmGameSystem
         component->m_Regions.SetCapacity(region_count);
         component->m_Regions.SetSize(region_count);
         memset(&component->m_Regions[0], 0xFF, region_count * sizeof(TileGridRegion)); // mark them all dirty
+
+        uint32_t range_count = region_count * component->m_Layers.Size();
+        component->m_RegionRanges.SetCapacity(range_count);
+        component->m_RegionRanges.SetSize(range_count);
+        memset(&component->m_RegionRanges[0], 0, range_count * sizeof(TileGridRegionRange));
     }
 
     static uint32_t UpdateRegion(TileGridComponent* component, uint32_t region_x, uint32_t region_y)
@@ -349,6 +391,7 @@ namespace dmGameSystem
         uint32_t column_count = resource->m_ColumnCount;
         uint32_t row_count = resource->m_RowCount;
 
+        DeleteLayerBuffers(component);
         component->m_Layers.SetCapacity(n_layers);
         component->m_Layers.SetSize(n_layers);
 
@@ -356,7 +399,10 @@ namespace dmGameSystem
         {
             dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[i];
 
+            component->m_Layers[i].m_VertexBuffer = 0;
             component->m_Layers[i].m_IsVisible = layer_ddf->m_IsVisible;
+            component->m_Layers[i].m_Dirty = 1;
+            component->m_Layers[i].m_RegionsDirty = 0;
 
             uint32_t n_cells = layer_ddf->m_Cell.m_Count;
             for (uint32_t j = 0; j < n_cells; ++j)
@@ -406,16 +452,6 @@ namespace dmGameSystem
         world->m_Components.Push(component);
         *params.m_UserData = (uintptr_t) component;
 
-        uint32_t num_layers = 0;
-        uint32_t n = world->m_Components.Size();
-        for (uint32_t i = 0; i < n; ++i)
-        {
-            TileGridComponent* component = world->m_Components[i];
-            dmGameSystemDDF::TileGrid* tile_grid_ddf = component->m_Resource->m_TileGrid;
-            num_layers += tile_grid_ddf->m_Layers.m_Count;
-        }
-        world->m_RenderObjects.SetCapacity(num_layers);
-
         ReHash(component);
         return dmGameObject::CREATE_RESULT_OK;
     }
@@ -435,6 +471,7 @@ namespace dmGameSystem
                     dmResource::Release(dmGameObject::GetFactory(params.m_Instance), tile_grid->m_TextureSet);
                 }
 
+                DeleteLayerBuffers(tile_grid);
                 delete [] tile_grid->m_Cells;
                 delete [] tile_grid->m_CellFlags;
                 world->m_Components.EraseSwap(i);
@@ -480,13 +517,21 @@ namespace dmGameSystem
 
             Matrix4 local(component->m_Rotation, component->m_Translation);
             const Matrix4& go_world = dmGameObject::GetWorldMatrix(component->m_Instance);
+            Matrix4 world;
             if (dmGameObject::ScaleAlongZ(component->m_Instance))
             {
-                component->m_World = go_world * local;
+                world = go_world * local;
             }
             else
             {
-                component->m_World = dmTransform::MulNoScaleZ(go_world, local);
+                world = dmTransform::MulNoScaleZ(go_world, local);
+            }
+
+            // The cached vertices are in world space
+            if (memcmp(&world, &component->m_World, sizeof(Matrix4)) != 0)
+            {
+                component->m_World = world;
+                SetLayersDirty(component);
             }
         }
         return dmGameObject::UPDATE_RESULT_OK;
@@ -505,9 +550,38 @@ namespace dmGameSystem
         region_y = (ptr >> 48) & 0xFFFF;
     }
 
-    TileGridVertex* CreateVertexData(TileGridWorld* world, TileGridVertex* where, TextureSetResource* texture_set, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    static void GetRegionCellBounds(const TileGridResource* resource, uint32_t region_x, uint32_t region_y, int32_t* min_x, int32_t* min_y, int32_t* max_x, int32_t* max_y)
+    {
+        *min_x = resource->m_MinCellX + region_x * TILEGRID_REGION_SIZE;
+        *min_y = resource->m_MinCellY + region_y * TILEGRID_REGION_SIZE;
+        *max_x = dmMath::Min(*min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)resource->m_ColumnCount);
+        *max_y = dmMath::Min(*min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)resource->m_RowCount);
+    }
+
+    static uint32_t CountRegionTiles(const TileGridComponent* component, uint32_t layer, uint32_t region_x, uint32_t region_y)
+    {
+        const TileGridResource* resource = component->m_Resource;
+        uint32_t column_count = resource->m_ColumnCount;
+        uint32_t row_count = resource->m_RowCount;
+
+        int32_t min_x, min_y, max_x, max_y;
+        GetRegionCellBounds(resource, region_x, region_y, &min_x, &min_y, &max_x, &max_y);
+
+        uint32_t count = 0;
+        for (int32_t y = min_y; y < max_y; ++y)
+        {
+            for (int32_t x = min_x; x < max_x; ++x)
+            {
+                uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
+                count += component->m_Cells[cell] != 0xffff ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+    // Writes the vertices of the tiles in a region of a layer and returns the number of vertices written
+    static uint32_t CreateRegionVertexData(const TileGridComponent* component, uint32_t layer, uint32_t region_x, uint32_t region_y, TileGridVertex* where)
     {
-        DM_PROFILE(TileGrid, "CreateVertexData");
         static int tex_coord_order[] = {
             0,1,2,2,3,0,
             3,2,1,1,0,3,    //h
@@ -515,90 +589,183 @@ namespace dmGameSystem
             2,3,0,0,1,2     //hv
         };
 
-        dmGameSystemDDF::TextureSet* texture_set_ddf = texture_set->m_TextureSet;
+        dmGameSystemDDF::TextureSet* texture_set_ddf = GetTextureSet(component)->m_TextureSet;
         const float* tex_coords = (const float*) texture_set_ddf->m_TexCoords.m_Data;
 
         uint32_t tile_width = texture_set_ddf->m_TileWidth;
         uint32_t tile_height = texture_set_ddf->m_TileHeight;
 
-        for (uint32_t* i = begin; i != end; ++i)
-        {
-            uint32_t index, layer, region_x, region_y;
-            DecodeGridAndLayer(buf[*i].m_UserData, index, layer, region_x, region_y);
-
-            const TileGridComponent* component = world->m_Components[index];
-            const TileGridResource* resource = component->m_Resource;
-            dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
-            dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[layer];
+        const TileGridResource* resource = component->m_Resource;
+        dmGameSystemDDF::TileGrid* tile_grid_ddf = resource->m_TileGrid;
+        dmGameSystemDDF::TileLayer* layer_ddf = &tile_grid_ddf->m_Layers[layer];
 
-            const Matrix4& w = component->m_World;
-            const float z = layer_ddf->m_Z;
+        const Matrix4& w = component->m_World;
+        const float z = layer_ddf->m_Z;
 
-            uint32_t column_count = resource->m_ColumnCount;
-            uint32_t row_count = resource->m_RowCount;
+        uint32_t column_count = resource->m_ColumnCount;
+        uint32_t row_count = resource->m_RowCount;
 
-            int32_t min_x = resource->m_MinCellX + region_x * TILEGRID_REGION_SIZE;
-            int32_t min_y = resource->m_MinCellY + region_y * TILEGRID_REGION_SIZE;
-            int32_t max_x = dmMath::Min(min_x + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellX + (int32_t)column_count);
-            int32_t max_y = dmMath::Min(min_y + (int32_t)TILEGRID_REGION_SIZE, resource->m_MinCellY + (int32_t)row_count);
+        int32_t min_x, min_y, max_x, max_y;
+        GetRegionCellBounds(resource, region_x, region_y, &min_x, &min_y, &max_x, &max_y);
 
-            for (int32_t y = min_y; y < max_y; ++y)
+        TileGridVertex* begin = where;
+        for (int32_t y = min_y; y < max_y; ++y)
+        {
+            for (int32_t x = min_x; x < max_x; ++x)
             {
-                for (int32_t x = min_x; x < max_x; ++x)
+                uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
+                uint16_t tile = component->m_Cells[cell];
+                if (tile == 0xffff)
                 {
-                    uint32_t cell = CalculateCellIndex(layer, x - resource->m_MinCellX, y - resource->m_MinCellY, column_count, row_count);
-                    uint16_t tile = component->m_Cells[cell];
-                    if (tile == 0xffff)
-                    {
-                        continue;
-                    }
+                    continue;
+                }
 
-                    if( where >= world->m_VertexBufferDataEnd )
-                    {
-                        dmLogError("Out of tiles to render (%zu). You can change this with the game.project setting tilemap.max_tile_count", (size_t)((world->m_VertexBufferDataEnd - world->m_VertexBufferData) / 6));
-                        return world->m_VertexBufferDataEnd;
+                float p[4];
+                CalculateCellBounds(x, y, 1, 1, p);
+                const float* puv = &tex_coords[tile * 8];
+                uint32_t flip_flag = 0;
+
+                TileGridComponent::Flags flags = component->m_CellFlags[cell];
+                if (flags.m_FlipHorizontal)
+                {
+                    flip_flag = 1;
+                }
+                if (flags.m_FlipVertical)
+                {
+                    flip_flag |= 2;
+                }
+                const int* tex_lookup = &tex_coord_order[flip_flag * 6];
+
+                #define SET_VERTEX(_I, _X, _Y, _Z, _U, _V) \
+                    { \
+                        const Vector4 v = w * Point3(_X * tile_width, _Y * tile_height, _Z); \
+                        where[_I].x = v.getX(); \
+                        where[_I].y = v.getY(); \
+                        where[_I].z = v.getZ(); \
+                        where[_I].u = _U; \
+                        where[_I].v = _V; \
                     }
 
-                    float p[4];
-                    CalculateCellBounds(x, y, 1, 1, p);
-                    const float* puv = &tex_coords[tile * 8];
-                    uint32_t flip_flag = 0;
+                SET_VERTEX(0, p[0], p[1], z, puv[tex_lookup[0] * 2], puv[tex_lookup[0] * 2 + 1]);
+                SET_VERTEX(1, p[0], p[3], z, puv[tex_lookup[1] * 2], puv[tex_lookup[1] * 2 + 1]);
+                SET_VERTEX(2, p[2], p[3], z, puv[tex_lookup[2] * 2], puv[tex_lookup[2] * 2 + 1]);
+                SET_VERTEX(3, p[2], p[3], z, puv[tex_lookup[3] * 2], puv[tex_lookup[3] * 2 + 1]);
+                SET_VERTEX(4, p[2], p[1], z, puv[tex_lookup[4] * 2], puv[tex_lookup[4] * 2 + 1]);
+                SET_VERTEX(5, p[0], p[1], z, puv[tex_lookup[5] * 2], puv[tex_lookup[5] * 2 + 1]);
 
-                    TileGridComponent::Flags flags = component->m_CellFlags[cell];
-                    if (flags.m_FlipHorizontal)
-                    {
-                        flip_flag = 1;
-                    }
-                    if (flags.m_FlipVertical)
-                    {
-                        flip_flag |= 2;
-                    }
-                    const int* tex_lookup = &tex_coord_order[flip_flag * 6];
-
-                    #define SET_VERTEX(_I, _X, _Y, _Z, _U, _V) \
-                        { \
-                            const Vector4 v = w * Point3(_X * tile_width, _Y * tile_height, _Z); \
-                            where[_I].x = v.getX(); \
-                            where[_I].y = v.getY(); \
-                            where[_I].z = v.getZ(); \
-                            where[_I].u = _U; \
-                            where[_I].v = _V; \
-                        }
+                where += 6;
+
+                #undef SET_VERTEX
+            }
+        }
+        return (uint32_t)(where - begin);
+    }
+
+    static void EnsureScratchVertices(TileGridWorld* world, uint32_t vertex_count)
+    {
+        if (world->m_VertexBufferData.Capacity() < vertex_count)
+        {
+            world->m_VertexBufferData.SetCapacity(vertex_count);
+        }
+        world->m_VertexBufferData.SetSize(vertex_count);
+    }
+
+    // Lays out all regions of the layer back to back in its vertex buffer and uploads all of it
+    static void CreateLayerVertexData(TileGridWorld* world, TileGridComponent* component, uint32_t layer)
+    {
+        DM_PROFILE(TileGrid, "CreateVertexData");
 
-                    SET_VERTEX(0, p[0], p[1], z, puv[tex_lookup[0] * 2], puv[tex_lookup[0] * 2 + 1]);
-                    SET_VERTEX(1, p[0], p[3], z, puv[tex_lookup[1] * 2], puv[tex_lookup[1] * 2 + 1]);
-                    SET_VERTEX(2, p[2], p[3], z, puv[tex_lookup[2] * 2], puv[tex_lookup[2] * 2 + 1]);
-                    SET_VERTEX(3, p[2], p[3], z, puv[tex_lookup[3] * 2], puv[tex_lookup[3] * 2 + 1]);
-                    SET_VERTEX(4, p[2], p[1], z, puv[tex_lookup[4] * 2], puv[tex_lookup[4] * 2 + 1]);
-                    SET_VERTEX(5, p[0], p[1], z, puv[tex_lookup[5] * 2], puv[tex_lookup[5] * 2 + 1]);
+        uint32_t region_count = component->m_RegionsX * component->m_RegionsY;
+        TileGridRegionRange* ranges = &component->m_RegionRanges[layer * region_count];
 
-                    where += 6;
+        uint32_t vertex_count = 0;
+        for (uint32_t region_y = 0, region_index = 0; region_y < component->m_RegionsY; ++region_y)
+        {
+            for (uint32_t region_x = 0; region_x < component->m_RegionsX; ++region_x, ++region_index)
+            {
+                TileGridRegionRange* range = &ranges[region_index];
+                range->m_VertexStart = vertex_count;
+                range->m_VertexCapacity = 6 * CountRegionTiles(component, layer, region_x, region_y);
+                vertex_count += range->m_VertexCapacity;
+            }
+        }
 
-                    #undef SET_VERTEX
+        EnsureScratchVertices(world, vertex_count);
+        TileGridVertex* data = world->m_VertexBufferData.Begin();
+        for (uint32_t region_y = 0, region_index = 0; region_y < component->m_RegionsY; ++region_y)
+        {
+            for (uint32_t region_x = 0; region_x < component->m_RegionsX; ++region_x, ++region_index)
+            {
+                TileGridRegionRange* range = &ranges[region_index];
+                range->m_VertexCount = CreateRegionVertexData(component, layer, region_x, region_y, data + range->m_VertexStart);
+                range->m_Dirty = 0;
+            }
+        }
+
+        TileGridLayer* tile_grid_layer = &component->m_Layers[layer];
+        if (tile_grid_layer->m_VertexBuffer == 0)
+        {
+            tile_grid_layer->m_VertexBuffer = dmGraphics::NewVertexBuffer(dmRender::GetGraphicsContext(world->m_RenderContext), 0, 0x0, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+        }
+        uint32_t data_size = sizeof(TileGridVertex) * vertex_count;
+        dmGraphics::SetVertexBufferData(tile_grid_layer->m_VertexBuffer, data_size, data, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+        DM_COUNTER("TileGridVertexBuffer", data_size);
+        tile_grid_layer->m_Dirty = 0;
+        tile_grid_layer->m_RegionsDirty = 0;
+    }
+
+    // Rewrites the ranges of the dirty regions of a layer in place. Falls back to rebuilding
+    // the whole layer when a region has grown beyond its range.
+    static void UpdateLayerRegionVertexData(TileGridWorld* world, TileGridComponent* component, uint32_t layer)
+    {
+        DM_PROFILE(TileGrid, "UpdateRegionVertexData");
+
+        uint32_t region_count = component->m_RegionsX * component->m_RegionsY;
+        TileGridRegionRange* ranges = &component->m_RegionRanges[layer * region_count];
+
+        for (uint32_t region_y = 0, region_index = 0; region_y < component->m_RegionsY; ++region_y)
+        {
+            for (uint32_t region_x = 0; region_x < component->m_RegionsX; ++region_x, ++region_index)
+            {
+                const TileGridRegionRange* range = &ranges[region_index];
+                if (range->m_Dirty && 6 * CountRegionTiles(component, layer, region_x, region_y) > range->m_VertexCapacity)
+                {
+                    CreateLayerVertexData(world, component, layer);
+                    return;
+                }
+            }
+        }
+
+        TileGridLayer* tile_grid_layer = &component->m_Layers[layer];
+        EnsureScratchVertices(world, 6 * TILEGRID_REGION_SIZE * TILEGRID_REGION_SIZE);
+        TileGridVertex* data = world->m_VertexBufferData.Begin();
+        for (uint32_t region_y = 0, region_index = 0; region_y < component->m_RegionsY; ++region_y)
+        {
+            for (uint32_t region_x = 0; region_x < component->m_RegionsX; ++region_x, ++region_index)
+            {
+                TileGridRegionRange* range = &ranges[region_index];
+                if (!range->m_Dirty)
+                {
+                    continue;
                 }
+                range->m_Dirty = 0;
+                range->m_VertexCount = CreateRegionVertexData(component, layer, region_x, region_y, data);
+                if (range->m_VertexCount == 0)
+                {
+                    continue;
+                }
+                uint32_t data_size = sizeof(TileGridVertex) * range->m_VertexCount;
+                dmGraphics::SetVertexBufferSubData(tile_grid_layer->m_VertexBuffer, sizeof(TileGridVertex) * range->m_VertexStart, data_size, data);
+                DM_COUNTER("TileGridVertexBuffer", data_size);
             }
         }
-        return where;
+        tile_grid_layer->m_RegionsDirty = 0;
+    }
+
+    static inline const TileGridRegionRange* GetRegionRange(const TileGridComponent* component, uint32_t layer, uint32_t region_x, uint32_t region_y)
+    {
+        uint32_t region_count = component->m_RegionsX * component->m_RegionsY;
+        return &component->m_RegionRanges[layer * region_count + region_y * component->m_RegionsX + region_x];
     }
 
     static void RenderBatch(TileGridWorld* world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
@@ -613,19 +780,10 @@ namespace dmGameSystem
         TileGridResource* resource = first->m_Resource;
         TextureSetResource* texture_set = GetTextureSet(first);
 
-        dmRender::RenderObject& ro = *world->m_RenderObjects.End();
-        world->m_RenderObjects.SetSize(world->m_RenderObjects.Size()+1);
-
-        // Fill in vertex buffer
-        TileGridVertex* vb_begin = world->m_VertexBufferWritePtr;
-        world->m_VertexBufferWritePtr = CreateVertexData(world, vb_begin, texture_set, buf, begin, end);
-
+        dmRender::RenderObject ro;
         ro.Init();
         ro.m_VertexDeclaration = world->m_VertexDeclaration;
-        ro.m_VertexBuffer = world->m_VertexBuffer;
         ro.m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
-        ro.m_VertexStart = vb_begin - world->m_VertexBufferData;
-        ro.m_VertexCount = (world->m_VertexBufferWritePtr - vb_begin);
         ro.m_Material = GetMaterial(first);
         ro.m_Textures[0] = texture_set->m_Texture;
 
@@ -664,7 +822,39 @@ namespace dmGameSystem
 
         ro.m_SetBlendFactors = 1;
 
-        dmRender::AddToRender(render_context, &ro);
+        // All entries in the batch share material, textures and constants. Each entry is a region range
+        // in the persistent buffer of its layer, and consecutive ranges in the same buffer are drawn together.
+        dmRender::RenderObject* current = 0;
+        uint32_t vertex_count = 0;
+        for (uint32_t* i = begin; i != end; ++i)
+        {
+            DecodeGridAndLayer(buf[*i].m_UserData, index, layer, region_x, region_y);
+            const TileGridComponent* component = world->m_Components[index];
+            const TileGridRegionRange* range = GetRegionRange(component, layer, region_x, region_y);
+            dmGraphics::HVertexBuffer vertex_buffer = component->m_Layers[layer].m_VertexBuffer;
+            vertex_count += range->m_VertexCount;
+
+            if (current && current->m_VertexBuffer == vertex_buffer && current->m_VertexStart + current->m_VertexCount == range->m_VertexStart)
+            {
+                current->m_VertexCount += range->m_VertexCount;
+                continue;
+            }
+
+            if (current)
+            {
+                dmRender::AddToRender(render_context, current);
+            }
+
+            current = world->m_RenderObjects.End();
+            world->m_RenderObjects.SetSize(world->m_RenderObjects.Size()+1);
+            *current = ro;
+            current->m_VertexBuffer = vertex_buffer;
+            current->m_VertexStart = range->m_VertexStart;
+            current->m_VertexCount = range->m_VertexCount;
+        }
+
+        dmRender::AddToRender(render_context, current);
+        DM_COUNTER("TileGridTileCount", vertex_count / 6);
     }
 
     static void RenderListDispatch(dmRender::RenderListDispatchParams const &params)
@@ -674,21 +864,19 @@ namespace dmGameSystem
         switch (params.m_Operation)
         {
         case dmRender::RENDER_LIST_OPERATION_BEGIN:
-            world->m_VertexBufferWritePtr = world->m_VertexBufferData;
             world->m_RenderObjects.SetSize(0);
             break;
 
         case dmRender::RENDER_LIST_OPERATION_END:
-            dmGraphics::SetVertexBufferData(world->m_VertexBuffer, 0, 0, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
-            dmGraphics::SetVertexBufferData(world->m_VertexBuffer, sizeof(TileGridVertex) * (world->m_VertexBufferWritePtr - world->m_VertexBufferData),
-                                            world->m_VertexBufferData, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
-            DM_COUNTER("TileGridVertexBuffer", (world->m_VertexBufferWritePtr - world->m_VertexBufferData) * sizeof(TileGridVertex));
-            DM_COUNTER("TileGridTileCount", (world->m_VertexBufferWritePtr - world->m_VertexBufferData));
             break;
 
         case dmRender::RENDER_LIST_OPERATION_BATCH:
             assert(params.m_Operation == dmRender::RENDER_LIST_OPERATION_BATCH);
             RenderBatch(world, params.m_Context, params.m_Buf, params.m_Begin, params.m_End);
+            break;
+
+        default:
+            break;
         }
     }
 
@@ -727,12 +915,45 @@ namespace dmGameSystem
             return dmGameObject::UPDATE_RESULT_OK;
         }
 
+        // Only layers and regions that changed since the last frame are rebuilt
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            TileGridComponent* component = components[i];
+            if (!component->m_Enabled || !component->m_AddedToUpdate || !component->m_Occupied) {
+                continue;
+            }
+            uint32_t n_layers = component->m_Layers.Size();
+            for (uint32_t l = 0; l < n_layers; ++l)
+            {
+                const TileGridLayer* layer = &component->m_Layers[l];
+                if (!layer->m_IsVisible)
+                    continue;
+
+                if (layer->m_Dirty)
+                {
+                    CreateLayerVertexData(world, component, l);
+                }
+                else if (layer->m_RegionsDirty)
+                {
+                    UpdateLayerRegionVertexData(world, component, l);
+                }
+            }
+        }
+
         uint32_t num_render_entries = CalcNumVisibleRegions(&components[0], n);
+        if (world->m_RenderObjects.Capacity() < num_render_entries)
+        {
+            // At most one render object per entry, and the render objects must not move once added
+            world->m_RenderObjects.SetCapacity(num_render_entries);
+        }
         dmRender::HRenderContext render_context = context->m_RenderContext;
         dmRender::RenderListEntry* render_list = dmRender::RenderListAlloc(render_context, num_render_entries);
         dmRender::HRenderListDispatch dispatch = dmRender::RenderListMakeDispatch(render_context, &RenderListDispatch, world);
         dmRender::RenderListEntry* write_ptr = render_list;
 
+        // The tile budget (tilemap.max_tile_count) applies to the tiles drawn this frame,
+        // regardless of how many tiles the layer buffers hold
+        uint32_t tile_count = 0;
         for (uint32_t i = 0; i < n; ++i)
         {
             TileGridComponent* component = components[i];
@@ -764,10 +985,18 @@ namespace dmGameSystem
                     for (uint32_t x = 0; x < component->m_RegionsX; ++x, ++region_index) {
 
                         TileGridRegion* region = &component->m_Regions[region_index];
-                        if (!region->m_Occupied) {
+                        uint32_t region_tile_count = GetRegionRange(component, l, x, y)->m_VertexCount / 6;
+                        if (!region->m_Occupied || region_tile_count == 0) {
                             continue;
                         }
 
+                        if (tile_count + region_tile_count > world->m_MaxTileCount)
+                        {
+                            dmLogError("Out of tiles to render (%u). You can change this with the game.project setting tilemap.max_tile_count", world->m_MaxTileCount);
+                            goto done;
+                        }
+                        tile_count += region_tile_count;
+
                         Vector4 trans = component->m_World * Point3(x * tile_width, y * tile_height, layer_ddf->m_Z);
 
                         write_ptr->m_WorldPosition = Point3(trans.getXYZ());
@@ -783,6 +1012,7 @@ namespace dmGameSystem
             }
         }
 
+done:
         if (render_list != write_ptr)
             dmRender::RenderListSubmit(render_context, render_list, write_ptr);
         return dmGameObject::UPDATE_RESULT_OK;
@@ -937,7 +1167,10 @@ namespace dmGameSystem
         }
         if (params.m_PropertyId == PROP_TILE_SOURCE)
         {
-            return SetResourceProperty(dmGameObject::GetFactory(params.m_Instance), params.m_Value, TEXTURE_SET_EXT_HASH, (void**)&component->m_TextureSet);
+            dmGameObject::PropertyResult res = SetResourceProperty(dmGameObject::GetFactory(params.m_Instance), params.m_Value, TEXTURE_SET_EXT_HASH, (void**)&component->m_TextureSet);
+            // Texture coordinates and tile size are baked into the vertex data
+            SetLayersDirty(component);
+            return res;
         }
         return SetMaterialConstant(GetMaterial(component), params.m_PropertyId, params.m_Value, CompTileGridSetConstantCallback, component);
     }
@@ -172,7 +172,7 @@ namespace dmGameSystem
 #define REGISTER_COMPONENT_TYPE(extension, prio, context, new_world_func, delete_world_func, \
                                 create_func, destroy_func, init_func, final_func, add_to_update_func, get_func, \
                                 update_func, render_func, post_update_func, on_message_func, on_input_func, \
-                                on_reload_func, get_property_func, set_property_func, set_reads_transforms)\
+                                on_reload_func, get_property_func, set_property_func, set_reads_transforms, update_access, thread_safe_update)\
     factory_result = dmResource::GetTypeFromExtension(factory, extension, &type);\
     if (factory_result != dmResource::RESULT_OK)\
     {\
@@ -202,6 +202,8 @@ namespace dmGameSystem
     component_type.m_ReadsTransforms = set_reads_transforms;\
     component_type.m_InstanceHasUserData = (uint32_t)true;\
     component_type.m_UpdateOrderPrio = prio;\
+    component_type.m_UpdateAccess = update_access;\
+    component_type.m_ThreadSafeUpdate = thread_safe_update;\
     go_result = dmGameObject::RegisterComponentType(regist, component_type);\
     if (go_result != dmGameObject::RESULT_OK)\
         return go_result;
@@ -209,13 +211,20 @@ namespace dmGameSystem
         /*
          * About update priority. Component types below have priority evenly spaced with increments by 100
          *
+         * About update access. Types that declare what they read and write in their update function (i.e. not
+         * UPDATE_ACCESS_EXCLUSIVE) may share an update stage with other types they do not conflict with.
+         * Types whose update run script callbacks or touch shared systems (resources, render, sound) stay exclusive.
+         *
+         * About thread safe update. The last argument sets m_ThreadSafeUpdate for types whose update only touches
+         * their own world. When the register has a job system, those are updated on worker threads, concurrently
+         * with the other types in their stage. Particle FX runs its emitter callbacks and releases resources in its post update for this reason.
          */
 
         REGISTER_COMPONENT_TYPE("collectionproxyc", 100, collection_proxy_context,
                 &CompCollectionProxyNewWorld, &CompCollectionProxyDeleteWorld,
                 &CompCollectionProxyCreate, &CompCollectionProxyDestroy, 0, &CompCollectionProxyFinal, &CompCollectionProxyAddToUpdate, 0,
                 &CompCollectionProxyUpdate, &CompCollectionProxyRender, &CompCollectionProxyPostUpdate, &CompCollectionProxyOnMessage, &CompCollectionProxyOnInput, 0, 0, 0,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         // See gameobject_comp.cpp for these two component types:
         // Priority 200 is reserved for scriptc (read+write transforms)
@@ -225,91 +234,91 @@ namespace dmGameSystem
                 CompGuiNewWorld, CompGuiDeleteWorld,
                 CompGuiCreate, CompGuiDestroy, CompGuiInit, CompGuiFinal, CompGuiAddToUpdate, 0,
                 CompGuiUpdate, CompGuiRender, 0, CompGuiOnMessage, CompGuiOnInput, CompGuiOnReload, CompGuiGetProperty, CompGuiSetProperty,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("collisionobjectc", 400, physics_context,
                 &CompCollisionObjectNewWorld, &CompCollisionObjectDeleteWorld,
                 &CompCollisionObjectCreate, &CompCollisionObjectDestroy, 0, &CompCollisionObjectFinal, &CompCollisionObjectAddToUpdate, 0,
                 &CompCollisionObjectUpdate, 0, &CompCollisionObjectPostUpdate, &CompCollisionObjectOnMessage, 0, &CompCollisionObjectOnReload, CompCollisionObjectGetProperty, CompCollisionObjectSetProperty,
-                1);
+                1, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("camerac", 500, render_context,
                 &CompCameraNewWorld, &CompCameraDeleteWorld,
                 &CompCameraCreate, &CompCameraDestroy, 0, 0, &CompCameraAddToUpdate, 0,
                 &CompCameraUpdate, 0, 0, &CompCameraOnMessage, 0, &CompCameraOnReload, 0, 0,
-                1);
+                1, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("soundc", 600, sound_context,
                 CompSoundNewWorld, CompSoundDeleteWorld,
                 CompSoundCreate, CompSoundDestroy, 0, 0, CompSoundAddToUpdate, 0,
                 CompSoundUpdate, 0, 0, CompSoundOnMessage, 0, 0, CompSoundGetProperty, CompSoundSetProperty,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("modelc", 700, model_context,
                 CompModelNewWorld, CompModelDeleteWorld,
                 CompModelCreate, CompModelDestroy, 0, 0, CompModelAddToUpdate, 0,
                 CompModelUpdate, CompModelRender, 0, CompModelOnMessage, 0, 0, CompModelGetProperty, CompModelSetProperty,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_WRITE_TRANSFORMS | dmGameObject::UPDATE_ACCESS_WRITE_MESSAGES, 0);
 
         REGISTER_COMPONENT_TYPE("meshc", 725, mesh_context,
                 CompMeshNewWorld, CompMeshDeleteWorld,
                 CompMeshCreate, CompMeshDestroy, 0, 0, CompMeshAddToUpdate, 0,
                 CompMeshUpdate, CompMeshRender, 0, CompMeshOnMessage, 0, 0, CompMeshGetProperty, CompMeshSetProperty,
-                0);
+                0, 0, 0);
 
         REGISTER_COMPONENT_TYPE("emitterc", 750, 0x0,
                 &CompEmitterNewWorld, &CompEmitterDeleteWorld,
                 &CompEmitterCreate, &CompEmitterDestroy, 0, 0, 0, 0,
                 0, 0, 0, CompEmitterOnMessage, 0, 0, 0, 0,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("particlefxc", 800, particlefx_context,
                 &CompParticleFXNewWorld, &CompParticleFXDeleteWorld,
                 &CompParticleFXCreate, &CompParticleFXDestroy, 0, 0, &CompParticleFXAddToUpdate, 0,
-                &CompParticleFXUpdate, &CompParticleFXRender, 0, &CompParticleFXOnMessage, 0, &CompParticleFXOnReload, 0, 0,
-                1);
+                &CompParticleFXUpdate, &CompParticleFXRender, &CompParticleFXPostUpdate, &CompParticleFXOnMessage, 0, &CompParticleFXOnReload, 0, 0,
+                1, dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS, 1);
 
         REGISTER_COMPONENT_TYPE("factoryc", 900, factory_context,
                 CompFactoryNewWorld, CompFactoryDeleteWorld,
                 CompFactoryCreate, CompFactoryDestroy, 0, 0, CompFactoryAddToUpdate, 0,
                 CompFactoryUpdate, 0, 0, CompFactoryOnMessage, 0, 0, 0, 0,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("collectionfactoryc", 950, collectionfactory_context,
                 CompCollectionFactoryNewWorld, CompCollectionFactoryDeleteWorld,
                 CompCollectionFactoryCreate, CompCollectionFactoryDestroy, 0, 0, CompCollectionFactoryAddToUpdate, 0,
                 CompCollectionFactoryUpdate, 0, 0, 0, 0, 0, 0, 0,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("lightc", 1000, render_context,
                 CompLightNewWorld, CompLightDeleteWorld,
                 CompLightCreate, CompLightDestroy, 0, 0, CompLightAddToUpdate, 0,
                 CompLightUpdate, 0, 0, CompLightOnMessage, 0, 0, 0, 0,
-                1);
+                1, dmGameObject::UPDATE_ACCESS_EXCLUSIVE, 0);
 
         REGISTER_COMPONENT_TYPE("spritec", 1100, sprite_context,
                 CompSpriteNewWorld, CompSpriteDeleteWorld,
                 CompSpriteCreate, CompSpriteDestroy, 0, 0, CompSpriteAddToUpdate, 0,
                 CompSpriteUpdate, CompSpriteRender, 0, CompSpriteOnMessage, 0, CompSpriteOnReload, CompSpriteGetProperty, CompSpriteSetProperty,
-                1);
+                1, dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS | dmGameObject::UPDATE_ACCESS_WRITE_MESSAGES, 1);
 
         REGISTER_COMPONENT_TYPE(TILE_MAP_EXT, 1200, tilemap_context,
                 CompTileGridNewWorld, CompTileGridDeleteWorld,
                 CompTileGridCreate, CompTileGridDestroy, 0, 0, CompTileGridAddToUpdate, 0,
                 CompTileGridUpdate, CompTileGridRender, 0, CompTileGridOnMessage, 0, CompTileGridOnReload, CompTileGridGetProperty, CompTileGridSetProperty,
-                1);
+                1, dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS, 1);
 
         REGISTER_COMPONENT_TYPE(SPINE_MODEL_EXT, 1300, spine_model_context,
                 CompSpineModelNewWorld, CompSpineModelDeleteWorld,
                 CompSpineModelCreate, CompSpineModelDestroy, 0, 0, CompSpineModelAddToUpdate, 0,
                 CompSpineModelUpdate, CompSpineModelRender, 0, CompSpineModelOnMessage, 0, CompSpineModelOnReload, CompSpineModelGetProperty, CompSpineModelSetProperty,
-                0);
+                0, dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS | dmGameObject::UPDATE_ACCESS_WRITE_TRANSFORMS | dmGameObject::UPDATE_ACCESS_WRITE_MESSAGES, 1);
 
         REGISTER_COMPONENT_TYPE("labelc", 1400, label_context,
                 CompLabelNewWorld, CompLabelDeleteWorld,
                 CompLabelCreate, CompLabelDestroy, 0, 0, CompLabelAddToUpdate, CompLabelGetComponent,
                 CompLabelUpdate, CompLabelRender, 0, CompLabelOnMessage, 0, CompLabelOnReload, CompLabelGetProperty, CompLabelSetProperty,
-                1);
+                1, dmGameObject::UPDATE_ACCESS_READ_TRANSFORMS, 1);
 
         #undef REGISTER_COMPONENT_TYPE
 
@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <sound/sound.h>
 #include "sound_ddf.h"
 
@@ -39,6 +40,7 @@ namespace dmGameSystem
             s->m_Gain = sound_desc->m_Gain;
             s->m_Pan = sound_desc->m_Pan;
             s->m_Speed = sound_desc->m_Speed;
+            s->m_Priority = (uint8_t) dmMath::Clamp(sound_desc->m_Priority, 0, 255);
 
             dmSound::Result result = dmSound::AddGroup(sound_desc->m_Group);
             if (result != dmSound::RESULT_OK) {
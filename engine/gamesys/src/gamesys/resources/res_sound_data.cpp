@@ -16,6 +16,50 @@
 
 namespace dmGameSystem
 {
+    static dmSound::Result ReadStreamedSoundData(void* context, uint32_t offset, uint32_t size, void* buffer, uint32_t* nread)
+    {
+        dmResource::HResourceStream stream = (dmResource::HResourceStream) context;
+        dmResource::Result r = dmResource::ReadResourceStream(stream, offset, size, buffer, nread);
+        return r == dmResource::RESULT_OK ? dmSound::RESULT_OK : dmSound::RESULT_INVALID_STREAM_DATA;
+    }
+
+    // Large sounds are streamed if the resource can be read in parts, i.e. is stored uncompressed and
+    // unencrypted in the archive or on disc. The data is still loaded once for the create call, but isn't kept.
+    // Returns the opened stream, or 0 if the sound should be kept resident
+    static dmResource::HResourceStream OpenStream(const dmResource::ResourceCreateParams& params, dmSound::SoundDataType type)
+    {
+        uint32_t threshold = dmSound::GetStreamingThreshold();
+        if (type != dmSound::SOUND_DATA_TYPE_OGG_VORBIS || threshold == 0 || params.m_BufferSize <= threshold)
+        {
+            return 0;
+        }
+
+        dmResource::HResourceStream stream = 0;
+        if (dmResource::OpenResourceStream(params.m_Factory, params.m_Filename, &stream) != dmResource::RESULT_OK)
+        {
+            return 0;
+        }
+
+        uint8_t header[4];
+        uint32_t nread = 0;
+        dmResource::Result r = dmResource::ReadResourceStream(stream, 0, sizeof(header), header, &nread);
+        if (r != dmResource::RESULT_OK || nread != sizeof(header) || memcmp(header, params.m_Buffer, sizeof(header)) != 0)
+        {
+            dmResource::CloseResourceStream(stream);
+            return 0;
+        }
+        return stream;
+    }
+
+    // Must be called after the sound stopped reading from the stream, i.e. after DeleteSoundData or SetSoundData
+    static void CloseStream(void* read_context)
+    {
+        if (read_context)
+        {
+            dmResource::CloseResourceStream((dmResource::HResourceStream) read_context);
+        }
+    }
+
     dmResource::Result ResSoundDataCreate(const dmResource::ResourceCreateParams& params)
     {
         dmSound::HSoundData sound_data;
@@ -28,7 +72,21 @@ namespace dmGameSystem
             type = dmSound::SOUND_DATA_TYPE_OGG_VORBIS;
         }
 
-        dmSound::Result r = dmSound::NewSoundData(params.m_Buffer, params.m_BufferSize, type, &sound_data, params.m_Resource->m_NameHash);
+        dmSound::Result r;
+        dmResource::HResourceStream stream = OpenStream(params, type);
+        if (stream)
+        {
+            r = dmSound::NewSoundDataStreaming(ReadStreamedSoundData, stream, params.m_BufferSize, type, &sound_data, params.m_Resource->m_NameHash);
+            if (r != dmSound::RESULT_OK)
+            {
+                CloseStream(stream);
+            }
+        }
+        else
+        {
+            r = dmSound::NewSoundData(params.m_Buffer, params.m_BufferSize, type, &sound_data, params.m_Resource->m_NameHash);
+        }
+
         if (r != dmSound::RESULT_OK)
         {
             return dmResource::RESULT_OUT_OF_RESOURCES;
@@ -42,7 +100,9 @@ namespace dmGameSystem
     dmResource::Result ResSoundDataDestroy(const dmResource::ResourceDestroyParams& params)
     {
         dmSound::HSoundData sound_data = (dmSound::HSoundData) params.m_Resource->m_Resource;
+        void* stream = dmSound::GetSoundDataReadContext(sound_data);
         dmSound::Result r = dmSound::DeleteSoundData(sound_data);
+        CloseStream(stream);
         if (r != dmSound::RESULT_OK)
         {
             return dmResource::RESULT_INVAL;
@@ -53,7 +113,10 @@ namespace dmGameSystem
     dmResource::Result ResSoundDataRecreate(const dmResource::ResourceRecreateParams& params)
     {
         dmSound::HSoundData sound_data = (dmSound::HSoundData) params.m_Resource->m_Resource;
+        // Reloaded data is kept resident
+        void* stream = dmSound::GetSoundDataReadContext(sound_data);
         dmSound::Result r = dmSound::SetSoundData(sound_data, params.m_Buffer, params.m_BufferSize);
+        CloseStream(stream);
         if (r != dmSound::RESULT_OK)
         {
             return dmResource::RESULT_INVAL;
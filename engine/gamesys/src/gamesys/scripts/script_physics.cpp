@@ -14,6 +14,8 @@
 #include <stdio.h>
 #include <assert.h>
 
+#include <dlib/array.h>
+#include <dlib/buffer.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
@@ -24,6 +26,7 @@
 #include "../gamesys_private.h"
 
 #include "components/comp_collision_object.h"
+#include "resources/res_buffer.h"
 
 #include "script_physics.h"
 #include <physics/physics.h>
@@ -113,6 +116,9 @@ namespace dmGameSystem
     {
         dmMessage::HSocket m_Socket;
         uint32_t m_ComponentIndex;
+        // Reused between calls to physics.raycast_batch
+        dmArray<dmPhysics::RayCastRequest>  m_BatchRequests;
+        dmArray<dmPhysics::RayCastResponse> m_BatchResponses;
     };
 
     /*# [type:number] collision object mass
@@ -465,6 +471,254 @@ namespace dmGameSystem
         return 1;
     }
 
+    static dmBuffer::HBuffer UnpackLuaBuffer(dmScript::LuaHBuffer* lua_buffer)
+    {
+        if (lua_buffer->m_Owner == dmScript::OWNER_RES)
+            return ((BufferResource*)lua_buffer->m_BufferRes)->m_Buffer;
+        return lua_buffer->m_Buffer;
+    }
+
+    // Returns the data of a stream of the given type with at least min_components components. Stride is in number of values.
+    static void* CheckBatchStream(lua_State* L, dmBuffer::HBuffer buffer, const char* name, dmBuffer::ValueType type, uint32_t min_components,
+                                  uint32_t* count, uint32_t* components, uint32_t* stride)
+    {
+        dmhash_t stream_name = dmHashString64(name);
+        dmBuffer::ValueType stream_type;
+        dmBuffer::Result r = dmBuffer::GetStreamType(buffer, stream_name, &stream_type, components);
+        if (r != dmBuffer::RESULT_OK)
+        {
+            luaL_error(L, "physics.raycast_batch: failed to get stream '%s': %s", name, dmBuffer::GetResultString(r));
+            return 0;
+        }
+        if (stream_type != type || *components < min_components)
+        {
+            luaL_error(L, "physics.raycast_batch: stream '%s' must be of type %s with at least %d components", name, dmBuffer::GetValueTypeString(type), min_components);
+            return 0;
+        }
+        void* data = 0;
+        r = dmBuffer::GetStream(buffer, stream_name, &data, count, components, stride);
+        if (r != dmBuffer::RESULT_OK)
+        {
+            luaL_error(L, "physics.raycast_batch: failed to get stream '%s': %s", name, dmBuffer::GetResultString(r));
+            return 0;
+        }
+        return data;
+    }
+
+    /*# performs a batch of ray casts
+     *
+     * Performs a batch of synchronous ray casts and writes the closest hit of each ray to a buffer.
+     * Meant for large numbers of rays, e.g. line of sight tests, where each ray returning a table
+     * or a message is too expensive. With 2D physics, the rays are cast in parallel on the worker threads.
+     * With 3D physics, they are cast one after the other on the calling thread.
+     * Collision objects of types kinematic, dynamic and static are tested against. Trigger objects
+     * do not intersect with ray casts.
+     *
+     * The result buffer has one element per ray, with the streams:
+     *
+     * `hit`
+     * : [type:uint8] 1 if the ray hit something, otherwise 0
+     *
+     * `fraction`
+     * : [type:float32] the fraction of the hit along the ray, 1 for misses
+     *
+     * `position`
+     * : [type:float32] 3 components, the world position of the hit
+     *
+     * `normal`
+     * : [type:float32] 3 components, the normal of the surface that was hit
+     *
+     * `group`
+     * : [type:uint8] the index in `groups` of the group of the object that was hit, 0 for misses
+     *
+     * @name physics.raycast_batch
+     * @param rays [type:buffer|table] either a buffer with the float32 streams `from` and `to`, with 3 components each,
+     * or a list of rays where each ray is a list `{from, to}` of [type:vector3]
+     * @param groups [type:table] a lua table containing the hashed groups for which to test collisions against
+     * @param [results] [type:buffer] buffer to write the results to, it must have the result streams and at least one element per ray.
+     * It may be the same buffer as `rays`. A new buffer is created if not specified.
+     * @return results [type:buffer] the buffer containing the results
+     * @examples
+     *
+     * How to test line of sight from a number of enemies to the player:
+     *
+     * ```lua
+     * function init(self)
+     *     self.groups = {hash("world")}
+     *     self.rays = buffer.create(#self.enemies, {
+     *         {name=hash("from"), type=buffer.VALUE_TYPE_FLOAT32, count=3},
+     *         {name=hash("to"), type=buffer.VALUE_TYPE_FLOAT32, count=3} })
+     *     self.results = physics.raycast_batch(self.rays, self.groups)
+     * end
+     *
+     * function update(self, dt)
+     *     local from = buffer.get_stream(self.rays, hash("from"))
+     *     local to = buffer.get_stream(self.rays, hash("to"))
+     *     local player = go.get_position("player")
+     *     for i,enemy in ipairs(self.enemies) do
+     *         local p = go.get_position(enemy)
+     *         from[i*3-2], from[i*3-1], from[i*3] = p.x, p.y, p.z
+     *         to[i*3-2], to[i*3-1], to[i*3] = player.x, player.y, player.z
+     *     end
+     *     physics.raycast_batch(self.rays, self.groups, self.results)
+     *     local hits = buffer.get_stream(self.results, hash("hit"))
+     *     for i,enemy in ipairs(self.enemies) do
+     *         local can_see_player = hits[i] == 0
+     *     end
+     * end
+     * ```
+     */
+    static int Physics_RayCastBatch(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+        int top = lua_gettop(L);
+
+        dmMessage::URL sender;
+        if (!dmScript::GetURL(L, &sender)) {
+            return luaL_error(L, "could not find a requesting instance for physics.raycast_batch");
+        }
+
+        dmScript::GetGlobal(L, PHYSICS_CONTEXT_HASH);
+        PhysicsScriptContext* context = (PhysicsScriptContext*)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+
+        dmGameObject::HInstance sender_instance = CheckGoInstance(L);
+        dmGameObject::HCollection collection = dmGameObject::GetCollection(sender_instance);
+        void* world = dmGameObject::GetWorld(collection, context->m_ComponentIndex);
+
+        // The group bits are kept in order, the results refer to the groups by index
+        uint16_t group_bits[16];
+        uint32_t group_count = 0;
+        uint32_t mask = 0;
+        luaL_checktype(L, 2, LUA_TTABLE);
+        uint32_t group_table_size = (uint32_t)lua_objlen(L, 2);
+        for (uint32_t i = 0; i < group_table_size && group_count < sizeof(group_bits) / sizeof(group_bits[0]); ++i)
+        {
+            lua_rawgeti(L, 2, i+1);
+            uint16_t bit = CompCollisionGetGroupBitIndex(world, dmScript::CheckHash(L, -1));
+            lua_pop(L, 1);
+            mask |= bit;
+            group_bits[group_count++] = bit;
+        }
+
+        dmArray<dmPhysics::RayCastRequest>& requests = context->m_BatchRequests;
+        uint32_t ray_count = 0;
+        if (lua_istable(L, 1))
+        {
+            ray_count = (uint32_t)lua_objlen(L, 1);
+            if (requests.Capacity() < ray_count)
+                requests.SetCapacity(ray_count);
+            requests.SetSize(ray_count);
+            for (uint32_t i = 0; i < ray_count; ++i)
+            {
+                lua_rawgeti(L, 1, i+1);
+                luaL_checktype(L, -1, LUA_TTABLE);
+                lua_rawgeti(L, -1, 1);
+                lua_rawgeti(L, -2, 2);
+                dmPhysics::RayCastRequest& request = requests[i];
+                request = dmPhysics::RayCastRequest();
+                request.m_From = Vectormath::Aos::Point3(*dmScript::CheckVector3(L, -2));
+                request.m_To = Vectormath::Aos::Point3(*dmScript::CheckVector3(L, -1));
+                request.m_Mask = mask;
+                lua_pop(L, 3);
+            }
+        }
+        else
+        {
+            dmBuffer::HBuffer rays = UnpackLuaBuffer(dmScript::CheckBuffer(L, 1));
+            uint32_t from_count, from_components, from_stride;
+            uint32_t to_count, to_components, to_stride;
+            const float* from = (const float*)CheckBatchStream(L, rays, "from", dmBuffer::VALUE_TYPE_FLOAT32, 3, &from_count, &from_components, &from_stride);
+            const float* to = (const float*)CheckBatchStream(L, rays, "to", dmBuffer::VALUE_TYPE_FLOAT32, 3, &to_count, &to_components, &to_stride);
+            ray_count = from_count;
+            if (requests.Capacity() < ray_count)
+                requests.SetCapacity(ray_count);
+            requests.SetSize(ray_count);
+            for (uint32_t i = 0; i < ray_count; ++i, from += from_stride, to += to_stride)
+            {
+                dmPhysics::RayCastRequest& request = requests[i];
+                request = dmPhysics::RayCastRequest();
+                request.m_From = Vectormath::Aos::Point3(from[0], from[1], from[2]);
+                request.m_To = Vectormath::Aos::Point3(to[0], to[1], to[2]);
+                request.m_Mask = mask;
+            }
+        }
+
+        dmBuffer::HBuffer results = 0;
+        if (top >= 3 && !lua_isnil(L, 3))
+        {
+            results = UnpackLuaBuffer(dmScript::CheckBuffer(L, 3));
+            uint32_t count = 0;
+            dmBuffer::GetCount(results, &count);
+            if (count < ray_count)
+            {
+                return luaL_error(L, "physics.raycast_batch: the result buffer has %d elements, %d are needed", count, ray_count);
+            }
+            lua_pushvalue(L, 3);
+        }
+        else
+        {
+            if (ray_count == 0)
+            {
+                return luaL_error(L, "physics.raycast_batch: no rays to cast");
+            }
+            const dmBuffer::StreamDeclaration streams_decl[] = {
+                {dmHashString64("hit"), dmBuffer::VALUE_TYPE_UINT8, 1},
+                {dmHashString64("fraction"), dmBuffer::VALUE_TYPE_FLOAT32, 1},
+                {dmHashString64("position"), dmBuffer::VALUE_TYPE_FLOAT32, 3},
+                {dmHashString64("normal"), dmBuffer::VALUE_TYPE_FLOAT32, 3},
+                {dmHashString64("group"), dmBuffer::VALUE_TYPE_UINT8, 1},
+            };
+            dmBuffer::Result r = dmBuffer::Create(ray_count, streams_decl, sizeof(streams_decl) / sizeof(streams_decl[0]), &results);
+            if (r != dmBuffer::RESULT_OK)
+            {
+                return luaL_error(L, "physics.raycast_batch: failed creating result buffer: %s", dmBuffer::GetResultString(r));
+            }
+            dmScript::LuaHBuffer luabuf = { {results}, dmScript::OWNER_LUA };
+            dmScript::PushBuffer(L, luabuf);
+        }
+
+        uint32_t count, components, hit_stride, fraction_stride, position_stride, normal_stride, group_stride;
+        uint8_t* hit = (uint8_t*)CheckBatchStream(L, results, "hit", dmBuffer::VALUE_TYPE_UINT8, 1, &count, &components, &hit_stride);
+        float* fraction = (float*)CheckBatchStream(L, results, "fraction", dmBuffer::VALUE_TYPE_FLOAT32, 1, &count, &components, &fraction_stride);
+        float* position = (float*)CheckBatchStream(L, results, "position", dmBuffer::VALUE_TYPE_FLOAT32, 3, &count, &components, &position_stride);
+        float* normal = (float*)CheckBatchStream(L, results, "normal", dmBuffer::VALUE_TYPE_FLOAT32, 3, &count, &components, &normal_stride);
+        uint8_t* group = (uint8_t*)CheckBatchStream(L, results, "group", dmBuffer::VALUE_TYPE_UINT8, 1, &count, &components, &group_stride);
+
+        dmArray<dmPhysics::RayCastResponse>& responses = context->m_BatchResponses;
+        if (responses.Capacity() < ray_count)
+            responses.SetCapacity(ray_count);
+        responses.SetSize(ray_count);
+        dmGameSystem::RayCastBatch(world, requests.Begin(), ray_count, responses.Begin());
+
+        for (uint32_t i = 0; i < ray_count; ++i)
+        {
+            const dmPhysics::RayCastResponse& response = responses[i];
+            uint8_t group_index = 0;
+            if (response.m_Hit)
+            {
+                for (uint32_t j = 0; j < group_count; ++j)
+                {
+                    if (group_bits[j] & response.m_CollisionObjectGroup)
+                    {
+                        group_index = (uint8_t)(j + 1);
+                        break;
+                    }
+                }
+            }
+
+            hit[i * hit_stride] = response.m_Hit;
+            fraction[i * fraction_stride] = response.m_Hit ? response.m_Fraction : 1.0f;
+            float* p = &position[i * position_stride];
+            p[0] = response.m_Position.getX(); p[1] = response.m_Position.getY(); p[2] = response.m_Position.getZ();
+            float* n = &normal[i * normal_stride];
+            n[0] = response.m_Normal.getX(); n[1] = response.m_Normal.getY(); n[2] = response.m_Normal.getZ();
+            group[i * group_stride] = group_index;
+        }
+
+        return 1;
+    }
+
     // Matches JointResult in physics.h
     static const char* PhysicsResultString[] = {
         "result ok",
@@ -1062,6 +1316,7 @@ namespace dmGameSystem
         {"ray_cast",        Physics_RayCastAsync}, // Deprecated
         {"raycast_async",   Physics_RayCastAsync},
         {"raycast",         Physics_RayCast},
+        {"raycast_batch",   Physics_RayCastBatch},
 
         {"create_joint",    Physics_CreateJoint},
         {"destroy_joint",   Physics_DestroyJoint},
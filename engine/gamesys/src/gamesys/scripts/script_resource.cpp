@@ -644,6 +644,7 @@ static const luaL_reg Module_methods[] =
     // LiveUpdate functionality in resource namespace
     {"get_current_manifest", dmLiveUpdate::Resource_GetCurrentManifest},
     {"store_resource", dmLiveUpdate::Resource_StoreResource},
+    {"store_resources", dmLiveUpdate::Resource_StoreResources},
     {"store_manifest", dmLiveUpdate::Resource_StoreManifest},
 
     {0, 0}
@@ -11,6 +11,8 @@
 // specific language governing permissions and limitations under the License.
 
 #include "script_resource_liveupdate.h"
+#include <stdlib.h>
+#include <string.h>
 #include <liveupdate/liveupdate.h>
 
 #include <script/script.h>
@@ -121,6 +123,127 @@ namespace dmLiveUpdate
         return 0;
     }
 
+    static void Callback_StoreResources(StoreResourcesCallbackData* callback_data)
+    {
+        lua_State* L = (lua_State*) callback_data->m_L;
+        DM_LUA_STACK_CHECK(L, 0);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, callback_data->m_Callback);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, callback_data->m_Self);
+        lua_pushvalue(L, -1);
+
+        dmScript::SetInstance(L);
+        if (dmScript::IsInstanceValid(L))
+        {
+            lua_createtable(L, 0, callback_data->m_Count);
+            for (uint32_t i = 0; i < callback_data->m_Count; ++i)
+            {
+                BatchResource* resource = &callback_data->m_Resources[i];
+                lua_pushlstring(L, resource->m_ExpectedDigest, resource->m_ExpectedDigestLength);
+                lua_pushboolean(L, resource->m_Status);
+                lua_rawset(L, -3);
+            }
+            int ret = lua_pcall(L, 2, 0, 0);
+            if (ret != 0)
+            {
+                dmLogError("Error while running store_resources callback: %s", lua_tostring(L, -1));
+                lua_pop(L, 1);
+            }
+        }
+        else
+        {
+            dmLogError("Could not run store_resources callback since the instance has been deleted.");
+            lua_pop(L, 2);
+        }
+
+        dmScript::Unref(L, LUA_REGISTRYINDEX, callback_data->m_ResourcesRef);
+        dmScript::Unref(L, LUA_REGISTRYINDEX, callback_data->m_Callback);
+        dmScript::Unref(L, LUA_REGISTRYINDEX, callback_data->m_Self);
+        free(callback_data->m_Resources);
+    }
+
+    int Resource_StoreResources(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 0);
+
+        // manifest index in first arg [luaL_checkint(L, 1)] deprecated
+        dmResource::Manifest* manifest = dmLiveUpdate::GetCurrentManifest();
+        if (manifest == 0x0)
+        {
+            return DM_LUA_ERROR("The manifest identifier does not exist");
+        }
+
+        luaL_checktype(L, 2, LUA_TTABLE);
+        luaL_checktype(L, 3, LUA_TFUNCTION);
+
+        // Copy the resources, so that the strings stay referenced until the callback even if the script modifies its table
+        uint32_t count = 0;
+        lua_newtable(L);
+        lua_pushnil(L);
+        while (lua_next(L, 2) != 0)
+        {
+            if (lua_type(L, -2) != LUA_TSTRING || lua_type(L, -1) != LUA_TSTRING)
+            {
+                lua_pop(L, 3);
+                return DM_LUA_ERROR("The resources must be a table of hexdigest and data strings");
+            }
+            lua_pushvalue(L, -2);
+            lua_insert(L, -2);
+            lua_rawset(L, -4);
+            ++count;
+        }
+
+        if (count == 0)
+        {
+            lua_pop(L, 1);
+            return DM_LUA_ERROR("The resources table is empty");
+        }
+
+        BatchResource* resources = (BatchResource*) malloc(count * sizeof(BatchResource));
+        memset(resources, 0, count * sizeof(BatchResource));
+        uint32_t i = 0;
+        lua_pushnil(L);
+        while (lua_next(L, -2) != 0)
+        {
+            size_t hex_digest_length = 0;
+            const char* hex_digest = lua_tolstring(L, -2, &hex_digest_length);
+            size_t buf_len = 0;
+            const char* buf = lua_tolstring(L, -1, &buf_len);
+
+            BatchResource* resource = &resources[i++];
+            resource->m_ExpectedDigest = hex_digest;
+            resource->m_ExpectedDigestLength = (uint32_t) hex_digest_length;
+            if (buf_len < sizeof(dmResourceArchive::LiveUpdateResourceHeader))
+            {
+                dmLogError("The liveupdate resource could not be verified, header information is missing for resource: %s", hex_digest);
+            }
+            else
+            {
+                resource->m_Resource.Set((const uint8_t*) buf, buf_len);
+            }
+            lua_pop(L, 1);
+        }
+
+        dmLiveUpdate::StoreResourcesCallbackData cb;
+        cb.m_ResourcesRef = dmScript::Ref(L, LUA_REGISTRYINDEX);
+        lua_pushvalue(L, 3);
+        cb.m_Callback = dmScript::Ref(L, LUA_REGISTRYINDEX);
+        cb.m_L = dmScript::GetMainThread(L);
+        dmScript::GetInstance(L);
+        cb.m_Self = dmScript::Ref(L, LUA_REGISTRYINDEX);
+
+        dmLiveUpdate::Result res = dmLiveUpdate::StoreResourcesAsync(manifest, resources, count, Callback_StoreResources, cb);
+        if (res != dmLiveUpdate::RESULT_OK)
+        {
+            dmLogError("Failed to queue %u liveupdate resources for storage, result: %i", count, res);
+            dmScript::Unref(L, LUA_REGISTRYINDEX, cb.m_ResourcesRef);
+            dmScript::Unref(L, LUA_REGISTRYINDEX, cb.m_Callback);
+            dmScript::Unref(L, LUA_REGISTRYINDEX, cb.m_Self);
+            free(resources);
+        }
+
+        return 0;
+    }
+
     static void Callback_StoreManifest(StoreManifestCallbackData* callback_data)
     {
         lua_State* L = (lua_State*) callback_data->m_L;
@@ -94,6 +94,59 @@ namespace dmLiveUpdate
      */
     int Resource_StoreResource(lua_State* L);
 
+    /*# add a batch of resources to the data archive and runtime index
+     *
+     * add a batch of resources to the data archive and runtime index. The resources are verified
+     * in parallel and the runtime index is rebuilt once for the whole batch, which is much faster
+     * than storing a large number of resources one by one.
+     *
+     * @name resource.store_resources
+     * @param manifest_reference [type:number] The manifest to check against.
+     * @param resources [type:table] The resources to store, as a table with the expected hexdigest of
+     * each resource as key and the resource data as value.
+     * @param callback [type:function(self, statuses)] The callback
+     * function that is executed once the engine has attempted to store
+     * the resources.
+     *
+     * `self`
+     * : [type:object] The current object.
+     *
+     * `statuses`
+     * : [type:table] Table with the hexdigest of each resource as key, and whether or not the resource
+     * was successfully stored as value.
+     *
+     * @examples
+     *
+     * ```lua
+     * local function callback_store_resources(self, statuses)
+     *      for hexdigest, status in pairs(statuses) do
+     *           if not status then
+     *                print("Failed to store resource: " .. hexdigest)
+     *           end
+     *      end
+     * end
+     *
+     * local function load_resources(self, target)
+     *      local missing = collectionproxy.missing_resources(target)
+     *      local downloaded = {}
+     *      local pending = #missing
+     *      for _, resource_hash in ipairs(missing) do
+     *           local baseurl = "http://example.defold.com:8000/"
+     *           http.request(baseurl .. resource_hash, "GET", function(self, id, response)
+     *                if response.status == 200 then
+     *                     downloaded[resource_hash] = response.response
+     *                end
+     *                pending = pending - 1
+     *                if pending == 0 then
+     *                     resource.store_resources(resource.get_current_manifest(), downloaded, callback_store_resources)
+     *                end
+     *           end)
+     *      end
+     * end
+     * ```
+     */
+    int Resource_StoreResources(lua_State* L);
+
     /*# create, verify, and store a manifest to device
      *
      * Create a new manifest from a buffer. The created manifest is verified
@@ -251,6 +251,41 @@ namespace dmGameSystem
         return 1;
     }
 
+    /*# set mixer group voice limit
+     * Set the max number of sounds in a mixer group that are mixed at once.
+     * When more sounds play, the ones with the lowest priority and gain are
+     * only advanced, without being decoded or mixed, until a voice is free.
+     * The limit can also be set in the "sound.group_voice_limits" game.project setting.
+     *
+     * @name sound.set_group_voice_limit
+     * @param group [type:string|hash] group name
+     * @param limit [type:number] max number of sounds mixed at once, 0 for no limit
+     * @examples
+     *
+     * Mix at most 8 sounds of the "explosions" group at once:
+     *
+     * ```lua
+     * sound.set_group_voice_limit("explosions", 8)
+     * ```
+     */
+    static int Sound_SetGroupVoiceLimit(lua_State* L)
+    {
+        int top = lua_gettop(L);
+        dmhash_t group_hash = CheckGroupName(L, 1);
+        int limit = luaL_checkinteger(L, 2);
+        if (limit < 0) {
+            return luaL_error(L, "The voice limit must be 0 or more, got %d", limit);
+        }
+
+        dmSound::Result r = dmSound::SetGroupVoiceLimit(group_hash, (uint32_t) limit);
+        if (r != dmSound::RESULT_OK) {
+            dmLogWarning("Failed to set group voice limit (%d)", r);
+        }
+
+        assert(top == lua_gettop(L));
+        return 0;
+    }
+
     /*# get all mixer group names
      * Get a table of all mixer group names (hashes).
      *
@@ -635,6 +670,7 @@ namespace dmGameSystem
         {"get_peak", Sound_GetPeak},
         {"set_group_gain", Sound_SetGroupGain},
         {"get_group_gain", Sound_GetGroupGain},
+        {"set_group_voice_limit", Sound_SetGroupVoiceLimit},
         {"get_groups", Sound_GetGroups},
         {"get_group_name", Sound_GetGroupName},
         {"is_phone_call_active", Sound_IsPhoneCallActive},
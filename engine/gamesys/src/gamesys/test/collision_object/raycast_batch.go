@@ -0,0 +1,8 @@
+components {
+  id: "collisionobject"
+  component: "/collision_object/raycast_batch_wall.collisionobject"
+}
+components {
+  id: "script"
+  component: "/collision_object/raycast_batch.script"
+}
@@ -0,0 +1,8 @@
+components {
+  id: "script"
+  component: "/factory/create_batch.script"
+}
+components {
+  id: "factory"
+  component: "/factory/create_batch.factory"
+}
@@ -0,0 +1,4 @@
+components {
+  id: "script"
+  component: "/factory/create_batch_instance.script"
+}
@@ -19,7 +19,10 @@
 
 #include <stdio.h>
 
+#include <dlib/atomic.h>
 #include <dlib/dstrings.h>
+#include <dlib/job_system.h>
+#include <dlib/thread.h>
 #include <dlib/time.h>
 #include <dlib/path.h>
 
@@ -901,6 +904,38 @@ TEST_P(FactoryTest, Test)
     dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
 }
 
+TEST_F(ComponentTest, FactoryCreateBatchTest)
+{
+    /* Setup:
+    ** create_batch
+    ** - [script] factory/create_batch.script
+    ** - [factory] factory/create_batch.factory, with the prototype factory/create_batch_instance.go
+    */
+
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = L;
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/factory/create_batch.goc", dmHashString64("/create_batch"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+
+    // The script creates the batches in its first update, and fails the update if a test fails
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+    lua_getglobal(L, "tests_done");
+    ASSERT_TRUE(lua_toboolean(L, -1));
+    lua_pop(L, 1);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+
+    dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
+}
+
 /* Collection factory dynamic and static loading */
 
 TEST_P(CollectionFactoryTest, Test)
@@ -1120,6 +1155,174 @@ TEST_P(DrawCountTest, DrawCount)
     ASSERT_TRUE(dmGameObject::Final(m_Collection));
 }
 
+/* Instanced sprites */
+
+TEST_F(ComponentTest, InstancedSpriteDrawCount)
+{
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    // Same material, texture and blend mode, so all sprites end up in one batch
+    const uint32_t sprite_count = 16;
+    for (uint32_t i = 0; i < sprite_count; ++i)
+    {
+        char id[16];
+        dmSnPrintf(id, sizeof(id), "/go%u", i);
+        dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/sprite/instanced_sprite.goc", dmHashString64(id), 0, 0, Point3(i * 20.0f, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+        ASSERT_NE((void*)0, go);
+    }
+
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+    // The null device resets its counters on the first draw after a flip
+    dmGraphics::Flip(m_GraphicsContext);
+
+    dmRender::RenderListBegin(m_RenderContext);
+    dmGameObject::Render(m_Collection);
+    dmRender::RenderListEnd(m_RenderContext);
+    dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0);
+
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+    ASSERT_EQ((uint64_t) 1, dmGraphics::GetDrawCount());
+    ASSERT_EQ((uint64_t) sprite_count, dmGraphics::GetDrawInstanceCount());
+    dmGraphics::Flip(m_GraphicsContext);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
+/* Tile grid */
+
+TEST_F(ComponentTest, TileGridSetTileRebuild)
+{
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = L;
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+
+    // set_tile.script clears tile (2,2) in the second frame and sets it again in the third
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/tile/set_tile.goc", dmHashString64("/go"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+
+    const uint64_t expected_vertex_counts[] = {4 * 6, 3 * 6, 4 * 6};
+    for (uint32_t i = 0; i < sizeof(expected_vertex_counts) / sizeof(expected_vertex_counts[0]); ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+
+        // The null device resets its counters on the first draw after a flip
+        dmGraphics::Flip(m_GraphicsContext);
+
+        dmRender::RenderListBegin(m_RenderContext);
+        dmGameObject::Render(m_Collection);
+        dmRender::RenderListEnd(m_RenderContext);
+        dmRender::DrawRenderList(m_RenderContext, 0x0, 0x0);
+
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+        ASSERT_EQ((uint64_t) 1, dmGraphics::GetDrawCount());
+        ASSERT_EQ(expected_vertex_counts[i], dmGraphics::GetDrawVertexCount());
+    }
+    dmGraphics::Flip(m_GraphicsContext);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+
+    dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
+}
+
+/* Thread safe updates */
+
+static dmThread::Thread                 g_UpdatingThread;
+static dmGameObject::ComponentsUpdate   g_ThreadSafeUpdates[2];
+static int32_atomic_t                   g_ThreadSafeUpdating[2];
+static int32_atomic_t                   g_ThreadSafeOverlapCount;
+static int32_atomic_t                   g_ThreadSafeWorkerCount;
+
+// Waits a little while for the other type in the stage to start updating, which only happens when the stage is updated concurrently
+template <int INDEX>
+static dmGameObject::UpdateResult ConcurrentComponentsUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
+{
+    if (dmThread::GetCurrentThread() != g_UpdatingThread)
+        dmAtomicIncrement32(&g_ThreadSafeWorkerCount);
+
+    dmAtomicStore32(&g_ThreadSafeUpdating[INDEX], 1);
+    uint64_t timeout = dmTime::GetTime() + 50000;
+    while (dmAtomicAdd32(&g_ThreadSafeUpdating[1 - INDEX], 0) == 0 && dmTime::GetTime() < timeout)
+    {
+        dmTime::Sleep(100);
+    }
+    if (dmAtomicAdd32(&g_ThreadSafeUpdating[1 - INDEX], 0) != 0)
+        dmAtomicIncrement32(&g_ThreadSafeOverlapCount);
+
+    dmGameObject::UpdateResult result = g_ThreadSafeUpdates[INDEX](params, update_result);
+    dmAtomicStore32(&g_ThreadSafeUpdating[INDEX], 0);
+    return result;
+}
+
+static dmGameObject::ComponentType* GetComponentType(dmResource::HFactory factory, dmGameObject::HRegister regist, const char* extension)
+{
+    dmResource::ResourceType resource_type;
+    if (dmResource::GetTypeFromExtension(factory, extension, &resource_type) != dmResource::RESULT_OK)
+        return 0;
+    return dmGameObject::FindComponentType(regist, resource_type, 0x0);
+}
+
+TEST_F(ComponentTest, ThreadSafeUpdate)
+{
+    const char* thread_safe_types[] = {"spritec", "tilemapc", "spinemodelc", "labelc", "particlefxc"};
+    for (uint32_t i = 0; i < sizeof(thread_safe_types) / sizeof(thread_safe_types[0]); ++i)
+    {
+        dmGameObject::ComponentType* type = GetComponentType(m_Factory, m_Register, thread_safe_types[i]);
+        ASSERT_NE((void*)0, type);
+        ASSERT_TRUE(type->m_ThreadSafeUpdate);
+        ASSERT_EQ(0u, (uint32_t)(type->m_UpdateAccess & dmGameObject::UPDATE_ACCESS_EXCLUSIVE));
+    }
+    ASSERT_FALSE(GetComponentType(m_Factory, m_Register, "scriptc")->m_ThreadSafeUpdate);
+
+    // Sprites and tile grids only read transforms, so they share an update stage
+    dmGameObject::ComponentType* sprite_type = GetComponentType(m_Factory, m_Register, "spritec");
+    dmGameObject::ComponentType* tilegrid_type = GetComponentType(m_Factory, m_Register, "tilemapc");
+    g_ThreadSafeUpdates[0] = sprite_type->m_UpdateFunction;
+    g_ThreadSafeUpdates[1] = tilegrid_type->m_UpdateFunction;
+    sprite_type->m_UpdateFunction = ConcurrentComponentsUpdate<0>;
+    tilegrid_type->m_UpdateFunction = ConcurrentComponentsUpdate<1>;
+
+    ASSERT_TRUE(dmGameObject::Init(m_Collection));
+    dmGameObject::HInstance sprite_go = Spawn(m_Factory, m_Collection, "/sprite/valid_sprite.goc", dmHashString64("/sprite"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, sprite_go);
+    dmGameObject::HInstance tilegrid_go = Spawn(m_Factory, m_Collection, "/tile/valid_tilegrid.goc", dmHashString64("/tilegrid"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, tilegrid_go);
+
+    dmJobSystem::NewContextParams job_params;
+    job_params.m_WorkerCount = 2;
+    dmJobSystem::HContext job_system = dmJobSystem::New(job_params);
+    dmGameObject::SetJobSystem(m_Register, job_system);
+
+    g_UpdatingThread = dmThread::GetCurrentThread();
+    g_ThreadSafeOverlapCount = 0;
+    g_ThreadSafeWorkerCount = 0;
+    const uint32_t update_count = 20;
+    for (uint32_t i = 0; i < update_count; ++i)
+    {
+        ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+        ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+    }
+
+    dmGameObject::SetJobSystem(m_Register, 0);
+    dmJobSystem::Delete(job_system);
+
+    sprite_type->m_UpdateFunction = g_ThreadSafeUpdates[0];
+    tilegrid_type->m_UpdateFunction = g_ThreadSafeUpdates[1];
+
+    ASSERT_LT(0, g_ThreadSafeWorkerCount);
+    ASSERT_LT(0, g_ThreadSafeOverlapCount);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+}
+
 /* Physics joints */
 TEST_F(ComponentTest, JointTest)
 {
@@ -1169,6 +1372,39 @@ TEST_F(ComponentTest, JointTest)
 
 }
 
+/* Physics ray cast batch */
+TEST_F(ComponentTest, RayCastBatchTest)
+{
+    /* Setup:
+    ** raycast_batch
+    ** - [collisionobject] collision_object/raycast_batch_wall.collisionobject
+    ** - [script] collision_object/raycast_batch.script
+    */
+
+    lua_State* L = dmScript::GetLuaState(m_ScriptContext);
+
+    dmGameSystem::ScriptLibContext scriptlibcontext;
+    scriptlibcontext.m_Factory = m_Factory;
+    scriptlibcontext.m_Register = m_Register;
+    scriptlibcontext.m_LuaState = L;
+    dmGameSystem::InitializeScriptLibs(scriptlibcontext);
+
+    dmGameObject::HInstance go = Spawn(m_Factory, m_Collection, "/collision_object/raycast_batch.goc", dmHashString64("/raycast_batch"), 0, 0, Point3(0, 0, 0), Quat(0, 0, 0, 1), Vector3(1, 1, 1));
+    ASSERT_NE((void*)0, go);
+
+    // The script casts the rays in its first update, and fails the update if a test fails
+    ASSERT_TRUE(dmGameObject::Update(m_Collection, &m_UpdateContext));
+    ASSERT_TRUE(dmGameObject::PostUpdate(m_Collection));
+
+    lua_getglobal(L, "tests_done");
+    ASSERT_TRUE(lua_toboolean(L, -1));
+    lua_pop(L, 1);
+
+    ASSERT_TRUE(dmGameObject::Final(m_Collection));
+
+    dmGameSystem::FinalizeScriptLibs(scriptlibcontext);
+}
+
 /* Camera */
 
 const char* valid_camera_resources[] = {"/camera/valid.camerac"};
@@ -1713,6 +1949,7 @@ DrawCountParams draw_count_params[] =
 {
     {"/gui/draw_count_test.goc", 2},
     {"/gui/draw_count_test2.goc", 1},
+    {"/tile/valid_tilegrid.goc", 1},
 };
 INSTANTIATE_TEST_CASE_P(DrawCount, DrawCountTest, jc_test_values_in(draw_count_params));
 
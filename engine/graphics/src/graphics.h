@@ -614,6 +614,27 @@ namespace dmGraphics
     void DrawElements(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer);
     void Draw(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count);
 
+    /**
+     * Check if instanced drawing is supported by the context
+     * @param context Graphics context handle
+     * @return true if instancing is supported
+     */
+    bool IsInstancingSupported(HContext context);
+
+    /**
+     * Enable a vertex declaration whose streams advance once per instance instead of once per vertex.
+     * Used together with a regular vertex declaration and DrawElementsInstanced/DrawInstanced.
+     * @param context Graphics context handle
+     * @param vertex_declaration Vertex declaration of the per-instance data
+     * @param vertex_buffer Buffer with the per-instance data
+     * @param buffer_offset Byte offset of the first instance in the buffer
+     * @param program Program the streams are bound to, by attribute name
+     */
+    void EnableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration, HVertexBuffer vertex_buffer, uint32_t buffer_offset, HProgram program);
+    void DisableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration);
+    void DrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count);
+    void DrawInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, uint32_t instance_count);
+
     HVertexProgram NewVertexProgram(HContext context, ShaderDesc::Shader* ddf);
     HFragmentProgram NewFragmentProgram(HContext context, ShaderDesc::Shader* ddf);
     HProgram NewProgram(HContext context, HVertexProgram vertex_program, HFragmentProgram fragment_program);
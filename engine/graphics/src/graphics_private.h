@@ -19,6 +19,8 @@
 namespace dmGraphics
 {
     uint64_t GetDrawCount();
+    uint64_t GetDrawInstanceCount();
+    uint64_t GetDrawVertexCount();
     void SetForceFragmentReloadFail(bool should_fail);
     void SetForceVertexReloadFail(bool should_fail);
     uint32_t GetTextureFormatBPP(TextureFormat format);
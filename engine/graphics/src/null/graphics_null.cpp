@@ -28,6 +28,8 @@
 using namespace Vectormath::Aos;
 
 uint64_t g_DrawCount = 0;
+uint64_t g_DrawInstanceCount = 0;
+uint64_t g_DrawVertexCount = 0;
 uint64_t g_Flipped = 0;
 
 // Used only for tests
@@ -610,6 +612,8 @@ namespace dmGraphics
             VertexStream& vs = context->m_VertexStreams[i];
             if (vs.m_Size > 0)
             {
+                // The declaration may stay enabled over several draws
+                delete [] (char*)vs.m_Buffer;
                 vs.m_Buffer = new char[vs.m_Size * count];
             }
         }
@@ -628,8 +632,11 @@ namespace dmGraphics
         {
             g_Flipped = 0;
             g_DrawCount = 0;
+            g_DrawInstanceCount = 0;
+            g_DrawVertexCount = 0;
         }
         g_DrawCount++;
+        g_DrawVertexCount += count;
     }
 
     static void NullDraw(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count)
@@ -640,8 +647,84 @@ namespace dmGraphics
         {
             g_Flipped = 0;
             g_DrawCount = 0;
+            g_DrawInstanceCount = 0;
+            g_DrawVertexCount = 0;
         }
         g_DrawCount++;
+        g_DrawVertexCount += count;
+    }
+
+    static bool NullIsInstancingSupported(HContext context)
+    {
+        return true;
+    }
+
+    static void NullEnableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration, HVertexBuffer vertex_buffer, uint32_t buffer_offset, HProgram program)
+    {
+        assert(context);
+        assert(vertex_declaration);
+        assert(vertex_buffer);
+        VertexBuffer* vb = (VertexBuffer*)vertex_buffer;
+        uint16_t stride = 0;
+        for (uint32_t i = 0; i < vertex_declaration->m_Count; ++i)
+            stride += vertex_declaration->m_Elements[i].m_Size * TYPE_SIZE[vertex_declaration->m_Elements[i].m_Type - dmGraphics::TYPE_BYTE];
+        uint32_t offset = buffer_offset;
+        for (uint16_t i = 0; i < vertex_declaration->m_Count; ++i)
+        {
+            VertexElement& ve = vertex_declaration->m_Elements[i];
+            if (ve.m_Size > 0)
+            {
+                VertexStream& s = context->m_InstanceStreams[i];
+                assert(s.m_Source == 0x0);
+                s.m_Source = &vb->m_Buffer[offset];
+                s.m_Size = ve.m_Size * TYPE_SIZE[ve.m_Type - dmGraphics::TYPE_BYTE];
+                s.m_Stride = stride;
+                offset += s.m_Size;
+            }
+        }
+    }
+
+    static void NullDisableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration)
+    {
+        assert(context);
+        assert(vertex_declaration);
+        for (uint32_t i = 0; i < vertex_declaration->m_Count; ++i)
+        {
+            VertexStream& s = context->m_InstanceStreams[i];
+            delete [] (char*)s.m_Buffer;
+            s.m_Buffer = 0x0;
+            s.m_Source = 0x0;
+            s.m_Size = 0;
+        }
+    }
+
+    // Read the per-instance data, as a driver would
+    static void ReadInstanceStreams(HContext context, uint32_t instance_count)
+    {
+        for (uint32_t i = 0; i < MAX_VERTEX_STREAM_COUNT; ++i)
+        {
+            VertexStream& s = context->m_InstanceStreams[i];
+            if (s.m_Size == 0)
+                continue;
+
+            delete [] (char*)s.m_Buffer;
+            s.m_Buffer = new char[s.m_Size * instance_count];
+            for (uint32_t j = 0; j < instance_count; ++j)
+                memcpy(&((char*)s.m_Buffer)[j * s.m_Size], &((char*)s.m_Source)[j * s.m_Stride], s.m_Size);
+        }
+        g_DrawInstanceCount += instance_count;
+    }
+
+    static void NullDrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
+    {
+        NullDrawElements(context, prim_type, first, count, type, index_buffer);
+        ReadInstanceStreams(context, instance_count);
+    }
+
+    static void NullDrawInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, uint32_t instance_count)
+    {
+        NullDraw(context, prim_type, first, count);
+        ReadInstanceStreams(context, instance_count);
     }
 
     // For tests
@@ -650,6 +733,16 @@ namespace dmGraphics
         return g_DrawCount;
     }
 
+    uint64_t GetDrawInstanceCount()
+    {
+        return g_DrawInstanceCount;
+    }
+
+    uint64_t GetDrawVertexCount()
+    {
+        return g_DrawVertexCount;
+    }
+
     struct VertexProgram
     {
         char* m_Data;
@@ -1256,6 +1349,11 @@ namespace dmGraphics
         fn_table.m_HashVertexDeclaration = NullHashVertexDeclaration;
         fn_table.m_DrawElements = NullDrawElements;
         fn_table.m_Draw = NullDraw;
+        fn_table.m_IsInstancingSupported = NullIsInstancingSupported;
+        fn_table.m_EnableInstanceVertexDeclaration = NullEnableInstanceVertexDeclaration;
+        fn_table.m_DisableInstanceVertexDeclaration = NullDisableInstanceVertexDeclaration;
+        fn_table.m_DrawElementsInstanced = NullDrawElementsInstanced;
+        fn_table.m_DrawInstanced = NullDrawInstanced;
         fn_table.m_NewVertexProgram = NullNewVertexProgram;
         fn_table.m_NewFragmentProgram = NullNewFragmentProgram;
         fn_table.m_NewProgram = NullNewProgram;
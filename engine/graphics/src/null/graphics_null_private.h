@@ -80,6 +80,7 @@ namespace dmGraphics
         Context(const ContextParams& params);
 
         VertexStream                m_VertexStreams[MAX_VERTEX_STREAM_COUNT];
+        VertexStream                m_InstanceStreams[MAX_VERTEX_STREAM_COUNT];
         Vectormath::Aos::Vector4    m_ProgramRegisters[MAX_REGISTER_COUNT];
         HTexture                    m_Textures[MAX_TEXTURE_COUNT];
         FrameBuffer                 m_MainFrameBuffer;
@@ -301,6 +301,12 @@ static void LogFrameBufferError(GLenum status)
     // The alternative is a matrix of conditional typedefs, linked statically/dynamically or core. OpenGL function prototypes does not change, so this is safe.
     typedef void (* DM_PFNGLINVALIDATEFRAMEBUFFERPROC) (GLenum target, GLsizei numAttachments, const GLenum *attachments);
     DM_PFNGLINVALIDATEFRAMEBUFFERPROC PFN_glInvalidateFramebuffer = NULL;
+    typedef void (* DM_PFNGLVERTEXATTRIBDIVISORPROC) (GLuint index, GLuint divisor);
+    DM_PFNGLVERTEXATTRIBDIVISORPROC PFN_glVertexAttribDivisor = NULL;
+    typedef void (* DM_PFNGLDRAWARRAYSINSTANCEDPROC) (GLenum mode, GLint first, GLsizei count, GLsizei primcount);
+    DM_PFNGLDRAWARRAYSINSTANCEDPROC PFN_glDrawArraysInstanced = NULL;
+    typedef void (* DM_PFNGLDRAWELEMENTSINSTANCEDPROC) (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount);
+    DM_PFNGLDRAWELEMENTSINSTANCEDPROC PFN_glDrawElementsInstanced = NULL;
 
     Context* g_Context = 0x0;
 
@@ -856,6 +862,13 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
 #endif
 
         DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glInvalidateFramebuffer, "glDiscardFramebuffer", "discard_framebuffer", "glInvalidateFramebuffer", DM_PFNGLINVALIDATEFRAMEBUFFERPROC, extensions);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glVertexAttribDivisor, "glVertexAttribDivisor", "instanced_arrays", "glVertexAttribDivisor", DM_PFNGLVERTEXATTRIBDIVISORPROC, extensions);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glDrawArraysInstanced, "glDrawArraysInstanced", "draw_instanced", "glDrawArraysInstanced", DM_PFNGLDRAWARRAYSINSTANCEDPROC, extensions);
+        DMGRAPHICS_GET_PROC_ADDRESS_EXT(PFN_glDrawElementsInstanced, "glDrawElementsInstanced", "draw_instanced", "glDrawElementsInstanced", DM_PFNGLDRAWELEMENTSINSTANCEDPROC, extensions);
+        if (PFN_glVertexAttribDivisor != NULL && PFN_glDrawArraysInstanced != NULL && PFN_glDrawElementsInstanced != NULL)
+        {
+            context->m_InstancingSupport = 1;
+        }
 
         if (IsExtensionSupported("GL_IMG_texture_compression_pvrtc", extensions))
         {
@@ -1468,6 +1481,95 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         CHECK_GL_ERROR
     }
 
+    static bool OpenGLIsInstancingSupported(HContext context)
+    {
+        assert(context);
+        return context->m_InstancingSupport;
+    }
+
+    static void OpenGLEnableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration, HVertexBuffer vertex_buffer, uint32_t buffer_offset, HProgram program)
+    {
+        assert(context);
+        assert(vertex_buffer);
+        assert(vertex_declaration);
+        assert(context->m_InstancingSupport);
+
+        if (!(context->m_ModificationVersion == vertex_declaration->m_ModificationVersion && vertex_declaration->m_BoundForProgram == program))
+        {
+            BindVertexDeclarationProgram(context, vertex_declaration, program);
+        }
+
+        #define BUFFER_OFFSET(i) ((char*)0x0 + (i))
+
+        glBindBufferARB(GL_ARRAY_BUFFER, vertex_buffer);
+        CHECK_GL_ERROR;
+
+        for (uint32_t i=0; i<vertex_declaration->m_StreamCount; i++)
+        {
+            if (vertex_declaration->m_Streams[i].m_PhysicalIndex != -1)
+            {
+                glEnableVertexAttribArray(vertex_declaration->m_Streams[i].m_PhysicalIndex);
+                CHECK_GL_ERROR;
+                glVertexAttribPointer(
+                        vertex_declaration->m_Streams[i].m_PhysicalIndex,
+                        vertex_declaration->m_Streams[i].m_Size,
+                        GetOpenGLType(vertex_declaration->m_Streams[i].m_Type),
+                        vertex_declaration->m_Streams[i].m_Normalize,
+                        vertex_declaration->m_Stride,
+                BUFFER_OFFSET(buffer_offset + vertex_declaration->m_Streams[i].m_Offset) );
+                CHECK_GL_ERROR;
+                // Advance the attribute once per instance instead of once per vertex
+                PFN_glVertexAttribDivisor(vertex_declaration->m_Streams[i].m_PhysicalIndex, 1);
+                CHECK_GL_ERROR;
+            }
+        }
+
+        #undef BUFFER_OFFSET
+    }
+
+    static void OpenGLDisableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration)
+    {
+        assert(context);
+        assert(vertex_declaration);
+
+        for (uint32_t i=0; i<vertex_declaration->m_StreamCount; i++)
+        {
+            if (vertex_declaration->m_Streams[i].m_PhysicalIndex != -1)
+            {
+                PFN_glVertexAttribDivisor(vertex_declaration->m_Streams[i].m_PhysicalIndex, 0);
+                CHECK_GL_ERROR;
+                glDisableVertexAttribArray(vertex_declaration->m_Streams[i].m_PhysicalIndex);
+                CHECK_GL_ERROR;
+            }
+        }
+
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+        CHECK_GL_ERROR;
+    }
+
+    static void OpenGLDrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
+    {
+        assert(context);
+        assert(index_buffer);
+        DM_PROFILE(Graphics, "DrawElementsInstanced");
+        DM_COUNTER("DrawCalls", 1);
+
+        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+        CHECK_GL_ERROR;
+
+        PFN_glDrawElementsInstanced(GetOpenGLPrimitiveType(prim_type), count, GetOpenGLType(type), (GLvoid*)(uintptr_t) first, instance_count);
+        CHECK_GL_ERROR
+    }
+
+    static void OpenGLDrawInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, uint32_t instance_count)
+    {
+        assert(context);
+        DM_PROFILE(Graphics, "DrawInstanced");
+        DM_COUNTER("DrawCalls", 1);
+        PFN_glDrawArraysInstanced(GetOpenGLPrimitiveType(prim_type), first, count, instance_count);
+        CHECK_GL_ERROR
+    }
+
     static uint32_t CreateShader(GLenum type, const void* program, uint32_t program_size)
     {
         GLuint s = glCreateShader(type);
@@ -2794,6 +2896,11 @@ static uintptr_t GetExtProcAddress(const char* name, const char* extension_name,
         fn_table.m_HashVertexDeclaration = OpenGLHashVertexDeclaration;
         fn_table.m_DrawElements = OpenGLDrawElements;
         fn_table.m_Draw = OpenGLDraw;
+        fn_table.m_IsInstancingSupported = OpenGLIsInstancingSupported;
+        fn_table.m_EnableInstanceVertexDeclaration = OpenGLEnableInstanceVertexDeclaration;
+        fn_table.m_DisableInstanceVertexDeclaration = OpenGLDisableInstanceVertexDeclaration;
+        fn_table.m_DrawElementsInstanced = OpenGLDrawElementsInstanced;
+        fn_table.m_DrawInstanced = OpenGLDrawInstanced;
         fn_table.m_NewVertexProgram = OpenGLNewVertexProgram;
         fn_table.m_NewFragmentProgram = OpenGLNewFragmentProgram;
         fn_table.m_NewProgram = OpenGLNewProgram;
@@ -327,6 +327,60 @@ TEST_F(dmGraphicsTest, Drawing)
     dmGraphics::DeleteVertexDeclaration(vd);
 }
 
+TEST_F(dmGraphicsTest, DrawingInstanced)
+{
+    ASSERT_TRUE(dmGraphics::IsInstancingSupported(m_Context));
+
+    float v[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+    uint16_t i[] = { 0, 1, 2 };
+    // Leading padding to exercise the buffer offset
+    float inst[] = { -1.0f, -1.0f, -1.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f };
+
+    dmGraphics::VertexElement ve[] =
+    {
+        {"position", 0, 2, dmGraphics::TYPE_FLOAT, false },
+    };
+    dmGraphics::VertexElement ive[] =
+    {
+        {"instance_position", 0, 3, dmGraphics::TYPE_FLOAT, false },
+    };
+    dmGraphics::HVertexDeclaration vd = dmGraphics::NewVertexDeclaration(m_Context, ve, 1);
+    dmGraphics::HVertexDeclaration ivd = dmGraphics::NewVertexDeclaration(m_Context, ive, 1);
+    dmGraphics::HVertexBuffer vb = dmGraphics::NewVertexBuffer(m_Context, sizeof(v), v, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+    dmGraphics::HVertexBuffer ivb = dmGraphics::NewVertexBuffer(m_Context, sizeof(inst), inst, dmGraphics::BUFFER_USAGE_STREAM_DRAW);
+    dmGraphics::HIndexBuffer ib = dmGraphics::NewIndexBuffer(m_Context, sizeof(i), i, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+
+    dmGraphics::Flip(m_Context);
+
+    dmGraphics::EnableVertexDeclaration(m_Context, vd, vb);
+    dmGraphics::EnableInstanceVertexDeclaration(m_Context, ivd, ivb, 3 * sizeof(float), 0);
+    dmGraphics::DrawElementsInstanced(m_Context, dmGraphics::PRIMITIVE_TRIANGLES, 0, 3, dmGraphics::TYPE_UNSIGNED_SHORT, ib, 3);
+
+    const float* read = (const float*)m_Context->m_InstanceStreams[0].m_Buffer;
+    for (uint32_t n = 0; n < 9; ++n)
+        ASSERT_EQ(inst[3 + n], read[n]);
+
+    dmGraphics::DisableInstanceVertexDeclaration(m_Context, ivd);
+    dmGraphics::DisableVertexDeclaration(m_Context, vd);
+    ASSERT_EQ(0u, m_Context->m_InstanceStreams[0].m_Size);
+
+    dmGraphics::EnableVertexDeclaration(m_Context, vd, vb);
+    dmGraphics::EnableInstanceVertexDeclaration(m_Context, ivd, ivb, 0, 0);
+    dmGraphics::DrawInstanced(m_Context, dmGraphics::PRIMITIVE_TRIANGLES, 0, 3, 2);
+    dmGraphics::DisableInstanceVertexDeclaration(m_Context, ivd);
+    dmGraphics::DisableVertexDeclaration(m_Context, vd);
+
+    // One draw call per batch, regardless of the number of instances
+    ASSERT_EQ(2u, dmGraphics::GetDrawCount());
+    ASSERT_EQ(5u, dmGraphics::GetDrawInstanceCount());
+
+    dmGraphics::DeleteIndexBuffer(ib);
+    dmGraphics::DeleteVertexBuffer(ivb);
+    dmGraphics::DeleteVertexBuffer(vb);
+    dmGraphics::DeleteVertexDeclaration(ivd);
+    dmGraphics::DeleteVertexDeclaration(vd);
+}
+
 static inline dmGraphics::ShaderDesc::Shader MakeDDFShader(const char* data, uint32_t count)
 {
     dmGraphics::ShaderDesc::Shader ddf;
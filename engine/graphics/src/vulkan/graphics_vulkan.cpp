@@ -2249,6 +2249,33 @@ bail:
         vkCmdDraw(vk_command_buffer, count, 1, first, 0);
     }
 
+    // Per-instance vertex input needs a second binding in the pipeline vertex input state,
+    // which the pipeline cache does not support yet. Callers must check IsInstancingSupported.
+    static bool VulkanIsInstancingSupported(HContext context)
+    {
+        return false;
+    }
+
+    static void VulkanEnableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration, HVertexBuffer vertex_buffer, uint32_t buffer_offset, HProgram program)
+    {
+        assert(0 && "Instancing is not supported");
+    }
+
+    static void VulkanDisableInstanceVertexDeclaration(HContext context, HVertexDeclaration vertex_declaration)
+    {
+        assert(0 && "Instancing is not supported");
+    }
+
+    static void VulkanDrawElementsInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, Type type, HIndexBuffer index_buffer, uint32_t instance_count)
+    {
+        assert(0 && "Instancing is not supported");
+    }
+
+    static void VulkanDrawInstanced(HContext context, PrimitiveType prim_type, uint32_t first, uint32_t count, uint32_t instance_count)
+    {
+        assert(0 && "Instancing is not supported");
+    }
+
     static void CreateShaderResourceBindings(ShaderModule* shader, ShaderDesc::Shader* ddf, uint32_t dynamicAlignment)
     {
         if (ddf->m_Uniforms.m_Count > 0)
@@ -3617,6 +3644,11 @@ bail:
         fn_table.m_HashVertexDeclaration = VulkanHashVertexDeclaration;
         fn_table.m_DrawElements = VulkanDrawElements;
         fn_table.m_Draw = VulkanDraw;
+        fn_table.m_IsInstancingSupported = VulkanIsInstancingSupported;
+        fn_table.m_EnableInstanceVertexDeclaration = VulkanEnableInstanceVertexDeclaration;
+        fn_table.m_DisableInstanceVertexDeclaration = VulkanDisableInstanceVertexDeclaration;
+        fn_table.m_DrawElementsInstanced = VulkanDrawElementsInstanced;
+        fn_table.m_DrawInstanced = VulkanDrawInstanced;
         fn_table.m_NewVertexProgram = VulkanNewVertexProgram;
         fn_table.m_NewFragmentProgram = VulkanNewFragmentProgram;
         fn_table.m_NewProgram = VulkanNewProgram;
@@ -17,7 +17,9 @@
 
 #include <ddf/ddf.h>
 
+#include <dlib/job_system.h>
 #include <dlib/log.h>
+#include <dlib/math.h>
 #include <dlib/time.h>
 #include <dlib/sys.h>
 
@@ -77,6 +79,10 @@ namespace dmLiveUpdate
     LiveUpdate g_LiveUpdate;
     /// Resource system factory
     static dmResource::HFactory m_ResourceFactory = 0x0;
+    /// Smallest number of resources hashed by a single job
+    static const uint32_t VERIFY_BATCH_MIN_SIZE = 8;
+    /// Max number of worker threads hashing a batch, the game keeps the other cores
+    static const uint32_t VERIFY_BATCH_MAX_WORKERS = 2;
 
     /** ***********************************************************************
      ** LiveUpdate utility functions
@@ -120,6 +126,16 @@ namespace dmLiveUpdate
         return uniqueCount;
     }
 
+    static bool VerifyDigest(dmLiveUpdateDDF::HashAlgorithm algorithm, const uint8_t* digest, const char* expected, uint32_t expectedLength)
+    {
+        uint32_t hexDigestLength = dmResource::HashLength(algorithm) * 2 + 1;
+        char* hexDigest = (char*) alloca(hexDigestLength * sizeof(char));
+
+        dmResource::BytesToHexString(digest, dmResource::HashLength(algorithm), hexDigest, hexDigestLength);
+
+        return dmResource::HashCompare((const uint8_t*)hexDigest, hexDigestLength-1, (const uint8_t*)expected, expectedLength) == dmResource::RESULT_OK;
+    }
+
     bool VerifyResource(dmResource::Manifest* manifest, const char* expected, uint32_t expectedLength, const dmResourceArchive::LiveUpdateResource* resource)
     {
         if (manifest == 0x0 || resource->m_Data == 0x0)
@@ -127,21 +143,13 @@ namespace dmLiveUpdate
             return false;
         }
 
-        bool result = true;
         dmLiveUpdateDDF::HashAlgorithm algorithm = manifest->m_DDFData->m_Header.m_ResourceHashAlgorithm;
         uint32_t digestLength = dmResource::HashLength(algorithm);
         uint8_t* digest = (uint8_t*) alloca(digestLength * sizeof(uint8_t));
 
         CreateResourceHash(algorithm, (const char*)resource->m_Data, resource->m_Count, digest);
 
-        uint32_t hexDigestLength = digestLength * 2 + 1;
-        char* hexDigest = (char*) alloca(hexDigestLength * sizeof(char));
-
-        dmResource::BytesToHexString(digest, dmResource::HashLength(algorithm), hexDigest, hexDigestLength);
-
-        result = dmResource::HashCompare((const uint8_t*)hexDigest, hexDigestLength-1, (const uint8_t*)expected, expectedLength) == dmResource::RESULT_OK;
-
-        return result;
+        return VerifyDigest(algorithm, digest, expected, expectedLength);
     }
 
     static bool VerifyManifestSupportedEngineVersion(dmResource::Manifest* manifest)
@@ -243,6 +251,25 @@ namespace dmLiveUpdate
         return res == true ? RESULT_OK : RESULT_INVALID_RESOURCE;
     }
 
+    Result StoreResourcesAsync(dmResource::Manifest* manifest, BatchResource* resources, uint32_t count, void (*callback)(StoreResourcesCallbackData*), StoreResourcesCallbackData& callback_data)
+    {
+        if (manifest == 0x0 || resources == 0x0 || count == 0)
+        {
+            return RESULT_MEM_ERROR;
+        }
+
+        AsyncResourceRequest request;
+        request.m_Manifest = manifest;
+        request.m_BatchResources = resources;
+        request.m_BatchCount = count;
+        request.m_BatchCallbackData = callback_data;
+        request.m_BatchCallbackData.m_Resources = resources;
+        request.m_BatchCallbackData.m_Count = count;
+        request.m_BatchCallback = callback;
+        bool res = AddAsyncResourceRequest(request);
+        return res == true ? RESULT_OK : RESULT_INVALID_RESOURCE;
+    }
+
     Result NewArchiveIndexWithResource(dmResource::Manifest* manifest, const char* expected_digest, const uint32_t expected_digest_length, const dmResourceArchive::LiveUpdateResource* resource, dmResourceArchive::HArchiveIndex& out_new_index)
     {
         out_new_index = 0x0;
@@ -265,6 +292,105 @@ namespace dmLiveUpdate
         return (res == dmResource::RESULT_OK) ? RESULT_OK : RESULT_INVALID_RESOURCE;
     }
 
+    struct VerifyBatchContext
+    {
+        dmLiveUpdateDDF::HashAlgorithm m_Algorithm;
+        BatchResource*                 m_Resources;
+        uint8_t*                       m_Digests;
+        uint32_t                       m_DigestLength;
+    };
+
+    static void VerifyBatchRange(void* context, uint32_t begin, uint32_t end)
+    {
+        VerifyBatchContext* ctx = (VerifyBatchContext*) context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            BatchResource* resource = &ctx->m_Resources[i];
+            resource->m_Status = false;
+            if (resource->m_Resource.m_Header == 0x0 || resource->m_Resource.m_Data == 0x0)
+            {
+                continue;
+            }
+            uint8_t* digest = ctx->m_Digests + i * ctx->m_DigestLength;
+            CreateResourceHash(ctx->m_Algorithm, (const char*)resource->m_Resource.m_Data, resource->m_Resource.m_Count, digest);
+            resource->m_Status = VerifyDigest(ctx->m_Algorithm, digest, resource->m_ExpectedDigest, resource->m_ExpectedDigestLength);
+        }
+    }
+
+    Result NewArchiveIndexWithResources(dmResource::Manifest* manifest, BatchResource* resources, uint32_t count, dmResourceArchive::HArchiveIndex& out_new_index)
+    {
+        out_new_index = 0x0;
+
+        dmLiveUpdateDDF::HashAlgorithm algorithm = manifest->m_DDFData->m_Header.m_ResourceHashAlgorithm;
+        uint32_t digestLength = dmResource::HashLength(algorithm);
+        uint8_t* digests = (uint8_t*) malloc(count * digestLength);
+
+        // Hash the resources in parallel, the digests are then reused as archive index keys
+        VerifyBatchContext ctx;
+        ctx.m_Algorithm = algorithm;
+        ctx.m_Resources = resources;
+        ctx.m_Digests = digests;
+        ctx.m_DigestLength = digestLength;
+        if (count >= 2 * VERIFY_BATCH_MIN_SIZE)
+        {
+            // The batch gets a job system of its own. With the engine's job system, the hashing would end up on
+            // the main thread, and this thread would pick up game object jobs while waiting.
+            dmJobSystem::NewContextParams job_system_params;
+            job_system_params.m_WorkerCount = dmMath::Min(job_system_params.m_WorkerCount, VERIFY_BATCH_MAX_WORKERS);
+            job_system_params.m_MaxJobs = 64;
+            dmJobSystem::HContext job_system = dmJobSystem::New(job_system_params);
+            dmJobSystem::ParallelFor(job_system, VerifyBatchRange, &ctx, count, VERIFY_BATCH_MIN_SIZE);
+            dmJobSystem::Delete(job_system);
+        }
+        else
+        {
+            VerifyBatchRange(&ctx, 0, count);
+        }
+
+        // Only the verified resources are passed on to the archive
+        dmResourceArchive::LiveUpdateResource* verified = (dmResourceArchive::LiveUpdateResource*) malloc(count * sizeof(dmResourceArchive::LiveUpdateResource));
+        uint32_t* verified_index = (uint32_t*) malloc(count * sizeof(uint32_t));
+        uint32_t verified_count = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            BatchResource* resource = &resources[i];
+            if (!resource->m_Status)
+            {
+                dmLogError("Verification failure for Liveupdate archive for resource: %.*s", resource->m_ExpectedDigestLength, resource->m_ExpectedDigest);
+                continue;
+            }
+            if (verified_count != i)
+            {
+                memcpy(digests + verified_count * digestLength, digests + i * digestLength, digestLength);
+            }
+            verified[verified_count] = resource->m_Resource;
+            verified_index[verified_count] = i;
+            ++verified_count;
+        }
+
+        Result result = RESULT_INVALID_RESOURCE;
+        if (verified_count > 0)
+        {
+            dmResourceArchive::Result* results = (dmResourceArchive::Result*) malloc(verified_count * sizeof(dmResourceArchive::Result));
+
+            char proj_id[dmResource::MANIFEST_PROJ_ID_LEN];
+            dmResource::BytesToHexString(manifest->m_DDFData->m_Header.m_ProjectIdentifier.m_Data.m_Data, dmResource::HashLength(dmLiveUpdateDDF::HASH_SHA1), proj_id, dmResource::MANIFEST_PROJ_ID_LEN);
+            dmResource::Result res = dmResource::NewArchiveIndexWithResources(manifest, digests, digestLength, verified, verified_count, proj_id, out_new_index, results);
+
+            for (uint32_t i = 0; i < verified_count; ++i)
+            {
+                resources[verified_index[i]].m_Status = results[i] == dmResourceArchive::RESULT_OK;
+            }
+            free(results);
+            result = (res == dmResource::RESULT_OK) ? RESULT_OK : RESULT_INVALID_RESOURCE;
+        }
+
+        free(verified_index);
+        free(verified);
+        free(digests);
+        return result;
+    }
+
     void SetNewArchiveIndex(dmResourceArchive::HArchiveIndexContainer archive_container, dmResourceArchive::HArchiveIndex new_index, bool mem_mapped)
     {
         dmResourceArchive::SetNewArchiveIndex(archive_container, new_index, mem_mapped);
@@ -54,6 +54,35 @@ namespace dmLiveUpdate
         bool        m_Status;
     };
 
+    /**
+     * Resource in a batch store request. The expected digest and the resource data must stay valid until the callback has been called.
+     */
+    struct BatchResource
+    {
+        const char*                           m_ExpectedDigest;
+        uint32_t                              m_ExpectedDigestLength;
+        dmResourceArchive::LiveUpdateResource m_Resource;
+        /// Set when the batch has been processed, true if the resource was verified and stored
+        bool                                  m_Status;
+    };
+
+    /**
+     * Callback data from store resources function
+     */
+    struct StoreResourcesCallbackData
+    {
+        StoreResourcesCallbackData()
+        {
+            memset(this, 0x0, sizeof(StoreResourcesCallbackData));
+        }
+        void*          m_L;
+        int            m_Self;
+        int            m_Callback;
+        int            m_ResourcesRef;
+        BatchResource* m_Resources;
+        uint32_t       m_Count;
+    };
+
     /**
      * Callback data from store manifest function
      */
@@ -74,6 +103,7 @@ namespace dmLiveUpdate
     const uint32_t PROJ_ID_LEN = 41; // SHA1 + NULL terminator
 
     void Initialize(const dmResource::HFactory factory);
+
     void Finalize();
     void Update();
 
@@ -91,6 +121,12 @@ namespace dmLiveUpdate
 
     Result StoreResourceAsync(dmResource::Manifest* manifest, const char* expected_digest, const uint32_t expected_digest_length, const dmResourceArchive::LiveUpdateResource* resource, void (*callback)(StoreResourceCallbackData*), StoreResourceCallbackData& callback_data);
 
+    /*
+     * Verifies and stores a batch of resources. The resources are hashed in parallel, the data is appended to the archive in one pass and
+     * the archive index is rebuilt once. The status of each resource is set before the callback is called.
+     */
+    Result StoreResourcesAsync(dmResource::Manifest* manifest, BatchResource* resources, uint32_t count, void (*callback)(StoreResourcesCallbackData*), StoreResourcesCallbackData& callback_data);
+
     Result StoreManifest(dmResource::Manifest* manifest);
 
     Result ParseManifestBin(uint8_t* manifest_data, size_t manifest_len, dmResource::Manifest* manifest);
@@ -46,8 +46,15 @@ namespace dmLiveUpdate
     {
         m_JobCompleteData.m_CallbackData = request.m_CallbackData;
         m_JobCompleteData.m_Callback = request.m_Callback;
+        m_JobCompleteData.m_BatchCallbackData = request.m_BatchCallbackData;
+        m_JobCompleteData.m_BatchCallback = request.m_BatchCallback;
         Result res = dmLiveUpdate::RESULT_OK;
-        if (request.m_Resource.m_Header != 0x0)
+        if (request.m_BatchResources != 0x0)
+        {
+            res = dmLiveUpdate::NewArchiveIndexWithResources(request.m_Manifest, request.m_BatchResources, request.m_BatchCount, m_JobCompleteData.m_NewArchiveIndex);
+            m_JobCompleteData.m_ArchiveIndexContainer = request.m_Manifest->m_ArchiveIndex;
+        }
+        else if (request.m_Resource.m_Header != 0x0)
         {
             res = dmLiveUpdate::NewArchiveIndexWithResource(request.m_Manifest, request.m_ExpectedResourceDigest, request.m_ExpectedResourceDigestLength, &request.m_Resource, m_JobCompleteData.m_NewArchiveIndex);
             m_JobCompleteData.m_ArchiveIndexContainer = request.m_Manifest->m_ArchiveIndex;
@@ -65,7 +72,14 @@ namespace dmLiveUpdate
         {
             dmLiveUpdate::SetNewArchiveIndex(m_JobCompleteData.m_ArchiveIndexContainer, m_JobCompleteData.m_NewArchiveIndex, true);
         }
-        m_JobCompleteData.m_Callback(&m_JobCompleteData.m_CallbackData);
+        if (m_JobCompleteData.m_BatchCallback)
+        {
+            m_JobCompleteData.m_BatchCallback(&m_JobCompleteData.m_BatchCallbackData);
+        }
+        else
+        {
+            m_JobCompleteData.m_Callback(&m_JobCompleteData.m_CallbackData);
+        }
     }
 
 
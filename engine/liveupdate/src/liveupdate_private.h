@@ -29,18 +29,29 @@ namespace dmLiveUpdate
 {
     struct AsyncResourceRequest
     {
+        AsyncResourceRequest()
+        {
+            memset(this, 0x0, sizeof(AsyncResourceRequest));
+        }
         dmResource::Manifest* m_Manifest;
         uint32_t m_ExpectedResourceDigestLength;
         const char* m_ExpectedResourceDigest;
         dmResourceArchive::LiveUpdateResource m_Resource;
         StoreResourceCallbackData m_CallbackData;
         void (*m_Callback)(StoreResourceCallbackData*);
+        /// Set for batch requests, in which case the single resource members above are unused
+        BatchResource* m_BatchResources;
+        uint32_t m_BatchCount;
+        StoreResourcesCallbackData m_BatchCallbackData;
+        void (*m_BatchCallback)(StoreResourcesCallbackData*);
     };
 
     struct ResourceRequestCallbackData
     {
         StoreResourceCallbackData m_CallbackData;
         void (*m_Callback)(StoreResourceCallbackData*);
+        StoreResourcesCallbackData m_BatchCallbackData;
+        void (*m_BatchCallback)(StoreResourcesCallbackData*);
         dmResourceArchive::HArchiveIndexContainer m_ArchiveIndexContainer;
         dmResourceArchive::HArchiveIndex m_NewArchiveIndex;
     };
@@ -58,6 +69,7 @@ namespace dmLiveUpdate
     void CreateManifestHash(dmLiveUpdateDDF::HashAlgorithm algorithm, const uint8_t* buf, size_t buflen, uint8_t* digest);
 
     Result NewArchiveIndexWithResource(dmResource::Manifest* manifest, const char* expected_digest, const uint32_t expected_digest_length, const dmResourceArchive::LiveUpdateResource* resource, dmResourceArchive::HArchiveIndex& out_new_index);
+    Result NewArchiveIndexWithResources(dmResource::Manifest* manifest, BatchResource* resources, uint32_t count, dmResourceArchive::HArchiveIndex& out_new_index);
     void SetNewArchiveIndex(dmResourceArchive::HArchiveIndexContainer archive_container, dmResourceArchive::HArchiveIndex new_index, bool mem_mapped);
 
     void AsyncInitialize(const dmResource::HFactory factory);
@@ -56,6 +56,19 @@ namespace dmLiveUpdate
         return dmLiveUpdate::RESULT_OK;
     }
 
+    dmLiveUpdate::Result NewArchiveIndexWithResources(dmResource::Manifest* manifest, dmLiveUpdate::BatchResource* resources, uint32_t count, dmResourceArchive::HArchiveIndex& out_new_index)
+    {
+        out_new_index = (dmResourceArchive::HArchiveIndex) 0x5678;
+        assert(manifest->m_ArchiveIndex == (dmResourceArchive::HArchiveIndexContainer) 0x1234);
+        assert(count == 3);
+        // The resource without a header fails verification, the others are stored
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            resources[i].m_Status = resources[i].m_Resource.m_Header != 0x0 && *((uint32_t*)resources[i].m_Resource.m_Data) == 0xdeadbeef;
+        }
+        return dmLiveUpdate::RESULT_OK;
+    }
+
     void SetNewArchiveIndex(dmResourceArchive::HArchiveIndexContainer archive_container, dmResourceArchive::HArchiveIndex new_index, bool mem_mapped)
     {
         ASSERT_EQ((dmResourceArchive::HArchiveIndexContainer) 0x1234, archive_container);
@@ -86,6 +99,19 @@ static void Callback_StoreResourceInvalidHeader(dmLiveUpdate::StoreResourceCallb
     ASSERT_FALSE(callback_data->m_Status);
 }
 
+static void Callback_StoreResources(dmLiveUpdate::StoreResourcesCallbackData* callback_data)
+{
+    g_TestAsyncCallbackComplete = true;
+    ASSERT_EQ(1, callback_data->m_Callback);
+    ASSERT_EQ(2, callback_data->m_ResourcesRef);
+    ASSERT_EQ(4, callback_data->m_Self);
+    ASSERT_EQ(3U, callback_data->m_Count);
+    ASSERT_STREQ("DUMMY0", callback_data->m_Resources[0].m_ExpectedDigest);
+    ASSERT_TRUE(callback_data->m_Resources[0].m_Status);
+    ASSERT_FALSE(callback_data->m_Resources[1].m_Status);
+    ASSERT_TRUE(callback_data->m_Resources[2].m_Status);
+}
+
 TEST_F(LiveUpdate, TestAsync)
 {
     dmLiveUpdate::AsyncInitialize(g_ResourceFactory);
@@ -156,6 +182,49 @@ TEST_F(LiveUpdate, TestAsyncInvalidResource)
     dmLiveUpdate::AsyncFinalize();
 }
 
+TEST_F(LiveUpdate, TestAsyncBatch)
+{
+    dmLiveUpdate::AsyncInitialize(g_ResourceFactory);
+
+    uint8_t buf[sizeof(dmResourceArchive::LiveUpdateResourceHeader)+sizeof(uint32_t)];
+    const size_t buf_len = sizeof(buf);
+    *((uint32_t*)&buf[sizeof(dmResourceArchive::LiveUpdateResourceHeader)]) = 0xdeadbeef;
+
+    dmLiveUpdate::BatchResource resources[3];
+    const char* digests[3] = { "DUMMY0", "DUMMY1", "DUMMY2" };
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        resources[i].m_ExpectedDigest = digests[i];
+        resources[i].m_ExpectedDigestLength = 6;
+        resources[i].m_Resource.Set((const uint8_t*) buf, buf_len);
+        resources[i].m_Status = false;
+    }
+    resources[1].m_Resource.m_Header = 0x0;
+
+    dmLiveUpdate::StoreResourcesCallbackData cb;
+    cb.m_Callback = 1;
+    cb.m_ResourcesRef = 2;
+    cb.m_Self = 4;
+
+    dmResource::Manifest manifest;
+    manifest.m_ArchiveIndex = (dmResourceArchive::HArchiveIndexContainer) 0x1234;
+
+    dmLiveUpdate::AsyncResourceRequest request;
+    request.m_Manifest = &manifest;
+    request.m_BatchResources = resources;
+    request.m_BatchCount = 3;
+    request.m_BatchCallbackData = cb;
+    request.m_BatchCallbackData.m_Resources = resources;
+    request.m_BatchCallbackData.m_Count = 3;
+    request.m_BatchCallback = Callback_StoreResources;
+
+    g_TestAsyncCallbackComplete = false;
+    ASSERT_TRUE(dmLiveUpdate::AddAsyncResourceRequest(request));
+    while(!g_TestAsyncCallbackComplete)
+        dmLiveUpdate::AsyncUpdate();
+
+    dmLiveUpdate::AsyncFinalize();
+}
 
 int main(int argc, char **argv)
 {
@@ -17,6 +17,7 @@
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
 #include <dlib/hash.h>
+#include <dlib/job_system.h>
 #include <dlib/message.h>
 #include <dlib/transform.h>
 
@@ -239,6 +240,8 @@ namespace dmPhysics
         uint32_t m_RayCastLimit3D;
         /// Maximum number of overlapping triggers
         uint32_t m_TriggerOverlapCapacity;
+        /// Job system used to run batched ray casts in parallel (optional)
+        dmJobSystem::HContext m_JobSystem;
         /// If true, the collision objects will retrieve the position of its game object
         uint8_t m_AllowDynamicTransforms:1;
         uint8_t :7;
@@ -1078,6 +1081,32 @@ namespace dmPhysics
      */
     void RayCast2D(HWorld2D world, const RayCastRequest& request, dmArray<RayCastResponse>& results);
 
+    /**
+     * Perform a batch of synchronous ray casts, returning the closest hit of each ray
+     *
+     * The ray casts are run serially, since Bullet temporarily swaps the shape of compound collision objects while testing them.
+     * Only the closest hit is reported, m_ReturnAllResults is ignored. Rays of 0 length are reported as misses.
+     *
+     * @param world Physics world in which to perform the ray casts
+     * @param requests Array of requests
+     * @param count Number of requests
+     * @param responses Array of at least count responses, responses[i] receives the result of requests[i]
+     */
+    void RayCastBatch3D(HWorld3D world, const RayCastRequest* requests, uint32_t count, RayCastResponse* responses);
+
+    /**
+     * Perform a batch of synchronous ray casts, returning the closest hit of each ray
+     *
+     * The ray casts are run in parallel when the context was created with a job system.
+     * Only the closest hit is reported, m_ReturnAllResults is ignored. Rays of 0 length are reported as misses.
+     *
+     * @param world Physics world in which to perform the ray casts
+     * @param requests Array of requests
+     * @param count Number of requests
+     * @param responses Array of at least count responses, responses[i] receives the result of requests[i]
+     */
+    void RayCastBatch2D(HWorld2D world, const RayCastRequest* requests, uint32_t count, RayCastResponse* responses);
+
     /**
      * Set the gravity for a 2D physics world.
      *
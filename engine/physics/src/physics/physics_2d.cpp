@@ -32,6 +32,7 @@ namespace dmPhysics
     , m_DebugCallbacks()
     , m_Gravity(0.0f, -10.0f)
     , m_Socket(0)
+    , m_JobSystem(0)
     , m_Scale(1.0f)
     , m_InvScale(1.0f)
     , m_ContactImpulseLimit(0.0f)
@@ -215,6 +216,7 @@ namespace dmPhysics
         context->m_TriggerEnterLimit = params.m_TriggerEnterLimit * params.m_Scale;
         context->m_RayCastLimit = params.m_RayCastLimit2D;
         context->m_TriggerOverlapCapacity = params.m_TriggerOverlapCapacity;
+        context->m_JobSystem = params.m_JobSystem;
         context->m_AllowDynamicTransforms = params.m_AllowDynamicTransforms;
         dmMessage::Result result = dmMessage::NewSocket(PHYSICS_SOCKET_NAME, &context->m_Socket);
         if (result != dmMessage::RESULT_OK)
@@ -1171,6 +1173,60 @@ namespace dmPhysics
         }
     }
 
+    // Minimum number of rays per job when running a batch in parallel
+    static const uint32_t RAY_CAST_BATCH_MIN_SIZE = 64;
+
+    struct RayCastBatchContext2D
+    {
+        HWorld2D                m_World;
+        const RayCastRequest*   m_Requests;
+        RayCastResponse*        m_Responses;
+    };
+
+    // Box2D ray casts only read the world, so each range can run on its own thread
+    static void RayCastBatchRange2D(void* _context, uint32_t begin, uint32_t end)
+    {
+        RayCastBatchContext2D* context = (RayCastBatchContext2D*)_context;
+        HWorld2D world = context->m_World;
+        float scale = world->m_Context->m_Scale;
+
+        ProcessRayCastResultCallback2D query;
+        query.m_Context = world->m_Context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const RayCastRequest& request = context->m_Requests[i];
+            query.m_Response = RayCastResponse();
+
+            b2Vec2 from;
+            ToB2(request.m_From, from, scale);
+            b2Vec2 to;
+            ToB2(request.m_To, to, scale);
+            if ((to - from).LengthSquared() > 0.0f)
+            {
+                query.m_IgnoredUserData = request.m_IgnoredUserData;
+                query.m_CollisionMask = request.m_Mask;
+                world->m_World.RayCast(&query, from, to);
+            }
+            context->m_Responses[i] = query.m_Response;
+        }
+    }
+
+    void RayCastBatch2D(HWorld2D world, const RayCastRequest* requests, uint32_t count, RayCastResponse* responses)
+    {
+        DM_PROFILE(Physics, "RayCastBatch");
+
+        RayCastBatchContext2D context;
+        context.m_World = world;
+        context.m_Requests = requests;
+        context.m_Responses = responses;
+
+        dmJobSystem::HContext job_system = world->m_Context->m_JobSystem;
+        if (job_system)
+            dmJobSystem::ParallelFor(job_system, RayCastBatchRange2D, &context, count, RAY_CAST_BATCH_MIN_SIZE);
+        else
+            RayCastBatchRange2D(&context, 0, count);
+    }
+
     void SetGravity2D(HWorld2D world, const Vectormath::Aos::Vector3& gravity)
     {
         b2Vec2 gravity_b;
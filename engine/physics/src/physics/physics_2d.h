@@ -61,6 +61,7 @@ namespace dmPhysics
         DebugCallbacks              m_DebugCallbacks;
         b2Vec2                      m_Gravity;
         dmMessage::HSocket          m_Socket;
+        dmJobSystem::HContext       m_JobSystem;
         float                       m_Scale;
         float                       m_InvScale;
         float                       m_ContactImpulseLimit;
@@ -218,6 +218,12 @@ namespace dmPhysics
     {
     }
 
+    void RayCastBatch2D(HWorld2D world, const RayCastRequest* requests, uint32_t count, RayCastResponse* responses)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            responses[i] = RayCastResponse();
+    }
+
     void SetGravity2D(HWorld2D world, const Vectormath::Aos::Vector3& gravity)
     {
     }
@@ -1130,6 +1130,34 @@ namespace dmPhysics
         }
     }
 
+    void RayCastBatch3D(HWorld3D world, const RayCastRequest* requests, uint32_t count, RayCastResponse* responses)
+    {
+        DM_PROFILE(Physics, "RayCastBatch");
+
+        float scale = world->m_Context->m_Scale;
+        float inv_scale = world->m_Context->m_InvScale;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const RayCastRequest& request = requests[i];
+            RayCastResponse& response = responses[i];
+            response = RayCastResponse();
+            if (Vectormath::Aos::lengthSqr(request.m_To - request.m_From) <= 0.0f)
+                continue;
+
+            btVector3 from;
+            ToBt(request.m_From, from, scale);
+            btVector3 to;
+            ToBt(request.m_To, to, scale);
+
+            RayCastResultClosestCallback3D result_callback(from, to, request.m_Mask, request.m_IgnoredUserData);
+            world->m_DynamicsWorld->rayTest(from, to, result_callback);
+            if (result_callback.hasHit())
+            {
+                ResponseFromRayCastResult(response, inv_scale, result_callback.m_closestHitFraction, result_callback.m_hitPointWorld, result_callback.m_hitNormalWorld, result_callback.m_collisionObject);
+            }
+        }
+    }
+
     void SetGravity3D(HWorld3D world, const Vectormath::Aos::Vector3& gravity)
     {
         HContext3D context = world->m_Context;
@@ -186,6 +186,12 @@ namespace dmPhysics
     {
     }
 
+    void RayCastBatch3D(HWorld3D world, const RayCastRequest* requests, uint32_t count, RayCastResponse* responses)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            responses[i] = RayCastResponse();
+    }
+
     void SetGravity3D(HWorld3D world, const Vectormath::Aos::Vector3& gravity)
     {
     }
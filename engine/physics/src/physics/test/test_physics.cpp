@@ -123,6 +123,7 @@ Test3D::Test3D()
 , m_GetMassFunc(dmPhysics::GetMass3D)
 , m_RequestRayCastFunc(dmPhysics::RequestRayCast3D)
 , m_RayCastFunc(dmPhysics::RayCast3D)
+, m_RayCastBatchFunc(dmPhysics::RayCastBatch3D)
 , m_SetDebugCallbacksFunc(dmPhysics::SetDebugCallbacks3D)
 , m_ReplaceShapeFunc(dmPhysics::ReplaceShape3D)
 , m_SetGravityFunc(dmPhysics::SetGravity3D)
@@ -178,6 +179,7 @@ Test2D::Test2D()
 , m_GetMassFunc(dmPhysics::GetMass2D)
 , m_RequestRayCastFunc(dmPhysics::RequestRayCast2D)
 , m_RayCastFunc(dmPhysics::RayCast2D)
+, m_RayCastBatchFunc(dmPhysics::RayCastBatch2D)
 , m_SetDebugCallbacksFunc(dmPhysics::SetDebugCallbacks2D)
 , m_ReplaceShapeFunc(dmPhysics::ReplaceShape2D)
 , m_SetGravityFunc(dmPhysics::SetGravity2D)
@@ -1245,6 +1247,108 @@ TYPED_TEST(PhysicsTest, FilteredRayCasting)
     (*TestFixture::m_Test.m_DeleteCollisionShapeFunc)(shape_b);
 }
 
+template<typename T>
+static void TestRayCastBatch(T& test, typename T::ContextType context, typename T::WorldType world)
+{
+    float box_half_ext = 0.5f;
+    typename T::CollisionShapeType shape = (*test.m_NewBoxShapeFunc)(context, Vector3(box_half_ext, box_half_ext, box_half_ext));
+
+    // A row of boxes, every other one in group B
+    const uint32_t box_count = 4;
+    VisualObject vo[box_count];
+    typename T::CollisionObjectType box_co[box_count];
+    for (uint32_t i = 0; i < box_count; ++i)
+    {
+        vo[i].m_Position.setX(i * 2.0f);
+        dmPhysics::CollisionObjectData data;
+        data.m_Mass = 0.0f;
+        data.m_Type = dmPhysics::COLLISION_OBJECT_TYPE_KINEMATIC;
+        data.m_Group = (i % 2) ? GROUP_B : GROUP_A;
+        data.m_Mask = GROUP_A | GROUP_B;
+        data.m_UserData = &vo[i];
+        box_co[i] = (*test.m_NewCollisionObjectFunc)(world, data, &shape, 1u);
+    }
+
+    // Vertical rays sweeping over the row, enough of them to be split over several jobs
+    const uint32_t ray_count = 512;
+    dmArray<dmPhysics::RayCastRequest> requests;
+    requests.SetCapacity(ray_count);
+    requests.SetSize(ray_count);
+    for (uint32_t i = 0; i < ray_count; ++i)
+    {
+        float x = -1.0f + 8.0f * i / ray_count;
+        requests[i].m_From = Vectormath::Aos::Point3(x, 2.0f, 0.0f);
+        requests[i].m_To = Vectormath::Aos::Point3(x, -2.0f, 0.0f);
+        requests[i].m_Mask = (i % 2) ? GROUP_A : (GROUP_A | GROUP_B);
+    }
+    // 0-length ray
+    requests[0].m_To = requests[0].m_From;
+
+    dmArray<dmPhysics::RayCastResponse> responses;
+    responses.SetCapacity(ray_count);
+    responses.SetSize(ray_count);
+    (*test.m_RayCastBatchFunc)(world, requests.Begin(), ray_count, responses.Begin());
+
+    ASSERT_FALSE(responses[0].m_Hit);
+
+    // Same results as the single ray casts
+    dmArray<dmPhysics::RayCastResponse> hits;
+    hits.SetCapacity(1);
+    uint32_t hit_count = 0;
+    for (uint32_t i = 1; i < ray_count; ++i)
+    {
+        hits.SetSize(0);
+        (*test.m_RayCastFunc)(world, requests[i], hits);
+        const dmPhysics::RayCastResponse& response = responses[i];
+        ASSERT_EQ(hits.Size(), (uint32_t)response.m_Hit);
+        if (response.m_Hit)
+        {
+            ASSERT_EQ(hits[0].m_Fraction, response.m_Fraction);
+            ASSERT_EQ(hits[0].m_Position.getX(), response.m_Position.getX());
+            ASSERT_EQ(hits[0].m_Position.getY(), response.m_Position.getY());
+            ASSERT_EQ(hits[0].m_Normal.getY(), response.m_Normal.getY());
+            ASSERT_EQ(hits[0].m_CollisionObjectUserData, response.m_CollisionObjectUserData);
+            ASSERT_EQ(hits[0].m_CollisionObjectGroup, response.m_CollisionObjectGroup);
+            ++hit_count;
+        }
+    }
+    ASSERT_LT(0u, hit_count);
+    ASSERT_GT(ray_count - 1, hit_count);
+
+    for (uint32_t i = 0; i < box_count; ++i)
+        (*test.m_DeleteCollisionObjectFunc)(world, box_co[i]);
+    (*test.m_DeleteCollisionShapeFunc)(shape);
+}
+
+TYPED_TEST(PhysicsTest, RayCastBatch)
+{
+    TestRayCastBatch(TestFixture::m_Test, TestFixture::m_Context, TestFixture::m_World);
+}
+
+TYPED_TEST(PhysicsTest, RayCastBatchJobSystem)
+{
+    dmJobSystem::NewContextParams job_params;
+    job_params.m_WorkerCount = 3;
+    dmJobSystem::HContext job_system = dmJobSystem::New(job_params);
+
+    // Recreate the context with the job system, it is deleted by the fixture as usual
+    (*TestFixture::m_Test.m_DeleteWorldFunc)(TestFixture::m_Context, TestFixture::m_World);
+    (*TestFixture::m_Test.m_DeleteContextFunc)(TestFixture::m_Context);
+
+    dmPhysics::NewContextParams context_params = dmPhysics::NewContextParams();
+    context_params.m_Scale = PHYSICS_SCALE;
+    context_params.m_JobSystem = job_system;
+    TestFixture::m_Context = (*TestFixture::m_Test.m_NewContextFunc)(context_params);
+    dmPhysics::NewWorldParams world_params;
+    world_params.m_GetWorldTransformCallback = GetWorldTransform;
+    world_params.m_SetWorldTransformCallback = SetWorldTransform;
+    TestFixture::m_World = (*TestFixture::m_Test.m_NewWorldFunc)(TestFixture::m_Context, world_params);
+
+    TestRayCastBatch(TestFixture::m_Test, TestFixture::m_Context, TestFixture::m_World);
+
+    dmJobSystem::Delete(job_system);
+}
+
 TYPED_TEST(PhysicsTest, GravityChange)
 {
     float box_half_ext = 0.5f;
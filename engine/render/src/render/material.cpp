@@ -168,7 +168,7 @@ namespace dmRender
             {
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_USER:
                 {
-                    dmGraphics::SetConstantV4(graphics_context, &constant.m_Value, location);
+                    ApplyConstantV4(render_context, &constant.m_Value, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEWPROJ:
@@ -179,27 +179,27 @@ namespace dmRender
                         ndc_matrix.setElem(2, 2, 0.5f );
                         ndc_matrix.setElem(3, 2, 0.5f );
                         const Matrix4 view_projection = ndc_matrix * render_context->m_ViewProj;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&view_projection, location);
+                        ApplyConstantM4(render_context, (Vector4*)&view_projection, location);
                     }
                     else
                     {
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_ViewProj, location);
+                        ApplyConstantM4(render_context, (Vector4*)&render_context->m_ViewProj, location);
                     }
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_WORLD:
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_WorldTransform, location);
+                    ApplyConstantM4(render_context, (Vector4*)&ro->m_WorldTransform, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_TEXTURE:
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&ro->m_TextureTransform, location);
+                    ApplyConstantM4(render_context, (Vector4*)&ro->m_TextureTransform, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_VIEW:
                 {
-                    dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_View, location);
+                    ApplyConstantM4(render_context, (Vector4*)&render_context->m_View, location);
                     break;
                 }
                 case dmRenderDDF::MaterialDesc::CONSTANT_TYPE_PROJECTION:
@@ -212,11 +212,11 @@ namespace dmRender
                         ndc_matrix.setElem(2, 2, 0.5f );
                         ndc_matrix.setElem(3, 2, 0.5f );
                         const Matrix4 proj = ndc_matrix * render_context->m_Projection;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&proj, location);
+                        ApplyConstantM4(render_context, (Vector4*)&proj, location);
                     }
                     else
                     {
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&render_context->m_Projection, location);
+                        ApplyConstantM4(render_context, (Vector4*)&render_context->m_Projection, location);
                     }
                     break;
                 }
@@ -229,7 +229,7 @@ namespace dmRender
                         // It is always affine however
                         normalT = affineInverse(normalT);
                         normalT = transpose(normalT);
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&normalT, location);
+                        ApplyConstantM4(render_context, (Vector4*)&normalT, location);
                     }
                     break;
                 }
@@ -237,7 +237,7 @@ namespace dmRender
                 {
                     {
                         Matrix4 world_view = render_context->m_View * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view, location);
+                        ApplyConstantM4(render_context, (Vector4*)&world_view, location);
                     }
                     break;
                 }
@@ -249,12 +249,12 @@ namespace dmRender
                         ndc_matrix.setElem(2, 2, 0.5f );
                         ndc_matrix.setElem(3, 2, 0.5f );
                         const Matrix4 world_view_projection = ndc_matrix * render_context->m_ViewProj * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
+                        ApplyConstantM4(render_context, (Vector4*)&world_view_projection, location);
                     }
                     else
                     {
                         const Matrix4 world_view_projection = render_context->m_ViewProj * ro->m_WorldTransform;
-                        dmGraphics::SetConstantM4(graphics_context, (Vector4*)&world_view_projection, location);
+                        ApplyConstantM4(render_context, (Vector4*)&world_view_projection, location);
                     }
                     break;
                 }
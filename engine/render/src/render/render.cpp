@@ -130,6 +130,9 @@ namespace dmRender
         }
 
         memset(context->m_Textures, 0, sizeof(dmGraphics::HTexture) * RenderObject::MAX_TEXTURE_COUNT);
+        memset(&context->m_StateCache, 0, sizeof(context->m_StateCache));
+        context->m_StateChangesIssued = 0;
+        context->m_StateChangesSkipped = 0;
 
         InitializeTextContext(context, params.m_MaxCharacters);
 
@@ -139,6 +142,8 @@ namespace dmRender
 
         context->m_RenderListDispatch.SetCapacity(255);
 
+        context->m_JobSystem = 0;
+
         dmMessage::Result r = dmMessage::NewSocket(RENDER_SOCKET_NAME, &context->m_Socket);
         assert(r == dmMessage::RESULT_OK);
 
@@ -163,15 +168,22 @@ namespace dmRender
         return render_context->m_ScriptContext;
     }
 
+    void SetJobSystem(HRenderContext render_context, dmJobSystem::HContext job_system)
+    {
+        render_context->m_JobSystem = job_system;
+    }
+
     void RenderListBegin(HRenderContext render_context)
     {
         render_context->m_RenderList.SetSize(0);
         render_context->m_RenderListSortIndices.SetSize(0);
         render_context->m_RenderListDispatch.SetSize(0);
         render_context->m_RenderListRanges.SetSize(0);
+        render_context->m_StateChangesIssued = 0;
+        render_context->m_StateChangesSkipped = 0;
     }
 
-    HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data)
+    static HRenderListDispatch MakeDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data, bool parallel_fill)
     {
         if (render_context->m_RenderListDispatch.Size() == render_context->m_RenderListDispatch.Capacity())
         {
@@ -183,11 +195,23 @@ namespace dmRender
         RenderListDispatch d;
         d.m_Fn = fn;
         d.m_UserData = user_data;
+        d.m_BatchCount = 0;
+        d.m_ParallelFill = parallel_fill;
         render_context->m_RenderListDispatch.Push(d);
 
         return render_context->m_RenderListDispatch.Size() - 1;
     }
 
+    HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data)
+    {
+        return MakeDispatch(render_context, fn, user_data, false);
+    }
+
+    HRenderListDispatch RenderListMakeParallelDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data)
+    {
+        return MakeDispatch(render_context, fn, user_data, true);
+    }
+
     // Allocate a buffer (from the array) with room for 'entries' entries.
     //
     // NOTE: Pointer might go invalid after a consecutive call to RenderListAlloc if reallocation
@@ -363,9 +387,56 @@ namespace dmRender
         dmGraphics::SetStencilOp(graphics_context, stp.m_OpSFail, stp.m_OpDPFail, stp.m_OpDPPass);
     }
 
+    static bool UpdateCachedConstant(HRenderContext render_context, const Vector4* value, int32_t location, uint32_t size)
+    {
+        RenderStateCache& cache = render_context->m_StateCache;
+        if (!cache.m_Active)
+            return true;
+
+        const uint32_t value_size = sizeof(float) * size;
+        for (uint32_t i = 0; i < cache.m_ConstantCount; ++i)
+        {
+            RenderStateCache::CachedConstant& c = cache.m_Constants[i];
+            if (c.m_Location == location)
+            {
+                if (c.m_Size == size && memcmp(c.m_Value, value, value_size) == 0)
+                {
+                    ++render_context->m_StateChangesSkipped;
+                    return false;
+                }
+                c.m_Size = size;
+                memcpy(c.m_Value, value, value_size);
+                ++render_context->m_StateChangesIssued;
+                return true;
+            }
+        }
+
+        // When the cache is full, the constant is simply set every time
+        if (cache.m_ConstantCount < RenderStateCache::MAX_CONSTANT_COUNT)
+        {
+            RenderStateCache::CachedConstant& c = cache.m_Constants[cache.m_ConstantCount++];
+            c.m_Location = location;
+            c.m_Size = size;
+            memcpy(c.m_Value, value, value_size);
+        }
+        ++render_context->m_StateChangesIssued;
+        return true;
+    }
+
+    void ApplyConstantV4(HRenderContext render_context, const Vector4* value, int32_t location)
+    {
+        if (UpdateCachedConstant(render_context, value, location, 4))
+            dmGraphics::SetConstantV4(render_context->m_GraphicsContext, value, location);
+    }
+
+    void ApplyConstantM4(HRenderContext render_context, const Vector4* value, int32_t location)
+    {
+        if (UpdateCachedConstant(render_context, value, location, 16))
+            dmGraphics::SetConstantM4(render_context->m_GraphicsContext, value, location);
+    }
+
     void ApplyRenderObjectConstants(HRenderContext render_context, HMaterial material, const RenderObject* ro)
     {
-        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
         if(!material)
         {
             for (uint32_t i = 0; i < RenderObject::MAX_CONSTANT_COUNT; ++i)
@@ -373,7 +444,7 @@ namespace dmRender
                 const Constant* c = &ro->m_Constants[i];
                 if (c->m_Location != -1)
                 {
-                    dmGraphics::SetConstantV4(graphics_context, &c->m_Value, c->m_Location);
+                    ApplyConstantV4(render_context, &c->m_Value, c->m_Location);
                 }
             }
             return;
@@ -386,7 +457,7 @@ namespace dmRender
                 int32_t* location = material->m_NameHashToLocation.Get(ro->m_Constants[i].m_NameHash);
                 if (location)
                 {
-                    dmGraphics::SetConstantV4(graphics_context, &c->m_Value, *location);
+                    ApplyConstantV4(render_context, &c->m_Value, *location);
                 }
             }
         }
@@ -542,6 +613,40 @@ namespace dmRender
         }
     }
 
+    // Min number of batches filled by one job
+    static const uint32_t FILL_MIN_BATCH_COUNT = 4;
+
+    // Dispatches the batches [begin, end), or only those of parallel dispatches if 'parallel_only' is set
+    static void DispatchBatches(HRenderContext context, RenderListDispatchParams& params, uint32_t begin, uint32_t end, bool parallel_only)
+    {
+        const RenderListBatch* batches = context->m_RenderListBatches.Begin();
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const RenderListBatch& batch = batches[i];
+            const RenderListDispatch& d = context->m_RenderListDispatch[batch.m_Dispatch];
+            if (parallel_only && !d.m_ParallelFill)
+                continue;
+            params.m_UserData = d.m_UserData;
+            params.m_Begin = batch.m_Begin;
+            params.m_End = batch.m_End;
+            params.m_BatchIndex = batch.m_BatchIndex;
+            d.m_Fn(params);
+        }
+    }
+
+    // Job function, runs on the workers of the job system
+    static void FillBatchRange(void* _context, uint32_t begin, uint32_t end)
+    {
+        DM_PROFILE(Render, "FillBatchRange");
+        HRenderContext context = (HRenderContext)_context;
+        RenderListDispatchParams params;
+        memset(&params, 0x00, sizeof(params));
+        params.m_Context = context;
+        params.m_Operation = RENDER_LIST_OPERATION_BATCH_FILL;
+        params.m_Buf = context->m_RenderList.Begin();
+        DispatchBatches(context, params, begin, end, true);
+    }
+
     Result DrawRenderList(HRenderContext context, Predicate* predicate, HNamedConstantBuffer constant_buffer)
     {
         DM_PROFILE(Render, "DrawRenderList");
@@ -584,19 +689,23 @@ namespace dmRender
         // All get begin operation first
         for (uint32_t i=0;i!=context->m_RenderListDispatch.Size();i++)
         {
-            const RenderListDispatch& d = context->m_RenderListDispatch[i];
+            RenderListDispatch& d = context->m_RenderListDispatch[i];
+            d.m_BatchCount = 0;
             params.m_UserData = d.m_UserData;
             d.m_Fn(params);
         }
 
-        params.m_Operation = RENDER_LIST_OPERATION_BATCH;
-        params.m_Buf = context->m_RenderList.Begin();
-
         // Make batches for matching dispatch, batch key & minor order
         RenderListEntry *base = context->m_RenderList.Begin();
         uint32_t *last = context->m_RenderListSortBuffer.Begin();
         uint32_t count = context->m_RenderListSortBuffer.Size();
 
+        dmArray<RenderListBatch>& batches = context->m_RenderListBatches;
+        batches.SetSize(0);
+        if (batches.Capacity() < count)
+            batches.SetCapacity(count);
+
+        bool parallel_fill = false;
         for (uint32_t i=1;i<=count;i++)
         {
             uint32_t *idx = context->m_RenderListSortBuffer.Begin() + i;
@@ -610,20 +719,47 @@ namespace dmRender
             if (last_entry->m_Dispatch != RENDERLIST_INVALID_DISPATCH)
             {
                 assert(last_entry->m_Dispatch < context->m_RenderListDispatch.Size());
-                const RenderListDispatch* d = &context->m_RenderListDispatch[last_entry->m_Dispatch];
-                params.m_UserData = d->m_UserData;
-                params.m_Begin = last;
-                params.m_End = idx;
-                d->m_Fn(params);
+                RenderListDispatch* d = &context->m_RenderListDispatch[last_entry->m_Dispatch];
+                RenderListBatch batch;
+                batch.m_Begin = last;
+                batch.m_End = idx;
+                batch.m_BatchIndex = d->m_BatchCount++;
+                batch.m_Dispatch = last_entry->m_Dispatch;
+                batches.Push(batch);
+                parallel_fill |= d->m_ParallelFill;
             }
 
             last = idx;
         }
 
+        params.m_Buf = base;
+
+        if (parallel_fill)
+        {
+            // The ranges are reserved in sorted order, so the vertex data ends up where a serial dispatch would have put it
+            {
+                DM_PROFILE(Render, "DrawRenderList_RESERVE");
+                params.m_Operation = RENDER_LIST_OPERATION_BATCH_RESERVE;
+                DispatchBatches(context, params, 0, batches.Size(), true);
+            }
+
+            {
+                DM_PROFILE(Render, "DrawRenderList_FILL");
+                if (context->m_JobSystem)
+                    dmJobSystem::ParallelFor(context->m_JobSystem, FillBatchRange, context, batches.Size(), FILL_MIN_BATCH_COUNT);
+                else
+                    FillBatchRange(context, 0, batches.Size());
+            }
+        }
+
+        params.m_Operation = RENDER_LIST_OPERATION_BATCH;
+        DispatchBatches(context, params, 0, batches.Size(), false);
+
         params.m_Operation = RENDER_LIST_OPERATION_END;
         params.m_Begin = 0;
         params.m_End = 0;
         params.m_Buf = 0;
+        params.m_BatchIndex = 0;
 
         for (uint32_t i=0;i!=context->m_RenderListDispatch.Size();i++)
         {
@@ -635,6 +771,14 @@ namespace dmRender
         return Draw(context, predicate, constant_buffer);
     }
 
+    static inline void CountStateChange(HRenderContext render_context, bool issued)
+    {
+        if (issued)
+            ++render_context->m_StateChangesIssued;
+        else
+            ++render_context->m_StateChangesSkipped;
+    }
+
     Result Draw(HRenderContext render_context, Predicate* predicate, HNamedConstantBuffer constant_buffer)
     {
         if (render_context == 0x0)
@@ -646,6 +790,16 @@ namespace dmRender
 
         dmGraphics::HContext context = dmRender::GetGraphicsContext(render_context);
 
+        // The totals are kept per frame, the profiler counters only get what this call added
+        uint32_t state_changes_issued = render_context->m_StateChangesIssued;
+        uint32_t state_changes_skipped = render_context->m_StateChangesSkipped;
+
+        // State set for one render object is kept for the next, and only the differences are applied.
+        // Textures and the vertex declaration are released once all objects are drawn.
+        RenderStateCache& cache = render_context->m_StateCache;
+        memset(&cache, 0, sizeof(cache));
+        cache.m_Active = 1;
+
         HMaterial material = render_context->m_Material;
         HMaterial context_material = render_context->m_Material;
         if(context_material)
@@ -661,11 +815,15 @@ namespace dmRender
             {
                 if (!context_material)
                 {
-                    if(material != ro->m_Material)
+                    bool changed = material != ro->m_Material;
+                    if(changed)
                     {
                         material = ro->m_Material;
                         dmGraphics::EnableProgram(context, GetMaterialProgram(material));
+                        // Constant values belong to the program
+                        cache.m_ConstantCount = 0;
                     }
+                    CountStateChange(render_context, changed);
                 }
 
                 ApplyMaterialConstants(render_context, material, ro);
@@ -675,10 +833,33 @@ namespace dmRender
                     ApplyNamedConstantBuffer(render_context, material, constant_buffer);
 
                 if (ro->m_SetBlendFactors)
-                    dmGraphics::SetBlendFunc(context, ro->m_SourceBlendFactor, ro->m_DestinationBlendFactor);
+                {
+                    bool changed = !cache.m_BlendFactorsSet ||
+                                   cache.m_SourceBlendFactor != ro->m_SourceBlendFactor ||
+                                   cache.m_DestinationBlendFactor != ro->m_DestinationBlendFactor;
+                    if (changed)
+                    {
+                        dmGraphics::SetBlendFunc(context, ro->m_SourceBlendFactor, ro->m_DestinationBlendFactor);
+                        cache.m_SourceBlendFactor = ro->m_SourceBlendFactor;
+                        cache.m_DestinationBlendFactor = ro->m_DestinationBlendFactor;
+                        cache.m_BlendFactorsSet = 1;
+                    }
+                    CountStateChange(render_context, changed);
+                }
 
                 if (ro->m_SetStencilTest)
-                    ApplyStencilTest(render_context, ro);
+                {
+                    // Clearing the stencil buffer is a side effect and is never skipped
+                    bool changed = ro->m_StencilTestParams.m_ClearBuffer || !cache.m_StencilTestSet ||
+                                   memcmp(&cache.m_StencilTestParams, &ro->m_StencilTestParams, sizeof(StencilTestParams)) != 0;
+                    if (changed)
+                    {
+                        ApplyStencilTest(render_context, ro);
+                        cache.m_StencilTestParams = ro->m_StencilTestParams;
+                        cache.m_StencilTestSet = 1;
+                    }
+                    CountStateChange(render_context, changed);
+                }
 
                 for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
                 {
@@ -687,35 +868,80 @@ namespace dmRender
                         texture = render_context->m_Textures[i];
                     if (texture)
                     {
-                        dmGraphics::EnableTexture(context, i, texture);
-                        ApplyMaterialSampler(render_context, material, i, texture);
+                        // The material samplers are applied on top of the texture parameters
+                        bool changed = cache.m_Textures[i] != texture || cache.m_TextureMaterial != material;
+                        if (changed)
+                        {
+                            dmGraphics::EnableTexture(context, i, texture);
+                            ApplyMaterialSampler(render_context, material, i, texture);
+                            cache.m_Textures[i] = texture;
+                        }
+                        CountStateChange(render_context, changed);
+                    }
+                    else if (cache.m_Textures[i])
+                    {
+                        dmGraphics::DisableTexture(context, i, cache.m_Textures[i]);
+                        cache.m_Textures[i] = 0;
+                        CountStateChange(render_context, true);
                     }
+                }
+                cache.m_TextureMaterial = material;
 
+                dmGraphics::HProgram program = GetMaterialProgram(material);
+                bool vertex_declaration_changed = cache.m_VertexDeclaration != ro->m_VertexDeclaration ||
+                                                  cache.m_VertexBuffer != ro->m_VertexBuffer ||
+                                                  cache.m_VertexProgram != program;
+                if (vertex_declaration_changed)
+                {
+                    if (cache.m_VertexDeclaration)
+                        dmGraphics::DisableVertexDeclaration(context, cache.m_VertexDeclaration);
+                    dmGraphics::EnableVertexDeclaration(context, ro->m_VertexDeclaration, ro->m_VertexBuffer, program);
+                    cache.m_VertexDeclaration = ro->m_VertexDeclaration;
+                    cache.m_VertexBuffer = ro->m_VertexBuffer;
+                    cache.m_VertexProgram = program;
                 }
+                CountStateChange(render_context, vertex_declaration_changed);
+
+                if (ro->m_InstanceCount > 0)
+                {
+                    dmGraphics::EnableInstanceVertexDeclaration(context, ro->m_InstanceVertexDeclaration, ro->m_InstanceVertexBuffer, ro->m_InstanceBufferOffset, program);
 
-                dmGraphics::EnableVertexDeclaration(context, ro->m_VertexDeclaration, ro->m_VertexBuffer, GetMaterialProgram(material));
+                    if (ro->m_IndexBuffer)
+                        dmGraphics::DrawElementsInstanced(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_IndexType, ro->m_IndexBuffer, ro->m_InstanceCount);
+                    else
+                        dmGraphics::DrawInstanced(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_InstanceCount);
 
-                if (ro->m_IndexBuffer)
+                    dmGraphics::DisableInstanceVertexDeclaration(context, ro->m_InstanceVertexDeclaration);
+                }
+                else if (ro->m_IndexBuffer)
                     dmGraphics::DrawElements(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount, ro->m_IndexType, ro->m_IndexBuffer);
                 else
                     dmGraphics::Draw(context, ro->m_PrimitiveType, ro->m_VertexStart, ro->m_VertexCount);
+            }
+        }
 
-                dmGraphics::DisableVertexDeclaration(context, ro->m_VertexDeclaration);
-
-                for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
-                {
-                    dmGraphics::HTexture texture = ro->m_Textures[i];
-                    if (render_context->m_Textures[i])
-                        texture = render_context->m_Textures[i];
-                    if (texture)
-                        dmGraphics::DisableTexture(context, i, texture);
-                }
+        if (cache.m_VertexDeclaration)
+            dmGraphics::DisableVertexDeclaration(context, cache.m_VertexDeclaration);
 
-            }
+        for (uint32_t i = 0; i < RenderObject::MAX_TEXTURE_COUNT; ++i)
+        {
+            if (cache.m_Textures[i])
+                dmGraphics::DisableTexture(context, i, cache.m_Textures[i]);
         }
+
+        cache.m_Active = 0;
+
+        DM_COUNTER("RenderStateChanges", render_context->m_StateChangesIssued - state_changes_issued);
+        DM_COUNTER("RenderStateChangesSkipped", render_context->m_StateChangesSkipped - state_changes_skipped);
         return RESULT_OK;
     }
 
+    void GetStateChangeCounts(HRenderContext render_context, uint32_t* issued, uint32_t* skipped)
+    {
+        *issued = render_context->m_StateChangesIssued;
+        *skipped = render_context->m_StateChangesSkipped;
+    }
+
     Result DrawDebug3d(HRenderContext context)
     {
         if (!context->m_DebugRenderer.m_RenderContext) {
@@ -822,11 +1048,11 @@ namespace dmRender
 
     struct ApplyContext
     {
-        dmGraphics::HContext m_GraphicsContext;
-        HMaterial            m_Material;
-        ApplyContext(dmGraphics::HContext graphics_context, HMaterial material)
+        HRenderContext m_RenderContext;
+        HMaterial      m_Material;
+        ApplyContext(HRenderContext render_context, HMaterial material)
         {
-            m_GraphicsContext = graphics_context;
+            m_RenderContext = render_context;
             m_Material = material;
         }
     };
@@ -836,15 +1062,14 @@ namespace dmRender
         int32_t* location = context->m_Material->m_NameHashToLocation.Get(*name_hash);
         if (location)
         {
-            dmGraphics::SetConstantV4(context->m_GraphicsContext, value, *location);
+            ApplyConstantV4(context->m_RenderContext, value, *location);
         }
     }
 
     void ApplyNamedConstantBuffer(dmRender::HRenderContext render_context, HMaterial material, HNamedConstantBuffer buffer)
     {
         dmHashTable64<Vectormath::Aos::Vector4>& constants = buffer->m_Constants;
-        dmGraphics::HContext graphics_context = dmRender::GetGraphicsContext(render_context);
-        ApplyContext context(graphics_context, material);
+        ApplyContext context(render_context, material);
         constants.Iterate(ApplyConstant, &context);
     }
 
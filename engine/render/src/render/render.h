@@ -17,6 +17,7 @@
 #include <stdint.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 #include <dlib/hash.h>
+#include <dlib/job_system.h>
 #include <script/script.h>
 #include <script/lua_source_ddf.h>
 #include <graphics/graphics.h>
@@ -143,6 +144,11 @@ namespace dmRender
         StencilTestParams               m_StencilTestParams;
         uint32_t                        m_VertexStart;
         uint32_t                        m_VertexCount;
+        /// Per-instance vertex data, only used when m_InstanceCount > 0
+        dmGraphics::HVertexBuffer       m_InstanceVertexBuffer;
+        dmGraphics::HVertexDeclaration  m_InstanceVertexDeclaration;
+        uint32_t                        m_InstanceBufferOffset;
+        uint32_t                        m_InstanceCount;
         uint8_t                         m_VertexConstantMask;
         uint8_t                         m_FragmentConstantMask;
         uint8_t                         m_SetBlendFactors : 1;
@@ -191,11 +197,22 @@ namespace dmRender
         uint32_t m_Dispatch:8;
     };
 
+    /**
+     * Operations passed to the render list dispatch functions. Dispatches made with
+     * RenderListMakeParallelDispatch get, for each batch in sorted order, BATCH_RESERVE followed
+     * later by BATCH_FILL and BATCH. The same m_BatchIndex is passed to all three.
+     * BATCH_RESERVE: Reserve room for the vertex (and index) data of the batch. Called on the render thread.
+     * BATCH_FILL: Write the vertex data into the reserved range. May be called concurrently from worker threads,
+     *             and must not modify any state shared with other batches.
+     * BATCH: Add the render objects of the batch. Called on the render thread, in sorted order for all dispatches.
+     */
     enum RenderListOperation
     {
         RENDER_LIST_OPERATION_BEGIN,
         RENDER_LIST_OPERATION_BATCH,
-        RENDER_LIST_OPERATION_END
+        RENDER_LIST_OPERATION_END,
+        RENDER_LIST_OPERATION_BATCH_RESERVE,
+        RENDER_LIST_OPERATION_BATCH_FILL,
     };
 
     struct RenderListDispatchParams
@@ -206,6 +223,7 @@ namespace dmRender
         RenderListEntry* m_Buf;
         uint32_t* m_Begin;
         uint32_t* m_End;
+        uint32_t m_BatchIndex;  // Index of the batch among the batches of the dispatch, counted from BEGIN
     };
 
     typedef void (*RenderListDispatchFn)(RenderListDispatchParams const &params);
@@ -217,8 +235,19 @@ namespace dmRender
 
     dmScript::HContext GetScriptContext(HRenderContext render_context);
 
+    /**
+     * Set the job system used to fill the batches of parallel render list dispatches.
+     * Without a job system (default) the batches are filled on the render thread.
+     * @param render_context Render context
+     * @param job_system Job system, or 0x0 to fill the batches sequentially
+     */
+    void SetJobSystem(HRenderContext render_context, dmJobSystem::HContext job_system);
+
     void RenderListBegin(HRenderContext render_context);
     HRenderListDispatch RenderListMakeDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data);
+    // Like RenderListMakeDispatch, but the vertex data of the batches is written in a separate fill pass that
+    // runs on the job system (if set). See RenderListOperation.
+    HRenderListDispatch RenderListMakeParallelDispatch(HRenderContext render_context, RenderListDispatchFn fn, void *user_data);
     RenderListEntry* RenderListAlloc(HRenderContext render_context, uint32_t entries);
     void RenderListSubmit(HRenderContext render_context, RenderListEntry *begin, RenderListEntry *end);
     void RenderListEnd(HRenderContext render_context);
@@ -245,6 +274,14 @@ namespace dmRender
     Result DrawDebug3d(HRenderContext context);
     Result DrawDebug2d(HRenderContext context);
 
+    /**
+     * Get the number of graphics state changes issued and skipped by Draw since the last RenderListBegin
+     * @param context Render context handle
+     * @param issued Number of state changes passed on to the graphics context
+     * @param skipped Number of redundant state changes that were skipped
+     */
+    void GetStateChangeCounts(HRenderContext context, uint32_t* issued, uint32_t* skipped);
+
     void EnableRenderObjectConstant(RenderObject* ro, dmhash_t name_hash, const Vectormath::Aos::Vector4& value);
     void DisableRenderObjectConstant(RenderObject* ro, dmhash_t name_hash);
 
@@ -108,14 +108,16 @@ namespace dmRender
                 {
                     Vectormath::Aos::Matrix4* matrix = (Vectormath::Aos::Matrix4*)c->m_Operands[0];
                     dmRender::SetViewMatrix(render_context, *matrix);
-                    delete matrix;
+                    if (c->m_Operands[1] == MATRIX_OWNER_COMMAND)
+                        delete matrix;
                     break;
                 }
                 case COMMAND_TYPE_SET_PROJECTION:
                 {
                     Vectormath::Aos::Matrix4* matrix = (Vectormath::Aos::Matrix4*)c->m_Operands[0];
                     dmRender::SetProjectionMatrix(render_context, *matrix);
-                    delete matrix;
+                    if (c->m_Operands[1] == MATRIX_OWNER_COMMAND)
+                        delete matrix;
                     break;
                 }
                 case COMMAND_TYPE_SET_BLEND_FUNC:
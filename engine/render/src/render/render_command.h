@@ -47,6 +47,14 @@ namespace dmRender
         COMMAND_TYPE_MAX
     };
 
+    /// Owner of the matrix in the first operand of SET_VIEW and SET_PROJECTION, stored in the second operand
+    enum MatrixOwner
+    {
+        MATRIX_OWNER_COMMAND = 0,   // Deleted when the command is executed
+        MATRIX_OWNER_STATIC  = 1,   // Deleted when the recorded static commands are released
+        MATRIX_OWNER_SLOT    = 2,   // A matrix slot of the render script instance
+    };
+
     struct Command
     {
         Command(CommandType type);
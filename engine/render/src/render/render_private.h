@@ -179,6 +179,17 @@ namespace dmRender
     {
         RenderListDispatchFn m_Fn;
         void *m_UserData;
+        uint32_t m_BatchCount;
+        uint32_t m_ParallelFill : 1;
+    };
+
+    // A run of sorted render list entries with the same dispatch, batch key and minor order
+    struct RenderListBatch
+    {
+        uint32_t* m_Begin;
+        uint32_t* m_End;
+        uint32_t  m_BatchIndex;
+        uint8_t   m_Dispatch;
     };
 
     struct RenderListSortValue
@@ -207,6 +218,34 @@ namespace dmRender
         uint32_t m_Count;
     };
 
+    // Graphics state set by the previous render object, used by Draw to skip redundant calls.
+    // Only valid while m_Active is set, since render script commands may change state between draws.
+    struct RenderStateCache
+    {
+        struct CachedConstant
+        {
+            int32_t  m_Location;
+            uint32_t m_Size;        // Number of floats
+            float    m_Value[16];
+        };
+
+        static const uint32_t MAX_CONSTANT_COUNT = 32;
+
+        CachedConstant                  m_Constants[MAX_CONSTANT_COUNT];
+        uint32_t                        m_ConstantCount;
+        HMaterial                       m_TextureMaterial;
+        dmGraphics::HTexture            m_Textures[RenderObject::MAX_TEXTURE_COUNT];
+        dmGraphics::HVertexDeclaration  m_VertexDeclaration;
+        dmGraphics::HVertexBuffer       m_VertexBuffer;
+        dmGraphics::HProgram            m_VertexProgram;
+        StencilTestParams               m_StencilTestParams;
+        dmGraphics::BlendFactor         m_SourceBlendFactor;
+        dmGraphics::BlendFactor         m_DestinationBlendFactor;
+        uint8_t                         m_Active : 1;
+        uint8_t                         m_BlendFactorsSet : 1;
+        uint8_t                         m_StencilTestSet : 1;
+    };
+
     struct RenderContext
     {
         dmGraphics::HTexture        m_Textures[RenderObject::MAX_TEXTURE_COUNT];
@@ -224,6 +263,9 @@ namespace dmRender
         dmArray<uint32_t>           m_RenderListSortBuffer;
         dmArray<uint32_t>           m_RenderListSortIndices;
         dmArray<RenderListRange>    m_RenderListRanges;         // Maps tagmask to a range in the (sorted) render list
+        dmArray<RenderListBatch>    m_RenderListBatches;        // Batches of the current DrawRenderList, in sorted order
+
+        dmJobSystem::HContext       m_JobSystem;
 
         HFontMap                    m_SystemFontMap;
 
@@ -237,6 +279,10 @@ namespace dmRender
 
         dmMessage::HSocket          m_Socket;
 
+        RenderStateCache            m_StateCache;
+        uint32_t                    m_StateChangesIssued;   // Per frame, reset in RenderListBegin
+        uint32_t                    m_StateChangesSkipped;
+
         uint32_t                    m_OutOfResources : 1;
         uint32_t                    m_StencilBufferCleared : 1;
     };
@@ -250,6 +296,9 @@ namespace dmRender
     Result GenerateKey(HRenderContext render_context, const Matrix4& view_matrix);
 
     void ApplyRenderObjectConstants(HRenderContext render_context, HMaterial material, const struct RenderObject* ro);
+    // Sets a shader constant, unless Draw has already set the same value for the current program
+    void ApplyConstantV4(HRenderContext render_context, const Vector4* value, int32_t location);
+    void ApplyConstantM4(HRenderContext render_context, const Vector4* value, int32_t location);
 
 
     // Exposed here for unit testing
@@ -332,6 +332,81 @@ namespace dmRender
         return true;
     }
 
+    static MatrixSlot* GetMatrixSlot(RenderScriptInstance* i, dmhash_t name)
+    {
+        for (uint32_t s = 0; s < i->m_MatrixSlotCount; ++s)
+        {
+            if (i->m_MatrixSlots[s].m_Name == name)
+                return &i->m_MatrixSlots[s];
+        }
+        if (i->m_MatrixSlotCount == MAX_MATRIX_SLOT_COUNT)
+            return 0;
+        MatrixSlot* slot = &i->m_MatrixSlots[i->m_MatrixSlotCount++];
+        slot->m_Name = name;
+        slot->m_Matrix = Vectormath::Aos::Matrix4::identity();
+        return slot;
+    }
+
+    static void ReleaseStaticCommands(lua_State* L, RenderScriptInstance* i)
+    {
+        if (i->m_StaticState == STATIC_STATE_RECORDING || i->m_StaticState == STATIC_STATE_REPLAY)
+        {
+            for (uint32_t c = 0; c < i->m_CommandBuffer.Size(); ++c)
+            {
+                Command& command = i->m_CommandBuffer[c];
+                if ((command.m_Type == COMMAND_TYPE_SET_VIEW || command.m_Type == COMMAND_TYPE_SET_PROJECTION) && command.m_Operands[1] == MATRIX_OWNER_STATIC)
+                {
+                    // The commands of the update being recorded are still to be executed
+                    if (i->m_InUpdate)
+                        command.m_Operands[1] = MATRIX_OWNER_COMMAND;
+                    else
+                        delete (Vectormath::Aos::Matrix4*)command.m_Operands[0];
+                }
+            }
+            if (!i->m_InUpdate)
+                i->m_CommandBuffer.SetSize(0);
+        }
+
+        for (uint32_t r = 0; r < i->m_StaticReferences.Size(); ++r)
+        {
+            dmScript::Unref(L, LUA_REGISTRYINDEX, i->m_StaticReferences[r]);
+        }
+        i->m_StaticReferences.SetSize(0);
+        i->m_StaticState = STATIC_STATE_NONE;
+    }
+
+    static int InsertMatrixCommand(lua_State* L, CommandType type)
+    {
+        RenderScriptInstance* i = RenderScriptInstance_Check(L);
+        Vectormath::Aos::Matrix4 value = *dmScript::CheckMatrix4(L, 1);
+
+        Vectormath::Aos::Matrix4* matrix = 0;
+        uintptr_t owner = MATRIX_OWNER_COMMAND;
+        if (!lua_isnoneornil(L, 2))
+        {
+            MatrixSlot* slot = GetMatrixSlot(i, dmScript::CheckHashOrString(L, 2));
+            if (!slot)
+                return luaL_error(L, "Could not create more matrix slots since the buffer is full (%d).", MAX_MATRIX_SLOT_COUNT);
+            slot->m_Matrix = value;
+            matrix = &slot->m_Matrix;
+            owner = MATRIX_OWNER_SLOT;
+        }
+        else
+        {
+            matrix = new Vectormath::Aos::Matrix4;
+            *matrix = value;
+            if (i->m_StaticState == STATIC_STATE_RECORDING)
+                owner = MATRIX_OWNER_STATIC;
+        }
+
+        if (InsertCommand(i, Command(type, (uintptr_t)matrix, owner)))
+            return 0;
+
+        if (owner != MATRIX_OWNER_SLOT)
+            delete matrix;
+        return luaL_error(L, "Command buffer is full (%d).", i->m_CommandBuffer.Capacity());
+    }
+
     /*#
      * @name render.STATE_DEPTH_TEST
      * @variable
@@ -1321,10 +1396,18 @@ namespace dmRender
             constant_buffer = *tmp;
         }
 
-        if (InsertCommand(i, Command(COMMAND_TYPE_DRAW, (uintptr_t)predicate, (uintptr_t) constant_buffer)))
-            return 0;
-        else
+        if (!InsertCommand(i, Command(COMMAND_TYPE_DRAW, (uintptr_t)predicate, (uintptr_t) constant_buffer)))
             return luaL_error(L, "Command buffer is full (%d).", i->m_CommandBuffer.Capacity());
+
+        if (constant_buffer && i->m_StaticState == STATIC_STATE_RECORDING)
+        {
+            // Keep the constant buffer alive for as long as the command is replayed
+            if (i->m_StaticReferences.Full())
+                i->m_StaticReferences.OffsetCapacity(16);
+            lua_pushvalue(L, 2);
+            i->m_StaticReferences.Push(dmScript::Ref(L, LUA_REGISTRYINDEX));
+        }
+        return 0;
     }
 
     /*# draws all 3d debug graphics
@@ -1366,8 +1449,13 @@ namespace dmRender
      *
      * Sets the view matrix to use when rendering.
      *
+     * If a slot is given, the matrix is stored in the named matrix slot and the command
+     * uses the value of the slot when it is executed. The slot can then be changed with
+     * [ref:render.set_matrix_slot] without recording static commands again.
+     *
      * @name render.set_view
      * @param matrix [type:matrix4] view matrix to set
+     * @param [slot] [type:string|hash] optional matrix slot to store the matrix in
      * @examples
      *
      * How to set the view and projection matrices according to
@@ -1396,22 +1484,18 @@ namespace dmRender
      */
     int RenderScript_SetView(lua_State* L)
     {
-        RenderScriptInstance* i = RenderScriptInstance_Check(L);
-        Vectormath::Aos::Matrix4 view = *dmScript::CheckMatrix4(L, 1);
-
-        Vectormath::Aos::Matrix4* matrix = new Vectormath::Aos::Matrix4;
-        *matrix = view;
-        if (InsertCommand(i, Command(COMMAND_TYPE_SET_VIEW, (uintptr_t)matrix)))
-            return 0;
-        else
-            return luaL_error(L, "Command buffer is full (%d).", i->m_CommandBuffer.Capacity());
+        return InsertMatrixCommand(L, COMMAND_TYPE_SET_VIEW);
     }
 
     /*# sets the projection matrix
      * Sets the projection matrix to use when rendering.
      *
+     * If a slot is given, the matrix is stored in the named matrix slot and the command
+     * uses the value of the slot when it is executed, see [ref:render.set_view].
+     *
      * @name render.set_projection
      * @param matrix [type:matrix4] projection matrix
+     * @param [slot] [type:string|hash] optional matrix slot to store the matrix in
      * @examples
      *
      * How to set the projection to orthographic with world origo at lower left,
@@ -1422,15 +1506,101 @@ namespace dmRender
      * ```
      */
     int RenderScript_SetProjection(lua_State* L)
+    {
+        return InsertMatrixCommand(L, COMMAND_TYPE_SET_PROJECTION);
+    }
+
+    /*# sets the matrix of a matrix slot
+     *
+     * Sets the matrix of a named matrix slot. Commands from [ref:render.set_view] and
+     * [ref:render.set_projection] that refer to the slot use the new value the next time
+     * they are executed, which is how static commands are given a new camera.
+     *
+     * @name render.set_matrix_slot
+     * @param slot [type:string|hash] the matrix slot
+     * @param matrix [type:matrix4] the matrix
+     * @examples
+     *
+     * ```lua
+     * function on_message(self, message_id, message)
+     *   if message_id == hash("set_view_projection") then
+     *      render.set_matrix_slot("view", message.view)
+     *      render.set_matrix_slot("projection", message.projection)
+     *   end
+     * end
+     * ```
+     */
+    int RenderScript_SetMatrixSlot(lua_State* L)
     {
         RenderScriptInstance* i = RenderScriptInstance_Check(L);
-        Vectormath::Aos::Matrix4 projection = *dmScript::CheckMatrix4(L, 1);
-        Vectormath::Aos::Matrix4* matrix = new Vectormath::Aos::Matrix4;
-        *matrix = projection;
-        if (InsertCommand(i, Command(COMMAND_TYPE_SET_PROJECTION, (uintptr_t)matrix)))
-            return 0;
+        dmhash_t name = dmScript::CheckHashOrString(L, 1);
+        Vectormath::Aos::Matrix4 value = *dmScript::CheckMatrix4(L, 2);
+        MatrixSlot* slot = GetMatrixSlot(i, name);
+        if (!slot)
+            return luaL_error(L, "Could not create more matrix slots since the buffer is full (%d).", MAX_MATRIX_SLOT_COUNT);
+        slot->m_Matrix = value;
+        return 0;
+    }
+
+    /*# replays the render commands without calling update
+     *
+     * When enabled, the commands issued by the next call to `update` are recorded, and
+     * on the following frames they are executed again without calling `update`.
+     * Use matrix slots ([ref:render.set_view], [ref:render.set_projection]) and constant
+     * buffers to change the parameters of the recorded commands, e.g. from `on_message`.
+     *
+     * Disable it when the commands need to change, e.g. when the window is resized or a
+     * render target is deleted, and `update` is called again the next frame.
+     *
+     * If called from `update`, it has to be called before any other render commands and
+     * the commands of the current update are recorded.
+     *
+     * @name render.set_static
+     * @param enable [type:boolean] true to record and replay the commands, false to call update every frame again
+     * @examples
+     *
+     * ```lua
+     * function update(self)
+     *   render.set_static(true)
+     *   render.set_view(self.view, "view")
+     *   render.set_projection(self.projection, "projection")
+     *   render.draw(self.tile_pred, self.constants)
+     * end
+     *
+     * function on_message(self, message_id, message)
+     *   if message_id == hash("set_view_projection") then
+     *      render.set_matrix_slot("view", message.view)
+     *      render.set_matrix_slot("projection", message.projection)
+     *   elseif message_id == hash("window_resized") then
+     *      render.set_static(false)
+     *   end
+     * end
+     * ```
+     */
+    int RenderScript_SetStatic(lua_State* L)
+    {
+        RenderScriptInstance* i = RenderScriptInstance_Check(L);
+        if (lua_toboolean(L, 1))
+        {
+            if (i->m_StaticState == STATIC_STATE_NONE)
+            {
+                if (i->m_InUpdate)
+                {
+                    if (i->m_CommandBuffer.Size() > 0)
+                        return luaL_error(L, "render.set_static(true) must be called before any render commands in update.");
+                    i->m_StaticState = STATIC_STATE_RECORDING;
+                }
+                else
+                {
+                    i->m_StaticState = STATIC_STATE_REQUESTED;
+                }
+            }
+        }
         else
-            return luaL_error(L, "Command buffer is full (%d).", i->m_CommandBuffer.Capacity());
+        {
+            ReleaseStaticCommands(L, i);
+        }
+        return 0;
     }
 
     /*#
@@ -2334,6 +2504,8 @@ namespace dmRender
         {"set_viewport",                    RenderScript_SetViewport},
         {"set_view",                        RenderScript_SetView},
         {"set_projection",                  RenderScript_SetProjection},
+        {"set_matrix_slot",                 RenderScript_SetMatrixSlot},
+        {"set_static",                      RenderScript_SetStatic},
         {"set_blend_func",                  RenderScript_SetBlendFunc},
         {"set_color_mask",                  RenderScript_SetColorMask},
         {"set_depth_mask",                  RenderScript_SetDepthMask},
@@ -2694,6 +2866,8 @@ bail:
         lua_pushnil(L);
         dmScript::SetInstance(L);
 
+        ReleaseStaticCommands(L, render_script_instance);
+
         dmScript::Unref(L, LUA_REGISTRYINDEX, render_script_instance->m_InstanceReference);
         dmScript::Unref(L, LUA_REGISTRYINDEX, render_script_instance->m_RenderScriptDataReference);
         dmScript::Unref(L, LUA_REGISTRYINDEX, render_script_instance->m_ContextTableReference);
@@ -2709,6 +2883,7 @@ bail:
 
     void SetRenderScriptInstanceRenderScript(HRenderScriptInstance render_script_instance, HRenderScript render_script)
     {
+        ReleaseStaticCommands(render_script_instance->m_RenderContext->m_RenderScriptContext.m_LuaState, render_script_instance);
         render_script_instance->m_RenderScript = render_script;
     }
 
@@ -2883,11 +3058,35 @@ bail:
     RenderScriptResult UpdateRenderScriptInstance(HRenderScriptInstance instance, float dt)
     {
         DM_PROFILE(RenderScript, "UpdateRSI");
-        instance->m_CommandBuffer.SetSize(0);
-
         dmScript::UpdateScriptWorld(instance->m_ScriptWorld, dt);
 
+        if (instance->m_StaticState == STATIC_STATE_REPLAY)
+        {
+            if (instance->m_CommandBuffer.Size() > 0)
+                ParseCommands(instance->m_RenderContext, &instance->m_CommandBuffer.Front(), instance->m_CommandBuffer.Size());
+            return RENDER_SCRIPT_RESULT_OK;
+        }
+
+        instance->m_CommandBuffer.SetSize(0);
+        if (instance->m_StaticState == STATIC_STATE_REQUESTED)
+            instance->m_StaticState = STATIC_STATE_RECORDING;
+
+        instance->m_InUpdate = 1;
         RenderScriptResult result = RunScript(instance, RENDER_SCRIPT_FUNCTION_UPDATE, (void*)&dt);
+        if (instance->m_StaticState == STATIC_STATE_RECORDING)
+        {
+            if (result == RENDER_SCRIPT_RESULT_OK)
+            {
+                instance->m_StaticState = STATIC_STATE_REPLAY;
+            }
+            else
+            {
+                // Don't replay the commands of a failed update, record the next one instead
+                ReleaseStaticCommands(instance->m_RenderContext->m_RenderScriptContext.m_LuaState, instance);
+                instance->m_StaticState = STATIC_STATE_REQUESTED;
+            }
+        }
+        instance->m_InUpdate = 0;
 
         if (instance->m_CommandBuffer.Size() > 0)
             ParseCommands(instance->m_RenderContext, &instance->m_CommandBuffer.Front(), instance->m_CommandBuffer.Size());
@@ -2896,6 +3095,7 @@ bail:
 
     void OnReloadRenderScriptInstance(HRenderScriptInstance render_script_instance)
     {
+        ReleaseStaticCommands(render_script_instance->m_RenderContext->m_RenderScriptContext.m_LuaState, render_script_instance);
         RunScript(render_script_instance, RENDER_SCRIPT_FUNCTION_ONRELOAD, 0x0);
     }
 }
@@ -42,19 +42,42 @@ namespace dmRender
         int             m_InstanceReference;
     };
 
+    enum StaticState
+    {
+        STATIC_STATE_NONE,
+        STATIC_STATE_REQUESTED,     // Record the commands of the next update
+        STATIC_STATE_RECORDING,     // Recording the commands of the current update
+        STATIC_STATE_REPLAY,        // Replaying the recorded commands instead of running update
+    };
+
+    /// Named matrix that set_view/set_projection commands can refer to, so it can be changed
+    /// without recording the commands again
+    struct MatrixSlot
+    {
+        Vectormath::Aos::Matrix4    m_Matrix;
+        dmhash_t                    m_Name;
+    };
+
     static const uint32_t MAX_PREDICATE_COUNT = 64;
+    static const uint32_t MAX_MATRIX_SLOT_COUNT = 16;
     struct RenderScriptInstance
     {
         dmArray<Command>            m_CommandBuffer;
         dmHashTable64<HMaterial>    m_Materials;
         Predicate*                  m_Predicates[MAX_PREDICATE_COUNT];
+        MatrixSlot                  m_MatrixSlots[MAX_MATRIX_SLOT_COUNT];
+        /// Lua references keeping the constant buffers of the static commands alive
+        dmArray<int>                m_StaticReferences;
         RenderContext*              m_RenderContext;
         HRenderScript               m_RenderScript;
         dmScript::ScriptWorld*      m_ScriptWorld;
         uint32_t                    m_PredicateCount;
+        uint32_t                    m_MatrixSlotCount;
         int                         m_InstanceReference;
         int                         m_RenderScriptDataReference;
         int                         m_ContextTableReference;
+        StaticState                 m_StaticState;
+        uint8_t                     m_InUpdate:1;
     };
 
     void InitializeRenderScriptContext(RenderScriptContext& context, dmScript::HContext script_context, uint32_t command_buffer_size);
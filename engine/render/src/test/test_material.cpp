@@ -178,6 +178,79 @@ TEST(dmMaterialTest, TestMaterialConstantsOverride)
     dmScript::DeleteContext(params.m_ScriptContext);
 }
 
+TEST(dmMaterialTest, TestDrawSkipsRedundantState)
+{
+    dmGraphics::Initialize();
+    dmGraphics::HContext context = dmGraphics::NewContext(dmGraphics::ContextParams());
+    dmRender::RenderContextParams params;
+    params.m_ScriptContext = dmScript::NewContext(0, 0, true);
+    params.m_MaxInstances = 2;
+    dmRender::HRenderContext render_context = dmRender::NewRenderContext(context, params);
+
+    dmGraphics::ShaderDesc::Shader vp_shader = MakeDDFShader("uniform vec4 tint;\n", 19);
+    dmGraphics::HVertexProgram vp = dmGraphics::NewVertexProgram(context, &vp_shader);
+    dmGraphics::ShaderDesc::Shader fp_shader = MakeDDFShader("foo", 3);
+    dmGraphics::HFragmentProgram fp = dmGraphics::NewFragmentProgram(context, &fp_shader);
+    dmRender::HMaterial material = dmRender::NewMaterial(render_context, vp, fp);
+
+    dmGraphics::VertexElement ve[] =
+    {
+        {"position", 0, 3, dmGraphics::TYPE_FLOAT, false},
+    };
+    dmGraphics::HVertexDeclaration vertex_declaration = dmGraphics::NewVertexDeclaration(context, ve, 1);
+    float vertices[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+    dmGraphics::HVertexBuffer vertex_buffer = dmGraphics::NewVertexBuffer(context, sizeof(vertices), vertices, dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+
+    // Two objects sharing all state, so everything but the draw call is redundant for the second one
+    dmRender::RenderObject ro[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        ro[i].m_Material = material;
+        ro[i].m_VertexDeclaration = vertex_declaration;
+        ro[i].m_VertexBuffer = vertex_buffer;
+        ro[i].m_PrimitiveType = dmGraphics::PRIMITIVE_TRIANGLES;
+        ro[i].m_VertexCount = 3;
+        ro[i].m_SetBlendFactors = 1;
+        ro[i].m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
+        ro[i].m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        ASSERT_EQ(dmRender::RESULT_OK, dmRender::AddToRender(render_context, &ro[i]));
+    }
+
+    dmRender::RenderListBegin(render_context);
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::Draw(render_context, 0x0, 0x0));
+
+    // program, tint, blend factors and vertex declaration
+    uint32_t issued = 0;
+    uint32_t skipped = 0;
+    dmRender::GetStateChangeCounts(render_context, &issued, &skipped);
+    ASSERT_EQ(4u, issued);
+    ASSERT_EQ(4u, skipped);
+
+    const Vector4& v = dmGraphics::GetConstantV4Ptr(context, 0);
+    ASSERT_EQ(0.0f, v.getX());
+    ASSERT_EQ(0.0f, v.getW());
+
+    // A render object constant overriding the material value must still be set
+    dmRender::EnableRenderObjectConstant(&ro[1], dmHashString64("tint"), Vector4(5.0f, 6.0f, 7.0f, 8.0f));
+    dmRender::RenderListBegin(render_context);
+    ASSERT_EQ(dmRender::RESULT_OK, dmRender::Draw(render_context, 0x0, 0x0));
+    dmRender::GetStateChangeCounts(render_context, &issued, &skipped);
+    ASSERT_EQ(5u, issued);
+    ASSERT_EQ(4u, skipped);
+    ASSERT_EQ(5.0f, v.getX());
+    ASSERT_EQ(8.0f, v.getW());
+
+    dmRender::ClearRenderObjects(render_context);
+    dmGraphics::DeleteVertexBuffer(vertex_buffer);
+    dmGraphics::DeleteVertexDeclaration(vertex_declaration);
+    dmGraphics::DeleteVertexProgram(vp);
+    dmGraphics::DeleteFragmentProgram(fp);
+    dmRender::DeleteMaterial(render_context, material);
+    dmRender::DeleteRenderContext(render_context, 0);
+    dmGraphics::DeleteContext(context);
+    dmScript::DeleteContext(params.m_ScriptContext);
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
@@ -15,7 +15,9 @@
 #include <jc_test/jc_test.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
 
+#include <dlib/atomic.h>
 #include <dlib/hash.h>
+#include <dlib/job_system.h>
 #include <dlib/math.h>
 
 #include <script/script.h>
@@ -321,6 +323,117 @@ TEST_F(dmRenderTest, TestRenderListDraw)
     ASSERT_EQ(ctx.m_Z, orders[1]);
 }
 
+struct TestParallelDispatchCtx
+{
+    static const uint32_t MAX_BATCHES = 32;
+    uint32_t        m_Reserved[MAX_BATCHES];    // Number of entries reserved per batch
+    uint32_t        m_Offsets[MAX_BATCHES];     // Offset into m_Data of each batch
+    uint32_t        m_Data[256];
+    uint32_t        m_ReserveCalls;
+    int32_atomic_t  m_FillCalls;
+    uint32_t        m_BatchCalls;
+    uint32_t        m_WriteOffset;
+    uint32_t        m_LastOrder;
+};
+
+static void TestParallelDispatch(dmRender::RenderListDispatchParams const & params)
+{
+    TestParallelDispatchCtx *ctx = (TestParallelDispatchCtx*) params.m_UserData;
+    switch (params.m_Operation)
+    {
+        case dmRender::RENDER_LIST_OPERATION_BEGIN:
+            ctx->m_WriteOffset = 0;
+            break;
+        case dmRender::RENDER_LIST_OPERATION_BATCH_RESERVE:
+            ASSERT_EQ(ctx->m_ReserveCalls, params.m_BatchIndex);
+            ASSERT_EQ(0, ctx->m_FillCalls);
+            ctx->m_ReserveCalls++;
+            ctx->m_Offsets[params.m_BatchIndex] = ctx->m_WriteOffset;
+            ctx->m_Reserved[params.m_BatchIndex] = params.m_End - params.m_Begin;
+            ctx->m_WriteOffset += params.m_End - params.m_Begin;
+            break;
+        case dmRender::RENDER_LIST_OPERATION_BATCH_FILL:
+            {
+                ASSERT_EQ(ctx->m_Reserved[params.m_BatchIndex], (uint32_t)(params.m_End - params.m_Begin));
+                uint32_t* out = &ctx->m_Data[ctx->m_Offsets[params.m_BatchIndex]];
+                for (uint32_t* i = params.m_Begin; i != params.m_End; ++i)
+                    *out++ = params.m_Buf[*i].m_Order;
+                dmAtomicIncrement32(&ctx->m_FillCalls);
+            }
+            break;
+        case dmRender::RENDER_LIST_OPERATION_BATCH:
+            {
+                ASSERT_EQ(ctx->m_ReserveCalls, (uint32_t)ctx->m_FillCalls);
+                ASSERT_EQ(ctx->m_BatchCalls, params.m_BatchIndex);
+                ctx->m_BatchCalls++;
+                // The filled data is complete and in sorted order
+                const uint32_t* data = &ctx->m_Data[ctx->m_Offsets[params.m_BatchIndex]];
+                for (uint32_t i = 0; i < ctx->m_Reserved[params.m_BatchIndex]; ++i)
+                {
+                    ASSERT_GT(data[i], ctx->m_LastOrder);
+                    ctx->m_LastOrder = data[i];
+                }
+            }
+            break;
+        default:
+            ASSERT_EQ(params.m_Operation, dmRender::RENDER_LIST_OPERATION_END);
+            ASSERT_EQ(ctx->m_ReserveCalls, ctx->m_BatchCalls);
+            break;
+    }
+}
+
+static void TestRenderListParallelDispatch(dmRender::HRenderContext context)
+{
+    TestParallelDispatchCtx ctx;
+    memset(&ctx, 0x00, sizeof(ctx));
+
+    dmRender::RenderListBegin(context);
+    uint8_t dispatch = dmRender::RenderListMakeParallelDispatch(context, TestParallelDispatch, &ctx);
+
+    const uint32_t n = 64;
+    dmRender::RenderListEntry* out = dmRender::RenderListAlloc(context, n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        dmRender::RenderListEntry & entry = out[i];
+        entry.m_WorldPosition = Point3(0,0,0);
+        entry.m_MajorOrder = dmRender::RENDER_ORDER_AFTER_WORLD;
+        entry.m_MinorOrder = 0;
+        entry.m_TagMask = 0;
+        entry.m_Order = n - i;
+        entry.m_BatchKey = (i / 3) & 15; // batches of one to three entries
+        entry.m_Dispatch = dispatch;
+        entry.m_UserData = 0;
+    }
+    dmRender::RenderListSubmit(context, out, out + n);
+    dmRender::RenderListEnd(context);
+
+    dmRender::DrawRenderList(context, 0, 0);
+
+    ASSERT_LT(1u, ctx.m_BatchCalls);
+    ASSERT_EQ(ctx.m_BatchCalls, ctx.m_ReserveCalls);
+    ASSERT_EQ(ctx.m_BatchCalls, (uint32_t)ctx.m_FillCalls);
+    ASSERT_EQ(n, ctx.m_WriteOffset);
+    ASSERT_EQ(n, ctx.m_LastOrder);
+}
+
+TEST_F(dmRenderTest, TestRenderListParallelDispatch)
+{
+    TestRenderListParallelDispatch(m_Context);
+}
+
+TEST_F(dmRenderTest, TestRenderListParallelDispatchJobSystem)
+{
+    dmJobSystem::NewContextParams params;
+    params.m_WorkerCount = 3;
+    dmJobSystem::HContext job_system = dmJobSystem::New(params);
+    dmRender::SetJobSystem(m_Context, job_system);
+
+    TestRenderListParallelDispatch(m_Context);
+
+    dmRender::SetJobSystem(m_Context, 0);
+    dmJobSystem::Delete(job_system);
+}
+
 struct TestRenderListOrderDispatchCtx
 {
     int m_BeginCalls;
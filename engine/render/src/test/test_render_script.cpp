@@ -1038,6 +1038,88 @@ TEST_F(dmRenderScriptTest, DeltaTime)
     dmRender::DeleteRenderScript(m_Context, render_script);
 }
 
+static void PostToRenderScript(const char* message)
+{
+    dmMessage::URL sender;
+    dmMessage::ResetURL(sender);
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(receiver);
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::GetSocket(dmRender::RENDER_SOCKET_NAME, &receiver.m_Socket));
+    ASSERT_EQ(dmMessage::RESULT_OK, dmMessage::Post(&sender, &receiver, dmHashString64(message), 0, 0, 0, 0, 0));
+}
+
+TEST_F(dmRenderScriptTest, TestStaticCommands)
+{
+    const char* script =
+    "function init(self)\n"
+    "    self.pred = render.predicate({\"one\"})\n"
+    "end\n"
+    "function update(self)\n"
+    "    assert(not self.recorded, \"update called while static\")\n"
+    "    self.recorded = true\n"
+    "    render.set_static(true)\n"
+    "    local constants = render.constant_buffer()\n"
+    "    constants.tint = vmath.vector4(1, 0, 0, 1)\n"
+    "    render.set_view(vmath.matrix4_translation(vmath.vector3(1, 0, 0)), \"view\")\n"
+    "    render.set_projection(vmath.matrix4())\n"
+    "    render.draw(self.pred, constants)\n"
+    "end\n"
+    "function on_message(self, message_id, message)\n"
+    "    if message_id == hash(\"move\") then\n"
+    "        render.set_matrix_slot(\"view\", vmath.matrix4_translation(vmath.vector3(2, 0, 0)))\n"
+    "        collectgarbage(\"collect\")\n"
+    "    elseif message_id == hash(\"invalidate\") then\n"
+    "        self.recorded = false\n"
+    "        render.set_static(false)\n"
+    "    end\n"
+    "end\n";
+    dmRender::HRenderScript render_script = dmRender::NewRenderScript(m_Context, LuaSourceFromString(script));
+    dmRender::HRenderScriptInstance render_script_instance = dmRender::NewRenderScriptInstance(m_Context, render_script);
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::InitRenderScriptInstance(render_script_instance));
+
+    // The first update records the commands, the following ones replay them without running update
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::UpdateRenderScriptInstance(render_script_instance, 0.0f));
+    ASSERT_EQ(dmRender::STATIC_STATE_REPLAY, render_script_instance->m_StaticState);
+    ASSERT_EQ(3u, render_script_instance->m_CommandBuffer.Size());
+    ASSERT_EQ(1.0f, m_Context->m_View.getTranslation().getX());
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::UpdateRenderScriptInstance(render_script_instance, 0.0f));
+    ASSERT_EQ(1.0f, m_Context->m_View.getTranslation().getX());
+
+    // Changing the matrix slot changes the replayed view
+    PostToRenderScript("move");
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::DispatchRenderScriptInstance(render_script_instance));
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::UpdateRenderScriptInstance(render_script_instance, 0.0f));
+    ASSERT_EQ(2.0f, m_Context->m_View.getTranslation().getX());
+
+    // Disabling it calls update again, which records new commands
+    PostToRenderScript("invalidate");
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::DispatchRenderScriptInstance(render_script_instance));
+    ASSERT_EQ(dmRender::STATIC_STATE_NONE, render_script_instance->m_StaticState);
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_OK, dmRender::UpdateRenderScriptInstance(render_script_instance, 0.0f));
+    ASSERT_EQ(dmRender::STATIC_STATE_REPLAY, render_script_instance->m_StaticState);
+    ASSERT_EQ(1.0f, m_Context->m_View.getTranslation().getX());
+
+    dmRender::DeleteRenderScriptInstance(render_script_instance);
+    dmRender::DeleteRenderScript(m_Context, render_script);
+}
+
+TEST_F(dmRenderScriptTest, TestStaticCommandsAfterCommands)
+{
+    const char* script =
+    "function update(self)\n"
+    "    render.set_viewport(0, 0, 1, 1)\n"
+    "    render.set_static(true)\n"
+    "end\n";
+    dmRender::HRenderScript render_script = dmRender::NewRenderScript(m_Context, LuaSourceFromString(script));
+    dmRender::HRenderScriptInstance render_script_instance = dmRender::NewRenderScriptInstance(m_Context, render_script);
+
+    ASSERT_EQ(dmRender::RENDER_SCRIPT_RESULT_FAILED, dmRender::UpdateRenderScriptInstance(render_script_instance, 0.0f));
+    ASSERT_EQ(dmRender::STATIC_STATE_NONE, render_script_instance->m_StaticState);
+
+    dmRender::DeleteRenderScriptInstance(render_script_instance);
+    dmRender::DeleteRenderScript(m_Context, render_script);
+}
+
 int main(int argc, char **argv)
 {
     dmDDF::RegisterAllTypes();
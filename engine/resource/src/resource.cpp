@@ -69,6 +69,8 @@ extern dmDDF::Descriptor dmLiveUpdateDDF_ManifestFile_DESCRIPTOR;
 namespace dmResource
 {
 const int DEFAULT_BUFFER_SIZE = 1024 * 1024;
+// Number of connections used to verify the http cache
+const uint32_t HTTP_CACHE_VERIFY_CONNECTIONS = 4;
 
 #define RESOURCE_SOCKET_NAME "@resource"
 #define LIVEUPDATE_MANIFEST_FILENAME "liveupdate.dmanifest"
@@ -99,6 +101,9 @@ struct SResourceFactory
     // with GetRaw (used for async threaded loading). Liveupdate, HttpClient, m_Buffer
     // m_BuiltinsManifest, m_Manifest
     dmMutex::HMutex                              m_LoadMutex;
+    // Guards reads from the archive files, which are shared between the loader and
+    // open resource streams. Taken after m_LoadMutex when both are needed
+    dmMutex::HMutex                              m_ArchiveMutex;
 
     // dmResource::Get recursion depth
     uint32_t                                     m_RecursionDepth;
@@ -110,6 +115,7 @@ struct SResourceFactory
     dmURI::Parts                                 m_UriParts;
     dmHttpClient::HClient                        m_HttpClient;
     dmHttpCache::HCache                          m_HttpCache;
+    dmHttpCacheVerify::HAsyncVerify              m_HttpCacheVerify;
     LoadBufferType*                              m_HttpBuffer;
 
     dmArray<char>                                m_Buffer;
@@ -568,6 +574,12 @@ Result NewArchiveIndexWithResource(Manifest* manifest, const uint8_t* hashDigest
     return (result == dmResourceArchive::RESULT_OK) ? RESULT_OK : RESULT_INVAL;
 }
 
+Result NewArchiveIndexWithResources(Manifest* manifest, const uint8_t* hash_digests, uint32_t hash_digest_length, const dmResourceArchive::LiveUpdateResource* resources, uint32_t count, const char* proj_id, dmResourceArchive::HArchiveIndex& out_new_index, dmResourceArchive::Result* out_results)
+{
+    dmResourceArchive::Result result = dmResourceArchive::NewArchiveIndexWithResources(manifest->m_ArchiveIndex, hash_digests, hash_digest_length, resources, count, proj_id, out_new_index, out_results);
+    return (result == dmResourceArchive::RESULT_OK) ? RESULT_OK : RESULT_INVAL;
+}
+
 Result BundleVersionValid(const Manifest* manifest, const char* bundle_ver_path)
 {
     Result result = RESULT_OK;
@@ -654,11 +666,9 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
                 }
                 else
                 {
-                    dmHttpCacheVerify::Result verify_r = dmHttpCacheVerify::VerifyCache(factory->m_HttpCache, &factory->m_UriParts, dns_channel, 60 * 60 * 24 * 5); // 5 days
-                    // Http-cache batch verification might be unsupported
-                    // We currently does not have support for batch validation in the editor http-server
-                    // Batch validation was introduced when we had remote branch and latency problems
-                    if (verify_r != dmHttpCacheVerify::RESULT_OK && verify_r != dmHttpCacheVerify::RESULT_UNSUPPORTED)
+                    // Verify the cache in the background. Entries not yet verified are revalidated when loaded
+                    dmHttpCacheVerify::Result verify_r = dmHttpCacheVerify::VerifyCacheAsync(factory->m_HttpCache, &factory->m_UriParts, 60 * 60 * 24 * 5, HTTP_CACHE_VERIFY_CONNECTIONS, &factory->m_HttpCacheVerify); // 5 days
+                    if (verify_r != dmHttpCacheVerify::RESULT_OK)
                     {
                         dmLogWarning("Cache validation failed (%d)", verify_r);
                     }
@@ -835,6 +845,7 @@ HFactory NewFactory(NewFactoryParams* params, const char* uri)
     }
 
     factory->m_LoadMutex = dmMutex::New();
+    factory->m_ArchiveMutex = dmMutex::New();
     return factory;
 }
 
@@ -850,6 +861,10 @@ void DeleteFactory(HFactory factory)
         dmHttpClient::Delete(factory->m_HttpClient);
         dmDNS::DeleteChannel(dns_channel);
     }
+    if (factory->m_HttpCacheVerify)
+    {
+        dmHttpCacheVerify::DeleteAsync(factory->m_HttpCacheVerify);
+    }
     if (factory->m_HttpCache)
     {
         dmHttpCache::Close(factory->m_HttpCache);
@@ -858,6 +873,10 @@ void DeleteFactory(HFactory factory)
     {
         dmMutex::Delete(factory->m_LoadMutex);
     }
+    if (factory->m_ArchiveMutex)
+    {
+        dmMutex::Delete(factory->m_ArchiveMutex);
+    }
     if (factory->m_Manifest)
     {
         if (factory->m_Manifest->m_DDF)
@@ -926,9 +945,38 @@ static void Dispatch(dmMessage::Message* message, void* user_ptr)
     }
 }
 
+static void UpdateHttpCacheVerify(HFactory factory)
+{
+    if (!dmHttpCacheVerify::IsDone(factory->m_HttpCacheVerify))
+        return;
+
+    dmHttpCacheVerify::Result verify_r = dmHttpCacheVerify::GetResult(factory->m_HttpCacheVerify);
+    // Http-cache batch verification might be unsupported
+    // We currently does not have support for batch validation in the editor http-server
+    // Batch validation was introduced when we had remote branch and latency problems
+    if (verify_r != dmHttpCacheVerify::RESULT_OK && verify_r != dmHttpCacheVerify::RESULT_UNSUPPORTED)
+    {
+        dmLogWarning("Cache validation failed (%d)", verify_r);
+    }
+    else if (verify_r == dmHttpCacheVerify::RESULT_OK)
+    {
+        dmHttpCacheVerify::Statistics stats;
+        dmHttpCacheVerify::GetStatistics(factory->m_HttpCacheVerify, &stats);
+        dmLogInfo("Http cache verified: %u checked, %u reused, %u not reused", stats.m_Checked, stats.m_Reused, stats.m_NotReused);
+    }
+
+    dmHttpCacheVerify::DeleteAsync(factory->m_HttpCacheVerify);
+    factory->m_HttpCacheVerify = 0;
+}
+
 void UpdateFactory(HFactory factory)
 {
     dmMessage::Dispatch(factory->m_Socket, &Dispatch, factory);
+
+    if (factory->m_HttpCacheVerify)
+    {
+        UpdateHttpCacheVerify(factory);
+    }
 }
 
 Result RegisterType(HFactory factory,
@@ -1025,7 +1073,7 @@ Result VerifyResourcesBundled(HFactory factory, Manifest* manifest)
     return VerifyResourcesBundled(entries, entry_count, factory->m_Manifest->m_ArchiveIndex);
 }
 
-static Result LoadFromManifest(const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer)
+static Result LoadFromManifest(HFactory factory, const Manifest* manifest, const char* path, uint32_t* resource_size, LoadBufferType* buffer)
 {
     dmhash_t path_hash = dmHashString64(path);
 
@@ -1046,7 +1094,11 @@ static Result LoadFromManifest(const Manifest* manifest, const char* path, uint3
         }
 
         buffer->SetSize(0);
-        dmResourceArchive::Result read_result = dmResourceArchive::Read(manifest->m_ArchiveIndex, &ed, buffer->Begin());
+        dmResourceArchive::Result read_result;
+        {
+            dmMutex::ScopedLock lk(factory->m_ArchiveMutex);
+            read_result = dmResourceArchive::Read(manifest->m_ArchiveIndex, &ed, buffer->Begin());
+        }
         if (read_result != dmResourceArchive::RESULT_OK)
         {
             return RESULT_IO_ERROR;
@@ -1072,7 +1124,7 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
     DM_PROFILE(Resource, "LoadResource");
     if (factory->m_BuiltinsManifest)
     {
-        if (LoadFromManifest(factory->m_BuiltinsManifest, original_name, resource_size, buffer) == RESULT_OK)
+        if (LoadFromManifest(factory, factory->m_BuiltinsManifest, original_name, resource_size, buffer) == RESULT_OK)
         {
             return RESULT_OK;
         }
@@ -1126,7 +1178,7 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
     }
     else if (factory->m_Manifest)
     {
-        Result r = LoadFromManifest(factory->m_Manifest, original_name, resource_size, buffer);
+        Result r = LoadFromManifest(factory, factory->m_Manifest, original_name, resource_size, buffer);
         return r;
     }
     else
@@ -1160,6 +1212,140 @@ static Result DoLoadResourceLocked(HFactory factory, const char* path, const cha
     }
 }
 
+struct ResourceStream
+{
+    HFactory                                m_Factory;
+    // Archive the resource is read from, or 0 for a file on disc
+    dmResourceArchive::HArchiveIndexContainer m_Archive;
+    dmResourceArchive::EntryData            m_Entry;
+    // Kept open for as long as the stream is
+    FILE*                                   m_File;
+};
+
+static Result OpenStreamFromManifest(const Manifest* manifest, const char* path, ResourceStream* stream)
+{
+    int index = FindEntryIndex(manifest, dmHashString64(path));
+    if (index < 0) {
+        return RESULT_RESOURCE_NOT_FOUND; // Path not in manifest
+    }
+
+    dmLiveUpdateDDF::ResourceEntry* entries = manifest->m_DDFData->m_Resources.m_Data;
+    dmResourceArchive::Result res = dmResourceArchive::FindEntry(manifest->m_ArchiveIndex, entries[index].m_Hash.m_Data.m_Data, &stream->m_Entry);
+    if (res == dmResourceArchive::RESULT_NOT_FOUND)
+    {
+        return RESULT_RESOURCE_NOT_FOUND;
+    }
+    else if (res != dmResourceArchive::RESULT_OK)
+    {
+        return RESULT_IO_ERROR;
+    }
+
+    if (!dmResourceArchive::CanStream(&stream->m_Entry))
+    {
+        return RESULT_NOT_SUPPORTED;
+    }
+
+    stream->m_Archive = manifest->m_ArchiveIndex;
+    return RESULT_OK;
+}
+
+Result OpenResourceStream(HFactory factory, const char* name, HResourceStream* out_stream)
+{
+    DM_PROFILE(Resource, "OpenResourceStream");
+
+    assert(name);
+    assert(out_stream);
+    *out_stream = 0;
+
+    Result chk = CheckSuppliedResourcePath(name);
+    if (chk != RESULT_OK)
+        return chk;
+
+    ResourceStream stream;
+    stream.m_Factory = factory;
+    stream.m_Archive = 0;
+    stream.m_File = 0;
+
+    {
+        // Only opening the stream is serialized with the loader, the reads aren't
+        dmMutex::ScopedLock lk(factory->m_LoadMutex);
+
+        Result r = RESULT_RESOURCE_NOT_FOUND;
+        if (factory->m_BuiltinsManifest)
+        {
+            r = OpenStreamFromManifest(factory->m_BuiltinsManifest, name, &stream);
+        }
+
+        if (r == RESULT_RESOURCE_NOT_FOUND)
+        {
+            if (factory->m_HttpClient)
+            {
+                // Ranged requests are not supported by the resource http loader
+                return RESULT_NOT_SUPPORTED;
+            }
+            else if (factory->m_Manifest)
+            {
+                r = OpenStreamFromManifest(factory->m_Manifest, name, &stream);
+            }
+            else
+            {
+                char canonical_path[RESOURCE_PATH_MAX];
+                GetCanonicalPath(name, canonical_path);
+                char factory_path[RESOURCE_PATH_MAX];
+                GetCanonicalPathFromBase(factory->m_UriParts.m_Path, canonical_path, factory_path);
+
+                stream.m_File = fopen(factory_path, "rb");
+                r = stream.m_File ? RESULT_OK : RESULT_RESOURCE_NOT_FOUND;
+            }
+        }
+
+        if (r != RESULT_OK)
+        {
+            return r;
+        }
+    }
+
+    *out_stream = new ResourceStream(stream);
+    return RESULT_OK;
+}
+
+Result ReadResourceStream(HResourceStream stream, uint32_t offset, uint32_t size, void* buffer, uint32_t* nread)
+{
+    DM_PROFILE(Resource, "ReadResourceStream");
+
+    assert(nread);
+    *nread = 0;
+
+    if (stream->m_Archive)
+    {
+        // The archive file handle is shared with the loader
+        dmMutex::ScopedLock lk(stream->m_Factory->m_ArchiveMutex);
+        dmResourceArchive::Result res = dmResourceArchive::ReadRange(stream->m_Archive, &stream->m_Entry, offset, size, buffer, nread);
+        return res == dmResourceArchive::RESULT_OK ? RESULT_OK : RESULT_IO_ERROR;
+    }
+
+    if (fseek(stream->m_File, offset, SEEK_SET) != 0)
+    {
+        return RESULT_IO_ERROR;
+    }
+    *nread = (uint32_t) fread(buffer, 1, size, stream->m_File);
+    if (*nread != size && ferror(stream->m_File))
+    {
+        clearerr(stream->m_File);
+        return RESULT_IO_ERROR;
+    }
+    return RESULT_OK;
+}
+
+void CloseResourceStream(HResourceStream stream)
+{
+    if (stream->m_File)
+    {
+        fclose(stream->m_File);
+    }
+    delete stream;
+}
+
 // Takes the lock.
 Result DoLoadResource(HFactory factory, const char* path, const char* original_name, uint32_t* resource_size, LoadBufferType* buffer)
 {
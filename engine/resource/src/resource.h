@@ -136,6 +136,11 @@ namespace dmResource
     typedef struct ResourcePreloader* HPreloader;
     typedef struct PreloadHintInfo* HPreloadHintInfo;
 
+    /**
+     * Resource stream handle
+     */
+    typedef struct ResourceStream* HResourceStream;
+
     typedef uintptr_t ResourceType;
 
     /**
@@ -426,6 +431,36 @@ namespace dmResource
      */
     Result GetRaw(HFactory factory, const char* name, void** resource, uint32_t* resource_size);
 
+    /**
+     * Open a resource for reading its raw data in parts, without loading all of it. Used to
+     * stream large resources, e.g. music. Resources stored compressed or encrypted in the archive,
+     * added with liveupdate, or served over http, can't be streamed.
+     * Only opening the stream is serialized with the resource loader, so the reads can be
+     * made from any one thread while other resources are loading.
+     * @param factory Factory handle
+     * @param name Resource name
+     * @param stream Returned stream handle, close with CloseResourceStream
+     * @return RESULT_OK on success, RESULT_NOT_SUPPORTED if the resource can't be streamed
+     */
+    Result OpenResourceStream(HFactory factory, const char* name, HResourceStream* stream);
+
+    /**
+     * Read part of a resource opened with OpenResourceStream
+     * @param stream Stream handle
+     * @param offset Byte offset into the resource data
+     * @param size Number of bytes to read
+     * @param buffer Buffer to read to, at least size bytes
+     * @param nread Number of bytes read. Less than size at the end of the resource
+     * @return RESULT_OK on success
+     */
+    Result ReadResourceStream(HResourceStream stream, uint32_t offset, uint32_t size, void* buffer, uint32_t* nread);
+
+    /**
+     * Close a resource stream
+     * @param stream Stream handle
+     */
+    void CloseResourceStream(HResourceStream stream);
+
     /**
      * Updates a preexisting resource with new data
      * @param factory Factory handle
@@ -612,6 +647,19 @@ namespace dmResource
      */
     Result NewArchiveIndexWithResource(Manifest* manifest, const uint8_t* hash_digest, uint32_t hash_digest_length, const dmResourceArchive::LiveUpdateResource* resource, const char* proj_id, dmResourceArchive::HArchiveIndex& out_new_index);
 
+    /**
+     * Create new archive index with a batch of resources.
+     * @param manifest Manifest to use
+     * @param hash_digests Hash digests of the resources, hash_digest_length bytes each
+     * @param hash_digest_length Hash digest length
+     * @param resources LiveUpdate resources to create with
+     * @param count Number of resources
+     * @param out_new_index New archive index
+     * @param out_results Per resource archive result
+     * @return RESULT_OK on success
+     */
+    Result NewArchiveIndexWithResources(Manifest* manifest, const uint8_t* hash_digests, uint32_t hash_digest_length, const dmResourceArchive::LiveUpdateResource* resources, uint32_t count, const char* proj_id, dmResourceArchive::HArchiveIndex& out_new_index, dmResourceArchive::Result* out_results);
+
     /**
      * Determines if the resource could be unique
      * @param name Resource name
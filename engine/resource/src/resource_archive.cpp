@@ -23,6 +23,8 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
+
 #include "resource.h"
 #include "resource_archive_private.h"
 #include <dlib/dstrings.h>
@@ -522,6 +524,23 @@ namespace dmResourceArchive
         }
     }
 
+    static Result RemapLiveUpdateResourceData(ArchiveIndexContainer* archive, uint32_t mapped_size, uint32_t new_size)
+    {
+        void* temp_map = (void*)archive->m_LiveUpdateResourceData;
+        dmResource::UnmapFile(temp_map, mapped_size);
+        temp_map = 0x0;
+        uint32_t map_size = 0;
+        dmResource::Result res = dmResource::MapFile(archive->m_LiveUpdateResourcePath, temp_map, map_size);
+        if (res != dmResource::RESULT_OK)
+        {
+            dmLogError("Failed to map liveupdate respource file, result = %i", res);
+            return RESULT_IO_ERROR;
+        }
+        archive->m_LiveUpdateResourceData = (uint8_t*)temp_map;
+        archive->m_LiveUpdateResourceSize = new_size;
+        return RESULT_OK;
+    }
+
     Result WriteResourceToArchive(HArchiveIndexContainer& archive, const uint8_t* buf, size_t buf_len, uint32_t& bytes_written, uint32_t& offset)
     {
         fseek(archive->m_LiveUpdateFileResourceData, 0, SEEK_END);
@@ -539,23 +558,51 @@ namespace dmResourceArchive
         // We have written to the resource file, need to update mapping
         if (archive->m_LiveUpdateResourcesMemMapped)
         {
-            void* temp_map = (void*)archive->m_LiveUpdateResourceData;
-            dmResource::UnmapFile(temp_map, offset);
-            temp_map = 0x0;
-            uint32_t map_size = 0;
-            dmResource::Result res = dmResource::MapFile(archive->m_LiveUpdateResourcePath, temp_map, map_size);
-            if (res != dmResource::RESULT_OK)
+            return RemapLiveUpdateResourceData(archive, offset, offset + bytes_written);
+        }
+
+        return RESULT_OK;
+    }
+
+    Result WriteResourcesToArchive(HArchiveIndexContainer& archive, const dmResourceArchive::LiveUpdateResource* resources, const uint32_t* order, uint32_t count, uint32_t* out_offsets)
+    {
+        FILE* f = archive->m_LiveUpdateFileResourceData;
+        fseek(f, 0, SEEK_END);
+        uint32_t start = (uint32_t)ftell(f);
+        uint32_t offs = start;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const dmResourceArchive::LiveUpdateResource* resource = &resources[order[i]];
+            size_t bytes = fwrite(resource->m_Data, 1, resource->m_Count, f);
+            if (bytes != resource->m_Count)
             {
-                dmLogError("Failed to map liveupdate respource file, result = %i", res);
+                dmLogError("All bytes not written for resource, bytes written: %zu, resource size: %zu", bytes, resource->m_Count);
                 return RESULT_IO_ERROR;
             }
-            archive->m_LiveUpdateResourceData = (uint8_t*)temp_map;
-            archive->m_LiveUpdateResourceSize = offset + bytes_written;
+            out_offsets[i] = offs;
+            offs += (uint32_t)bytes;
+        }
+
+        fflush(f); // make sure all writes flushed before mem-mapping below
+
+        // Remap once for the whole batch
+        if (archive->m_LiveUpdateResourcesMemMapped)
+        {
+            return RemapLiveUpdateResourceData(archive, start, offs);
         }
 
         return RESULT_OK;
     }
 
+    static void SetLiveUpdateEntry(EntryData* entry, const dmResourceArchive::LiveUpdateResource* resource, uint32_t offset)
+    {
+        bool is_compressed = (resource->m_Header->m_Flags & ENTRY_FLAG_COMPRESSED);
+        entry->m_ResourceDataOffset = C_TO_JAVA(offset);
+        entry->m_ResourceSize = is_compressed ? resource->m_Header->m_Size : C_TO_JAVA(resource->m_Count);
+        entry->m_ResourceCompressedSize = is_compressed ? C_TO_JAVA(resource->m_Count) : (C_TO_JAVA(0xffffffff));
+        entry->m_Flags = C_TO_JAVA(resource->m_Header->m_Flags | ENTRY_FLAG_LIVEUPDATE_DATA);
+    }
+
     Result ShiftAndInsert(ArchiveIndexContainer* archive_container, ArchiveIndex* ai, const uint8_t* hash_digest, uint32_t hash_digest_len, int insertion_index, const dmResourceArchive::LiveUpdateResource* resource, const EntryData* lu_entry_data)
     {
         assert(insertion_index >= 0);
@@ -606,12 +653,7 @@ namespace dmResourceArchive
             }
 
             // Create entrydata instance and insert into index
-            bool is_compressed = (resource->m_Header->m_Flags & ENTRY_FLAG_COMPRESSED);
-            //EntryData entry;
-            entry.m_ResourceDataOffset = C_TO_JAVA(offs);
-            entry.m_ResourceSize = is_compressed ? resource->m_Header->m_Size : C_TO_JAVA(resource->m_Count);
-            entry.m_ResourceCompressedSize = is_compressed ? C_TO_JAVA(resource->m_Count) : (C_TO_JAVA(0xffffffff));
-            entry.m_Flags = C_TO_JAVA(resource->m_Header->m_Flags | ENTRY_FLAG_LIVEUPDATE_DATA);
+            SetLiveUpdateEntry(&entry, resource, offs);
             /// --- WRITE RESOURCE END
         }
 
@@ -620,6 +662,94 @@ namespace dmResourceArchive
         return RESULT_OK;
     }
 
+    struct HashDigestSortPred
+    {
+        HashDigestSortPred(const uint8_t* hash_digests, uint32_t hash_digest_len) : m_HashDigests(hash_digests), m_HashDigestLen(hash_digest_len) {}
+
+        bool operator ()(uint32_t a, uint32_t b) const
+        {
+            return memcmp(m_HashDigests + a * m_HashDigestLen, m_HashDigests + b * m_HashDigestLen, m_HashDigestLen) < 0;
+        }
+
+        const uint8_t* m_HashDigests;
+        uint32_t m_HashDigestLen;
+    };
+
+    uint32_t GetInsertionOrder(HArchiveIndexContainer archive, const uint8_t* hash_digests, uint32_t hash_digest_len, uint32_t count, uint32_t* out_order, Result* out_results)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            out_order[i] = i;
+        }
+        std::sort(out_order, out_order + count, HashDigestSortPred(hash_digests, hash_digest_len));
+
+        // Skip resources already in the index, as well as duplicates within the batch
+        uint32_t insert_count = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint8_t* hash = hash_digests + out_order[i] * hash_digest_len;
+            bool stored = FindEntry(archive, hash, 0x0) == RESULT_OK;
+            if (!stored && insert_count > 0)
+            {
+                stored = memcmp(hash, hash_digests + out_order[insert_count - 1] * hash_digest_len, hash_digest_len) == 0;
+            }
+
+            if (stored)
+            {
+                out_results[out_order[i]] = RESULT_ALREADY_STORED;
+            }
+            else
+            {
+                out_order[insert_count++] = out_order[i];
+            }
+        }
+        return insert_count;
+    }
+
+    Result InsertResources(ArchiveIndexContainer* archive_container, ArchiveIndex* ai, const uint8_t* hash_digests, uint32_t hash_digest_len, const dmResourceArchive::LiveUpdateResource* resources, const uint32_t* order, uint32_t count)
+    {
+        ArchiveIndex* archive = (ai == 0x0) ? archive_container->m_ArchiveIndex : ai;
+        uint8_t* hashes = (uint8_t*)((uintptr_t)archive + JAVA_TO_C(archive->m_HashOffset));
+        EntryData* entries = (EntryData*)((uintptr_t)archive + JAVA_TO_C(archive->m_EntryDataOffset));
+
+        uint32_t* offsets = (uint32_t*)malloc(count * sizeof(uint32_t));
+        Result write_res = WriteResourcesToArchive(archive_container, resources, order, count, offsets);
+        if (write_res != RESULT_OK)
+        {
+            free(offsets);
+            return write_res;
+        }
+
+        // Merge the sorted batch into the sorted index from the back, so that every existing entry is moved at most once
+        uint32_t hash_len = JAVA_TO_C(archive->m_HashLength);
+        int32_t src = (int32_t)JAVA_TO_C(archive->m_EntryDataCount) - 1;
+        int32_t batch = (int32_t)count - 1;
+        int32_t dst = src + (int32_t)count;
+        while (batch >= 0)
+        {
+            const uint8_t* batch_hash = hash_digests + order[batch] * hash_digest_len;
+            uint8_t* dst_hash = hashes + DMRESOURCE_MAX_HASH * dst;
+            if (src >= 0 && memcmp(hashes + DMRESOURCE_MAX_HASH * src, batch_hash, hash_len) > 0)
+            {
+                memcpy(dst_hash, hashes + DMRESOURCE_MAX_HASH * src, DMRESOURCE_MAX_HASH);
+                entries[dst] = entries[src];
+                --src;
+            }
+            else
+            {
+                memset(dst_hash, 0, DMRESOURCE_MAX_HASH);
+                memcpy(dst_hash, batch_hash, hash_digest_len);
+                SetLiveUpdateEntry(&entries[dst], &resources[order[batch]], offsets[batch]);
+                --batch;
+            }
+            --dst;
+        }
+
+        archive->m_EntryDataCount = C_TO_JAVA(JAVA_TO_C(archive->m_EntryDataCount) + count);
+        free(offsets);
+        return RESULT_OK;
+    }
+
     void CreateFilesIfNotExists(ArchiveIndexContainer* archive_container, const char* lu_index_path)
     {
         struct stat file_stat;
@@ -650,6 +780,45 @@ namespace dmResourceArchive
         }
     }
 
+    static Result GetLiveUpdateIndexPath(HArchiveIndexContainer archive_container, const char* proj_id, char* lu_index_path, uint32_t lu_index_path_len)
+    {
+        char app_support_path[DMPATH_MAX_PATH];
+        dmSys::Result support_path_result = dmSys::GetApplicationSupportPath(proj_id, app_support_path, DMPATH_MAX_PATH);
+        if (support_path_result != dmSys::RESULT_OK)
+        {
+            dmLogError("Failed get application support path for \"%s\", result = %i", proj_id, support_path_result);
+            return RESULT_NOT_FOUND;
+        }
+        dmPath::Concat(app_support_path, "liveupdate.arci", lu_index_path, lu_index_path_len);
+        CreateFilesIfNotExists(archive_container, lu_index_path);
+        return RESULT_OK;
+    }
+
+    static Result WriteLiveUpdateIndex(const char* lu_index_path, ArchiveIndex* ai)
+    {
+        // Write to temporary index file, filename liveupdate.arci.tmp
+        char lu_index_tmp_path[DMPATH_MAX_PATH];
+        dmStrlCpy(lu_index_tmp_path, lu_index_path, DMPATH_MAX_PATH);
+        dmStrlCat(lu_index_tmp_path, ".tmp", DMPATH_MAX_PATH);
+        FILE* f_lu_index = fopen(lu_index_tmp_path, "wb");
+        if (!f_lu_index)
+        {
+            dmLogError("Failed to create liveupdate index file");
+            return RESULT_IO_ERROR;
+        }
+        uint32_t entry_count = JAVA_TO_C(ai->m_EntryDataCount);
+        uint32_t total_size = sizeof(ArchiveIndex) + entry_count * DMRESOURCE_MAX_HASH + entry_count * sizeof(EntryData);
+        if (fwrite((void*)ai, 1, total_size, f_lu_index) != total_size)
+        {
+            fclose(f_lu_index);
+            dmLogError("Failed to write liveupdate index file");
+            return RESULT_IO_ERROR;
+        }
+        fflush(f_lu_index);
+        fclose(f_lu_index);
+        return RESULT_OK;
+    }
+
     Result NewArchiveIndexWithResource(HArchiveIndexContainer archive_container, const uint8_t* hash_digest, uint32_t hash_digest_len, const dmResourceArchive::LiveUpdateResource* resource, const char* proj_id, HArchiveIndex& out_new_index)
     {
         out_new_index = 0x0;
@@ -662,18 +831,12 @@ namespace dmResourceArchive
             return index_result;
         }
 
-        char app_support_path[DMPATH_MAX_PATH];
         char lu_index_path[DMPATH_MAX_PATH];
-        char lu_index_tmp_path[DMPATH_MAX_PATH];
-
-        dmSys::Result support_path_result = dmSys::GetApplicationSupportPath(proj_id, app_support_path, DMPATH_MAX_PATH);
-        if (support_path_result != dmSys::RESULT_OK)
+        Result path_result = GetLiveUpdateIndexPath(archive_container, proj_id, lu_index_path, DMPATH_MAX_PATH);
+        if (path_result != RESULT_OK)
         {
-            dmLogError("Failed get application support path for \"%s\", result = %i", proj_id, support_path_result);
-            return RESULT_NOT_FOUND;
+            return path_result;
         }
-        dmPath::Concat(app_support_path, "liveupdate.arci", lu_index_path, DMPATH_MAX_PATH);
-        CreateFilesIfNotExists(archive_container, lu_index_path);
 
         // Make deep-copy. Operate on this and only overwrite when done inserting
         ArchiveIndex* ai_temp = 0x0;
@@ -689,31 +852,62 @@ namespace dmResourceArchive
             return insert_result;
         }
 
-        // Write to temporary index file, filename liveupdate.arci.tmp
-        dmStrlCpy(lu_index_tmp_path, lu_index_path, DMPATH_MAX_PATH);
-        dmStrlCat(lu_index_tmp_path, ".tmp", DMPATH_MAX_PATH);
-        FILE* f_lu_index = fopen(lu_index_tmp_path, "wb");
-        if (!f_lu_index)
+        Result write_result = WriteLiveUpdateIndex(lu_index_path, ai_temp);
+        if (write_result != RESULT_OK)
         {
-            dmLogError("Failed to create liveupdate index file");
-            return RESULT_IO_ERROR;
+            return write_result;
         }
-        uint32_t entry_count = JAVA_TO_C(ai_temp->m_EntryDataCount);
-        uint32_t total_size = sizeof(ArchiveIndex) + entry_count * DMRESOURCE_MAX_HASH + entry_count * sizeof(EntryData);
-        if (fwrite((void*)ai_temp, 1, total_size, f_lu_index) != total_size)
-        {
-            fclose(f_lu_index);
-            dmLogError("Failed to write liveupdate index file");
-            return RESULT_IO_ERROR;
-        }
-        fflush(f_lu_index);
-        fclose(f_lu_index);
 
         // set result
         out_new_index = ai_temp;
         return RESULT_OK;
     }
 
+    Result NewArchiveIndexWithResources(HArchiveIndexContainer archive_container, const uint8_t* hash_digests, uint32_t hash_digest_len, const dmResourceArchive::LiveUpdateResource* resources, uint32_t count, const char* proj_id, HArchiveIndex& out_new_index, Result* out_results)
+    {
+        out_new_index = 0x0;
+
+        uint32_t* order = (uint32_t*)malloc(count * sizeof(uint32_t));
+        uint32_t insert_count = GetInsertionOrder(archive_container, hash_digests, hash_digest_len, count, order, out_results);
+
+        Result result = RESULT_ALREADY_STORED;
+        if (insert_count > 0)
+        {
+            char lu_index_path[DMPATH_MAX_PATH];
+            result = GetLiveUpdateIndexPath(archive_container, proj_id, lu_index_path, DMPATH_MAX_PATH);
+            if (result == RESULT_OK)
+            {
+                // Make deep-copy with room for the whole batch. Operate on this and only overwrite when done inserting
+                ArchiveIndex* ai_temp = 0x0;
+                NewArchiveIndexFromCopy(ai_temp, archive_container, insert_count);
+
+                result = InsertResources(archive_container, ai_temp, hash_digests, hash_digest_len, resources, order, insert_count);
+                if (result == RESULT_OK)
+                {
+                    result = WriteLiveUpdateIndex(lu_index_path, ai_temp);
+                }
+
+                if (result == RESULT_OK)
+                {
+                    out_new_index = ai_temp;
+                }
+                else
+                {
+                    dmLogError("Failed to insert %u resources, result = %i", insert_count, result);
+                    Delete(ai_temp);
+                }
+            }
+
+            for (uint32_t i = 0; i < insert_count; ++i)
+            {
+                out_results[order[i]] = result;
+            }
+        }
+
+        free(order);
+        return result;
+    }
+
     void SetNewArchiveIndex(HArchiveIndexContainer archive_container, HArchiveIndex new_index, bool mem_mapped)
     {
         if (!archive_container->m_IsMemMapped)
@@ -922,6 +1116,52 @@ namespace dmResourceArchive
         }
     }
 
+    Result ReadRange(HArchiveIndexContainer archive, EntryData* entry_data, uint32_t offset, uint32_t size, void* buffer, uint32_t* nread)
+    {
+        *nread = 0;
+        if (entry_data->m_ResourceCompressedSize != 0xFFFFFFFF || (entry_data->m_Flags & ENTRY_FLAG_ENCRYPTED))
+        {
+            return RESULT_NOT_SUPPORTED;
+        }
+
+        uint32_t resource_size = entry_data->m_ResourceSize;
+        if (offset >= resource_size)
+        {
+            return RESULT_OK;
+        }
+        if (size > resource_size - offset)
+        {
+            size = resource_size - offset;
+        }
+
+        bool loaded_with_liveupdate = (entry_data->m_Flags & ENTRY_FLAG_LIVEUPDATE_DATA);
+        bool resource_memmapped = loaded_with_liveupdate ? archive->m_LiveUpdateResourcesMemMapped : archive->m_ResourcesMemMapped;
+
+        if (resource_memmapped)
+        {
+            const uint8_t* data = (const uint8_t*) (loaded_with_liveupdate ? archive->m_LiveUpdateResourceData : archive->m_ResourceData);
+            memcpy(buffer, data + entry_data->m_ResourceDataOffset + offset, size);
+        }
+        else
+        {
+            FILE* resource_file = loaded_with_liveupdate ? archive->m_LiveUpdateFileResourceData : archive->m_FileResourceData;
+            if (fseek(resource_file, entry_data->m_ResourceDataOffset + offset, SEEK_SET) != 0 ||
+                fread(buffer, 1, size, resource_file) != size)
+            {
+                return RESULT_IO_ERROR;
+            }
+        }
+
+        *nread = size;
+        return RESULT_OK;
+    }
+
+    bool CanStream(const EntryData* entry_data)
+    {
+        return entry_data->m_ResourceCompressedSize == 0xFFFFFFFF &&
+               (entry_data->m_Flags & (ENTRY_FLAG_ENCRYPTED | ENTRY_FLAG_LIVEUPDATE_DATA)) == 0;
+    }
+
     uint32_t GetEntryCount(HArchiveIndexContainer archive)
     {
         return JAVA_TO_C(archive->m_ArchiveIndex->m_EntryDataCount);
@@ -48,6 +48,7 @@ namespace dmResourceArchive
         RESULT_MEM_ERROR = -3,
         RESULT_OUTBUFFER_TOO_SMALL = -4,
         RESULT_ALREADY_STORED = -5,
+        RESULT_NOT_SUPPORTED = -6,
         RESULT_UNKNOWN = -1000,
     };
 
@@ -134,6 +135,27 @@ namespace dmResourceArchive
      */
     Result Read(HArchiveIndexContainer archive, EntryData* entry_data, void* buffer);
 
+    /**
+     * Read part of a resource. Only uncompressed and unencrypted entries can be read
+     * partially, since any other entry has to be decoded as a whole.
+     * @param archive archive index handle
+     * @param entry_data entry data
+     * @param offset byte offset into the resource
+     * @param size number of bytes to read
+     * @param buffer buffer to load to, at least size bytes
+     * @param nread number of bytes read. Less than size when reading past the end of the resource
+     * @return RESULT_OK on success, RESULT_NOT_SUPPORTED if the entry is compressed or encrypted
+     */
+    Result ReadRange(HArchiveIndexContainer archive, EntryData* entry_data, uint32_t offset, uint32_t size, void* buffer, uint32_t* nread);
+
+    /**
+     * Check if an entry can be read partially over time, e.g. while streaming. Liveupdate
+     * entries can't, since their data file is appended to and remapped when resources are stored.
+     * @param entry_data entry data
+     * @return true if ReadRange may be used on the entry for as long as the archive is alive
+     */
+    bool CanStream(const EntryData* entry_data);
+
     /**
      * Delete archive index. Only required for archives created with LoadArchive function
      * @param archive archive index handle
@@ -159,6 +181,22 @@ namespace dmResourceArchive
      */
     Result NewArchiveIndexWithResource(HArchiveIndexContainer archive, const uint8_t* hash_digest, uint32_t hash_digest_len, const dmResourceArchive::LiveUpdateResource* resource, const char* proj_id, HArchiveIndex& out_new_index);
 
+    /**
+     * Make a deep-copy of the existing archive index within archive container and return copy on successful insertion of a batch of LiveUpdate resources.
+     * The resource data is appended to the data file in one pass and the index is rebuilt once, regardless of the number of resources.
+     * Resources already in the index, or more than once in the batch, are skipped.
+     * @param archive archive container
+     * @param hash_digests hash digests of the resources, hash_digest_len bytes each
+     * @param hash_digest_len size in bytes of each hash digest
+     * @param resources LiveUpdate resources to insert
+     * @param count number of resources
+     * @param proj_id project id SHA
+     * @param out_new_index reference to HArchiveIndex that will cointain the new archive index (on success)
+     * @param out_results per resource result, RESULT_ALREADY_STORED for skipped resources
+     * @return RESULT_OK on success, RESULT_ALREADY_STORED if there was nothing to insert
+     */
+    Result NewArchiveIndexWithResources(HArchiveIndexContainer archive, const uint8_t* hash_digests, uint32_t hash_digest_len, const dmResourceArchive::LiveUpdateResource* resources, uint32_t count, const char* proj_id, HArchiveIndex& out_new_index, Result* out_results);
+
     /**
      * Set new archive index in archive container. Replace existing archive index if set
      * @param archive archive container
@@ -94,6 +94,23 @@ namespace dmResourceArchive
 
 	Result WriteResourceToArchive(ArchiveIndexContainer*& archive, const uint8_t* buf, uint32_t buf_len, uint32_t& bytes_written, uint32_t& offset);
 
+    Result WriteResourcesToArchive(ArchiveIndexContainer*& archive, const dmResourceArchive::LiveUpdateResource* resources, const uint32_t* order, uint32_t count, uint32_t* out_offsets);
+
+    /**
+     * Sort a batch of resources on hash digest, skipping the ones already in the archive index or earlier in the batch
+     * @param out_order indices of the resources to insert, sorted on hash digest. Must have room for count indices.
+     * @param out_results set to RESULT_ALREADY_STORED for the skipped resources
+     * @return number of resources to insert
+     */
+    uint32_t GetInsertionOrder(HArchiveIndexContainer archive, const uint8_t* hash_digests, uint32_t hash_digest_len, uint32_t count, uint32_t* out_order, Result* out_results);
+
+    /**
+     * Insert a batch of resources into an archive index with room for them. The resource data is appended
+     * to the liveupdate data file in one pass and the index entries are merged in one pass.
+     * @param order indices into hash_digests and resources, sorted on hash digest and not present in the index
+     */
+    Result InsertResources(ArchiveIndexContainer* archive_container, ArchiveIndex* archive, const uint8_t* hash_digests, uint32_t hash_digest_len, const dmResourceArchive::LiveUpdateResource* resources, const uint32_t* order, uint32_t count);
+
 	void NewArchiveIndexFromCopy(ArchiveIndex*& dst, ArchiveIndexContainer* src, uint32_t extra_entries_alloc);
 
     Result GetInsertionIndex(HArchiveIndexContainer archive, const uint8_t* hash_digest, int* index);
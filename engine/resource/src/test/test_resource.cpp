@@ -406,6 +406,42 @@ TEST_P(GetResourceTest, GetRaw)
     ASSERT_EQ(dmResource::RESULT_RESOURCE_NOT_FOUND, e);
 }
 
+TEST_P(GetResourceTest, Stream)
+{
+    dmResource::HResourceStream stream = 0;
+    dmResource::Result e = dmResource::OpenResourceStream(m_Factory, "/test01.foo", &stream);
+    if (strncmp(GetParam(), "http", 4) == 0)
+    {
+        ASSERT_EQ(dmResource::RESULT_NOT_SUPPORTED, e);
+        return;
+    }
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+
+    void* resource = 0;
+    uint32_t resource_size = 0;
+    e = dmResource::GetRaw(m_Factory, "/test01.foo", (void**) &resource, &resource_size);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+
+    // Reads are independent of each other and may go past the end
+    uint8_t buffer[4];
+    uint32_t nread = 0;
+    e = dmResource::ReadResourceStream(stream, 1, sizeof(buffer), buffer, &nread);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_EQ(resource_size - 1, nread);
+    ASSERT_EQ(0, memcmp((uint8_t*) resource + 1, buffer, nread));
+
+    e = dmResource::ReadResourceStream(stream, 0, sizeof(buffer), buffer, &nread);
+    ASSERT_EQ(dmResource::RESULT_OK, e);
+    ASSERT_EQ(resource_size, nread);
+    ASSERT_EQ(0, memcmp(resource, buffer, nread));
+
+    free(resource);
+    dmResource::CloseResourceStream(stream);
+
+    e = dmResource::OpenResourceStream(m_Factory, "/does_not_exists", &stream);
+    ASSERT_EQ(dmResource::RESULT_RESOURCE_NOT_FOUND, e);
+}
+
 TEST_P(GetResourceTest, IncRef)
 {
     dmResource::Result e;
@@ -16,6 +16,10 @@
 #include "../resource_archive.h"
 #include "../resource_archive_private.h"
 
+#include <dlib/crypt.h>
+#include <dlib/dstrings.h>
+#include <dlib/sys.h>
+
 #if defined(__linux__) || defined(__MACH__) || defined(__EMSCRIPTEN__)
 #include <netinet/in.h>
 #elif defined(_WIN32)
@@ -245,6 +249,132 @@ TEST(dmResourceArchive, ShiftInsertResource)
     FreeMutableIndexData((void*&)arci_copy);
 }
 
+// A local directory acts as the liveupdate server, with one file per resource named by its hex digest
+static void WriteServerResource(const char* server_dir, const char* payload, char* out_hex_digest, uint32_t hex_digest_len)
+{
+    uint8_t digest[20];
+    dmCrypt::HashSha1((const uint8_t*)payload, strlen(payload), digest);
+    dmResource::BytesToHexString(digest, sizeof(digest), out_hex_digest, hex_digest_len);
+
+    char path[DMPATH_MAX_PATH];
+    dmSnPrintf(path, sizeof(path), "%s/%s", server_dir, out_hex_digest);
+    FILE* f = fopen(path, "wb");
+    ASSERT_NE((FILE*)0, f);
+    dmResourceArchive::LiveUpdateResourceHeader header;
+    memset(&header, 0, sizeof(header));
+    fwrite(&header, 1, sizeof(header), f);
+    fwrite(payload, 1, strlen(payload), f);
+    fclose(f);
+}
+
+static uint8_t* DownloadServerResource(const char* server_dir, const char* hex_digest, uint32_t* out_size)
+{
+    char path[DMPATH_MAX_PATH];
+    dmSnPrintf(path, sizeof(path), "%s/%s", server_dir, hex_digest);
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return 0;
+    fseek(f, 0, SEEK_END);
+    uint32_t size = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = (uint8_t*)malloc(size);
+    *out_size = (uint32_t)fread(buf, 1, size, f);
+    fclose(f);
+    return buf;
+}
+
+TEST(dmResourceArchive, InsertResourcesBatch)
+{
+    const char* server_dir = "test_resource_liveupdate_server";
+    const uint32_t resource_count = 64;
+    const uint32_t batch_count = resource_count + 2;
+    char payloads[resource_count][64];
+    char hex_digests[resource_count][41];
+
+    dmSys::Mkdir(server_dir, 0755);
+    for (uint32_t i = 0; i < resource_count; ++i)
+    {
+        dmSnPrintf(payloads[i], sizeof(payloads[i]), "liveupdate batch resource %u", i);
+        WriteServerResource(server_dir, payloads[i], hex_digests[i], sizeof(hex_digests[i]));
+    }
+
+    // Download everything, plus a duplicate and a resource that is already in the archive
+    uint8_t* buffers[resource_count];
+    dmResourceArchive::LiveUpdateResource resources[batch_count];
+    uint8_t hash_digests[batch_count * 20];
+    for (uint32_t i = 0; i < resource_count; ++i)
+    {
+        uint32_t size = 0;
+        buffers[i] = DownloadServerResource(server_dir, hex_digests[i], &size);
+        ASSERT_NE((uint8_t*)0, buffers[i]);
+        resources[i].Set(buffers[i], size);
+        dmCrypt::HashSha1(resources[i].m_Data, resources[i].m_Count, &hash_digests[i * 20]);
+    }
+    resources[resource_count] = resources[7];
+    memcpy(&hash_digests[resource_count * 20], &hash_digests[7 * 20], 20);
+    dmResourceArchive::LiveUpdateResourceHeader header;
+    memset(&header, 0, sizeof(header));
+    resources[resource_count + 1].m_Data = (const uint8_t*)content[0];
+    resources[resource_count + 1].m_Count = strlen(content[0]);
+    resources[resource_count + 1].m_Header = &header;
+    memcpy(&hash_digests[(resource_count + 1) * 20], content_hash[0], 20);
+
+    const char* resource_filename = "test_resource_liveupdate_batch.arcd";
+    FILE* resource_file = fopen(resource_filename, "wb+");
+    ASSERT_NE((FILE*)0, resource_file);
+
+    dmResourceArchive::HArchiveIndexContainer archive = 0;
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCD, resource_filename, 0x0, resource_file, &archive);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+    ASSERT_EQ(7U, dmResourceArchive::GetEntryCount(archive));
+
+    uint32_t order[batch_count];
+    dmResourceArchive::Result results[batch_count];
+    uint32_t insert_count = dmResourceArchive::GetInsertionOrder(archive, hash_digests, 20, batch_count, order, results);
+    ASSERT_EQ(resource_count, insert_count);
+    ASSERT_EQ(dmResourceArchive::RESULT_ALREADY_STORED, results[resource_count + 1]);
+
+    dmResourceArchive::HArchiveIndex new_index = 0;
+    dmResourceArchive::NewArchiveIndexFromCopy(new_index, archive, insert_count);
+    result = dmResourceArchive::InsertResources(archive, new_index, hash_digests, 20, resources, order, insert_count);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+    dmResourceArchive::SetNewArchiveIndex(archive, new_index, true);
+    ASSERT_EQ(7U + resource_count, dmResourceArchive::GetEntryCount(archive));
+
+    // The index must still be sorted
+    uint8_t* hashes = (uint8_t*)((uintptr_t)new_index + JAVA_TO_C(new_index->m_HashOffset));
+    for (uint32_t i = 1; i < 7U + resource_count; ++i)
+    {
+        ASSERT_LT(memcmp(hashes + DMRESOURCE_MAX_HASH * (i - 1), hashes + DMRESOURCE_MAX_HASH * i, 20), 0);
+    }
+
+    // Both the new and the bundled resources are found and can be read
+    char buffer[64];
+    for (uint32_t i = 0; i < resource_count; ++i)
+    {
+        dmResourceArchive::EntryData entry;
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::FindEntry(archive, &hash_digests[i * 20], &entry));
+        ASSERT_EQ((uint32_t)strlen(payloads[i]), entry.m_ResourceSize);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::Read(archive, &entry, buffer));
+        ASSERT_EQ(0, memcmp(payloads[i], buffer, entry.m_ResourceSize));
+    }
+    for (uint32_t i = 0; i < 7U; ++i)
+    {
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, dmResourceArchive::FindEntry(archive, content_hash[i], 0x0));
+    }
+
+    for (uint32_t i = 0; i < resource_count; ++i)
+    {
+        char path[DMPATH_MAX_PATH];
+        dmSnPrintf(path, sizeof(path), "%s/%s", server_dir, hex_digests[i]);
+        dmSys::Unlink(path);
+        free(buffers[i]);
+    }
+    dmResourceArchive::Delete(new_index);
+    dmResourceArchive::Delete(archive); // closes the resource file
+    dmSys::Unlink(resource_filename);
+}
+
 TEST(dmResourceArchive, NewArchiveIndexFromCopy)
 {
     uint32_t single_entry_offset = DMRESOURCE_MAX_HASH;
@@ -643,6 +773,83 @@ TEST(dmResourceArchive, Wrap_Compressed)
     dmResourceArchive::Delete(archive);
 }
 
+TEST(dmResourceArchive, ReadRange)
+{
+    dmResourceArchive::HArchiveIndexContainer archive = 0;
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_ARCI, RESOURCES_ARCD, 0x0, 0x0, 0x0, &archive);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+    dmResourceArchive::EntryData entry;
+    for (uint32_t i = 0; i < (sizeof(path_hash) / sizeof(path_hash[0])); ++i)
+    {
+        if (IsLiveUpdateResource(path_hash[i])) continue;
+
+        result = dmResourceArchive::FindEntry(archive, content_hash[i], &entry);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+        uint32_t size = strlen(content[i]);
+        ASSERT_LT(3U, size);
+
+        char buffer[1024] = { 0 };
+        uint32_t nread = 0;
+        result = dmResourceArchive::ReadRange(archive, &entry, 1, 2, buffer, &nread);
+        if (entry.m_Flags & dmResourceArchive::ENTRY_FLAG_ENCRYPTED)
+        {
+            // Encrypted entries can only be read as a whole
+            ASSERT_EQ(dmResourceArchive::RESULT_NOT_SUPPORTED, result);
+            continue;
+        }
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+        ASSERT_EQ(2U, nread);
+        ASSERT_EQ(0, memcmp(content[i] + 1, buffer, 2));
+
+        // Reading past the end is clamped to the resource
+        result = dmResourceArchive::ReadRange(archive, &entry, size - 2, sizeof(buffer), buffer, &nread);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+        ASSERT_EQ(2U, nread);
+        ASSERT_EQ(0, memcmp(content[i] + size - 2, buffer, 2));
+
+        result = dmResourceArchive::ReadRange(archive, &entry, size, sizeof(buffer), buffer, &nread);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+        ASSERT_EQ(0U, nread);
+    }
+
+    dmResourceArchive::Delete(archive);
+}
+
+TEST(dmResourceArchive, ReadRange_Compressed)
+{
+    dmResourceArchive::HArchiveIndexContainer archive = 0;
+    dmResourceArchive::Result result = dmResourceArchive::WrapArchiveBuffer((void*) RESOURCES_COMPRESSED_ARCI, (void*) RESOURCES_COMPRESSED_ARCD, 0x0, 0x0, 0x0, &archive);
+    ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+    dmResourceArchive::EntryData entry;
+    for (uint32_t i = 0; i < (sizeof(path_hash) / sizeof(path_hash[0])); ++i)
+    {
+        if (IsLiveUpdateResource(path_hash[i])) continue;
+
+        result = dmResourceArchive::FindEntry(archive, compressed_content_hash[i], &entry);
+        ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+
+        char buffer[1024] = { 0 };
+        uint32_t nread = 0;
+        result = dmResourceArchive::ReadRange(archive, &entry, 0, 2, buffer, &nread);
+        if (entry.m_ResourceCompressedSize != 0xFFFFFFFF || (entry.m_Flags & dmResourceArchive::ENTRY_FLAG_ENCRYPTED))
+        {
+            // Compressed entries can only be read as a whole
+            ASSERT_EQ(dmResourceArchive::RESULT_NOT_SUPPORTED, result);
+            ASSERT_EQ(0U, nread);
+        }
+        else
+        {
+            ASSERT_EQ(dmResourceArchive::RESULT_OK, result);
+            ASSERT_EQ(0, memcmp(content[i], buffer, 2));
+        }
+    }
+
+    dmResourceArchive::Delete(archive);
+}
+
 TEST(dmResourceArchive, LoadFromDisk)
 {
     dmResourceArchive::HArchiveIndexContainer archive = 0;
@@ -97,15 +97,22 @@ namespace dmScript
             premult = lua_toboolean(L, 2);
         }
 
+        // The pixels are decoded straight into a buffer of the final size, which is then copied into the lua string
         dmImage::Image image;
-        dmImage::Result r = dmImage::Load(buffer, buffer_len, premult, &image);
+        dmImage::Result r = dmImage::GetInfo(buffer, buffer_len, &image);
+        uint32_t bytes_per_pixel = dmImage::BytesPerPixel(image.m_Type);
+        uint32_t image_size = 0;
         if (r == dmImage::RESULT_OK) {
-
-            int bytes_per_pixel = dmImage::BytesPerPixel(image.m_Type);
-            if (bytes_per_pixel == 0) {
-                dmImage::Free(&image);
-                luaL_error(L, "unknown image type %d", image.m_Type);
+            uint64_t size = (uint64_t) image.m_Width * image.m_Height * bytes_per_pixel;
+            image.m_Buffer = size <= 0xffffffff ? malloc((size_t) size) : 0;
+            if (!image.m_Buffer) {
+                return luaL_error(L, "not enough memory to load a %ux%u image", image.m_Width, image.m_Height);
             }
+            image_size = (uint32_t) size;
+            r = dmImage::LoadInto(buffer, buffer_len, image.m_Type, premult ? dmImage::LOAD_FLAG_PREMULTIPLY : 0, image.m_Buffer, image_size);
+        }
+
+        if (r == dmImage::RESULT_OK) {
 
             lua_newtable(L);
 
@@ -134,12 +141,13 @@ namespace dmScript
             lua_rawset(L, -3);
 
             lua_pushliteral(L, "buffer");
-            lua_pushlstring(L, (const char*) image.m_Buffer, bytes_per_pixel * image.m_Width * image.m_Height);
+            lua_pushlstring(L, (const char*) image.m_Buffer, image_size);
             lua_rawset(L, -3);
 
-            dmImage::Free(&image);
+            free(image.m_Buffer);
 
         } else {
+            free(image.m_Buffer);
             dmLogWarning("failed to load image (%d)", r);
             lua_pushnil(L);
         }
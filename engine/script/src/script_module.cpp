@@ -36,11 +36,32 @@ extern "C"
 namespace dmScript
 {
 
+#if !defined(LUA_BYTECODE_ENABLE_32) && !defined(LUA_BYTECODE_ENABLE_64)
+    // Checks that the bytecode was dumped by a luac with the same version, word size and number
+    // type as this runtime. See luaU_header in lundump.c
+    static bool IsLua51BytecodeCompatible(const uint8_t* data, uint32_t size)
+    {
+        const int one = 1;
+        const uint8_t header[] = {
+            0x1b, 'L', 'u', 'a',
+            0x51,                                       // LUAC_VERSION
+            0,                                          // LUAC_FORMAT
+            (uint8_t) *(const char*) &one,              // 1 = little endian
+            (uint8_t) sizeof(int),
+            (uint8_t) sizeof(size_t),
+            4,                                          // sizeof(Instruction)
+            (uint8_t) sizeof(lua_Number),
+            (uint8_t) (((lua_Number) 0.5) == 0),        // integral lua_Number
+        };
+        return size >= sizeof(header) && memcmp(data, header, sizeof(header)) == 0;
+    }
+#endif
+
     // Helper function where the decision is made if to load bytecode or source code.
     //
-    // Currently the bytecode is only ever built with LuaJIT which means it cannot be loaded
-    // with vanilla lua runtime. The LUA_BYTECODE_ENABLE_(32/62) indicates if we can load bytecode,
-    // and in reality, if linking happens against LuaJIT.
+    // The LuaJIT bytecode cannot be loaded with vanilla lua runtime. The LUA_BYTECODE_ENABLE_(32/62)
+    // indicates if we can load it, and in reality, if linking happens against LuaJIT.
+    // Otherwise the luac bytecode is used if it matches the runtime, with the source as fallback.
     static void GetLuaSource(dmLuaDDF::LuaSource *source, const char **buf, uint32_t *size)
     {
 #if defined(LUA_BYTECODE_ENABLE_32)
@@ -57,6 +78,19 @@ namespace dmScript
             *size = source->m_Bytecode64.m_Count;
             return;
         }
+#else
+        const uint8_t* bytecode = sizeof(size_t) == 8 ? source->m_Lua51Bytecode64.m_Data : source->m_Lua51Bytecode.m_Data;
+        uint32_t bytecode_size = sizeof(size_t) == 8 ? source->m_Lua51Bytecode64.m_Count : source->m_Lua51Bytecode.m_Count;
+        if (bytecode_size > 0)
+        {
+            if (IsLua51BytecodeCompatible(bytecode, bytecode_size))
+            {
+                *buf = (const char*)bytecode;
+                *size = bytecode_size;
+                return;
+            }
+            dmLogWarning("Bytecode of '%s' doesn't match the Lua runtime, loading the source instead", source->m_Filename);
+        }
 #endif
         *buf = (const char*)source->m_Script.m_Data;
         *size = source->m_Script.m_Count;
@@ -54,6 +54,10 @@ namespace dmScript
 // End DEF-3714 helper functions.
 ///////////////////////////////////////////////////////////////
 
+    // Serializes a table like CheckTable, in the given format version. Only version 3, the last one
+    // without array parts and interned keys, and the current version can be written
+    uint32_t CheckTableVersion(lua_State* L, char* buffer, uint32_t buffer_size, int index, uint32_t version);
+
     struct Module
     {
         char*       m_Script;
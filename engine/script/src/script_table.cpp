@@ -39,11 +39,15 @@ typedef lua_Number lua_Number_4_align;
 // the rest of the types used when serializing a table come from lua.h
 // make sure this type has a value quite a bit higher than the types in lua.h
 #define LUA_TNEGATIVENUMBER 64
+// custom key type for a string key that has already been written, see version 4 below
+#define LUA_TKEYREF 65
 
 namespace dmScript
 {
     const int TABLE_MAGIC = 0x42544448;
-    const uint32_t TABLE_VERSION_CURRENT = 3;
+    const uint32_t TABLE_VERSION_CURRENT = 4;
+    // Max number of distinct string keys interned per serialized table
+    const uint32_t KEY_CACHE_MAX_KEYS = 192;
 
     /*
      * Original table serialization format:
@@ -84,6 +88,25 @@ namespace dmScript
      *    For the imagined use cases, we consider it likely that taking this approach with keys will lead to smaller files,
      *    since a typical key will fit within a single byte of data. Numerical values when used elsewhere are essentially random
      *    and so we cannot guarantee that this encoding method will yield smaller data in such cases.
+     *
+     *    Version 4 table serialization format:
+     *
+     *    Number keys use the fixed 32 bit encoding of version 3. A non-empty table stores the length of its array part,
+     *    a leading run of the keys 1..n, directly after the count:
+     *
+     *    uint16_t   count
+     *    uint16_t   array_count (only present if count > 0)
+     *    char       array_type (only present if array_count > 0)
+     *    T          array values
+     *    ...        remaining (count - array_count) entries as in version 3
+     *
+     *    If all values in the array part are numbers the array_type is LUA_TNUMBER and the values are stored as
+     *    a single aligned run of lua_Numbers. Otherwise the array_type is LUA_TNIL and each value is stored as
+     *    a value_type followed by the value. The reader creates each table with the known array and hash sizes.
+     *
+     *    The first KEY_CACHE_MAX_KEYS distinct string keys are numbered in the order they are written. Later
+     *    occurrences of the same key, in this or any nested table, are stored with the key type LUA_TKEYREF
+     *    followed by the MSB encoded key number instead of the string.
      */
 
     struct TableHeader
@@ -181,6 +204,7 @@ namespace dmScript
         case 1:
         case 2:
         case 3:
+        case 4:
             supported = true;
             break;
         default:
@@ -201,7 +225,7 @@ namespace dmScript
             memcpy(buffer, &key, sizeof(uint16_t));
             buffer += sizeof(uint16_t);
         }
-        else if (3 == header.m_Version)
+        else if (3 <= header.m_Version)
         {
             if (buffer_end - buffer < 4)
                 luaL_error(L, "table too large");
@@ -283,254 +307,381 @@ namespace dmScript
         return total_size;
     }
 
-    uint32_t DoCheckTable(lua_State* L, const TableHeader& header, const char* original_buffer, char* buffer, uint32_t buffer_size, int index)
-    {
-        int top = lua_gettop(L);
-        (void)top;
-
-        char* buffer_start = buffer;
-        char* buffer_end = buffer + buffer_size;
-        luaL_checktype(L, index, LUA_TTABLE);
-        lua_pushvalue(L, index);
-        lua_pushnil(L);
+    // Lua strings are interned by the VM, so the data pointer of a key string identifies its
+    // contents. The writer keeps an open addressed set of the keys written so far.
+    static const uint32_t KEY_CACHE_SIZE = 256;
 
-        if (buffer_size < 2)
+    struct TableWriter
+    {
+        TableHeader m_Header;
+        const char* m_OriginalBuffer;
+        uint32_t    m_KeyCount;
+        uint64_t    m_KeyUsed[KEY_CACHE_SIZE / 64];
+        const char* m_Keys[KEY_CACHE_SIZE];
+        uint16_t    m_KeyIndices[KEY_CACHE_SIZE];
+
+        TableWriter(const TableHeader& header, const char* original_buffer)
+        : m_Header(header)
+        , m_OriginalBuffer(original_buffer)
+        , m_KeyCount(0)
         {
-            luaL_error(L, "table too large");
+            memset(m_KeyUsed, 0, sizeof(m_KeyUsed));
         }
-        // Make room for count (2 bytes)
-        buffer += 2;
+    };
 
-        uint16_t count = 0;
-        while (lua_next(L, -2) != 0)
+    // Returns the index of a previously written key, or KEY_CACHE_MAX_KEYS if the key hasn't been seen.
+    // New keys are assigned the next index as long as there is room in the cache.
+    static uint32_t InternKey(TableWriter& writer, const char* key)
+    {
+        uint32_t slot = ((uint32_t)((uintptr_t)key >> 3) * 2654435761U) & (KEY_CACHE_SIZE - 1);
+        while (writer.m_KeyUsed[slot >> 6] & (1ULL << (slot & 63)))
         {
-            // Check overflow
-            if (count == (uint16_t)0xffff)
+            if (writer.m_Keys[slot] == key)
             {
-                luaL_error(L, "too many values in table, %d is max", 0xffff);
+                return writer.m_KeyIndices[slot];
             }
+            slot = (slot + 1) & (KEY_CACHE_SIZE - 1);
+        }
+        if (writer.m_KeyCount < KEY_CACHE_MAX_KEYS)
+        {
+            writer.m_KeyUsed[slot >> 6] |= 1ULL << (slot & 63);
+            writer.m_Keys[slot] = key;
+            writer.m_KeyIndices[slot] = (uint16_t)writer.m_KeyCount++;
+        }
+        return KEY_CACHE_MAX_KEYS;
+    }
 
-            count++;
+    // NOTE: We align lua_Number to sizeof(float) even if lua_Number probably is of double type
+    static char* AlignBuffer(lua_State* L, const TableWriter& writer, char* buffer, const char* buffer_end, uint32_t buffer_size, int key_type, uint32_t count)
+    {
+        intptr_t offset = buffer - writer.m_OriginalBuffer;
+        intptr_t aligned_buffer = ((intptr_t) offset + sizeof(float)-1) & ~(sizeof(float)-1);
+        intptr_t align_size = aligned_buffer - (intptr_t) offset;
 
-            int key_type = lua_type(L, -2);
-            int value_type = lua_type(L, -1);
-            if (key_type != LUA_TSTRING && key_type != LUA_TNUMBER)
-            {
-                luaL_error(L, "keys in table must be of type number or string (found %s)", lua_typename(L, key_type));
-            }
+        if (buffer_end - buffer < align_size)
+        {
+            luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
+        }
 
-            if (buffer_end - buffer < 2)
+#ifndef NDEBUG
+        memset(buffer, 0, align_size);
+#endif
+        return buffer + align_size;
+    }
+
+    static uint32_t DoCheckTable(lua_State* L, TableWriter& writer, char* buffer, uint32_t buffer_size, int index);
+
+    // Writes the value at the top of the stack
+    static char* WriteValue(lua_State* L, TableWriter& writer, int value_type, char* buffer, const char* buffer_end, uint32_t buffer_size, int key_type, uint32_t count)
+    {
+        switch (value_type)
+        {
+            case LUA_TBOOLEAN:
             {
-                luaL_error(L, "buffer (%d bytes) too small for table, exceeded at key for element #%d", buffer_size, count);
+                if (buffer_end - buffer < 1)
+                {
+                    luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
+                }
+                (*buffer++) = (char) lua_toboolean(L, -1);
             }
+            break;
 
-            if (key_type == LUA_TSTRING)
+            case LUA_TNUMBER:
             {
-                (*buffer++) = (char) LUA_TSTRING;
-                (*buffer++) = (char) value_type;
-                buffer += SaveTSTRING(L, -2, buffer, buffer_size, buffer_end, count);
+                buffer = AlignBuffer(L, writer, buffer, buffer_end, buffer_size, key_type, count);
+
+                if (buffer_end - buffer < int32_t(sizeof(lua_Number)))
+                {
+                    luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
+                }
+
+                lua_Number x = lua_tonumber(L, -1);
+                memcpy(buffer, &x, sizeof(lua_Number));
+                buffer += sizeof(lua_Number);
             }
-            else if (key_type == LUA_TNUMBER)
+            break;
+
+            case LUA_TSTRING:
             {
-                lua_Number key = lua_tonumber(L, -2);
-                (*buffer++) = (char) (key >= 0 ? LUA_TNUMBER : LUA_TNEGATIVENUMBER);
-                (*buffer++) = (char) value_type;
-                buffer = WriteEncodedIndex(L, key, header, buffer, buffer_end);
+                buffer += SaveTSTRING(L, -1, buffer, buffer_size, buffer_end, count);
             }
+            break;
 
-            switch (value_type)
+            case LUA_TUSERDATA:
             {
-                case LUA_TBOOLEAN:
+                if (buffer_end - buffer < 1)
                 {
-                    if (buffer_end - buffer < 1)
-                    {
-                        luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
-                    }
-                    (*buffer++) = (char) lua_toboolean(L, -1);
+                    luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
                 }
-                break;
 
-                case LUA_TNUMBER:
-                {
-                    // NOTE: We align lua_Number to sizeof(float) even if lua_Number probably is of double type
-                    intptr_t offset = buffer - original_buffer;
-                    intptr_t aligned_buffer = ((intptr_t) offset + sizeof(float)-1) & ~(sizeof(float)-1);
-                    intptr_t align_size = aligned_buffer - (intptr_t) offset;
+                char* sub_type = buffer++;
+                buffer = AlignBuffer(L, writer, buffer, buffer_end, buffer_size, key_type, count);
 
-                    if (buffer_end - buffer < align_size)
+                float* f = (float*) (buffer);
+                Vectormath::Aos::Vector3* v3;
+                Vectormath::Aos::Vector4* v4;
+                Vectormath::Aos::Quat* q;
+                Vectormath::Aos::Matrix4* m;
+                if ((v3 = ToVector3(L, -1)))
+                {
+                    if (buffer_end - buffer < int32_t(sizeof(float) * 3))
                     {
                         luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
                     }
 
-#ifndef NDEBUG
-                    memset(buffer, 0, align_size);
-#endif
-                    buffer += align_size;
+                    *sub_type = (char) SUB_TYPE_VECTOR3;
+                    *f++ = v3->getX();
+                    *f++ = v3->getY();
+                    *f++ = v3->getZ();
 
-                    if (buffer_end - buffer < int32_t(sizeof(lua_Number)) || buffer_end - buffer < align_size)
+                    buffer += sizeof(float) * 3;
+                }
+                else if ((v4 = ToVector4(L, -1)))
+                {
+                    if (buffer_end - buffer < int32_t(sizeof(float) * 4))
                     {
                         luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
                     }
 
-                    union
-                    {
-                        lua_Number x;
-                        char buf[sizeof(lua_Number)];
-                    };
+                    *sub_type = (char) SUB_TYPE_VECTOR4;
+                    *f++ = v4->getX();
+                    *f++ = v4->getY();
+                    *f++ = v4->getZ();
+                    *f++ = v4->getW();
 
-                    x = lua_tonumber(L, -1);
-                    memcpy(buffer, buf, sizeof(lua_Number));
-                    buffer += sizeof(lua_Number);
+                    buffer += sizeof(float) * 4;
                 }
-                break;
-
-                case LUA_TSTRING:
+                else if ((q = ToQuat(L, -1)))
                 {
-                    buffer += SaveTSTRING(L, -1, buffer, buffer_size, buffer_end, count);
-                }
-                break;
+                    if (buffer_end - buffer < int32_t(sizeof(float) * 4))
+                    {
+                        luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
+                    }
 
-                case LUA_TUSERDATA:
+                    *sub_type = (char) SUB_TYPE_QUAT;
+                    *f++ = q->getX();
+                    *f++ = q->getY();
+                    *f++ = q->getZ();
+                    *f++ = q->getW();
+
+                    buffer += sizeof(float) * 4;
+                }
+                else if ((m = ToMatrix4(L, -1)))
                 {
-                    if (buffer_end - buffer < 1)
+                    if (buffer_end - buffer < int32_t(sizeof(float) * 16))
                     {
                         luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
                     }
 
-                    char* sub_type = buffer++;
+                    *sub_type = (char) SUB_TYPE_MATRIX4;
+                    for (uint32_t i = 0; i < 4; ++i)
+                        for (uint32_t j = 0; j < 4; ++j)
+                            *f++ = m->getElem(i, j);
 
-                    // NOTE: We align lua_Number to sizeof(float) even if lua_Number probably is of double type
-                    intptr_t offset = buffer - original_buffer;
-                    intptr_t aligned_buffer = ((intptr_t) offset + sizeof(float)-1) & ~(sizeof(float)-1);
-                    intptr_t align_size = aligned_buffer - (intptr_t) offset;
+                    buffer += sizeof(float) * 16;
+                }
+                else if (IsHash(L, -1))
+                {
+                    dmhash_t hash = *(dmhash_t*)lua_touserdata(L, -1);
+                    const uint32_t hash_size = sizeof(dmhash_t);
 
-                    if (buffer_end - buffer < align_size)
+                    if (buffer_end - buffer < int32_t(hash_size))
                     {
                         luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
                     }
 
-#ifndef NDEBUG
-                    memset(buffer, 0, align_size);
-#endif
-                    buffer += align_size;
-
-                    float* f = (float*) (buffer);
-                    Vectormath::Aos::Vector3* v3;
-                    Vectormath::Aos::Vector4* v4;
-                    Vectormath::Aos::Quat* q;
-                    Vectormath::Aos::Matrix4* m;
-                    if ((v3 = ToVector3(L, -1)))
-                    {
-                        if (buffer_end - buffer < int32_t(sizeof(float) * 3))
-                        {
-                            luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
-                        }
+                    *sub_type = (char) SUB_TYPE_HASH;
 
-                        *sub_type = (char) SUB_TYPE_VECTOR3;
-                        *f++ = v3->getX();
-                        *f++ = v3->getY();
-                        *f++ = v3->getZ();
+                    memcpy(buffer, (const void*)&hash, hash_size);
+                    buffer += hash_size;
+                }
+                else if (IsURL(L, -1))
+                {
+                    dmMessage::URL* url = (dmMessage::URL*)lua_touserdata(L, -1);
+                    const uint32_t url_size = sizeof(dmMessage::URL);
 
-                        buffer += sizeof(float) * 3;
-                    }
-                    else if ((v4 = ToVector4(L, -1)))
+                    if (buffer_end - buffer < int32_t(url_size))
                     {
-                        if (buffer_end - buffer < int32_t(sizeof(float) * 4))
-                        {
-                            luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
-                        }
-
-                        *sub_type = (char) SUB_TYPE_VECTOR4;
-                        *f++ = v4->getX();
-                        *f++ = v4->getY();
-                        *f++ = v4->getZ();
-                        *f++ = v4->getW();
-
-                        buffer += sizeof(float) * 4;
-                    }
-                    else if ((q = ToQuat(L, -1)))
-                    {
-                        if (buffer_end - buffer < int32_t(sizeof(float) * 4))
-                        {
-                            luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
-                        }
-
-                        *sub_type = (char) SUB_TYPE_QUAT;
-                        *f++ = q->getX();
-                        *f++ = q->getY();
-                        *f++ = q->getZ();
-                        *f++ = q->getW();
-
-                        buffer += sizeof(float) * 4;
+                        luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
                     }
-                    else if ((m = ToMatrix4(L, -1)))
-                    {
-                        if (buffer_end - buffer < int32_t(sizeof(float) * 16))
-                        {
-                            luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
-                        }
 
-                        *sub_type = (char) SUB_TYPE_MATRIX4;
-                        for (uint32_t i = 0; i < 4; ++i)
-                            for (uint32_t j = 0; j < 4; ++j)
-                                *f++ = m->getElem(i, j);
+                    *sub_type = (char) SUB_TYPE_URL;
 
-                        buffer += sizeof(float) * 16;
-                    }
-                    else if (IsHash(L, -1))
-                    {
-                        dmhash_t hash = *(dmhash_t*)lua_touserdata(L, -1);
-                        const uint32_t hash_size = sizeof(dmhash_t);
+                    memcpy(buffer, (const void*)url, url_size);
+                    buffer += url_size;
+                }
+                else
+                {
+                    luaL_error(L, "unsupported value type in table: %s", lua_typename(L, value_type));
+                }
+            }
+            break;
+
+            case LUA_TTABLE:
+            {
+                uint32_t n_used = DoCheckTable(L, writer, buffer, buffer_end - buffer, -1);
+                buffer += n_used;
+            }
+            break;
+
+            default:
+                luaL_error(L, "unsupported value type in table: %s", lua_typename(L, value_type));
+                break;
+        }
+        return buffer;
+    }
 
-                        if (buffer_end - buffer < int32_t(hash_size))
-                        {
-                            luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
-                        }
+    static uint32_t DoCheckTable(lua_State* L, TableWriter& writer, char* buffer, uint32_t buffer_size, int index)
+    {
+        int top = lua_gettop(L);
+        (void)top;
 
-                        *sub_type = (char) SUB_TYPE_HASH;
+        char* buffer_start = buffer;
+        char* buffer_end = buffer + buffer_size;
+        luaL_checktype(L, index, LUA_TTABLE);
+        lua_pushvalue(L, index);
 
-                        memcpy(buffer, (const void*)&hash, hash_size);
-                        buffer += hash_size;
-                    }
-                    else if (IsURL(L, -1))
-                    {
-                        dmMessage::URL* url = (dmMessage::URL*)lua_touserdata(L, -1);
-                        const uint32_t url_size = sizeof(dmMessage::URL);
+        if (buffer_size < 2)
+        {
+            luaL_error(L, "table too large");
+        }
+        // Make room for count (2 bytes)
+        buffer += 2;
+
+        // Room for the array count is only needed for non-empty tables. Every entry checks the space
+        // for what it writes, so the count is patched in at the end.
+        const bool has_array = writer.m_Header.m_Version >= 4;
+        char* array_count_buffer = buffer;
+        if (has_array)
+        {
+            buffer += 2;
+        }
+
+        // lua_next visits the array part of a table first, in order. The leading run of keys 1..n is
+        // written as the array part and ends at the first key out of sequence or, for number arrays,
+        // the first value that isn't a number. Any remaining keys are written as regular entries.
+        bool in_array = has_array;
+        int array_type = LUA_TNIL;
+        uint32_t array_count = 0;
+
+        uint16_t count = 0;
+        lua_pushnil(L);
+        while (lua_next(L, -2) != 0)
+        {
+            // Check overflow
+            if (count == (uint16_t)0xffff)
+            {
+                luaL_error(L, "too many values in table, %d is max", 0xffff);
+            }
 
-                        if (buffer_end - buffer < int32_t(url_size))
-                        {
-                            luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
-                        }
+            count++;
 
-                        *sub_type = (char) SUB_TYPE_URL;
+            int key_type = lua_type(L, -2);
+            int value_type = lua_type(L, -1);
 
-                        memcpy(buffer, (const void*)url, url_size);
-                        buffer += url_size;
+            if (in_array)
+            {
+                in_array = key_type == LUA_TNUMBER && lua_tonumber(L, -2) == (lua_Number)(array_count + 1) &&
+                           (array_count == 0 || array_type == LUA_TNIL || value_type == LUA_TNUMBER);
+            }
+
+            if (in_array)
+            {
+                if (array_count == 0)
+                {
+                    if (buffer_end - buffer < 1)
+                    {
+                        luaL_error(L, "buffer (%d bytes) too small for table, exceeded at key for element #%d", buffer_size, count);
                     }
-                    else
+
+                    // Number arrays are stored as a single run of numbers without any tags
+                    array_type = value_type == LUA_TNUMBER ? LUA_TNUMBER : LUA_TNIL;
+                    (*buffer++) = (char) array_type;
+                    if (array_type == LUA_TNUMBER)
                     {
-                        luaL_error(L, "unsupported value type in table: %s", lua_typename(L, value_type));
+                        buffer = AlignBuffer(L, writer, buffer, buffer_end, buffer_size, key_type, count);
                     }
                 }
-                break;
 
-                case LUA_TTABLE:
+                if (array_type == LUA_TNUMBER)
+                {
+                    if (buffer_end - buffer < int32_t(sizeof(lua_Number)))
+                    {
+                        luaL_error(L, "buffer (%d bytes) too small for table, exceeded at value (%s) for element #%d", buffer_size, lua_typename(L, key_type), count);
+                    }
+
+                    lua_Number x = lua_tonumber(L, -1);
+                    memcpy(buffer, &x, sizeof(lua_Number));
+                    buffer += sizeof(lua_Number);
+                }
+                else
                 {
-                    uint32_t n_used = DoCheckTable(L, header, original_buffer, buffer, buffer_end - buffer, -1);
-                    buffer += n_used;
+                    if (buffer_end - buffer < 1)
+                    {
+                        luaL_error(L, "buffer (%d bytes) too small for table, exceeded at key for element #%d", buffer_size, count);
+                    }
+                    (*buffer++) = (char) value_type;
+                    buffer = WriteValue(L, writer, value_type, buffer, buffer_end, buffer_size, key_type, count);
                 }
-                break;
 
-                default:
-                    luaL_error(L, "unsupported value type in table: %s", lua_typename(L, value_type));
-                    break;
+                ++array_count;
+                lua_pop(L, 1);
+                continue;
             }
 
+            if (key_type != LUA_TSTRING && key_type != LUA_TNUMBER)
+            {
+                luaL_error(L, "keys in table must be of type number or string (found %s)", lua_typename(L, key_type));
+            }
+
+            if (buffer_end - buffer < 2)
+            {
+                luaL_error(L, "buffer (%d bytes) too small for table, exceeded at key for element #%d", buffer_size, count);
+            }
+
+            if (key_type == LUA_TSTRING)
+            {
+                uint32_t key_index = has_array ? InternKey(writer, lua_tostring(L, -2)) : KEY_CACHE_MAX_KEYS;
+                if (key_index < KEY_CACHE_MAX_KEYS)
+                {
+                    (*buffer++) = (char) LUA_TKEYREF;
+                    (*buffer++) = (char) value_type;
+                    if (!EncodeMSB(key_index, buffer, buffer_end))
+                    {
+                        luaL_error(L, "buffer (%d bytes) too small for table, exceeded at key for element #%d", buffer_size, count);
+                    }
+                }
+                else
+                {
+                    (*buffer++) = (char) LUA_TSTRING;
+                    (*buffer++) = (char) value_type;
+                    buffer += SaveTSTRING(L, -2, buffer, buffer_size, buffer_end, count);
+                }
+            }
+            else if (key_type == LUA_TNUMBER)
+            {
+                lua_Number key = lua_tonumber(L, -2);
+                (*buffer++) = (char) (key >= 0 ? LUA_TNUMBER : LUA_TNEGATIVENUMBER);
+                (*buffer++) = (char) value_type;
+                buffer = WriteEncodedIndex(L, key, writer.m_Header, buffer, buffer_end);
+            }
+
+            buffer = WriteValue(L, writer, value_type, buffer, buffer_end, buffer_size, key_type, count);
+
             lua_pop(L, 1);
         }
         lua_pop(L, 1);
 
         memcpy(buffer_start, &count, sizeof(uint16_t));
+        if (has_array && count > 0)
+        {
+            uint16_t array_count16 = (uint16_t)array_count;
+            memcpy(array_count_buffer, &array_count16, sizeof(uint16_t));
+        }
+        else if (has_array)
+        {
+            buffer = array_count_buffer;
+        }
 
         assert(top == lua_gettop(L));
         return buffer - buffer_start;
@@ -538,16 +689,23 @@ namespace dmScript
 
     uint32_t CheckTable(lua_State* L, char* buffer, uint32_t buffer_size, int index)
     {
+        return CheckTableVersion(L, buffer, buffer_size, index, TABLE_VERSION_CURRENT);
+    }
+
+    uint32_t CheckTableVersion(lua_State* L, char* buffer, uint32_t buffer_size, int index, uint32_t version)
+    {
+        assert(version == 3 || version == TABLE_VERSION_CURRENT);
         if (buffer_size > sizeof(TableHeader)) {
             char* original_buffer = buffer;
 
             TableHeader* header = (TableHeader*)buffer;
             header->m_Magic = TABLE_MAGIC;
-            header->m_Version = TABLE_VERSION_CURRENT;
+            header->m_Version = version;
             buffer += sizeof(TableHeader);
             buffer_size -= (buffer - original_buffer);
 
-            return sizeof(TableHeader) + DoCheckTable(L, *header, original_buffer, buffer, buffer_size, index);
+            TableWriter writer(*header, original_buffer);
+            return sizeof(TableHeader) + DoCheckTable(L, writer, buffer, buffer_size, index);
         } else {
             luaL_error(L, "buffer (%d bytes) too small for header (%zu bytes)", buffer_size, sizeof(TableHeader));
             return 0;
@@ -577,7 +735,7 @@ namespace dmScript
             lua_pushnumber(L, value);
             buffer += sizeof(uint16_t);
         }
-        else if (3 == header.m_Version)
+        else if (3 <= header.m_Version)
         {
             if (key_type != LUA_TNUMBER && key_type != LUA_TNEGATIVENUMBER)
             {
@@ -675,11 +833,244 @@ namespace dmScript
         return luaL_error(L, "%s", str); \
     }
 
-    int DoPushTable(lua_State*L, PushTableLogger& logger, const TableHeader& header, const char* original_buffer, const char* buffer, uint32_t buffer_size, uint32_t depth)
+    struct TableReader
+    {
+        TableHeader      m_Header;
+        const char*      m_OriginalBuffer;
+        PushTableLogger& m_Logger;
+        // Interned keys point into the serialized data (version 4 and later)
+        const char*      m_Keys[KEY_CACHE_MAX_KEYS];
+        uint32_t         m_KeyLengths[KEY_CACHE_MAX_KEYS];
+        uint32_t         m_KeyCount;
+
+        TableReader(const TableHeader& header, const char* original_buffer, PushTableLogger& logger)
+        : m_Header(header)
+        , m_OriginalBuffer(original_buffer)
+        , m_Logger(logger)
+        , m_KeyCount(0)
+        {
+        }
+    };
+
+    // NOTE: We align lua_Number to sizeof(float) even if lua_Number probably is of double type
+    static const char* AlignBuffer(const TableReader& reader, const char* buffer)
+    {
+        intptr_t offset = buffer - reader.m_OriginalBuffer;
+        intptr_t aligned_buffer = ((intptr_t) offset + sizeof(float)-1) & ~(sizeof(float)-1);
+        intptr_t align_size = aligned_buffer - (intptr_t) offset;
+        buffer += align_size;
+        // Sanity-check. At least 4 bytes alignment (de facto)
+        assert((((intptr_t) buffer) & 3) == 0);
+        return buffer;
+    }
+
+    static int DoPushTable(lua_State*L, TableReader& reader, const char* buffer, uint32_t buffer_size, uint32_t depth);
+
+    // Pushes a value and returns the number of bytes consumed
+    static int PushValue(lua_State* L, TableReader& reader, char key_type, char value_type, const char* buffer, const char* buffer_end, uint32_t i, uint32_t count, uint32_t depth)
+    {
+        PushTableLogger& logger = reader.m_Logger;
+        const char* buffer_start = buffer;
+        switch (value_type)
+        {
+            case LUA_TBOOLEAN:
+            {
+                PushTableLogString(logger, "VB");
+
+                lua_pushboolean(L, *buffer++);
+                CHECK_PUSHTABLE_OOB("value bool", logger, buffer, buffer_end, count, depth);
+            }
+            break;
+
+            case LUA_TNUMBER:
+            {
+                PushTableLogString(logger, "VN");
+
+                buffer = AlignBuffer(reader, buffer);
+                lua_pushnumber(L, *((lua_Number_4_align *) buffer));
+                buffer += sizeof(lua_Number);
+
+                CHECK_PUSHTABLE_OOB("value number", logger, buffer, buffer_end, count, depth);
+            }
+            break;
+
+            case LUA_TSTRING:
+            {
+                PushTableLogString(logger, "VS");
+
+                if (reader.m_Header.m_Version <= 1)
+                    buffer += LoadOldTSTRING(L, buffer, buffer_end, count, logger);
+                else
+                    buffer += LoadTSTRING(L, buffer, buffer_end, count, logger);
+
+                CHECK_PUSHTABLE_OOB("value string", logger, buffer, buffer_end, count, depth);
+            }
+            break;
+
+            case LUA_TUSERDATA:
+            {
+                PushTableLogString(logger, "VU");
+
+                char sub_type = *buffer++;
+                buffer = AlignBuffer(reader, buffer);
+
+                CHECK_PUSHTABLE_OOB("descriptor for udata", logger, buffer, buffer_end, count, depth);
+
+                if (sub_type == (char) SUB_TYPE_VECTOR3)
+                {
+                    PushTableLogString(logger, "V3");
+
+                    float* f = (float*) buffer;
+                    dmScript::PushVector3(L, Vectormath::Aos::Vector3(f[0], f[1], f[2]));
+                    buffer += sizeof(float) * 3;
+                    CHECK_PUSHTABLE_OOB("udata vec3", logger, buffer, buffer_end, count, depth);
+                }
+                else if (sub_type == (char) SUB_TYPE_VECTOR4)
+                {
+                    PushTableLogString(logger, "V4");
+
+                    float* f = (float*) buffer;
+                    dmScript::PushVector4(L, Vectormath::Aos::Vector4(f[0], f[1], f[2], f[3]));
+                    buffer += sizeof(float) * 4;
+                    CHECK_PUSHTABLE_OOB("udata vec4", logger, buffer, buffer_end, count, depth);
+                }
+                else if (sub_type == (char) SUB_TYPE_QUAT)
+                {
+                    PushTableLogString(logger, "Q4");
+
+                    float* f = (float*) buffer;
+                    dmScript::PushQuat(L, Vectormath::Aos::Quat(f[0], f[1], f[2], f[3]));
+                    buffer += sizeof(float) * 4;
+                    CHECK_PUSHTABLE_OOB("udata quat", logger, buffer, buffer_end, count, depth);
+                }
+                else if (sub_type == (char) SUB_TYPE_MATRIX4)
+                {
+                    PushTableLogString(logger, "M4");
+
+                    float* f = (float*) buffer;
+                    Vectormath::Aos::Matrix4 m;
+                    for (uint32_t i = 0; i < 4; ++i)
+                        for (uint32_t j = 0; j < 4; ++j)
+                            m.setElem(i, j, f[i * 4 + j]);
+                    dmScript::PushMatrix4(L, m);
+                    buffer += sizeof(float) * 16;
+                    CHECK_PUSHTABLE_OOB("udata mat4", logger, buffer, buffer_end, count, depth);
+                }
+                else if (sub_type == (char) SUB_TYPE_HASH)
+                {
+                    PushTableLogString(logger, "H");
+
+                    dmhash_t hash;
+                    uint32_t hash_size = sizeof(dmhash_t);
+                    memcpy(&hash, buffer, hash_size);
+                    dmScript::PushHash(L, hash);
+                    buffer += hash_size;
+                    CHECK_PUSHTABLE_OOB("udata hash", logger, buffer, buffer_end, count, depth);
+                }
+                else if (sub_type == (char) SUB_TYPE_URL)
+                {
+                    PushTableLogString(logger, "URL");
+
+                    dmMessage::URL url;
+                    uint32_t url_size = sizeof(dmMessage::URL);
+                    memcpy(&url, buffer, url_size);
+                    dmScript::PushURL(L, url);
+                    buffer += url_size;
+                    CHECK_PUSHTABLE_OOB("udata url", logger, buffer, buffer_end, count, depth);
+                }
+                else
+                {
+                    return luaL_error(L, "Table contains invalid UserData subtype (%s) at element #%d: %s", lua_typename(L, key_type), i, buffer);
+                }
+            }
+            break;
+            case LUA_TTABLE:
+            {
+                int n_consumed = DoPushTable(L, reader, buffer, buffer_end - buffer, depth+1);
+                buffer += n_consumed;
+                CHECK_PUSHTABLE_OOB("table", logger, buffer, buffer_end, count, depth);
+            }
+            break;
+
+            default:
+                return luaL_error(L, "Table contains invalid type (%s) at element #%d: %s", lua_typename(L, key_type), i, buffer);
+                break;
+        }
+        return buffer - buffer_start;
+    }
+
+    // Pushes the array part of a version 4 table and returns the number of bytes consumed
+    static int PushArray(lua_State* L, TableReader& reader, uint32_t array_count, const char* buffer, const char* buffer_end, uint32_t count, uint32_t depth)
+    {
+        PushTableLogger& logger = reader.m_Logger;
+        const char* buffer_start = buffer;
+        CHECK_PUSHTABLE_OOB("array tag", logger, buffer+1, buffer_end, count, depth);
+
+        char array_type = *buffer++;
+        if (array_type == LUA_TNUMBER)
+        {
+            PushTableLogString(logger, "AN");
+
+            buffer = AlignBuffer(reader, buffer);
+            CHECK_PUSHTABLE_OOB("number array", logger, buffer + array_count * sizeof(lua_Number), buffer_end, count, depth);
+
+            for (uint32_t i = 1; i <= array_count; ++i)
+            {
+                lua_pushnumber(L, *((lua_Number_4_align *) buffer));
+                lua_rawseti(L, -2, i);
+                buffer += sizeof(lua_Number);
+            }
+        }
+        else if (array_type == LUA_TNIL)
+        {
+            PushTableLogString(logger, "A");
+
+            for (uint32_t i = 1; i <= array_count; ++i)
+            {
+                CHECK_PUSHTABLE_OOB("array value tag", logger, buffer+1, buffer_end, count, depth);
+                char value_type = *buffer++;
+                buffer += PushValue(L, reader, LUA_TNUMBER, value_type, buffer, buffer_end, i - 1, count, depth);
+                lua_rawseti(L, -2, i);
+            }
+        }
+        else
+        {
+            return luaL_error(L, "Table contains invalid array type (%d)", array_type);
+        }
+        return buffer - buffer_start;
+    }
+
+    // Pushes an interned key, encoded the same way as EncodeMSB, and returns the number of bytes consumed
+    static int PushKeyRef(lua_State* L, TableReader& reader, const char* buffer, const char* buffer_end, uint32_t count, uint32_t depth)
+    {
+        PushTableLogger& logger = reader.m_Logger;
+        CHECK_PUSHTABLE_OOB("key reference", logger, buffer+1, buffer_end, count, depth);
+
+        // Less than KEY_CACHE_MAX_KEYS keys are interned, which never needs more than two bytes
+        uint32_t key_index = (uint8_t)buffer[0] & 0x7f;
+        int consumed = 1;
+        if ((uint8_t)buffer[0] & 0x80)
+        {
+            CHECK_PUSHTABLE_OOB("key reference", logger, buffer+2, buffer_end, count, depth);
+            key_index |= ((uint8_t)buffer[1]) << 7;
+            consumed = 2;
+        }
+
+        if (reader.m_Header.m_Version < 4 || key_index >= reader.m_KeyCount)
+        {
+            return luaL_error(L, "Table contains invalid key reference (%d)", key_index);
+        }
+        lua_pushlstring(L, reader.m_Keys[key_index], reader.m_KeyLengths[key_index]);
+        return consumed;
+    }
+
+    static int DoPushTable(lua_State*L, TableReader& reader, const char* buffer, uint32_t buffer_size, uint32_t depth)
     {
         int top = lua_gettop(L);
         (void)top;
 
+        PushTableLogger& logger = reader.m_Logger;
+        const TableHeader& header = reader.m_Header;
         const char* buffer_start = buffer;
         const char* buffer_end = buffer + buffer_size;
         CHECK_PUSHTABLE_OOB("table header", logger, buffer+2, buffer_end, 0, depth);
@@ -698,9 +1089,32 @@ namespace dmScript
             return luaL_error(L, "%s", str);
         }
 
-        lua_newtable(L);
+        uint32_t array_count = 0;
+        if (header.m_Version >= 4 && count > 0)
+        {
+            CHECK_PUSHTABLE_OOB("array count", logger, buffer+2, buffer_end, count, depth);
+
+            uint16_t array_count16;
+            memcpy(&array_count16, buffer, sizeof(uint16_t));
+            buffer += 2;
+            array_count = array_count16;
+            if (array_count > count)
+            {
+                return luaL_error(L, "Table contains invalid array size (%d) for table of size %d", array_count, count);
+            }
 
-        for (uint32_t i = 0; i < count; ++i)
+            lua_createtable(L, array_count, count - array_count);
+            if (array_count > 0)
+            {
+                buffer += PushArray(L, reader, array_count, buffer, buffer_end, count, depth);
+            }
+        }
+        else
+        {
+            lua_newtable(L);
+        }
+
+        for (uint32_t i = array_count; i < count; ++i)
         {
             CHECK_PUSHTABLE_OOB("key-value tags", logger, buffer+2, buffer_end, count, depth);
 
@@ -711,12 +1125,27 @@ namespace dmScript
             {
                 PushTableLogString(logger, "KS");
 
+                const char* key = buffer;
                 if (header.m_Version <= 1)
                     buffer += LoadOldTSTRING(L, buffer, buffer_end, count, logger);
                 else
                     buffer += LoadTSTRING(L, buffer, buffer_end, count, logger);
 
                 CHECK_PUSHTABLE_OOB("key string", logger, buffer, buffer_end, count, depth);
+
+                // Mirror the interning done by the writer
+                if (header.m_Version >= 4 && reader.m_KeyCount < KEY_CACHE_MAX_KEYS)
+                {
+                    reader.m_Keys[reader.m_KeyCount] = key + sizeof(uint32_t);
+                    reader.m_KeyLengths[reader.m_KeyCount] = (uint32_t)(buffer - key - sizeof(uint32_t));
+                    reader.m_KeyCount++;
+                }
+            }
+            else if (key_type == LUA_TKEYREF)
+            {
+                PushTableLogString(logger, "KR");
+
+                buffer += PushKeyRef(L, reader, buffer, buffer_end, count, depth);
             }
             else if (key_type == LUA_TNUMBER || key_type == LUA_TNEGATIVENUMBER)
             {
@@ -726,146 +1155,8 @@ namespace dmScript
                 CHECK_PUSHTABLE_OOB("key number", logger, buffer, buffer_end, count, depth);
             }
 
-            switch (value_type)
-            {
-                case LUA_TBOOLEAN:
-                {
-                    PushTableLogString(logger, "VB");
-
-                    lua_pushboolean(L, *buffer++);
-                    CHECK_PUSHTABLE_OOB("value bool", logger, buffer, buffer_end, count, depth);
-                }
-                break;
-
-                case LUA_TNUMBER:
-                {
-                    PushTableLogString(logger, "VN");
-
-                    // NOTE: We align lua_Number to sizeof(float) even if lua_Number probably is of double type
-                    intptr_t offset = buffer - original_buffer;
-                    intptr_t aligned_buffer = ((intptr_t) offset + sizeof(float)-1) & ~(sizeof(float)-1);
-                    intptr_t align_size = aligned_buffer - (intptr_t) offset;
-                    buffer += align_size;
-                    // Sanity-check. At least 4 bytes alignment (de facto)
-                    assert((((intptr_t) buffer) & 3) == 0);
-
-                    lua_pushnumber(L, *((lua_Number_4_align *) buffer));
-                    buffer += sizeof(lua_Number);
-
-                    CHECK_PUSHTABLE_OOB("value number", logger, buffer, buffer_end, count, depth);
-                }
-                break;
-
-                case LUA_TSTRING:
-                {
-                    PushTableLogString(logger, "VS");
-
-                    if (header.m_Version <= 1)
-                        buffer += LoadOldTSTRING(L, buffer, buffer_end, count, logger);
-                    else
-                        buffer += LoadTSTRING(L, buffer, buffer_end, count, logger);
-
-                    CHECK_PUSHTABLE_OOB("value string", logger, buffer, buffer_end, count, depth);
-                }
-                break;
-
-                case LUA_TUSERDATA:
-                {
-                    PushTableLogString(logger, "VU");
-
-                    char sub_type = *buffer++;
-
-                    // NOTE: We align lua_Number to sizeof(float) even if lua_Number probably is of double type
-                    intptr_t offset = buffer - original_buffer;
-                    intptr_t aligned_buffer = ((intptr_t) offset + sizeof(float)-1) & ~(sizeof(float)-1);
-                    intptr_t align_size = aligned_buffer - (intptr_t) offset;
-                    buffer += align_size;
-                    // Sanity-check. At least 4 bytes alignment (de facto)
-                    assert((((intptr_t) buffer) & 3) == 0);
-
-                    CHECK_PUSHTABLE_OOB("descriptor for udata", logger, buffer, buffer_end, count, depth);
-
-                    if (sub_type == (char) SUB_TYPE_VECTOR3)
-                    {
-                        PushTableLogString(logger, "V3");
-
-                        float* f = (float*) buffer;
-                        dmScript::PushVector3(L, Vectormath::Aos::Vector3(f[0], f[1], f[2]));
-                        buffer += sizeof(float) * 3;
-                        CHECK_PUSHTABLE_OOB("udata vec3", logger, buffer, buffer_end, count, depth);
-                    }
-                    else if (sub_type == (char) SUB_TYPE_VECTOR4)
-                    {
-                        PushTableLogString(logger, "V4");
-
-                        float* f = (float*) buffer;
-                        dmScript::PushVector4(L, Vectormath::Aos::Vector4(f[0], f[1], f[2], f[3]));
-                        buffer += sizeof(float) * 4;
-                        CHECK_PUSHTABLE_OOB("udata vec4", logger, buffer, buffer_end, count, depth);
-                    }
-                    else if (sub_type == (char) SUB_TYPE_QUAT)
-                    {
-                        PushTableLogString(logger, "Q4");
-
-                        float* f = (float*) buffer;
-                        dmScript::PushQuat(L, Vectormath::Aos::Quat(f[0], f[1], f[2], f[3]));
-                        buffer += sizeof(float) * 4;
-                        CHECK_PUSHTABLE_OOB("udata quat", logger, buffer, buffer_end, count, depth);
-                    }
-                    else if (sub_type == (char) SUB_TYPE_MATRIX4)
-                    {
-                        PushTableLogString(logger, "M4");
-
-                        float* f = (float*) buffer;
-                        Vectormath::Aos::Matrix4 m;
-                        for (uint32_t i = 0; i < 4; ++i)
-                            for (uint32_t j = 0; j < 4; ++j)
-                                m.setElem(i, j, f[i * 4 + j]);
-                        dmScript::PushMatrix4(L, m);
-                        buffer += sizeof(float) * 16;
-                        CHECK_PUSHTABLE_OOB("udata mat4", logger, buffer, buffer_end, count, depth);
-                    }
-                    else if (sub_type == (char) SUB_TYPE_HASH)
-                    {
-                        PushTableLogString(logger, "H");
-
-                        dmhash_t hash;
-                        uint32_t hash_size = sizeof(dmhash_t);
-                        memcpy(&hash, buffer, hash_size);
-                        dmScript::PushHash(L, hash);
-                        buffer += hash_size;
-                        CHECK_PUSHTABLE_OOB("udata hash", logger, buffer, buffer_end, count, depth);
-                    }
-                    else if (sub_type == (char) SUB_TYPE_URL)
-                    {
-                        PushTableLogString(logger, "URL");
-
-                        dmMessage::URL url;
-                        uint32_t url_size = sizeof(dmMessage::URL);
-                        memcpy(&url, buffer, url_size);
-                        dmScript::PushURL(L, url);
-                        buffer += url_size;
-                        CHECK_PUSHTABLE_OOB("udata url", logger, buffer, buffer_end, count, depth);
-                    }
-                    else
-                    {
-                        return luaL_error(L, "Table contains invalid UserData subtype (%s) at element #%d: %s", lua_typename(L, key_type), i, buffer);
-                    }
-                }
-                break;
-                case LUA_TTABLE:
-                {
-                    int n_consumed = DoPushTable(L, logger, header, original_buffer, buffer, buffer_size, depth+1);
-                    buffer += n_consumed;
-                    CHECK_PUSHTABLE_OOB("table", logger, buffer, buffer_end, count, depth);
-                }
-                break;
-
-                default:
-                    return luaL_error(L, "Table contains invalid type (%s) at element #%d: %s", lua_typename(L, key_type), i, buffer);
-                    break;
-            }
-            lua_settable(L, -3);
+            buffer += PushValue(L, reader, key_type, value_type, buffer, buffer_end, i, count, depth);
+            lua_rawset(L, -3);
 
             CHECK_PUSHTABLE_OOB("loop end", logger, buffer, buffer_end, count, depth);
         }
@@ -897,7 +1188,9 @@ namespace dmScript
             PushTableLogger logger;
             logger.m_BufferStart = buffer;
             logger.m_BufferSize = buffer_size;
-            DoPushTable(L, logger, header, original_buffer, buffer, buffer_size, 0);
+
+            TableReader reader(header, original_buffer, logger);
+            DoPushTable(L, reader, buffer, buffer_size, 0);
         }
         else
         {
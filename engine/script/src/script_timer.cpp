@@ -37,20 +37,27 @@ namespace dmScript
      */
 
     /*
-        The timers are stored in a flat array with no holes which we scan sequenctially on each update.
-
-        When a timer is removed the last timer in the list may change location (EraseSwap).
-
-        This is to keep the array sweep fast and handle cases where multiple short lived timers are
-        created followed by one long-lived timer. If we did not re-shuffle and keep holes we would keep
-        scanning the array to the end where the only live timer exists skipping all the holes.
-        How much of an issue this is guesswork at this point.
+        The timers are stored in a flat array with no holes. When a timer is removed the last timer
+        in the list may change location (EraseSwap).
 
         The timer identity is an index into an indirection layer combined with a generation counter,
         this makes it possible to reuse the index for the indirection layer without risk of using
         stale indexes - the caller to CancelTimer is allowed to call with an handle of a timer that already
         has expired.
 
+        Instead of decrementing the remaining time of every timer on each update, the timer world keeps
+        a running clock and each timer stores the absolute time at which it fires. The live timers are
+        ordered in a binary min-heap on that deadline, so an update only pops the timers that actually
+        fire and the cost of an update is O(f log n) where f is the number of fired timers.
+        Timers with the same deadline fire in the order they were scheduled.
+
+        The heap references timers by their lookup index (which is stable while the timer lives) and each
+        timer stores its position in the heap so it can be removed in O(log n) when cancelled.
+
+        All timers of an owner are linked together in a list (also via lookup indexes), with the head of
+        the list stored in a hash table keyed on the owner. This keeps KillTimers O(k) where k is the
+        number of timers belonging to the owner.
+
         Each script instance needs to call KillTimers for its owner to clean up potential timers
         that has not yet been cancelled or completed (one-shot).
     */
@@ -64,22 +71,38 @@ namespace dmScript
         uintptr_t       m_Owner;
         uintptr_t       m_UserData;
 
+        // The absolute time (in timer world time) when the timer fires
+        double          m_Deadline;
+
         // Store complete timer handle with generation here to identify stale timer handles
         HTimer          m_Handle;
 
-        // How much time remaining until the timer fires
-        float           m_Remaining;
-
         // The timer delay, we need to keep this for repeating timers
         float           m_Delay;
 
+        // Position in the timer world heap, INVALID_TIMER_HEAP_INDEX if not scheduled
+        uint32_t        m_HeapIndex;
+
+        // Lookup indexes of the previous/next timer with the same owner
+        uint16_t        m_PrevOwnerTimer;
+        uint16_t        m_NextOwnerTimer;
+
         // Flag if the timer should repeat
         uint32_t        m_Repeat : 1;
         // Flag if the timer is alive
         uint32_t        m_IsAlive : 1;
     };
 
+    struct TimerHeapEntry
+    {
+        double          m_Deadline;
+        // Monotonically increasing schedule order, used to break ties between equal deadlines
+        uint32_t        m_Order;
+        uint16_t        m_LookupIndex;
+    };
+
     #define INVALID_TIMER_LOOKUP_INDEX  0xffffu
+    #define INVALID_TIMER_HEAP_INDEX    0xffffffffu
     #define INITIAL_TIMER_CAPACITY      8u
     #define MAX_TIMER_CAPACITY          65000u  // Needs to be less that 65535 since 65535 is reserved for invalid index
     #define TIMER_CAPACITY_GROWTH       16u
@@ -89,6 +112,15 @@ namespace dmScript
         dmArray<Timer>                      m_Timers;
         dmArray<uint16_t>                   m_IndexLookup;
         dmIndexPool<uint16_t>               m_IndexPool;
+        dmArray<TimerHeapEntry>             m_Heap;
+        // Lookup indexes of the timers that fire in the current update
+        dmArray<uint16_t>                   m_Triggered;
+        // Lookup indexes of the timers that died during the current update
+        dmArray<uint16_t>                   m_Dead;
+        // Owner -> lookup index of the first timer of the owner
+        dmHashTable64<uint16_t>             m_OwnerTimers;
+        double                              m_Time;
+        uint32_t                            m_ScheduleOrder;
         uint16_t                            m_Version;   // Incremented to avoid collisions each time we push timer indexes back to the m_IndexPool
         uint16_t                            m_InUpdate : 1;
     };
@@ -103,6 +135,179 @@ namespace dmScript
         return (((uint32_t)generation) << 16) | (lookup_index);
     }
 
+    static inline Timer& GetTimer(HTimerWorld timer_world, uint16_t lookup_index)
+    {
+        return timer_world->m_Timers[timer_world->m_IndexLookup[lookup_index]];
+    }
+
+    static inline bool HeapLess(const TimerHeapEntry& a, const TimerHeapEntry& b)
+    {
+        if (a.m_Deadline != b.m_Deadline)
+        {
+            return a.m_Deadline < b.m_Deadline;
+        }
+        // The order counter may wrap, compare the distance instead of the values
+        return (int32_t)(a.m_Order - b.m_Order) < 0;
+    }
+
+    static inline void HeapSet(HTimerWorld timer_world, uint32_t heap_index, const TimerHeapEntry& entry)
+    {
+        timer_world->m_Heap[heap_index] = entry;
+        GetTimer(timer_world, entry.m_LookupIndex).m_HeapIndex = heap_index;
+    }
+
+    static void HeapSiftUp(HTimerWorld timer_world, uint32_t heap_index)
+    {
+        TimerHeapEntry entry = timer_world->m_Heap[heap_index];
+        while (heap_index > 0)
+        {
+            uint32_t parent = (heap_index - 1) / 2;
+            if (!HeapLess(entry, timer_world->m_Heap[parent]))
+            {
+                break;
+            }
+            HeapSet(timer_world, heap_index, timer_world->m_Heap[parent]);
+            heap_index = parent;
+        }
+        HeapSet(timer_world, heap_index, entry);
+    }
+
+    static void HeapSiftDown(HTimerWorld timer_world, uint32_t heap_index)
+    {
+        dmArray<TimerHeapEntry>& heap = timer_world->m_Heap;
+        uint32_t size = heap.Size();
+        TimerHeapEntry entry = heap[heap_index];
+        while (true)
+        {
+            uint32_t child = heap_index * 2 + 1;
+            if (child >= size)
+            {
+                break;
+            }
+            if (child + 1 < size && HeapLess(heap[child + 1], heap[child]))
+            {
+                ++child;
+            }
+            if (!HeapLess(heap[child], entry))
+            {
+                break;
+            }
+            HeapSet(timer_world, heap_index, heap[child]);
+            heap_index = child;
+        }
+        HeapSet(timer_world, heap_index, entry);
+    }
+
+    static void ScheduleTimer(HTimerWorld timer_world, Timer& timer, double deadline)
+    {
+        assert(timer.m_HeapIndex == INVALID_TIMER_HEAP_INDEX);
+        timer.m_Deadline = deadline;
+
+        dmArray<TimerHeapEntry>& heap = timer_world->m_Heap;
+        if (heap.Full())
+        {
+            heap.OffsetCapacity(dmMath::Max(heap.Capacity(), TIMER_CAPACITY_GROWTH));
+        }
+        TimerHeapEntry entry;
+        entry.m_Deadline = deadline;
+        entry.m_Order = timer_world->m_ScheduleOrder++;
+        entry.m_LookupIndex = GetLookupIndex(timer.m_Handle);
+        heap.Push(entry);
+        HeapSiftUp(timer_world, heap.Size() - 1);
+    }
+
+    static void UnscheduleTimer(HTimerWorld timer_world, Timer& timer)
+    {
+        uint32_t heap_index = timer.m_HeapIndex;
+        if (heap_index == INVALID_TIMER_HEAP_INDEX)
+        {
+            return;
+        }
+        timer.m_HeapIndex = INVALID_TIMER_HEAP_INDEX;
+
+        dmArray<TimerHeapEntry>& heap = timer_world->m_Heap;
+        uint32_t last = heap.Size() - 1;
+        if (heap_index != last)
+        {
+            TimerHeapEntry moved = heap[last];
+            heap.Pop();
+            bool sift_up = HeapLess(moved, heap[heap_index]);
+            heap[heap_index] = moved;
+            if (sift_up)
+            {
+                HeapSiftUp(timer_world, heap_index);
+            }
+            else
+            {
+                HeapSiftDown(timer_world, heap_index);
+            }
+        }
+        else
+        {
+            heap.Pop();
+        }
+    }
+
+    static uint16_t PopExpiredTimer(HTimerWorld timer_world)
+    {
+        dmArray<TimerHeapEntry>& heap = timer_world->m_Heap;
+        if (heap.Empty() || heap[0].m_Deadline > timer_world->m_Time)
+        {
+            return INVALID_TIMER_LOOKUP_INDEX;
+        }
+        uint16_t lookup_index = heap[0].m_LookupIndex;
+        UnscheduleTimer(timer_world, GetTimer(timer_world, lookup_index));
+        return lookup_index;
+    }
+
+    static void LinkOwnerTimer(HTimerWorld timer_world, Timer& timer)
+    {
+        uint16_t lookup_index = GetLookupIndex(timer.m_Handle);
+        dmHashTable64<uint16_t>& owner_timers = timer_world->m_OwnerTimers;
+        uint16_t* first = owner_timers.Get(timer.m_Owner);
+
+        timer.m_PrevOwnerTimer = INVALID_TIMER_LOOKUP_INDEX;
+        if (first == 0x0)
+        {
+            timer.m_NextOwnerTimer = INVALID_TIMER_LOOKUP_INDEX;
+            if (owner_timers.Full())
+            {
+                uint32_t capacity = owner_timers.Capacity() + TIMER_CAPACITY_GROWTH;
+                owner_timers.SetCapacity(dmMath::Max(capacity / 2, 1u), capacity);
+            }
+            owner_timers.Put(timer.m_Owner, lookup_index);
+        }
+        else
+        {
+            timer.m_NextOwnerTimer = *first;
+            GetTimer(timer_world, *first).m_PrevOwnerTimer = lookup_index;
+            *first = lookup_index;
+        }
+    }
+
+    static void UnlinkOwnerTimer(HTimerWorld timer_world, Timer& timer)
+    {
+        if (timer.m_NextOwnerTimer != INVALID_TIMER_LOOKUP_INDEX)
+        {
+            GetTimer(timer_world, timer.m_NextOwnerTimer).m_PrevOwnerTimer = timer.m_PrevOwnerTimer;
+        }
+
+        if (timer.m_PrevOwnerTimer != INVALID_TIMER_LOOKUP_INDEX)
+        {
+            GetTimer(timer_world, timer.m_PrevOwnerTimer).m_NextOwnerTimer = timer.m_NextOwnerTimer;
+        }
+        else if (timer.m_NextOwnerTimer != INVALID_TIMER_LOOKUP_INDEX)
+        {
+            *timer_world->m_OwnerTimers.Get(timer.m_Owner) = timer.m_NextOwnerTimer;
+        }
+        else
+        {
+            timer_world->m_OwnerTimers.Erase(timer.m_Owner);
+        }
+        timer.m_PrevOwnerTimer = INVALID_TIMER_LOOKUP_INDEX;
+        timer.m_NextOwnerTimer = INVALID_TIMER_LOOKUP_INDEX;
+    }
+
     static Timer* AllocateTimer(HTimerWorld timer_world, uintptr_t owner)
     {
         assert(timer_world != 0x0);
@@ -136,10 +341,13 @@ namespace dmScript
         Timer& timer = timer_world->m_Timers[timer_count];
         timer.m_Handle = handle;
         timer.m_Owner = owner;
+        timer.m_HeapIndex = INVALID_TIMER_HEAP_INDEX;
 
         uint16_t lookup_index = GetLookupIndex(handle);
 
         timer_world->m_IndexLookup[lookup_index] = timer_count;
+
+        LinkOwnerTimer(timer_world, timer);
         return &timer;
     }
 
@@ -160,6 +368,9 @@ namespace dmScript
     {
         assert(timer_world != 0x0);
         assert(timer.m_IsAlive == 0);
+        assert(timer.m_HeapIndex == INVALID_TIMER_HEAP_INDEX);
+
+        UnlinkOwnerTimer(timer_world, timer);
 
         uint16_t lookup_index = GetLookupIndex(timer.m_Handle);
         uint16_t timer_index = timer_world->m_IndexLookup[lookup_index];
@@ -168,6 +379,32 @@ namespace dmScript
         EraseTimer(timer_world, timer_index);
     }
 
+    // Marks a live timer as dead and removes it from the schedule, the timer memory is kept until ReleaseTimer
+    static void KillTimer(HTimerWorld timer_world, Timer& timer)
+    {
+        assert(timer.m_IsAlive == 1);
+        timer.m_IsAlive = 0;
+        UnscheduleTimer(timer_world, timer);
+    }
+
+    // Outside of UpdateTimers a dead timer is freed directly, inside UpdateTimers it is freed once
+    // all the triggered timers have been dispatched
+    static void ReleaseTimer(HTimerWorld timer_world, uint16_t lookup_index)
+    {
+        if (timer_world->m_InUpdate == 0)
+        {
+            FreeTimer(timer_world, GetTimer(timer_world, lookup_index));
+        }
+        else
+        {
+            if (timer_world->m_Dead.Full())
+            {
+                timer_world->m_Dead.OffsetCapacity(dmMath::Max(timer_world->m_Dead.Capacity(), TIMER_CAPACITY_GROWTH));
+            }
+            timer_world->m_Dead.Push(lookup_index);
+        }
+    }
+
     HTimerWorld NewTimerWorld()
     {
         TimerWorld* timer_world = new TimerWorld();
@@ -176,6 +413,10 @@ namespace dmScript
         timer_world->m_IndexLookup.SetSize(INITIAL_TIMER_CAPACITY);
         memset(&timer_world->m_IndexLookup[0], 0u, INITIAL_TIMER_CAPACITY * sizeof(uint16_t));
         timer_world->m_IndexPool.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_Heap.SetCapacity(INITIAL_TIMER_CAPACITY);
+        timer_world->m_OwnerTimers.SetCapacity(INITIAL_TIMER_CAPACITY / 2, INITIAL_TIMER_CAPACITY);
+        timer_world->m_Time = 0.0;
+        timer_world->m_ScheduleOrder = 0;
         timer_world->m_Version = 0;
         timer_world->m_InUpdate = 0;
         return timer_world;
@@ -192,35 +433,48 @@ namespace dmScript
         assert(timer_world != 0x0);
         DM_PROFILE(TimerWorld, "Update");
 
-        timer_world->m_InUpdate = 1;
+        DM_COUNTER("timerc", timer_world->m_Timers.Size());
 
-        // We only scan timers for trigger if the timer *existed at entry to UpdateTimers*, any timers added
-        // in a trigger callback will always be added at the end of m_Timers and not triggered in this scope.
-        uint32_t size = timer_world->m_Timers.Size();
-        DM_COUNTER("timerc", size);
+        timer_world->m_Time += dt;
+        const double time = timer_world->m_Time;
 
-        for (uint32_t i = 0; i < size; ++i)
+        // We only trigger timers that *existed at entry to UpdateTimers*. All expired timers are popped from
+        // the heap before any callback is invoked, so timers added (or rescheduled) in a trigger callback are
+        // never triggered in this scope.
+        dmArray<uint16_t>& triggered = timer_world->m_Triggered;
+        triggered.SetSize(0);
+        uint16_t lookup_index;
+        while ((lookup_index = PopExpiredTimer(timer_world)) != INVALID_TIMER_LOOKUP_INDEX)
         {
-            Timer* timer = &timer_world->m_Timers[i];
-            if (timer->m_IsAlive == 0)
+            if (triggered.Full())
             {
-                continue;
+                triggered.OffsetCapacity(dmMath::Max(triggered.Capacity(), TIMER_CAPACITY_GROWTH));
             }
+            triggered.Push(lookup_index);
+        }
+
+        timer_world->m_InUpdate = 1;
+
+        uint32_t triggered_count = triggered.Size();
+        for (uint32_t i = 0; i < triggered_count; ++i)
+        {
+            lookup_index = triggered[i];
 
-            timer->m_Remaining -= dt;
-            if (timer->m_Remaining > 0.0f)
+            // The array might be reallocated by the callbacks! So always look up the timer again...
+            Timer* timer = &GetTimer(timer_world, lookup_index);
+            if (timer->m_IsAlive == 0)
             {
                 continue;
             }
 
-            float elapsed_time = timer->m_Delay - timer->m_Remaining;
+            float remaining = (float)(timer->m_Deadline - time);
+            float elapsed_time = timer->m_Delay - remaining;
 
             TimerEventType eventType = timer->m_Repeat == 0 ? TIMER_EVENT_TRIGGER_WILL_DIE : TIMER_EVENT_TRIGGER_WILL_REPEAT;
 
             timer->m_Callback(timer_world, eventType, timer->m_Handle, elapsed_time, timer->m_Owner, timer->m_UserData);
 
-            // The array might have been reallocated here! So grab the pointer again...
-            timer = &timer_world->m_Timers[i];
+            timer = &GetTimer(timer_world, lookup_index);
 
             if (timer->m_IsAlive == 0)
             {
@@ -229,42 +483,35 @@ namespace dmScript
 
             if (timer->m_Repeat == 0)
             {
-                timer->m_IsAlive = 0;
+                KillTimer(timer_world, *timer);
+                ReleaseTimer(timer_world, lookup_index);
                 continue;
             }
 
             if (timer->m_Delay == 0.0f)
             {
-                timer->m_Remaining = 0.0f;
+                ScheduleTimer(timer_world, *timer, time);
                 continue;
             }
 
-            float wrapped_count = ((-timer->m_Remaining) / timer->m_Delay) + 1.f;
+            float wrapped_count = ((-remaining) / timer->m_Delay) + 1.f;
             float offset_to_next_trigger  = floor(wrapped_count) * timer->m_Delay;
-            timer->m_Remaining += offset_to_next_trigger;
-            assert(timer->m_Remaining >= 0.f);
+            remaining += offset_to_next_trigger;
+            assert(remaining >= 0.f);
+            ScheduleTimer(timer_world, *timer, time + remaining);
         }
 
         timer_world->m_InUpdate = 0;
 
-        size = timer_world->m_Timers.Size();
-        uint32_t original_size = size;
-        uint32_t i = 0;
-        while (i < size)
+        dmArray<uint16_t>& dead = timer_world->m_Dead;
+        uint32_t dead_count = dead.Size();
+        for (uint32_t i = 0; i < dead_count; ++i)
         {
-            Timer& timer = timer_world->m_Timers[i];
-            if (timer.m_IsAlive == 0)
-            {
-                FreeTimer(timer_world, timer);
-                --size;
-            }
-            else
-            {
-                ++i;
-            }
+            FreeTimer(timer_world, GetTimer(timer_world, dead[i]));
         }
+        dead.SetSize(0);
 
-        if (size != original_size)
+        if (dead_count != 0)
         {
             ++timer_world->m_Version;
         }
@@ -287,47 +534,58 @@ namespace dmScript
         }
 
         timer->m_Delay = delay;
-        timer->m_Remaining = delay;
         timer->m_UserData = userdata;
         timer->m_Callback = timer_callback;
         timer->m_Repeat = repeat;
         timer->m_IsAlive = 1;
 
+        ScheduleTimer(timer_world, *timer, timer_world->m_Time + delay);
+
         return timer->m_Handle;
     }
 
-    bool CancelTimer(HTimerWorld timer_world, HTimer handle)
+    static Timer* LookupTimer(HTimerWorld timer_world, HTimer handle)
     {
-        assert(timer_world != 0x0);
         uint16_t lookup_index = GetLookupIndex(handle);
         if (lookup_index >= timer_world->m_IndexLookup.Size())
         {
-            return false;
+            return 0x0;
         }
 
         uint16_t timer_index = timer_world->m_IndexLookup[lookup_index];
         if (timer_index >= timer_world->m_Timers.Size())
         {
-            return false;
+            return 0x0;
         }
 
-        Timer& timer = timer_world->m_Timers[timer_index];
-        if (timer.m_Handle != handle)
+        Timer* timer = &timer_world->m_Timers[timer_index];
+        if (timer->m_Handle != handle)
+        {
+            return 0x0;
+        }
+        return timer;
+    }
+
+    bool CancelTimer(HTimerWorld timer_world, HTimer handle)
+    {
+        assert(timer_world != 0x0);
+        Timer* timer = LookupTimer(timer_world, handle);
+        if (timer == 0x0)
         {
             return false;
         }
 
-        if (timer.m_IsAlive == 0)
+        if (timer->m_IsAlive == 0)
         {
             return false;
         }
 
-        timer.m_IsAlive = 0;
-        timer.m_Callback(timer_world, TIMER_EVENT_CANCELLED, timer.m_Handle, 0.f, timer.m_Owner, timer.m_UserData);
+        KillTimer(timer_world, *timer);
+        timer->m_Callback(timer_world, TIMER_EVENT_CANCELLED, timer->m_Handle, 0.f, timer->m_Owner, timer->m_UserData);
 
+        ReleaseTimer(timer_world, GetLookupIndex(handle));
         if (timer_world->m_InUpdate == 0)
         {
-            FreeTimer(timer_world, timer);
             ++timer_world->m_Version;
         }
         return true;
@@ -337,33 +595,26 @@ namespace dmScript
     {
         assert(timer_world != 0x0);
 
-        uint32_t size = timer_world->m_Timers.Size();
+        uint16_t* first = timer_world->m_OwnerTimers.Get(owner);
+        if (first == 0x0)
+        {
+            return 0;
+        }
+
         uint32_t cancelled_count = 0;
-        uint32_t timer_index = 0;
-        while (timer_index < size)
+        uint16_t lookup_index = *first;
+        while (lookup_index != INVALID_TIMER_LOOKUP_INDEX)
         {
-            Timer& timer = timer_world->m_Timers[timer_index];
-            if (timer.m_Owner != owner)
-            {
-                ++timer_index;
-                continue;
-            }
+            Timer& timer = GetTimer(timer_world, lookup_index);
+            // Read the link before the timer is (potentially) freed
+            lookup_index = timer.m_NextOwnerTimer;
 
             if (timer.m_IsAlive == 1)
             {
-                timer.m_IsAlive = 0;
+                KillTimer(timer_world, timer);
+                ReleaseTimer(timer_world, GetLookupIndex(timer.m_Handle));
                 ++cancelled_count;
             }
-
-            if (timer_world->m_InUpdate == 0)
-            {
-                FreeTimer(timer_world, timer);
-                --size;
-            }
-            else
-            {
-                ++timer_index;
-            }
         }
 
         if (cancelled_count > 0)
@@ -374,6 +625,13 @@ namespace dmScript
         return cancelled_count;
     }
 
+    bool IsTimerAlive(HTimerWorld timer_world, HTimer handle)
+    {
+        assert(timer_world != 0x0);
+        Timer* timer = LookupTimer(timer_world, handle);
+        return timer != 0x0 && timer->m_IsAlive == 1;
+    }
+
     uint32_t GetAliveTimers(HTimerWorld timer_world)
     {
         assert(timer_world != 0x0);
@@ -20,6 +20,7 @@
 
 #include <dlib/dstrings.h>
 #include <dlib/log.h>
+#include <dlib/profile.h>
 
 extern "C"
 {
@@ -2265,6 +2266,390 @@ namespace dmScript
         return 1;
     }
 
+    // The in-place functions below write their result into the userdata passed as
+    // the first argument instead of allocating a new one. The output argument is
+    // fetched without the NaN check since its current value is overwritten.
+    static void* CheckOut(lua_State* L, ScriptUserType type, const char* function_name, const char* type_name)
+    {
+        if (GetType(L, 1) != type)
+        {
+            luaL_error(L, "%s.%s expects a %s.%s as output argument.", SCRIPT_LIB_NAME, function_name, SCRIPT_LIB_NAME, type_name);
+        }
+        DM_COUNTER("Lua.VmathReused", 1);
+        return lua_touserdata(L, 1);
+    }
+
+    /*# sets the value of a vector, quaternion or matrix in place
+     *
+     * Copies the value of another object of the same type into `out`,
+     * or assigns the components of `out` directly. No new object is created,
+     * which makes this function suitable for reusing temporary values in
+     * update loops.
+     *
+     * @name vmath.set
+     * @param out [type:vector3|vector4|quat|matrix4] the object to modify
+     * @param v [type:vector3|vector4|quat|matrix4|number] object of the same type to copy from, or the first component
+     * @param [y] [type:number] second component, when setting components
+     * @param [z] [type:number] third component, when setting components
+     * @param [w] [type:number] fourth component, when setting components of a vector4 or quat
+     * @return out [type:vector3|vector4|quat|matrix4] the modified object
+     * @examples
+     *
+     * ```lua
+     * local v = vmath.vector3()
+     * vmath.set(v, 1, 2, 3)
+     * print(v) --> vmath.vector3(1, 2, 3)
+     * local p = vmath.vector3()
+     * vmath.set(p, v)
+     * print(p) --> vmath.vector3(1, 2, 3)
+     * ```
+     */
+    static int Set(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        const bool components = lua_type(L, 2) == LUA_TNUMBER;
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, type, "set", SCRIPT_TYPE_NAME_VECTOR3);
+            if (components)
+                *out = Vectormath::Aos::Vector3((float) luaL_checknumber(L, 2), (float) luaL_checknumber(L, 3), (float) luaL_checknumber(L, 4));
+            else
+                *out = *CheckVector3(L, 2);
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = (Vectormath::Aos::Vector4*)CheckOut(L, type, "set", SCRIPT_TYPE_NAME_VECTOR4);
+            if (components)
+                *out = Vectormath::Aos::Vector4((float) luaL_checknumber(L, 2), (float) luaL_checknumber(L, 3), (float) luaL_checknumber(L, 4), (float) luaL_checknumber(L, 5));
+            else
+                *out = *CheckVector4(L, 2);
+        }
+        else if (type == SCRIPT_TYPE_QUAT)
+        {
+            Vectormath::Aos::Quat* out = (Vectormath::Aos::Quat*)CheckOut(L, type, "set", SCRIPT_TYPE_NAME_QUAT);
+            if (components)
+                *out = Vectormath::Aos::Quat((float) luaL_checknumber(L, 2), (float) luaL_checknumber(L, 3), (float) luaL_checknumber(L, 4), (float) luaL_checknumber(L, 5));
+            else
+                *out = *CheckQuat(L, 2);
+        }
+        else if (type == SCRIPT_TYPE_MATRIX4)
+        {
+            Vectormath::Aos::Matrix4* out = (Vectormath::Aos::Matrix4*)CheckOut(L, type, "set", SCRIPT_TYPE_NAME_MATRIX4);
+            *out = *CheckMatrix4(L, 2);
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s|%s|%s) as first argument.", SCRIPT_LIB_NAME, "set", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4, SCRIPT_TYPE_NAME_QUAT, SCRIPT_TYPE_NAME_MATRIX4);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# adds two vectors in place
+     *
+     * Calculates `v1 + v2 * s` and stores the result in `out`. The output
+     * vector may be one of the input vectors. No new vector is created,
+     * which avoids garbage in tight update loops.
+     *
+     * @name vmath.add_to
+     * @param out [type:vector3|vector4] vector to store the result in
+     * @param v1 [type:vector3|vector4] first vector
+     * @param v2 [type:vector3|vector4] second vector
+     * @param [s] [type:number] scale applied to `v2`, defaults to 1
+     * @return out [type:vector3|vector4] the modified `out` vector
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     -- same as self.pos = self.pos + self.vel * dt, without allocating
+     *     vmath.add_to(self.pos, self.pos, self.vel, dt)
+     * end
+     * ```
+     */
+    static int AddTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        const float s = (float) luaL_optnumber(L, 4, 1.0);
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, type, "add_to", SCRIPT_TYPE_NAME_VECTOR3);
+            Vectormath::Aos::Vector3* v1 = CheckVector3(L, 2);
+            Vectormath::Aos::Vector3* v2 = CheckVector3(L, 3);
+            *out = *v1 + *v2 * s;
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = (Vectormath::Aos::Vector4*)CheckOut(L, type, "add_to", SCRIPT_TYPE_NAME_VECTOR4);
+            Vectormath::Aos::Vector4* v1 = CheckVector4(L, 2);
+            Vectormath::Aos::Vector4* v2 = CheckVector4(L, 3);
+            *out = *v1 + *v2 * s;
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s) as arguments.", SCRIPT_LIB_NAME, "add_to", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# subtracts two vectors in place
+     *
+     * Calculates `v1 - v2` and stores the result in `out`. The output
+     * vector may be one of the input vectors.
+     *
+     * @name vmath.sub_to
+     * @param out [type:vector3|vector4] vector to store the result in
+     * @param v1 [type:vector3|vector4] vector to subtract from
+     * @param v2 [type:vector3|vector4] vector to subtract
+     * @return out [type:vector3|vector4] the modified `out` vector
+     * @examples
+     *
+     * ```lua
+     * local dir = vmath.vector3()
+     * vmath.sub_to(dir, target_pos, pos)
+     * ```
+     */
+    static int SubTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, type, "sub_to", SCRIPT_TYPE_NAME_VECTOR3);
+            Vectormath::Aos::Vector3* v1 = CheckVector3(L, 2);
+            Vectormath::Aos::Vector3* v2 = CheckVector3(L, 3);
+            *out = *v1 - *v2;
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = (Vectormath::Aos::Vector4*)CheckOut(L, type, "sub_to", SCRIPT_TYPE_NAME_VECTOR4);
+            Vectormath::Aos::Vector4* v1 = CheckVector4(L, 2);
+            Vectormath::Aos::Vector4* v2 = CheckVector4(L, 3);
+            *out = *v1 - *v2;
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s) as arguments.", SCRIPT_LIB_NAME, "sub_to", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# multiplies in place
+     *
+     * Calculates `a * b` and stores the result in `out`. The supported
+     * combinations are the same as for the `*` operator:
+     *
+     * - vector3 or vector4 scaled by a number
+     * - quat multiplied by a quat
+     * - matrix4 multiplied by a matrix4 or a number
+     * - matrix4 multiplied by a vector4, with a vector4 as output
+     *
+     * The output may be one of the inputs.
+     *
+     * @name vmath.mul_to
+     * @param out [type:vector3|vector4|quat|matrix4] object to store the result in
+     * @param a [type:vector3|vector4|quat|matrix4] first operand
+     * @param b [type:number|vector4|quat|matrix4] second operand
+     * @return out [type:vector3|vector4|quat|matrix4] the modified `out` object
+     * @examples
+     *
+     * ```lua
+     * local rot = vmath.quat()
+     * vmath.mul_to(rot, rot, vmath.quat_rotation_z(0.1))
+     * ```
+     */
+    static int MulTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        const ScriptUserType type_a = GetType(L, 2);
+        const ScriptUserType type_b = GetType(L, 3);
+        if (type == SCRIPT_TYPE_VECTOR3 && type_a == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, type, "mul_to", SCRIPT_TYPE_NAME_VECTOR3);
+            *out = *CheckVector3(L, 2) * (float) luaL_checknumber(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4 && type_a == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = (Vectormath::Aos::Vector4*)CheckOut(L, type, "mul_to", SCRIPT_TYPE_NAME_VECTOR4);
+            *out = *CheckVector4(L, 2) * (float) luaL_checknumber(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4 && type_a == SCRIPT_TYPE_MATRIX4 && type_b == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = (Vectormath::Aos::Vector4*)CheckOut(L, type, "mul_to", SCRIPT_TYPE_NAME_VECTOR4);
+            *out = *CheckMatrix4(L, 2) * *CheckVector4(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_QUAT && type_a == SCRIPT_TYPE_QUAT && type_b == SCRIPT_TYPE_QUAT)
+        {
+            Vectormath::Aos::Quat* out = (Vectormath::Aos::Quat*)CheckOut(L, type, "mul_to", SCRIPT_TYPE_NAME_QUAT);
+            *out = *CheckQuat(L, 2) * *CheckQuat(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_MATRIX4 && type_a == SCRIPT_TYPE_MATRIX4 && type_b == SCRIPT_TYPE_MATRIX4)
+        {
+            Vectormath::Aos::Matrix4* out = (Vectormath::Aos::Matrix4*)CheckOut(L, type, "mul_to", SCRIPT_TYPE_NAME_MATRIX4);
+            *out = *CheckMatrix4(L, 2) * *CheckMatrix4(L, 3);
+        }
+        else if (type == SCRIPT_TYPE_MATRIX4 && type_a == SCRIPT_TYPE_MATRIX4)
+        {
+            Vectormath::Aos::Matrix4* out = (Vectormath::Aos::Matrix4*)CheckOut(L, type, "mul_to", SCRIPT_TYPE_NAME_MATRIX4);
+            *out = *CheckMatrix4(L, 2) * (float) luaL_checknumber(L, 3);
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s does not support the given combination of arguments.", SCRIPT_LIB_NAME, "mul_to");
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# normalizes a vector or quaternion in place
+     *
+     * Normalizes `v` and stores the result in `out`. The output may be
+     * the same object as the input.
+     *
+     * @name vmath.normalize_to
+     * @param out [type:vector3|vector4|quat] object to store the result in
+     * @param v [type:vector3|vector4|quat] object to normalize
+     * @return out [type:vector3|vector4|quat] the modified `out` object
+     * @examples
+     *
+     * ```lua
+     * vmath.normalize_to(self.dir, self.dir)
+     * ```
+     */
+    static int NormalizeTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, type, "normalize_to", SCRIPT_TYPE_NAME_VECTOR3);
+            *out = Vectormath::Aos::normalize(*CheckVector3(L, 2));
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = (Vectormath::Aos::Vector4*)CheckOut(L, type, "normalize_to", SCRIPT_TYPE_NAME_VECTOR4);
+            *out = Vectormath::Aos::normalize(*CheckVector4(L, 2));
+        }
+        else if (type == SCRIPT_TYPE_QUAT)
+        {
+            Vectormath::Aos::Quat* out = (Vectormath::Aos::Quat*)CheckOut(L, type, "normalize_to", SCRIPT_TYPE_NAME_QUAT);
+            *out = Vectormath::Aos::normalize(*CheckQuat(L, 2));
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s|%s) as arguments.", SCRIPT_LIB_NAME, "normalize_to", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4, SCRIPT_TYPE_NAME_QUAT);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# calculates the cross-product of two vectors in place
+     *
+     * Calculates the cross product of `v1` and `v2` and stores the result
+     * in `out`. The output vector may be one of the input vectors.
+     *
+     * @name vmath.cross_to
+     * @param out [type:vector3] vector to store the result in
+     * @param v1 [type:vector3] first vector
+     * @param v2 [type:vector3] second vector
+     * @return out [type:vector3] the modified `out` vector
+     * @examples
+     *
+     * ```lua
+     * local n = vmath.vector3()
+     * vmath.cross_to(n, vmath.vector3(1, 0, 0), vmath.vector3(0, 1, 0)) --> vmath.vector3(0, 0, 1)
+     * ```
+     */
+    static int CrossTo(lua_State* L)
+    {
+        Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, SCRIPT_TYPE_VECTOR3, "cross_to", SCRIPT_TYPE_NAME_VECTOR3);
+        Vectormath::Aos::Vector3* v1 = CheckVector3(L, 2);
+        Vectormath::Aos::Vector3* v2 = CheckVector3(L, 3);
+        *out = Vectormath::Aos::cross(*v1, *v2);
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# lerps between two vectors or quaternions in place
+     *
+     * Linearly interpolates between `v1` and `v2` and stores the result in `out`.
+     * The output may be one of the inputs.
+     *
+     * [icon:attention] The function does not clamp t between 0 and 1.
+     *
+     * @name vmath.lerp_to
+     * @param out [type:vector3|vector4|quat] object to store the result in
+     * @param t [type:number] interpolation parameter, 0-1
+     * @param v1 [type:vector3|vector4|quat] object to lerp from
+     * @param v2 [type:vector3|vector4|quat] object to lerp to
+     * @return out [type:vector3|vector4|quat] the modified `out` object
+     * @examples
+     *
+     * ```lua
+     * function update(self, dt)
+     *     vmath.lerp_to(self.pos, 0.1, self.pos, self.target)
+     * end
+     * ```
+     */
+    static int LerpTo(lua_State* L)
+    {
+        const ScriptUserType type = GetType(L, 1);
+        const float t = (float) luaL_checknumber(L, 2);
+        if (type == SCRIPT_TYPE_VECTOR3)
+        {
+            Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, type, "lerp_to", SCRIPT_TYPE_NAME_VECTOR3);
+            Vectormath::Aos::Vector3* v1 = CheckVector3(L, 3);
+            Vectormath::Aos::Vector3* v2 = CheckVector3(L, 4);
+            *out = Vectormath::Aos::lerp(t, *v1, *v2);
+        }
+        else if (type == SCRIPT_TYPE_VECTOR4)
+        {
+            Vectormath::Aos::Vector4* out = (Vectormath::Aos::Vector4*)CheckOut(L, type, "lerp_to", SCRIPT_TYPE_NAME_VECTOR4);
+            Vectormath::Aos::Vector4* v1 = CheckVector4(L, 3);
+            Vectormath::Aos::Vector4* v2 = CheckVector4(L, 4);
+            *out = Vectormath::Aos::lerp(t, *v1, *v2);
+        }
+        else if (type == SCRIPT_TYPE_QUAT)
+        {
+            Vectormath::Aos::Quat* out = (Vectormath::Aos::Quat*)CheckOut(L, type, "lerp_to", SCRIPT_TYPE_NAME_QUAT);
+            Vectormath::Aos::Quat* q1 = CheckQuat(L, 3);
+            Vectormath::Aos::Quat* q2 = CheckQuat(L, 4);
+            *out = Vectormath::Aos::lerp(t, *q1, *q2);
+        }
+        else
+        {
+            return luaL_error(L, "%s.%s accepts (%s|%s|%s) as arguments.", SCRIPT_LIB_NAME, "lerp_to", SCRIPT_TYPE_NAME_VECTOR3, SCRIPT_TYPE_NAME_VECTOR4, SCRIPT_TYPE_NAME_QUAT);
+        }
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
+    /*# rotates a vector by a quaternion in place
+     *
+     * Rotates `v1` by the quaternion `q` and stores the result in `out`.
+     * The output vector may be the same object as `v1`.
+     *
+     * @name vmath.rotate_to
+     * @param out [type:vector3] vector to store the result in
+     * @param q [type:quat] quaternion
+     * @param v1 [type:vector3] vector to rotate
+     * @return out [type:vector3] the modified `out` vector
+     * @examples
+     *
+     * ```lua
+     * local v = vmath.vector3(1, 0, 0)
+     * vmath.rotate_to(v, vmath.quat_rotation_z(math.pi), v) --> vmath.vector3(-1, 0, 0)
+     * ```
+     */
+    static int RotateTo(lua_State* L)
+    {
+        Vectormath::Aos::Vector3* out = (Vectormath::Aos::Vector3*)CheckOut(L, SCRIPT_TYPE_VECTOR3, "rotate_to", SCRIPT_TYPE_NAME_VECTOR3);
+        Vectormath::Aos::Quat* q = CheckQuat(L, 2);
+        Vectormath::Aos::Vector3* v = CheckVector3(L, 3);
+        *out = Vectormath::Aos::rotate(*q, *v);
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
     static const luaL_reg methods[] =
     {
         {SCRIPT_TYPE_NAME_VECTOR, Vector_new},
@@ -2301,6 +2686,14 @@ namespace dmScript
         {"inv", Inverse},
         {"ortho_inv", OrthoInverse},
         {"mul_per_elem", MulPerElem},
+        {"set", Set},
+        {"add_to", AddTo},
+        {"sub_to", SubTo},
+        {"mul_to", MulTo},
+        {"normalize_to", NormalizeTo},
+        {"cross_to", CrossTo},
+        {"lerp_to", LerpTo},
+        {"rotate_to", RotateTo},
         {0, 0}
     };
 
@@ -2349,6 +2742,7 @@ namespace dmScript
     void PushVector3(lua_State* L, const Vectormath::Aos::Vector3& v)
     {
         Vectormath::Aos::Vector3* vp = (Vectormath::Aos::Vector3*)lua_newuserdata(L, sizeof(Vectormath::Aos::Vector3));
+        DM_COUNTER("Lua.VmathAllocs", 1);
         *vp = v;
         luaL_getmetatable(L, SCRIPT_TYPE_NAME_VECTOR3);
         lua_setmetatable(L, -2);
@@ -2367,6 +2761,7 @@ namespace dmScript
     void PushVector4(lua_State* L, const Vectormath::Aos::Vector4& v)
     {
         Vectormath::Aos::Vector4* vp = (Vectormath::Aos::Vector4*)lua_newuserdata(L, sizeof(Vectormath::Aos::Vector4));
+        DM_COUNTER("Lua.VmathAllocs", 1);
         *vp = v;
         luaL_getmetatable(L, SCRIPT_TYPE_NAME_VECTOR4);
         lua_setmetatable(L, -2);
@@ -2385,6 +2780,7 @@ namespace dmScript
     void PushQuat(lua_State* L, const Vectormath::Aos::Quat& q)
     {
         Vectormath::Aos::Quat* qp = (Vectormath::Aos::Quat*)lua_newuserdata(L, sizeof(Vectormath::Aos::Quat));
+        DM_COUNTER("Lua.VmathAllocs", 1);
         *qp = q;
         luaL_getmetatable(L, SCRIPT_TYPE_NAME_QUAT);
         lua_setmetatable(L, -2);
@@ -2403,6 +2799,7 @@ namespace dmScript
     void PushMatrix4(lua_State* L, const Vectormath::Aos::Matrix4& m)
     {
         Vectormath::Aos::Matrix4* mp = (Vectormath::Aos::Matrix4*)lua_newuserdata(L, sizeof(Vectormath::Aos::Matrix4));
+        DM_COUNTER("Lua.VmathAllocs", 1);
         *mp = m;
         luaL_getmetatable(L, SCRIPT_TYPE_NAME_MATRIX4);
         lua_setmetatable(L, -2);
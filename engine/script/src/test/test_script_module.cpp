@@ -16,6 +16,7 @@
 #include "script.h"
 #include "script_private.h"
 
+#include <dlib/array.h>
 #include <dlib/dstrings.h>
 #include <dlib/hash.h>
 #include <dlib/log.h>
@@ -172,6 +173,61 @@ TEST_F(ScriptModuleTest, TestReloadNotLoaded)
     ASSERT_EQ(top, lua_gettop(L));
 }
 
+static int WriteBytecode(lua_State* L, const void* p, size_t size, void* ud)
+{
+    dmArray<uint8_t>* bytecode = (dmArray<uint8_t>*) ud;
+    if (bytecode->Remaining() < size)
+        bytecode->OffsetCapacity(size + 256);
+    bytecode->PushArray((const uint8_t*) p, size);
+    return 0;
+}
+
+// The luac bytecode is loaded by the vanilla runtime, and ignored by LuaJIT
+TEST_F(ScriptModuleTest, TestLua51Bytecode)
+{
+    int top = lua_gettop(L);
+    const char* script = "return 2";
+    ASSERT_EQ(0, luaL_loadbuffer(L, script, strlen(script), "=bytecode"));
+    dmArray<uint8_t> bytecode;
+    lua_dump(L, WriteBytecode, &bytecode);
+    lua_pop(L, 1);
+    bool vanilla = bytecode.Size() > 4 && memcmp(bytecode.Begin(), "\x1bLua", 4) == 0;
+
+    dmLuaDDF::LuaSource* source = LuaSourceFromText("return 1");
+    memset(&source->m_Bytecode, 0, sizeof(source->m_Bytecode));
+    memset(&source->m_Bytecode64, 0, sizeof(source->m_Bytecode64));
+    source->m_Lua51Bytecode.m_Data = bytecode.Begin();
+    source->m_Lua51Bytecode.m_Count = bytecode.Size();
+    source->m_Lua51Bytecode64.m_Data = bytecode.Begin();
+    source->m_Lua51Bytecode64.m_Count = bytecode.Size();
+
+    ASSERT_EQ(0, dmScript::LuaLoad(L, source));
+    ASSERT_EQ(0, dmScript::PCall(L, 0, 1));
+    ASSERT_EQ(vanilla ? 2 : 1, lua_tointeger(L, -1));
+    lua_pop(L, 1);
+    ASSERT_EQ(top, lua_gettop(L));
+}
+
+// Bytecode from another Lua version or word size falls back to the source
+TEST_F(ScriptModuleTest, TestLua51BytecodeMismatch)
+{
+    int top = lua_gettop(L);
+    const char* bytecode = "\x1bLuaR\x00\x01\x04\x08\x04\x08\x00";
+    dmLuaDDF::LuaSource* source = LuaSourceFromText("return 1");
+    memset(&source->m_Bytecode, 0, sizeof(source->m_Bytecode));
+    memset(&source->m_Bytecode64, 0, sizeof(source->m_Bytecode64));
+    source->m_Lua51Bytecode.m_Data = (uint8_t*) bytecode;
+    source->m_Lua51Bytecode.m_Count = 12;
+    source->m_Lua51Bytecode64.m_Data = (uint8_t*) bytecode;
+    source->m_Lua51Bytecode64.m_Count = 12;
+
+    ASSERT_EQ(0, dmScript::LuaLoad(L, source));
+    ASSERT_EQ(0, dmScript::PCall(L, 0, 1));
+    ASSERT_EQ(1, lua_tointeger(L, -1));
+    lua_pop(L, 1);
+    ASSERT_EQ(top, lua_gettop(L));
+}
+
 struct ChunknameParam
 {
     const char* m_Input;
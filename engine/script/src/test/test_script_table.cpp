@@ -15,9 +15,11 @@
 #include <dlib/log.h>
 #include <dlib/align.h>
 #include <dlib/math.h>
+#include <dlib/time.h>
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include "../script.h"
+#include "../script_private.h"
 #include "test/test_ddf.h"
 
 #include "data/table_cos_v0.dat.embed.h"
@@ -166,7 +168,7 @@ TEST_F(LuaTableTest, AttemptReadUnsupportedVersion)
     int result = lua_cpcall(L, ReadUnsupportedVersion, 0x0);
     ASSERT_NE(0, result);
     char str[256];
-    dmSnPrintf(str, sizeof(str), "Unsupported serialized table data: version = 0x%x (current = 0x%x)", 818192, 3);
+    dmSnPrintf(str, sizeof(str), "Unsupported serialized table data: version = 0x%x (current = 0x%x)", 818192, 4);
     ASSERT_STREQ(str, lua_tostring(L, -1));
     // pop error message
     lua_pop(L, 1);
@@ -812,6 +814,221 @@ TEST_F(LuaTableTest, MixedKeys)
     lua_pop(L, 1);
 }
 
+TEST_F(LuaTableTest, NumberArray)
+{
+    const uint32_t count = 100;
+    lua_createtable(L, count, 0);
+    for (uint32_t i = 1; i <= count; ++i)
+    {
+        lua_pushnumber(L, i * 0.5);
+        lua_rawseti(L, -2, i);
+    }
+
+    char* buf = new char[1024];
+    uint32_t buffer_used = dmScript::CheckTable(L, buf, 1024, -1);
+    lua_pop(L, 1);
+
+    // header + count + array count + array type, aligned, followed by the numbers without any tags
+    ASSERT_EQ(16 + count * sizeof(lua_Number), buffer_used);
+
+    dmScript::PushTable(L, buf, buffer_used);
+    ASSERT_EQ(count, lua_objlen(L, -1));
+    for (uint32_t i = 1; i <= count; ++i)
+    {
+        lua_rawgeti(L, -1, i);
+        ASSERT_EQ(LUA_TNUMBER, lua_type(L, -1));
+        ASSERT_EQ(i * 0.5, lua_tonumber(L, -1));
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+
+    delete[] buf;
+}
+
+TEST_F(LuaTableTest, MixedArray)
+{
+    ASSERT_TRUE(RunString(L, "mixed = { 1, 'two', true, { x = 4 }, -5, n = 'name', [-1] = 'neg' }\n"
+                             "mixed[9] = 'after hole'"));
+    lua_getglobal(L, "mixed");
+
+    uint32_t buffer_used = dmScript::CheckTable(L, m_Buf, sizeof(m_Buf), -1);
+    lua_pop(L, 1);
+
+    dmScript::PushTable(L, m_Buf, buffer_used);
+    lua_setglobal(L, "result");
+
+    ASSERT_TRUE(RunString(L, "assert(#result == 5)\n"
+                             "assert(result[1] == 1)\n"
+                             "assert(result[2] == 'two')\n"
+                             "assert(result[3] == true)\n"
+                             "assert(result[4].x == 4)\n"
+                             "assert(result[5] == -5)\n"
+                             "assert(result[9] == 'after hole')\n"
+                             "assert(result[-1] == 'neg')\n"
+                             "assert(result.n == 'name')\n"
+                             "local count = 0\n"
+                             "for k,v in pairs(result) do count = count + 1 end\n"
+                             "assert(count == 8)"));
+}
+
+TEST_F(LuaTableTest, InternedKeys)
+{
+    ASSERT_TRUE(RunString(L, "function make_records(n)\n"
+                             "    local t = {}\n"
+                             "    for i=1,n do\n"
+                             "        t[i] = { name = 'record' .. i, level = i, alive = (i % 2) == 0 }\n"
+                             "    end\n"
+                             "    return { records = t }\n"
+                             "end\n"
+                             "one = make_records(1)\n"
+                             "many = make_records(50)"));
+
+    char* buf = new char[4096];
+
+    lua_getglobal(L, "one");
+    uint32_t size_one = dmScript::CheckTable(L, buf, 4096, -1);
+    lua_pop(L, 1);
+
+    lua_getglobal(L, "many");
+    uint32_t size_many = dmScript::CheckTable(L, buf, 4096, -1);
+    lua_pop(L, 1);
+
+    // The keys are only written as strings the first time they are seen
+    ASSERT_LT(size_many - size_one, 49 * (size_one - 8 - strlen("records") - 4));
+
+    dmScript::PushTable(L, buf, size_many);
+    lua_setglobal(L, "result");
+
+    ASSERT_TRUE(RunString(L, "assert(#result.records == 50)\n"
+                             "for i=1,50 do\n"
+                             "    local r = result.records[i]\n"
+                             "    assert(r.name == 'record' .. i)\n"
+                             "    assert(r.level == i)\n"
+                             "    assert(r.alive == ((i % 2) == 0))\n"
+                             "end"));
+
+    delete[] buf;
+}
+
+TEST_F(LuaTableTest, ManyKeys)
+{
+    // More distinct keys than are interned, repeated in a nested table
+    ASSERT_TRUE(RunString(L, "many_keys = { nested = {} }\n"
+                             "for i=1,300 do\n"
+                             "    many_keys['key' .. i] = i\n"
+                             "    many_keys.nested['key' .. i] = -i\n"
+                             "end"));
+    lua_getglobal(L, "many_keys");
+
+    const uint32_t buffer_size = 32 * 1024;
+    char* buf = new char[buffer_size];
+    uint32_t buffer_used = dmScript::CheckTable(L, buf, buffer_size, -1);
+    lua_pop(L, 1);
+
+    dmScript::PushTable(L, buf, buffer_used);
+    lua_setglobal(L, "result");
+
+    ASSERT_TRUE(RunString(L, "for i=1,300 do\n"
+                             "    assert(result['key' .. i] == i)\n"
+                             "    assert(result.nested['key' .. i] == -i)\n"
+                             "end"));
+
+    delete[] buf;
+}
+
+static int PushInvalidKeyRef(lua_State* L)
+{
+    char buf[32];
+    memset(buf, 0, sizeof(buf));
+    // Version 4 header, one entry, no array part
+    uint32_t header[2] = { 0x42544448, 4 };
+    memcpy(buf, header, sizeof(header));
+    buf[8] = 1;     // count
+    buf[10] = 0;    // array count
+    buf[12] = 65;   // key reference
+    buf[13] = LUA_TBOOLEAN;
+    buf[14] = 3;    // key number that was never written
+    buf[15] = 1;
+    dmScript::PushTable(L, buf, 16);
+    return 1;
+}
+
+TEST_F(LuaTableTest, InvalidKeyReference)
+{
+    int result = lua_cpcall(L, PushInvalidKeyRef, 0x0);
+    ASSERT_NE(0, result);
+    ASSERT_STREQ("Table contains invalid key reference (3)", lua_tostring(L, -1));
+    lua_pop(L, 1);
+}
+
+TEST_F(LuaTableTest, WriteVersion3)
+{
+    // The previous format, still written for comparing against it
+    ASSERT_TRUE(RunString(L, "v3 = { 1, 2, 3, name = 'v3', nested = { name = 'nested' } }"));
+    lua_getglobal(L, "v3");
+    uint32_t buffer_used = dmScript::CheckTableVersion(L, m_Buf, sizeof(m_Buf), -1, 3);
+    lua_pop(L, 1);
+    ASSERT_EQ(3u, ((uint32_t*) m_Buf)[1]);
+
+    dmScript::PushTable(L, m_Buf, buffer_used);
+    lua_setglobal(L, "result");
+    ASSERT_TRUE(RunString(L, "assert(#result == 3 and result[3] == 3)\n"
+                             "assert(result.name == 'v3' and result.nested.name == 'nested')"));
+}
+
+// Prints the time to encode and decode the global table name, and its encoded size, in the
+// previous format (version 3) and the current one
+static void BenchTable(lua_State* L, const char* name, char* buf, uint32_t buffer_size, uint32_t iterations)
+{
+    lua_getglobal(L, name);
+
+    const uint32_t versions[] = {3, 4};
+    for (uint32_t v = 0; v < sizeof(versions) / sizeof(versions[0]); ++v)
+    {
+        uint32_t buffer_used = 0;
+        uint64_t start = dmTime::GetTime();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            buffer_used = dmScript::CheckTableVersion(L, buf, buffer_size, -1, versions[v]);
+        }
+        uint64_t encoded = dmTime::GetTime();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            dmScript::PushTable(L, buf, buffer_used);
+            lua_pop(L, 1);
+        }
+        uint64_t decoded = dmTime::GetTime();
+
+        printf("%s version %u: %u bytes, encode %.2f us, decode %.2f us\n", name, versions[v], buffer_used,
+               (encoded - start) / (float) iterations, (decoded - encoded) / (float) iterations);
+    }
+    lua_pop(L, 1);
+}
+
+TEST_F(LuaTableTest, BenchSaveFile)
+{
+    // A save game with a few hundred records and a long numeric history
+    ASSERT_TRUE(RunString(L, "save_file = { version = 3, settings = { music = 0.5, sound = 1, fullscreen = true }, players = {}, history = {} }\n"
+                             "for i=1,200 do\n"
+                             "    save_file.players[i] = { name = 'player' .. i, level = i, score = i * 1.5, alive = true,\n"
+                             "                             position = vmath.vector3(i, i * 2, 0), inventory = { 1, 2, 3, 4, 5 } }\n"
+                             "end\n"
+                             "for i=1,2000 do save_file.history[i] = math.sin(i) end"));
+
+    const uint32_t buffer_size = 512 * 1024;
+    char* buf = new char[buffer_size];
+    BenchTable(L, "save_file", buf, buffer_size, 20);
+    delete[] buf;
+}
+
+TEST_F(LuaTableTest, BenchMessage)
+{
+    // A typical msg.post payload
+    ASSERT_TRUE(RunString(L, "message = { id = hash('enemy'), position = vmath.vector3(1, 2, 3), damage = 10, critical = false, tags = { 'fire', 'area' } }"));
+
+    BenchTable(L, "message", m_Buf, sizeof(m_Buf), 10000);
+}
+
 int static ParseTruncatedTable(lua_State* L)
 {
     size_t buffer_len = 0;
@@ -719,6 +719,70 @@ TEST_F(ScriptTimerTest, TestKillTimers)
     dmScript::DeleteTimerWorld(timer_world);
 }
 
+TEST_F(ScriptTimerTest, TestTriggerOrder)
+{
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+
+    static uintptr_t order[8];
+    static uint32_t order_count = 0;
+
+    struct Callback {
+        static void cb(dmScript::HTimerWorld timer_world, dmScript::TimerEventType event_type, dmScript::HTimer timer_handle, float time_elapsed, uintptr_t owner, uintptr_t userdata)
+        {
+            order[order_count++] = userdata;
+        }
+    };
+
+    // Added out of order, should trigger sorted on delay and in add order for equal delays
+    const float delays[] = { 3.0f, 1.0f, 2.0f, 1.0f, 3.0f, 2.0f, 1.0f, 2.0f };
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, delays[i], false, Callback::cb, 0x10 + (i % 3), i));
+    }
+
+    // A killed owner should not affect the order of the remaining timers
+    ASSERT_EQ(3u, dmScript::KillTimers(timer_world, 0x10));
+    ASSERT_EQ(5u, GetAliveTimers(timer_world));
+
+    dmScript::UpdateTimers(timer_world, 1.5f);
+    ASSERT_EQ(1u, order_count);
+    ASSERT_EQ(1u, order[0]);
+
+    dmScript::UpdateTimers(timer_world, 10.0f);
+    ASSERT_EQ(5u, order_count);
+    ASSERT_EQ(2u, order[1]);
+    ASSERT_EQ(5u, order[2]);
+    ASSERT_EQ(7u, order[3]);
+    ASSERT_EQ(4u, order[4]);
+
+    ASSERT_EQ(0u, GetAliveTimers(timer_world));
+
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
+TEST_F(ScriptTimerTest, TestManyTimers)
+{
+    dmScript::HTimerWorld timer_world = dmScript::NewTimerWorld();
+
+    const uint32_t count = 10000;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        ASSERT_NE(dmScript::INVALID_TIMER_HANDLE, dmScript::AddTimer(timer_world, (float)(i % 100) + 1.0f, false, TestCallback, i % 10, 0x0));
+    }
+
+    dmScript::UpdateTimers(timer_world, 1.0f);
+    ASSERT_EQ(count / 100, TimerTestCallback::callback_count);
+
+    ASSERT_EQ(count / 10 - count / 100, dmScript::KillTimers(timer_world, 0));
+    ASSERT_EQ(0u, dmScript::KillTimers(timer_world, 0));
+
+    dmScript::UpdateTimers(timer_world, 99.0f);
+    ASSERT_EQ(count - count / 10 + count / 100, TimerTestCallback::callback_count);
+    ASSERT_EQ(0u, GetAliveTimers(timer_world));
+
+    dmScript::DeleteTimerWorld(timer_world);
+}
+
 static bool RunString(lua_State* L, const char* script)
 {
     luaL_loadstring(L, script);
@@ -338,6 +338,33 @@ TEST_F(ScriptVmathTest, TestMatrix4Fail)
 }
 
 
+TEST_F(ScriptVmathTest, TestInPlace)
+{
+    ASSERT_TRUE(RunFile(L, "test_vmath_inplace.luac"));
+}
+
+TEST_F(ScriptVmathTest, TestInPlaceFail)
+{
+    // output of wrong type
+    ASSERT_FALSE(RunString(L, "vmath.add_to(vmath.vector4(), vmath.vector3(), vmath.vector3())"));
+    ASSERT_FALSE(RunString(L, "vmath.add_to(1, vmath.vector3(), vmath.vector3())"));
+    ASSERT_FALSE(RunString(L, "vmath.cross_to(vmath.quat(), vmath.vector3(), vmath.vector3())"));
+    // mixed inputs
+    ASSERT_FALSE(RunString(L, "vmath.sub_to(vmath.vector3(), vmath.vector3(), vmath.vector4())"));
+    ASSERT_FALSE(RunString(L, "vmath.mul_to(vmath.quat(), vmath.quat(), 2)"));
+    ASSERT_FALSE(RunString(L, "vmath.mul_to(vmath.vector3(), vmath.matrix4(), vmath.vector4())"));
+    ASSERT_FALSE(RunString(L, "vmath.set(vmath.vector3(), vmath.vector4())"));
+    ASSERT_FALSE(RunString(L, "vmath.set(vmath.vector3(), 1, 2)"));
+    ASSERT_FALSE(RunString(L, "vmath.lerp_to(vmath.vector3(), 0.5, vmath.vector3(), 1)"));
+    ASSERT_FALSE(RunString(L, "vmath.rotate_to(vmath.vector3(), vmath.vector3(), vmath.vector3())"));
+
+    // a failed call leaves the output untouched
+    ASSERT_TRUE(RunString(L, "local v = vmath.vector3(1, 2, 3)\n"
+                             "assert(not pcall(vmath.set, v, 4, 5))\n"
+                             "assert(v == vmath.vector3(1, 2, 3))"));
+}
+
+
 TEST_F(ScriptVmathTest, TestToValueFn)
 {
     int top = lua_gettop(L);
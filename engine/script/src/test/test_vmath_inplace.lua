@@ -0,0 +1,138 @@
+-- Copyright 2020 The Defold Foundation
+-- Licensed under the Defold License version 1.0 (the "License"); you may not use
+-- this file except in compliance with the License.
+-- 
+-- You may obtain a copy of the License, together with FAQs at
+-- https://www.defold.com/license
+-- 
+-- Unless required by applicable law or agreed to in writing, software distributed
+-- under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+-- CONDITIONS OF ANY KIND, either express or implied. See the License for the
+-- specific language governing permissions and limitations under the License.
+
+
+local function assert_near(a, b, msg)
+    assert(math.abs(a - b) < 0.0001, msg)
+end
+
+-- set
+local v = vmath.vector3()
+local r = vmath.set(v, 1, 2, 3)
+assert(r == v, "set does not return out")
+assert(v.x == 1 and v.y == 2 and v.z == 3, "set components failed")
+local v2 = vmath.vector3()
+vmath.set(v2, v)
+assert(v2 == v, "set copy failed")
+v.x = 10
+assert(v2.x == 1, "set does not copy")
+
+local v4 = vmath.vector4()
+vmath.set(v4, 1, 2, 3, 4)
+assert(v4 == vmath.vector4(1, 2, 3, 4), "set vector4 failed")
+
+local q = vmath.quat()
+vmath.set(q, 0, 0, 0, 1)
+assert(q == vmath.quat(), "set quat failed")
+
+local m = vmath.matrix4_rotation_z(1)
+local m2 = vmath.matrix4()
+vmath.set(m2, m)
+assert(m2 == m, "set matrix4 failed")
+
+-- add_to, with aliasing and optional scale
+local pos = vmath.vector3(1, 2, 3)
+local vel = vmath.vector3(2, 4, 6)
+local p = pos
+vmath.add_to(pos, pos, vel)
+assert(p == pos, "add_to replaced out")
+assert(pos == vmath.vector3(3, 6, 9), "add_to failed")
+vmath.add_to(pos, pos, vel, 0.5)
+assert(pos == vmath.vector3(4, 8, 12), "add_to with scale failed")
+v4 = vmath.vector4(1, 1, 1, 1)
+vmath.add_to(v4, v4, vmath.vector4(1, 2, 3, 4))
+assert(v4 == vmath.vector4(2, 3, 4, 5), "add_to vector4 failed")
+
+-- sub_to
+vmath.sub_to(pos, pos, vel)
+assert(pos == vmath.vector3(2, 4, 6), "sub_to failed")
+vmath.sub_to(v4, v4, vmath.vector4(1, 1, 1, 1))
+assert(v4 == vmath.vector4(1, 2, 3, 4), "sub_to vector4 failed")
+
+-- mul_to
+vmath.mul_to(pos, pos, 0.5)
+assert(pos == vmath.vector3(1, 2, 3), "mul_to scale failed")
+vmath.mul_to(v4, v4, 2)
+assert(v4 == vmath.vector4(2, 4, 6, 8), "mul_to vector4 scale failed")
+local qa = vmath.quat_rotation_z(0.5)
+local qb = vmath.quat_rotation_z(0.25)
+local qr = vmath.quat()
+vmath.mul_to(qr, qa, qb)
+assert(qr == qa * qb, "mul_to quat failed")
+vmath.mul_to(qa, qa, qb)
+assert(qa == qr, "mul_to quat aliased failed")
+local ma = vmath.matrix4_rotation_z(0.5)
+local mb = vmath.matrix4_translation(vmath.vector3(1, 2, 3))
+local mr = vmath.matrix4()
+vmath.mul_to(mr, ma, mb)
+assert(mr == ma * mb, "mul_to matrix4 failed")
+vmath.mul_to(mr, ma, 2)
+assert(mr == ma * 2, "mul_to matrix4 scale failed")
+local vr = vmath.vector4()
+vmath.mul_to(vr, mb, vmath.vector4(0, 0, 0, 1))
+assert(vr == vmath.vector4(1, 2, 3, 1), "mul_to matrix4 vector4 failed")
+
+-- normalize_to
+v = vmath.vector3(3, 0, 4)
+vmath.normalize_to(v, v)
+assert_near(v.x, 0.6, "normalize_to x failed")
+assert_near(v.z, 0.8, "normalize_to z failed")
+q = vmath.quat(0, 0, 0, 2)
+vmath.normalize_to(q, q)
+assert_near(q.w, 1, "normalize_to quat failed")
+
+-- cross_to
+v = vmath.vector3(1, 0, 0)
+vmath.cross_to(v, v, vmath.vector3(0, 1, 0))
+assert(v == vmath.vector3(0, 0, 1), "cross_to failed")
+
+-- lerp_to
+v = vmath.vector3(0, 0, 0)
+vmath.lerp_to(v, 0.25, v, vmath.vector3(4, 8, 12))
+assert(v == vmath.vector3(1, 2, 3), "lerp_to failed")
+q = vmath.quat()
+local q_to = vmath.quat_rotation_z(1)
+vmath.lerp_to(q, 0.5, q, q_to)
+assert(q == vmath.lerp(0.5, vmath.quat(), q_to), "lerp_to quat failed")
+
+-- rotate_to
+v = vmath.vector3(1, 0, 0)
+vmath.rotate_to(v, vmath.quat_rotation_z(math.pi * 0.5), v)
+assert_near(v.x, 0, "rotate_to x failed")
+assert_near(v.y, 1, "rotate_to y failed")
+
+-- in-place updates produce far less garbage than the operator equivalents
+local function garbage(fn)
+    collectgarbage("collect")
+    collectgarbage("stop")
+    local before = collectgarbage("count")
+    fn()
+    local after = collectgarbage("count")
+    collectgarbage("restart")
+    return after - before
+end
+
+local n = 10000
+local dt = 1 / 60
+pos = vmath.vector3()
+vel = vmath.vector3(1, 2, 3)
+local allocating = garbage(function()
+    for i = 1, n do
+        pos = pos + vel * dt
+    end
+end)
+local in_place = garbage(function()
+    for i = 1, n do
+        vmath.add_to(pos, pos, vel, dt)
+    end
+end)
+assert(in_place * 10 < allocating, string.format("in-place update allocated %f kb, operators %f kb", in_place, allocating))
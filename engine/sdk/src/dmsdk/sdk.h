@@ -30,6 +30,7 @@
 #include <dmsdk/dlib/mutex.h>
 #include <dmsdk/dlib/dstrings.h>
 #include <dmsdk/dlib/hash.h>
+#include <dmsdk/dlib/job_system.h>
 #include <dmsdk/graphics/graphics_native.h>
 #include <dmsdk/graphics/graphics.h>
 #include <dmsdk/vectormath/cpp/vectormath_aos.h>
@@ -11,6 +11,8 @@
 // specific language governing permissions and limitations under the License.
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <dlib/index_pool.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
@@ -24,12 +26,185 @@ namespace dmSoundCodec
 {
     namespace
     {
+        // Initial size of the compressed data window when streaming. Grows when a
+        // packet (or the headers) doesn't fit, up to STREAM_INPUT_MAX_SIZE
+        const uint32_t STREAM_INPUT_SIZE = 8 * 1024;
+        const uint32_t STREAM_INPUT_MAX_SIZE = 256 * 1024;
+        // Pending skips shorter than this (in frames) are decoded past exactly
+        // instead of seeking, which re-syncs on an ogg page
+        const uint32_t SEEK_MIN_FRAMES = 8 * 1024;
+
         struct DecodeStreamInfo {
             Info m_Info;
             stb_vorbis *m_StbVorbis;
+
+            // Streaming from a StreamSource through the pushdata api.
+            // m_Input is null for streams opened from memory
+            StreamSource m_Source;
+            uint8_t*     m_Input;
+            uint32_t     m_InputStart;
+            uint32_t     m_InputEnd;
+            uint32_t     m_InputCapacity;
+            // Decoded frame not yet returned to the caller
+            float**      m_Output;
+            int          m_OutputSamples;
+            int          m_OutputOffset;
+            bool         m_SourceEnd;
+
+            // Streams opened from memory skip by moving m_Position only. The decoder
+            // catches up on the next decode, see StbVorbisApplySkip
+            uint32_t     m_Length;
+            uint32_t     m_Position;
+            uint32_t     m_DecodedPosition;
         };
     }
 
+    // Move unconsumed data to the front of the window and top it up from the source
+    static void StbVorbisFillInput(DecodeStreamInfo* streamInfo)
+    {
+        uint32_t remaining = streamInfo->m_InputEnd - streamInfo->m_InputStart;
+        if (streamInfo->m_InputStart > 0) {
+            memmove(streamInfo->m_Input, streamInfo->m_Input + streamInfo->m_InputStart, remaining);
+            streamInfo->m_InputStart = 0;
+            streamInfo->m_InputEnd = remaining;
+        }
+
+        // A single read, since the source may have to block to return more than it has buffered
+        if (!streamInfo->m_SourceEnd && streamInfo->m_InputEnd < streamInfo->m_InputCapacity) {
+            uint32_t nread = streamInfo->m_Source.m_Read(streamInfo->m_Source.m_Context, streamInfo->m_Input + streamInfo->m_InputEnd, streamInfo->m_InputCapacity - streamInfo->m_InputEnd);
+            if (nread == 0) {
+                streamInfo->m_SourceEnd = true;
+            }
+            streamInfo->m_InputEnd += nread;
+        }
+    }
+
+    // Make room for more data when the window is full but still doesn't hold a whole packet
+    static bool StbVorbisGrowInput(DecodeStreamInfo* streamInfo)
+    {
+        if (streamInfo->m_InputStart > 0 || streamInfo->m_InputEnd < streamInfo->m_InputCapacity) {
+            return true;
+        }
+        if (streamInfo->m_InputCapacity >= STREAM_INPUT_MAX_SIZE) {
+            return false;
+        }
+        streamInfo->m_InputCapacity *= 2;
+        streamInfo->m_Input = (uint8_t*) realloc(streamInfo->m_Input, streamInfo->m_InputCapacity);
+        return true;
+    }
+
+    static Result StbVorbisOpenPushData(DecodeStreamInfo* streamInfo)
+    {
+        streamInfo->m_InputStart = 0;
+        streamInfo->m_InputEnd = 0;
+        streamInfo->m_Output = 0;
+        streamInfo->m_OutputSamples = 0;
+        streamInfo->m_OutputOffset = 0;
+        streamInfo->m_SourceEnd = false;
+
+        while (true) {
+            StbVorbisFillInput(streamInfo);
+
+            int used = 0;
+            int error = 0;
+            stb_vorbis* vorbis = stb_vorbis_open_pushdata(streamInfo->m_Input, streamInfo->m_InputEnd, &used, &error, NULL);
+            if (vorbis) {
+                streamInfo->m_StbVorbis = vorbis;
+                streamInfo->m_InputStart = used;
+                return RESULT_OK;
+            }
+
+            if (error != VORBIS_need_more_data || streamInfo->m_SourceEnd || !StbVorbisGrowInput(streamInfo)) {
+                return RESULT_INVALID_FORMAT;
+            }
+        }
+    }
+
+    static Result StbVorbisOpenSourceStream(const StreamSource* source, HDecodeStream* stream)
+    {
+        DecodeStreamInfo *streamInfo = new DecodeStreamInfo;
+        memset(streamInfo, 0, sizeof(*streamInfo));
+        streamInfo->m_Source = *source;
+        streamInfo->m_InputCapacity = STREAM_INPUT_SIZE;
+        streamInfo->m_Input = (uint8_t*) malloc(STREAM_INPUT_SIZE);
+
+        Result r = StbVorbisOpenPushData(streamInfo);
+        if (r != RESULT_OK) {
+            free(streamInfo->m_Input);
+            delete streamInfo;
+            return r;
+        }
+
+        stb_vorbis_info info = stb_vorbis_get_info(streamInfo->m_StbVorbis);
+        streamInfo->m_Info.m_Rate = info.sample_rate;
+        streamInfo->m_Info.m_Size = 0;
+        streamInfo->m_Info.m_Channels = info.channels;
+        streamInfo->m_Info.m_BitsPerSample = 16;
+
+        *stream = streamInfo;
+        return RESULT_OK;
+    }
+
+    // Decode from the pushdata window. A null buffer skips the frames without converting them
+    static Result StbVorbisDecodePushData(DecodeStreamInfo* streamInfo, char* buffer, uint32_t buffer_size, uint32_t* decoded)
+    {
+        if (!streamInfo->m_StbVorbis) {
+            // Failed to reopen the stream on reset
+            return RESULT_DECODE_ERROR;
+        }
+
+        const int channels = streamInfo->m_Info.m_Channels;
+        const uint32_t frame_size = channels * sizeof(short);
+        const uint32_t frames = buffer_size / frame_size;
+        short* out = (short*) buffer;
+
+        uint32_t done = 0;
+        while (done < frames) {
+            if (streamInfo->m_OutputOffset < streamInfo->m_OutputSamples) {
+                uint32_t n = dmMath::Min(frames - done, (uint32_t) (streamInfo->m_OutputSamples - streamInfo->m_OutputOffset));
+                if (out) {
+                    for (uint32_t i = 0; i < n; ++i) {
+                        for (int c = 0; c < channels; ++c) {
+                            // Round like stb_vorbis_get_samples_short_interleaved does
+                            float f = streamInfo->m_Output[c][streamInfo->m_OutputOffset + i] * 32768.0f;
+                            int v = (int) (f < 0.0f ? f - 0.5f : f + 0.5f);
+                            *out++ = (short) dmMath::Clamp(v, -32768, 32767);
+                        }
+                    }
+                }
+                streamInfo->m_OutputOffset += n;
+                done += n;
+                continue;
+            }
+
+            int samples = 0;
+            float** output = 0;
+            int used = stb_vorbis_decode_frame_pushdata(streamInfo->m_StbVorbis,
+                                                        streamInfo->m_Input + streamInfo->m_InputStart,
+                                                        streamInfo->m_InputEnd - streamInfo->m_InputStart,
+                                                        NULL, &output, &samples);
+            if (used == 0) {
+                // Not a whole packet in the window
+                if (streamInfo->m_SourceEnd) {
+                    break;
+                }
+                if (!StbVorbisGrowInput(streamInfo)) {
+                    return RESULT_DECODE_ERROR;
+                }
+                StbVorbisFillInput(streamInfo);
+                continue;
+            }
+
+            streamInfo->m_InputStart += used;
+            streamInfo->m_Output = output;
+            streamInfo->m_OutputSamples = samples;
+            streamInfo->m_OutputOffset = 0;
+        }
+
+        *decoded = done * frame_size;
+        return RESULT_OK;
+    }
+
     static Result StbVorbisOpenStream(const void* buffer, uint32_t buffer_size, HDecodeStream* stream)
     {
         int error;
@@ -39,11 +214,14 @@ namespace dmSoundCodec
             stb_vorbis_info info = stb_vorbis_get_info(vorbis);
 
             DecodeStreamInfo *streamInfo = new DecodeStreamInfo;
+            memset(streamInfo, 0, sizeof(*streamInfo));
             streamInfo->m_Info.m_Rate = info.sample_rate;
             streamInfo->m_Info.m_Size = 0;
             streamInfo->m_Info.m_Channels = info.channels;
             streamInfo->m_Info.m_BitsPerSample = 16;
             streamInfo->m_StbVorbis = vorbis;
+            streamInfo->m_Input = 0;
+            streamInfo->m_Length = stb_vorbis_stream_length_in_samples(vorbis);
 
             *stream = streamInfo;
             return RESULT_OK;
@@ -52,12 +230,47 @@ namespace dmSoundCodec
         }
     }
 
+    // Move the decoder to the position skipped to. Long skips seek, which in this
+    // version of stb_vorbis may land up to half a block after the target. That is
+    // inaudible for a voice coming back from being virtual, and cheaper than
+    // decoding every packet in between
+    static void StbVorbisApplySkip(DecodeStreamInfo* streamInfo)
+    {
+        uint32_t frames = streamInfo->m_Position - streamInfo->m_DecodedPosition;
+        if (frames == 0) {
+            return;
+        }
+
+        stb_vorbis* vorbis = streamInfo->m_StbVorbis;
+        if (frames >= SEEK_MIN_FRAMES) {
+            stb_vorbis_get_error(vorbis); // clears any earlier error
+            stb_vorbis_seek(vorbis, streamInfo->m_Position);
+            if (stb_vorbis_get_error(vorbis) == VORBIS__no_error) {
+                streamInfo->m_DecodedPosition = streamInfo->m_Position;
+                return;
+            }
+            // Seeking fails close to the end of the stream
+            stb_vorbis_seek_start(vorbis);
+            frames = streamInfo->m_Position;
+        }
+
+        // A null buffer skips the frames, stb_vorbis then leaves out most of the decoding work
+        stb_vorbis_get_samples_short_interleaved(vorbis, streamInfo->m_Info.m_Channels, 0, frames * streamInfo->m_Info.m_Channels);
+        streamInfo->m_DecodedPosition = streamInfo->m_Position;
+    }
+
     static Result StbVorbisDecode(HDecodeStream stream, char* buffer, uint32_t buffer_size, uint32_t* decoded)
     {
         DecodeStreamInfo *streamInfo = (DecodeStreamInfo *) stream;
 
         DM_PROFILE(SoundCodec, "StbVorbis")
 
+        if (streamInfo->m_Input) {
+            return StbVorbisDecodePushData(streamInfo, buffer, buffer_size, decoded);
+        }
+
+        StbVorbisApplySkip(streamInfo);
+
         int ret = 0;
         if (streamInfo->m_Info.m_Channels == 1) {
             ret = stb_vorbis_get_samples_short_interleaved(streamInfo->m_StbVorbis, 1, (short*) buffer, buffer_size / 2);
@@ -77,6 +290,8 @@ namespace dmSoundCodec
             } else {
                 assert(0);
             }
+            streamInfo->m_Position += ret;
+            streamInfo->m_DecodedPosition = streamInfo->m_Position;
         }
 
         return RESULT_OK;
@@ -84,23 +299,43 @@ namespace dmSoundCodec
 
     Result StbVorbisResetStream(HDecodeStream stream)
     {
-        stb_vorbis_seek_start(((DecodeStreamInfo*)stream)->m_StbVorbis);
+        DecodeStreamInfo *streamInfo = (DecodeStreamInfo *) stream;
+        if (streamInfo->m_Input) {
+            // The pushdata api can't seek, so restart the source and parse the headers again
+            stb_vorbis_close(streamInfo->m_StbVorbis);
+            streamInfo->m_StbVorbis = 0;
+            streamInfo->m_Source.m_Rewind(streamInfo->m_Source.m_Context);
+            return StbVorbisOpenPushData(streamInfo);
+        }
+        stb_vorbis_seek_start(streamInfo->m_StbVorbis);
+        streamInfo->m_Position = 0;
+        streamInfo->m_DecodedPosition = 0;
         return RESULT_OK;
     }
 
     Result StbVorbisSkipInStream(HDecodeStream stream, uint32_t bytes, uint32_t* skipped)
     {
-        // Decode with buffer = null corresponding number of bytes.
-        // stb_vorbis has a special case for this skipping a lot of
-        // decoding work.
-        Result r = StbVorbisDecode(stream, 0, bytes, skipped);
-        return r;
+        DecodeStreamInfo *streamInfo = (DecodeStreamInfo *) stream;
+        if (streamInfo->m_Input) {
+            // The pushdata api can't seek, so the packets are decoded and thrown away
+            return StbVorbisDecode(stream, 0, bytes, skipped);
+        }
+
+        // Only count the frames, the seek is done when decoding again
+        const uint32_t frame_size = streamInfo->m_Info.m_Channels * sizeof(short);
+        uint32_t frames = dmMath::Min(bytes / frame_size, streamInfo->m_Length - dmMath::Min(streamInfo->m_Position, streamInfo->m_Length));
+        streamInfo->m_Position += frames;
+        *skipped = frames * frame_size;
+        return RESULT_OK;
     }
 
     void StbVorbisCloseStream(HDecodeStream stream)
     {
         DecodeStreamInfo *streamInfo = (DecodeStreamInfo*) stream;
-        stb_vorbis_close(streamInfo->m_StbVorbis);
+        if (streamInfo->m_StbVorbis) {
+            stb_vorbis_close(streamInfo->m_StbVorbis);
+        }
+        free(streamInfo->m_Input);
         delete streamInfo;
     }
 
@@ -109,7 +344,8 @@ namespace dmSoundCodec
         *out = ((DecodeStreamInfo *)stream)->m_Info;
     }
 
-    DM_DECLARE_SOUND_DECODER(AudioDecoderStbVorbis, "VorbisDecoderStb", FORMAT_VORBIS,
+    DM_DECLARE_SOUND_STREAMING_DECODER(AudioDecoderStbVorbis, "VorbisDecoderStb", FORMAT_VORBIS,
                              5, // baseline score (1-10)
-                             StbVorbisOpenStream, StbVorbisCloseStream, StbVorbisDecode, StbVorbisResetStream, StbVorbisSkipInStream, StbVorbisGetInfo);
+                             StbVorbisOpenStream, StbVorbisCloseStream, StbVorbisDecode, StbVorbisResetStream, StbVorbisSkipInStream, StbVorbisGetInfo,
+                             StbVorbisOpenSourceStream);
 }
@@ -11,10 +11,16 @@
 // specific language governing permissions and limitations under the License.
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlib/dstrings.h>
 #include <dlib/hashtable.h>
 #include <dlib/index_pool.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
+#include <dlib/mutex.h>
+#include <dlib/condition_variable.h>
+#include <dlib/thread.h>
 #include <dlib/profile.h>
 
 #include "sound.h"
@@ -23,6 +29,7 @@
 
 #include <math.h>
 #include <cfloat>
+#include <algorithm>
 
 /**
  * Defold simple sound system
@@ -144,13 +151,47 @@ namespace dmSound
         dmhash_t      m_NameHash;
         void*         m_Data;
         int           m_Size;
+        // Set for streaming sounds, which have no m_Data
+        SoundDataReadCallback m_ReadCallback;
+        void*         m_ReadContext;
+        // Decoded data shared by all instances, see m_DecodedCacheSize
+        uint8_t*      m_Decoded;
+        uint32_t      m_DecodedSize;
+        dmSoundCodec::Info m_DecodedInfo;
+        // For LRU eviction
+        uint32_t      m_DecodedLastUsed;
+        // Number of instances mixing from m_Decoded
+        uint16_t      m_DecodedUsers;
         // Index in m_SoundData
         uint16_t      m_Index;
         SoundDataType m_Type;
+        // Decodes to more than the cache threshold
+        uint8_t       m_DecodedTooLarge : 1;
+        // m_Decoded is of data that was replaced, and is freed when the last instance mixing from it is deleted
+        uint8_t       m_DecodedStale : 1;
+        uint8_t       : 6;
+    };
+
+    /**
+     * Ring buffer of compressed data for a streaming sound instance.
+     * Refilled by the stream thread, and read by the decoder while mixing. Without the
+     * thread (web) it's refilled in Update() before mixing. Guarded by m_StreamMutex
+     */
+    struct StreamBuffer
+    {
+        uint8_t*    m_Data;
+        uint32_t    m_Capacity;
+        uint32_t    m_ReadPos;
+        uint32_t    m_Count;
+        // Offset of the next byte to read from the sound data
+        uint32_t    m_SourceOffset;
+        // Bumped on rewind, so that a read in flight isn't added to the ring
+        uint32_t    m_Generation;
     };
 
     struct SoundInstance
     {
+        // Null when mixing from the decoded data of the sound
         dmSoundCodec::HDecoder m_Decoder;
         void*       m_Frames;
         dmhash_t    m_Group;
@@ -160,13 +201,19 @@ namespace dmSound
         float       m_Speed;    // 1.0 = normal speed, 0.5 = half speed, 2.0 = double speed
         uint32_t    m_FrameCount;
         uint64_t    m_FrameFraction;
+        StreamBuffer m_StreamBuffer;
+        // Byte offset into the decoded data of the sound, when there is no decoder
+        uint32_t    m_DecodedOffset;
 
         uint16_t    m_Index;
         uint16_t    m_SoundDataIndex;
+        uint8_t     m_Priority;
         uint8_t     m_Looping : 1;
         uint8_t     m_EndOfStream : 1;
         uint8_t     m_Playing : 1;
-        uint8_t     : 5;
+        // Over the voice limits. Advances without decoding or mixing
+        uint8_t     m_Virtual : 1;
+        uint8_t     : 4;
     };
 
     struct SoundGroup
@@ -177,6 +224,16 @@ namespace dmSound
         float    m_SumSquaredMemory[SOUND_MAX_MIX_CHANNELS * GROUP_MEMORY_BUFFER_COUNT];
         float    m_PeakMemorySq[SOUND_MAX_MIX_CHANNELS * GROUP_MEMORY_BUFFER_COUNT];
         int      m_NextMemorySlot;
+        uint32_t m_MaxVoices;   // 0 = no limit
+        uint32_t m_VoiceCount;
+    };
+
+    // Playing instance competing for a voice
+    struct Voice
+    {
+        float       m_Audibility;
+        uint16_t    m_Index;
+        uint8_t     m_Priority;
     };
 
     struct SoundSystem
@@ -191,6 +248,8 @@ namespace dmSound
         dmArray<SoundData>      m_SoundData;
         dmIndexPool16           m_SoundDataPool;
 
+        dmArray<Voice>          m_Voices;
+
         dmHashTable<dmhash_t, int> m_GroupMap;
         SoundGroup              m_Groups[MAX_GROUPS];
 
@@ -199,10 +258,27 @@ namespace dmSound
         uint32_t                m_MixRate;
         uint32_t                m_FrameCount;
         uint32_t                m_PlayCounter;
+        uint32_t                m_StreamingThreshold;
+        uint32_t                m_StreamBufferSize;
+        uint32_t                m_DecodedCacheSize;
+        uint32_t                m_DecodedCacheThreshold;
+        uint32_t                m_DecodedCacheClock;
+        uint32_t                m_MaxVoices;
 
         int16_t*                m_OutBuffers[SOUND_OUTBUFFER_COUNT];
         uint16_t                m_NextOutBuffer;
 
+        // Reads streaming sound data into the ring buffers. Started with the first streaming sound
+        dmThread::Thread        m_StreamThread;
+        // Guards the ring buffers, and the data of the sounds they are read from
+        dmMutex::HMutex         m_StreamMutex;
+        // Signaled when a ring needs data, when data was added, and when a read is done
+        dmConditionVariable::HConditionVariable m_StreamCondition;
+        // The ring being read into, and its sound, while the lock is released for the read
+        SoundInstance*          m_StreamReadingInstance;
+        SoundData*              m_StreamReadingSoundData;
+        bool                    m_StreamThreadQuit;
+
         bool                    m_IsDeviceStarted;
         bool                    m_IsPhoneCallActive;
         bool                    m_HasWindowFocus;
@@ -223,6 +299,11 @@ namespace dmSound
         params->m_BufferSize = 12 * 4096;
         params->m_FrameCount = 768;
         params->m_MaxInstances = 256;
+        params->m_StreamingThreshold = 0;
+        params->m_StreamBufferSize = 32 * 1024;
+        params->m_DecodedCacheSize = 0;
+        params->m_DecodedCacheThreshold = 128 * 1024;
+        params->m_MaxVoices = 0;
     }
 
     Result RegisterDevice(struct DeviceType* device)
@@ -270,6 +351,33 @@ namespace dmSound
         return index;
     }
 
+    // Parses the "group=limit,..." list of the sound.group_voice_limits setting
+    static void SetGroupVoiceLimits(SoundSystem* sound, const char* limits)
+    {
+        char buffer[512];
+        dmStrlCpy(buffer, limits, sizeof(buffer));
+
+        char* last = 0;
+        for (char* entry = dmStrTok(buffer, ", ", &last); entry; entry = dmStrTok(0, ", ", &last))
+        {
+            char* separator = strchr(entry, '=');
+            if (!separator)
+            {
+                dmLogWarning("Expected group=limit in sound.group_voice_limits, got '%s'", entry);
+                continue;
+            }
+            *separator = 0;
+
+            int index = GetOrCreateGroup(entry);
+            if (index == -1)
+            {
+                dmLogWarning("Unable to add the voice limit of sound group '%s' (%d)", entry, RESULT_OUT_OF_GROUPS);
+                continue;
+            }
+            sound->m_Groups[index].m_MaxVoices = (uint32_t) dmMath::Max(0, atoi(separator + 1));
+        }
+    }
+
     Result Initialize(dmConfigFile::HConfig config, const InitializeParams* params)
     {
         Result r = PlatformInitialize(config, params);
@@ -309,6 +417,11 @@ namespace dmSound
         uint32_t max_buffers = params->m_MaxBuffers;
         uint32_t max_sources = params->m_MaxSources;
         uint32_t max_instances = params->m_MaxInstances;
+        uint32_t streaming_threshold = params->m_StreamingThreshold;
+        uint32_t stream_buffer_size = params->m_StreamBufferSize;
+        uint32_t decoded_cache_size = params->m_DecodedCacheSize;
+        uint32_t decoded_cache_threshold = params->m_DecodedCacheThreshold;
+        uint32_t max_voices = params->m_MaxVoices;
 
         if (config)
         {
@@ -317,11 +430,17 @@ namespace dmSound
             max_buffers = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_buffers", (int32_t) max_buffers);
             max_sources = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_sources", (int32_t) max_sources);
             max_instances = (uint32_t) dmConfigFile::GetInt(config, "sound.max_sound_instances", (int32_t) max_instances);
+            streaming_threshold = (uint32_t) dmConfigFile::GetInt(config, "sound.stream_threshold", (int32_t) streaming_threshold);
+            stream_buffer_size = (uint32_t) dmConfigFile::GetInt(config, "sound.stream_buffer_size", (int32_t) stream_buffer_size);
+            decoded_cache_size = (uint32_t) dmConfigFile::GetInt(config, "sound.decoded_cache_size", (int32_t) decoded_cache_size);
+            decoded_cache_threshold = (uint32_t) dmConfigFile::GetInt(config, "sound.decoded_cache_threshold", (int32_t) decoded_cache_threshold);
+            max_voices = (uint32_t) dmConfigFile::GetInt(config, "sound.max_voices", (int32_t) max_voices);
         }
 
         sound->m_Instances.SetCapacity(max_instances);
         sound->m_Instances.SetSize(max_instances);
         sound->m_InstancesPool.SetCapacity(max_instances);
+        sound->m_Voices.SetCapacity(max_instances);
         for (uint32_t i = 0; i < max_instances; ++i)
         {
             SoundInstance* instance = &sound->m_Instances[i];
@@ -340,16 +459,30 @@ namespace dmSound
         sound->m_SoundDataPool.SetCapacity(max_sound_data);
         for (uint32_t i = 0; i < max_sound_data; ++i)
         {
+            memset(&sound->m_SoundData[i], 0, sizeof(SoundData));
             sound->m_SoundData[i].m_Index = 0xffff;
         }
 
         sound->m_MixRate = device_info.m_MixRate;
         sound->m_FrameCount = params->m_FrameCount;
+        sound->m_StreamingThreshold = streaming_threshold;
+        sound->m_StreamBufferSize = dmMath::Max(stream_buffer_size, 4096U);
+        sound->m_DecodedCacheSize = decoded_cache_size;
+        sound->m_DecodedCacheThreshold = dmMath::Min(decoded_cache_threshold, decoded_cache_size);
+        sound->m_DecodedCacheClock = 0;
+        sound->m_MaxVoices = max_voices;
         for (int i = 0; i < SOUND_OUTBUFFER_COUNT; ++i) {
             sound->m_OutBuffers[i] = (int16_t*) malloc(params->m_FrameCount * sizeof(int16_t) * SOUND_MAX_MIX_CHANNELS);
         }
         sound->m_NextOutBuffer = 0;
 
+        sound->m_StreamThread = 0;
+        sound->m_StreamMutex = dmMutex::New();
+        sound->m_StreamCondition = dmConditionVariable::New();
+        sound->m_StreamReadingInstance = 0;
+        sound->m_StreamReadingSoundData = 0;
+        sound->m_StreamThreadQuit = false;
+
         memset(&g_SoundSystem->m_Stats, 0, sizeof(g_SoundSystem->m_Stats));
         sound->m_GroupMap.SetCapacity(MAX_GROUPS * 2 + 1, MAX_GROUPS);
         for (uint32_t i = 0; i < MAX_GROUPS; ++i) {
@@ -360,6 +493,11 @@ namespace dmSound
         SoundGroup* master = &sound->m_Groups[master_index];
         master->m_Gain.Reset(master_gain);
 
+        if (config)
+        {
+            SetGroupVoiceLimits(sound, dmConfigFile::GetString(config, "sound.group_voice_limits", ""));
+        }
+
         return RESULT_OK;
     }
 
@@ -372,6 +510,18 @@ namespace dmSound
         if (g_SoundSystem)
         {
             SoundSystem* sound = g_SoundSystem;
+            if (sound->m_StreamThread)
+            {
+                dmMutex::Lock(sound->m_StreamMutex);
+                sound->m_StreamThreadQuit = true;
+                dmConditionVariable::Broadcast(sound->m_StreamCondition);
+                dmMutex::Unlock(sound->m_StreamMutex);
+                dmThread::Join(sound->m_StreamThread);
+                sound->m_StreamThread = 0;
+            }
+            dmConditionVariable::Delete(sound->m_StreamCondition);
+            dmMutex::Delete(sound->m_StreamMutex);
+
             dmSoundCodec::Delete(sound->m_CodecContext);
 
             for (uint32_t i = 0; i < sound->m_Instances.Size(); ++i)
@@ -380,9 +530,15 @@ namespace dmSound
                 instance->m_Index = 0xffff;
                 instance->m_SoundDataIndex = 0xffff;
                 free(instance->m_Frames);
+                free(instance->m_StreamBuffer.m_Data);
                 memset(instance, 0, sizeof(*instance));
             }
 
+            for (uint32_t i = 0; i < sound->m_SoundData.Size(); ++i)
+            {
+                free(sound->m_SoundData[i].m_Decoded);
+            }
+
             for (int i = 0; i < SOUND_OUTBUFFER_COUNT; ++i) {
                 free((void*) sound->m_OutBuffers[i]);
             }
@@ -432,6 +588,13 @@ namespace dmSound
         sd->m_Index = index;
         sd->m_Data = 0;
         sd->m_Size = 0;
+        sd->m_ReadCallback = 0;
+        sd->m_ReadContext = 0;
+        sd->m_Decoded = 0;
+        sd->m_DecodedSize = 0;
+        sd->m_DecodedUsers = 0;
+        sd->m_DecodedTooLarge = 0;
+        sd->m_DecodedStale = 0;
 
         Result result = SetSoundData(sd, sound_buffer, sound_buffer_size);
         if (result == RESULT_OK)
@@ -442,32 +605,460 @@ namespace dmSound
         return result;
     }
 
+    static void StreamThread(void* context);
+
+    Result NewSoundDataStreaming(SoundDataReadCallback read_cb, void* read_ctx, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name)
+    {
+        SoundSystem* sound = g_SoundSystem;
+
+        if (type != SOUND_DATA_TYPE_OGG_VORBIS)
+        {
+            *sound_data = 0;
+            return RESULT_UNSUPPORTED;
+        }
+
+        if (sound->m_SoundDataPool.Remaining() == 0)
+        {
+            *sound_data = 0;
+            dmLogError("Out of sound data slots (%u). Increase the project setting 'sound.max_sound_data'", sound->m_SoundDataPool.Capacity());
+            return RESULT_OUT_OF_INSTANCES;
+        }
+        uint16_t index = sound->m_SoundDataPool.Pop();
+
+        SoundData* sd = &sound->m_SoundData[index];
+        sd->m_NameHash = name;
+        sd->m_Type = type;
+        sd->m_Index = index;
+        sd->m_Data = 0;
+        sd->m_Size = sound_buffer_size;
+        sd->m_ReadCallback = read_cb;
+        sd->m_ReadContext = read_ctx;
+        sd->m_Decoded = 0;
+        sd->m_DecodedSize = 0;
+        sd->m_DecodedUsers = 0;
+        sd->m_DecodedTooLarge = 0;
+        sd->m_DecodedStale = 0;
+
+#if !(defined(__EMSCRIPTEN__))
+        if (!sound->m_StreamThread)
+        {
+            sound->m_StreamThread = dmThread::New(StreamThread, 0x20000, sound, "sound_stream");
+        }
+#endif
+
+        *sound_data = sd;
+        return RESULT_OK;
+    }
+
+    uint32_t GetStreamingThreshold()
+    {
+        SoundSystem* sound = g_SoundSystem;
+        return sound ? sound->m_StreamingThreshold : 0;
+    }
+
+    void* GetSoundDataReadContext(HSoundData sound_data)
+    {
+        return sound_data->m_ReadContext;
+    }
+
+    static void FreeDecodedData(SoundSystem* sound, SoundData* sound_data)
+    {
+        if (sound_data->m_Decoded)
+        {
+            sound->m_Stats.m_DecodedCacheMemory -= sound_data->m_DecodedSize;
+            free(sound_data->m_Decoded);
+            sound_data->m_Decoded = 0;
+            sound_data->m_DecodedSize = 0;
+        }
+        sound_data->m_DecodedStale = 0;
+    }
+
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size)
     {
+        // Instances mixing from the old decoded data play it to the end, and new instances decode the new data
+        if (sound_data->m_DecodedUsers > 0)
+        {
+            sound_data->m_DecodedStale = sound_data->m_Decoded != 0;
+        }
+        else
+        {
+            FreeDecodedData(g_SoundSystem, sound_data);
+        }
+        sound_data->m_DecodedTooLarge = 0;
+
+        // A streaming sound becomes resident. Instances already playing it read from the new data
+        SoundSystem* sound = g_SoundSystem;
+        DM_MUTEX_SCOPED_LOCK(sound->m_StreamMutex);
+        while (sound->m_StreamReadingSoundData == sound_data)
+        {
+            dmConditionVariable::Wait(sound->m_StreamCondition, sound->m_StreamMutex);
+        }
         free(sound_data->m_Data);
         sound_data->m_Data = malloc(sound_buffer_size);
         sound_data->m_Size = sound_buffer_size;
+        sound_data->m_ReadCallback = 0;
+        sound_data->m_ReadContext = 0;
         memcpy(sound_data->m_Data, sound_buffer, sound_buffer_size);
         return RESULT_OK;
     }
 
     uint32_t GetSoundResourceSize(HSoundData sound_data)
     {
-        return sound_data->m_Size + sizeof(SoundData);
+        uint32_t data_size = sound_data->m_Data ? sound_data->m_Size : 0;
+        return data_size + sizeof(SoundData);
     }
 
-    Result DeleteSoundData(HSoundData sound_data)
+    static Result ReadSoundData(SoundData* sound_data, uint32_t offset, uint32_t size, void* buffer, uint32_t* nread)
     {
-        if (sound_data->m_Data != 0x0)
-            free((void*) sound_data->m_Data);
+        if (sound_data->m_Data)
+        {
+            uint32_t total = (uint32_t) sound_data->m_Size;
+            *nread = offset < total ? dmMath::Min(size, total - offset) : 0;
+            memcpy(buffer, (const uint8_t*) sound_data->m_Data + offset, *nread);
+            return RESULT_OK;
+        }
+        return sound_data->m_ReadCallback(sound_data->m_ReadContext, offset, size, buffer, nread);
+    }
 
+    // Adds the result of a read at the write position of the ring
+    static void CommitStreamRead(SoundInstance* instance, SoundData* sound_data, Result r, uint32_t nread)
+    {
+        StreamBuffer* sb = &instance->m_StreamBuffer;
+        if (r != RESULT_OK || nread == 0)
+        {
+            dmLogWarning("Failed to read streaming sound data (%s). Result %d", dmHashReverseSafe64(sound_data->m_NameHash), r);
+            // Treat the rest of the data as missing, which ends the stream
+            sb->m_SourceOffset = (uint32_t) sound_data->m_Size;
+            return;
+        }
+        sb->m_Count += nread;
+        sb->m_SourceOffset += nread;
+    }
+
+    // Number of bytes that can be read into the ring in one go, at its write position
+    static uint32_t GetStreamReadSize(SoundData* sound_data, StreamBuffer* sb, uint32_t* write_pos)
+    {
+        uint32_t size = (uint32_t) sound_data->m_Size;
+        if (sb->m_Count == sb->m_Capacity || sb->m_SourceOffset >= size)
+        {
+            return 0;
+        }
+        *write_pos = (sb->m_ReadPos + sb->m_Count) % sb->m_Capacity;
+        uint32_t n = dmMath::Min(sb->m_Capacity - *write_pos, sb->m_Capacity - sb->m_Count);
+        return dmMath::Min(n, size - sb->m_SourceOffset);
+    }
+
+    static void RefillStreamBuffer(SoundSystem* sound, SoundInstance* instance)
+    {
+        StreamBuffer* sb = &instance->m_StreamBuffer;
+        SoundData* sd = &sound->m_SoundData[instance->m_SoundDataIndex];
+
+        uint32_t write_pos = 0;
+        uint32_t n;
+        while ((n = GetStreamReadSize(sd, sb, &write_pos)) != 0)
+        {
+            uint32_t nread = 0;
+            Result r = ReadSoundData(sd, sb->m_SourceOffset, n, sb->m_Data + write_pos, &nread);
+            CommitStreamRead(instance, sd, r, nread);
+        }
+    }
+
+    // The ring with the least data buffered, among those less than half full
+    static SoundInstance* FindStreamBufferToRefill(SoundSystem* sound)
+    {
+        SoundInstance* found = 0;
+        uint32_t instances = sound->m_Instances.Size();
+        for (uint32_t i = 0; i < instances; ++i)
+        {
+            SoundInstance* instance = &sound->m_Instances[i];
+            StreamBuffer* sb = &instance->m_StreamBuffer;
+            // Refill when half empty, to keep the reads few and large
+            if (!sb->m_Data || sb->m_Count >= sb->m_Capacity / 2 || (found && sb->m_Count >= found->m_StreamBuffer.m_Count))
+            {
+                continue;
+            }
+            if (sb->m_SourceOffset < (uint32_t) sound->m_SoundData[instance->m_SoundDataIndex].m_Size)
+            {
+                found = instance;
+            }
+        }
+        return found;
+    }
+
+    // Fills the rings of the streaming sounds, so that the mixer never reads from the sound data itself.
+    // The lock is released while reading, and the ring is only written past its buffered data
+    static void StreamThread(void* context)
+    {
+        SoundSystem* sound = (SoundSystem*) context;
+        dmMutex::Lock(sound->m_StreamMutex);
+        SoundInstance* instance = 0;
+        while (!sound->m_StreamThreadQuit)
+        {
+            // Keep filling the same ring until it's full, before looking for another one
+            StreamBuffer* sb = instance ? &instance->m_StreamBuffer : 0;
+            SoundData* sd = 0;
+            uint32_t write_pos = 0;
+            uint32_t n = 0;
+            if (sb && sb->m_Data)
+            {
+                sd = &sound->m_SoundData[instance->m_SoundDataIndex];
+                n = GetStreamReadSize(sd, sb, &write_pos);
+            }
+            if (n == 0)
+            {
+                instance = FindStreamBufferToRefill(sound);
+                if (!instance)
+                {
+                    dmConditionVariable::Wait(sound->m_StreamCondition, sound->m_StreamMutex);
+                }
+                continue;
+            }
+
+            uint32_t offset = sb->m_SourceOffset;
+            uint32_t generation = sb->m_Generation;
+            uint8_t* dst = sb->m_Data + write_pos;
+            sound->m_StreamReadingInstance = instance;
+            sound->m_StreamReadingSoundData = sd;
+            dmMutex::Unlock(sound->m_StreamMutex);
+
+            uint32_t nread = 0;
+            Result r = ReadSoundData(sd, offset, n, dst, &nread);
+
+            dmMutex::Lock(sound->m_StreamMutex);
+            sound->m_StreamReadingInstance = 0;
+            sound->m_StreamReadingSoundData = 0;
+            if (sb->m_Generation == generation)
+            {
+                CommitStreamRead(instance, sd, r, nread);
+            }
+            dmConditionVariable::Broadcast(sound->m_StreamCondition);
+        }
+        dmMutex::Unlock(sound->m_StreamMutex);
+    }
+
+    static uint32_t StreamBufferRead(void* context, void* buffer, uint32_t size)
+    {
         SoundSystem* sound = g_SoundSystem;
+        SoundInstance* instance = (SoundInstance*) context;
+        StreamBuffer* sb = &instance->m_StreamBuffer;
+        DM_MUTEX_SCOPED_LOCK(sound->m_StreamMutex);
+
+        if (sb->m_Count == 0)
+        {
+            SoundData* sd = &sound->m_SoundData[instance->m_SoundDataIndex];
+            if (sb->m_SourceOffset >= (uint32_t) sd->m_Size)
+            {
+                return 0;
+            }
+            // The decoder consumed everything read ahead. The first fill after a rewind isn't counted
+            if (sb->m_SourceOffset != 0)
+            {
+                ++sound->m_Stats.m_StreamUnderflowCount;
+            }
+            if (sound->m_StreamThread)
+            {
+                dmConditionVariable::Broadcast(sound->m_StreamCondition);
+                while (sb->m_Count == 0 && sb->m_SourceOffset < (uint32_t) sd->m_Size)
+                {
+                    dmConditionVariable::Wait(sound->m_StreamCondition, sound->m_StreamMutex);
+                }
+            }
+            else
+            {
+                RefillStreamBuffer(sound, instance);
+            }
+        }
+
+        uint32_t n = dmMath::Min(size, sb->m_Count);
+        uint32_t first = dmMath::Min(n, sb->m_Capacity - sb->m_ReadPos);
+        memcpy(buffer, sb->m_Data + sb->m_ReadPos, first);
+        memcpy((uint8_t*) buffer + first, sb->m_Data, n - first);
+        sb->m_ReadPos = (sb->m_ReadPos + n) % sb->m_Capacity;
+        sb->m_Count -= n;
+        return n;
+    }
+
+    static void StreamBufferRewind(void* context)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        SoundInstance* instance = (SoundInstance*) context;
+        StreamBuffer* sb = &instance->m_StreamBuffer;
+        DM_MUTEX_SCOPED_LOCK(sound->m_StreamMutex);
+        sb->m_ReadPos = 0;
+        sb->m_Count = 0;
+        sb->m_SourceOffset = 0;
+        sb->m_Generation++;
+        if (sound->m_StreamThread)
+        {
+            dmConditionVariable::Broadcast(sound->m_StreamCondition);
+        }
+        else
+        {
+            RefillStreamBuffer(sound, instance);
+        }
+    }
+
+    static void FreeStreamBuffer(SoundSystem* sound, SoundInstance* instance)
+    {
+        DM_MUTEX_SCOPED_LOCK(sound->m_StreamMutex);
+        while (sound->m_StreamReadingInstance == instance)
+        {
+            dmConditionVariable::Wait(sound->m_StreamCondition, sound->m_StreamMutex);
+        }
+        free(instance->m_StreamBuffer.m_Data);
+        memset(&instance->m_StreamBuffer, 0, sizeof(instance->m_StreamBuffer));
+    }
+
+    static void RefillStreamBuffers(SoundSystem* sound)
+    {
+        DM_PROFILE(Sound, "RefillStreamBuffers")
+        if (sound->m_StreamThread)
+        {
+            // Wake the thread up to top up the rings the last mix read from
+            DM_MUTEX_SCOPED_LOCK(sound->m_StreamMutex);
+            dmConditionVariable::Broadcast(sound->m_StreamCondition);
+            return;
+        }
+
+        uint32_t instances = sound->m_Instances.Size();
+        for (uint32_t i = 0; i < instances; ++i)
+        {
+            SoundInstance* instance = &sound->m_Instances[i];
+            StreamBuffer* sb = &instance->m_StreamBuffer;
+            // Refill when half empty, to keep the reads few and large
+            if (instance->m_Playing && sb->m_Data && sb->m_Count < sb->m_Capacity / 2)
+            {
+                RefillStreamBuffer(sound, instance);
+            }
+        }
+    }
+
+    Result DeleteSoundData(HSoundData sound_data)
+    {
+        SoundSystem* sound = g_SoundSystem;
+
+        {
+            DM_MUTEX_SCOPED_LOCK(sound->m_StreamMutex);
+            while (sound->m_StreamReadingSoundData == sound_data)
+            {
+                dmConditionVariable::Wait(sound->m_StreamCondition, sound->m_StreamMutex);
+            }
+            if (sound_data->m_Data != 0x0)
+                free((void*) sound_data->m_Data);
+            sound_data->m_Data = 0;
+            sound_data->m_ReadCallback = 0;
+            sound_data->m_ReadContext = 0;
+        }
+        FreeDecodedData(sound, sound_data);
+
         sound->m_SoundDataPool.Push(sound_data->m_Index);
         sound_data->m_Index = 0xffff;
 
         return RESULT_OK;
     }
 
+    // Checks, without evicting anything, if size bytes would fit in the budget
+    static bool CanReserveDecodedCache(SoundSystem* sound, uint32_t size)
+    {
+        uint32_t used = sound->m_Stats.m_DecodedCacheMemory;
+        for (uint32_t i = 0; i < sound->m_SoundData.Size() && used + size > sound->m_DecodedCacheSize; ++i)
+        {
+            SoundData* sd = &sound->m_SoundData[i];
+            if (sd->m_Decoded && sd->m_DecodedUsers == 0)
+            {
+                used -= sd->m_DecodedSize;
+            }
+        }
+        return used + size <= sound->m_DecodedCacheSize;
+    }
+
+    static bool ReserveDecodedCache(SoundSystem* sound, uint32_t size)
+    {
+        while (sound->m_Stats.m_DecodedCacheMemory + size > sound->m_DecodedCacheSize)
+        {
+            // Evict the least recently used data no instance is mixing from
+            SoundData* lru = 0;
+            for (uint32_t i = 0; i < sound->m_SoundData.Size(); ++i)
+            {
+                SoundData* sd = &sound->m_SoundData[i];
+                if (sd->m_Decoded && sd->m_DecodedUsers == 0 && (!lru || sd->m_DecodedLastUsed < lru->m_DecodedLastUsed))
+                {
+                    lru = sd;
+                }
+            }
+            if (!lru)
+            {
+                return false;
+            }
+            FreeDecodedData(sound, lru);
+        }
+        return true;
+    }
+
+    // Decode the whole sound into the cache, if it's small enough and fits in the budget.
+    // The decoder is left at the start of the stream
+    static bool CacheDecodedData(SoundSystem* sound, SoundData* sound_data, dmSoundCodec::HDecoder decoder)
+    {
+        // Stale data is still in use, and takes the place of the new data until it's freed
+        if (sound->m_DecodedCacheSize == 0 || sound_data->m_DecodedTooLarge || sound_data->m_Decoded)
+        {
+            return false;
+        }
+        sound->m_Stats.m_DecodedCacheMisses++;
+
+        dmSoundCodec::Info info;
+        dmSoundCodec::GetInfo(sound->m_CodecContext, decoder, &info);
+        uint32_t threshold = sound->m_DecodedCacheThreshold;
+        uint32_t stride = info.m_Channels * (info.m_BitsPerSample / 8);
+        if (stride == 0 || info.m_Size > threshold)
+        {
+            sound_data->m_DecodedTooLarge = 1;
+            return false;
+        }
+
+        // Don't decode data that can't be kept, while the budget is full of data in use.
+        // The decoded size isn't known up front for all formats, so assume the largest
+        if (!CanReserveDecodedCache(sound, info.m_Size ? info.m_Size : threshold))
+        {
+            return false;
+        }
+
+        // Room for one frame more than the threshold, to tell if the sound is larger
+        uint32_t capacity = threshold - threshold % stride + stride;
+        uint8_t* decoded = (uint8_t*) malloc(capacity);
+        uint32_t size = 0;
+        dmSoundCodec::Result r = dmSoundCodec::RESULT_OK;
+        while (size < capacity)
+        {
+            uint32_t n = 0;
+            r = dmSoundCodec::Decode(sound->m_CodecContext, decoder, (char*) decoded + size, capacity - size, &n);
+            if (r != dmSoundCodec::RESULT_OK || n == 0)
+            {
+                break;
+            }
+            size += n;
+        }
+        dmSoundCodec::Reset(sound->m_CodecContext, decoder);
+
+        if (size > threshold)
+        {
+            sound_data->m_DecodedTooLarge = 1;
+        }
+
+        if (r != dmSoundCodec::RESULT_OK || size == 0 || size > threshold || !ReserveDecodedCache(sound, size))
+        {
+            free(decoded);
+            return false;
+        }
+
+        sound_data->m_Decoded = (uint8_t*) realloc(decoded, size);
+        sound_data->m_DecodedSize = size;
+        sound_data->m_DecodedInfo = info;
+        sound_data->m_DecodedLastUsed = ++sound->m_DecodedCacheClock;
+        sound->m_Stats.m_DecodedCacheMemory += size;
+        return true;
+    }
+
     Result NewSoundInstance(HSoundData sound_data, HSoundInstance* sound_instance)
     {
         SoundSystem* ss = g_SoundSystem;
@@ -479,7 +1070,7 @@ namespace dmSound
             return RESULT_OUT_OF_INSTANCES;
         }
 
-        dmSoundCodec::HDecoder decoder;
+        dmSoundCodec::HDecoder decoder = 0;
 
         dmSoundCodec::Format codec_format = dmSoundCodec::FORMAT_WAV;
         if (sound_data->m_Type == SOUND_DATA_TYPE_WAV) {
@@ -490,28 +1081,67 @@ namespace dmSound
             assert(0);
         }
 
-        dmSoundCodec::Result r = dmSoundCodec::NewDecoder(ss->m_CodecContext, codec_format, sound_data->m_Data, sound_data->m_Size, &decoder);
+        uint16_t index = ss->m_InstancesPool.Pop();
+        SoundInstance* si = &ss->m_Instances[index];
+        assert(si->m_Index == 0xffff);
+        si->m_SoundDataIndex = sound_data->m_Index;
+
+        dmSoundCodec::Result r = dmSoundCodec::RESULT_OK;
+        if (sound_data->m_Decoded && !sound_data->m_DecodedStale)
+        {
+            // Mix straight from the shared decoded data
+            ss->m_Stats.m_DecodedCacheHits++;
+            sound_data->m_DecodedLastUsed = ++ss->m_DecodedCacheClock;
+        }
+        else if (sound_data->m_Data == 0 && sound_data->m_ReadCallback != 0)
+        {
+            {
+                DM_MUTEX_SCOPED_LOCK(ss->m_StreamMutex);
+                StreamBuffer* sb = &si->m_StreamBuffer;
+                sb->m_Data = (uint8_t*) malloc(ss->m_StreamBufferSize);
+                sb->m_Capacity = ss->m_StreamBufferSize;
+            }
+            StreamBufferRewind(si);
+
+            dmSoundCodec::StreamSource source;
+            source.m_Read = StreamBufferRead;
+            source.m_Rewind = StreamBufferRewind;
+            source.m_Context = si;
+            r = dmSoundCodec::NewStreamingDecoder(ss->m_CodecContext, codec_format, &source, &decoder);
+        }
+        else
+        {
+            r = dmSoundCodec::NewDecoder(ss->m_CodecContext, codec_format, sound_data->m_Data, sound_data->m_Size, &decoder);
+            if (r == dmSoundCodec::RESULT_OK && CacheDecodedData(ss, sound_data, decoder))
+            {
+                dmSoundCodec::DeleteDecoder(ss->m_CodecContext, decoder);
+                decoder = 0;
+            }
+        }
+
         if (r != dmSoundCodec::RESULT_OK) {
             dmLogError("Failed to decode sound (%d)", r);
+            FreeStreamBuffer(ss, si);
+            si->m_SoundDataIndex = 0xffff;
+            ss->m_InstancesPool.Push(index);
             return RESULT_INVALID_STREAM_DATA;
         }
 
-        dmSoundCodec::Info info;
-        dmSoundCodec::GetInfo(ss->m_CodecContext, decoder, &info);
-
-        uint16_t index = ss->m_InstancesPool.Pop();
-        SoundInstance* si = &ss->m_Instances[index];
-        assert(si->m_Index == 0xffff);
-
-        si->m_SoundDataIndex = sound_data->m_Index;
         si->m_Index = index;
         si->m_Gain.Reset(1.0f);
         si->m_Pan.Reset(0.5f);
         si->m_Looping = 0;
         si->m_EndOfStream = 0;
         si->m_Playing = 0;
+        si->m_Virtual = 0;
+        si->m_Priority = 0;
         si->m_Decoder = decoder;
+        si->m_DecodedOffset = 0;
         si->m_Group = MASTER_GROUP_HASH;
+        if (!decoder)
+        {
+            sound_data->m_DecodedUsers++;
+        }
 
         *sound_instance = si;
 
@@ -528,9 +1158,21 @@ namespace dmSound
         }
         uint16_t index = sound_instance->m_Index;
         sound->m_InstancesPool.Push(index);
+        if (sound_instance->m_Decoder)
+        {
+            dmSoundCodec::DeleteDecoder(sound->m_CodecContext, sound_instance->m_Decoder);
+        }
+        else
+        {
+            SoundData* sd = &sound->m_SoundData[sound_instance->m_SoundDataIndex];
+            if (sd->m_DecodedUsers > 0)
+                sd->m_DecodedUsers--;
+            if (sd->m_DecodedUsers == 0 && sd->m_DecodedStale)
+                FreeDecodedData(sound, sd);
+        }
         sound_instance->m_Index = 0xffff;
+        FreeStreamBuffer(sound, sound_instance);
         sound_instance->m_SoundDataIndex = 0xffff;
-        dmSoundCodec::DeleteDecoder(sound->m_CodecContext, sound_instance->m_Decoder);
         sound_instance->m_Decoder = 0;
         sound_instance->m_FrameCount = 0;
         sound_instance->m_Speed = 1.0f;
@@ -564,6 +1206,17 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetGroupVoiceLimit(dmhash_t group_hash, uint32_t max_voices)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        int* index = sound->m_GroupMap.Get(group_hash);
+        if (!index) {
+            return RESULT_NO_SUCH_GROUP;
+        }
+        sound->m_Groups[*index].m_MaxVoices = max_voices;
+        return RESULT_OK;
+    }
+
     Result SetGroupGain(dmhash_t group_hash, float gain)
     {
         SoundSystem* sound = g_SoundSystem;
@@ -689,6 +1342,50 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    static void GetInstanceInfo(SoundSystem* sound, SoundInstance* instance, dmSoundCodec::Info* info)
+    {
+        if (instance->m_Decoder)
+        {
+            dmSoundCodec::GetInfo(sound->m_CodecContext, instance->m_Decoder, info);
+        }
+        else
+        {
+            *info = sound->m_SoundData[instance->m_SoundDataIndex].m_DecodedInfo;
+        }
+    }
+
+    // Decode, or copy from the cached decoded data. A null buffer skips the data
+    static dmSoundCodec::Result DecodeInstance(SoundSystem* sound, SoundInstance* instance, char* buffer, uint32_t buffer_size, uint32_t* decoded)
+    {
+        if (instance->m_Decoder)
+        {
+            if (buffer)
+                return dmSoundCodec::Decode(sound->m_CodecContext, instance->m_Decoder, buffer, buffer_size, decoded);
+            return dmSoundCodec::Skip(sound->m_CodecContext, instance->m_Decoder, buffer_size, decoded);
+        }
+
+        // Replaced decoded data is kept until the instance is deleted, see m_DecodedStale
+        SoundData* sd = &sound->m_SoundData[instance->m_SoundDataIndex];
+        uint32_t offset = dmMath::Min(instance->m_DecodedOffset, sd->m_DecodedSize);
+        uint32_t n = dmMath::Min(buffer_size, sd->m_DecodedSize - offset);
+        if (buffer)
+        {
+            memcpy(buffer, sd->m_Decoded + offset, n);
+        }
+        instance->m_DecodedOffset = offset + n;
+        *decoded = n;
+        return dmSoundCodec::RESULT_OK;
+    }
+
+    static void ResetInstance(SoundSystem* sound, SoundInstance* instance)
+    {
+        if (instance->m_Decoder)
+        {
+            dmSoundCodec::Reset(sound->m_CodecContext, instance->m_Decoder);
+        }
+        instance->m_DecodedOffset = 0;
+    }
+
     Result Play(HSoundInstance sound_instance)
     {
         sound_instance->m_Playing = 1;
@@ -699,7 +1396,7 @@ namespace dmSound
     {
         SoundSystem* sound = g_SoundSystem;
         sound_instance->m_Playing = 0;
-        dmSoundCodec::Reset(sound->m_CodecContext, sound_instance->m_Decoder);
+        ResetInstance(sound, sound_instance);
         return RESULT_OK;
     }
 
@@ -729,6 +1426,12 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetPriority(HSoundInstance sound_instance, uint8_t priority)
+    {
+        sound_instance->m_Priority = priority;
+        return RESULT_OK;
+    }
+
     Result SetParameter(HSoundInstance sound_instance, Parameter parameter, const Vector4& value)
     {
         bool reset = !sound_instance->m_Playing;
@@ -986,15 +1689,21 @@ namespace dmSound
         mixer(mix_context, instance, rate, mix_rate, mix_buffer, mix_buffer_count);
     }
 
-    static void Mix(const MixContext* mix_context, SoundInstance* instance, const dmSoundCodec::Info* info)
+    static uint32_t GetMixCount(SoundSystem* sound, SoundInstance* instance, const dmSoundCodec::Info* info)
     {
-        DM_PROFILE(Sound, "Mix")
-
-        SoundSystem* sound = g_SoundSystem;
         uint64_t delta = (uint32_t) ((((uint64_t) info->m_Rate) << RESAMPLE_FRACTION_BITS) / sound->m_MixRate);
         uint32_t mix_count = ((uint64_t) (instance->m_FrameCount) << RESAMPLE_FRACTION_BITS) / (delta * instance->m_Speed);
         mix_count = dmMath::Min(mix_count, sound->m_FrameCount);
         assert(mix_count <= sound->m_FrameCount);
+        return mix_count;
+    }
+
+    static void Mix(const MixContext* mix_context, SoundInstance* instance, const dmSoundCodec::Info* info)
+    {
+        DM_PROFILE(Sound, "Mix")
+
+        SoundSystem* sound = g_SoundSystem;
+        uint32_t mix_count = GetMixCount(sound, instance, info);
 
         int* index = sound->m_GroupMap.Get(instance->m_Group);
         if (index) {
@@ -1005,6 +1714,28 @@ namespace dmSound
         }
     }
 
+    // Consume the frames a virtual voice would have mixed, the same way the resamplers do
+    static void AdvanceVirtual(SoundInstance* instance, const dmSoundCodec::Info* info)
+    {
+        SoundSystem* sound = g_SoundSystem;
+        uint32_t mix_count = GetMixCount(sound, instance, info);
+
+        uint32_t consumed = mix_count;
+        if (info->m_Rate != sound->m_MixRate || instance->m_Speed != 1.0f)
+        {
+            uint64_t delta = (((uint64_t) info->m_Rate) << RESAMPLE_FRACTION_BITS) / sound->m_MixRate;
+            delta *= instance->m_Speed;
+            uint64_t frac = instance->m_FrameFraction + delta * mix_count;
+            consumed = (uint32_t) (frac >> RESAMPLE_FRACTION_BITS);
+            instance->m_FrameFraction = frac & ((1U << RESAMPLE_FRACTION_BITS) - 1U);
+        }
+        consumed = dmMath::Min(consumed, instance->m_FrameCount);
+
+        const uint32_t stride = info->m_Channels * (info->m_BitsPerSample / 8);
+        memmove(instance->m_Frames, (char*) instance->m_Frames + consumed * stride, (instance->m_FrameCount - consumed) * stride);
+        instance->m_FrameCount -= consumed;
+    }
+
     static bool IsMuted(SoundInstance* instance) {
         SoundSystem* sound = g_SoundSystem;
 
@@ -1040,7 +1771,7 @@ namespace dmSound
         uint32_t decoded = 0;
 
         dmSoundCodec::Info info;
-        dmSoundCodec::GetInfo(sound->m_CodecContext, instance->m_Decoder, &info);
+        GetInstanceInfo(sound, instance, &info);
         if (info.m_BitsPerSample == 16 && info.m_Channels > SOUND_MAX_MIX_CHANNELS ) {
             dmLogError("Only mono/stereo with 16 bits per sample is supported (%s)", GetSoundName(sound, instance));
             return;
@@ -1051,7 +1782,8 @@ namespace dmSound
             return;
         }
 
-        bool is_muted = dmSound::IsMuted(instance);
+        // Virtual voices only skip ahead, like muted ones
+        bool is_muted = instance->m_Virtual || dmSound::IsMuted(instance);
 
         dmSoundCodec::Result r = dmSoundCodec::RESULT_OK;
 
@@ -1062,15 +1794,15 @@ namespace dmSound
 
             if (!is_muted)
             {
-                r = dmSoundCodec::Decode(sound->m_CodecContext,
-                                         instance->m_Decoder,
-                                         ((char*) instance->m_Frames) + instance->m_FrameCount * stride,
-                                         n * stride,
-                                         &decoded);
+                r = DecodeInstance(sound,
+                                   instance,
+                                   ((char*) instance->m_Frames) + instance->m_FrameCount * stride,
+                                   n * stride,
+                                   &decoded);
             }
             else
             {
-                r = dmSoundCodec::Skip(sound->m_CodecContext, instance->m_Decoder, n * stride, &decoded);
+                r = DecodeInstance(sound, instance, 0, n * stride, &decoded);
                 memset(((char*) instance->m_Frames) + instance->m_FrameCount * stride, 0x00, n * stride);
             }
 
@@ -1080,20 +1812,20 @@ namespace dmSound
             if (instance->m_FrameCount < sound->m_FrameCount) {
 
                 if (instance->m_Looping) {
-                    dmSoundCodec::Reset(sound->m_CodecContext, instance->m_Decoder);
+                    ResetInstance(sound, instance);
 
                     uint32_t n = sound->m_FrameCount - instance->m_FrameCount;
                     if (!is_muted)
                     {
-                        r = dmSoundCodec::Decode(sound->m_CodecContext,
-                                                 instance->m_Decoder,
-                                                 ((char*) instance->m_Frames) + instance->m_FrameCount * stride,
-                                                 n * stride,
-                                                 &decoded);
+                        r = DecodeInstance(sound,
+                                           instance,
+                                           ((char*) instance->m_Frames) + instance->m_FrameCount * stride,
+                                           n * stride,
+                                           &decoded);
                     }
                     else
                     {
-                        r = dmSoundCodec::Skip(sound->m_CodecContext, instance->m_Decoder, n * stride, &decoded);
+                        r = DecodeInstance(sound, instance, 0, n * stride, &decoded);
                         memset(((char*) instance->m_Frames) + instance->m_FrameCount * stride, 0x00, n * stride);
                     }
 
@@ -1114,7 +1846,12 @@ namespace dmSound
         }
 
         if (instance->m_FrameCount > 0)
-            Mix(mix_context, instance, &info);
+        {
+            if (instance->m_Virtual)
+                AdvanceVirtual(instance, &info);
+            else
+                Mix(mix_context, instance, &info);
+        }
 
         if (instance->m_FrameCount <= 1 && instance->m_EndOfStream) {
             // NOTE: Due to round-off errors, e.g 32000 -> 44100,
@@ -1124,10 +1861,98 @@ namespace dmSound
         }
     }
 
+    static bool IsMoreImportant(const Voice& a, const Voice& b)
+    {
+        if (a.m_Priority != b.m_Priority)
+            return a.m_Priority > b.m_Priority;
+        if (a.m_Audibility != b.m_Audibility)
+            return a.m_Audibility > b.m_Audibility;
+        return a.m_Index < b.m_Index;
+    }
+
+    static SoundGroup* GetInstanceGroup(SoundSystem* sound, SoundInstance* instance)
+    {
+        int* index = sound->m_GroupMap.Get(instance->m_Group);
+        return index ? &sound->m_Groups[*index] : 0;
+    }
+
+    // Give the most important playing instances a voice, within the global and per group limits.
+    // The rest become virtual voices
+    static void AssignVoices(SoundSystem* sound)
+    {
+        DM_PROFILE(Sound, "AssignVoices")
+
+        bool limited = sound->m_MaxVoices > 0;
+        for (uint32_t i = 0; i < MAX_GROUPS; ++i) {
+            sound->m_Groups[i].m_VoiceCount = 0;
+            limited |= sound->m_Groups[i].m_MaxVoices > 0;
+        }
+
+        uint32_t real = 0;
+        uint32_t virtual_count = 0;
+        sound->m_Voices.SetSize(0);
+        uint32_t instances = sound->m_Instances.Size();
+        for (uint32_t i = 0; i < instances; ++i) {
+            SoundInstance* instance = &sound->m_Instances[i];
+            if (!(instance->m_Playing || instance->m_FrameCount > 0))
+                continue;
+
+            if (!limited)
+            {
+                instance->m_Virtual = 0;
+                real++;
+                continue;
+            }
+
+            SoundGroup* group = GetInstanceGroup(sound, instance);
+            Voice voice;
+            voice.m_Audibility = instance->m_Gain.m_Current * (group ? group->m_Gain.m_Current : 1.0f);
+            voice.m_Index = (uint16_t) i;
+            voice.m_Priority = instance->m_Priority;
+            sound->m_Voices.Push(voice);
+        }
+
+        if (limited)
+        {
+            std::sort(sound->m_Voices.Begin(), sound->m_Voices.End(), IsMoreImportant);
+            for (uint32_t i = 0; i < sound->m_Voices.Size(); ++i) {
+                SoundInstance* instance = &sound->m_Instances[sound->m_Voices[i].m_Index];
+                SoundGroup* group = GetInstanceGroup(sound, instance);
+
+                bool is_real = sound->m_MaxVoices == 0 || real < sound->m_MaxVoices;
+                if (group && group->m_MaxVoices > 0 && group->m_VoiceCount >= group->m_MaxVoices)
+                    is_real = false;
+
+                if (is_real)
+                {
+                    if (instance->m_Virtual)
+                    {
+                        // Fade in from silence, as when starting to play
+                        instance->m_Gain.m_Prev = 0.0f;
+                    }
+                    instance->m_Virtual = 0;
+                    if (group)
+                        group->m_VoiceCount++;
+                    real++;
+                }
+                else
+                {
+                    instance->m_Virtual = 1;
+                    virtual_count++;
+                }
+            }
+        }
+
+        sound->m_Stats.m_RealVoiceCount = real;
+        sound->m_Stats.m_VirtualVoiceCount = virtual_count;
+    }
+
     static void MixInstances(const MixContext* mix_context) {
         DM_PROFILE(Sound, "MixInstances")
         SoundSystem* sound = g_SoundSystem;
 
+        AssignVoices(sound);
+
         for (uint32_t i = 0; i < MAX_GROUPS; i++) {
             SoundGroup* g = &sound->m_Groups[i];
 
@@ -1324,6 +2149,8 @@ namespace dmSound
         if (free_slots > 0) {
             StepGroupValues();
             StepInstanceValues();
+            // Read ahead for streaming sounds, so the decoders don't have to while mixing
+            RefillStreamBuffers(sound);
         }
 
         uint32_t current_buffer = 0;
@@ -66,10 +66,28 @@ namespace dmSound
     struct Stats
     {
         uint32_t m_BufferUnderflowCount;
+        // Number of times a streaming sound ran out of buffered data, and the mixer had to wait for it to be read
+        uint32_t m_StreamUnderflowCount;
+        // Sound instances created from, and without, already decoded data
+        uint32_t m_DecodedCacheHits;
+        uint32_t m_DecodedCacheMisses;
+        // Bytes of decoded data currently cached
+        uint32_t m_DecodedCacheMemory;
+        // Playing instances that were mixed, and that only advanced, in the last update
+        uint32_t m_RealVoiceCount;
+        uint32_t m_VirtualVoiceCount;
     };
 
-    // TODO:
-    // - Music streaming.
+    /**
+     * Callback used to read the data of a streaming sound
+     * @param context the context passed to NewSoundDataStreaming
+     * @param offset byte offset into the sound data
+     * @param size number of bytes to read
+     * @param buffer buffer to read to
+     * @param nread number of bytes read
+     * @return RESULT_OK on success
+     */
+    typedef Result (*SoundDataReadCallback)(void* context, uint32_t offset, uint32_t size, void* buffer, uint32_t* nread);
 
     struct InitializeParams;
     void SetDefaultInitializeParams(InitializeParams* params);
@@ -84,6 +102,16 @@ namespace dmSound
         uint32_t m_BufferSize;
         uint32_t m_FrameCount;
         uint32_t m_MaxInstances;
+        // Sound data larger than this (in bytes) should be streamed. 0 disables streaming
+        uint32_t m_StreamingThreshold;
+        // Size of the per instance buffer of compressed data for streaming sounds
+        uint32_t m_StreamBufferSize;
+        // Total memory budget for decoded sound data shared between instances. 0 disables the cache
+        uint32_t m_DecodedCacheSize;
+        // Only sounds that decode to at most this many bytes are cached
+        uint32_t m_DecodedCacheThreshold;
+        // Max number of instances mixed at once. The rest become virtual. 0 means no limit
+        uint32_t m_MaxVoices;
 
         InitializeParams()
         {
@@ -97,6 +125,12 @@ namespace dmSound
     void   GetStats(Stats* stats);
 
     Result NewSoundData(const void* sound_buffer, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name);
+    // Sound data that isn't kept in memory. Instances read it in chunks through read_cb while playing.
+    // read_cb is called from the sound stream thread, except on web. Only ogg vorbis data can be streamed
+    Result NewSoundDataStreaming(SoundDataReadCallback read_cb, void* read_ctx, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name);
+    uint32_t GetStreamingThreshold();
+    // The read_ctx of a streaming sound, or 0 for resident sound data
+    void* GetSoundDataReadContext(HSoundData sound_data);
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size);
     uint32_t GetSoundResourceSize(HSoundData sound_data);
     Result DeleteSoundData(HSoundData sound_data);
@@ -110,6 +144,8 @@ namespace dmSound
     Result AddGroup(const char* group);
     Result SetGroupGain(dmhash_t group_hash, float gain);
     Result GetGroupGain(dmhash_t group_hash, float* gain);
+    // Max number of instances in the group mixed at once. 0 means no limit
+    Result SetGroupVoiceLimit(dmhash_t group_hash, uint32_t max_voices);
     uint32_t GetGroupCount();
     Result GetGroupHash(uint32_t index, dmhash_t* hash);
 
@@ -125,6 +161,8 @@ namespace dmSound
     uint32_t GetAndIncreasePlayCounter();
 
     Result SetLooping(HSoundInstance sound_instance, bool looping);
+    // Instances with higher priority keep their voice over more audible ones when over the voice limits. Default 0
+    Result SetPriority(HSoundInstance sound_instance, uint8_t priority);
 
     Result SetParameter(HSoundInstance sound_instance, Parameter parameter, const Vectormath::Aos::Vector4& value);
     Result GetParameter(HSoundInstance sound_instance, Parameter parameter, Vectormath::Aos::Vector4& value);
@@ -88,6 +88,32 @@ namespace dmSoundCodec
         return RESULT_OK;
     }
 
+    Result NewStreamingDecoder(HCodecContext context, Format format, const StreamSource* source, HDecoder* decoder)
+    {
+        if (context->m_DecodersPool.Remaining() == 0) {
+            return RESULT_OUT_OF_RESOURCES;
+        }
+
+        const DecoderInfo* decoderImpl = FindBestStreamingDecoder(format);
+        if (!decoderImpl) {
+            return RESULT_UNSUPPORTED;
+        }
+
+        uint16_t index = context->m_DecodersPool.Pop();
+        Decoder* d = &context->m_Decoders[index];
+        d->m_Index = index;
+        d->m_DecoderInfo = decoderImpl;
+
+        Result r = decoderImpl->m_OpenSourceStream(source, &d->m_Stream);
+        if (r != RESULT_OK) {
+            context->m_DecodersPool.Push(index);
+            return r;
+        }
+
+        *decoder = d;
+        return RESULT_OK;
+    }
+
     void GetInfo(HCodecContext context, HDecoder decoder, Info* info)
     {
         assert(decoder);
@@ -60,6 +60,30 @@ namespace dmSoundCodec
         uint8_t  m_BitsPerSample;
     };
 
+    /**
+     * Source of compressed data for decoders that stream their input
+     */
+    struct StreamSource
+    {
+        /**
+         * Read compressed data
+         * @param context source context
+         * @param buffer buffer to read to
+         * @param size max number of bytes to read
+         * @return number of bytes read. 0 at end of data
+         */
+        uint32_t (*m_Read)(void* context, void* buffer, uint32_t size);
+
+        /**
+         * Restart reading from the beginning of the data
+         * @param context source context
+         */
+        void (*m_Rewind)(void* context);
+
+        /// Source context
+        void* m_Context;
+    };
+
     /**
      * Parameters for new codec context
      */
@@ -98,6 +122,17 @@ namespace dmSoundCodec
      */
     Result NewDecoder(HCodecContext context, Format format, const void* buffer, uint32_t buffer_size, HDecoder* decoder);
 
+    /**
+     * Create a new decoder that pulls its compressed data from a source
+     * instead of from a resident buffer
+     * @param context context
+     * @param format format
+     * @param source source of compressed data. Copied
+     * @param decoder decoder (out)
+     * @return RESULT_OK on success, RESULT_UNSUPPORTED if no decoder can stream the format
+     */
+    Result NewStreamingDecoder(HCodecContext context, Format format, const StreamSource* source, HDecoder* decoder);
+
     /**
      * Delete decoder
      * @param context context
@@ -72,4 +72,26 @@ namespace dmSoundCodec
         assert(best != 0);
         return best;
     }
+
+    const DecoderInfo* FindBestStreamingDecoder(Format format)
+    {
+        int highest_score;
+        const DecoderInfo *best = 0;
+        const DecoderInfo *decoder = g_FirstDecoder;
+
+        while (decoder)
+        {
+            if (decoder->m_Format == format && decoder->m_OpenSourceStream != 0)
+            {
+                if (!best || decoder->m_Score > highest_score)
+                {
+                    highest_score = decoder->m_Score;
+                    best = decoder;
+                }
+            }
+            decoder = decoder->m_Next;
+        }
+
+        return best;
+    }
 }
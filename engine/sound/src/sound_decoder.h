@@ -75,6 +75,11 @@ namespace dmSoundCodec
          */
         void (*m_GetStreamInfo)(HDecodeStream, struct Info* out);
 
+        /**
+         * Open a stream reading compressed data from a source. Optional
+         */
+        Result (*m_OpenSourceStream)(const StreamSource* source, HDecodeStream* out);
+
         DecoderInfo *m_Next;
     };
 
@@ -88,6 +93,12 @@ namespace dmSoundCodec
      */
     const DecoderInfo* FindBestDecoder(Format format);
 
+    /**
+     * Finds the best match for a stream among all registered decoders able to stream from a source.
+     * Returns 0 if there is none.
+     */
+    const DecoderInfo* FindBestStreamingDecoder(Format format);
+
     /**
      * Get by name of implementation
      */
@@ -130,6 +141,24 @@ namespace dmSoundCodec
                     getinfo, \
             };\
         DM_REGISTER_SOUND_DECODER(symbol, DM_SOUND_PASTE2(symbol, __LINE__))
+
+    /**
+     * Declare a new stream decoder that can also read its data from a StreamSource
+     */
+    #define DM_DECLARE_SOUND_STREAMING_DECODER(symbol, name, format, score, open, close, decode, reset, skip, getinfo, open_source) \
+            dmSoundCodec::DecoderInfo DM_SOUND_PASTE2(symbol, __LINE__) = { \
+                    name, \
+                    format, \
+                    score, \
+                    open, \
+                    close, \
+                    decode, \
+                    reset, \
+                    skip, \
+                    getinfo, \
+                    open_source, \
+            };\
+        DM_REGISTER_SOUND_DECODER(symbol, DM_SOUND_PASTE2(symbol, __LINE__))
 }
 
 #endif
@@ -69,6 +69,22 @@ namespace dmSound
         return result;
     }
 
+    Result NewSoundDataStreaming(SoundDataReadCallback read_cb, void* read_ctx, uint32_t sound_buffer_size, SoundDataType type, HSoundData* sound_data, dmhash_t name)
+    {
+        *sound_data = 0;
+        return RESULT_UNSUPPORTED;
+    }
+
+    uint32_t GetStreamingThreshold()
+    {
+        return 0;
+    }
+
+    void* GetSoundDataReadContext(HSoundData sound_data)
+    {
+        return 0;
+    }
+
     Result SetSoundData(HSoundData sound_data, const void* sound_buffer, uint32_t sound_buffer_size)
     {
         if (sound_data->m_Buffer != 0x0)
@@ -157,6 +173,13 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetGroupVoiceLimit(dmhash_t group_hash, uint32_t max_voices)
+    {
+        // NOTE: Not supported.
+        // sound_null is deprecated and should be replaced by sound2 with null-device
+        return RESULT_OK;
+    }
+
     uint32_t GetGroupCount()
     {
         // NOTE: Not supported.
@@ -220,6 +243,11 @@ namespace dmSound
         return RESULT_OK;
     }
 
+    Result SetPriority(HSoundInstance sound_instance, uint8_t priority)
+    {
+        return RESULT_OK;
+    }
+
     Result SetParameter(HSoundInstance sound_instance, Parameter parameter, const Vector4& value)
     {
         sound_instance->m_Parameters[parameter] = value;
@@ -4713,7 +4713,9 @@ static int vorbis_seek_frame_from_page(stb_vorbis *f, uint32 page_start, uint32
    // of the first frame that doesn't overlap either of the other frames.
    // so, if we have to handle that case for the first frame, we might
    // as well handle it for all of them, so:
-   if (target_sample > frame_start + (left_end - left_start)) {
+   // the first frame of the page can't be decoded either, so start after its
+   // overlap, at most half a block after the target
+   if (target_sample > frame_start + (left_end - left_start) || frame == 0) {
       // so what we want to do is go ahead and just immediately decode
       // this frame, but then make it so the next get_frame_float() uses
       // this already-decoded data? or do we want to go ahead and rewind,
@@ -4725,7 +4727,6 @@ static int vorbis_seek_frame_from_page(stb_vorbis *f, uint32 page_start, uint32
       // (which means frame-2+1 total frames) then decode frame-1,
       // then leave frame pending
       frames_to_skip = frame - 1;
-      assert(frames_to_skip >= 0);
       data_to_skip = -1;
    }
 
@@ -4753,10 +4754,9 @@ static int vorbis_seek_frame_from_page(stb_vorbis *f, uint32 page_start, uint32
    // at this point, the NEXT decoded frame will generate the desired sample
    if (fine) {
       // so if we're doing sample accurate streaming, we want to go ahead and decode it!
-      if (target_sample != frame_start) {
+      if (target_sample > frame_start) {
          int n;
          stb_vorbis_get_frame_float(f, &n, NULL);
-         assert(target_sample > frame_start);
          assert(f->channel_buffer_start + (int) (target_sample-frame_start) < f->channel_buffer_end);
          f->channel_buffer_start += (target_sample - frame_start);
       }
@@ -13,6 +13,7 @@
 #define JC_TEST_IMPLEMENTATION
 #include <jc_test/jc_test.h>
 #include <dlib/image.h>
+#include <dlib/time.h>
 #include <dlib/webp.h>
 #include <string.h> // memcmp
 
@@ -482,6 +483,120 @@ TEST_F(TexcTest, TranscodeWebEncodedTextureFormat)
     TranscodeWebEncodedFormat(dmTexc::PF_R4G4B4A4, dmWebP::TEXTURE_ENCODE_FORMAT_RGBA4444);
 }
 
+static uint8_t* GetTextureData(dmTexc::HTexture texture, uint32_t* out_size)
+{
+    *out_size = dmTexc::GetTotalDataSize(texture);
+    uint8_t* data = new uint8_t[*out_size];
+    dmTexc::GetData(texture, data, *out_size);
+    return data;
+}
+
+static void TranscodeBatchEqual(dmTexc::PixelFormat pixel_format, dmTexc::CompressionType compression_type, uint32_t max_threads)
+{
+    // Large enough for the ETC1 mip maps to be split into strips, and a few small ones
+    const uint32_t sizes[] = {1024, 64, 128, 32};
+    const uint32_t count = sizeof(sizes) / sizeof(sizes[0]);
+    dmTexc::HTexture expected[count];
+    dmTexc::HTexture actual[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        expected[i] = CreateDefaultRGBA32(sizes[i], sizes[i]);
+        actual[i] = CreateDefaultRGBA32(sizes[i], sizes[i]);
+        ASSERT_TRUE(dmTexc::GenMipMaps(expected[i]));
+        ASSERT_TRUE(dmTexc::GenMipMaps(actual[i]));
+        ASSERT_TRUE(dmTexc::Transcode(expected[i], pixel_format, dmTexc::CS_SRGB, dmTexc::CL_FAST, compression_type, dmTexc::DT_DEFAULT));
+    }
+
+    ASSERT_TRUE(dmTexc::TranscodeBatch(actual, count, pixel_format, dmTexc::CS_SRGB, dmTexc::CL_FAST, compression_type, dmTexc::DT_DEFAULT, max_threads));
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmTexc::Header expected_header;
+        dmTexc::Header actual_header;
+        dmTexc::GetHeader(expected[i], &expected_header);
+        dmTexc::GetHeader(actual[i], &actual_header);
+        // The whole header, the split textures get a new header that must match the one Transcode produces
+        ASSERT_EQ(expected_header.m_Version, actual_header.m_Version);
+        ASSERT_EQ(expected_header.m_Flags, actual_header.m_Flags);
+        ASSERT_EQ(expected_header.m_PixelFormat, actual_header.m_PixelFormat);
+        ASSERT_EQ(expected_header.m_ColourSpace, actual_header.m_ColourSpace);
+        ASSERT_EQ(expected_header.m_ChannelType, actual_header.m_ChannelType);
+        ASSERT_EQ(expected_header.m_Height, actual_header.m_Height);
+        ASSERT_EQ(expected_header.m_Width, actual_header.m_Width);
+        ASSERT_EQ(expected_header.m_Depth, actual_header.m_Depth);
+        ASSERT_EQ(expected_header.m_NumSurfaces, actual_header.m_NumSurfaces);
+        ASSERT_EQ(expected_header.m_NumFaces, actual_header.m_NumFaces);
+        ASSERT_EQ(expected_header.m_MipMapCount, actual_header.m_MipMapCount);
+        ASSERT_EQ(expected_header.m_MetaDataSize, actual_header.m_MetaDataSize);
+        ASSERT_EQ(dmTexc::GetCompressionFlags(expected[i]), dmTexc::GetCompressionFlags(actual[i]));
+        for (uint32_t mip_map = 0; mip_map < expected_header.m_MipMapCount; ++mip_map)
+        {
+            ASSERT_EQ(dmTexc::GetDataSizeCompressed(expected[i], mip_map), dmTexc::GetDataSizeCompressed(actual[i], mip_map));
+        }
+
+        uint32_t expected_size;
+        uint32_t actual_size;
+        uint8_t* expected_data = GetTextureData(expected[i], &expected_size);
+        uint8_t* actual_data = GetTextureData(actual[i], &actual_size);
+        ASSERT_EQ(expected_size, actual_size);
+        ASSERT_EQ(0, memcmp(expected_data, actual_data, expected_size));
+        delete[] expected_data;
+        delete[] actual_data;
+
+        dmTexc::Destroy(expected[i]);
+        dmTexc::Destroy(actual[i]);
+    }
+}
+
+TEST_F(TexcTest, TranscodeBatch)
+{
+    const uint32_t max_threads[] = {1, 4};
+    for (uint32_t i = 0; i < sizeof(max_threads) / sizeof(max_threads[0]); ++i)
+    {
+        TranscodeBatchEqual(dmTexc::PF_RGB_ETC1, dmTexc::CT_DEFAULT, max_threads[i]);
+        TranscodeBatchEqual(dmTexc::PF_RGB_ETC1, dmTexc::CT_WEBP, max_threads[i]);
+        TranscodeBatchEqual(dmTexc::PF_RGBA_PVRTC_4BPPV1, dmTexc::CT_DEFAULT, max_threads[i]);
+        TranscodeBatchEqual(dmTexc::PF_R8G8B8A8, dmTexc::CT_WEBP, max_threads[i]);
+        TranscodeBatchEqual(dmTexc::PF_R4G4B4A4, dmTexc::CT_WEBP_LOSSY, max_threads[i]);
+    }
+}
+
+static void BenchTranscodeBatch(const char* name, dmTexc::PixelFormat pixel_format, dmTexc::CompressionType compression_type, uint32_t max_threads)
+{
+    const uint32_t count = 16;
+    const uint32_t size = 512;
+    dmTexc::HTexture textures[count];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        textures[i] = CreateDefaultRGBA32(size, size);
+        dmTexc::GenMipMaps(textures[i]);
+    }
+
+    uint64_t start = dmTime::GetTime();
+    ASSERT_TRUE(dmTexc::TranscodeBatch(textures, count, pixel_format, dmTexc::CS_SRGB, dmTexc::CL_FAST, compression_type, dmTexc::DT_DEFAULT, max_threads));
+    uint64_t end = dmTime::GetTime();
+
+    // Only the top mip maps are counted
+    float megapixels = (count * size * size) / 1000000.0f;
+    float seconds = (end - start) / 1000000.0f;
+    printf("%s (max threads %u): %.2f megapixels in %.2f ms, %.2f megapixels/s\n", name, max_threads, megapixels, seconds * 1000.0f, megapixels / seconds);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        dmTexc::Destroy(textures[i]);
+    }
+}
+
+TEST_F(TexcTest, BenchTranscodeBatch)
+{
+    const uint32_t max_threads[] = {1, 0};
+    for (uint32_t i = 0; i < sizeof(max_threads) / sizeof(max_threads[0]); ++i)
+    {
+        BenchTranscodeBatch("ETC1", dmTexc::PF_RGB_ETC1, dmTexc::CT_DEFAULT, max_threads[i]);
+        BenchTranscodeBatch("RGBA8888 WebP", dmTexc::PF_R8G8B8A8, dmTexc::CT_WEBP, max_threads[i]);
+    }
+}
+
 int main(int argc, char **argv)
 {
     jc_test_init(&argc, argv);
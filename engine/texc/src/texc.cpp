@@ -14,7 +14,9 @@
 #include "texc_private.h"
 
 #include <assert.h>
+#include <string.h>
 
+#include <dlib/job_system.h>
 #include <dlib/log.h>
 #include <dlib/math.h>
 
@@ -277,6 +279,18 @@ namespace dmTexc
         return pvrtexture::Flip(*t->m_PVRTexture, ConvertFlipAxis(flip_axis));
     }
 
+    static void ClearCompressedMips(Texture* t)
+    {
+        if(!t->m_CompressedMips.Empty())
+        {
+            for(size_t i = 0; i < t->m_CompressedMips.Size(); ++i)
+            {
+                delete[] t->m_CompressedMips[i].m_Data;
+            }
+            t->m_CompressedMips.SetSize(0);
+        }
+    }
+
     bool Transcode(HTexture texture, PixelFormat pixel_format, ColorSpace color_space, CompressionLevel compression_level, CompressionType compression_type, DitherType dither_type)
     {
         Texture* t = (Texture*) texture;
@@ -290,14 +304,7 @@ namespace dmTexc
             return false;
         }
 
-        if(!t->m_CompressedMips.Empty())
-        {
-            for(size_t i = 0; i < t->m_CompressedMips.Size(); ++i)
-            {
-                delete[] t->m_CompressedMips[i].m_Data;
-            }
-            t->m_CompressedMips.SetSize(0);
-        }
+        ClearCompressedMips(t);
 
         switch(compression_type)
         {
@@ -315,6 +322,246 @@ namespace dmTexc
         return true;
     }
 
+    void RunBatchJobs(dmJobSystem::HContext job_system, dmJobSystem::JobFunction function, void* context, void* items, uint32_t item_size, uint32_t item_count)
+    {
+        uint8_t* item = (uint8_t*) items;
+        if (job_system == 0)
+        {
+            for (uint32_t i = 0; i < item_count; ++i)
+            {
+                function(context, item + i * item_size);
+            }
+            return;
+        }
+
+        for (uint32_t first = 0; first < item_count; first += MAX_BATCH_JOBS)
+        {
+            uint32_t last = dmMath::Min(first + MAX_BATCH_JOBS, item_count);
+            dmJobSystem::HJob parent = dmJobSystem::CreateJob(job_system, 0, 0, 0, dmJobSystem::INVALID_JOB, 0, "TexcBatch");
+            for (uint32_t i = first; i < last; ++i)
+            {
+                dmJobSystem::HJob job = dmJobSystem::INVALID_JOB;
+                if (parent != dmJobSystem::INVALID_JOB)
+                {
+                    job = dmJobSystem::CreateJob(job_system, function, context, item + i * item_size, parent, 0, "TexcJob");
+                }
+                if (job != dmJobSystem::INVALID_JOB)
+                {
+                    dmJobSystem::Run(job_system, job);
+                }
+                else
+                {
+                    function(context, item + i * item_size);
+                }
+            }
+            if (parent != dmJobSystem::INVALID_JOB)
+            {
+                dmJobSystem::Run(job_system, parent);
+                dmJobSystem::Wait(job_system, parent);
+            }
+        }
+    }
+
+    /*
+     * A unit of work in TranscodeBatch. Either a whole texture, or a strip of rows of a mip map
+     * that is transcoded on its own and copied into m_Target.
+     */
+    struct TranscodeItem
+    {
+        Texture*                    m_Texture;
+        pvrtexture::CPVRTexture*    m_Target;
+        uint32_t                    m_MipMap;
+        uint32_t                    m_Row;
+        uint32_t                    m_RowCount;
+        uint32_t                    m_Offset;
+        bool                        m_Ok;
+    };
+
+    struct TranscodeBatchContext
+    {
+        pvrtexture::PixelType               m_PixelType;
+        EPVRTColourSpace                    m_ColorSpace;
+        pvrtexture::ECompressorQuality      m_Quality;
+        bool                                m_Dither;
+    };
+
+    // Byte size of an ETC1 image, 8 bytes per 4x4 block
+    static uint32_t GetETC1DataSize(uint32_t width, uint32_t height)
+    {
+        return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+    }
+
+    // The ETC1 blocks are encoded independently of each other, so a mip map can be split into strips
+    // of whole blocks that are transcoded separately with the same result as transcoding the whole mip map
+    static bool CanSplit(pvrtexture::CPVRTexture* pt, PixelFormat pixel_format)
+    {
+        if (pixel_format != PF_RGB_ETC1)
+            return false;
+        // The source must be uncompressed (the upper 32 bits of the pixel type is the channel layout) and byte aligned
+        if ((pt->getPixelType().PixelTypeID >> 32) == 0 || (pt->getBitsPerPixel() & 7) != 0)
+            return false;
+        return pt->getWidth() * pt->getHeight() >= SPLIT_PIXELCOUNT_THRESHOLD && pt->getNumFaces() == 1 && pt->getNumArrayMembers() == 1 && pt->getDepth() == 1;
+    }
+
+    static void TranscodeItemJob(void* _context, void* data)
+    {
+        TranscodeBatchContext* context = (TranscodeBatchContext*) _context;
+        TranscodeItem* item = (TranscodeItem*) data;
+        pvrtexture::CPVRTexture* pt = item->m_Texture->m_PVRTexture;
+
+        if (item->m_Target == 0)
+        {
+            item->m_Ok = pvrtexture::Transcode(*pt, context->m_PixelType, ePVRTVarTypeUnsignedByteNorm, context->m_ColorSpace, context->m_Quality, context->m_Dither);
+            return;
+        }
+
+        uint32_t width = pt->getWidth(item->m_MipMap);
+        uint32_t row_size = width * (pt->getBitsPerPixel() >> 3);
+        uint8_t* rows = (uint8_t*) pt->getDataPtr(item->m_MipMap) + item->m_Row * row_size;
+
+        pvrtexture::CPVRTextureHeader header(pt->getPixelType().PixelTypeID, item->m_RowCount, width, 1, 1, 1, 1,
+                                             pt->getColourSpace(), pt->getChannelType(), pt->isPreMultiplied());
+        pvrtexture::CPVRTexture strip(header, rows);
+        item->m_Ok = pvrtexture::Transcode(strip, context->m_PixelType, ePVRTVarTypeUnsignedByteNorm, context->m_ColorSpace, context->m_Quality, context->m_Dither);
+        if (item->m_Ok)
+        {
+            uint32_t size = strip.getDataSize(0);
+            assert(size == GetETC1DataSize(width, item->m_RowCount));
+            memcpy((uint8_t*) item->m_Target->getDataPtr(item->m_MipMap) + item->m_Offset, strip.getDataPtr(0), size);
+        }
+    }
+
+    bool TranscodeBatch(HTexture* textures, uint32_t texture_count, PixelFormat pixel_format, ColorSpace color_space, CompressionLevel compression_level, CompressionType compression_type, DitherType dither_type, uint32_t max_threads)
+    {
+        dmJobSystem::NewContextParams job_system_params;
+        if (max_threads > 0)
+        {
+            job_system_params.m_WorkerCount = max_threads - 1;
+        }
+        job_system_params.m_MaxJobs = MAX_BATCH_JOBS + 1;
+        dmJobSystem::HContext job_system = dmJobSystem::New(job_system_params);
+
+        TranscodeBatchContext context;
+        context.m_PixelType = ConvertPixelFormat(pixel_format);
+        context.m_ColorSpace = ConvertColorSpace(color_space);
+        context.m_Quality = ConvertCompressionLevel(compression_level);
+        context.m_Dither = dither_type == DT_DEFAULT;
+
+        // Textures that are split get a target texture that the strips are transcoded into
+        dmArray<pvrtexture::CPVRTexture*> targets;
+        targets.SetCapacity(texture_count);
+        targets.SetSize(texture_count);
+
+        dmArray<TranscodeItem> items;
+        items.SetCapacity(texture_count);
+        for (uint32_t i = 0; i < texture_count; ++i)
+        {
+            Texture* t = (Texture*) textures[i];
+            pvrtexture::CPVRTexture* pt = t->m_PVRTexture;
+            targets[i] = 0;
+
+            TranscodeItem item;
+            memset(&item, 0, sizeof(item));
+            item.m_Texture = t;
+
+            if (!CanSplit(pt, pixel_format))
+            {
+                if (items.Full())
+                    items.OffsetCapacity(64);
+                items.Push(item);
+                continue;
+            }
+
+            // Copy the whole source header (incl. meta data such as the orientation) and change what Transcode would change
+            uint32_t mip_maps = pt->getNumMIPLevels();
+            pvrtexture::CPVRTextureHeader header(pt->getHeader());
+            header.setPixelFormat(context.m_PixelType);
+            header.setChannelType(ePVRTVarTypeUnsignedByteNorm);
+            header.setColourSpace(context.m_ColorSpace);
+            targets[i] = new pvrtexture::CPVRTexture(header, 0);
+            item.m_Target = targets[i];
+
+            for (uint32_t mip_map = 0; mip_map < mip_maps; ++mip_map)
+            {
+                uint32_t width = pt->getWidth(mip_map);
+                uint32_t height = pt->getHeight(mip_map);
+                uint32_t strip_height = width * height >= SPLIT_PIXELCOUNT_THRESHOLD ? SPLIT_STRIP_HEIGHT : height;
+                item.m_MipMap = mip_map;
+                for (uint32_t row = 0; row < height; row += strip_height)
+                {
+                    item.m_Row = row;
+                    item.m_RowCount = dmMath::Min(strip_height, height - row);
+                    item.m_Offset = GetETC1DataSize(width, row);
+                    if (items.Full())
+                        items.OffsetCapacity(64);
+                    items.Push(item);
+                }
+            }
+        }
+
+        RunBatchJobs(job_system, TranscodeItemJob, &context, items.Begin(), sizeof(TranscodeItem), items.Size());
+
+        bool* results = new bool[texture_count];
+        for (uint32_t i = 0; i < texture_count; ++i)
+        {
+            results[i] = true;
+        }
+        uint32_t item_index = 0;
+        for (uint32_t i = 0; i < texture_count; ++i)
+        {
+            Texture* t = (Texture*) textures[i];
+            for (; item_index < items.Size() && items[item_index].m_Texture == t; ++item_index)
+            {
+                results[i] &= items[item_index].m_Ok;
+            }
+
+            if (!results[i])
+            {
+                dmLogError("Failed to transcode texture %u", i);
+                delete targets[i];
+                continue;
+            }
+
+            if (targets[i])
+            {
+                delete t->m_PVRTexture;
+                t->m_PVRTexture = targets[i];
+            }
+            ClearCompressedMips(t);
+        }
+
+        bool result = true;
+        if (compression_type == CT_WEBP || compression_type == CT_WEBP_LOSSY)
+        {
+            // Compress the successfully transcoded textures
+            dmArray<HTexture> webp_textures;
+            webp_textures.SetCapacity(texture_count);
+            for (uint32_t i = 0; i < texture_count; ++i)
+            {
+                if (results[i])
+                    webp_textures.Push(textures[i]);
+                else
+                    result = false;
+            }
+            if (!webp_textures.Empty() && !CompressWebPBatch(webp_textures.Begin(), webp_textures.Size(), pixel_format, color_space, compression_level, compression_type, job_system, 0))
+            {
+                dmLogError("Failed to compress texture with WebP compression");
+                result = false;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < texture_count; ++i)
+            {
+                result &= results[i];
+            }
+        }
+
+        delete [] results;
+        dmJobSystem::Delete(job_system);
+        return result;
+    }
+
 #define DM_TEXC_TRAMPOLINE1(ret, name, t1) \
     ret TEXC_##name(t1 a1)\
     {\
@@ -370,6 +617,7 @@ namespace dmTexc
     DM_TEXC_TRAMPOLINE1(bool, GenMipMaps, HTexture);
     DM_TEXC_TRAMPOLINE2(bool, Flip, HTexture, FlipAxis);
     DM_TEXC_TRAMPOLINE6(bool, Transcode, HTexture, PixelFormat, ColorSpace, CompressionLevel, CompressionType, DitherType);
+    DM_TEXC_TRAMPOLINE8(bool, TranscodeBatch, HTexture*, uint32_t, PixelFormat, ColorSpace, CompressionLevel, CompressionType, DitherType, uint32_t);
     DM_TEXC_TRAMPOLINE8(HBuffer, CompressWebPBuffer, uint32_t, uint32_t, uint32_t, void*, uint32_t, PixelFormat, CompressionLevel, CompressionType);
     DM_TEXC_TRAMPOLINE1(uint32_t, GetTotalBufferDataSize, HBuffer);
     DM_TEXC_TRAMPOLINE3(uint32_t, GetBufferData, HBuffer, void*, uint32_t);
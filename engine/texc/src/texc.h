@@ -183,6 +183,16 @@ namespace dmTexc
      * Transcode a texture into another format.
      */
     DM_TEXC_PROTO(bool, Transcode, HTexture texture, PixelFormat pixelFormat, ColorSpace color_space, CompressionLevel compressionLevel, CompressionType compression_type, DitherType dither_type);
+    /**
+     * Transcode a batch of textures into another format.
+     * The textures, their mip maps and, for block compressed formats where the blocks are encoded
+     * independently (ETC1), horizontal strips of large mip maps are transcoded and compressed concurrently.
+     * The result is identical to calling Transcode on each texture.
+     * Returns false if any of the textures failed, in which case that texture is left in an undefined state.
+     * max_threads is the max number of threads to use, including the calling thread.
+     * 0 uses one thread per cpu core, at most 9 (8 workers and the calling thread).
+     */
+    DM_TEXC_PROTO(bool, TranscodeBatch, HTexture* textures, uint32_t texture_count, PixelFormat pixelFormat, ColorSpace color_space, CompressionLevel compressionLevel, CompressionType compression_type, DitherType dither_type, uint32_t max_threads);
 
     // Compresses an image buffer
     DM_TEXC_PROTO(HBuffer, CompressWebPBuffer, uint32_t width, uint32_t height, uint32_t bpp, void* data, uint32_t size, PixelFormat pixelFormat, CompressionLevel compressionLevel, CompressionType compression_type);
@@ -14,6 +14,7 @@
 #define DM_TEXC_PRIVATE_H
 
 #include <dlib/array.h>
+#include <dlib/job_system.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <PVRTexture.h>
@@ -25,6 +26,9 @@
 namespace dmTexc
 {
     static const uint32_t COMPRESSION_ENABLED_PIXELCOUNT_THRESHOLD = 64; // do not compress mips with less than this pixelcount
+    static const uint32_t SPLIT_PIXELCOUNT_THRESHOLD = 512 * 512;        // split mips with at least this pixelcount into strips when transcoding in batch
+    static const uint32_t SPLIT_STRIP_HEIGHT = 128;                       // rows per strip, must be a multiple of the block height
+    static const uint32_t MAX_BATCH_JOBS = 4096;                          // max jobs in flight when processing a batch
 
     struct TextureData
     {
@@ -41,7 +45,15 @@ namespace dmTexc
     };
 
 
+    /**
+     * Calls function(context, &items[i]) for each item. The items are run on the job system if there is one,
+     * otherwise one by one on the calling thread.
+     */
+    void RunBatchJobs(dmJobSystem::HContext job_system, dmJobSystem::JobFunction function, void* context, void* items, uint32_t item_size, uint32_t item_count);
+
     bool CompressWebP(HTexture texture, PixelFormat pixel_format, ColorSpace color_space, CompressionLevel compression_level, CompressionType compression_type);
+    // Compresses all mip maps of all textures, the result per texture is stored in out_results. Returns false if any texture failed.
+    bool CompressWebPBatch(HTexture* textures, uint32_t texture_count, PixelFormat pixel_format, ColorSpace color_space, CompressionLevel compression_level, CompressionType compression_type, dmJobSystem::HContext job_system, bool* out_results);
     HBuffer CompressWebPBuffer(uint32_t width, uint32_t height, uint32_t bpp, void* data, uint32_t size, PixelFormat pixel_format, CompressionLevel compression_level, CompressionType compression_type);
 
     void PVRTCDecomposeBlocks(const uint64_t* data, const uint32_t width, const uint32_t height, uint32_t* color_a_rgba, uint32_t* color_b_rgba, uint32_t* modulation);
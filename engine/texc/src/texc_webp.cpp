@@ -257,17 +257,11 @@ namespace dmTexc
     }
 
 
-    bool CompressWebP(HTexture texture, PixelFormat pixel_format, ColorSpace color_space, CompressionLevel compression_level, CompressionType compression_type)
+    // Sets up the compressor config from the options and updates the compression flags of the texture
+    static bool InitWebPConfig(Texture* t, CompressionLevel compression_level, CompressionType compression_type, WebPConfig* config)
     {
-        Texture* t = (Texture*) texture;
-        assert(t->m_CompressedMips.Empty());
-        assert(compression_type == dmTexc::CT_WEBP || compression_type == dmTexc::CT_WEBP_LOSSY);
         t->m_CompressionFlags = 0;
-
         pvrtexture::CPVRTexture* pt = (pvrtexture::CPVRTexture*)t->m_PVRTexture;
-        uint32_t mip_maps = t->m_PVRTexture->getNumMIPLevels();
-        uint32_t mip_map = 0;
-        uint32_t bits_per_pixel = pt->getBitsPerPixel();
 
         // validate dimensions
         if((pt->getWidth() > WEBP_MAX_DIMENSION) || (pt->getHeight() > WEBP_MAX_DIMENSION))
@@ -276,79 +270,177 @@ namespace dmTexc
             return false;
         }
 
-        // setup compressor config from options
-        WebPConfig config;
         if(compression_type == dmTexc::CT_WEBP)
         {
             uint32_t quality_lut[CL_ENUM] = {3,6,9,9};
-            WebPConfigInit(&config);
-            WebPConfigLosslessPreset(&config, quality_lut[compression_level]);
+            WebPConfigInit(config);
+            WebPConfigLosslessPreset(config, quality_lut[compression_level]);
             // Disabling exact mode will allow for the RGB values to be modified, which can give better results. This however have a run-time penalty in that it needs to be cleaned up after decoding
             // by setting RGB to zero (if not zero), when alpha is zero. Only affect alpha enabled formats and is only relevant if alpha is premultiplied.
             if(pt->isPreMultiplied())
             {
-                config.exact = (compression_level == CL_BEST) ? 0 : 1;
-                t->m_CompressionFlags |= config.exact == 0 ? dmTexc::CF_ALPHA_CLEAN : 0;
+                config->exact = (compression_level == CL_BEST) ? 0 : 1;
+                t->m_CompressionFlags |= config->exact == 0 ? dmTexc::CF_ALPHA_CLEAN : 0;
             }
         }
         else
         {
             if(compression_level == CL_BEST)
             {
-                WebPConfigInit(&config);
-                WebPConfigLosslessPreset(&config, 9);
-                config.near_lossless = 50;
+                WebPConfigInit(config);
+                WebPConfigLosslessPreset(config, 9);
+                config->near_lossless = 50;
             }
             else
             {
                 float quality_lut[CL_ENUM] = {50,75,90};
-                WebPConfigPreset(&config, WEBP_PRESET_DEFAULT, quality_lut[compression_level]);
+                WebPConfigPreset(config, WEBP_PRESET_DEFAULT, quality_lut[compression_level]);
             }
             if(pt->isPreMultiplied())
             {
-                t->m_CompressionFlags |= config.exact == 0 ? dmTexc::CF_ALPHA_CLEAN : 0;
+                t->m_CompressionFlags |= config->exact == 0 ? dmTexc::CF_ALPHA_CLEAN : 0;
             }
         }
+        return true;
+    }
 
-        for(; mip_map < mip_maps; ++mip_map)
-        {
-            uint32_t mip_width = pt->getWidth(mip_map);
-            uint32_t mip_height = pt->getHeight(mip_map);
+    struct WebPTexture
+    {
+        Texture*    m_Texture;
+        WebPConfig  m_Config;
+        // Index of the first mip map in the job array, and the number of mip maps to compress
+        uint32_t    m_FirstMipJob;
+        uint32_t    m_MipMapCount;
+        bool        m_Valid;
+    };
+
+    struct WebPMipJob
+    {
+        WebPTexture*    m_WebPTexture;
+        uint32_t        m_MipMap;
+        TextureData     m_Result;
+        bool            m_Ok;
+    };
+
+    struct WebPBatchContext
+    {
+        PixelFormat         m_PixelFormat;
+        CompressionLevel    m_CompressionLevel;
+        CompressionType     m_CompressionType;
+    };
+
+    static void CompressWebPMipJob(void* _context, void* data)
+    {
+        WebPBatchContext* context = (WebPBatchContext*) _context;
+        WebPMipJob* job = (WebPMipJob*) data;
+        pvrtexture::CPVRTexture* pt = job->m_WebPTexture->m_Texture->m_PVRTexture;
+        uint32_t mip_map = job->m_MipMap;
+
+        // The compression may alter the config depending on the format, so each mip map gets its own copy
+        WebPConfig config = job->m_WebPTexture->m_Config;
+        uint32_t outsize;
+        job->m_Result.m_Data = 0;
+        job->m_Result.m_IsCompressed = 1;
+        job->m_Ok = CompressWebPInternal(&config, pt->getWidth(mip_map), pt->getHeight(mip_map), pt->getBitsPerPixel(),
+                                         (uint8_t*) pt->getDataPtr(mip_map), pt->getDataSize(mip_map), &job->m_Result.m_Data, &outsize,
+                                         context->m_PixelFormat, context->m_CompressionLevel, context->m_CompressionType);
+        job->m_Result.m_ByteSize = job->m_Ok ? outsize : 0;
+    }
+
+    bool CompressWebPBatch(HTexture* textures, uint32_t texture_count, PixelFormat pixel_format, ColorSpace color_space, CompressionLevel compression_level, CompressionType compression_type, dmJobSystem::HContext job_system, bool* out_results)
+    {
+        assert(compression_type == dmTexc::CT_WEBP || compression_type == dmTexc::CT_WEBP_LOSSY);
 
-            // check compression size threshold
-            if((mip_width * mip_height) <= COMPRESSION_ENABLED_PIXELCOUNT_THRESHOLD)
+        dmArray<WebPTexture> webp_textures;
+        webp_textures.SetCapacity(texture_count);
+        webp_textures.SetSize(texture_count);
+        dmArray<WebPMipJob> jobs;
+
+        for (uint32_t i = 0; i < texture_count; ++i)
+        {
+            Texture* t = (Texture*) textures[i];
+            assert(t->m_CompressedMips.Empty());
+            WebPTexture& webp_texture = webp_textures[i];
+            webp_texture.m_Texture = t;
+            webp_texture.m_FirstMipJob = jobs.Size();
+            webp_texture.m_MipMapCount = 0;
+            webp_texture.m_Valid = InitWebPConfig(t, compression_level, compression_type, &webp_texture.m_Config);
+            if (!webp_texture.m_Valid)
+                continue;
+
+            pvrtexture::CPVRTexture* pt = t->m_PVRTexture;
+            uint32_t mip_maps = pt->getNumMIPLevels();
+            for (uint32_t mip_map = 0; mip_map < mip_maps; ++mip_map)
             {
-                mip_map = mip_maps;
-                break;
+                // check compression size threshold
+                if((pt->getWidth(mip_map) * pt->getHeight(mip_map)) <= COMPRESSION_ENABLED_PIXELCOUNT_THRESHOLD)
+                    break;
+                webp_texture.m_MipMapCount++;
             }
 
-            uint32_t datasize = pt->getDataSize(mip_map);
-            uint8_t* data = (uint8_t*) pt->getDataPtr(mip_map);
-            uint32_t outsize;
-            TextureData ctd;
-            if (!CompressWebPInternal(&config, mip_width, mip_height, bits_per_pixel, data, datasize, &ctd.m_Data, &outsize, pixel_format, compression_level, compression_type)) {
-                dmLogError("Failed to compress mip %d", mip_map);
-                mip_map = mip_maps;
-                break;
+            jobs.OffsetCapacity(webp_texture.m_MipMapCount);
+            for (uint32_t mip_map = 0; mip_map < webp_texture.m_MipMapCount; ++mip_map)
+            {
+                WebPMipJob job;
+                job.m_WebPTexture = &webp_texture;
+                job.m_MipMap = mip_map;
+                job.m_Ok = false;
+                jobs.Push(job);
             }
-            ctd.m_ByteSize = outsize;
-            t->m_CompressedMips.Push(ctd);
         }
 
-        // if we haven't got a complete mip-map chain, something went' wrong so free all used memory
-        if(mip_map != mip_maps)
+        WebPBatchContext context;
+        context.m_PixelFormat = pixel_format;
+        context.m_CompressionLevel = compression_level;
+        context.m_CompressionType = compression_type;
+        if (!jobs.Empty())
+        {
+            RunBatchJobs(job_system, CompressWebPMipJob, &context, jobs.Begin(), sizeof(WebPMipJob), jobs.Size());
+        }
+
+        bool result = true;
+        for (uint32_t i = 0; i < texture_count; ++i)
         {
-            dmLogError("WebPEncode compression failed at mip index(%d)", mip_map);
-            for(size_t i = 0; i < t->m_CompressedMips.Size(); ++i)
+            WebPTexture& webp_texture = webp_textures[i];
+            Texture* t = webp_texture.m_Texture;
+            bool ok = webp_texture.m_Valid;
+            for (uint32_t mip_map = 0; ok && mip_map < webp_texture.m_MipMapCount; ++mip_map)
             {
-                delete[] &t->m_CompressedMips[i].m_Data;
+                if (!jobs[webp_texture.m_FirstMipJob + mip_map].m_Ok)
+                {
+                    dmLogError("WebPEncode compression failed at mip index(%u)", mip_map);
+                    ok = false;
+                }
             }
-            t->m_CompressedMips.SetSize(0);
-            return false;
+
+            // if we haven't got a complete mip-map chain, something went' wrong so free all used memory
+            if (ok && t->m_CompressedMips.Capacity() < webp_texture.m_MipMapCount)
+            {
+                t->m_CompressedMips.SetCapacity(webp_texture.m_MipMapCount);
+            }
+            for (uint32_t mip_map = 0; mip_map < webp_texture.m_MipMapCount; ++mip_map)
+            {
+                WebPMipJob& job = jobs[webp_texture.m_FirstMipJob + mip_map];
+                if (ok)
+                {
+                    t->m_CompressedMips.Push(job.m_Result);
+                }
+                else
+                {
+                    delete[] job.m_Result.m_Data;
+                }
+            }
+
+            if (out_results)
+                out_results[i] = ok;
+            result &= ok;
         }
+        return result;
+    }
 
-        // compression success, free source picture
-        return true;
+    bool CompressWebP(HTexture texture, PixelFormat pixel_format, ColorSpace color_space, CompressionLevel compression_level, CompressionType compression_type)
+    {
+        return CompressWebPBatch(&texture, 1, pixel_format, color_space, compression_level, compression_type, 0, 0);
     }
 
 
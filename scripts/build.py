@@ -813,6 +813,14 @@ class Configuration(object):
             gdc_bin = join(bin_dir, gdc_name)
             self.upload_file(gdc_bin, '%s/%s' % (full_archive_path, gdc_name))
 
+        # upload the lua 5.1 compilers used by bob, see engine/lua/src/lua/wscript_build
+        if self.target_platform in ['x86_64-linux', 'x86_64-darwin', 'x86_64-win32', 'win32']:
+            for luac in ['luac-32', 'luac-64']:
+                for luac_name in format_exes(luac, self.target_platform):
+                    luac_bin = join(bin_dir, luac_name)
+                    if os.path.exists(luac_bin):
+                        self.upload_file(luac_bin, '%s/%s' % (full_archive_path, luac_name))
+
         for n in ['dmengine', 'dmengine_release', 'dmengine_headless']:
             for engine_name in format_exes(n, self.target_platform):
                 engine = join(bin_dir, engine_name)
@@ -1032,6 +1040,10 @@ class Configuration(object):
         osx_files = dict([['ext/lib/%s/lib%s.dylib' % (plf[0], lib), 'lib/%s/lib%s.dylib' % (plf[1], lib)] for lib in ['PVRTexLib'] for plf in [['x86_64-darwin', 'x86_64-darwin']]])
         linux_files = dict([['ext/lib/%s/lib%s.so' % (plf[0], lib), 'lib/%s/lib%s.so' % (plf[1], lib)] for lib in ['PVRTexLib'] for plf in [['x86_64-linux', 'x86_64-linux']]])
         js_files = {}
+        # The lua 5.1 compilers used by --use-lua51-bytecode. The 32-bit one for windows is built by the win32 target
+        lua51_files = {'bin/%s/%s' % (self.host2, format_exes('luac-64', self.host2)[0]): 'libexec/%s/%s' % (self.host2, format_exes('luac-64', self.host2)[0])}
+        luac_32_plf = 'win32' if 'win32' in self.host2 else self.host2
+        lua51_files['bin/%s/%s' % (luac_32_plf, format_exes('luac-32', self.host2)[0])] = 'libexec/%s/%s' % (self.host2, format_exes('luac-32', self.host2)[0])
         android_files = {'ext/bin/%s/%s' % (self.host2, apkc_name): 'libexec/%s/%s' % (self.host2, apkc_name),
                          'share/java/classes.dex': 'lib/classes.dex',
                          'ext/share/java/android.jar': 'lib/android.jar'}
@@ -1044,6 +1056,7 @@ class Configuration(object):
                      'android-bundling': android_files,
                      'win32-bundling': win32_files,
                      'js-bundling': js_files,
+                     'lua51-bytecode': lua51_files,
                      'ios-bundling': {},
                      'osx-bundling': osx_files,
                      'linux-bundling': linux_files}